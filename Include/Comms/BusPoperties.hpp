@@ -22,6 +22,8 @@ enum class BusProperty : uint8_t {
     StopBits,       // enum (One, Two)
     FlowControl,    // enum (None, Hardware, Software)
     Timeout,        // uint32_t in milliseconds
+    LowLatency,     // bool (0/1), USB-UART bridges: ASYNC_LOW_LATENCY and latency timer
+    LatencyTimer,   // uint32_t in milliseconds, FTDI latency_timer (1..255)
 
     // SPI properties
     SpiMode,        // enum (Mode0..Mode3)
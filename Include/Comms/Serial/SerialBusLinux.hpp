@@ -0,0 +1,253 @@
+/**
+ * @file SerialBusLinux.hpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Linux implementation of serial communication bus
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <etl/string.h>
+#include <etl/expected.h>
+
+#include "ISerialBus.hpp"
+
+namespace comms
+{
+    namespace serial
+    {
+
+        /**
+         * @brief Serial bus on a Linux tty (/dev/ttyUSB0, /dev/ttyACM0, /dev/ttyS0, ...)
+         *
+         * USB-UART bridges (FTDI, CH340, CP210x) hold received bytes until
+         * their latency timer expires, 16 ms by default on FTDI, which is
+         * added to every PN532 ACK and response. Low-latency mode sets
+         * ASYNC_LOW_LATENCY on the tty (TIOCSSERIAL) and, when the driver
+         * exposes it, lowers the latency_timer sysfs attribute. Either step
+         * may be unavailable: CH340 has no latency timer, ptys and CDC-ACM
+         * reject TIOCSSERIAL, and writing sysfs needs permission.
+         * getProperty(BusProperty::LowLatency) reports what was actually
+         * applied. The original latency timer is restored on close().
+         */
+        class SerialBusLinux : public ISerialBus
+        {
+        public:
+            static constexpr uint32_t LOW_LATENCY_TIMER_MS = 1U;
+            static constexpr const char *DEFAULT_SYSFS_TTY_ROOT = "/sys/class/tty";
+
+            // ==============================================================================
+            // Initialization and Teardown
+            // ==============================================================================
+
+            /**
+             * @brief Construct a new Serial Bus Linux object
+             *
+             * @param portname Device path, e.g. /dev/ttyUSB0
+             * @param baudrate Baud rate applied by init()
+             * @param sysfsTtyRoot Directory holding <tty>/device/latency_timer
+             */
+            SerialBusLinux(const etl::string<256> &portname, uint32_t baudrate, const char *sysfsTtyRoot = DEFAULT_SYSFS_TTY_ROOT);
+
+            /**
+             * @brief Destroy the Serial Bus Linux object
+             *
+             */
+            ~SerialBusLinux() override;
+
+            /**
+             * @brief Initializes the serial bus
+             *
+             * @return etl::expected<void, Error> void on success, Error on failure
+             */
+            etl::expected<void, Error> init() override;
+
+            // ==============================================================================
+            // Open and Close
+            // ==============================================================================
+
+            /**
+             * @brief Opens the serial bus in raw mode
+             *
+             * @return etl::expected<void, Error> void on success, Error on failure
+             */
+            etl::expected<void, Error> open() override;
+
+            /**
+             * @brief Closes the serial bus and restores the latency timer
+             *
+             */
+            void close() override;
+
+            // ==============================================================================
+            // Read and Write
+            // ==============================================================================
+
+            /**
+             * @brief Writes data to the hardware bus
+             *
+             * @param data Data to write
+             * @return etl::expected<void, Error> void on success, Error on failure
+             */
+            etl::expected<void, Error> write(const etl::ivector<uint8_t> &data) override;
+
+            /**
+             * @brief Reads data from the hardware bus
+             *
+             * Returns what arrived within the timeout, up to length bytes.
+             *
+             * @param buffer Buffer to store read data
+             * @param length Number of bytes to read
+             * @return etl::expected<size_t, Error> Number of bytes read on success, Error on failure
+             */
+            etl::expected<size_t, Error> read(etl::ivector<uint8_t> &buffer, size_t length) override;
+
+            /**
+             * @brief Waits until all output has been transmitted
+             *
+             * @return etl::expected<void, Error> void on success, Error on failure
+             */
+            etl::expected<void, Error> flush() override;
+
+            /**
+             * @brief Checks how many bytes are available to read
+             *
+             * @return size_t Number of available bytes
+             */
+            size_t available() const override;
+
+            // ==============================================================================
+            // Bus-specific Properties
+            // ==============================================================================
+
+            /**
+             * @brief Set the Baud Rate
+             *
+             * @param baudrate The baud rate to set
+             * @return etl::expected<void, Error> void on success, Error on failure
+             */
+            etl::expected<void, Error> setBaudRate(uint32_t baudrate) override;
+
+            /**
+             * @brief Set the Parity
+             *
+             * @param parity The parity to set
+             * @return etl::expected<void, Error> void on success, Error on failure
+             */
+            etl::expected<void, Error> setParity(Parity parity) override;
+
+            /**
+             * @brief Set the Stop Bits
+             *
+             * @param stopBits The stop bits to set
+             * @return etl::expected<void, Error>
+             */
+            etl::expected<void, Error> setStopBits(StopBits stopBits) override;
+
+            /**
+             * @brief Set the Flow Control
+             *
+             * @param flowControl The flow control to set
+             * @return etl::expected<void, Error> void on success, Error on failure
+             */
+            etl::expected<void, Error> setFlowControl(FlowControl flowControl) override;
+
+            /**
+             * @brief Set timeout for read operations
+             *
+             * @param timeoutMs Timeout in milliseconds
+             * @return etl::expected<void, Error> void on success, Error on failure
+             */
+            etl::expected<void, Error> setTimeout(uint32_t timeoutMs) override;
+
+            /**
+             * @brief Enable or disable low-latency mode
+             *
+             * @param enable true to set ASYNC_LOW_LATENCY and a 1 ms latency timer,
+             *        false to clear the flag and restore the original timer
+             * @return etl::expected<void, Error> void when at least one of the two
+             *         settings was applied, NotSupported when neither is available
+             */
+            etl::expected<void, Error> setLowLatency(bool enable);
+
+            /**
+             * @brief Set the USB-UART latency timer
+             *
+             * @param timerMs Latency timer in milliseconds, 1..255
+             * @return etl::expected<void, Error> void on success, NotSupported when the
+             *         driver has no latency_timer attribute
+             */
+            etl::expected<void, Error> setLatencyTimer(uint32_t timerMs);
+
+            /**
+             * @brief Set the minimum byte count of a blocking tty read (VMIN)
+             *
+             * 0, the default, suits read() which polls with the timeout
+             * first. io_uring reads need 1: with VMIN=0 the kernel completes
+             * them at once with 0 bytes instead of waiting for data.
+             *
+             * @param bytes VMIN value
+             * @return etl::expected<void, Error> void on success, Error on failure
+             */
+            etl::expected<void, Error> setReadMinimum(uint8_t bytes);
+
+            /**
+             * @brief File descriptor of the open tty, -1 when closed
+             */
+            int nativeHandle() const;
+
+            // ==============================================================================
+            // Bus Properties
+            // ==============================================================================
+
+            /**
+             * @brief Set the Property object
+             *
+             * @param property The property to set
+             * @param value The value to set
+             * @return etl::expected<void, Error> void on success, Error on failure
+             */
+            etl::expected<void, Error> setProperty(BusProperty property, uint32_t value) override;
+
+            /**
+             * @brief Get the Property object
+             *
+             * LowLatency is 1 when ASYNC_LOW_LATENCY reads back as set or the
+             * latency timer is at LOW_LATENCY_TIMER_MS. LatencyTimer is read
+             * from sysfs.
+             *
+             * @param property The property to get
+             * @return etl::expected<uint32_t, Error> Value of the property on success, Error on failure
+             */
+            etl::expected<uint32_t, Error> getProperty(BusProperty property) const override;
+
+        private:
+            etl::expected<void, Error> applyTermios();
+            etl::expected<bool, Error> setAsyncLowLatency(bool enable);
+            etl::expected<bool, Error> readAsyncLowLatency() const;
+            etl::expected<uint32_t, Error> readLatencyTimer() const;
+            etl::expected<void, Error> writeLatencyTimer(uint32_t timerMs);
+            void latencyTimerPath(etl::string<384> &path) const;
+
+            int fileDescriptor;
+            uint32_t baudRate;
+            uint32_t timeoutMs;
+            Parity parity;
+            StopBits stopBits;
+            FlowControl flowControl;
+
+            etl::string<256> portName;
+            etl::string<128> sysfsRoot;
+            uint32_t originalLatencyTimer;  // 0 when the timer was not changed
+            uint8_t readMinimum;            // VMIN
+        };
+
+    } // namespace serial
+
+} // namespace comms
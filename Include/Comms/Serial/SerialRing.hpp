@@ -0,0 +1,232 @@
+/**
+ * @file SerialRing.hpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief io_uring engine serving many serial readers from one thread
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <etl/array.h>
+#include <etl/circular_buffer.h>
+#include <etl/expected.h>
+#include <etl/vector.h>
+
+#include "Error/Error.h"
+
+namespace comms
+{
+    namespace serial
+    {
+        using error::Error;
+
+        /**
+         * @brief Completion handlers of one channel, all optional
+         *
+         * Called from SerialRing::poll() on the thread that runs the ring.
+         */
+        struct SerialRingHandlers
+        {
+            void (*onReceive)(void *context, size_t channel) = nullptr;                 // new bytes buffered
+            void (*onWriteComplete)(void *context, size_t channel, bool ok) = nullptr;  // queued bytes sent or failed
+            void *context = nullptr;
+        };
+
+        /**
+         * @brief Counters since init()
+         */
+        struct SerialRingMetrics
+        {
+            uint32_t enterCalls = 0U;   // io_uring_enter system calls
+            uint32_t submitted = 0U;    // read/write operations handed to the kernel
+            uint32_t completed = 0U;    // completions reaped
+            uint32_t bytesRead = 0U;
+            uint32_t bytesWritten = 0U;
+        };
+
+        /**
+         * @brief io_uring engine for up to MAX_CHANNELS serial file descriptors
+         *
+         * Every attached descriptor always has one read outstanding in the
+         * kernel; received bytes land in the channel's receive buffer and
+         * are taken from there without a system call. Writes are queued and
+         * go out together with everything else queued since the last
+         * poll(), so N readers cost one io_uring_enter per step instead of
+         * a read, write and FIONREAD each. Completions are reaped from
+         * shared memory; poll() only enters the kernel to submit or to wait.
+         *
+         * The ring and its channels belong to one thread. Spread many
+         * readers over a few threads with one SerialRing each. Descriptors
+         * must be blocking; the kernel turns the outstanding read into a
+         * poll wait. Needs Linux 5.11 (IORING_FEAT_EXT_ARG); init() reports
+         * NotSupported on older kernels. The engine takes about 27 KB; keep
+         * it in static storage.
+         */
+        class SerialRing
+        {
+        public:
+            static constexpr size_t MAX_CHANNELS = 16U;
+            static constexpr size_t READ_CHUNK = 64U;       // bytes per outstanding read
+            static constexpr size_t RX_BUFFER_SIZE = 512U;  // received, not yet taken
+            static constexpr size_t TX_BUFFER_SIZE = 512U;  // queued, not yet submitted
+            static constexpr uint32_t QUEUE_DEPTH = 64U;
+
+            SerialRing();
+            ~SerialRing();
+
+            SerialRing(const SerialRing &) = delete;
+            SerialRing &operator=(const SerialRing &) = delete;
+
+            /**
+             * @brief Set up the submission and completion queues
+             *
+             * @return etl::expected<void, Error> void on success, NotSupported without io_uring
+             */
+            etl::expected<void, Error> init();
+
+            /**
+             * @brief Detach every channel and release the ring
+             */
+            void shutdown();
+
+            /**
+             * @brief Start serving a descriptor
+             *
+             * @param fd Open, blocking serial descriptor; stays owned by the caller
+             * @param handlers Completion handlers
+             * @return etl::expected<size_t, Error> Channel number, BufferOverflow when all channels are in use
+             */
+            etl::expected<size_t, Error> attach(int fd, const SerialRingHandlers &handlers = SerialRingHandlers());
+
+            /**
+             * @brief Stop serving a channel
+             *
+             * Cancels its outstanding operations and waits for them, so the
+             * descriptor may be closed afterwards. Unread bytes are dropped.
+             *
+             * @param channel Channel from attach()
+             */
+            void detach(size_t channel);
+
+            /**
+             * @brief Queue bytes for sending
+             *
+             * Submitted by the next poll(). A failure of an earlier write
+             * on the channel is reported here.
+             *
+             * @param channel Channel from attach()
+             * @param data Bytes to send
+             * @return etl::expected<void, Error> void when queued, BufferOverflow when the queue is full
+             */
+            etl::expected<void, Error> write(size_t channel, const etl::ivector<uint8_t> &data);
+
+            /**
+             * @brief Take received bytes
+             *
+             * @param channel Channel from attach()
+             * @param data Destination
+             * @param length Maximum number of bytes
+             * @return size_t Bytes copied
+             */
+            size_t read(size_t channel, uint8_t *data, size_t length);
+
+            /**
+             * @brief Received bytes waiting in the channel buffer
+             */
+            size_t available(size_t channel) const;
+
+            /**
+             * @brief Queued or in-flight write bytes
+             */
+            bool writePending(size_t channel) const;
+
+            /**
+             * @brief True after a read or write on the channel failed
+             */
+            bool failed(size_t channel) const;
+
+            /**
+             * @brief Submit everything queued and dispatch completions
+             *
+             * @param timeoutMs Longest wait for a first completion; 0 never blocks
+             * @return etl::expected<size_t, Error> Completions dispatched, BusError when the ring fails
+             */
+            etl::expected<size_t, Error> poll(uint32_t timeoutMs);
+
+            /**
+             * @brief Run poll() until the channel has received bytes, failed, or the time is up
+             *
+             * @return true Bytes are available
+             */
+            bool waitReadable(size_t channel, uint32_t timeoutMs);
+
+            /**
+             * @brief Run poll() until the channel's writes are out, failed, or the time is up
+             *
+             * @return true Nothing is left to send and no write failed
+             */
+            bool waitWritten(size_t channel, uint32_t timeoutMs);
+
+            const SerialRingMetrics &getMetrics() const;
+
+        private:
+            struct Channel
+            {
+                int fd = -1;
+                SerialRingHandlers handlers;
+                bool readArmed = false;
+                bool writeArmed = false;
+                bool failed = false;
+                bool closing = false;
+                uint8_t readChunk[READ_CHUNK];
+                etl::circular_buffer<uint8_t, RX_BUFFER_SIZE> rx;
+                etl::vector<uint8_t, TX_BUFFER_SIZE> txInFlight;
+                etl::vector<uint8_t, TX_BUFFER_SIZE> txQueued;
+            };
+
+            bool queueRead(size_t channel);
+            bool queueWrite(size_t channel);
+            bool queueCancel(size_t channel, uint64_t operation);
+            bool prepare(uint8_t opcode, int fd, uint64_t address, uint32_t length, uint64_t userData);
+            etl::expected<void, Error> enter(uint32_t timeoutMs);
+            size_t reap();
+            void complete(uint64_t userData, int32_t result);
+            bool isAttached(size_t channel) const;
+
+            int ringFd;
+            void *ringMemory;
+            size_t ringMemorySize;
+            void *completionMemory;
+            size_t completionMemorySize;
+            void *entryMemory;
+            size_t entryMemorySize;
+
+            // Submission queue
+            uint32_t *sqHead;
+            uint32_t *sqTail;
+            uint32_t sqMask;
+            uint32_t *sqArray;
+            uint32_t sqEntries;
+            uint32_t toSubmit;
+
+            // Completion queue
+            uint32_t *cqHead;
+            uint32_t *cqTail;
+            uint32_t cqMask;
+            void *cqes;
+
+            uint32_t inFlight;
+            etl::array<Channel, MAX_CHANNELS> channels;
+            SerialRingMetrics metrics;
+        };
+
+    } // namespace serial
+
+} // namespace comms
@@ -0,0 +1,138 @@
+/**
+ * @file SerialRingBus.hpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Serial bus whose I/O runs through a shared SerialRing
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <etl/string.h>
+#include <etl/expected.h>
+
+#include "ISerialBus.hpp"
+#include "SerialBusLinux.hpp"
+#include "SerialRing.hpp"
+
+namespace comms
+{
+    namespace serial
+    {
+
+        /**
+         * @brief Serial bus on a Linux tty served by a SerialRing
+         *
+         * Drop-in for SerialBusLinux under Pn532Driver. Port settings go to
+         * an embedded SerialBusLinux; reads, writes and available() go
+         * through the ring channel, so available() is a buffer check
+         * instead of an FIONREAD call. Each call pumps the ring, which
+         * also moves data for every other bus on it: a thread driving
+         * several readers in turn never blocks on one of them while the
+         * others' responses are still in the kernel.
+         *
+         * Use a bus only from the thread that runs its ring.
+         */
+        class SerialRingBus : public ISerialBus
+        {
+        public:
+            /**
+             * @brief Construct a new Serial Ring Bus object
+             *
+             * @param ring Engine serving this bus, initialized before open()
+             * @param portname Device path, e.g. /dev/ttyUSB0
+             * @param baudrate Baud rate applied by init()
+             */
+            SerialRingBus(SerialRing &ring, const etl::string<256> &portname, uint32_t baudrate);
+
+            /**
+             * @brief Destroy the Serial Ring Bus object
+             *
+             */
+            ~SerialRingBus() override;
+
+            etl::expected<void, Error> init() override;
+
+            /**
+             * @brief Opens the tty and attaches it to the ring
+             *
+             * @return etl::expected<void, Error> void on success, Error on failure
+             */
+            etl::expected<void, Error> open() override;
+
+            /**
+             * @brief Detaches from the ring and closes the tty
+             *
+             */
+            void close() override;
+
+            /**
+             * @brief Queues data on the ring and submits it
+             *
+             * @param data Data to write
+             * @return etl::expected<void, Error> void on success, WriteFailed when an earlier write failed
+             */
+            etl::expected<void, Error> write(const etl::ivector<uint8_t> &data) override;
+
+            /**
+             * @brief Reads received data
+             *
+             * Returns what arrived within the timeout, up to length bytes;
+             * the timeout restarts with every chunk as on SerialBusLinux.
+             *
+             * @param buffer Buffer to store read data
+             * @param length Number of bytes to read
+             * @return etl::expected<size_t, Error> Number of bytes read on success, Error on failure
+             */
+            etl::expected<size_t, Error> read(etl::ivector<uint8_t> &buffer, size_t length) override;
+
+            /**
+             * @brief Waits until queued data is written and transmitted
+             *
+             * @return etl::expected<void, Error> void on success, Error on failure
+             */
+            etl::expected<void, Error> flush() override;
+
+            /**
+             * @brief Bytes received on the ring channel
+             *
+             * @return size_t Number of available bytes
+             */
+            size_t available() const override;
+
+            etl::expected<void, Error> setBaudRate(uint32_t baudrate) override;
+            etl::expected<void, Error> setParity(Parity parity) override;
+            etl::expected<void, Error> setStopBits(StopBits stopBits) override;
+            etl::expected<void, Error> setFlowControl(FlowControl flowControl) override;
+            etl::expected<void, Error> setTimeout(uint32_t timeoutMs) override;
+            etl::expected<void, Error> setProperty(BusProperty property, uint32_t value) override;
+            etl::expected<uint32_t, Error> getProperty(BusProperty property) const override;
+
+            /**
+             * @brief The embedded port, for low-latency and latency timer settings
+             */
+            SerialBusLinux &port();
+
+            /**
+             * @brief Ring channel of this bus, valid while open
+             */
+            size_t channel() const;
+
+        private:
+            etl::expected<void, Error> attachPort();
+
+            SerialRing &ring;
+            SerialBusLinux serialPort;
+            size_t ringChannel;
+            bool attached;
+            uint32_t timeoutMs;
+        };
+
+    } // namespace serial
+
+} // namespace comms
@@ -23,7 +23,9 @@ namespace error {
         CardMute,
         AuthenticationRequired,
         OperationFailed,
-        InvalidParameter
+        InvalidParameter,
+        CardRejected,
+        DuplicateTap
     };
 
 } // namespace error
\ No newline at end of file
@@ -294,6 +294,10 @@ namespace error {
                         return "OperationFailed";
                     case CardManagerError::InvalidParameter:
                         return "InvalidParameter";
+                    case CardManagerError::CardRejected:
+                        return "CardRejected";
+                    case CardManagerError::DuplicateTap:
+                        return "DuplicateTap";
                     default:
                         return "UndefinedCardManagerError";
                 }
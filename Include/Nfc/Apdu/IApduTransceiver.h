@@ -50,10 +50,10 @@ namespace nfc
          * Returns PDU format: [Status][Data...] where Status is DESFire status byte.
          *
          * @param apdu Command data to transmit
-         * @return etl::expected<etl::vector<uint8_t, buffer::APDU_DATA_MAX>, error::Error> 
+         * @return etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> 
          *         PDU response or error
          */
-        virtual etl::expected<etl::vector<uint8_t, buffer::APDU_DATA_MAX>, error::Error> transceive(
+        virtual etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> transceive(
             const etl::ivector<uint8_t> &apdu) = 0;
     };
 
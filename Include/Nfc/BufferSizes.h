@@ -111,6 +111,16 @@ namespace nfc
          */
         constexpr size_t APDU_STATUS_SIZE = 2;
         
+        /**
+         * @brief Maximum normalized PDU response size
+         * 
+         * Calculation:
+         * - Status: 1 byte (SW2 mapped to the DESFire status)
+         * - Data: 256 bytes maximum
+         * Total: 1 + 256 = 257 bytes
+         */
+        constexpr size_t PDU_RESPONSE_MAX = 257;
+        
         // ========================================================================
         // DESFire Native Protocol Layer
         // ========================================================================
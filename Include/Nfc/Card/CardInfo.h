@@ -22,15 +22,85 @@
 namespace nfc
 {
 
+   /**
+    * @brief Product generation, where it can be told apart
+    */
+   enum class CardGeneration : uint8_t {
+      Unknown = 0,
+      DesfireEv0,
+      DesfireEv1,
+      DesfireEv2,
+      DesfireEv3,
+      DesfireLight,
+      Ntag424Dna
+   };
+
+   /**
+    * @brief Bit rate flags for AtsInfo (106 kbit/s is always supported)
+    */
+   enum AtsBitRate : uint8_t {
+      ATS_BITRATE_106 = 0x01,
+      ATS_BITRATE_212 = 0x02,
+      ATS_BITRATE_424 = 0x04,
+      ATS_BITRATE_848 = 0x08
+   };
+
+   /**
+    * @brief Decoded ATS interface bytes (ISO/IEC 14443-4, 5.2)
+    *
+    * Absent interface bytes take their ISO defaults: TA 0x00, TB 0x40
+    * (FWI 4, SFGI 0), TC 0x02 (CID supported, NAD not supported).
+    */
+   struct AtsInfo {
+      bool valid = false;                  // ATS present and well formed
+      uint8_t fsci = 2U;                   // Frame size for proximity card integer
+      uint16_t fsc = 32U;                  // Maximum frame size the card accepts
+      uint8_t bitRatesToCard = ATS_BITRATE_106;     // DR: reader to card
+      uint8_t bitRatesFromCard = ATS_BITRATE_106;   // DS: card to reader
+      bool sameBitRateOnly = false;        // TA b8: both directions must use the same rate
+      uint8_t fwi = 4U;                    // Frame waiting time integer
+      uint8_t sfgi = 0U;                   // Start-up frame guard time integer
+      bool cidSupported = true;
+      bool nadSupported = false;
+      uint8_t historicalOffset = 0U;       // Index of the first historical byte in CardInfo::ats
+      uint8_t historicalLength = 0U;
+   };
+
    struct CardInfo {
       etl::vector<uint8_t, 10> uid;    // Unique Identifier of the card
       uint16_t atqa;                   // ATQA value
       uint8_t  sak;                    // SAK value
-      etl::vector<uint8_t, 32> ats;    // ATS (Answer To Select) data, if applicable
+      etl::vector<uint8_t, 32> ats;    // ATS (Answer To Select) without the TL byte, if applicable
       CardType type;                   // Detected card type
+      AtsInfo atsInfo;                 // Decoded ATS, filled by detectType()
+      CardGeneration generation = CardGeneration::Unknown;   // Generation inferred from the ATS
+      bool generationAmbiguous = true; // True if GetVersion is needed to know the generation
 
+      /**
+       * @brief Detect the card type from ATQA/SAK and decode the ATS
+       *
+       * Also infers the generation from factory-default ATS values. Cards
+       * whose ATS is shared by several generations (DESFire EV1/EV2/EV3 all
+       * ship with 75 77 81 02 80) or was changed with SetConfiguration keep
+       * generationAmbiguous set.
+       */
       CardType detectType();
 
+      /**
+       * @brief Decode the ATS interface bytes into atsInfo
+       *
+       * @return true if the ATS was present and well formed
+       */
+      bool parseAts();
+
+      /**
+       * @brief Map a DESFire GetVersion hardware block to a generation
+       *
+       * @param version GetVersion payload (at least the 7 hardware bytes)
+       * @return CardGeneration Generation, or Unknown for other products
+       */
+      static CardGeneration generationFromVersion(const etl::ivector<uint8_t>& version);
+
       etl::string<255> toString() const;
    };
 
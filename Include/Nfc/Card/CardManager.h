@@ -13,6 +13,7 @@
 
 #include <etl/optional.h>
 #include <etl/expected.h>
+#include <etl/vector.h>
 #include "Nfc/Apdu/IApduTransceiver.h"
 #include "Nfc/Card/ICardDetector.h"
 #include "Nfc/Wire/IWire.h"
@@ -22,10 +23,42 @@
 #include "CardInfo.h"
 #include "CardSession.h"
 #include "ReaderCapabilities.h"
+#include "UidHotlist.h"
 #include "Error/Error.h"
 
 namespace nfc
 {
+    /**
+     * @brief How detectCard() treats a card it has just processed
+     */
+    enum class TapDebounceMode : uint8_t
+    {
+        Off,            // every call runs a full detection
+        Suppress,       // the same card within the window reports DuplicateTap
+        ReuseSession    // a card that never left the field is returned with its session kept
+    };
+
+    /**
+     * @brief Tap debounce configuration
+     */
+    struct TapDebounceOptions
+    {
+        TapDebounceMode mode = TapDebounceMode::Off;
+        uint32_t windowMs = 1500U;      // a UID seen again within this time is the same tap
+        uint32_t (*clock)() = nullptr;  // millisecond tick, utils::get_tick_ms when unset
+    };
+
+    /**
+     * @brief Tap debounce counters
+     */
+    struct TapDebounceMetrics
+    {
+        uint32_t detections = 0U;       // full detections (InListPassiveTarget) run
+        uint32_t presenceChecks = 0U;
+        uint32_t suppressed = 0U;       // DuplicateTap returned
+        uint32_t sessionsReused = 0U;
+    };
+
     /**
      * @brief Card manager for NFC operations
      * 
@@ -34,6 +67,8 @@ namespace nfc
     class CardManager
     {
     public:
+        static constexpr size_t RECENT_TAPS = 8U;
+
         /**
          * @brief Construct a new CardManager
          * 
@@ -60,10 +95,40 @@ namespace nfc
          */
         WireKind getWireKind() const;
 
+        /**
+         * @brief Set the UID hotlist consulted on every detection
+         *
+         * @param hotlist Hotlist, or nullptr to accept every card
+         */
+        void setHotlist(const UidHotlist* hotlist);
+
+        /**
+         * @brief Configure the tap debounce and forget recent taps
+         *
+         * @param options Debounce mode, window and clock
+         */
+        void setTapDebounce(const TapDebounceOptions& options);
+
+        /**
+         * @brief Get the tap debounce counters
+         */
+        const TapDebounceMetrics& getTapDebounceMetrics() const;
+
         /**
          * @brief Detect card
          * 
-         * @return etl::expected<CardInfo, error::Error> Card info or error
+         * With a hotlist set, a card that does not pass it is rejected
+         * before any session can be created for it.
+         *
+         * With a tap debounce set, the card of the previous detection is
+         * first checked with the detector's presence check. A card that is
+         * still in the field is reported as DuplicateTap (Suppress) or
+         * returned without a new detection, and createSession() then hands
+         * back the existing session (ReuseSession). A card that left the
+         * field and comes back within the window is reported as DuplicateTap
+         * in both modes. The last RECENT_TAPS UIDs are remembered.
+         *
+         * @return etl::expected<CardInfo, error::Error> Card info, or CardRejected/DuplicateTap/detection error
          */
         etl::expected<CardInfo, error::Error> detectCard();
 
@@ -77,6 +142,9 @@ namespace nfc
         /**
          * @brief Create a card session
          * 
+         * Returns the active session unchanged when detectCard() found the
+         * card still in the field in ReuseSession mode.
+         *
          * @return etl::expected<CardSession*, error::Error> Pointer to session or error
          */
         etl::expected<CardSession*, error::Error> createSession();
@@ -109,6 +177,20 @@ namespace nfc
         const ReaderCapabilities& getCapabilities() const;
 
     private:
+        /**
+         * @brief UID processed recently and when it was last seen
+         */
+        struct RecentTap
+        {
+            etl::vector<uint8_t, 10> uid;
+            uint32_t seenMs = 0U;
+        };
+
+        etl::expected<CardInfo, error::Error> detectInField();
+        uint32_t nowMs() const;
+        bool seenWithinWindow(const etl::ivector<uint8_t>& uid, uint32_t now) const;
+        void rememberTap(const etl::ivector<uint8_t>& uid, uint32_t now);
+
         IApduTransceiver& transceiver;
         ICardDetector& detector;
         ReaderCapabilities capabilities;
@@ -118,8 +200,16 @@ namespace nfc
         IWire* activeWire;
         WireKind activeWireKind;
 
+        const UidHotlist* hotlist;
+
         etl::optional<CardInfo> currentCardInfo;
         etl::optional<CardSession> activeSession;
+
+        TapDebounceOptions debounce;
+        TapDebounceMetrics debounceMetrics;
+        etl::vector<RecentTap, RECENT_TAPS> recentTaps;
+        etl::optional<CardInfo> fieldCard;  // card activated by the last detection, kept across clearSession()
+        bool sessionReused;
     };
 
 } // namespace nfc
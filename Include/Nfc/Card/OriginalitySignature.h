@@ -0,0 +1,196 @@
+/**
+ * @file OriginalitySignature.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief NXP originality signature verification with fixed-base tables
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <etl/vector.h>
+#include <etl/expected.h>
+#include "Nfc/Card/CardInfo.h"
+#include "Error/Error.h"
+
+namespace nfc
+{
+    /**
+     * @brief Curve an originality key lives on
+     */
+    enum class OriginalityCurve : uint8_t
+    {
+        Secp128r1,  // NTAG 21x, Ultralight EV1
+        Secp224r1   // DESFire EV2/EV3/Light, NTAG 424 DNA
+    };
+
+    /**
+     * @brief Originality public key
+     */
+    enum class OriginalityKeyId : uint8_t
+    {
+        Ntag21x = 0,
+        DesfireEv2 = 1,
+        DesfireEv3 = 2,     // also NTAG 424 DNA
+        DesfireLight = 3,
+        Custom = 4          // set with setCustomKey()
+    };
+
+    /**
+     * @brief One signature of a verifyBatch() call
+     */
+    struct OriginalityBatchItem
+    {
+        const uint8_t* uid = nullptr;
+        size_t uidLength = 0U;
+        const uint8_t* signature = nullptr;
+        size_t signatureLength = 0U;
+        bool valid = false;     // set by verifyBatch()
+    };
+
+    /**
+     * @brief Verification counters
+     */
+    struct OriginalityVerifierMetrics
+    {
+        uint32_t verifications = 0U;    // signatures checked with curve arithmetic
+        uint32_t cacheHits = 0U;        // results answered from the cache
+        uint32_t rejected = 0U;         // signatures found invalid
+        uint32_t tablesBuilt = 0U;      // fixed-base tables computed
+    };
+
+    /**
+     * @brief ECDSA verifier for NXP originality signatures
+     *
+     * The signature is ECDSA without hashing over the UID. Both points of
+     * the verification, the curve generator and the NXP public key, are
+     * fixed, so each gets a comb table of 255 precomputed multiples (built
+     * on first use or by precompute()). u1*G + u2*Q then costs one doubling
+     * and two additions per comb column: 28 doublings for secp224r1 instead
+     * of 224. The x coordinate is compared in projective form, so the only
+     * inversion left is s^-1 mod n; verifyBatch() shares that inversion
+     * between signatures.
+     *
+     * Results are cached per UID and signature, so a card presented again
+     * costs a table lookup. The verifier holds all tables (about 100 KB);
+     * give it static storage.
+     */
+    class OriginalitySignatureVerifier
+    {
+    public:
+        static constexpr size_t KEY_COUNT = 5U;
+        static constexpr size_t CACHE_SIZE = 32U;
+        static constexpr size_t MAX_UID_LENGTH = 10U;
+        static constexpr size_t MAX_SIGNATURE_LENGTH = 56U;
+        static constexpr size_t MAX_LIMBS = 7U;
+        static constexpr size_t COMB_ENTRIES = 255U;
+
+        OriginalitySignatureVerifier();
+
+        /**
+         * @brief Get the key that signs a card generation
+         *
+         * @return etl::expected<OriginalityKeyId, error::Error> Key, or UnsupportedCardType
+         *         for generations without an originality signature
+         */
+        static etl::expected<OriginalityKeyId, error::Error> keyFor(CardGeneration generation);
+
+        /**
+         * @brief Get the signature length for a curve (r || s)
+         */
+        static size_t signatureLength(OriginalityCurve curve);
+
+        /**
+         * @brief Get the curve of a key
+         */
+        OriginalityCurve curveOf(OriginalityKeyId key) const;
+
+        /**
+         * @brief Install the Custom key, e.g. for a test issuer
+         *
+         * @param curve Curve of the key
+         * @param publicKey Uncompressed point (0x04 || X || Y)
+         * @param length Point length
+         * @return etl::expected<void, error::Error> Success, or InvalidParameter if the point is not on the curve
+         */
+        etl::expected<void, error::Error> setCustomKey(OriginalityCurve curve, const uint8_t* publicKey, size_t length);
+
+        /**
+         * @brief Build the tables for a key ahead of the first tap
+         */
+        etl::expected<void, error::Error> precompute(OriginalityKeyId key);
+
+        /**
+         * @brief Verify the originality signature of a card
+         *
+         * @param key Signing key
+         * @param uid Card UID
+         * @param signature r || s as returned by Read_Sig
+         * @return etl::expected<bool, error::Error> true for a genuine signature,
+         *         InvalidParameter for malformed input
+         */
+        etl::expected<bool, error::Error> verify(
+            OriginalityKeyId key,
+            const etl::ivector<uint8_t>& uid,
+            const etl::ivector<uint8_t>& signature);
+
+        /**
+         * @brief Verify many logged signatures made with the same key
+         *
+         * Malformed items are reported as invalid. The cache is neither
+         * consulted nor filled.
+         *
+         * @param key Signing key
+         * @param items Signatures; valid is set on each
+         * @param count Number of items
+         * @return etl::expected<size_t, error::Error> Number of valid signatures
+         */
+        etl::expected<size_t, error::Error> verifyBatch(OriginalityKeyId key, OriginalityBatchItem* items, size_t count);
+
+        /**
+         * @brief Drop all cached results
+         */
+        void clearCache();
+
+        const OriginalityVerifierMetrics& metrics() const;
+
+    private:
+        struct CombTable
+        {
+            bool ready = false;
+            uint32_t x[COMB_ENTRIES][MAX_LIMBS];
+            uint32_t y[COMB_ENTRIES][MAX_LIMBS];
+        };
+
+        struct CacheEntry
+        {
+            bool used = false;
+            bool valid = false;
+            OriginalityKeyId key = OriginalityKeyId::Custom;
+            uint8_t uidLength = 0U;
+            uint8_t uid[MAX_UID_LENGTH] = {0};
+            uint8_t signature[MAX_SIGNATURE_LENGTH] = {0};
+        };
+
+        etl::expected<void, error::Error> ensureTables(OriginalityKeyId key);
+        const CacheEntry* findCached(OriginalityKeyId key, const etl::ivector<uint8_t>& uid,
+                                     const etl::ivector<uint8_t>& signature) const;
+        void storeCached(OriginalityKeyId key, const etl::ivector<uint8_t>& uid,
+                         const etl::ivector<uint8_t>& signature, bool valid);
+
+        CombTable generatorTables[2];
+        CombTable keyTables[KEY_COUNT];
+        OriginalityCurve customCurve;
+        uint8_t customKey[1U + (2U * 28U)];
+        bool customKeySet;
+        CacheEntry cache[CACHE_SIZE];
+        size_t cacheNext;
+        OriginalityVerifierMetrics verifierMetrics;
+    };
+
+} // namespace nfc
@@ -0,0 +1,115 @@
+/**
+ * @file RetryPolicy.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Layer-aware retry policy for reader and card exchanges
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "Error/Error.h"
+
+namespace nfc
+{
+    /**
+     * @brief Recovery step, from cheapest to most expensive
+     */
+    enum class RetryAction : uint8_t
+    {
+        Fail,               ///< Not recoverable by retrying
+        ResendFrame,        ///< Host frame never reached the reader: send it again
+        RepeatResponse,     ///< Reader answer corrupted on the host link: NACK so the reader repeats it
+        RestartCommand,     ///< RF exchange failed outside a session: run the command again
+        RecoverSession      ///< RF exchange failed inside a session: re-select, re-authenticate, run again
+    };
+
+    /**
+     * @brief Maximum attempts per recovery step for one exchange
+     */
+    struct RetryLimits
+    {
+        uint8_t frameResends = 2U;
+        uint8_t responseRepeats = 2U;
+        uint8_t commandRestarts = 1U;
+        uint8_t sessionRecoveries = 1U;
+    };
+
+    /**
+     * @brief Retry counters
+     */
+    struct RetryMetrics
+    {
+        uint32_t frameResends = 0U;
+        uint32_t responseRepeats = 0U;
+        uint32_t commandRestarts = 0U;
+        uint32_t sessionRecoveries = 0U;
+        uint32_t recovered = 0U;        ///< Exchanges that succeeded after at least one retry
+        uint32_t exhausted = 0U;        ///< Recoverable failures that ran out of attempts
+    };
+
+    /**
+     * @brief Decides which layer retries a failed exchange
+     *
+     * Link-level steps (ResendFrame, RepeatResponse) are taken by the reader
+     * driver and never reach the card twice. Card-level steps are taken by
+     * DesfireCard for commands that are safe to run again. One policy can be
+     * shared by both so its metrics cover the whole stack.
+     */
+    class RetryPolicy
+    {
+    public:
+        explicit RetryPolicy(const RetryLimits& limits = RetryLimits());
+
+        /**
+         * @brief Classify an error that reached the card layer
+         *
+         * RF errors (PN532 target timeout, CRC, parity, framing, protocol),
+         * their RC522 link equivalents and DESFire integrity/abort statuses are
+         * recoverable; everything else (permissions, missing files, card gone)
+         * fails immediately.
+         *
+         * @param error Error returned by the exchange
+         * @param authenticated True if a secure session was active
+         * @return RetryAction RestartCommand, RecoverSession or Fail
+         */
+        static RetryAction classifyCardError(const error::Error& error, bool authenticated);
+
+        /**
+         * @brief Check whether another attempt of a step is allowed
+         *
+         * @param action Recovery step
+         * @param attempt Attempts of this step already made for the exchange
+         * @return true if the limit has not been reached
+         */
+        bool allows(RetryAction action, uint8_t attempt) const;
+
+        /**
+         * @brief Count an attempt of a recovery step
+         */
+        void recordAttempt(RetryAction action);
+
+        /**
+         * @brief Count an exchange that succeeded after retrying
+         */
+        void recordRecovered();
+
+        /**
+         * @brief Count a recoverable failure that ran out of attempts
+         */
+        void recordExhausted();
+
+        const RetryLimits& limits() const;
+        const RetryMetrics& metrics() const;
+        void resetMetrics();
+
+    private:
+        RetryLimits retryLimits;
+        RetryMetrics retryMetrics;
+    };
+
+} // namespace nfc
@@ -0,0 +1,262 @@
+/**
+ * @file UidHotlist.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief UID hotlist/allowlist image with Bloom-filter front
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <etl/vector.h>
+#include <etl/atomic.h>
+#include <etl/expected.h>
+#include "Error/Error.h"
+
+namespace nfc
+{
+    /**
+     * @brief Hotlist image layout
+     *
+     * The image is a header, a bucket index, a Bloom filter and fixed-size
+     * UID records grouped by hash bucket. It is built once on the back
+     * office side and used in place, so it can be memory-mapped straight
+     * from a file. A lookup tests the Bloom filter and, on a hit, scans one
+     * bucket of about four records: constant time for any list size.
+     *
+     * Header (24 bytes, little endian):
+     *   0  magic "UHL1"
+     *   4  version
+     *   5  Bloom hash count
+     *   6  log2 of the Bloom filter size in bits
+     *   7  log2 of the bucket count
+     *   8  record count (u32)
+     *   12 list sequence number (u32)
+     *   16 reserved, zero
+     *
+     * Each record is the UID length followed by the UID, zero padded to
+     * MAX_UID_LENGTH bytes.
+     */
+    struct UidHotlistFormat
+    {
+        static constexpr uint8_t MAGIC[4] = {'U', 'H', 'L', '1'};
+        static constexpr uint8_t VERSION = 0x01U;
+        static constexpr size_t HEADER_SIZE = 24U;
+        static constexpr size_t MAX_UID_LENGTH = 10U;
+        static constexpr size_t RECORD_SIZE = 1U + MAX_UID_LENGTH;
+        static constexpr uint8_t HASH_COUNT = 7U;
+        static constexpr size_t BLOOM_BITS_PER_ENTRY = 10U;    // ~1% false positives with 7 hashes
+        static constexpr size_t ENTRIES_PER_BUCKET = 4U;
+
+        static constexpr uint8_t ceilLog2(size_t value)
+        {
+            uint8_t bits = 0U;
+            while ((static_cast<size_t>(1U) << bits) < value)
+            {
+                ++bits;
+            }
+            return bits;
+        }
+
+        static constexpr uint8_t bucketLog2(size_t maxEntries)
+        {
+            const uint8_t bits = ceilLog2((maxEntries + ENTRIES_PER_BUCKET - 1U) / ENTRIES_PER_BUCKET);
+            return (bits < 4U) ? 4U : ((bits > 24U) ? 24U : bits);
+        }
+
+        static constexpr uint8_t bloomLog2(size_t maxEntries)
+        {
+            const uint8_t bits = ceilLog2(maxEntries * BLOOM_BITS_PER_ENTRY);
+            return (bits < 10U) ? 10U : ((bits > 31U) ? 31U : bits);
+        }
+
+        static constexpr size_t indexSize(uint8_t bucketBits)
+        {
+            return ((static_cast<size_t>(1U) << bucketBits) + 1U) * 4U;
+        }
+
+        static constexpr size_t bloomSize(uint8_t bloomBits)
+        {
+            return (static_cast<size_t>(1U) << bloomBits) / 8U;
+        }
+
+        static constexpr size_t recordsOffset(uint8_t bucketBits, uint8_t bloomBits)
+        {
+            return HEADER_SIZE + indexSize(bucketBits) + bloomSize(bloomBits);
+        }
+
+        /**
+         * @brief Buffer size needed to build a list of up to maxEntries UIDs
+         */
+        static constexpr size_t imageSize(size_t maxEntries)
+        {
+            return recordsOffset(bucketLog2(maxEntries), bloomLog2(maxEntries)) + (maxEntries * RECORD_SIZE);
+        }
+    };
+
+    /**
+     * @brief Builds a hotlist image into a caller-provided buffer
+     *
+     * UIDs may be added in any order; finish() groups them by bucket, drops
+     * duplicates and fills the index and Bloom filter. Nothing is allocated.
+     */
+    class UidHotlistWriter
+    {
+    public:
+        /**
+         * @brief Construct a writer
+         *
+         * @param buffer Output buffer, at least UidHotlistFormat::imageSize(maxEntries)
+         * @param capacity Buffer size in bytes
+         * @param maxEntries Maximum number of UIDs; fixes the index and filter sizes
+         * @param sequence List sequence number stored in the header
+         */
+        UidHotlistWriter(uint8_t* buffer, size_t capacity, size_t maxEntries, uint32_t sequence);
+
+        /**
+         * @brief Add a UID
+         *
+         * @param uid Card UID (1..10 bytes)
+         * @return etl::expected<void, error::Error> Success, or InvalidParameter/OperationFailed
+         */
+        etl::expected<void, error::Error> addUid(const etl::ivector<uint8_t>& uid);
+
+        /**
+         * @brief Sort the records and write index, filter and header
+         *
+         * @return etl::expected<size_t, error::Error> Image size in bytes
+         */
+        etl::expected<size_t, error::Error> finish();
+
+        /**
+         * @brief Get the number of UIDs added so far
+         */
+        size_t entryCount() const;
+
+    private:
+        uint8_t* buffer;
+        size_t capacity;
+        size_t maxEntries;
+        uint32_t sequence;
+        uint8_t bucketBits;
+        uint8_t bloomBits;
+        size_t count;
+    };
+
+    /**
+     * @brief Read-only view of a hotlist image
+     *
+     * Does not copy the image; the buffer must outlive the view.
+     */
+    class UidHotlistView
+    {
+    public:
+        UidHotlistView() = default;
+
+        /**
+         * @brief Validate and attach to an image
+         *
+         * @param image Image bytes
+         * @param size Image size
+         * @return etl::expected<void, error::Error> Success, or InvalidParameter for a malformed image
+         */
+        etl::expected<void, error::Error> open(const uint8_t* image, size_t size);
+
+        /**
+         * @brief Check whether a UID is on the list
+         *
+         * @param uid Card UID
+         * @param length UID length
+         * @return true if the UID is listed
+         */
+        bool contains(const uint8_t* uid, size_t length) const;
+
+        bool isOpen() const;
+        size_t size() const;
+        uint32_t sequence() const;
+
+    private:
+        const uint8_t* index = nullptr;
+        const uint8_t* bloom = nullptr;
+        const uint8_t* records = nullptr;
+        size_t count = 0U;
+        uint32_t listSequence = 0U;
+        uint8_t bucketBits = 0U;
+        uint8_t bloomBits = 0U;
+        uint8_t hashCount = 0U;
+    };
+
+    /**
+     * @brief How CardManager applies a hotlist
+     */
+    enum class UidHotlistMode : uint8_t
+    {
+        Denylist,   ///< Listed cards are rejected; without a list every card passes
+        Allowlist   ///< Only listed cards pass; without a list every card is rejected
+    };
+
+    /**
+     * @brief Hot-swappable hotlist consulted at detection time
+     *
+     * Holds two image slots. publish() opens the new image in the idle slot
+     * and switches readers over with one atomic store; lookups never wait.
+     * The previous image stays in use by readers that started before the
+     * switch, so its buffer may only be unmapped or reused once
+     * isPreviousReleased() returns true. There must be a single publisher.
+     */
+    class UidHotlist
+    {
+    public:
+        explicit UidHotlist(UidHotlistMode mode = UidHotlistMode::Denylist);
+
+        /**
+         * @brief Switch lookups to a new image
+         *
+         * @param image Image bytes (e.g. a read-only mapping of the list file)
+         * @param size Image size
+         * @return etl::expected<void, error::Error> Success, InvalidParameter for a malformed image,
+         *         or OperationFailed while the image published before the current one is still being read
+         */
+        etl::expected<void, error::Error> publish(const uint8_t* image, size_t size);
+
+        /**
+         * @brief Check whether the image replaced by the last publish() is no longer read
+         */
+        bool isPreviousReleased() const;
+
+        /**
+         * @brief Check whether a card may proceed
+         *
+         * @param uid Card UID
+         * @return true if the card passes the list under the configured mode
+         */
+        bool allows(const etl::ivector<uint8_t>& uid) const;
+
+        /**
+         * @brief Check whether a UID is on the current list
+         */
+        bool contains(const etl::ivector<uint8_t>& uid) const;
+
+        /**
+         * @brief Get the sequence number of the current list (0 when none)
+         */
+        uint32_t sequence() const;
+
+        UidHotlistMode mode() const;
+
+    private:
+        uint8_t acquire() const;
+        void release(uint8_t slot) const;
+
+        UidHotlistMode listMode;
+        UidHotlistView slots[2];
+        mutable etl::atomic<uint32_t> readers[2];
+        etl::atomic<uint8_t> active;
+    };
+
+} // namespace nfc
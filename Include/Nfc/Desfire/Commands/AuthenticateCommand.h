@@ -14,6 +14,7 @@
 #include "../IDesfireCommand.h"
 #include "../DesfireKeyType.h"
 #include "../DesfireAuthMode.h"
+#include "../DesfireKeyStore.h"
 #include <etl/vector.h>
 
 namespace nfc
@@ -26,6 +27,9 @@ namespace nfc
         DesfireAuthMode mode;
         uint8_t keyNo;
         etl::vector<uint8_t, 24> key;
+
+        /// Key from a DesfireKeyStore; when set, `key` is ignored and may stay empty
+        const DesfireStoredKey* storedKey = nullptr;
     };
 
     /**
@@ -93,6 +97,11 @@ namespace nfc
          */
         void reset() override;
 
+        /**
+         * @brief A fresh authentication replaces any half-finished one
+         */
+        bool isReplaySafe() const override;
+
     private:
         /**
          * @brief Determine if authentication keying should use DES-style session key derivation.
@@ -113,6 +122,20 @@ namespace nfc
          */
         bool usesThreeKey3DesSessionKey() const;
 
+        /**
+         * @brief Get the active key bytes (stored key or options.key)
+         *
+         * @return const uint8_t* Key bytes
+         */
+        const uint8_t* keyBytes() const;
+
+        /**
+         * @brief Get the active key length (stored key or options.key)
+         *
+         * @return size_t Key length in bytes
+         */
+        size_t keyLength() const;
+
         /**
          * @brief Get challenge/random size for current authentication mode
          *
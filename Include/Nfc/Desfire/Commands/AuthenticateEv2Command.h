@@ -0,0 +1,132 @@
+/**
+ * @file AuthenticateEv2Command.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief DESFire AuthenticateEV2First / AuthenticateEV2NonFirst command
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include "../IDesfireCommand.h"
+#include "../DesfireKeyStore.h"
+#include <etl/vector.h>
+
+namespace nfc
+{
+    /**
+     * @brief AuthenticateEV2 command options
+     */
+    struct AuthenticateEv2CommandOptions
+    {
+        uint8_t keyNo = 0U;
+        etl::vector<uint8_t, 16> key;
+
+        /// AES key from a DesfireKeyStore; when set, `key` is ignored and may stay empty
+        const DesfireStoredKey* storedKey = nullptr;
+
+        /// AuthenticateEV2NonFirst: switch keys inside the running EV2 transaction
+        bool nonFirst = false;
+    };
+
+    /**
+     * @brief AuthenticateEV2First (0x71) / AuthenticateEV2NonFirst (0x77)
+     *
+     * AES authentication of DESFire EV2/EV3 cards in EV2 secure messaging.
+     * First starts a transaction: the card returns a new transaction
+     * identifier (TI) and the command counter starts at 0. NonFirst only
+     * replaces the session keys; TI and counter carry on, and the card skips
+     * the capability exchange, so switching keys between files is one
+     * cryptogram shorter. NonFirst requires an EV2 session in the selected
+     * application and fails with InvalidState otherwise.
+     */
+    class AuthenticateEv2Command : public IDesfireCommand
+    {
+    public:
+        static constexpr uint8_t FIRST_COMMAND_CODE = 0x71U;
+        static constexpr uint8_t NON_FIRST_COMMAND_CODE = 0x77U;
+
+        /**
+         * @brief Authentication stage
+         */
+        enum class Stage : uint8_t
+        {
+            Initial,
+            ChallengeSent,
+            Complete
+        };
+
+        /**
+         * @brief Construct authenticate EV2 command
+         *
+         * @param options Authentication options
+         */
+        explicit AuthenticateEv2Command(const AuthenticateEv2CommandOptions& options);
+
+        /**
+         * @brief Get command name
+         *
+         * @return etl::string_view Command name
+         */
+        etl::string_view name() const override;
+
+        /**
+         * @brief Build the request
+         *
+         * @param context DESFire context
+         * @return etl::expected<DesfireRequest, error::Error> Request or error
+         */
+        etl::expected<DesfireRequest, error::Error> buildRequest(const DesfireContext& context) override;
+
+        /**
+         * @brief Parse the response
+         *
+         * @param response Response data
+         * @param context DESFire context
+         * @return etl::expected<DesfireResult, error::Error> Result or error
+         */
+        etl::expected<DesfireResult, error::Error> parseResponse(
+            const etl::ivector<uint8_t>& response,
+            DesfireContext& context) override;
+
+        /**
+         * @brief Check if command is complete
+         *
+         * @return true Command completed
+         * @return false More frames needed
+         */
+        bool isComplete() const override;
+
+        /**
+         * @brief Reset command state
+         */
+        void reset() override;
+
+        /**
+         * @brief A fresh authentication replaces any half-finished one
+         */
+        bool isReplaySafe() const override;
+
+        /**
+         * @brief PICC capabilities (PDcap2) returned by AuthenticateEV2First
+         *
+         * @return const etl::ivector<uint8_t>& 6 bytes after a First authentication, empty otherwise
+         */
+        const etl::ivector<uint8_t>& getPiccCapabilities() const;
+
+    private:
+        const etl::ivector<uint8_t>& keyBytes() const;
+        void crypt(uint8_t* data, size_t length, bool encrypt) const;
+
+        AuthenticateEv2CommandOptions options;
+        Stage stage;
+        etl::vector<uint8_t, 16> rndA;
+        etl::vector<uint8_t, 16> rndB;
+        etl::vector<uint8_t, 32> encryptedResponse;
+        etl::vector<uint8_t, 6> piccCapabilities;
+    };
+
+} // namespace nfc
@@ -14,6 +14,7 @@
 #include "../IDesfireCommand.h"
 #include "../DesfireKeyType.h"
 #include "../DesfireAuthMode.h"
+#include "../DesfireKeyStore.h"
 #include "Nfc/Desfire/SecureMessagingPolicy.h"
 #include <etl/vector.h>
 #include <etl/optional.h>
@@ -26,6 +27,23 @@ namespace nfc
         SessionEncryptedRndB // Seed SEND_MODE with first 8 bytes of encrypted RndB from auth
     };
 
+    /**
+     * @brief Session-independent part of a ChangeKey cryptogram
+     * 
+     * Key stream (new key, or new XOR old key), AES key version and CRCs,
+     * before padding and session encryption. Produced by
+     * ChangeKeyCommand::precompute() so the tap only has to encrypt.
+     */
+    struct ChangeKeyPrecomputedCryptogram
+    {
+        uint8_t effectiveKeyNo = 0U;       // Key number including PICC key type flags
+        bool sameKey = false;              // Cryptogram targets the authenticated key
+        DesfireAuthMode authMode = DesfireAuthMode::ISO;
+        DesfireKeyType newKeyType = DesfireKeyType::UNKNOWN;
+        uint8_t newKeyVersion = 0U;
+        etl::vector<uint8_t, 33> plaintext;
+    };
+
     /**
      * @brief Change key command options
      */
@@ -40,6 +58,15 @@ namespace nfc
         uint8_t newKeyVersion;
         etl::optional<etl::vector<uint8_t, 24>> oldKey;
         ChangeKeyLegacyIvMode legacyIvMode = ChangeKeyLegacyIvMode::Zero;
+
+        /// New key from a DesfireKeyStore; overrides newKey, newKeyType and newKeyVersion
+        const DesfireStoredKey* newStoredKey = nullptr;
+
+        /// Old key from a DesfireKeyStore; overrides oldKey and oldKeyType
+        const DesfireStoredKey* oldStoredKey = nullptr;
+
+        /// Precomputed cryptogram; replaces all key material and overrides authMode
+        const ChangeKeyPrecomputedCryptogram* precomputed = nullptr;
     };
 
     /**
@@ -66,6 +93,19 @@ namespace nfc
          */
         explicit ChangeKeyCommand(const ChangeKeyCommandOptions& options);
 
+        /**
+         * @brief Precompute the session-independent part of the cryptogram
+         * 
+         * @param options Change key options (key material, key number, auth mode)
+         * @param piccSelected Cryptogram is for the PICC master key
+         * @param authenticatedKeyNo Key number the session will authenticate with
+         * @return etl::expected<ChangeKeyPrecomputedCryptogram, error::Error> Cryptogram or error
+         */
+        static etl::expected<ChangeKeyPrecomputedCryptogram, error::Error> precompute(
+            const ChangeKeyCommandOptions& options,
+            bool piccSelected,
+            uint8_t authenticatedKeyNo);
+
         /**
          * @brief Get command name
          * 
@@ -114,6 +154,25 @@ namespace nfc
          */
         etl::expected<etl::vector<uint8_t, 48>, error::Error> buildKeyCryptogram(const DesfireContext& context);
 
+        /**
+         * @brief Resolve the key number byte sent on the wire
+         * 
+         * @param piccSelected PICC application is selected
+         * @return etl::expected<uint8_t, error::Error> Key number with PICC key type flags
+         */
+        etl::expected<uint8_t, error::Error> resolveEffectiveKeyNo(bool piccSelected) const;
+
+        /**
+         * @brief Build the plaintext cryptogram (key stream and CRCs, unpadded)
+         * 
+         * @param keyNo Effective key number
+         * @param sameKey Target key is the authenticated key
+         * @return etl::expected<etl::vector<uint8_t, 33>, error::Error> Plaintext cryptogram or error
+         */
+        etl::expected<etl::vector<uint8_t, 33>, error::Error> buildPlaintextCryptogram(
+            uint8_t keyNo,
+            bool sameKey) const;
+
         /**
          * @brief Get key size for key type
          * 
@@ -78,6 +78,11 @@ namespace nfc
          */
         void reset() override;
 
+        /**
+         * @brief Read-only; safe to run again after a failed exchange
+         */
+        bool isReplaySafe() const override;
+
         /**
          * @brief Get parsed free-memory value in bytes
          *
@@ -92,6 +92,11 @@ namespace nfc
          */
         void reset() override;
 
+        /**
+         * @brief Read-only; safe to run again after a failed exchange
+         */
+        bool isReplaySafe() const override;
+
         /**
          * @brief Get requested file number
          *
@@ -101,9 +101,17 @@ namespace nfc
          */
         void reset() override;
 
+        /**
+         * @brief Read-only; safe to run again after a failed exchange
+         */
+        bool isReplaySafe() const override;
+
         /**
          * @brief Get accumulated read data
          *
+         * Holds only verified chunks, so after a failed exchange it is the
+         * prefix that an interrupted read can be resumed after.
+         *
          * @return const etl::vector<uint8_t, MAX_READ_DATA_SIZE>& Read data bytes
          */
         const etl::vector<uint8_t, MAX_READ_DATA_SIZE>& getData() const;
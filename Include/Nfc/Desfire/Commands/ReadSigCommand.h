@@ -0,0 +1,105 @@
+/**
+ * @file ReadSigCommand.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief DESFire read originality signature command
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include "../IDesfireCommand.h"
+#include <etl/vector.h>
+
+namespace nfc
+{
+    /**
+     * @brief Read_Sig command
+     *
+     * Executes Read_Sig (INS 0x3C, address 0x00) on DESFire EV2 and later,
+     * DESFire Light and NTAG 424 DNA. The card returns the 56 byte NXP
+     * originality signature (r || s over secp224r1). Outside a session the
+     * signature comes back plain; in an AES session it is encrypted with
+     * a CRC32 and is decrypted here. Other session types are read as plain.
+     */
+    class ReadSigCommand : public IDesfireCommand
+    {
+    public:
+        static constexpr size_t SIGNATURE_LENGTH = 56U;
+
+        /**
+         * @brief Command stage
+         */
+        enum class Stage : uint8_t
+        {
+            Initial,
+            Complete
+        };
+
+        /**
+         * @brief Construct Read_Sig command
+         */
+        ReadSigCommand();
+
+        /**
+         * @brief Get command name
+         *
+         * @return etl::string_view Command name
+         */
+        etl::string_view name() const override;
+
+        /**
+         * @brief Build request
+         *
+         * @param context DESFire context
+         * @return etl::expected<DesfireRequest, error::Error> Request or error
+         */
+        etl::expected<DesfireRequest, error::Error> buildRequest(const DesfireContext& context) override;
+
+        /**
+         * @brief Parse response
+         *
+         * @param response Response data
+         * @param context DESFire context
+         * @return etl::expected<DesfireResult, error::Error> Result or error
+         */
+        etl::expected<DesfireResult, error::Error> parseResponse(
+            const etl::ivector<uint8_t>& response,
+            DesfireContext& context) override;
+
+        /**
+         * @brief Check if command is complete
+         *
+         * @return true Command completed
+         * @return false More frames needed
+         */
+        bool isComplete() const override;
+
+        /**
+         * @brief Reset command state
+         */
+        void reset() override;
+
+        /**
+         * @brief Read-only; safe to run again after a failed exchange
+         */
+        bool isReplaySafe() const override;
+
+        /**
+         * @brief Get the signature
+         *
+         * @return const etl::vector<uint8_t, SIGNATURE_LENGTH>& r || s, big endian
+         */
+        const etl::vector<uint8_t, SIGNATURE_LENGTH>& getSignature() const;
+
+    private:
+        bool tryDecodeEncryptedSignature(const etl::ivector<uint8_t>& payload, DesfireContext& context);
+
+        Stage stage;
+        etl::vector<uint8_t, SIGNATURE_LENGTH> signature;
+    };
+
+} // namespace nfc
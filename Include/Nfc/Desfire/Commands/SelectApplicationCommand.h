@@ -71,6 +71,11 @@ namespace nfc
          */
         void reset() override;
 
+        /**
+         * @brief Selecting the same application again yields the same state
+         */
+        bool isReplaySafe() const override;
+
     private:
         etl::array<uint8_t, 3> aid;
         bool complete;
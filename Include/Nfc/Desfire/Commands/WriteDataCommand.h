@@ -26,6 +26,7 @@ namespace nfc
         const etl::ivector<uint8_t>* data;
         uint16_t chunkSize;
         uint8_t communicationSettings = 0xFFU; // 0x00 plain, 0x01 mac, 0x03 enc, 0xFF auto
+        size_t resumeIndex = 0U; // First data byte to write; earlier bytes were already acknowledged
     };
 
     /**
@@ -96,6 +97,16 @@ namespace nfc
          */
         void reset() override;
 
+        /**
+         * @brief Get number of data bytes acknowledged by the card
+         *
+         * Includes options.resumeIndex. Valid after a failed exchange too, so
+         * an interrupted write can be resumed from this index.
+         *
+         * @return size_t Acknowledged byte count
+         */
+        size_t getWrittenLength() const;
+
     private:
         enum class SessionCipher : uint8_t
         {
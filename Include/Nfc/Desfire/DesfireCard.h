@@ -18,6 +18,11 @@
 #include "DesfireContext.h"
 #include "DesfireAuthMode.h"
 #include "DesfireKeyType.h"
+#include "DesfireKeyStore.h"
+#include "DesfireReadPlan.h"
+#include "SecureMessagingCodec.h"
+#include "Nfc/Card/CardInfo.h"
+#include "Nfc/Card/RetryPolicy.h"
 #include "Error/Error.h"
 
 namespace nfc
@@ -52,6 +57,32 @@ namespace nfc
         uint32_t currentRecords = 0U;
     };
 
+    /**
+     * @brief Progress of a chunked ReadData/WriteData that failed part-way
+     *
+     * Filled by the resumable readData/writeData overloads when a transfer
+     * fails. Only chunks the card confirmed are counted: read chunks after
+     * their MAC/CRC was verified, write chunks after the card acknowledged
+     * them. Passing the token back for the same file, range and application
+     * continues after the last confirmed chunk.
+     *
+     * No secure-messaging state is kept. A failed exchange drops the session
+     * on the card, so the caller re-authenticates and the remaining chunks
+     * run under the new session keys.
+     */
+    struct DesfireTransferToken
+    {
+        static constexpr size_t MAX_DATA_SIZE = 4096U;
+
+        bool valid = false;
+        uint8_t fileNo = 0U;
+        uint32_t offset = 0U;           ///< Start offset of the whole transfer
+        uint32_t length = 0U;           ///< Length of the whole transfer
+        uint32_t completed = 0U;        ///< Bytes confirmed by the card
+        etl::vector<uint8_t, 3> aid;    ///< Application selected when the transfer started
+        etl::vector<uint8_t, MAX_DATA_SIZE> data;   ///< Bytes read so far (reads only)
+    };
+
     // Forward declarations
     class ISecurePipe;
     class PlainPipe;
@@ -93,11 +124,22 @@ namespace nfc
         /**
          * @brief Execute a DESFire command
          * 
+         * With a retry policy set, replay-safe commands that fail on an RF or
+         * integrity error are run again; inside a session authenticated through
+         * a key store the application is re-selected and re-authenticated first.
+         * 
          * @param command Command to execute
          * @return etl::expected<void, error::Error> Success or error
          */
         etl::expected<void, error::Error> executeCommand(IDesfireCommand& command);
 
+        /**
+         * @brief Set the card-level retry policy
+         *
+         * @param policy Policy to consult and update, or nullptr to disable retries
+         */
+        void setRetryPolicy(RetryPolicy* policy);
+
         /**
          * @brief Select application
          * 
@@ -119,6 +161,53 @@ namespace nfc
             const etl::vector<uint8_t, 24>& key,
             DesfireAuthMode mode);
 
+        /**
+         * @brief Authenticate with a key registered in a key store
+         * 
+         * Uses the store's cached parity-normalised key and AES schedule; the
+         * key bytes are not copied into the command.
+         * 
+         * @param keyNo Key number
+         * @param keyStore Store holding the key
+         * @param keyHandle Handle returned by DesfireKeyStore::registerKey
+         * @param mode Authentication mode
+         * @return etl::expected<void, error::Error> Success, or NoSuchKey for stale handles
+         */
+        etl::expected<void, error::Error> authenticate(
+            uint8_t keyNo,
+            const DesfireKeyStore& keyStore,
+            DesfireKeyHandle keyHandle,
+            DesfireAuthMode mode);
+
+        /**
+         * @brief Authenticate with AuthenticateEV2First or AuthenticateEV2NonFirst
+         * 
+         * Starts an EV2 transaction, or switches to another key with NonFirst
+         * when an EV2 session is already running in the selected application;
+         * NonFirst keeps the transaction identifier and command counter.
+         * Exchange data in the session through wrapRequest()/unwrapResponse().
+         * 
+         * @param keyNo Key number
+         * @param key 16-byte AES key
+         * @return etl::expected<void, error::Error> Success or error
+         */
+        etl::expected<void, error::Error> authenticateEv2(
+            uint8_t keyNo,
+            const etl::vector<uint8_t, 16>& key);
+
+        /**
+         * @brief EV2 authentication with a key registered in a key store
+         * 
+         * @param keyNo Key number
+         * @param keyStore Store holding the AES key
+         * @param keyHandle Handle returned by DesfireKeyStore::registerKey
+         * @return etl::expected<void, error::Error> Success, or NoSuchKey for stale handles
+         */
+        etl::expected<void, error::Error> authenticateEv2(
+            uint8_t keyNo,
+            const DesfireKeyStore& keyStore,
+            DesfireKeyHandle keyHandle);
+
         /**
          * @brief Create a DESFire application
          *
@@ -409,6 +498,53 @@ namespace nfc
             const etl::ivector<uint8_t>& data,
             uint16_t chunkSize = 0U);
 
+        /**
+         * @brief Read data bytes, resuming a previously interrupted read
+         *
+         * If the token holds progress for the same file, range and
+         * application, only the remaining bytes are read. On failure the
+         * token is updated with the verified bytes so far; on success it is
+         * cleared.
+         *
+         * @param fileNo File number (0..31)
+         * @param offset Start offset (24-bit)
+         * @param length Number of bytes to read (1..MAX_DATA_IO_SIZE)
+         * @param chunkSize Max bytes per command cycle (0 uses default)
+         * @param token Resume token, updated in place
+         * @return etl::expected<etl::vector<uint8_t, MAX_DATA_IO_SIZE>, error::Error> Data or error
+         */
+        etl::expected<etl::vector<uint8_t, MAX_DATA_IO_SIZE>, error::Error> readData(
+            uint8_t fileNo,
+            uint32_t offset,
+            uint32_t length,
+            uint16_t chunkSize,
+            DesfireTransferToken& token);
+
+        /**
+         * @brief Write data bytes, resuming a previously interrupted write
+         *
+         * If the token holds progress for the same file, range and
+         * application, writing continues after the last acknowledged chunk.
+         * The caller must pass the same data as the interrupted call.
+         * Backup data files always restart at the first byte: the lost
+         * session aborted the transaction, so the card dropped the chunks
+         * it had acknowledged. So does a file whose settings could not be
+         * read, since it may be a backup file.
+         *
+         * @param fileNo File number (0..31)
+         * @param offset Start offset (24-bit)
+         * @param data Data bytes to write
+         * @param chunkSize Max bytes per command cycle (0 uses default)
+         * @param token Resume token, updated in place
+         * @return etl::expected<void, error::Error> Success or error
+         */
+        etl::expected<void, error::Error> writeData(
+            uint8_t fileNo,
+            uint32_t offset,
+            const etl::ivector<uint8_t>& data,
+            uint16_t chunkSize,
+            DesfireTransferToken& token);
+
         /**
          * @brief Read records from a linear/cyclic record file
          *
@@ -453,6 +589,27 @@ namespace nfc
             const etl::ivector<uint8_t>& data,
             uint16_t chunkSize = 0U);
 
+        /**
+         * @brief Read several files of the selected application in one call
+         *
+         * Entries answered by the result set from an earlier call for the
+         * same card UID are not sent to the card. The rest are reordered so that each read key is
+         * authenticated at most once: files of the key the session already
+         * holds first, then free-access files, then the other keys in plan
+         * order. Each file is read in its own communication mode; MAC-mode
+         * reads use the plain path, which verifies the response CMAC in
+         * AES/ISO sessions. A failed entry does not stop the others; the
+         * session is rebuilt for the next one since the card dropped it.
+         *
+         * @param plan Files to read
+         * @param results Result set, filled in plan order
+         * @return etl::expected<DesfireReadPlanMetrics, error::Error> Counters, or
+         *         ParameterError for an empty or oversized plan
+         */
+        etl::expected<DesfireReadPlanMetrics, error::Error> readFiles(
+            const DesfireReadPlan& plan,
+            DesfireReadResultSet& results);
+
         /**
          * @brief Get DESFire version payload bytes
          *
@@ -463,6 +620,18 @@ namespace nfc
          */
         etl::expected<etl::vector<uint8_t, 96>, error::Error> getVersion();
 
+        /**
+         * @brief Resolve the card generation, using GetVersion only if needed
+         *
+         * Returns the generation inferred from the ATS at detection time
+         * when it is unambiguous. Otherwise runs GetVersion and stores the
+         * result in the card info, so later calls for the same tap are free.
+         *
+         * @param info Card info from detection, updated in place
+         * @return etl::expected<CardGeneration, error::Error> Generation or error
+         */
+        etl::expected<CardGeneration, error::Error> resolveGeneration(CardInfo& info);
+
         /**
          * @brief Format the PICC (erase all applications/files)
          *
@@ -589,25 +758,110 @@ namespace nfc
         etl::expected<etl::vector<uint8_t, 10>, error::Error> getRealCardUid();
 
         /**
-         * @brief Wrap a DESFire request using the appropriate pipe
-         * 
+         * @brief Read the NXP originality signature
+         *
+         * Runs Read_Sig (INS 0x3C). Verify the result against the card UID
+         * with OriginalitySignatureVerifier.
+         *
+         * @return etl::expected<etl::vector<uint8_t, 56>, error::Error> Signature (r || s) or error
+         */
+        etl::expected<etl::vector<uint8_t, 56>, error::Error> readSignature();
+
+        /**
+         * @brief Wrap a DESFire request for the current session
+         *
+         * Protects the request data according to the context comm mode with
+         * SecureMessagingCodec and advances the session state. The request's
+         * header bytes stay plain; its responseMode tells the matching
+         * unwrapResponse() call how the answer is protected.
+         *
          * @param request Request to wrap
          * @return etl::expected<etl::vector<uint8_t, 261>, error::Error> Wrapped data or error
          */
         etl::expected<etl::vector<uint8_t, 261>, error::Error> wrapRequest(const DesfireRequest& request);
 
         /**
-         * @brief Unwrap a response using the appropriate pipe
-         * 
+         * @brief Unwrap the response to the last wrapRequest()
+         *
          * @param response Response to unwrap
          * @return etl::expected<DesfireResult, error::Error> Unwrapped result or error
          */
         etl::expected<DesfireResult, error::Error> unwrapResponse(const etl::ivector<uint8_t>& response);
 
+        /**
+         * @brief Wrap a request against a given session state
+         *
+         * Same protection as wrapRequest(), but the card's session is left
+         * alone. Lets a caller protect a request ahead of time, against the
+         * state the session is expected to reach; adoptRequest() puts the
+         * result into effect.
+         *
+         * @param request Request to wrap
+         * @param state Session state to wrap against
+         * @return etl::expected<WrappedCommand, error::Error> Wrapped command or error
+         */
+        etl::expected<WrappedCommand, error::Error> previewRequest(
+            const DesfireRequest& request,
+            const DesfireContext& state) const;
+
+        /**
+         * @brief Put a request from previewRequest() into effect
+         *
+         * Behaves as wrapRequest() would have, provided the session is
+         * still in the state the request was wrapped against.
+         *
+         * @param wrapped Result of previewRequest()
+         * @param origin State passed to previewRequest()
+         * @return etl::expected<etl::vector<uint8_t, 261>, error::Error> Wrapped data, or
+         *         InvalidState when the session is no longer in origin
+         */
+        etl::expected<etl::vector<uint8_t, 261>, error::Error> adoptRequest(
+            const WrappedCommand& wrapped,
+            const DesfireContext& origin);
+
     private:
+        /**
+         * @brief Key-store authentication that a lost session can be rebuilt from
+         */
+        struct SessionCredentials
+        {
+            bool valid = false;
+            const DesfireKeyStore* keyStore = nullptr;
+            DesfireKeyHandle keyHandle;
+            DesfireAuthMode mode = DesfireAuthMode::ISO;
+            uint8_t keyNo = 0U;
+            etl::vector<uint8_t, 3> aid;
+        };
+
+        etl::expected<void, error::Error> runCommand(IDesfireCommand& command);
+        etl::expected<void, error::Error> recoverSession();
+        etl::expected<uint8_t, error::Error> resolveDataCommunicationSettings(
+            uint8_t fileNo,
+            uint32_t offset,
+            uint32_t length,
+            uint8_t* fileType = nullptr);  // 0xFF when the settings could not be read
+        etl::expected<void, error::Error> readPlanEntry(
+            const DesfireReadPlanEntry& entry,
+            DesfireReadResultSet& results,
+            DesfireFileReadResult& result,
+            DesfireReadPlanMetrics& metrics);
+        etl::expected<void, error::Error> prepareForPlanEntry(
+            const DesfireReadPlan& plan,
+            const DesfireReadPlanEntry& entry,
+            bool& sessionLost,
+            DesfireReadPlanMetrics& metrics);
+        void prepareTransferToken(
+            DesfireTransferToken& token,
+            uint8_t fileNo,
+            uint32_t offset,
+            uint32_t length) const;
+
         IApduTransceiver& transceiver;
         DesfireContext context;
         IWire* wire;  // Wire strategy for APDU framing
+        RetryPolicy* retryPolicy;
+        SessionCredentials sessionCredentials;
+        SecureResponseExpectation pendingResponse;  // set by wrapRequest()
 
         PlainPipe* plainPipe;
         MacPipe* macPipe;
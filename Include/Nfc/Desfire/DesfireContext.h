@@ -34,7 +34,8 @@ namespace nfc
         None = 0x00,
         Legacy = 0x0A,
         Iso = 0x1A,
-        Aes = 0xAA
+        Aes = 0xAA,
+        Ev2 = 0x71      // AuthenticateEV2First/NonFirst, EV2 secure messaging
     };
 
     /**
@@ -53,6 +54,9 @@ namespace nfc
         etl::vector<uint8_t, 16> iv;             // Initialization vector
         etl::vector<uint8_t, 16> sessionEncRndB; // Raw encrypted RndB from last successful authenticate
         
+        etl::vector<uint8_t, 4> transactionId;   // EV2 transaction identifier (TI)
+        uint16_t commandCounter = 0;              // EV2 command counter (CmdCtr)
+
         uint8_t keyNo = 0;                        // Current authenticated key number
         etl::vector<uint8_t, 3> selectedAid;     // Selected application ID
     };
@@ -0,0 +1,133 @@
+/**
+ * @file DesfireCryptoBatch.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Multi-buffer crypto service for DESFire sessions
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <etl/vector.h>
+#include <etl/expected.h>
+#include "DesfireContext.h"
+#include "Error/Error.h"
+
+namespace nfc
+{
+    /**
+     * @brief Kind of crypto job queued in a DesfireCryptoBatch
+     */
+    enum class DesfireCryptoJobKind : uint8_t
+    {
+        AesCbcEncrypt,
+        AesCbcDecrypt,
+        AesCmac,
+        TdesCbcEncrypt,
+        TdesCbcDecrypt
+    };
+
+    /**
+     * @brief Single crypto job
+     *
+     * All buffers are owned by the caller and must stay valid until
+     * DesfireCryptoBatch::process() returns. CBC jobs work in place on
+     * @c data. The chaining value in @c iv is updated the same way a single
+     * DESFire session would update it: last ciphertext block for CBC, the
+     * full MAC for CMAC.
+     */
+    struct DesfireCryptoJob
+    {
+        DesfireCryptoJobKind kind = DesfireCryptoJobKind::AesCbcEncrypt;
+        const uint8_t* key = nullptr;
+        size_t keyLength = 0U;      // 16 for AES, 16 or 24 for 3DES
+        uint8_t* iv = nullptr;      // 16 bytes for AES, 8 bytes for 3DES
+        uint8_t* data = nullptr;    // in place for CBC, message for CMAC
+        size_t length = 0U;         // block multiple for CBC
+        uint8_t* mac = nullptr;     // 16 byte CMAC output (AesCmac only)
+    };
+
+    /**
+     * @brief Collects independent crypto jobs and processes them interleaved
+     *
+     * A multi-reader host runs many sessions that each encrypt or MAC only a
+     * few blocks at a time. Queueing those jobs here and running them
+     * together keeps the AES pipeline busy: blocks of different jobs do not
+     * depend on each other, so each AES round is issued for several lanes
+     * before moving to the next round.
+     *
+     * When built with NFCCPP_USE_AESNI the AES jobs run on AES-NI in
+     * groups of AES_LANES. Otherwise every lane uses the portable tiny-aes
+     * block functions with a key schedule expanded once per job. 3DES jobs
+     * are always processed with the portable implementation.
+     */
+    class DesfireCryptoBatch
+    {
+    public:
+        static constexpr size_t MAX_JOBS = 16U;
+        static constexpr size_t AES_LANES = 4U;
+
+        /**
+         * @brief Queue a job
+         *
+         * Jobs sharing an IV buffer with a queued job are rejected with
+         * DuplicateError, a full batch with CountError.
+         *
+         * @param job Job description
+         * @return etl::expected<size_t, error::Error> Index of the job in the batch
+         */
+        etl::expected<size_t, error::Error> submit(const DesfireCryptoJob& job);
+
+        /**
+         * @brief Queue a job using the session key and IV of a DESFire context
+         *
+         * The context IV is updated by process(). A second job for the same
+         * context depends on that IV and is rejected with DuplicateError; it
+         * belongs in the next batch.
+         *
+         * @param context Authenticated session
+         * @param kind Job kind, must match the session cipher
+         * @param data Payload (in place for CBC)
+         * @param length Payload length
+         * @param mac CMAC output for AesCmac jobs
+         * @return etl::expected<size_t, error::Error> Index of the job in the batch
+         */
+        etl::expected<size_t, error::Error> submit(
+            DesfireContext& context,
+            DesfireCryptoJobKind kind,
+            uint8_t* data,
+            size_t length,
+            uint8_t* mac = nullptr);
+
+        /**
+         * @brief Run all queued jobs and empty the batch
+         *
+         * @return size_t Number of jobs processed
+         */
+        size_t process();
+
+        /**
+         * @brief Drop all queued jobs without running them
+         */
+        void clear();
+
+        /**
+         * @brief Get the number of queued jobs
+         */
+        size_t size() const;
+
+        /**
+         * @brief Check whether AES jobs run on AES-NI in this build
+         */
+        static bool hardwareAccelerated();
+
+    private:
+        etl::vector<DesfireCryptoJob, MAX_JOBS> jobs;
+    };
+
+} // namespace nfc
@@ -0,0 +1,166 @@
+/**
+ * @file DesfireKeyStore.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief DESFire key store with opaque key handles
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <etl/array.h>
+#include <etl/vector.h>
+#include <etl/expected.h>
+#include "DesfireKeyType.h"
+#include "Error/Error.h"
+
+namespace nfc
+{
+    class DesfireKeyStore;
+
+    /**
+     * @brief Opaque reference to a key registered in a DesfireKeyStore
+     * 
+     * Handles carry a slot generation, so a handle becomes invalid once its
+     * key is released, even if the slot is reused for another key.
+     */
+    class DesfireKeyHandle
+    {
+    public:
+        DesfireKeyHandle() = default;
+
+        /**
+         * @brief Check if the handle was issued by a key store
+         * 
+         * @return true Handle refers to a slot (may still be stale)
+         * @return false Default-constructed handle
+         */
+        bool isValid() const
+        {
+            return value != 0U;
+        }
+
+        bool operator==(const DesfireKeyHandle& other) const
+        {
+            return value == other.value;
+        }
+
+        bool operator!=(const DesfireKeyHandle& other) const
+        {
+            return value != other.value;
+        }
+
+    private:
+        explicit DesfireKeyHandle(uint16_t value)
+            : value(value)
+        {
+        }
+
+        uint16_t value = 0U;  // (generation << 8) | (slot + 1)
+
+        friend class DesfireKeyStore;
+    };
+
+    /**
+     * @brief Key material cached by the key store
+     * 
+     * Everything that authentication and ChangeKey would otherwise re-derive
+     * on every call is computed once at registration.
+     */
+    struct DesfireStoredKey
+    {
+        /// AES-128 expanded key schedule size (11 round keys of 16 bytes)
+        static constexpr size_t AES_ROUND_KEY_SIZE = 176U;
+
+        DesfireKeyType type = DesfireKeyType::UNKNOWN;
+        uint8_t version = 0U;
+
+        /// Key bytes; DES/3DES keys have their parity/version bits cleared
+        etl::vector<uint8_t, 24> key;
+
+        /// 8-byte DES key, or 16-byte key with K1 == K2 (ignoring parity bits)
+        bool singleDesKey = false;
+
+        /// AES expanded key schedule (valid when type is AES)
+        bool hasAesSchedule = false;
+        etl::array<uint8_t, AES_ROUND_KEY_SIZE> aesRoundKeys{};
+    };
+
+    /**
+     * @brief Fixed-capacity key store
+     * 
+     * Keys are registered once and referenced by handle afterwards, so key
+     * bytes are not copied into command options or request buffers. Released
+     * slots and the whole store on destruction are zeroised.
+     */
+    class DesfireKeyStore
+    {
+    public:
+        static constexpr size_t MAX_KEYS = 16U;
+
+        DesfireKeyStore();
+        ~DesfireKeyStore();
+
+        DesfireKeyStore(const DesfireKeyStore&) = delete;
+        DesfireKeyStore& operator=(const DesfireKeyStore&) = delete;
+
+        /**
+         * @brief Register a key and precompute its cipher state
+         * 
+         * @param type Key type (DES keys may be 8 or 16 bytes, K1 == K2)
+         * @param key Raw key bytes
+         * @param version Key version (stored alongside the key)
+         * @return etl::expected<DesfireKeyHandle, error::Error> Handle or error
+         */
+        etl::expected<DesfireKeyHandle, error::Error> registerKey(
+            DesfireKeyType type,
+            const etl::ivector<uint8_t>& key,
+            uint8_t version = 0U);
+
+        /**
+         * @brief Release a key and zeroise its slot
+         * 
+         * @param handle Key handle
+         * @return etl::expected<void, error::Error> Success, or NoSuchKey for stale handles
+         */
+        etl::expected<void, error::Error> release(DesfireKeyHandle handle);
+
+        /**
+         * @brief Release and zeroise all keys
+         */
+        void clear();
+
+        /**
+         * @brief Look up a registered key
+         * 
+         * @param handle Key handle
+         * @return const DesfireStoredKey* Cached key material, or nullptr if the handle is stale
+         */
+        const DesfireStoredKey* find(DesfireKeyHandle handle) const;
+
+        /**
+         * @brief Number of registered keys
+         * 
+         * @return size_t Key count
+         */
+        size_t size() const;
+
+    private:
+        struct Slot
+        {
+            DesfireStoredKey entry;
+            uint8_t generation = 1U;
+            bool used = false;
+        };
+
+        static void zeroise(Slot& slot);
+
+        etl::array<Slot, MAX_KEYS> slots;
+    };
+
+} // namespace nfc
@@ -0,0 +1,161 @@
+/**
+ * @file DesfireReadPlan.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Multi-file read plan and arena-backed result set
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <etl/vector.h>
+#include <etl/expected.h>
+#include "DesfireAuthMode.h"
+#include "DesfireKeyStore.h"
+#include "Error/Error.h"
+
+namespace nfc
+{
+    /**
+     * @brief What a plan entry reads
+     */
+    enum class DesfireReadKind : uint8_t
+    {
+        Data,       // ReadData on a standard/backup data file
+        Records,    // ReadRecords on a linear/cyclic record file
+        Value       // GetValue on a value file
+    };
+
+    /**
+     * @brief Where a plan entry was answered from
+     */
+    enum class DesfireReadSource : uint8_t
+    {
+        None,       // not read (failed or not reached)
+        Card,
+        Cache       // result kept in the set from an earlier readFiles() call
+    };
+
+    /**
+     * @brief One file to read
+     *
+     * Settings that are already known (from the application's file layout)
+     * save a GetFileSettings round trip each. Leave communicationSettings at
+     * COMM_SETTINGS_UNKNOWN, a Data length of 0 (to end of file) or a
+     * Records recordSize/length of 0 to have them looked up on the card.
+     */
+    struct DesfireReadPlanEntry
+    {
+        static constexpr uint8_t COMM_SETTINGS_UNKNOWN = 0xFFU;
+        static constexpr uint8_t FREE_ACCESS = 0x0EU;
+
+        uint8_t fileNo = 0U;
+        DesfireReadKind kind = DesfireReadKind::Data;
+        uint32_t offset = 0U;       // byte offset (Data) or first record (Records)
+        uint32_t length = 0U;       // bytes (Data) or records (Records), 0 = up to the end
+        uint32_t recordSize = 0U;   // Records only
+        uint8_t communicationSettings = COMM_SETTINGS_UNKNOWN; // 0x00 plain, 0x01 MAC, 0x03 enc
+
+        uint8_t keyNo = FREE_ACCESS;    // key granting read access
+        DesfireKeyHandle keyHandle;     // in the plan's key store
+        DesfireAuthMode authMode = DesfireAuthMode::AES;
+
+        bool allowCached = true;    // clear for files written during the tap
+    };
+
+    /**
+     * @brief Files to read from the selected application
+     *
+     * Results of an earlier call are only reused for the card with the same
+     * UID. Without a card UID every entry is read from the card.
+     */
+    struct DesfireReadPlan
+    {
+        static constexpr size_t MAX_ENTRIES = 8U;
+
+        const DesfireKeyStore* keyStore = nullptr;  // needed when an entry has a read key
+        etl::vector<uint8_t, 10> cardUid;           // UID of the card being read, from detection
+        etl::vector<DesfireReadPlanEntry, MAX_ENTRIES> entries;
+    };
+
+    /**
+     * @brief Outcome of one plan entry
+     */
+    struct DesfireFileReadResult
+    {
+        uint8_t fileNo = 0U;
+        DesfireReadKind kind = DesfireReadKind::Data;
+        uint32_t offset = 0U;       // as requested in the plan
+        uint32_t length = 0U;       // as requested in the plan
+        DesfireReadSource source = DesfireReadSource::None;
+        etl::expected<void, error::Error> status;
+        size_t dataOffset = 0U;     // position in the result set arena
+        size_t dataLength = 0U;     // bytes read (Data and Records)
+        int32_t value = 0;          // balance (Value)
+
+        bool isOk() const
+        {
+            return source != DesfireReadSource::None && status.has_value();
+        }
+    };
+
+    /**
+     * @brief Counters of one readFiles() call
+     */
+    struct DesfireReadPlanMetrics
+    {
+        uint32_t filesRead = 0U;        // entries answered (card or cache)
+        uint32_t filesFailed = 0U;
+        uint32_t cardReads = 0U;        // ReadData/ReadRecords/GetValue sent
+        uint32_t cacheHits = 0U;
+        uint32_t authentications = 0U;
+        uint32_t settingsLookups = 0U;  // GetFileSettings sent
+    };
+
+    /**
+     * @brief Results of a read plan, in plan order
+     *
+     * All file contents share one arena instead of one 4 KB vector per
+     * file. The set also serves as the cache of the next readFiles() call:
+     * an entry identical to a successful one in the set, for the same card
+     * UID and application, is answered without touching the card. The set
+     * takes about 8 KB; keep it in static storage.
+     */
+    class DesfireReadResultSet
+    {
+    public:
+        static constexpr size_t ARENA_SIZE = 8192U;
+
+        DesfireReadResultSet();
+
+        size_t size() const;
+
+        const DesfireFileReadResult& operator[](size_t index) const;
+
+        /**
+         * @brief Bytes read for an entry
+         *
+         * @return const uint8_t* Start of the data in the arena, nullptr when there is none
+         */
+        const uint8_t* data(size_t index) const;
+
+        /**
+         * @brief Drop all results and cached data
+         */
+        void clear();
+
+    private:
+        friend class DesfireCard;
+
+        etl::vector<DesfireFileReadResult, DesfireReadPlan::MAX_ENTRIES> results;
+        etl::vector<uint8_t, ARENA_SIZE> arena;
+        etl::vector<uint8_t, 10> uid;   // card the results belong to
+        etl::vector<uint8_t, 3> aid;    // application the results belong to
+    };
+
+} // namespace nfc
@@ -0,0 +1,100 @@
+/**
+ * @file DesfireRecordFile.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Record file helper that journals writes and commits
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <etl/vector.h>
+#include <etl/expected.h>
+#include "Error/Error.h"
+#include "TransactionJournal.h"
+
+namespace nfc
+{
+    class DesfireCard;
+
+    /**
+     * @brief Record file accessor for settlement journaling
+     *
+     * Counterpart of DesfireValueFile for linear and cyclic record files.
+     * With a journal attached, every WriteRecord the card accepted is
+     * appended as a WriteRecord entry (delta = bytes written, newValue =
+     * offset within the record) and a successful CommitTransaction as a
+     * Commit entry carrying the bytes it made permanent.
+     *
+     * A failed commit is not journaled: its outcome is unknown, so the
+     * WriteRecord entries stay unsettled until the back office checks the
+     * card. A failed append does not fail the operation the card already
+     * applied; it is counted in journalFailures().
+     */
+    class DesfireRecordFile
+    {
+    public:
+        /**
+         * @brief Construct a record file accessor
+         *
+         * @param card DESFire card session
+         * @param fileNo Record file number (0..31)
+         */
+        DesfireRecordFile(DesfireCard& card, uint8_t fileNo);
+
+        /**
+         * @brief Write to the record being assembled (WriteRecord, INS 0x3B)
+         *
+         * @param offset Byte offset within the record (24-bit)
+         * @param data Record payload bytes
+         * @param chunkSize Max bytes per command cycle (0 uses default)
+         * @return etl::expected<void, error::Error> Success or card error; a journal
+         *         failure does not fail the write (see journalFailures())
+         */
+        etl::expected<void, error::Error> writeRecord(
+            uint32_t offset,
+            const etl::ivector<uint8_t>& data,
+            uint16_t chunkSize = 0U);
+
+        /**
+         * @brief Commit pending record writes
+         *
+         * @return etl::expected<void, error::Error> Success or error
+         */
+        etl::expected<void, error::Error> commit();
+
+        /**
+         * @brief Get the bytes written since the last commit
+         */
+        uint32_t pendingBytes() const;
+
+        /**
+         * @brief Journal record operations of this file
+         *
+         * @param journal Transaction journal (nullptr to stop journaling)
+         * @param uid UID of the card the file lives on
+         */
+        void setJournal(TransactionJournal* journal, const etl::ivector<uint8_t>& uid);
+
+        /**
+         * @brief Get the number of journal appends that failed since setJournal()
+         */
+        uint32_t journalFailures() const;
+
+        /**
+         * @brief Get the error of the last failed journal append
+         */
+        const etl::optional<error::Error>& lastJournalError() const;
+
+    private:
+        DesfireCard& card;
+        uint8_t fileNo;
+        uint32_t pending;
+        TransactionJournalRecorder journal;
+    };
+
+} // namespace nfc
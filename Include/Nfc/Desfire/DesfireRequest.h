@@ -14,19 +14,26 @@
 #include <etl/vector.h>
 #include <cstdint>
 #include <cstddef>
+#include "Nfc/Desfire/DesfireContext.h"
 
 namespace nfc
 {
     /**
      * @brief DESFire request structure
      * 
-     * Contains command code, request data, and expected response length
+     * Contains command code, request data, and expected response length.
+     * For wrapRequest() the first headerLength data bytes (file number,
+     * offset, length) are sent in plain and only covered by the MAC/CRC;
+     * responseMode is the protection of the answer, which differs from the
+     * request's for commands that return only status plus CMAC.
      */
     struct DesfireRequest
     {
         uint8_t commandCode;
         etl::vector<uint8_t, 252> data;
         size_t expectedResponseLength;
+        size_t headerLength = 0U;
+        CommMode responseMode = CommMode::Plain;   // Enciphered only when the response carries enciphered data
     };
 
 } // namespace nfc
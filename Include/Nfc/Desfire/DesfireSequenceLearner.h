@@ -0,0 +1,177 @@
+/**
+ * @file DesfireSequenceLearner.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Learned command sequences and speculative request protection
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <etl/vector.h>
+#include <etl/expected.h>
+#include "DesfireCard.h"
+#include "DesfireContext.h"
+#include "DesfireRequest.h"
+#include "DesfireResult.h"
+#include "SecureMessagingCodec.h"
+#include "Error/Error.h"
+
+namespace nfc
+{
+    /**
+     * @brief When a learned successor is trusted enough to prepare
+     */
+    struct DesfireSequenceOptions
+    {
+        uint16_t minObservations = 3U;      // times the successor must have followed the step
+        uint8_t minConfidencePercent = 90U; // its share of everything that followed the step
+    };
+
+    /**
+     * @brief Counters since construction or forget()
+     */
+    struct DesfireSequenceMetrics
+    {
+        uint32_t predictions = 0U;      // requests protected ahead of time
+        uint32_t hits = 0U;             // sent as prepared
+        uint32_t misses = 0U;           // the application issued something else
+        uint32_t stale = 0U;            // right request, but the session had moved on
+        uint32_t unpredictable = 0U;    // a successor was known, the session state was not
+    };
+
+    /**
+     * @brief Learns per-profile request sequences and protects the next request early
+     *
+     * Applications tend to run the same requests in the same order on every
+     * card of a kind (select, authenticate, read settings, read file...).
+     * The learner records which request followed which, per profile, and
+     * once a successor is confident enough it wraps that request ahead of
+     * time, against the session state the current request will leave. When
+     * the application then issues exactly that request it is sent as
+     * prepared; anything else is wrapped as usual and the prepared request
+     * is dropped. Speculation only costs host CPU: nothing reaches the card
+     * that the application did not ask for.
+     *
+     * The state after a successful response is known in advance for
+     * unauthenticated and EV2 sessions. EV1 sessions chain the IV through
+     * the response CMAC, so there the next request is prepared only once
+     * the response has been checked.
+     *
+     * Works on the card's wrapRequest()/unwrapResponse() path: prepare()
+     * the request, send it, speculate() while the card works, then
+     * complete() with the response as received.
+     *
+     * Tables are fixed-size; steps beyond MAX_STEPS or with more than
+     * MAX_STEP_DATA data bytes are run but not learned.
+     */
+    class DesfireSequenceLearner
+    {
+    public:
+        static constexpr size_t MAX_STEPS = 32U;
+        static constexpr size_t MAX_TRANSITIONS = 64U;
+        static constexpr size_t MAX_STEP_DATA = 32U;
+
+        /**
+         * @brief Construct a new Desfire Sequence Learner object
+         *
+         * @param card Card whose requests are wrapped
+         * @param options Prediction thresholds
+         */
+        explicit DesfireSequenceLearner(
+            DesfireCard& card,
+            const DesfireSequenceOptions& options = DesfireSequenceOptions());
+
+        /**
+         * @brief Start a new sequence, e.g. on each tap
+         *
+         * Call speculate() afterwards to prepare the usual first request.
+         *
+         * @param profile Card profile (application, card type...) the sequence belongs to
+         */
+        void beginSequence(uint32_t profile);
+
+        /**
+         * @brief Wrap the next request of the sequence
+         *
+         * @param request Request issued by the application
+         * @return etl::expected<etl::vector<uint8_t, 261>, error::Error> Data to send or error
+         */
+        etl::expected<etl::vector<uint8_t, 261>, error::Error> prepare(const DesfireRequest& request);
+
+        /**
+         * @brief Protect the predicted next request ahead of time
+         *
+         * Does nothing when no successor is confident enough or the state
+         * the session will be in cannot be predicted.
+         */
+        void speculate();
+
+        /**
+         * @brief Check the response to the last prepare()
+         *
+         * For an EV1 session, call speculate() after this instead of
+         * while the request is in flight.
+         *
+         * @param response Response as received
+         * @return etl::expected<DesfireResult, error::Error> Unwrapped result or error
+         */
+        etl::expected<DesfireResult, error::Error> complete(const etl::ivector<uint8_t>& response);
+
+        /**
+         * @brief Drop everything learned
+         */
+        void forget();
+
+        const DesfireSequenceMetrics& getMetrics() const;
+
+    private:
+        static constexpr uint8_t NO_STEP = 0xFFU;     // not learnable, or position unknown
+        static constexpr uint8_t START_STEP = 0xFEU;  // before the first request of a sequence
+
+        struct Step
+        {
+            uint32_t profile = 0U;
+            uint8_t commandCode = 0x00U;
+            size_t expectedResponseLength = 0U;
+            size_t headerLength = 0U;
+            CommMode responseMode = CommMode::Plain;
+            etl::vector<uint8_t, MAX_STEP_DATA> data;
+        };
+
+        struct Transition
+        {
+            uint32_t profile = 0U;
+            uint8_t from = NO_STEP;
+            uint8_t to = NO_STEP;
+            uint16_t count = 0U;
+        };
+
+        uint8_t findOrAddStep(const DesfireRequest& request);
+        void recordTransition(uint8_t from, uint8_t to);
+        uint8_t predict(uint8_t from) const;
+        void dropSpeculation();
+
+        DesfireCard& card;
+        DesfireSequenceOptions options;
+        DesfireSequenceMetrics metrics;
+
+        etl::vector<Step, MAX_STEPS> steps;
+        etl::vector<Transition, MAX_TRANSITIONS> transitions;
+
+        uint32_t profile;
+        uint8_t lastStep;
+        bool inFlight;
+
+        bool speculated;
+        uint8_t speculatedStep;
+        DesfireContext speculatedOrigin;    // state the prepared request was wrapped against
+        WrappedCommand speculatedRequest;
+    };
+
+} // namespace nfc
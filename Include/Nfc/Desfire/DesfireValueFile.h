@@ -0,0 +1,185 @@
+/**
+ * @file DesfireValueFile.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Value file helper with optimistic local balance tracking
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <etl/vector.h>
+#include <etl/expected.h>
+#include "Error/Error.h"
+#include "TransactionJournal.h"
+
+namespace nfc
+{
+    class DesfireCard;
+
+    /**
+     * @brief Outcome of DesfireValueFile::commit
+     */
+    struct DesfireValueCommitResult
+    {
+        int32_t balance = 0;        ///< Balance after the commit
+        bool committed = false;     ///< Pending operations are now on the card
+        bool verified = false;      ///< Balance was read back with GetValue instead of predicted
+        bool journaled = false;     ///< Outcome was appended to the transaction journal
+    };
+
+    /**
+     * @brief Round-trip counters
+     */
+    struct DesfireValueFileMetrics
+    {
+        uint32_t cardReads = 0U;        ///< GetValue commands sent
+        uint32_t cacheHits = 0U;        ///< Balances answered from the cache
+        uint32_t reconciliations = 0U;  ///< Failed commits resolved with GetValue
+    };
+
+    /**
+     * @brief Value file accessor that avoids confirming GetValue reads
+     *
+     * The balance read with GetValue is cached together with the session it
+     * was read in (selected application and authentication state). Credits
+     * and debits are sent to the card as usual and also applied to a local
+     * pending delta. A successful CommitTransaction folds the delta into the
+     * cache, so the fare flow GetValue, Debit, Commit needs no final GetValue.
+     *
+     * If the commit fails, the response may have been lost after the card
+     * committed. The balance is then read back with GetValue and compared
+     * with the prediction to tell whether the transaction went through.
+     *
+     * The cache is dropped when the session changes, since selecting or
+     * authenticating aborts the card's open transaction, and when any value
+     * operation fails.
+     *
+     * With a journal attached, every credit, debit and limited credit the
+     * card accepted and every commit outcome is appended to it for
+     * settlement. A failed append does not fail the operation the card
+     * already applied; it is counted in journalFailures(), and the caller
+     * should hold back the commit until the entry is journaled.
+     */
+    class DesfireValueFile
+    {
+    public:
+        /**
+         * @brief Construct a value file accessor
+         *
+         * @param card DESFire card session
+         * @param fileNo Value file number (0..31)
+         */
+        DesfireValueFile(DesfireCard& card, uint8_t fileNo);
+
+        /**
+         * @brief Get the committed balance
+         *
+         * Answered from the cache when it belongs to the current session,
+         * otherwise read with GetValue.
+         *
+         * @return etl::expected<int32_t, error::Error> Balance or error
+         */
+        etl::expected<int32_t, error::Error> balance();
+
+        /**
+         * @brief Read the balance with GetValue and replace the cache
+         *
+         * @return etl::expected<int32_t, error::Error> Balance or error
+         */
+        etl::expected<int32_t, error::Error> refresh();
+
+        /**
+         * @brief Credit the file (Credit, INS 0x0C)
+         *
+         * @param value Credit amount (must be >= 0)
+         * @return etl::expected<void, error::Error> Success or card error; a journal
+         *         failure does not fail the credit (see journalFailures())
+         */
+        etl::expected<void, error::Error> credit(int32_t value);
+
+        /**
+         * @brief Debit the file (Debit, INS 0xDC)
+         *
+         * @param value Debit amount (must be >= 0)
+         * @return etl::expected<void, error::Error> Success or card error; a journal
+         *         failure does not fail the debit (see journalFailures())
+         */
+        etl::expected<void, error::Error> debit(int32_t value);
+
+        /**
+         * @brief Limited-credit the file (LimitedCredit, INS 0x1C)
+         *
+         * @param value Limited-credit amount (must be >= 0)
+         * @return etl::expected<void, error::Error> Success or card error; a journal
+         *         failure does not fail the credit (see journalFailures())
+         */
+        etl::expected<void, error::Error> limitedCredit(int32_t value);
+
+        /**
+         * @brief Commit pending operations and return the new balance
+         *
+         * @return etl::expected<DesfireValueCommitResult, error::Error> Commit outcome, or
+         *         error if neither the commit nor the reconciling GetValue succeeded
+         */
+        etl::expected<DesfireValueCommitResult, error::Error> commit();
+
+        /**
+         * @brief Check whether a balance is cached for the current session
+         */
+        bool isCached() const;
+
+        /**
+         * @brief Get the delta sent to the card but not yet committed
+         */
+        int32_t pendingDelta() const;
+
+        /**
+         * @brief Drop the cached balance and any pending delta
+         */
+        void invalidate();
+
+        /**
+         * @brief Journal value operations of this file
+         *
+         * @param journal Transaction journal (nullptr to stop journaling)
+         * @param uid UID of the card the file lives on
+         */
+        void setJournal(TransactionJournal* journal, const etl::ivector<uint8_t>& uid);
+
+        /**
+         * @brief Get the number of journal appends that failed since setJournal()
+         */
+        uint32_t journalFailures() const;
+
+        /**
+         * @brief Get the error of the last failed journal append
+         */
+        const etl::optional<error::Error>& lastJournalError() const;
+
+        const DesfireValueFileMetrics& metrics() const;
+
+    private:
+        bool sessionMatches() const;
+        void bindSession();
+        etl::expected<int32_t, error::Error> readFromCard();
+        void journalOperation(TransactionJournalType type, int32_t delta);
+        void journalOutcome(DesfireValueCommitResult& outcome, int32_t delta);
+
+        DesfireCard& card;
+        uint8_t fileNo;
+        bool cached;
+        int32_t committedValue;
+        int32_t pending;
+        bool sessionAuthenticated;
+        uint8_t sessionKeyNo;
+        etl::vector<uint8_t, 3> sessionAid;
+        DesfireValueFileMetrics valueMetrics;
+        TransactionJournalRecorder journal;
+    };
+
+} // namespace nfc
@@ -70,6 +70,19 @@ namespace nfc
          * @brief Reset command state
          */
         virtual void reset() = 0;
+
+        /**
+         * @brief Check if the command may be run again after a failed exchange
+         *
+         * Only commands without card-side effects qualify; DesfireCard's retry
+         * policy never repeats anything else.
+         *
+         * @return true Command can be restarted from scratch
+         */
+        virtual bool isReplaySafe() const
+        {
+            return false;
+        }
     };
 
 } // namespace nfc
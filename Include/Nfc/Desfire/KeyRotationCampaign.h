@@ -0,0 +1,199 @@
+/**
+ * @file KeyRotationCampaign.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Precomputed DESFire key rotation campaign image
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <etl/array.h>
+#include <etl/vector.h>
+#include <etl/optional.h>
+#include <etl/expected.h>
+#include "DesfireKeyType.h"
+#include "DesfireAuthMode.h"
+#include "Commands/ChangeKeyCommand.h"
+#include "Error/Error.h"
+
+namespace nfc
+{
+    /**
+     * @brief Campaign-wide ChangeKey parameters
+     *
+     * A campaign rotates one key slot of one application on every card.
+     */
+    struct KeyRotationCampaignSettings
+    {
+        etl::array<uint8_t, 3> aid = {0x00U, 0x00U, 0x00U};
+        uint8_t keyNo = 0x00U;              // Key slot to change
+        uint8_t authKeyNo = 0x00U;          // Key slot the session authenticates with
+        DesfireAuthMode authMode = DesfireAuthMode::ISO;
+        DesfireKeyType sessionKeyType = DesfireKeyType::UNKNOWN;
+        DesfireKeyType newKeyType = DesfireKeyType::AES;
+        uint8_t newKeyVersion = 0x00U;
+    };
+
+    /**
+     * @brief Campaign image layout
+     *
+     * The image is a header followed by fixed-size records sorted by UID, so
+     * it can be memory-mapped or loaded as-is and searched without parsing.
+     * Each record holds the plaintext ChangeKey cryptogram for one card and
+     * is protected by its own CRC32. The header carries a CRC32 over all
+     * records and is itself CRC-protected, so its CRC identifies both the
+     * campaign parameters and every card's cryptogram.
+     *
+     * The cryptogram contains new XOR old key material; the image must be
+     * stored with the same care as the keys themselves.
+     */
+    struct KeyRotationCampaignFormat
+    {
+        static constexpr uint8_t MAGIC[4] = {'D', 'K', 'R', 'C'};
+        static constexpr uint8_t VERSION = 0x02U;
+        static constexpr size_t HEADER_SIZE = 28U;
+        static constexpr size_t RECORD_SIZE = 52U;
+        static constexpr size_t MAX_UID_LENGTH = 10U;
+
+        /**
+         * @brief Image size needed for a number of cards
+         */
+        static constexpr size_t imageSize(size_t cardCount)
+        {
+            return HEADER_SIZE + (cardCount * RECORD_SIZE);
+        }
+    };
+
+    /**
+     * @brief Builds a campaign image into a caller-provided buffer
+     *
+     * Cards may be added in any order; records are kept sorted on insert.
+     * Intended for the provisioning host, where the per-card diversified
+     * old and new keys are available.
+     */
+    class KeyRotationCampaignWriter
+    {
+    public:
+        /**
+         * @brief Construct a writer
+         *
+         * @param buffer Output buffer, at least KeyRotationCampaignFormat::imageSize(cards)
+         * @param capacity Buffer size in bytes
+         * @param settings Campaign-wide parameters
+         */
+        KeyRotationCampaignWriter(uint8_t* buffer, size_t capacity, const KeyRotationCampaignSettings& settings);
+
+        /**
+         * @brief Precompute and add the cryptogram for one card
+         *
+         * @param uid Card UID (4, 7 or 10 bytes)
+         * @param newKey New (diversified) key for this card
+         * @param oldKey Current key in the target slot; ignored when the
+         *               campaign changes the authenticated key itself
+         * @return etl::expected<void, error::Error> Success, DuplicateError, CountError or key error
+         */
+        etl::expected<void, error::Error> addCard(
+            const etl::ivector<uint8_t>& uid,
+            const etl::ivector<uint8_t>& newKey,
+            const etl::ivector<uint8_t>& oldKey);
+
+        /**
+         * @brief Write the header, including the CRC over all records
+         *
+         * @return etl::expected<size_t, error::Error> Image size in bytes
+         */
+        etl::expected<size_t, error::Error> finish();
+
+        /**
+         * @brief Get the number of records added so far
+         */
+        size_t recordCount() const;
+
+    private:
+        uint8_t* buffer;
+        size_t capacity;
+        KeyRotationCampaignSettings settings;
+        size_t count;
+    };
+
+    /**
+     * @brief Read-only view of a campaign image
+     *
+     * Does not copy the image; the buffer must outlive the view.
+     */
+    class KeyRotationCampaignView
+    {
+    public:
+        KeyRotationCampaignView() = default;
+
+        /**
+         * @brief Validate and attach to an image
+         *
+         * Checks the header CRC and the CRC over all records, so a view
+         * that opened is bound to the campaign ID of its records.
+         *
+         * @param image Image bytes
+         * @param size Image size
+         * @return etl::expected<void, error::Error> Success, or IntegrityError/LengthError
+         */
+        etl::expected<void, error::Error> open(const uint8_t* image, size_t size);
+
+        /**
+         * @brief Get the campaign-wide parameters
+         */
+        const KeyRotationCampaignSettings& settings() const;
+
+        /**
+         * @brief Get the campaign identifier (header CRC32)
+         *
+         * The header covers the CRC of all records, so campaigns with the
+         * same parameters but different cards or keys get different
+         * identifiers. Journals record this value so a journal cannot be
+         * replayed against a different campaign.
+         */
+        uint32_t campaignId() const;
+
+        /**
+         * @brief Get the number of cards in the campaign
+         */
+        size_t recordCount() const;
+
+        /**
+         * @brief Find a card by UID (binary search)
+         *
+         * @param uid Card UID
+         * @return etl::optional<size_t> Record index, or empty when the card is not in the campaign
+         */
+        etl::optional<size_t> find(const etl::ivector<uint8_t>& uid) const;
+
+        /**
+         * @brief Check whether a record belongs to a card
+         *
+         * @param index Record index
+         * @param uid Card UID
+         * @return true if record @p index exists and holds @p uid
+         */
+        bool matches(size_t index, const etl::ivector<uint8_t>& uid) const;
+
+        /**
+         * @brief Load the precomputed cryptogram of a record
+         *
+         * @param index Record index
+         * @return etl::expected<ChangeKeyPrecomputedCryptogram, error::Error> Cryptogram, or IntegrityError on CRC mismatch
+         */
+        etl::expected<ChangeKeyPrecomputedCryptogram, error::Error> cryptogram(size_t index) const;
+
+    private:
+        const uint8_t* image = nullptr;
+        size_t count = 0U;
+        uint32_t id = 0U;
+        KeyRotationCampaignSettings campaignSettings;
+    };
+
+} // namespace nfc
@@ -0,0 +1,75 @@
+/**
+ * @file KeyRotationEngine.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Applies a precomputed key rotation campaign to tapped cards
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <etl/vector.h>
+#include <etl/expected.h>
+#include "KeyRotationCampaign.h"
+#include "KeyRotationJournal.h"
+#include "Error/Error.h"
+
+namespace nfc
+{
+    class DesfireCard;
+
+    /**
+     * @brief Result of applying the campaign to a card
+     */
+    enum class KeyRotationOutcome : uint8_t
+    {
+        Rotated,        // ChangeKey sent and confirmed during this tap
+        AlreadyRotated, // Journal or card key version shows the card is done
+        NotInCampaign   // UID has no campaign record
+    };
+
+    /**
+     * @brief Key rotation campaign engine
+     *
+     * On tap the engine only looks up the card, authenticates and encrypts
+     * the precomputed cryptogram with the session key. CRCs and key XOR were
+     * done when the campaign image was written.
+     *
+     * A card left InProgress by an interrupted run is checked with
+     * GetKeyVersion first, so a key that already changed is not changed
+     * twice (which would fail authentication with the old key).
+     */
+    class KeyRotationEngine
+    {
+    public:
+        /**
+         * @brief Construct an engine
+         *
+         * @param campaign Opened campaign image
+         * @param journal Recovered journal for the same campaign
+         */
+        KeyRotationEngine(const KeyRotationCampaignView& campaign, KeyRotationJournal& journal);
+
+        /**
+         * @brief Rotate the key of a tapped card
+         *
+         * @param card Card session
+         * @param uid Card UID
+         * @param authKey Current key of the campaign's authentication slot for this card
+         * @return etl::expected<KeyRotationOutcome, error::Error> Outcome or error
+         */
+        etl::expected<KeyRotationOutcome, error::Error> apply(
+            DesfireCard& card,
+            const etl::ivector<uint8_t>& uid,
+            const etl::vector<uint8_t, 24>& authKey);
+
+    private:
+        const KeyRotationCampaignView& campaign;
+        KeyRotationJournal& journal;
+    };
+
+} // namespace nfc
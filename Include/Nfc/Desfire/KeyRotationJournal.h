@@ -0,0 +1,108 @@
+/**
+ * @file KeyRotationJournal.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Crash-safe progress journal for key rotation campaigns
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <etl/vector.h>
+#include <etl/expected.h>
+#include "Error/Error.h"
+#include "KeyRotationCampaign.h"
+
+namespace nfc
+{
+    /**
+     * @brief Append-only storage backing a key rotation journal
+     *
+     * Implemented by the host (file, flash sector, ...). sync() must not
+     * return before appended data is durable.
+     */
+    class IKeyRotationJournalStorage
+    {
+    public:
+        virtual ~IKeyRotationJournalStorage() = default;
+
+        virtual size_t size() const = 0;
+        virtual etl::expected<void, error::Error> read(size_t offset, uint8_t* out, size_t length) = 0;
+        virtual etl::expected<void, error::Error> append(const uint8_t* data, size_t length) = 0;
+        virtual etl::expected<void, error::Error> truncate(size_t length) = 0;
+        virtual etl::expected<void, error::Error> sync() = 0;
+    };
+
+    /**
+     * @brief Per-card rotation state
+     */
+    enum class KeyRotationState : uint8_t
+    {
+        Pending = 0x00,     // Not attempted
+        InProgress = 0x01,  // ChangeKey may or may not have reached the card
+        Done = 0x02         // ChangeKey confirmed
+    };
+
+    /**
+     * @brief Journal of rotation progress
+     *
+     * Every state change is appended as a fixed-size, CRC-protected record
+     * and synced before the card is touched. On startup recover() replays
+     * the records into a caller-provided state table (one byte per campaign
+     * record) and cuts off a torn record left by a crash. Each replayed
+     * record must name the card its campaign record index belongs to.
+     */
+    class KeyRotationJournal
+    {
+    public:
+        static constexpr size_t RECORD_SIZE = 24U;
+
+        /**
+         * @brief Construct a journal
+         *
+         * @param storage Backing storage
+         * @param states State table, one entry per campaign record
+         * @param stateCount Number of entries in the state table
+         */
+        KeyRotationJournal(IKeyRotationJournalStorage& storage, KeyRotationState* states, size_t stateCount);
+
+        /**
+         * @brief Replay the journal, or start it when the storage is empty
+         *
+         * @param campaign Campaign this journal belongs to
+         * @return etl::expected<size_t, error::Error> Number of records replayed,
+         *         ParameterError if the journal belongs to another campaign,
+         *         IntegrityError if a record's UID does not match the indexed card
+         */
+        etl::expected<size_t, error::Error> recover(const KeyRotationCampaignView& campaign);
+
+        /**
+         * @brief Get the state of a campaign record
+         */
+        KeyRotationState state(size_t index) const;
+
+        /**
+         * @brief Record that ChangeKey is about to be sent to a card
+         */
+        etl::expected<void, error::Error> markInProgress(size_t index, const etl::ivector<uint8_t>& uid);
+
+        /**
+         * @brief Record that a card now holds the new key
+         */
+        etl::expected<void, error::Error> markDone(size_t index, const etl::ivector<uint8_t>& uid);
+
+    private:
+        etl::expected<void, error::Error> appendRecord(uint8_t type, uint32_t value, const etl::ivector<uint8_t>& uid);
+
+        IKeyRotationJournalStorage& storage;
+        KeyRotationState* states;
+        size_t stateCount;
+        bool recovered;
+    };
+
+} // namespace nfc
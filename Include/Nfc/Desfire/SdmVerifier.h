@@ -0,0 +1,184 @@
+/**
+ * @file SdmVerifier.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Back-end verifier for Secure Dynamic Messaging (SUN) tap URLs
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <etl/string_view.h>
+#include <etl/expected.h>
+#include "Error/Error.h"
+
+namespace nfc
+{
+    /**
+     * @brief Outcome of verifying one tap
+     */
+    enum class SdmVerifyStatus : uint8_t
+    {
+        Pending,        // not processed yet
+        Valid,          // SDMMAC correct, counter fresh
+        Malformed,      // missing or badly encoded parameter, bad PICCData
+        MacMismatch,    // SDMMAC does not match
+        Replayed        // SDMReadCtr not above the last accepted value for the UID
+    };
+
+    /**
+     * @brief Verifier configuration
+     *
+     * The parameter names match the SDM mirror offsets configured with
+     * ChangeFileSettings. The SDMMAC input runs from the start of the value
+     * of macInputParameter up to the start of the SDMMAC value, which is
+     * what the card MACs when SDMMACInputOffset points at that value. Leave
+     * macInputParameter empty when SDMMACInputOffset equals SDMMACOffset.
+     */
+    struct SdmVerifierOptions
+    {
+        const uint8_t* metaReadKey = nullptr;       // K_SDMMetaRead, 16 bytes, decrypts PICCData
+        const uint8_t* fileReadKey = nullptr;       // K_SDMFileRead, or the master key when diversifying
+        bool diversifyFileReadKey = false;          // derive K_SDMFileRead per UID (AN10922)
+        const uint8_t* diversificationSuffix = nullptr; // appended to the UID, e.g. AID || system identifier
+        size_t diversificationSuffixLength = 0U;
+        etl::string_view piccDataParameter = "picc_data";
+        etl::string_view encParameter = "enc";      // SDMENCFileData, optional in the URL
+        etl::string_view macParameter = "cmac";
+        etl::string_view macInputParameter = "";
+        bool rejectReplay = true;
+    };
+
+    /**
+     * @brief One tap to verify
+     *
+     * The URL (or only its query string) must stay valid until the
+     * verification returns. The remaining fields are filled in.
+     */
+    struct SdmTap
+    {
+        static constexpr size_t UID_LENGTH = 7U;
+        static constexpr size_t MAX_FILE_DATA = 128U;
+
+        etl::string_view url;
+        SdmVerifyStatus status = SdmVerifyStatus::Pending;
+        uint8_t uid[UID_LENGTH] = {0};
+        uint32_t readCounter = 0U;
+        uint8_t fileData[MAX_FILE_DATA] = {0};     // decrypted SDMENCFileData, valid taps only
+        size_t fileDataLength = 0U;
+    };
+
+    /**
+     * @brief Verification counters
+     */
+    struct SdmVerifierMetrics
+    {
+        uint32_t taps = 0U;
+        uint32_t valid = 0U;
+        uint32_t malformed = 0U;
+        uint32_t macMismatches = 0U;
+        uint32_t replayed = 0U;
+        uint32_t keyCacheHits = 0U;     // diversified keys found in the cache
+        uint32_t keyCacheMisses = 0U;   // diversified keys derived
+    };
+
+    /**
+     * @brief Verifies SUN URLs produced by DESFire EV3 and NTAG 424 DNA
+     *
+     * For each tap the PICCData is decrypted with K_SDMMetaRead to get the
+     * UID and SDMReadCtr, the SDM session keys are derived with CMAC over
+     * SV1/SV2, and the truncated SDMMAC is checked. SDMENCFileData, when
+     * present, is decrypted only after the MAC has been accepted.
+     *
+     * verifyBatch() runs every step for up to LANES taps at once through a
+     * DesfireCryptoBatch, so the AES blocks of different taps are issued
+     * together (on AES-NI when the build enables it). Diversified file read
+     * keys and the last accepted counter are kept per UID in a 4-way set
+     * associative LRU cache. A UID evicted from the cache loses its replay
+     * history, so a back end that must never accept a replay keeps the
+     * counter in its own store as well. The cache takes about 40 KB; give
+     * the verifier static or heap storage.
+     */
+    class SdmVerifier
+    {
+    public:
+        static constexpr size_t KEY_LENGTH = 16U;
+        static constexpr size_t MAC_LENGTH = 8U;
+        static constexpr size_t MAX_MAC_INPUT = 256U;
+        static constexpr size_t CACHE_SIZE = 1024U;
+        static constexpr size_t CACHE_WAYS = 4U;
+        static constexpr size_t LANES = 8U;
+
+        explicit SdmVerifier(const SdmVerifierOptions& options);
+
+        /**
+         * @brief Verify one tap
+         *
+         * @param tap Tap; status and the decoded fields are set
+         * @return etl::expected<bool, error::Error> true for a valid tap,
+         *         ParameterError when the verifier has no keys
+         */
+        etl::expected<bool, error::Error> verify(SdmTap& tap);
+
+        /**
+         * @brief Verify many taps
+         *
+         * Taps are processed in groups of LANES. Within a batch, a second tap
+         * with the same UID and counter as an accepted one is reported as
+         * Replayed.
+         *
+         * @param taps Taps; status and the decoded fields are set on each
+         * @param count Number of taps
+         * @return etl::expected<size_t, error::Error> Number of valid taps
+         */
+        etl::expected<size_t, error::Error> verifyBatch(SdmTap* taps, size_t count);
+
+        /**
+         * @brief Diversify an AES-128 key (NXP AN10922)
+         *
+         * @param masterKey 16 byte master key
+         * @param input Diversification input, 1 to 31 bytes
+         * @param length Input length
+         * @param outKey 16 byte diversified key
+         * @return true Key derived
+         * @return false Input length out of range
+         */
+        static bool diversifyKey(const uint8_t* masterKey, const uint8_t* input, size_t length, uint8_t* outKey);
+
+        /**
+         * @brief Drop all cached keys and counters
+         */
+        void clearCache();
+
+        const SdmVerifierMetrics& metrics() const;
+
+    private:
+        struct CacheEntry
+        {
+            bool used = false;
+            bool keyReady = false;
+            bool counterSeen = false;
+            uint8_t uid[SdmTap::UID_LENGTH] = {0};
+            uint8_t key[KEY_LENGTH] = {0};
+            uint32_t lastCounter = 0U;
+            uint32_t lastUse = 0U;
+        };
+
+        struct Lane;
+
+        CacheEntry& cacheEntry(const uint8_t* uid);
+        bool resolveFileReadKey(const uint8_t* uid, uint8_t* outKey);
+        void runGroup(Lane* lanes, size_t count);
+
+        SdmVerifierOptions options;
+        CacheEntry cache[CACHE_SIZE];
+        uint32_t cacheClock;
+        SdmVerifierMetrics verifierMetrics;
+    };
+
+} // namespace nfc
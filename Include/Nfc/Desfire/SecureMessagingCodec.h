@@ -0,0 +1,157 @@
+/**
+ * @file SecureMessagingCodec.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Stateless DESFire secure messaging for relayed sessions
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <etl/vector.h>
+#include <etl/expected.h>
+#include "DesfireContext.h"
+#include "Nfc/BufferSizes.h"
+#include "Nfc/Wire/IWire.h"
+#include "Error/Error.h"
+
+namespace nfc
+{
+    /**
+     * @brief Plain command to protect
+     *
+     * The header (file number, offset, length, ...) always travels in the
+     * clear; the data is protected according to commMode. Both are covered
+     * by the MAC or CRC.
+     */
+    struct SecureCommand
+    {
+        uint8_t commandCode = 0x00U;
+        etl::vector<uint8_t, 16> header;
+        etl::vector<uint8_t, 200> data;
+        CommMode commMode = CommMode::Plain;        // protection of the request data
+        CommMode responseMode = CommMode::Plain;    // Enciphered only when the response carries enciphered data
+        size_t expectedResponseLength = 0U;         // plaintext length of an enciphered response, 0 = locate by CRC
+    };
+
+    /**
+     * @brief What unwrapResponse() needs to know about the command it answers
+     */
+    struct SecureResponseExpectation
+    {
+        CommMode responseMode = CommMode::Plain;
+        size_t expectedResponseLength = 0U;
+    };
+
+    /**
+     * @brief Result of SecureMessagingCodec::wrapCommand()
+     */
+    struct WrappedCommand
+    {
+        etl::vector<uint8_t, buffer::APDU_COMMAND_MAX> apdu;
+        DesfireContext state;                   // session state once the command is sent
+        SecureResponseExpectation expectation;
+    };
+
+    /**
+     * @brief Result of SecureMessagingCodec::unwrapResponse()
+     */
+    struct UnwrappedResponse
+    {
+        uint8_t statusCode = 0x00U;
+        etl::vector<uint8_t, 256> data;         // plain response data, MAC/CRC/padding removed
+        DesfireContext state;                   // session state after the response
+
+        bool isSuccess() const
+        {
+            return statusCode == 0x00U;
+        }
+    };
+
+    /**
+     * @brief Secure messaging as pure functions of the session state
+     *
+     * A key-holding service that relays APDUs through thin readers keeps no
+     * per-session object: it stores the session as a DesfireContext (or
+     * its serialised form), calls wrapCommand() to get the APDU for the
+     * reader and the next state, and unwrapResponse() with the card's
+     * answer. Any worker can pick up a session from its serialised state.
+     *
+     * Covers EV1 secure messaging: AES and ISO (2K3DES/3K3DES) sessions,
+     * where every command and response advances the CMAC/CBC chaining value
+     * kept in the state. EV2 sessions (AuthenticateEV2First/NonFirst) MAC
+     * with the transaction identifier and command counter instead; their
+     * plain commands travel without a MAC. Unauthenticated sessions pass
+     * commands through.
+     * Legacy (0x0A) sessions and responses chained with 0xAF are rejected
+     * with InvalidState; relay those with DesfireCard.
+     *
+     * A card error status ends the authentication on the card, so the
+     * state returned with it is unauthenticated. A failed MAC or CRC check
+     * is returned as IntegrityError; the session is no longer usable.
+     *
+     * The serialised state holds the session keys in the clear. Protect it
+     * like the keys themselves when it is moved between workers.
+     */
+    class SecureMessagingCodec
+    {
+    public:
+        static constexpr uint8_t STATE_MAGIC = 0x53U;
+        static constexpr uint8_t STATE_VERSION = 3U;
+        static constexpr size_t STATE_SIZE = 105U;
+
+        /**
+         * @brief Protect a command
+         *
+         * @param state Current session state
+         * @param command Plain command
+         * @param wire Framing of the APDU (native or ISO 7816 wrapped)
+         * @return etl::expected<WrappedCommand, error::Error> APDU and next state
+         */
+        static etl::expected<WrappedCommand, error::Error> wrapCommand(
+            const DesfireContext& state,
+            const SecureCommand& command,
+            IWire& wire);
+
+        /**
+         * @brief Check and decode a response
+         *
+         * @param state State returned by wrapCommand()
+         * @param expectation Expectation returned by wrapCommand()
+         * @param response Response APDU as received by the reader
+         * @param wire Framing used for the command
+         * @return etl::expected<UnwrappedResponse, error::Error> Status, plain data and next state
+         */
+        static etl::expected<UnwrappedResponse, error::Error> unwrapResponse(
+            const DesfireContext& state,
+            const SecureResponseExpectation& expectation,
+            const etl::ivector<uint8_t>& response,
+            IWire& wire);
+
+        /**
+         * @brief Serialise a session state
+         *
+         * Layout: magic, version, flags, comm mode, auth scheme, key number,
+         * six length-prefixed fields padded to their capacity (keys 2 x 25,
+         * IV 17, RndB 17, AID 4, TI 5), command counter (LE16) and the
+         * utils::crc32 of everything before it (LE32): 105 bytes.
+         *
+         * @return etl::vector<uint8_t, STATE_SIZE> Fixed-layout image with a trailing CRC32
+         */
+        static etl::vector<uint8_t, STATE_SIZE> serializeState(const DesfireContext& state);
+
+        /**
+         * @brief Restore a serialised session state
+         *
+         * @return etl::expected<DesfireContext, error::Error> State, or IntegrityError for
+         *         a damaged image and ParameterError for a wrong size or version
+         */
+        static etl::expected<DesfireContext, error::Error> deserializeState(const etl::ivector<uint8_t>& image);
+    };
+
+} // namespace nfc
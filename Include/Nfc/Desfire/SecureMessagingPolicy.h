@@ -21,6 +21,7 @@ namespace nfc
      * - Derive request IV for authenticated plain commands
      * - Verify response CMAC and derive next IV for authenticated plain commands
      * - Apply legacy DES/2K3DES command-boundary IV reset behavior
+     * - EV2 secure messaging (CMACt over the command counter and TI)
      */
     class SecureMessagingPolicy
     {
@@ -44,6 +45,11 @@ namespace nfc
             bool updateContextIv = false;
         };
 
+        struct Ev2CommandProtection
+        {
+            etl::vector<uint8_t, 256> payload;  // header || protected data || CMACt
+        };
+
         enum class SessionCipher : uint8_t
         {
             DES,
@@ -186,6 +192,90 @@ namespace nfc
             const etl::ivector<uint8_t>& response,
             const EncryptedPayloadProtection& protection);
 
+        /**
+         * @brief Check whether the session uses EV2 secure messaging.
+         */
+        static bool isEv2Session(const DesfireContext& context);
+
+        /**
+         * @brief Derive the EV2 session keys after AuthenticateEV2First/NonFirst.
+         *
+         * SV1/SV2 are built from RndA and RndB and MACed with the authentication
+         * key: KSesAuthENC = CMAC(K, SV1), KSesAuthMAC = CMAC(K, SV2).
+         *
+         * @param key 16-byte AES key used for the authentication
+         * @param rndA 16-byte PCD random
+         * @param rndB 16-byte PICC random
+         * @param context Session context receiving sessionKeyEnc/sessionKeyMac
+         */
+        static etl::expected<void, error::Error> deriveEv2SessionKeys(
+            const etl::ivector<uint8_t>& key,
+            const etl::ivector<uint8_t>& rndA,
+            const etl::ivector<uint8_t>& rndB,
+            DesfireContext& context);
+
+        /**
+         * @brief EV2 truncated MAC (CMACt): odd bytes of CMAC(KSesAuthMAC, code || CmdCtr || TI || data).
+         *
+         * @param context EV2 session context
+         * @param code Command code (requests) or status byte (responses)
+         * @param commandCounter CmdCtr value covered by the MAC
+         * @param data Header and data bytes following the counter and TI
+         * @return etl::vector<uint8_t, 8> 8-byte truncated MAC
+         */
+        static etl::vector<uint8_t, 8> calculateEv2Mac(
+            const DesfireContext& context,
+            uint8_t code,
+            uint16_t commandCounter,
+            const etl::ivector<uint8_t>& data);
+
+        /**
+         * @brief EV2 IV for enciphered data: E(KSesAuthENC, A55A/5AA5 || TI || CmdCtr || 0^8).
+         *
+         * @param context EV2 session context
+         * @param response true for response decryption (5AA5 label)
+         * @param commandCounter CmdCtr value of the command or response
+         */
+        static etl::vector<uint8_t, 16> deriveEv2Iv(
+            const DesfireContext& context,
+            bool response,
+            uint16_t commandCounter);
+
+        /**
+         * @brief Protect an EV2 command.
+         *
+         * Plain commands pass through; MACed commands get CMACt appended;
+         * enciphered commands have their data padded (ISO/IEC 9797-1 method 2),
+         * encrypted with the command IV and then MACed. The header is never
+         * encrypted.
+         */
+        static etl::expected<Ev2CommandProtection, error::Error> protectEv2Command(
+            const DesfireContext& context,
+            uint8_t commandCode,
+            const etl::ivector<uint8_t>& header,
+            const etl::ivector<uint8_t>& data,
+            CommMode commMode);
+
+        /**
+         * @brief Check an EV2 response and advance the command counter.
+         *
+         * The counter is incremented first; the response CMACt covers the new
+         * value. Plain responses carry no MAC. Enciphered response data is
+         * decrypted and its padding removed.
+         *
+         * @param context EV2 session context, commandCounter advanced on success
+         * @param statusCode Response status byte (success only)
+         * @param payload Response bytes after the status byte
+         * @param commMode Protection of the response
+         * @param data Plain response data
+         */
+        static etl::expected<void, error::Error> verifyEv2Response(
+            DesfireContext& context,
+            uint8_t statusCode,
+            const etl::ivector<uint8_t>& payload,
+            CommMode commMode,
+            etl::ivector<uint8_t>& data);
+
         /**
          * @brief DESFire CRC16 helper.
          */
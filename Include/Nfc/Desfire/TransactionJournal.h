@@ -0,0 +1,396 @@
+/**
+ * @file TransactionJournal.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Append-only settlement journal on memory-mapped segments
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <etl/vector.h>
+#include <etl/expected.h>
+#include <etl/optional.h>
+#include "Error/Error.h"
+
+namespace nfc
+{
+    /**
+     * @brief Operation recorded by a journal entry
+     */
+    enum class TransactionJournalType : uint8_t
+    {
+        Credit = 0x01,
+        Debit = 0x02,
+        LimitedCredit = 0x03,
+        WriteRecord = 0x04,     // delta = bytes written, newValue = record offset
+        Commit = 0x05,          // newValue = balance after the commit (0 for record files)
+        Abort = 0x06            // pending operations were discarded
+    };
+
+    /**
+     * @brief Entry flags
+     */
+    enum TransactionJournalFlag : uint8_t
+    {
+        TRANSACTION_JOURNAL_VALUE_KNOWN = 0x01,     // newValue is a balance, not a placeholder
+        TRANSACTION_JOURNAL_VERIFIED = 0x02         // newValue was read back from the card
+    };
+
+    /**
+     * @brief Decoded journal entry
+     */
+    struct TransactionJournalEntry
+    {
+        TransactionJournalType type = TransactionJournalType::Commit;
+        uint8_t flags = 0U;
+        uint32_t sequence = 0U;     // assigned by the journal
+        uint64_t timestamp = 0U;    // milliseconds, stamped by the journal clock when set
+        etl::vector<uint8_t, 10> uid;
+        etl::vector<uint8_t, 3> aid;
+        uint8_t fileNo = 0U;
+        int32_t delta = 0;
+        int32_t newValue = 0;
+        uint8_t mac[8] = {0};       // truncated AES-CMAC, zero without a journal key
+    };
+
+    /**
+     * @brief Segment and entry layout
+     *
+     * A segment is a header slot followed by fixed-size entry slots. Slots
+     * are 64 bytes so an entry never straddles a cache line or a page.
+     *
+     * Segment header (little endian):
+     *   0  magic "TJS1"
+     *   4  version
+     *   8  segment index (u32)
+     *   12 sequence of the first entry (u32)
+     *   16 segment size (u32)
+     *   60 CRC32 over bytes 0..59
+     *
+     * Entry (little endian):
+     *   0  magic 0x54
+     *   1  type
+     *   2  flags
+     *   3  file number
+     *   4  AID length
+     *   5  AID (3 bytes)
+     *   8  sequence (u32)
+     *   12 delta (i32)
+     *   16 timestamp (u64)
+     *   24 new value (i32)
+     *   28 UID length
+     *   29 UID (zero padded to 10 bytes)
+     *   48 MAC (8 bytes, AES-CMAC over bytes 0..47)
+     *   60 CRC32 over bytes 0..59
+     *
+     * The CRC is written last, so a slot whose CRC does not match is an
+     * entry that was never completely written.
+     */
+    struct TransactionJournalFormat
+    {
+        static constexpr uint8_t MAGIC[4] = {'T', 'J', 'S', '1'};
+        static constexpr uint8_t VERSION = 0x01U;
+        static constexpr uint8_t ENTRY_MAGIC = 0x54U;
+        static constexpr size_t SLOT_SIZE = 64U;
+        static constexpr size_t MAC_OFFSET = 48U;
+        static constexpr size_t CRC_OFFSET = 60U;
+
+        /**
+         * @brief Number of entry slots in a segment of the given size
+         */
+        static constexpr size_t entriesPerSegment(size_t segmentSize)
+        {
+            return (segmentSize / SLOT_SIZE) - 1U;
+        }
+
+        /**
+         * @brief Encode an entry into a slot, without MAC and CRC
+         */
+        static void encode(const TransactionJournalEntry& entry, uint8_t* slot);
+
+        /**
+         * @brief Decode and check a slot
+         *
+         * @return true if the slot holds a complete entry
+         */
+        static bool decode(const uint8_t* slot, TransactionJournalEntry& entry);
+
+        /**
+         * @brief Check whether the MAC of an entry matches a journal key
+         *
+         * @param entry Decoded entry
+         * @param key 16 byte AES key
+         */
+        static bool verifyMac(const TransactionJournalEntry& entry, const uint8_t* key);
+    };
+
+    /**
+     * @brief Segment files backing a transaction journal
+     *
+     * Implemented by the host, normally with one file per segment mapped
+     * shared and read-write (mmap/MapViewOfFile). Appending then costs a
+     * memcpy; only flush() reaches the disk (msync/FlushViewOfFile), and it
+     * is called once per group of entries rather than once per tap.
+     */
+    class ITransactionJournalSegments
+    {
+    public:
+        virtual ~ITransactionJournalSegments() = default;
+
+        /**
+         * @brief Find the highest existing segment index
+         *
+         * @return false when no segment exists yet
+         */
+        virtual bool newestSegment(uint32_t& index) const = 0;
+
+        /**
+         * @brief Map a segment, creating it zero-filled when it does not exist
+         *
+         * @param index Segment index
+         * @param size Segment size in bytes
+         * @return etl::expected<uint8_t*, error::Error> Writable mapping of the segment
+         */
+        virtual etl::expected<uint8_t*, error::Error> map(uint32_t index, size_t size) = 0;
+
+        /**
+         * @brief Make a byte range of a mapped segment durable
+         *
+         * Must not return before the range has reached stable storage.
+         */
+        virtual etl::expected<void, error::Error> flush(uint32_t index, size_t offset, size_t length) = 0;
+
+        /**
+         * @brief Release a segment mapping; the segment stays on disk for export
+         */
+        virtual void unmap(uint32_t index) = 0;
+    };
+
+    /**
+     * @brief Journal configuration
+     */
+    struct TransactionJournalOptions
+    {
+        size_t segmentSize = 64U * 1024U;   // multiple of SLOT_SIZE, at least two slots
+        size_t groupSize = 16U;             // entries per flush
+        uint32_t groupDelayMs = 200U;       // flush older entries from poll() (needs a clock)
+        const uint8_t* macKey = nullptr;    // 16 byte AES key for entry MACs, optional
+        uint64_t (*clock)() = nullptr;      // timestamp source in milliseconds, optional
+    };
+
+    /**
+     * @brief Durability counters
+     */
+    struct TransactionJournalMetrics
+    {
+        uint32_t appended = 0U;     // entries written to a segment
+        uint32_t flushes = 0U;      // flush() calls issued
+        uint32_t rotations = 0U;    // segments started after the first
+        uint32_t recovered = 0U;    // entries found by recover()
+        uint32_t discarded = 0U;    // torn or unflushed slots cleared by recover()
+    };
+
+    /**
+     * @brief Append-only transaction journal with group commit
+     *
+     * append() copies the entry into the mapped segment and returns; the
+     * entry is durable once a flush covering it has returned. Flushes happen
+     * every groupSize entries, from poll() once the oldest unflushed entry
+     * is groupDelayMs old, on rotation, and on commit(). Entries that are not
+     * yet durable still survive a crash of the process, since they live in
+     * the shared mapping; only a power loss can take them.
+     *
+     * A full segment is flushed and released and the next one is started.
+     * recover() reopens the newest segment, keeps the run of complete
+     * entries with consecutive sequence numbers and clears the rest, since
+     * pages of an unflushed group may reach the disk in any order.
+     */
+    class TransactionJournal
+    {
+    public:
+        TransactionJournal(ITransactionJournalSegments& segments, const TransactionJournalOptions& options);
+        ~TransactionJournal();
+
+        TransactionJournal(const TransactionJournal&) = delete;
+        TransactionJournal& operator=(const TransactionJournal&) = delete;
+
+        /**
+         * @brief Open the newest segment, or start the first one
+         *
+         * @return etl::expected<uint32_t, error::Error> Number of entries kept in the newest segment
+         */
+        etl::expected<uint32_t, error::Error> recover();
+
+        /**
+         * @brief Append an entry
+         *
+         * The sequence number, timestamp (when a clock is set) and MAC are
+         * filled in by the journal.
+         *
+         * @param entry Entry to record
+         * @return etl::expected<uint32_t, error::Error> Sequence number of the entry
+         */
+        etl::expected<uint32_t, error::Error> append(const TransactionJournalEntry& entry);
+
+        /**
+         * @brief Flush the current group if its oldest entry has waited groupDelayMs
+         */
+        etl::expected<void, error::Error> poll();
+
+        /**
+         * @brief Flush every appended entry
+         */
+        etl::expected<void, error::Error> commit();
+
+        /**
+         * @brief Check whether an entry has been flushed
+         */
+        bool isDurable(uint32_t sequence) const;
+
+        /**
+         * @brief Sequence number the next entry will get
+         */
+        uint32_t nextSequence() const;
+
+        /**
+         * @brief Index of the segment being written
+         */
+        uint32_t segmentIndex() const;
+
+        const TransactionJournalMetrics& metrics() const;
+
+    private:
+        etl::expected<void, error::Error> startSegment(uint32_t index, uint32_t firstSequence);
+        etl::expected<void, error::Error> rotate();
+        uint32_t scanSegment(const uint8_t* image, uint32_t firstSequence) const;
+
+        ITransactionJournalSegments& segments;
+        TransactionJournalOptions options;
+        uint8_t* segment;
+        uint32_t currentIndex;
+        size_t capacity;
+        size_t used;            // entry slots written in the current segment
+        size_t flushed;         // entry slots flushed in the current segment
+        uint32_t sequence;
+        uint32_t durableSequence;
+        uint64_t groupStart;
+        TransactionJournalMetrics journalMetrics;
+    };
+
+    /**
+     * @brief Records the operations of one card file in a transaction journal
+     *
+     * Shared by the value and record file accessors. An operation is only
+     * recorded after the card accepted it, so a failed append never fails
+     * the operation itself: retrying it would apply it twice. The failure is
+     * counted instead and its error kept for the caller to check.
+     */
+    class TransactionJournalRecorder
+    {
+    public:
+        TransactionJournalRecorder();
+
+        /**
+         * @brief Start or stop journaling
+         *
+         * Clears the failure count.
+         *
+         * @param journal Transaction journal (nullptr to stop journaling)
+         * @param uid UID of the card the file lives on
+         */
+        void attach(TransactionJournal* journal, const etl::ivector<uint8_t>& uid);
+
+        /**
+         * @brief Check whether a journal is attached
+         */
+        bool isAttached() const;
+
+        /**
+         * @brief Append an entry for an operation the card accepted
+         *
+         * @param type Operation
+         * @param aid Application the file belongs to
+         * @param fileNo File number
+         * @param delta Entry delta
+         * @param newValue Entry new value
+         * @param flags Entry flags
+         * @return true if the entry was appended, false without a journal or when the append failed
+         */
+        bool record(
+            TransactionJournalType type,
+            const etl::ivector<uint8_t>& aid,
+            uint8_t fileNo,
+            int32_t delta,
+            int32_t newValue,
+            uint8_t flags = 0U);
+
+        /**
+         * @brief Get the number of appends that failed since attach()
+         */
+        uint32_t failures() const;
+
+        /**
+         * @brief Get the error of the last failed append
+         */
+        const etl::optional<error::Error>& lastError() const;
+
+    private:
+        TransactionJournal* journal;
+        etl::vector<uint8_t, 10> uid;
+        uint32_t failed;
+        etl::optional<error::Error> lastFailure;
+    };
+
+    /**
+     * @brief Sequential reader for exporting a segment
+     *
+     * Works on a separate read-only mapping of a segment and never writes
+     * to it, so it can run while the journal is appending. next() stops at
+     * the first slot that is not a complete entry; calling it again later
+     * picks up entries appended in the meantime.
+     */
+    class TransactionJournalReader
+    {
+    public:
+        TransactionJournalReader() = default;
+
+        /**
+         * @brief Attach to a segment image
+         *
+         * @param image Segment bytes
+         * @param size Mapping size
+         * @return etl::expected<void, error::Error> Success, or ParameterError for a malformed header
+         */
+        etl::expected<void, error::Error> open(const uint8_t* image, size_t size);
+
+        /**
+         * @brief Read the next entry
+         *
+         * @param entry Decoded entry
+         * @return true if an entry was read
+         */
+        bool next(TransactionJournalEntry& entry);
+
+        /**
+         * @brief Check whether every slot of the segment has been read
+         */
+        bool atEnd() const;
+
+        uint32_t segmentIndex() const;
+        uint32_t nextSequence() const;
+
+    private:
+        const uint8_t* image = nullptr;
+        size_t slots = 0U;
+        size_t position = 0U;
+        uint32_t index = 0U;
+        uint32_t expectedSequence = 0U;
+    };
+
+} // namespace nfc
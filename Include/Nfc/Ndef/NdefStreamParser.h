@@ -0,0 +1,148 @@
+/**
+ * @file NdefStreamParser.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Incremental NDEF message parser
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <etl/vector.h>
+#include <etl/expected.h>
+#include "Error/Error.h"
+
+namespace nfc
+{
+    /**
+     * @brief NDEF record header flags
+     */
+    namespace ndef
+    {
+        constexpr uint8_t FLAG_MB = 0x80U;   // Message begin
+        constexpr uint8_t FLAG_ME = 0x40U;   // Message end
+        constexpr uint8_t FLAG_CF = 0x20U;   // Chunk flag
+        constexpr uint8_t FLAG_SR = 0x10U;   // Short record (1-byte payload length)
+        constexpr uint8_t FLAG_IL = 0x08U;   // ID length present
+        constexpr uint8_t TNF_MASK = 0x07U;
+    }
+
+    /**
+     * @brief Type Name Format of an NDEF record
+     */
+    enum class NdefTnf : uint8_t
+    {
+        Empty = 0x00,
+        WellKnown = 0x01,
+        Media = 0x02,
+        AbsoluteUri = 0x03,
+        External = 0x04,
+        Unknown = 0x05,
+        Unchanged = 0x06,
+        Reserved = 0x07
+    };
+
+    /**
+     * @brief Decoded NDEF record header
+     */
+    struct NdefRecordHeader
+    {
+        uint8_t flags = 0U;                 // MB/ME/CF/SR/IL bits
+        NdefTnf tnf = NdefTnf::Empty;
+        uint32_t payloadLength = 0U;
+        etl::vector<uint8_t, 255> type;
+        etl::vector<uint8_t, 255> id;
+    };
+
+    /**
+     * @brief Receives records from an NdefStreamParser
+     *
+     * Payloads are delivered in the pieces they arrive in; a handler that
+     * needs the whole payload must collect it itself.
+     */
+    class INdefRecordHandler
+    {
+    public:
+        virtual ~INdefRecordHandler() = default;
+
+        virtual void onRecordBegin(const NdefRecordHeader& header) = 0;
+        virtual void onPayload(const uint8_t* data, size_t length) = 0;
+        virtual void onRecordEnd() = 0;
+    };
+
+    /**
+     * @brief Single-pass NDEF message parser
+     *
+     * Accepts the message in arbitrary pieces (for example one reader frame
+     * at a time) and keeps only the header of the current record, so the
+     * message itself never needs to be buffered.
+     */
+    class NdefStreamParser
+    {
+    public:
+        /**
+         * @brief Construct a parser
+         *
+         * @param handler Record consumer
+         */
+        explicit NdefStreamParser(INdefRecordHandler& handler);
+
+        /**
+         * @brief Consume the next piece of the message
+         *
+         * @param data Message bytes
+         * @param length Number of bytes
+         * @return etl::expected<void, error::Error> Success, or InvalidResponse on malformed records
+         */
+        etl::expected<void, error::Error> feed(const uint8_t* data, size_t length);
+
+        /**
+         * @brief Check that the message ended on a record boundary
+         *
+         * @return etl::expected<void, error::Error> Success, or LengthError when truncated
+         */
+        etl::expected<void, error::Error> finish() const;
+
+        /**
+         * @brief Restart at the beginning of a new message
+         */
+        void reset();
+
+        /**
+         * @brief Get the number of complete records parsed
+         */
+        size_t recordCount() const;
+
+    private:
+        enum class State : uint8_t
+        {
+            Header,
+            TypeLength,
+            PayloadLength,
+            IdLength,
+            Type,
+            Id,
+            Payload,
+            Done
+        };
+
+        void beginPayload();
+        void endRecord();
+
+        INdefRecordHandler& handler;
+        NdefRecordHeader header;
+        State state;
+        uint8_t typeLength;
+        uint8_t idLength;
+        uint8_t lengthBytesLeft;
+        uint32_t payloadLeft;
+        size_t records;
+        bool inChunkedRecord;
+    };
+
+} // namespace nfc
@@ -0,0 +1,118 @@
+/**
+ * @file NdefType4Tag.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief NFC Forum Type 4 Tag NDEF access on DESFire cards
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <etl/array.h>
+#include <etl/expected.h>
+#include "NdefStreamParser.h"
+#include "Error/Error.h"
+
+namespace nfc
+{
+    class DesfireCard;
+
+    /**
+     * @brief Location of the NDEF application on the card
+     *
+     * Defaults follow the DESFire Type 4 Tag mapping: native AID 0xEEEE10
+     * (ISO DF name D2760000850101), CC file 01 (ISO E103) and NDEF file 02
+     * (ISO E104). The AID is given LSB first, as for SelectApplication.
+     */
+    struct NdefType4Options
+    {
+        etl::array<uint8_t, 3> aid = {0x10U, 0xEEU, 0xEEU};
+        uint8_t ccFileNo = 0x01U;
+        uint8_t ndefFileNo = 0x02U;
+        uint16_t chunkSize = 0U;    // Bytes per ReadData/WriteData; 0 uses the CC limits
+    };
+
+    /**
+     * @brief Parsed Capability Container
+     */
+    struct NdefCapabilityContainer
+    {
+        uint8_t mappingVersion = 0U;
+        uint16_t maxReadLength = 0U;     // MLe
+        uint16_t maxWriteLength = 0U;    // MLc
+        uint16_t ndefFileId = 0U;
+        uint32_t maxNdefFileSize = 0U;   // Including the NLEN field
+        uint8_t readAccess = 0U;
+        uint8_t writeAccess = 0U;
+    };
+
+    /**
+     * @brief Type 4 Tag NDEF reader and writer on top of DesfireCard
+     *
+     * Reading streams the message through an NdefStreamParser one chunk at
+     * a time, so messages larger than DesfireCard::MAX_DATA_IO_SIZE can be
+     * read without a message-sized buffer. The NDEF application uses plain
+     * communication and no authentication.
+     */
+    class NdefType4Tag
+    {
+    public:
+        /// Size of the NLEN field at the start of the NDEF file
+        static constexpr size_t NLEN_SIZE = 2U;
+
+        /**
+         * @brief Construct a Type 4 Tag accessor
+         *
+         * @param card DESFire card session
+         * @param options Application and file location
+         */
+        explicit NdefType4Tag(DesfireCard& card, const NdefType4Options& options = NdefType4Options());
+
+        /**
+         * @brief Select the NDEF application and read the CC file
+         *
+         * @return etl::expected<NdefCapabilityContainer, error::Error> Capability container or error
+         */
+        etl::expected<NdefCapabilityContainer, error::Error> open();
+
+        /**
+         * @brief Read the NDEF message and feed it to a record handler
+         *
+         * Calls open() first if it has not succeeded yet.
+         *
+         * @param handler Record consumer
+         * @return etl::expected<uint32_t, error::Error> Message length (NLEN) or error
+         */
+        etl::expected<uint32_t, error::Error> readMessage(INdefRecordHandler& handler);
+
+        /**
+         * @brief Replace the NDEF message
+         *
+         * Follows the Type 4 Tag update procedure: NLEN is set to zero, the
+         * message body is written, then NLEN is written in a single command.
+         * A reader that sees a torn update finds an empty message, never a
+         * partial one.
+         *
+         * @param message Encoded NDEF message
+         * @param length Message length
+         * @return etl::expected<void, error::Error> Success, or BoundaryError if it does not fit
+         */
+        etl::expected<void, error::Error> writeMessage(const uint8_t* message, size_t length);
+
+    private:
+        etl::expected<void, error::Error> writeFile(uint32_t offset, const uint8_t* data, size_t length);
+        uint16_t readChunkSize() const;
+        uint16_t writeChunkSize() const;
+
+        DesfireCard& card;
+        NdefType4Options options;
+        NdefCapabilityContainer capabilities;
+        bool opened;
+    };
+
+} // namespace nfc
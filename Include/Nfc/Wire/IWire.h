@@ -42,9 +42,9 @@ namespace nfc
          * @brief Unwrap an APDU response to get the PDU
          * 
          * @param apdu APDU response to unwrap
-         * @return etl::expected<etl::vector<uint8_t, buffer::APDU_DATA_MAX>, error::Error> Unwrapped PDU or error
+         * @return etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> Unwrapped PDU or error
          */
-        virtual etl::expected<etl::vector<uint8_t, buffer::APDU_DATA_MAX>, error::Error> unwrap(const etl::ivector<uint8_t>& apdu) = 0;
+        virtual etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> unwrap(const etl::ivector<uint8_t>& apdu) = 0;
     };
 
 } // namespace nfc
@@ -13,6 +13,7 @@
 
 #include "IWire.h"
 #include "Nfc/BufferSizes.h"
+#include <etl/array.h>
 
 namespace nfc
 {
@@ -38,9 +39,35 @@ namespace nfc
          * @brief Unwrap ISO 7816-4 APDU response
          * 
          * @param apdu APDU response to unwrap
-         * @return etl::expected<etl::vector<uint8_t, buffer::APDU_DATA_MAX>, error::Error> Unwrapped PDU or error
+         * @return etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> Unwrapped PDU or error
          */
-        etl::expected<etl::vector<uint8_t, buffer::APDU_DATA_MAX>, error::Error> unwrap(const etl::ivector<uint8_t>& apdu) override;
+        etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> unwrap(const etl::ivector<uint8_t>& apdu) override;
+
+        /**
+         * @brief Wrap a fixed DESFire command at compile time
+         * 
+         * Produces exactly the bytes wrap() would produce for the PDU
+         * [Command][Data...]: 90 CMD 00 00 [Lc Data...] 00
+         * 
+         * @tparam Command DESFire command code (INS)
+         * @tparam Data Fixed command data bytes
+         * @return etl::array<uint8_t, N> Wrapped APDU
+         */
+        template <uint8_t Command, uint8_t... Data>
+        static constexpr auto wrapFixed()
+        {
+            static_assert(sizeof...(Data) <= buffer::APDU_COMMAND_DATA_MAX, "Fixed APDU data too large");
+
+            if constexpr (sizeof...(Data) == 0U)
+            {
+                return etl::array<uint8_t, 5U>{{0x90, Command, 0x00, 0x00, 0x00}};
+            }
+            else
+            {
+                return etl::array<uint8_t, 6U + sizeof...(Data)>{{
+                    0x90, Command, 0x00, 0x00, static_cast<uint8_t>(sizeof...(Data)), Data..., 0x00}};
+            }
+        }
     };
 
 } // namespace nfc
@@ -38,9 +38,9 @@ namespace nfc
          * @brief Unwrap native format response
          * 
          * @param apdu Response to unwrap
-         * @return etl::expected<etl::vector<uint8_t, buffer::APDU_DATA_MAX>, error::Error> Unwrapped PDU or error
+         * @return etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> Unwrapped PDU or error
          */
-        etl::expected<etl::vector<uint8_t, buffer::APDU_DATA_MAX>, error::Error> unwrap(const etl::ivector<uint8_t>& apdu) override;
+        etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> unwrap(const etl::ivector<uint8_t>& apdu) override;
     };
 
 } // namespace nfc
@@ -12,14 +12,51 @@
 #pragma once
 
 #include <etl/vector.h>
+#include <etl/array.h>
 #include <etl/string.h>
 #include <cstdint>
+#include <cstddef>
 
 namespace pn532
 {
     // Forward declaration for friend class
     class IPn532Command;
 
+    /**
+     * @brief Reference to a complete, compile-time built PN532 frame
+     * 
+     * Points into static storage (see Pn532PrecomputedFrames.h); the frame
+     * already contains LEN/LCS/DCS and is sent as-is by the driver.
+     */
+    struct PrecomputedFrame
+    {
+        const uint8_t* bytes = nullptr;
+        size_t length = 0;
+
+        /**
+         * @brief Create a reference to a static frame
+         * 
+         * @tparam N Frame size
+         * @param frame Frame with static storage duration
+         * @return PrecomputedFrame Frame reference
+         */
+        template <size_t N>
+        static PrecomputedFrame of(const etl::array<uint8_t, N>& frame)
+        {
+            return PrecomputedFrame{frame.data(), N};
+        }
+
+        /**
+         * @brief Check if no frame is referenced
+         * 
+         * @return bool True if empty
+         */
+        bool empty() const
+        {
+            return bytes == nullptr || length == 0;
+        }
+    };
+
     /**
      * @brief Represents a PN532 command request
      * 
@@ -78,6 +115,20 @@ namespace pn532
          */
         bool expectsDataFrame() const;
 
+        /**
+         * @brief Check if the request carries a precomputed wire frame
+         * 
+         * @return bool True if the driver can send precomputedFrame() without building
+         */
+        bool hasPrecomputedFrame() const;
+
+        /**
+         * @brief Get the precomputed wire frame
+         * 
+         * @return const PrecomputedFrame& Frame reference (empty if none)
+         */
+        const PrecomputedFrame& precomputedFrame() const;
+
     private:
         /**
          * @brief Construct a new CommandRequest object
@@ -86,13 +137,15 @@ namespace pn532
          * @param payload Payload data
          * @param timeout Response timeout in milliseconds
          * @param expectsData Whether command expects a data frame response
+         * @param frame Precomputed wire frame matching cmd/payload (optional)
          */
-        CommandRequest(uint8_t cmd, const etl::ivector<uint8_t>& payload, uint32_t timeout = 1000, bool expectsData = true);
+        CommandRequest(uint8_t cmd, const etl::ivector<uint8_t>& payload, uint32_t timeout = 1000, bool expectsData = true, PrecomputedFrame frame = PrecomputedFrame{});
 
         uint8_t commandCode;
         etl::vector<uint8_t, MaxPayloadSize> payload;
         uint32_t responseTimeoutMs;
         bool expectsData;
+        PrecomputedFrame fixedFrame;
 
     friend class IPn532Command;
     };
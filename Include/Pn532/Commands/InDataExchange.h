@@ -41,6 +41,11 @@ namespace pn532
     class InDataExchange : public IPn532Command
     {
     public:
+        /// Status byte layout: [NAD][MI][ErrorCode(6)]
+        static constexpr uint8_t STATUS_ERROR_MASK = 0x3F;
+        static constexpr uint8_t STATUS_MI = 0x40;
+        static constexpr uint8_t STATUS_NAD = 0x80;
+
         explicit InDataExchange(const InDataExchangeOptions& opts);
 
         etl::string_view name() const override;
@@ -58,7 +63,7 @@ namespace pn532
         /**
          * @brief Get the status as Pn532Error
          * 
-         * @return Pn532Error Mapped PN532 error code
+         * @return Pn532Error Mapped PN532 error code (MI/NAD bits masked off)
          */
         Pn532Error getStatus() const;
 
@@ -66,10 +71,21 @@ namespace pn532
         /**
          * @brief Check if exchange was successful
          * 
-         * @return bool True if success (status == 0x00)
+         * @return bool True if success (error code bits == 0)
          */
         bool isSuccess() const;
 
+        /**
+         * @brief Check if the card response continues in another exchange
+         *
+         * The PN532 sets MI when the card's answer did not fit in one frame;
+         * the rest is fetched with further InDataExchange rounds carrying
+         * no DataOut.
+         *
+         * @return bool True if the MI bit is set
+         */
+        bool hasMoreInformation() const;
+
         /**
          * @brief Get response data from card
          * 
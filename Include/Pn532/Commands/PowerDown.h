@@ -0,0 +1,75 @@
+/**
+ * @file PowerDown.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief PowerDown command for PN532
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include "Pn532/IPn532Command.h"
+#include <cstdint>
+
+namespace pn532
+{
+    /**
+     * @brief Events that bring the PN532 out of Power Down (WakeUpEnable bits)
+     *
+     */
+    enum class WakeUpSource : uint8_t
+    {
+        Int0 = 0x01,        // P32_INT0 pin
+        Int1 = 0x02,        // P33_INT1 pin
+        RfLevel = 0x08,     // RF level detector: an external field (phone, other reader)
+        Hsu = 0x10,         // activity on the HSU line
+        Spi = 0x20,
+        Gpio = 0x40,        // P34/P71/P72 pins
+        I2c = 0x80
+    };
+
+    /**
+     * @brief Combine wake-up sources into a WakeUpEnable byte
+     *
+     */
+    constexpr uint8_t operator|(WakeUpSource lhs, WakeUpSource rhs)
+    {
+        return static_cast<uint8_t>(static_cast<uint8_t>(lhs) | static_cast<uint8_t>(rhs));
+    }
+
+    /**
+     * @brief PowerDown command options
+     *
+     */
+    struct PowerDownOptions
+    {
+        uint8_t wakeUpEnable = WakeUpSource::Hsu | WakeUpSource::RfLevel;
+        bool generateIrq = false;   // drive P70_IRQ low on wake-up
+    };
+
+    /**
+     * @brief PowerDown command - Put the PN532 in Power Down mode
+     *
+     * The PN532 answers before it goes down. The RF field is off while
+     * it sleeps; a passive card in front of the antenna cannot wake it.
+     * Configuration (SAM, RF retries) survives, so after wake-up the next
+     * command can be sent straight away.
+     */
+    class PowerDown : public IPn532Command
+    {
+    public:
+        explicit PowerDown(const PowerDownOptions& opts);
+
+        etl::string_view name() const override;
+        CommandRequest buildRequest() override;
+        etl::expected<CommandResponse, error::Error> parseResponse(const Pn532ResponseFrame& frame) override;
+        bool expectsDataFrame() const override;
+
+    private:
+        PowerDownOptions options;
+    };
+
+} // namespace pn532
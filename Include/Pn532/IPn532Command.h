@@ -69,6 +69,18 @@ namespace pn532
             return CommandRequest(cmd, payload, timeout, expectsData);
         }
 
+        /**
+         * @brief Factory method to create CommandRequest backed by a precomputed frame
+         * 
+         * The frame must encode exactly cmd and payload; the driver sends it
+         * instead of building the frame at runtime.
+         * 
+         */
+        static CommandRequest createPrecomputedCommandRequest(uint8_t cmd, const etl::ivector<uint8_t>& payload, PrecomputedFrame frame, uint32_t timeout = 1000, bool expectsData = true)
+        {
+            return CommandRequest(cmd, payload, timeout, expectsData, frame);
+        }
+
         /**
          * @brief Factory method to create CommandResponse
          * 
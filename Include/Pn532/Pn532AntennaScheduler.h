@@ -0,0 +1,188 @@
+/**
+ * @file Pn532AntennaScheduler.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief RF time slots for co-located PN532 readers
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <etl/vector.h>
+#include <etl/expected.h>
+
+#include "Error/Error.h"
+
+namespace pn532
+{
+    class Pn532Driver;  // Forward declaration
+
+    /**
+     * @brief How the readers' fields are managed
+     */
+    enum class AntennaSchedulingMode : uint8_t
+    {
+        Shared,     // every field stays on; slots only order the work (baseline)
+        Exclusive   // only the reader holding the slot has its field on
+    };
+
+    /**
+     * @brief What a slot is for
+     */
+    enum class AntennaSlotKind : uint8_t
+    {
+        Poll,           // look for a card, then beginTransaction() or let the slot pass
+        Transaction     // continue the transaction on this reader
+    };
+
+    /**
+     * @brief One RF time slot
+     */
+    struct AntennaSlot
+    {
+        size_t reader = 0U;
+        AntennaSlotKind kind = AntennaSlotKind::Poll;
+        uint32_t budgetMs = 0U;     // time to use before asking for the next slot
+    };
+
+    /**
+     * @brief Slot lengths and limits
+     */
+    struct AntennaSchedulerOptions
+    {
+        AntennaSchedulingMode mode = AntennaSchedulingMode::Exclusive;
+        uint32_t minPollBurstMs = 20U;          // poll slot of a reader that has not seen cards lately
+        uint32_t maxPollBurstMs = 100U;         // poll slot of a reader that keeps finding cards
+        uint32_t transactionLimitMs = 2000U;    // longest a transaction keeps the field to itself
+        uint32_t (*clock)() = nullptr;          // millisecond tick, utils::get_tick_ms when unset
+    };
+
+    /**
+     * @brief Counters since construction
+     *
+     * Run a gate once in Shared and once in Exclusive mode and compare
+     * rfErrors / exchanges to see what the interference cost.
+     */
+    struct AntennaSchedulerMetrics
+    {
+        uint32_t pollSlots = 0U;
+        uint32_t transactionSlots = 0U;
+        uint32_t transactions = 0U;             // begun with beginTransaction()
+        uint32_t transactionsRevoked = 0U;      // ran past transactionLimitMs
+        uint32_t fieldSwitches = 0U;
+        uint32_t fieldSwitchFailures = 0U;
+        uint32_t exchanges = 0U;                // reported through recordSuccess()/recordFailure()
+        uint32_t rfErrors = 0U;                 // failures interference causes: CRC, parity, target timeout...
+        uint32_t overlapMs = 0U;                // time more than one field was on
+    };
+
+    /**
+     * @brief Hands out RF time slots to PN532 readers whose fields interfere
+     *
+     * The application asks nextSlot() what to do and does it on the reader
+     * named, for about the slot's budget. In Exclusive mode the field of the
+     * previous holder is switched off before the new holder's goes on, so
+     * two fields are never on together.
+     *
+     * Idle readers take turns in short poll bursts. A reader that finds a
+     * card calls beginTransaction() and keeps the field, and every slot,
+     * until endTransaction() or transactionLimitMs: switching its field off
+     * would power down the card mid-transaction. Poll bursts adapt to
+     * demand: they double each time a reader starts a transaction, up to
+     * maxPollBurstMs, and shrink by a quarter each burst that finds nothing,
+     * down to minPollBurstMs.
+     *
+     * Only the reader holding the slot may be sent RF commands; the PN532
+     * switches its field back on by itself for InListPassiveTarget.
+     */
+    class Pn532AntennaScheduler
+    {
+    public:
+        static constexpr size_t MAX_READERS = 4U;
+
+        explicit Pn532AntennaScheduler(const AntennaSchedulerOptions& options = AntennaSchedulerOptions());
+
+        /**
+         * @brief Add a reader to the rotation
+         *
+         * Switches its field off (Exclusive) or on (Shared).
+         *
+         * @param driver Initialized driver; must outlive the scheduler
+         * @return etl::expected<size_t, error::Error> Reader index, or the driver error
+         */
+        etl::expected<size_t, error::Error> addReader(Pn532Driver& driver);
+
+        /**
+         * @brief Move on to the next slot
+         *
+         * A field that cannot be switched off keeps every other field off;
+         * the error is returned until the reader recovers.
+         *
+         * @return etl::expected<AntennaSlot, error::Error> Slot, or the driver error of a failed field switch
+         */
+        etl::expected<AntennaSlot, error::Error> nextSlot();
+
+        /**
+         * @brief Keep the field for a transaction on the card just found
+         *
+         * @param reader Reader of the current poll slot
+         * @return etl::expected<void, error::Error> void on success, InvalidDeviceState when
+         *         the reader does not hold the current poll slot
+         */
+        etl::expected<void, error::Error> beginTransaction(size_t reader);
+
+        /**
+         * @brief Give the field back to the rotation
+         *
+         * @param reader Reader that ran the transaction
+         */
+        void endTransaction(size_t reader);
+
+        /**
+         * @brief Count an exchange that went through
+         */
+        void recordSuccess();
+
+        /**
+         * @brief Count a failed exchange, as an RF error when interference can cause it
+         *
+         * @param error Error returned by the exchange
+         */
+        void recordFailure(const error::Error& error);
+
+        const AntennaSchedulerMetrics& getMetrics() const;
+
+    private:
+        static constexpr size_t NO_READER = MAX_READERS;
+
+        struct Reader
+        {
+            Pn532Driver* driver = nullptr;
+            bool fieldOn = false;
+            uint32_t pollBurstMs = 0U;
+        };
+
+        etl::expected<void, error::Error> giveFieldTo(size_t reader);
+        etl::expected<void, error::Error> switchField(size_t reader, bool on);
+        void accountOverlap(uint32_t now);
+        uint32_t nowMs() const;
+
+        AntennaSchedulerOptions options;
+        AntennaSchedulerMetrics metrics;
+        etl::vector<Reader, MAX_READERS> readers;
+
+        size_t holder;              // reader whose field is on (Exclusive)
+        size_t cursor;              // next reader to poll
+        size_t slotReader;          // reader of the last slot handed out
+        AntennaSlotKind slotKind;
+        size_t transactionReader;
+        uint32_t transactionStartMs;
+        uint32_t lastTickMs;
+    };
+
+} // namespace pn532
@@ -15,6 +15,7 @@
 #include "Nfc/Apdu/ApduResponse.h"
 #include "Nfc/Card/ICardDetector.h"
 #include "Nfc/Card/CardInfo.h"
+#include "Pn532/Commands/PowerDown.h"
 #include "Error/Error.h"
 
 #include <etl/vector.h>
@@ -26,6 +27,32 @@ namespace pn532
 {
     class Pn532Driver;  // Forward declaration
 
+    /**
+     * @brief Power saving between taps
+     *
+     * An idle detectCard() puts the PN532 in Power Down and blocks the host
+     * on the bus for sleepMs before returning; the next call wakes the chip
+     * with the preamble in front of its InListPassiveTarget frame. A card
+     * is found at most sleepMs plus one detection after it arrives.
+     */
+    struct PowerSavingOptions
+    {
+        bool enabled = false;
+        uint32_t sleepMs = 200U;            // host wait per idle detectCard(), chip powered down
+        uint8_t passiveRetries = 0x02U;     // activation attempts before InListPassiveTarget reports no card
+        uint8_t wakeUpEnable = WakeUpSource::Hsu | WakeUpSource::RfLevel;
+    };
+
+    /**
+     * @brief Power saving counters
+     */
+    struct PowerSavingMetrics
+    {
+        uint32_t sleeps = 0U;               // idle detections followed by Power Down
+        uint32_t earlyWakeUps = 0U;         // sleeps ended by the chip before sleepMs
+        uint32_t powerDownFailures = 0U;
+    };
+
 
     /**
      * @brief Adapter that wraps Pn532Driver to provide APDU and card detection interfaces
@@ -61,7 +88,7 @@ namespace pn532
          * @param apdu Command data to send
          * @return Expected PDU [Status][Data...] on success, Error on failure
          */
-        etl::expected<etl::vector<uint8_t, buffer::APDU_DATA_MAX>, error::Error> transceive(
+        etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> transceive(
             const etl::ivector<uint8_t> &apdu) override;
 
         // ICardDetector interface implementation
@@ -78,9 +105,26 @@ namespace pn532
          */
         bool isCardPresent() override;
 
+        /**
+         * @brief Enable or disable power saving between taps
+         *
+         * Sets the passive activation retries, so that detectCard() comes
+         * back when no card answers instead of waiting for one.
+         *
+         * @param options Power saving settings
+         * @return Expected void on success, Error when the retries cannot be set
+         */
+        etl::expected<void, error::Error> setPowerSaving(const PowerSavingOptions &options);
+
+        const PowerSavingMetrics &getPowerSavingMetrics() const;
+
     private:
+        void sleepUntilNextDetection();
+
         Pn532Driver &driver;
         IWire* activeWire;  // Current wire protocol for card session
+        PowerSavingOptions powerSaving;
+        PowerSavingMetrics powerSavingMetrics;
     };
 
 } // namespace pn532
\ No newline at end of file
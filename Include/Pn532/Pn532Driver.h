@@ -9,11 +9,13 @@
 
 #include "Error/Error.h"
 #include "Comms/IHardwareBus.hpp"
+#include "Nfc/Card/RetryPolicy.h"
 
 // Command-specific structures
 #include "Commands/GetFirmwareVersion.h"
 #include "Commands/GetGeneralStatus.h"
 #include "Commands/SetSerialBaudRate.h"
+#include "Commands/PowerDown.h"
 
 using namespace error;
 
@@ -38,6 +40,9 @@ namespace pn532
         // Command execution
         etl::expected<CommandResponse, Error> executeCommand(IPn532Command &command);
 
+        // Link-level retries (resend on missing ACK, NACK on corrupted response); nullptr disables
+        void setRetryPolicy(nfc::RetryPolicy* policy);
+
         // Firmware and status
         etl::expected<FirmwareInfo, Error> getFirmwareVersion();
         etl::expected<void, Error> performSelftest();
@@ -45,10 +50,15 @@ namespace pn532
 
         // Configuration
         etl::expected<void, Error> setSamConfiguration(uint8_t mode);
-        etl::expected<void, Error> setRfField(const bool state);
+        etl::expected<void, Error> setRfField(const bool state);  // switching off powers down any card in the field
         etl::expected<void, Error> setMaxRetries(const uint8_t maxRetries);
         etl::expected<void, Error> setSerialBaudrate(Pn532Baudrate baudrate);
 
+        // Power management: the first command after powerDown() carries the HSU wake-up preamble
+        etl::expected<void, Error> powerDown(const PowerDownOptions &options);
+        bool waitForWakeUp(const uint32_t timeoutMs);  // host blocks on the bus; true if the chip sent something
+        bool isPoweredDown() const;
+
         // Register operations
         etl::expected<void, Error> writeRegister(const uint16_t reg, const uint8_t val);
         etl::expected<uint8_t, Error> readRegister(const uint16_t reg);
@@ -60,14 +70,28 @@ namespace pn532
         // Static utility
         static uint32_t calculateChecksum(const etl::ivector<uint8_t> &data);
 
+        // Find and validate the response frame in raw bytes from the bus: skips leading
+        // garbage, ACKs and false start codes in linear time (public for the parser fuzzers)
+        static etl::expected<Pn532ResponseFrame, Error> parseResponseFrame(
+            const etl::ivector<uint8_t> &frame,
+            uint8_t sentCommandCode);
+
     private:
         // Member variables
         comms::IHardwareBus &bus;
+        nfc::RetryPolicy* retryPolicy;
+        bool poweredDown;
         static constexpr uint32_t DEFAULT_TIMEOUT_MS = 500;
         static constexpr etl::array<uint8_t, 6> ACK_FRAME = {0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00};
+        static constexpr etl::array<uint8_t, 6> NACK_FRAME = {0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00};
+        static constexpr etl::array<uint8_t, 16> HSU_WAKE_PREAMBLE = {
+            0x55, 0x55, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
         
         // Private methods
         etl::expected<Pn532ResponseFrame, Error> transceive(const CommandRequest & request);
+        etl::expected<void, Error> sendAndReadAck(const etl::ivector<uint8_t> &frame);
+        etl::expected<Pn532ResponseFrame, Error> readResponseFrame(const CommandRequest &request);
         etl::expected<void, Error> sendCommand(const etl::ivector<uint8_t> &data);
         etl::expected<Pn532Response, Error> getResponse(uint8_t onCommand, uint32_t timeoutMs);
         etl::expected<void, Error> sendAndAcknowledgeCommand(uint8_t command);
@@ -76,9 +100,6 @@ namespace pn532
         bool waitForChip(const int timeout);
 
         static bool checkAck(const etl::ivector<uint8_t> &buffer);
-        static etl::expected<Pn532ResponseFrame, Error> parseResponseFrame(
-            const etl::ivector<uint8_t> &frame, 
-            uint8_t sentCommandCode);
     };
 
 } // namespace pn532
\ No newline at end of file
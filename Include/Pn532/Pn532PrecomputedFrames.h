@@ -0,0 +1,103 @@
+/**
+ * @file Pn532PrecomputedFrames.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Compile-time built PN532 frames for fixed commands
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#pragma once
+
+#include <etl/vector.h>
+#include <cstdint>
+#include "Pn532/Pn532RequestFrame.h"
+#include "Pn532/CommandRequest.h"
+#include "Nfc/Wire/IsoWire.h"
+#include <etl/utility.h>
+
+namespace pn532
+{
+namespace frames
+{
+    // ========================================================================
+    // PN532 commands with fixed payloads
+    // ========================================================================
+
+    /// GetFirmwareVersion (0x02): 00 00 FF 02 FE D4 02 2A 00
+    inline constexpr auto GET_FIRMWARE_VERSION = Pn532RequestFrame::buildFixed<0x02>();
+
+    /// GetGeneralStatus (0x04): 00 00 FF 02 FE D4 04 28 00
+    inline constexpr auto GET_GENERAL_STATUS = Pn532RequestFrame::buildFixed<0x04>();
+
+    /// SAMConfiguration (0x14) normal mode, no timeout, no IRQ
+    inline constexpr auto SAM_CONFIGURATION_NORMAL = Pn532RequestFrame::buildFixed<0x14, 0x01, 0x00, 0x00>();
+
+    // ========================================================================
+    // DESFire commands without data, carried by InDataExchange (0x40) to Tg 1
+    // ========================================================================
+
+    /// Target number used by Pn532ApduAdapter for the detected card
+    constexpr uint8_t DESFIRE_TARGET = 0x01;
+
+    /**
+     * @brief InDataExchange frame carrying an ISO-wrapped DESFire command (90 INS 00 00 00)
+     * 
+     * The APDU comes from IsoWire::wrapFixed, so it matches what IsoWire::wrap sends.
+     * 
+     * @tparam Ins DESFire command code
+     */
+    template <uint8_t Ins>
+    inline constexpr auto DESFIRE_ISO_APDU = nfc::IsoWire::wrapFixed<Ins>();
+
+    template <uint8_t Ins, size_t... Index>
+    constexpr auto buildDesfireIsoExchange(etl::index_sequence<Index...>)
+    {
+        return Pn532RequestFrame::buildFixed<0x40, DESFIRE_TARGET, DESFIRE_ISO_APDU<Ins>[Index]...>();
+    }
+
+    template <uint8_t Ins>
+    constexpr auto buildDesfireIsoExchange()
+    {
+        return buildDesfireIsoExchange<Ins>(etl::make_index_sequence<DESFIRE_ISO_APDU<Ins>.size()>{});
+    }
+
+    /**
+     * @brief InDataExchange frame carrying a native DESFire command (INS)
+     * 
+     * @tparam Ins DESFire command code
+     */
+    template <uint8_t Ins>
+    constexpr auto buildDesfireNativeExchange()
+    {
+        return Pn532RequestFrame::buildFixed<0x40, DESFIRE_TARGET, Ins>();
+    }
+
+    inline constexpr auto DESFIRE_ISO_GET_VERSION = buildDesfireIsoExchange<0x60>();
+    inline constexpr auto DESFIRE_ISO_GET_APPLICATION_IDS = buildDesfireIsoExchange<0x6A>();
+    inline constexpr auto DESFIRE_ISO_FREE_MEMORY = buildDesfireIsoExchange<0x6E>();
+    inline constexpr auto DESFIRE_ISO_GET_FILE_IDS = buildDesfireIsoExchange<0x6F>();
+    inline constexpr auto DESFIRE_ISO_ADDITIONAL_FRAME = buildDesfireIsoExchange<0xAF>();
+
+    inline constexpr auto DESFIRE_NATIVE_GET_VERSION = buildDesfireNativeExchange<0x60>();
+    inline constexpr auto DESFIRE_NATIVE_GET_APPLICATION_IDS = buildDesfireNativeExchange<0x6A>();
+    inline constexpr auto DESFIRE_NATIVE_FREE_MEMORY = buildDesfireNativeExchange<0x6E>();
+    inline constexpr auto DESFIRE_NATIVE_GET_FILE_IDS = buildDesfireNativeExchange<0x6F>();
+    inline constexpr auto DESFIRE_NATIVE_ADDITIONAL_FRAME = buildDesfireNativeExchange<0xAF>();
+
+    /**
+     * @brief Look up a precomputed InDataExchange frame
+     * 
+     * Matches the InDataExchange payload ([Tg][DataOut...]) against the fixed
+     * DESFire commands above, in either native or ISO wrapping.
+     * 
+     * @param targetNumber Target number (Tg)
+     * @param dataOut Data sent to the card
+     * @return PrecomputedFrame Matching frame, or empty if the exchange is not fixed
+     */
+    PrecomputedFrame findInDataExchangeFrame(uint8_t targetNumber, const etl::ivector<uint8_t>& dataOut);
+
+} // namespace frames
+} // namespace pn532
@@ -12,6 +12,7 @@
 #pragma once
 
 #include <etl/vector.h>
+#include <etl/array.h>
 #include <etl/expected.h>
 #include <cstdint>
 #include "CommandRequest.h"
@@ -37,6 +38,13 @@ namespace pn532
     class Pn532RequestFrame
     {
     public:
+        /**
+         * @brief Framing overhead of a request frame
+         * 
+         * Preamble(1) + Start(2) + LEN(1) + LCS(1) + TFI(1) + CMD(1) + DCS(1) + Postamble(1) = 9 bytes
+         */
+        static constexpr size_t FRAME_OVERHEAD = 9;
+
         /**
          * @brief Build a PN532 frame from a command request
          * 
@@ -65,6 +73,39 @@ namespace pn532
          */
         static etl::vector<uint8_t, 6> buildNack();
 
+        /**
+         * @brief Build a PN532 frame for a fixed command at compile time
+         * 
+         * Produces exactly the bytes build() would produce for the same command
+         * code and payload, including LCS and DCS, so the frame can be stored in
+         * read-only memory and sent without a build step.
+         * 
+         * @tparam Command PN532 command code
+         * @tparam Data Fixed payload bytes
+         * @return etl::array<uint8_t, FRAME_OVERHEAD + sizeof...(Data)> Complete frame
+         */
+        template <uint8_t Command, uint8_t... Data>
+        static constexpr etl::array<uint8_t, FRAME_OVERHEAD + sizeof...(Data)> buildFixed()
+        {
+            static_assert(sizeof...(Data) + 2U <= nfc::buffer::PN532_DATA_MAX, "Fixed PN532 payload too large");
+
+            constexpr uint8_t length = static_cast<uint8_t>(sizeof...(Data) + 2U); // TFI + CMD + data
+            constexpr uint8_t sum = static_cast<uint8_t>(TFI_HOST_TO_PN532 + Command + (0U + ... + Data));
+
+            return {{
+                PREAMBLE,
+                START_CODE_1,
+                START_CODE_2,
+                length,
+                static_cast<uint8_t>(~length + 1),
+                TFI_HOST_TO_PN532,
+                Command,
+                Data...,
+                static_cast<uint8_t>(~sum + 1),
+                POSTAMBLE
+            }};
+        }
+
     private:
         // Frame protocol constants
         static constexpr uint8_t PREAMBLE = 0x00;
@@ -77,7 +77,7 @@ namespace rc522
          * @param apdu Command data to send
          * @return Expected PDU [Status][Data...] on success, Error on failure
          */
-        etl::expected<etl::vector<uint8_t, buffer::APDU_DATA_MAX>, error::Error> transceive(
+        etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> transceive(
             const etl::ivector<uint8_t> &apdu) override;
 
         // ICardDetector interface implementation
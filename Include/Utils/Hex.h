@@ -0,0 +1,88 @@
+/**
+ * @file Hex.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Table-driven hex encoding and decoding
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <etl/string.h>
+
+namespace utils
+{
+    /**
+     * @brief Number of characters hexEncode() writes
+     *
+     * @param length Number of bytes
+     * @param separated true when a separator goes between bytes
+     * @return size_t Characters, without terminator
+     */
+    constexpr size_t hexEncodedLength(size_t length, bool separated = false)
+    {
+        if (length == 0U)
+        {
+            return 0U;
+        }
+        return separated ? (length * 3U) - 1U : length * 2U;
+    }
+
+    /**
+     * @brief Encode bytes as upper-case hex
+     *
+     * One table lookup per byte, no formatting calls. Does not terminate
+     * the output.
+     *
+     * @param data Bytes to encode
+     * @param length Number of bytes
+     * @param out Output, at least hexEncodedLength(length, separator != '\0') characters
+     * @param separator Character between bytes, '\0' for none
+     * @return size_t Characters written
+     */
+    size_t hexEncode(const uint8_t* data, size_t length, char* out, char separator = '\0');
+
+    /**
+     * @brief Append bytes as upper-case hex to a string
+     *
+     * Stops at the last whole byte that fits the string's capacity.
+     *
+     * @param text String to append to
+     * @param data Bytes to encode
+     * @param length Number of bytes
+     * @param separator Character between bytes, '\0' for none
+     */
+    void appendHex(etl::istring& text, const uint8_t* data, size_t length, char separator = ' ');
+
+    /**
+     * @brief Decode a string of hex digit pairs, e.g. "04A1FF"
+     *
+     * @param text Hex digits, either case
+     * @param length Number of characters
+     * @param out Output bytes
+     * @param capacity Size of out
+     * @param outLength Bytes decoded
+     * @return true Decoded; false on an odd length, a non-hex character or too little capacity
+     */
+    bool hexDecode(const char* text, size_t length, uint8_t* out, size_t capacity, size_t& outLength);
+
+    /**
+     * @brief Decode hex written for people, e.g. "04 A1 FF" or "04:a1:ff"
+     *
+     * Every character that is not a hex digit is skipped.
+     *
+     * @param text Hex digits with separators
+     * @param length Number of characters
+     * @param out Output bytes
+     * @param capacity Size of out
+     * @param outLength Bytes decoded
+     * @return true Decoded; false on an odd number of digits or too little capacity
+     */
+    bool hexDecodeLoose(const char* text, size_t length, uint8_t* out, size_t capacity, size_t& outLength);
+
+} // namespace utils
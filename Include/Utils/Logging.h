@@ -15,8 +15,11 @@
 #include <cstdio>
 #include <cstring>
 #include <cstdint>
+#include "Utils/Hex.h"
 
+#ifndef ENABLE_LOGGING
 #define ENABLE_LOGGING 1
+#endif
 
 #define LOG_INFO(fmt, ...)  Logger::log("INFO", __FILE__, __LINE__, fmt, ##__VA_ARGS__)
 #define LOG_WARN(fmt, ...)  Logger::log("WARN", __FILE__, __LINE__, fmt, ##__VA_ARGS__)
@@ -77,9 +80,15 @@ public:
                     COLOR_GRAY, file, line, COLOR_RESET,
                     name, len);
 
+        // Encode a chunk at a time and print it in one call, not one printf per byte
         const uint8_t* bytes = static_cast<const uint8_t*>(data);
-        for (size_t i = 0; i < len; ++i) {
-            std::printf("%02X ", bytes[i]);
+        constexpr size_t CHUNK = 64;
+        char text[CHUNK * 3];
+        for (size_t offset = 0; offset < len; offset += CHUNK) {
+            const size_t count = (len - offset < CHUNK) ? len - offset : CHUNK;
+            const size_t written = utils::hexEncode(bytes + offset, count, text, ' ');
+            text[written] = ' ';
+            std::fwrite(text, 1, written + 1, stdout);
         }
         std::printf("\n");
 #endif
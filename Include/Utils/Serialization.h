@@ -0,0 +1,70 @@
+/**
+ * @file Serialization.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Little-endian fields and CRC32 for persisted binary images
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace utils
+{
+    /**
+     * @brief CRC-32 (IEEE 802.3: reflected 0xEDB88320, initial and final value 0xFFFFFFFF)
+     *
+     * Integrity check of journal, campaign and hotlist images. Not the
+     * DESFire CRC32, which leaves out the final inversion.
+     *
+     * @param data Bytes to check
+     * @param length Number of bytes
+     * @param previous CRC of the preceding bytes, to checksum data in chunks
+     * @return uint32_t CRC
+     */
+    uint32_t crc32(const uint8_t* data, size_t length, uint32_t previous = 0U);
+
+    inline void writeLe16(uint8_t* out, uint16_t value)
+    {
+        out[0] = static_cast<uint8_t>(value & 0xFFU);
+        out[1] = static_cast<uint8_t>((value >> 8U) & 0xFFU);
+    }
+
+    inline uint16_t readLe16(const uint8_t* in)
+    {
+        return static_cast<uint16_t>(static_cast<uint16_t>(in[0]) | (static_cast<uint16_t>(in[1]) << 8U));
+    }
+
+    inline void writeLe32(uint8_t* out, uint32_t value)
+    {
+        out[0] = static_cast<uint8_t>(value & 0xFFU);
+        out[1] = static_cast<uint8_t>((value >> 8U) & 0xFFU);
+        out[2] = static_cast<uint8_t>((value >> 16U) & 0xFFU);
+        out[3] = static_cast<uint8_t>((value >> 24U) & 0xFFU);
+    }
+
+    inline uint32_t readLe32(const uint8_t* in)
+    {
+        return static_cast<uint32_t>(in[0]) |
+               (static_cast<uint32_t>(in[1]) << 8U) |
+               (static_cast<uint32_t>(in[2]) << 16U) |
+               (static_cast<uint32_t>(in[3]) << 24U);
+    }
+
+    inline void writeLe64(uint8_t* out, uint64_t value)
+    {
+        writeLe32(out, static_cast<uint32_t>(value & 0xFFFFFFFFU));
+        writeLe32(out + 4U, static_cast<uint32_t>(value >> 32U));
+    }
+
+    inline uint64_t readLe64(const uint8_t* in)
+    {
+        return static_cast<uint64_t>(readLe32(in)) | (static_cast<uint64_t>(readLe32(in + 4U)) << 32U);
+    }
+
+} // namespace utils
@@ -0,0 +1,653 @@
+/**
+ * @file SerialBusLinux.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Linux implementation of serial communication bus
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/serial.h>
+
+#include "Comms/Serial/SerialBusLinux.hpp"
+#include "Utils/Logging.h"
+
+namespace comms
+{
+
+    namespace serial
+    {
+        using namespace error;
+
+        namespace
+        {
+            bool toSpeed(uint32_t baudrate, speed_t &speed)
+            {
+                switch (baudrate)
+                {
+                case 9600U: speed = B9600; return true;
+                case 19200U: speed = B19200; return true;
+                case 38400U: speed = B38400; return true;
+                case 57600U: speed = B57600; return true;
+                case 115200U: speed = B115200; return true;
+                case 230400U: speed = B230400; return true;
+                case 460800U: speed = B460800; return true;
+                case 921600U: speed = B921600; return true;
+                case 1000000U: speed = B1000000; return true;
+                default: return false;
+                }
+            }
+        }
+
+        // ==============================================================================
+        // Initialization and Teardown
+        // ==============================================================================
+
+        SerialBusLinux::SerialBusLinux(const etl::string<256> &portname, uint32_t baudrate, const char *sysfsTtyRoot)
+            : fileDescriptor(-1)
+            , baudRate(baudrate)
+            , timeoutMs(1000U)
+            , parity(Parity::None)
+            , stopBits(StopBits::One)
+            , flowControl(FlowControl::None)
+            , portName(portname)
+            , sysfsRoot(sysfsTtyRoot)
+            , originalLatencyTimer(0U)
+            , readMinimum(0U)
+        {
+        }
+
+        SerialBusLinux::~SerialBusLinux()
+        {
+            this->close();
+        }
+
+        etl::expected<void, Error> SerialBusLinux::init()
+        {
+            // Open the port
+            auto result = this->open();
+            if (!result)
+            {
+                return etl::unexpected(result.error());
+            }
+
+            // Set timeouts
+            result = this->setTimeout(1000); // Default timeout 1000 ms
+            if (!result)
+            {
+                return etl::unexpected(result.error());
+            }
+
+            // Set Baud Rate
+            result = this->setBaudRate(this->baudRate);
+            if (!result)
+            {
+                return etl::unexpected(result.error());
+            }
+
+            LOG_INFO("Serial port %s initialized with baud rate %u", portName.c_str(), baudRate);
+            return {};
+        }
+
+        // ==============================================================================
+        // Open and Close
+        // ==============================================================================
+
+        etl::expected<void, Error> SerialBusLinux::open()
+        {
+            this->fileDescriptor = ::open(portName.c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+            if (this->fileDescriptor < 0)
+            {
+                LOG_ERROR("Error opening serial port: %s", portName.c_str());
+                return etl::unexpected(Error::fromHardware(HardwareError::DeviceNotFound));
+            }
+
+            auto result = this->applyTermios();
+            if (!result)
+            {
+                ::close(this->fileDescriptor);
+                this->fileDescriptor = -1;
+                return etl::unexpected(result.error());
+            }
+
+            LOG_INFO("Serial port %s opened", portName.c_str());
+            this->setIsOpen(true);
+
+            return {};
+        }
+
+        void SerialBusLinux::close()
+        {
+            if (this->isOpen())
+            {
+                // The latency timer outlives the file descriptor; give it back
+                if (this->originalLatencyTimer != 0U)
+                {
+                    (void)this->writeLatencyTimer(this->originalLatencyTimer);
+                    this->originalLatencyTimer = 0U;
+                }
+
+                auto res = ::close(this->fileDescriptor);
+                this->fileDescriptor = -1;
+                this->setIsOpen(false);
+                if (res != 0)
+                {
+                    LOG_ERROR("Error closing serial port: %s", portName.c_str());
+                    return;
+                }
+                LOG_INFO("Serial port %s closed successfully", portName.c_str());
+            }
+        }
+
+        // ==============================================================================
+        // Read and Write
+        // ==============================================================================
+
+        etl::expected<void, Error> SerialBusLinux::write(const etl::ivector<uint8_t> &data)
+        {
+            size_t written = 0U;
+            while (written < data.size())
+            {
+                const ssize_t result = ::write(this->fileDescriptor, data.data() + written, data.size() - written);
+                if (result < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    LOG_ERROR("Error writing to serial port: %s", portName.c_str());
+                    return etl::unexpected(Error::fromHardware(HardwareError::WriteFailed));
+                }
+                written += static_cast<size_t>(result);
+            }
+            LOG_INFO("Wrote %u bytes to serial port: %s", static_cast<unsigned>(written), portName.c_str());
+            return {};
+        }
+
+        etl::expected<size_t, Error> SerialBusLinux::read(etl::ivector<uint8_t> &buffer, size_t length)
+        {
+            if (buffer.capacity() < length)
+            {
+                LOG_ERROR("Read buffer too small for requested length on serial port: %s", portName.c_str());
+                return etl::unexpected(Error::fromHardware(HardwareError::BufferOverflow));
+            }
+
+            // Same semantics as SerialBusWin: the timeout restarts with every byte
+            buffer.uninitialized_resize(length);
+            size_t bytesRead = 0U;
+            while (bytesRead < length)
+            {
+                pollfd descriptor = {this->fileDescriptor, POLLIN, 0};
+                const int ready = ::poll(&descriptor, 1, static_cast<int>(this->timeoutMs));
+                if (ready < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (ready < 0 || (descriptor.revents & (POLLERR | POLLNVAL)) != 0)
+                {
+                    buffer.uninitialized_resize(bytesRead);
+                    LOG_ERROR("Error reading from serial port: %s", portName.c_str());
+                    return etl::unexpected(Error::fromHardware(HardwareError::ReadFailed));
+                }
+                if (ready == 0)
+                {
+                    break;
+                }
+
+                const ssize_t result = ::read(this->fileDescriptor, buffer.data() + bytesRead, length - bytesRead);
+                if (result <= 0)
+                {
+                    if (result < 0 && (errno == EINTR || errno == EAGAIN))
+                    {
+                        continue;
+                    }
+                    break;
+                }
+                bytesRead += static_cast<size_t>(result);
+            }
+
+            LOG_INFO("Read %u bytes from serial port: %s", static_cast<unsigned>(bytesRead), portName.c_str());
+            buffer.uninitialized_resize(bytesRead);  // Resize buffer to actual bytes read, keep data intact
+            return bytesRead;
+        }
+
+        etl::expected<void, Error> SerialBusLinux::flush()
+        {
+            if (tcdrain(this->fileDescriptor) != 0)
+            {
+                LOG_ERROR("Error flushing serial port buffers: %s", portName.c_str());
+                return etl::unexpected(Error::fromHardware(HardwareError::BusError));
+            }
+            LOG_INFO("Serial port buffers flushed successfully: %s", portName.c_str());
+            return {};
+        }
+
+        size_t SerialBusLinux::available() const
+        {
+            int pending = 0;
+            if (ioctl(this->fileDescriptor, FIONREAD, &pending) != 0)
+            {
+                LOG_ERROR("Error checking available bytes on serial port: %s", portName.c_str());
+                return 0;
+            }
+            return static_cast<size_t>(pending);
+        }
+
+        // ==============================================================================
+        // Bus-specific Properties
+        // ==============================================================================
+
+        etl::expected<void, Error> SerialBusLinux::setBaudRate(uint32_t baudrate)
+        {
+            speed_t speed;
+            if (!toSpeed(baudrate, speed))
+            {
+                LOG_ERROR("Unsupported baud rate %u on serial port: %s", baudrate, this->portName.c_str());
+                return etl::unexpected(Error::fromHardware(HardwareError::InvalidConfiguration));
+            }
+
+            const uint32_t previous = this->baudRate;
+            this->baudRate = baudrate;
+            auto result = this->applyTermios();
+            if (!result)
+            {
+                this->baudRate = previous;
+                return result;
+            }
+
+            LOG_INFO("Baud rate set to %u on serial port: %s", baudrate, this->portName.c_str());
+            return {};
+        }
+
+        etl::expected<void, Error> SerialBusLinux::setParity(Parity newParity)
+        {
+            if (newParity != Parity::None && newParity != Parity::Even && newParity != Parity::Odd)
+            {
+                LOG_ERROR("Invalid parity setting for serial port: %s", this->portName.c_str());
+                return etl::unexpected(Error::fromHardware(HardwareError::InvalidConfiguration));
+            }
+
+            const Parity previous = this->parity;
+            this->parity = newParity;
+            auto result = this->applyTermios();
+            if (!result)
+            {
+                this->parity = previous;
+                return result;
+            }
+
+            LOG_INFO("Parity set on serial port: %s", this->portName.c_str());
+            return {};
+        }
+
+        etl::expected<void, Error> SerialBusLinux::setStopBits(StopBits newStopBits)
+        {
+            if (newStopBits != StopBits::One && newStopBits != StopBits::Two)
+            {
+                LOG_ERROR("Invalid stop bits setting for serial port: %s", this->portName.c_str());
+                return etl::unexpected(Error::fromHardware(HardwareError::InvalidConfiguration));
+            }
+
+            const StopBits previous = this->stopBits;
+            this->stopBits = newStopBits;
+            auto result = this->applyTermios();
+            if (!result)
+            {
+                this->stopBits = previous;
+                return result;
+            }
+
+            LOG_INFO("Stop bits set on serial port: %s", this->portName.c_str());
+            return {};
+        }
+
+        etl::expected<void, Error> SerialBusLinux::setFlowControl(FlowControl newFlowControl)
+        {
+            if (newFlowControl != FlowControl::None && newFlowControl != FlowControl::Hardware &&
+                newFlowControl != FlowControl::Software)
+            {
+                LOG_ERROR("Invalid flow control setting for serial port: %s", this->portName.c_str());
+                return etl::unexpected(Error::fromHardware(HardwareError::InvalidConfiguration));
+            }
+
+            const FlowControl previous = this->flowControl;
+            this->flowControl = newFlowControl;
+            auto result = this->applyTermios();
+            if (!result)
+            {
+                this->flowControl = previous;
+                return result;
+            }
+
+            LOG_INFO("Flow control set on serial port: %s", this->portName.c_str());
+            return {};
+        }
+
+        etl::expected<void, Error> SerialBusLinux::setTimeout(uint32_t newTimeoutMs)
+        {
+            // Reads poll() with this timeout; the tty itself keeps VTIME=0
+            this->timeoutMs = newTimeoutMs;
+            LOG_INFO("Timeout set to %u ms on serial port: %s", newTimeoutMs, this->portName.c_str());
+            return {};
+        }
+
+        etl::expected<void, Error> SerialBusLinux::setLowLatency(bool enable)
+        {
+            bool applied = false;
+
+            auto flag = this->setAsyncLowLatency(enable);
+            if (flag && flag.value())
+            {
+                applied = true;
+            }
+            else
+            {
+                LOG_WARN("ASYNC_LOW_LATENCY not available on serial port: %s", this->portName.c_str());
+            }
+
+            if (enable)
+            {
+                applied = this->setLatencyTimer(LOW_LATENCY_TIMER_MS).has_value() || applied;
+            }
+            else if (this->originalLatencyTimer != 0U)
+            {
+                if (this->writeLatencyTimer(this->originalLatencyTimer))
+                {
+                    this->originalLatencyTimer = 0U;
+                    applied = true;
+                }
+            }
+            else
+            {
+                // Never lowered by us: already at the driver's setting
+                applied = this->readLatencyTimer().has_value() || applied;
+            }
+
+            if (!applied)
+            {
+                LOG_ERROR("Low-latency mode not supported on serial port: %s", this->portName.c_str());
+                return etl::unexpected(Error::fromHardware(HardwareError::NotSupported));
+            }
+
+            LOG_INFO("Low-latency mode %s on serial port: %s", enable ? "enabled" : "disabled", this->portName.c_str());
+            return {};
+        }
+
+        etl::expected<void, Error> SerialBusLinux::setLatencyTimer(uint32_t timerMs)
+        {
+            if (timerMs == 0U || timerMs > 255U)
+            {
+                LOG_ERROR("Invalid latency timer %u on serial port: %s", timerMs, this->portName.c_str());
+                return etl::unexpected(Error::fromHardware(HardwareError::InvalidConfiguration));
+            }
+
+            auto current = this->readLatencyTimer();
+            if (!current)
+            {
+                return etl::unexpected(current.error());
+            }
+
+            const bool firstChange = this->originalLatencyTimer == 0U;
+            auto result = this->writeLatencyTimer(timerMs);
+            if (!result)
+            {
+                return result;
+            }
+            if (firstChange)
+            {
+                this->originalLatencyTimer = current.value();
+            }
+
+            LOG_INFO("Latency timer set to %u ms on serial port: %s", timerMs, this->portName.c_str());
+            return {};
+        }
+
+        etl::expected<void, Error> SerialBusLinux::setReadMinimum(uint8_t bytes)
+        {
+            const uint8_t previous = this->readMinimum;
+            this->readMinimum = bytes;
+            if (this->fileDescriptor < 0)
+            {
+                return {};
+            }
+
+            auto result = this->applyTermios();
+            if (!result)
+            {
+                this->readMinimum = previous;
+                return result;
+            }
+            return {};
+        }
+
+        int SerialBusLinux::nativeHandle() const
+        {
+            return this->fileDescriptor;
+        }
+
+        // ==============================================================================
+        // Bus Properties
+        // ==============================================================================
+
+        etl::expected<void, Error> SerialBusLinux::setProperty(BusProperty property, uint32_t value)
+        {
+            switch (property)
+            {
+            case BusProperty::BaudRate:
+                return this->setBaudRate(value);
+            case BusProperty::Timeout:
+                return this->setTimeout(value);
+            case BusProperty::Parity:
+                return this->setParity(static_cast<Parity>(value));
+            case BusProperty::StopBits:
+                return this->setStopBits(static_cast<StopBits>(value));
+            case BusProperty::FlowControl:
+                return this->setFlowControl(static_cast<FlowControl>(value));
+            case BusProperty::LowLatency:
+                return this->setLowLatency(value != 0U);
+            case BusProperty::LatencyTimer:
+                return this->setLatencyTimer(value);
+            default:
+                LOG_ERROR("Property not supported on serial port: %s", this->portName.c_str());
+                return etl::unexpected(Error::fromHardware(HardwareError::NotSupported));
+            }
+        }
+
+        etl::expected<uint32_t, Error> SerialBusLinux::getProperty(BusProperty property) const
+        {
+            switch (property)
+            {
+            case BusProperty::BaudRate:
+                return this->baudRate;
+            case BusProperty::Timeout:
+                return this->timeoutMs;
+            case BusProperty::Parity:
+                return static_cast<uint32_t>(this->parity);
+            case BusProperty::StopBits:
+                return static_cast<uint32_t>(this->stopBits);
+            case BusProperty::FlowControl:
+                return static_cast<uint32_t>(this->flowControl);
+            case BusProperty::LatencyTimer:
+                return this->readLatencyTimer();
+            case BusProperty::LowLatency:
+            {
+                // Report what the kernel holds, not what was requested
+                auto flag = this->readAsyncLowLatency();
+                auto timer = this->readLatencyTimer();
+                if (!flag && !timer)
+                {
+                    return etl::unexpected(Error::fromHardware(HardwareError::NotSupported));
+                }
+                const bool low = (flag && flag.value()) || (timer && timer.value() <= LOW_LATENCY_TIMER_MS);
+                return low ? 1U : 0U;
+            }
+            default:
+                LOG_ERROR("Property not supported on serial port: %s", this->portName.c_str());
+                return etl::unexpected(Error::fromHardware(HardwareError::NotSupported));
+            }
+        }
+
+        // ==============================================================================
+        // Private helpers
+        // ==============================================================================
+
+        etl::expected<void, Error> SerialBusLinux::applyTermios()
+        {
+            termios options;
+            if (tcgetattr(this->fileDescriptor, &options) != 0)
+            {
+                LOG_ERROR("Error getting current serial port state: %s", this->portName.c_str());
+                return etl::unexpected(Error::fromHardware(HardwareError::Unknown));
+            }
+
+            cfmakeraw(&options);
+            options.c_cflag |= (CLOCAL | CREAD);
+            options.c_cflag &= ~(PARENB | PARODD | CSTOPB | CRTSCTS);
+            options.c_iflag &= ~(IXON | IXOFF | IXANY);
+            options.c_cc[VMIN] = this->readMinimum;
+            options.c_cc[VTIME] = 0;
+
+            if (this->parity != Parity::None)
+            {
+                options.c_cflag |= PARENB;
+                if (this->parity == Parity::Odd)
+                {
+                    options.c_cflag |= PARODD;
+                }
+            }
+            if (this->stopBits == StopBits::Two)
+            {
+                options.c_cflag |= CSTOPB;
+            }
+            if (this->flowControl == FlowControl::Hardware)
+            {
+                options.c_cflag |= CRTSCTS;
+            }
+            else if (this->flowControl == FlowControl::Software)
+            {
+                options.c_iflag |= (IXON | IXOFF);
+            }
+
+            speed_t speed;
+            if (toSpeed(this->baudRate, speed))
+            {
+                cfsetispeed(&options, speed);
+                cfsetospeed(&options, speed);
+            }
+
+            if (tcsetattr(this->fileDescriptor, TCSANOW, &options) != 0)
+            {
+                LOG_ERROR("Error configuring serial port: %s", this->portName.c_str());
+                return etl::unexpected(Error::fromHardware(HardwareError::Unknown));
+            }
+            return {};
+        }
+
+        etl::expected<bool, Error> SerialBusLinux::setAsyncLowLatency(bool enable)
+        {
+            serial_struct settings;
+            if (ioctl(this->fileDescriptor, TIOCGSERIAL, &settings) != 0)
+            {
+                return etl::unexpected(Error::fromHardware(HardwareError::NotSupported));
+            }
+
+            if (enable)
+            {
+                settings.flags |= ASYNC_LOW_LATENCY;
+            }
+            else
+            {
+                settings.flags &= ~ASYNC_LOW_LATENCY;
+            }
+
+            if (ioctl(this->fileDescriptor, TIOCSSERIAL, &settings) != 0)
+            {
+                return etl::unexpected(Error::fromHardware(HardwareError::InvalidConfiguration));
+            }
+
+            // Some drivers accept the ioctl and ignore the flag
+            auto effective = this->readAsyncLowLatency();
+            if (!effective)
+            {
+                return effective;
+            }
+            return effective.value() == enable;
+        }
+
+        etl::expected<bool, Error> SerialBusLinux::readAsyncLowLatency() const
+        {
+            serial_struct settings;
+            if (this->fileDescriptor < 0 || ioctl(this->fileDescriptor, TIOCGSERIAL, &settings) != 0)
+            {
+                return etl::unexpected(Error::fromHardware(HardwareError::NotSupported));
+            }
+            return (settings.flags & ASYNC_LOW_LATENCY) != 0;
+        }
+
+        etl::expected<uint32_t, Error> SerialBusLinux::readLatencyTimer() const
+        {
+            etl::string<384> path;
+            this->latencyTimerPath(path);
+
+            FILE *attribute = fopen(path.c_str(), "r");
+            if (attribute == nullptr)
+            {
+                return etl::unexpected(Error::fromHardware(HardwareError::NotSupported));
+            }
+
+            unsigned value = 0U;
+            const int parsed = fscanf(attribute, "%u", &value);
+            fclose(attribute);
+            if (parsed != 1)
+            {
+                return etl::unexpected(Error::fromHardware(HardwareError::ReadFailed));
+            }
+            return static_cast<uint32_t>(value);
+        }
+
+        etl::expected<void, Error> SerialBusLinux::writeLatencyTimer(uint32_t timerMs)
+        {
+            etl::string<384> path;
+            this->latencyTimerPath(path);
+
+            FILE *attribute = fopen(path.c_str(), "w");
+            if (attribute == nullptr)
+            {
+                LOG_WARN("Cannot write %s", path.c_str());
+                return etl::unexpected(Error::fromHardware(errno == ENOENT ? HardwareError::NotSupported : HardwareError::WriteFailed));
+            }
+
+            const bool written = fprintf(attribute, "%u\n", static_cast<unsigned>(timerMs)) > 0;
+            const bool closed = fclose(attribute) == 0;
+            if (!written || !closed)
+            {
+                return etl::unexpected(Error::fromHardware(HardwareError::WriteFailed));
+            }
+            return {};
+        }
+
+        void SerialBusLinux::latencyTimerPath(etl::string<384> &path) const
+        {
+            // /dev/ttyUSB0 -> <root>/ttyUSB0/device/latency_timer
+            size_t start = this->portName.find_last_of('/');
+            start = (start == etl::string<256>::npos) ? 0U : start + 1U;
+
+            path.assign(this->sysfsRoot.begin(), this->sysfsRoot.end());
+            path.append("/");
+            path.append(this->portName.begin() + start, this->portName.end());
+            path.append("/device/latency_timer");
+        }
+
+    } // namespace serial
+
+} // namespace comms
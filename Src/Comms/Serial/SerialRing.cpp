@@ -0,0 +1,616 @@
+/**
+ * @file SerialRing.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief io_uring engine serving many serial readers from one thread
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#include "Comms/Serial/SerialRing.hpp"
+#include "Utils/Logging.h"
+
+namespace comms
+{
+
+    namespace serial
+    {
+        using namespace error;
+
+        namespace
+        {
+            // user_data layout: channel << 8 | operation
+            constexpr uint64_t OP_READ = 1U;
+            constexpr uint64_t OP_WRITE = 2U;
+            constexpr uint64_t OP_CANCEL = 3U;
+            constexpr uint32_t DETACH_ATTEMPTS = 10U;
+
+            uint64_t userDataFor(size_t channel, uint64_t operation)
+            {
+                return (static_cast<uint64_t>(channel) << 8) | operation;
+            }
+
+            uint32_t loadAcquire(const uint32_t *value)
+            {
+                return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+            }
+
+            void storeRelease(uint32_t *value, uint32_t newValue)
+            {
+                __atomic_store_n(value, newValue, __ATOMIC_RELEASE);
+            }
+
+            uint32_t monotonicMs()
+            {
+                timespec now;
+                clock_gettime(CLOCK_MONOTONIC, &now);
+                return static_cast<uint32_t>(now.tv_sec * 1000U + now.tv_nsec / 1000000);
+            }
+
+            void *mapRing(int fd, size_t size, off_t offset)
+            {
+                void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+                return (memory == MAP_FAILED) ? nullptr : memory;
+            }
+        }
+
+        SerialRing::SerialRing()
+            : ringFd(-1)
+            , ringMemory(nullptr)
+            , ringMemorySize(0U)
+            , completionMemory(nullptr)
+            , completionMemorySize(0U)
+            , entryMemory(nullptr)
+            , entryMemorySize(0U)
+            , sqHead(nullptr)
+            , sqTail(nullptr)
+            , sqMask(0U)
+            , sqArray(nullptr)
+            , sqEntries(0U)
+            , toSubmit(0U)
+            , cqHead(nullptr)
+            , cqTail(nullptr)
+            , cqMask(0U)
+            , cqes(nullptr)
+            , inFlight(0U)
+            , channels()
+            , metrics()
+        {
+        }
+
+        SerialRing::~SerialRing()
+        {
+            this->shutdown();
+        }
+
+        etl::expected<void, Error> SerialRing::init()
+        {
+            if (this->ringFd >= 0)
+            {
+                return {};
+            }
+
+            io_uring_params params;
+            memset(&params, 0, sizeof(params));
+            const long fd = syscall(__NR_io_uring_setup, QUEUE_DEPTH, &params);
+            if (fd < 0)
+            {
+                LOG_ERROR("io_uring_setup failed (errno %d)", errno);
+                return etl::unexpected(Error::fromHardware(HardwareError::NotSupported));
+            }
+            this->ringFd = static_cast<int>(fd);
+
+            if ((params.features & IORING_FEAT_EXT_ARG) == 0U)
+            {
+                LOG_ERROR("io_uring without IORING_FEAT_EXT_ARG, Linux 5.11 or newer needed");
+                this->shutdown();
+                return etl::unexpected(Error::fromHardware(HardwareError::NotSupported));
+            }
+
+            this->ringMemorySize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+            this->completionMemorySize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0U;
+            if (singleMap && this->completionMemorySize > this->ringMemorySize)
+            {
+                this->ringMemorySize = this->completionMemorySize;
+            }
+
+            this->ringMemory = mapRing(this->ringFd, this->ringMemorySize, IORING_OFF_SQ_RING);
+            if (this->ringMemory != nullptr && !singleMap)
+            {
+                this->completionMemory = mapRing(this->ringFd, this->completionMemorySize, IORING_OFF_CQ_RING);
+            }
+            this->entryMemorySize = params.sq_entries * sizeof(io_uring_sqe);
+            this->entryMemory = mapRing(this->ringFd, this->entryMemorySize, IORING_OFF_SQES);
+            if (this->ringMemory == nullptr || this->entryMemory == nullptr ||
+                (!singleMap && this->completionMemory == nullptr))
+            {
+                LOG_ERROR("Mapping io_uring queues failed (errno %d)", errno);
+                this->shutdown();
+                return etl::unexpected(Error::fromHardware(HardwareError::NotSupported));
+            }
+
+            uint8_t *sq = static_cast<uint8_t *>(this->ringMemory);
+            uint8_t *cq = singleMap ? sq : static_cast<uint8_t *>(this->completionMemory);
+            this->sqHead = reinterpret_cast<uint32_t *>(sq + params.sq_off.head);
+            this->sqTail = reinterpret_cast<uint32_t *>(sq + params.sq_off.tail);
+            this->sqMask = *reinterpret_cast<uint32_t *>(sq + params.sq_off.ring_mask);
+            this->sqArray = reinterpret_cast<uint32_t *>(sq + params.sq_off.array);
+            this->sqEntries = params.sq_entries;
+            this->cqHead = reinterpret_cast<uint32_t *>(cq + params.cq_off.head);
+            this->cqTail = reinterpret_cast<uint32_t *>(cq + params.cq_off.tail);
+            this->cqMask = *reinterpret_cast<uint32_t *>(cq + params.cq_off.ring_mask);
+            this->cqes = cq + params.cq_off.cqes;
+
+            this->toSubmit = 0U;
+            this->inFlight = 0U;
+            this->metrics = SerialRingMetrics();
+            LOG_INFO("io_uring serial engine ready, %u entries", static_cast<unsigned>(params.sq_entries));
+            return {};
+        }
+
+        void SerialRing::shutdown()
+        {
+            for (size_t channel = 0U; channel < MAX_CHANNELS; ++channel)
+            {
+                if (this->isAttached(channel))
+                {
+                    this->detach(channel);
+                }
+            }
+
+            if (this->entryMemory != nullptr)
+            {
+                munmap(this->entryMemory, this->entryMemorySize);
+                this->entryMemory = nullptr;
+            }
+            if (this->completionMemory != nullptr)
+            {
+                munmap(this->completionMemory, this->completionMemorySize);
+                this->completionMemory = nullptr;
+            }
+            if (this->ringMemory != nullptr)
+            {
+                munmap(this->ringMemory, this->ringMemorySize);
+                this->ringMemory = nullptr;
+            }
+            if (this->ringFd >= 0)
+            {
+                ::close(this->ringFd);
+                this->ringFd = -1;
+            }
+        }
+
+        // ==============================================================================
+        // Channels
+        // ==============================================================================
+
+        etl::expected<size_t, Error> SerialRing::attach(int fd, const SerialRingHandlers &handlers)
+        {
+            if (this->ringFd < 0 || fd < 0)
+            {
+                return etl::unexpected(Error::fromHardware(HardwareError::InvalidConfiguration));
+            }
+
+            for (size_t channel = 0U; channel < MAX_CHANNELS; ++channel)
+            {
+                Channel &entry = this->channels[channel];
+                if (entry.fd >= 0)
+                {
+                    continue;
+                }
+
+                entry.fd = fd;
+                entry.handlers = handlers;
+                entry.failed = false;
+                entry.closing = false;
+                entry.rx.clear();
+                entry.txInFlight.clear();
+                entry.txQueued.clear();
+                if (!this->queueRead(channel))
+                {
+                    entry.fd = -1;
+                    return etl::unexpected(Error::fromHardware(HardwareError::BufferOverflow));
+                }
+                return channel;
+            }
+
+            LOG_ERROR("All %u io_uring serial channels in use", static_cast<unsigned>(MAX_CHANNELS));
+            return etl::unexpected(Error::fromHardware(HardwareError::BufferOverflow));
+        }
+
+        void SerialRing::detach(size_t channel)
+        {
+            if (!this->isAttached(channel))
+            {
+                return;
+            }
+
+            Channel &entry = this->channels[channel];
+            entry.closing = true;
+            entry.txQueued.clear();
+            if (entry.readArmed)
+            {
+                (void)this->queueCancel(channel, OP_READ);
+            }
+            if (entry.writeArmed)
+            {
+                (void)this->queueCancel(channel, OP_WRITE);
+            }
+
+            // The kernel still points into readChunk/txInFlight until both complete
+            for (uint32_t attempt = 0U; (entry.readArmed || entry.writeArmed) && attempt < DETACH_ATTEMPTS; ++attempt)
+            {
+                if (!this->poll(100U))
+                {
+                    break;
+                }
+            }
+            if (entry.readArmed || entry.writeArmed)
+            {
+                LOG_ERROR("io_uring channel %u did not stop", static_cast<unsigned>(channel));
+            }
+
+            entry.fd = -1;
+            entry.handlers = SerialRingHandlers();
+            entry.rx.clear();
+            entry.txInFlight.clear();
+        }
+
+        bool SerialRing::isAttached(size_t channel) const
+        {
+            return channel < MAX_CHANNELS && this->channels[channel].fd >= 0;
+        }
+
+        // ==============================================================================
+        // Read and Write
+        // ==============================================================================
+
+        etl::expected<void, Error> SerialRing::write(size_t channel, const etl::ivector<uint8_t> &data)
+        {
+            if (!this->isAttached(channel) || this->channels[channel].closing)
+            {
+                return etl::unexpected(Error::fromHardware(HardwareError::InvalidConfiguration));
+            }
+
+            Channel &entry = this->channels[channel];
+            if (entry.failed)
+            {
+                return etl::unexpected(Error::fromHardware(HardwareError::WriteFailed));
+            }
+            if (entry.txQueued.available() < data.size())
+            {
+                return etl::unexpected(Error::fromHardware(HardwareError::BufferOverflow));
+            }
+
+            entry.txQueued.insert(entry.txQueued.end(), data.begin(), data.end());
+            if (!entry.writeArmed)
+            {
+                (void)this->queueWrite(channel);
+            }
+            return {};
+        }
+
+        size_t SerialRing::read(size_t channel, uint8_t *data, size_t length)
+        {
+            if (!this->isAttached(channel))
+            {
+                return 0U;
+            }
+
+            Channel &entry = this->channels[channel];
+            size_t count = 0U;
+            while (count < length && !entry.rx.empty())
+            {
+                data[count++] = entry.rx.front();
+                entry.rx.pop();
+            }
+
+            // Room again for a full chunk: resume receiving
+            if (!entry.readArmed && !entry.failed && !entry.closing && entry.rx.available() >= READ_CHUNK)
+            {
+                (void)this->queueRead(channel);
+            }
+            return count;
+        }
+
+        size_t SerialRing::available(size_t channel) const
+        {
+            return this->isAttached(channel) ? this->channels[channel].rx.size() : 0U;
+        }
+
+        bool SerialRing::writePending(size_t channel) const
+        {
+            return this->isAttached(channel) &&
+                   (this->channels[channel].writeArmed || !this->channels[channel].txQueued.empty());
+        }
+
+        bool SerialRing::failed(size_t channel) const
+        {
+            return this->isAttached(channel) && this->channels[channel].failed;
+        }
+
+        // ==============================================================================
+        // Event Loop
+        // ==============================================================================
+
+        etl::expected<size_t, Error> SerialRing::poll(uint32_t timeoutMs)
+        {
+            if (this->ringFd < 0)
+            {
+                return etl::unexpected(Error::fromHardware(HardwareError::BusError));
+            }
+
+            // Completions already posted need no system call
+            size_t handled = this->reap();
+            if (handled > 0U && this->toSubmit == 0U)
+            {
+                return handled;
+            }
+
+            if (this->toSubmit > 0U || (timeoutMs > 0U && handled == 0U))
+            {
+                auto result = this->enter((handled > 0U) ? 0U : timeoutMs);
+                if (!result)
+                {
+                    return etl::unexpected(result.error());
+                }
+                handled += this->reap();
+            }
+            return handled;
+        }
+
+        bool SerialRing::waitReadable(size_t channel, uint32_t timeoutMs)
+        {
+            const uint32_t start = monotonicMs();
+            while (this->available(channel) == 0U && this->isAttached(channel) && !this->channels[channel].failed)
+            {
+                const uint32_t elapsed = monotonicMs() - start;
+                if (elapsed >= timeoutMs || !this->poll(timeoutMs - elapsed))
+                {
+                    break;
+                }
+            }
+            return this->available(channel) > 0U;
+        }
+
+        bool SerialRing::waitWritten(size_t channel, uint32_t timeoutMs)
+        {
+            const uint32_t start = monotonicMs();
+            while (this->writePending(channel) && !this->channels[channel].failed)
+            {
+                const uint32_t elapsed = monotonicMs() - start;
+                if (elapsed >= timeoutMs || !this->poll(timeoutMs - elapsed))
+                {
+                    break;
+                }
+            }
+            return this->isAttached(channel) && !this->writePending(channel) && !this->channels[channel].failed;
+        }
+
+        const SerialRingMetrics &SerialRing::getMetrics() const
+        {
+            return this->metrics;
+        }
+
+        // ==============================================================================
+        // Submission and Completion
+        // ==============================================================================
+
+        bool SerialRing::queueRead(size_t channel)
+        {
+            Channel &entry = this->channels[channel];
+            if (!this->prepare(IORING_OP_READ, entry.fd, reinterpret_cast<uint64_t>(entry.readChunk),
+                               static_cast<uint32_t>(READ_CHUNK), userDataFor(channel, OP_READ)))
+            {
+                return false;
+            }
+            entry.readArmed = true;
+            return true;
+        }
+
+        bool SerialRing::queueWrite(size_t channel)
+        {
+            Channel &entry = this->channels[channel];
+            if (entry.txInFlight.empty())
+            {
+                entry.txInFlight.assign(entry.txQueued.begin(), entry.txQueued.end());
+                entry.txQueued.clear();
+            }
+            if (entry.txInFlight.empty())
+            {
+                return true;
+            }
+            if (!this->prepare(IORING_OP_WRITE, entry.fd, reinterpret_cast<uint64_t>(entry.txInFlight.data()),
+                               static_cast<uint32_t>(entry.txInFlight.size()), userDataFor(channel, OP_WRITE)))
+            {
+                return false;
+            }
+            entry.writeArmed = true;
+            return true;
+        }
+
+        bool SerialRing::queueCancel(size_t channel, uint64_t operation)
+        {
+            // ASYNC_CANCEL finds its target by user_data, passed in addr
+            return this->prepare(IORING_OP_ASYNC_CANCEL, -1, userDataFor(channel, operation), 0U,
+                                 userDataFor(channel, OP_CANCEL));
+        }
+
+        bool SerialRing::prepare(uint8_t opcode, int fd, uint64_t address, uint32_t length, uint64_t userData)
+        {
+            const uint32_t tail = *this->sqTail;
+            if (tail - loadAcquire(this->sqHead) >= this->sqEntries)
+            {
+                LOG_ERROR("io_uring submission queue full");
+                return false;
+            }
+
+            const uint32_t index = tail & this->sqMask;
+            io_uring_sqe &sqe = static_cast<io_uring_sqe *>(this->entryMemory)[index];
+            memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = opcode;
+            sqe.fd = fd;
+            if (opcode != IORING_OP_ASYNC_CANCEL)
+            {
+                sqe.off = static_cast<uint64_t>(-1);   // stream: current position
+            }
+            sqe.addr = address;
+            sqe.len = length;
+            sqe.user_data = userData;
+            this->sqArray[index] = index;
+            storeRelease(this->sqTail, tail + 1U);
+
+            ++this->toSubmit;
+            ++this->inFlight;
+            return true;
+        }
+
+        etl::expected<void, Error> SerialRing::enter(uint32_t timeoutMs)
+        {
+            __kernel_timespec timeout;
+            timeout.tv_sec = timeoutMs / 1000U;
+            timeout.tv_nsec = static_cast<long long>(timeoutMs % 1000U) * 1000000;
+
+            io_uring_getevents_arg waitArgument;
+            memset(&waitArgument, 0, sizeof(waitArgument));
+            waitArgument.sigmask_sz = _NSIG / 8;
+            waitArgument.ts = reinterpret_cast<uint64_t>(&timeout);
+
+            const uint32_t waitFor = (timeoutMs > 0U) ? 1U : 0U;
+            const long result = syscall(__NR_io_uring_enter, this->ringFd, this->toSubmit, waitFor,
+                                        IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                                        &waitArgument, sizeof(waitArgument));
+            ++this->metrics.enterCalls;
+            if (result < 0)
+            {
+                // Timer expiry and signals are normal ends of a wait
+                if (errno == ETIME || errno == EINTR || errno == EBUSY || errno == EAGAIN)
+                {
+                    return {};
+                }
+                LOG_ERROR("io_uring_enter failed (errno %d)", errno);
+                return etl::unexpected(Error::fromHardware(HardwareError::BusError));
+            }
+
+            this->metrics.submitted += static_cast<uint32_t>(result);
+            this->toSubmit -= static_cast<uint32_t>(result);
+            return {};
+        }
+
+        size_t SerialRing::reap()
+        {
+            size_t handled = 0U;
+            uint32_t head = *this->cqHead;
+            const io_uring_cqe *entries = static_cast<const io_uring_cqe *>(this->cqes);
+            while (head != loadAcquire(this->cqTail))
+            {
+                const io_uring_cqe &cqe = entries[head & this->cqMask];
+                const uint64_t userData = cqe.user_data;
+                const int32_t result = cqe.res;
+                ++head;
+                storeRelease(this->cqHead, head);
+
+                this->complete(userData, result);
+                ++handled;
+            }
+            this->metrics.completed += static_cast<uint32_t>(handled);
+            return handled;
+        }
+
+        void SerialRing::complete(uint64_t userData, int32_t result)
+        {
+            --this->inFlight;
+            const size_t channel = static_cast<size_t>(userData >> 8);
+            const uint64_t operation = userData & 0xFFU;
+            if (channel >= MAX_CHANNELS || operation == OP_CANCEL)
+            {
+                return;
+            }
+
+            Channel &entry = this->channels[channel];
+            if (operation == OP_READ)
+            {
+                entry.readArmed = false;
+                if (entry.closing)
+                {
+                    return;
+                }
+                if (result == -EINTR || result == -EAGAIN)
+                {
+                    (void)this->queueRead(channel);
+                    return;
+                }
+                if (result <= 0)
+                {
+                    LOG_ERROR("io_uring read failed on channel %u (%d)", static_cast<unsigned>(channel), result);
+                    entry.failed = true;
+                    return;
+                }
+
+                for (int32_t i = 0; i < result; ++i)
+                {
+                    entry.rx.push(entry.readChunk[i]);
+                }
+                this->metrics.bytesRead += static_cast<uint32_t>(result);
+                if (entry.rx.available() >= READ_CHUNK)
+                {
+                    (void)this->queueRead(channel);
+                }
+                if (entry.handlers.onReceive != nullptr)
+                {
+                    entry.handlers.onReceive(entry.handlers.context, channel);
+                }
+                return;
+            }
+
+            // OP_WRITE
+            entry.writeArmed = false;
+            if (entry.closing)
+            {
+                return;
+            }
+            // n_tty sees pending io_uring task work as a signal; just send again
+            if (result == -EINTR || result == -EAGAIN)
+            {
+                (void)this->queueWrite(channel);
+                return;
+            }
+            if (result <= 0)
+            {
+                LOG_ERROR("io_uring write failed on channel %u (%d)", static_cast<unsigned>(channel), result);
+                entry.failed = true;
+                entry.txInFlight.clear();
+                entry.txQueued.clear();
+                if (entry.handlers.onWriteComplete != nullptr)
+                {
+                    entry.handlers.onWriteComplete(entry.handlers.context, channel, false);
+                }
+                return;
+            }
+
+            // Short write: send the rest before anything queued behind it
+            this->metrics.bytesWritten += static_cast<uint32_t>(result);
+            entry.txInFlight.erase(entry.txInFlight.begin(), entry.txInFlight.begin() + result);
+            (void)this->queueWrite(channel);
+            if (!entry.writeArmed && entry.handlers.onWriteComplete != nullptr)
+            {
+                entry.handlers.onWriteComplete(entry.handlers.context, channel, true);
+            }
+        }
+
+    } // namespace serial
+
+} // namespace comms
@@ -0,0 +1,228 @@
+/**
+ * @file SerialRingBus.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Serial bus whose I/O runs through a shared SerialRing
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdint.h>
+
+#include "Comms/Serial/SerialRingBus.hpp"
+#include "Utils/Logging.h"
+
+namespace comms
+{
+
+    namespace serial
+    {
+        using namespace error;
+
+        SerialRingBus::SerialRingBus(SerialRing &ringRef, const etl::string<256> &portname, uint32_t baudrate)
+            : ring(ringRef)
+            , serialPort(portname, baudrate)
+            , ringChannel(0U)
+            , attached(false)
+            , timeoutMs(1000U)
+        {
+        }
+
+        SerialRingBus::~SerialRingBus()
+        {
+            this->close();
+        }
+
+        etl::expected<void, Error> SerialRingBus::init()
+        {
+            auto result = this->serialPort.init();
+            if (!result)
+            {
+                return result;
+            }
+            return this->attachPort();
+        }
+
+        etl::expected<void, Error> SerialRingBus::open()
+        {
+            auto result = this->serialPort.open();
+            if (!result)
+            {
+                return result;
+            }
+            return this->attachPort();
+        }
+
+        void SerialRingBus::close()
+        {
+            if (this->attached)
+            {
+                // The ring must let go of the descriptor before it is closed
+                this->ring.detach(this->ringChannel);
+                this->attached = false;
+            }
+            this->serialPort.close();
+            this->setIsOpen(false);
+        }
+
+        etl::expected<void, Error> SerialRingBus::attachPort()
+        {
+            auto result = this->serialPort.setReadMinimum(1U);
+            if (!result)
+            {
+                this->serialPort.close();
+                return result;
+            }
+
+            auto channel = this->ring.attach(this->serialPort.nativeHandle());
+            if (!channel)
+            {
+                LOG_ERROR("Serial port could not join the io_uring engine");
+                this->serialPort.close();
+                return etl::unexpected(channel.error());
+            }
+
+            this->ringChannel = channel.value();
+            this->attached = true;
+            this->setIsOpen(true);
+            return {};
+        }
+
+        // ==============================================================================
+        // Read and Write
+        // ==============================================================================
+
+        etl::expected<void, Error> SerialRingBus::write(const etl::ivector<uint8_t> &data)
+        {
+            if (!this->attached)
+            {
+                return etl::unexpected(Error::fromHardware(HardwareError::WriteFailed));
+            }
+
+            auto result = this->ring.write(this->ringChannel, data);
+            if (!result)
+            {
+                return result;
+            }
+
+            // Submit now; the completion is reaped by a later call
+            auto submitted = this->ring.poll(0U);
+            if (!submitted)
+            {
+                return etl::unexpected(Error::fromHardware(HardwareError::WriteFailed));
+            }
+            return {};
+        }
+
+        etl::expected<size_t, Error> SerialRingBus::read(etl::ivector<uint8_t> &buffer, size_t length)
+        {
+            if (buffer.capacity() < length)
+            {
+                LOG_ERROR("Read buffer too small for requested length on io_uring serial channel");
+                return etl::unexpected(Error::fromHardware(HardwareError::BufferOverflow));
+            }
+            if (!this->attached)
+            {
+                return etl::unexpected(Error::fromHardware(HardwareError::ReadFailed));
+            }
+
+            buffer.uninitialized_resize(length);
+            size_t bytesRead = 0U;
+            while (bytesRead < length)
+            {
+                bytesRead += this->ring.read(this->ringChannel, buffer.data() + bytesRead, length - bytesRead);
+                if (bytesRead == length || !this->ring.waitReadable(this->ringChannel, this->timeoutMs))
+                {
+                    break;
+                }
+            }
+            buffer.uninitialized_resize(bytesRead);
+
+            if (bytesRead == 0U && this->ring.failed(this->ringChannel))
+            {
+                return etl::unexpected(Error::fromHardware(HardwareError::ReadFailed));
+            }
+            return bytesRead;
+        }
+
+        etl::expected<void, Error> SerialRingBus::flush()
+        {
+            if (!this->attached || !this->ring.waitWritten(this->ringChannel, this->timeoutMs))
+            {
+                LOG_ERROR("Queued data not written on io_uring serial channel");
+                return etl::unexpected(Error::fromHardware(HardwareError::BusError));
+            }
+            return this->serialPort.flush();
+        }
+
+        size_t SerialRingBus::available() const
+        {
+            if (!this->attached)
+            {
+                return 0U;
+            }
+
+            // Reaping completions is a shared-memory read, no system call
+            (void)this->ring.poll(0U);
+            return this->ring.available(this->ringChannel);
+        }
+
+        // ==============================================================================
+        // Bus-specific Properties
+        // ==============================================================================
+
+        etl::expected<void, Error> SerialRingBus::setBaudRate(uint32_t baudrate)
+        {
+            return this->serialPort.setBaudRate(baudrate);
+        }
+
+        etl::expected<void, Error> SerialRingBus::setParity(Parity parity)
+        {
+            return this->serialPort.setParity(parity);
+        }
+
+        etl::expected<void, Error> SerialRingBus::setStopBits(StopBits stopBits)
+        {
+            return this->serialPort.setStopBits(stopBits);
+        }
+
+        etl::expected<void, Error> SerialRingBus::setFlowControl(FlowControl flowControl)
+        {
+            return this->serialPort.setFlowControl(flowControl);
+        }
+
+        etl::expected<void, Error> SerialRingBus::setTimeout(uint32_t newTimeoutMs)
+        {
+            this->timeoutMs = newTimeoutMs;
+            return this->serialPort.setTimeout(newTimeoutMs);
+        }
+
+        etl::expected<void, Error> SerialRingBus::setProperty(BusProperty property, uint32_t value)
+        {
+            if (property == BusProperty::Timeout)
+            {
+                return this->setTimeout(value);
+            }
+            return this->serialPort.setProperty(property, value);
+        }
+
+        etl::expected<uint32_t, Error> SerialRingBus::getProperty(BusProperty property) const
+        {
+            return this->serialPort.getProperty(property);
+        }
+
+        SerialBusLinux &SerialRingBus::port()
+        {
+            return this->serialPort;
+        }
+
+        size_t SerialRingBus::channel() const
+        {
+            return this->ringChannel;
+        }
+
+    } // namespace serial
+
+} // namespace comms
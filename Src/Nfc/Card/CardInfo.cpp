@@ -10,14 +10,66 @@
  */
 
 #include "Nfc/Card/CardInfo.h"
+#include "Utils/Hex.h"
 #include <cstdio>
 #include <etl/string.h>
 
+namespace
+{
+    // ISO/IEC 14443-4 FSCI to FSC; FSCI 9..F are treated as 256
+    constexpr uint16_t FSC_TABLE[9] = {16U, 24U, 32U, 40U, 48U, 64U, 96U, 128U, 256U};
+
+    constexpr uint8_t T0_TA_PRESENT = 0x10U;
+    constexpr uint8_t T0_TB_PRESENT = 0x20U;
+    constexpr uint8_t T0_TC_PRESENT = 0x40U;
+
+    /**
+     * Factory-default ATS values (T0 TA TB TC and first historical byte).
+     * Only signatures that belong to one product family are listed; a
+     * signature shared by several generations is marked ambiguous.
+     */
+    struct AtsSignature
+    {
+        uint8_t t0;
+        uint8_t ta;
+        uint8_t tb;
+        uint8_t tc;
+        uint8_t historical;
+        nfc::CardGeneration generation;
+        bool ambiguous;
+    };
+
+    constexpr AtsSignature ATS_SIGNATURES[] = {
+        // DESFire EV0 through EV3: FSC 64, up to 848 kbit/s, FWI 8
+        {0x75U, 0x77U, 0x81U, 0x02U, 0x80U, nfc::CardGeneration::Unknown, true},
+        // NTAG 424 DNA: FSC 128, up to 848 kbit/s, FWI 7
+        {0x77U, 0x77U, 0x71U, 0x02U, 0x80U, nfc::CardGeneration::Ntag424Dna, false},
+    };
+}
+
 namespace nfc
 {
 
     CardType CardInfo::detectType()
     {
+        generation = CardGeneration::Unknown;
+        generationAmbiguous = true;
+        if (parseAts() && atsInfo.historicalLength == 1U)
+        {
+            for (const AtsSignature& signature : ATS_SIGNATURES)
+            {
+                if (ats.size() == 5U &&
+                    ats[0] == signature.t0 && ats[1] == signature.ta &&
+                    ats[2] == signature.tb && ats[3] == signature.tc &&
+                    ats[4] == signature.historical)
+                {
+                    generation = signature.generation;
+                    generationAmbiguous = signature.ambiguous;
+                    break;
+                }
+            }
+        }
+
         // Detect card type based on ATQA and SAK values
         // Reference: NFC Forum Type Tags and ISO14443 specifications
         // Note: ATQA is stored in little-endian format (as received from PN532)
@@ -77,6 +129,97 @@ namespace nfc
         return type;
     }
 
+    bool CardInfo::parseAts()
+    {
+        atsInfo = AtsInfo();
+        if (ats.empty())
+        {
+            return false;
+        }
+
+        const uint8_t t0 = ats[0];
+        const uint8_t fsci = t0 & 0x0FU;
+        atsInfo.fsci = fsci;
+        atsInfo.fsc = FSC_TABLE[(fsci < 8U) ? fsci : 8U];
+
+        size_t index = 1U;
+        if ((t0 & T0_TA_PRESENT) != 0U)
+        {
+            if (index >= ats.size())
+            {
+                return false;
+            }
+            const uint8_t ta = ats[index++];
+            atsInfo.sameBitRateOnly = (ta & 0x80U) != 0U;
+            atsInfo.bitRatesFromCard = static_cast<uint8_t>(ATS_BITRATE_106 | ((ta >> 3U) & 0x0EU));
+            atsInfo.bitRatesToCard = static_cast<uint8_t>(ATS_BITRATE_106 | ((ta << 1U) & 0x0EU));
+        }
+
+        if ((t0 & T0_TB_PRESENT) != 0U)
+        {
+            if (index >= ats.size())
+            {
+                return false;
+            }
+            const uint8_t tb = ats[index++];
+            atsInfo.fwi = (tb >> 4U) & 0x0FU;
+            atsInfo.sfgi = tb & 0x0FU;
+        }
+
+        if ((t0 & T0_TC_PRESENT) != 0U)
+        {
+            if (index >= ats.size())
+            {
+                return false;
+            }
+            const uint8_t tc = ats[index++];
+            atsInfo.nadSupported = (tc & 0x01U) != 0U;
+            atsInfo.cidSupported = (tc & 0x02U) != 0U;
+        }
+
+        atsInfo.historicalOffset = static_cast<uint8_t>(index);
+        atsInfo.historicalLength = static_cast<uint8_t>(ats.size() - index);
+        atsInfo.valid = true;
+        return true;
+    }
+
+    CardGeneration CardInfo::generationFromVersion(const etl::ivector<uint8_t>& version)
+    {
+        // Hardware block: vendor, type, subtype, major, minor, storage, protocol
+        if (version.size() < 7U || version[0] != 0x04U)
+        {
+            return CardGeneration::Unknown;
+        }
+
+        const uint8_t hwType = version[1];
+        const uint8_t major = version[3];
+        if (hwType == 0x08U)
+        {
+            return CardGeneration::DesfireLight;
+        }
+        if (hwType == 0x04U && major == 0x30U)
+        {
+            return CardGeneration::Ntag424Dna;
+        }
+        if (hwType != 0x01U)
+        {
+            return CardGeneration::Unknown;
+        }
+
+        switch (major & 0xF0U)
+        {
+        case 0x00U:
+            return (major == 0x00U) ? CardGeneration::DesfireEv0 : CardGeneration::DesfireEv1;
+        case 0x10U:
+        case 0x20U:
+            return CardGeneration::DesfireEv2;
+        case 0x30U:
+            return CardGeneration::DesfireEv3;
+        default:
+            return CardGeneration::Unknown;
+        }
+    }
+
     etl::string<255> CardInfo::toString() const
     {
         etl::string<255> result;
@@ -109,31 +252,14 @@ namespace nfc
             break;
         }
 
-        // Format UID as hex string
+        // Format UID and ATS as hex strings (at most 10 and 32 bytes: 29 and 95 characters)
         char uidStr[32] = {0};
-        char *uidPtr = uidStr;
-        for (size_t i = 0; i < uid.size(); ++i)
-        {
-            uidPtr += std::snprintf(uidPtr, sizeof(uidStr) - (uidPtr - uidStr), "%02X", uid[i]);
-            if (i < uid.size() - 1)
-            {
-                uidPtr += std::snprintf(uidPtr, sizeof(uidStr) - (uidPtr - uidStr), " ");
-            }
-        }
+        utils::hexEncode(uid.data(), uid.size(), uidStr, ' ');
 
-        // Format ATS as hex string if present
         char atsStr[128] = {0};
         if (!ats.empty())
         {
-            char *atsPtr = atsStr;
-            for (size_t i = 0; i < ats.size(); ++i)
-            {
-                atsPtr += std::snprintf(atsPtr, sizeof(atsStr) - (atsPtr - atsStr), "%02X", ats[i]);
-                if (i < ats.size() - 1)
-                {
-                    atsPtr += std::snprintf(atsPtr, sizeof(atsStr) - (atsPtr - atsStr), " ");
-                }
-            }
+            utils::hexEncode(ats.data(), ats.size(), atsStr, ' ');
         }
         else
         {
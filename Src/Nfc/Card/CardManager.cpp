@@ -10,6 +10,8 @@
  */
 
 #include "Nfc/Card/CardManager.h"
+#include "Utils/Timing.h"
+#include <algorithm>
 
 namespace nfc
 {
@@ -24,6 +26,8 @@ namespace nfc
         , isoWire()
         , activeWire(&nativeWire)
         , activeWireKind(WireKind::Native)
+        , hotlist(nullptr)
+        , sessionReused(false)
     {
     }
 
@@ -47,14 +51,101 @@ namespace nfc
         return activeWireKind;
     }
 
+    void CardManager::setHotlist(const UidHotlist* list)
+    {
+        hotlist = list;
+    }
+
+    void CardManager::setTapDebounce(const TapDebounceOptions& options)
+    {
+        debounce = options;
+        recentTaps.clear();
+        fieldCard.reset();
+        sessionReused = false;
+    }
+
+    const TapDebounceMetrics& CardManager::getTapDebounceMetrics() const
+    {
+        return debounceMetrics;
+    }
+
     etl::expected<CardInfo, error::Error> CardManager::detectCard()
     {
-        // TODO: Implement card detection
+        sessionReused = false;
+        if (debounce.mode == TapDebounceMode::Off)
+        {
+            return detectInField();
+        }
+
+        const uint32_t now = nowMs();
+
+        // A card that never left the field needs no new detection
+        if (fieldCard.has_value())
+        {
+            ++debounceMetrics.presenceChecks;
+            if (detector.isCardPresent())
+            {
+                rememberTap(fieldCard.value().uid, now);
+                if (debounce.mode == TapDebounceMode::ReuseSession)
+                {
+                    ++debounceMetrics.sessionsReused;
+                    sessionReused = true;
+                    currentCardInfo = fieldCard.value();
+                    return fieldCard.value();
+                }
+
+                ++debounceMetrics.suppressed;
+                return etl::unexpected(error::Error::fromCardManager(error::CardManagerError::DuplicateTap));
+            }
+
+            // The card left; its session is gone with it
+            activeSession.reset();
+            currentCardInfo.reset();
+            fieldCard.reset();
+        }
+
+        auto result = detectInField();
+        if (!result || result.value().uid.empty())
+        {
+            return result;
+        }
+
+        // Lifted and put back within the window: the tap was already processed
+        const bool duplicate = seenWithinWindow(result.value().uid, now);
+        rememberTap(result.value().uid, now);
+        if (duplicate)
+        {
+            ++debounceMetrics.suppressed;
+            return etl::unexpected(error::Error::fromCardManager(error::CardManagerError::DuplicateTap));
+        }
+
+        return result;
+    }
+
+    etl::expected<CardInfo, error::Error> CardManager::detectInField()
+    {
+        ++debounceMetrics.detections;
         auto result = detector.detectCard();
         
         if (result.has_value())
         {
+            // Hotlisted cards never get a session; an empty field has no card to check
+            if (hotlist != nullptr && !result.value().uid.empty() && !hotlist->allows(result.value().uid))
+            {
+                currentCardInfo.reset();
+                fieldCard.reset();
+                return etl::unexpected(error::Error::fromCardManager(error::CardManagerError::CardRejected));
+            }
+
+            // Empty field: no card to remember or to open a session for
+            if (result.value().uid.empty())
+            {
+                currentCardInfo.reset();
+                return result.value();
+            }
+
             currentCardInfo = result.value();
+            fieldCard = result.value();
             
             // Configure adapter with current wire protocol for this card session
             // Note: Wire selection is done via setWire() before detection
@@ -63,9 +154,64 @@ namespace nfc
             return result.value();
         }
         
+        fieldCard.reset();
         return etl::unexpected(result.error());
     }
 
+    uint32_t CardManager::nowMs() const
+    {
+        return (debounce.clock != nullptr) ? debounce.clock() : utils::get_tick_ms();
+    }
+
+    bool CardManager::seenWithinWindow(const etl::ivector<uint8_t>& uid, uint32_t now) const
+    {
+        for (size_t i = 0U; i < recentTaps.size(); ++i)
+        {
+            const RecentTap& tap = recentTaps[i];
+            if (tap.uid.size() == uid.size() &&
+                std::equal(tap.uid.begin(), tap.uid.end(), uid.begin()) &&
+                static_cast<uint32_t>(now - tap.seenMs) < debounce.windowMs)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void CardManager::rememberTap(const etl::ivector<uint8_t>& uid, uint32_t now)
+    {
+        size_t slot = recentTaps.size();
+        size_t oldest = 0U;
+        for (size_t i = 0U; i < recentTaps.size(); ++i)
+        {
+            const RecentTap& tap = recentTaps[i];
+            if (tap.uid.size() == uid.size() && std::equal(tap.uid.begin(), tap.uid.end(), uid.begin()))
+            {
+                slot = i;
+                break;
+            }
+            if (static_cast<uint32_t>(now - tap.seenMs) > static_cast<uint32_t>(now - recentTaps[oldest].seenMs))
+            {
+                oldest = i;
+            }
+        }
+
+        if (slot == recentTaps.size())
+        {
+            if (recentTaps.full())
+            {
+                slot = oldest;
+            }
+            else
+            {
+                recentTaps.push_back(RecentTap());
+            }
+        }
+
+        recentTaps[slot].uid.assign(uid.begin(), uid.end());
+        recentTaps[slot].seenMs = now;
+    }
+
     bool CardManager::isCardPresent()
     {
         return detector.isCardPresent();
@@ -79,6 +225,12 @@ namespace nfc
             return etl::unexpected(error::Error::fromCardManager(error::CardManagerError::NoCardPresent));
             
         }
+        // Same card, never left the field: keep its session and card state
+        if (sessionReused && activeSession.has_value())
+        {
+            return &activeSession.value();
+        }
+
         // Create session from the already-detected card, passing the managed wire
         auto sessionResult = CardSession::create(transceiver, currentCardInfo.value(), *activeWire);
         
@@ -87,7 +239,7 @@ namespace nfc
             return etl::unexpected(sessionResult.error());
         }
 
-        activeSession = sessionResult.value();
+        activeSession.emplace(sessionResult.value());
         return &activeSession.value();
     }
 
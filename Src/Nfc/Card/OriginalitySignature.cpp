@@ -0,0 +1,936 @@
+/**
+ * @file OriginalitySignature.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief NXP originality signature verifier implementation
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Nfc/Card/OriginalitySignature.h"
+#include "Error/CardManagerError.h"
+#include <cstring>
+
+using namespace nfc;
+
+namespace
+{
+    constexpr size_t MAX_LIMBS = OriginalitySignatureVerifier::MAX_LIMBS;
+    constexpr size_t COMB_TEETH = 8U;
+    constexpr size_t BATCH_CHUNK = 16U;
+
+    /**
+     * @brief Curve domain parameters (SEC 2), big endian
+     */
+    struct CurveParameters
+    {
+        size_t bytes;
+        const uint8_t* p;
+        const uint8_t* n;
+        const uint8_t* b;
+        const uint8_t* gx;
+        const uint8_t* gy;
+    };
+
+    constexpr uint8_t SECP128R1_P[16] = {
+        0xFF, 0xFF, 0xFF, 0xFD, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    constexpr uint8_t SECP128R1_N[16] = {
+        0xFF, 0xFF, 0xFF, 0xFE, 0x00, 0x00, 0x00, 0x00, 0x75, 0xA3, 0x0D, 0x1B, 0x90, 0x38, 0xA1, 0x15};
+    constexpr uint8_t SECP128R1_B[16] = {
+        0xE8, 0x75, 0x79, 0xC1, 0x10, 0x79, 0xF4, 0x3D, 0xD8, 0x24, 0x99, 0x3C, 0x2C, 0xEE, 0x5E, 0xD3};
+    constexpr uint8_t SECP128R1_GX[16] = {
+        0x16, 0x1F, 0xF7, 0x52, 0x8B, 0x89, 0x9B, 0x2D, 0x0C, 0x28, 0x60, 0x7C, 0xA5, 0x2C, 0x5B, 0x86};
+    constexpr uint8_t SECP128R1_GY[16] = {
+        0xCF, 0x5A, 0xC8, 0x39, 0x5B, 0xAF, 0xEB, 0x13, 0xC0, 0x2D, 0xA2, 0x92, 0xDD, 0xED, 0x7A, 0x83};
+
+    constexpr uint8_t SECP224R1_P[28] = {
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01};
+    constexpr uint8_t SECP224R1_N[28] = {
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x16, 0xA2,
+        0xE0, 0xB8, 0xF0, 0x3E, 0x13, 0xDD, 0x29, 0x45, 0x5C, 0x5C, 0x2A, 0x3D};
+    constexpr uint8_t SECP224R1_B[28] = {
+        0xB4, 0x05, 0x0A, 0x85, 0x0C, 0x04, 0xB3, 0xAB, 0xF5, 0x41, 0x32, 0x56, 0x50, 0x44, 0xB0, 0xB7,
+        0xD7, 0xBF, 0xD8, 0xBA, 0x27, 0x0B, 0x39, 0x43, 0x23, 0x55, 0xFF, 0xB4};
+    constexpr uint8_t SECP224R1_GX[28] = {
+        0xB7, 0x0E, 0x0C, 0xBD, 0x6B, 0xB4, 0xBF, 0x7F, 0x32, 0x13, 0x90, 0xB9, 0x4A, 0x03, 0xC1, 0xD3,
+        0x56, 0xC2, 0x11, 0x22, 0x34, 0x32, 0x80, 0xD6, 0x11, 0x5C, 0x1D, 0x21};
+    constexpr uint8_t SECP224R1_GY[28] = {
+        0xBD, 0x37, 0x63, 0x88, 0xB5, 0xF7, 0x23, 0xFB, 0x4C, 0x22, 0xDF, 0xE6, 0xCD, 0x43, 0x75, 0xA0,
+        0x5A, 0x07, 0x47, 0x64, 0x44, 0xD5, 0x81, 0x99, 0x85, 0x00, 0x7E, 0x34};
+
+    const CurveParameters CURVES[2] = {
+        {16U, SECP128R1_P, SECP128R1_N, SECP128R1_B, SECP128R1_GX, SECP128R1_GY},
+        {28U, SECP224R1_P, SECP224R1_N, SECP224R1_B, SECP224R1_GX, SECP224R1_GY}};
+
+    // NXP originality public keys, uncompressed
+    constexpr uint8_t KEY_NTAG21X[33] = {
+        0x04, 0x49, 0x4E, 0x1A, 0x38, 0x6D, 0x3D, 0x3C, 0xFE, 0x3D, 0xC1, 0x0E, 0x5D, 0xE6, 0x8A, 0x49,
+        0x9B, 0x1C, 0x20, 0x2D, 0xB5, 0xB1, 0x32, 0x39, 0x3E, 0x89, 0xED, 0x19, 0xFE, 0x5B, 0xE8, 0xBC,
+        0x61};
+    constexpr uint8_t KEY_DESFIRE_EV2[57] = {
+        0x04, 0xB3, 0x04, 0xDC, 0x4C, 0x61, 0x5F, 0x53, 0x26, 0xFE, 0x93, 0x83, 0xDD, 0xEC, 0x9A, 0xA8,
+        0x92, 0xDF, 0x3A, 0x57, 0xFA, 0x7F, 0xFB, 0x32, 0x76, 0x19, 0x2B, 0xC0, 0xEA, 0xA2, 0x52, 0xED,
+        0x45, 0xA8, 0x65, 0xE3, 0xB0, 0x93, 0xA3, 0xD0, 0xDC, 0xE5, 0xBE, 0x29, 0xE9, 0x2F, 0x13, 0x92,
+        0xCE, 0x7D, 0xE3, 0x21, 0xE3, 0xE5, 0xC5, 0x2B, 0x3A};
+    constexpr uint8_t KEY_DESFIRE_EV3[57] = {
+        0x04, 0x8A, 0x9B, 0x38, 0x0A, 0xF2, 0xEE, 0x1B, 0x98, 0xDC, 0x41, 0x7F, 0xEC, 0xC2, 0x63, 0xF8,
+        0x44, 0x9C, 0x76, 0x25, 0xCE, 0xCE, 0x82, 0xD9, 0xB9, 0x16, 0xC9, 0x92, 0xDA, 0x20, 0x9D, 0x68,
+        0x42, 0x2B, 0x81, 0xEC, 0x20, 0xB6, 0x5A, 0x66, 0xB5, 0x10, 0x2A, 0x61, 0x59, 0x6A, 0xF3, 0x37,
+        0x92, 0x00, 0x59, 0x93, 0x16, 0xA0, 0x0A, 0x14, 0x10};
+    constexpr uint8_t KEY_DESFIRE_LIGHT[57] = {
+        0x04, 0x0E, 0x98, 0xE1, 0x17, 0xAA, 0xA3, 0x64, 0x57, 0xF4, 0x31, 0x73, 0xDC, 0x92, 0x0A, 0x87,
+        0x57, 0x26, 0x7F, 0x44, 0xCE, 0x4E, 0xC5, 0xAD, 0xD3, 0xC5, 0x40, 0x75, 0x57, 0x1A, 0xEB, 0xBF,
+        0x7B, 0x94, 0x2A, 0x97, 0x74, 0xA1, 0xD9, 0x4A, 0xD0, 0x25, 0x72, 0x42, 0x7E, 0x5A, 0xE0, 0xA2,
+        0xDD, 0x36, 0x59, 0x1B, 0x1F, 0xB3, 0x4F, 0xCF, 0x3D};
+
+    struct Fe
+    {
+        uint32_t v[MAX_LIMBS];
+    };
+
+    void loadBigEndian(Fe& out, const uint8_t* bytes, size_t length)
+    {
+        std::memset(out.v, 0, sizeof(out.v));
+        for (size_t i = 0U; i < length; ++i)
+        {
+            const size_t bit = (length - 1U - i) * 8U;
+            out.v[bit / 32U] |= static_cast<uint32_t>(bytes[i]) << (bit % 32U);
+        }
+    }
+
+    bool lessThan(const Fe& a, const Fe& b, size_t limbs)
+    {
+        for (size_t i = limbs; i > 0U; --i)
+        {
+            if (a.v[i - 1U] != b.v[i - 1U])
+            {
+                return a.v[i - 1U] < b.v[i - 1U];
+            }
+        }
+        return false;
+    }
+
+    bool isZero(const Fe& a, size_t limbs)
+    {
+        for (size_t i = 0U; i < limbs; ++i)
+        {
+            if (a.v[i] != 0U)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // out = a + b, returns the carry
+    uint32_t addRaw(Fe& out, const Fe& a, const Fe& b, size_t limbs)
+    {
+        uint64_t carry = 0U;
+        for (size_t i = 0U; i < limbs; ++i)
+        {
+            carry += static_cast<uint64_t>(a.v[i]) + b.v[i];
+            out.v[i] = static_cast<uint32_t>(carry);
+            carry >>= 32U;
+        }
+        return static_cast<uint32_t>(carry);
+    }
+
+    // out = a - b, returns the borrow
+    uint32_t subRaw(Fe& out, const Fe& a, const Fe& b, size_t limbs)
+    {
+        int64_t borrow = 0;
+        for (size_t i = 0U; i < limbs; ++i)
+        {
+            borrow += static_cast<int64_t>(a.v[i]) - b.v[i];
+            out.v[i] = static_cast<uint32_t>(borrow);
+            borrow >>= 32;
+        }
+        return (borrow != 0) ? 1U : 0U;
+    }
+
+    bool testBit(const Fe& a, size_t bit)
+    {
+        return ((a.v[bit / 32U] >> (bit % 32U)) & 1U) != 0U;
+    }
+
+    /**
+     * @brief Montgomery arithmetic modulo an odd prime
+     */
+    struct Modulus
+    {
+        size_t limbs = 0U;
+        size_t bits = 0U;
+        Fe m = {};
+        Fe one = {};        // R mod m
+        Fe rr = {};         // R^2 mod m
+        uint32_t minv = 0U; // -m^-1 mod 2^32
+
+        void init(const uint8_t* bytes, size_t length)
+        {
+            limbs = (length + 3U) / 4U;
+            loadBigEndian(m, bytes, length);
+            bits = limbs * 32U;
+            while (bits > 0U && !testBit(m, bits - 1U))
+            {
+                --bits;
+            }
+
+            uint32_t inverse = 1U;
+            for (size_t i = 0U; i < 5U; ++i)
+            {
+                inverse *= 2U - (m.v[0] * inverse);
+            }
+            minv = static_cast<uint32_t>(0U - inverse);
+
+            // 2^k mod m by doubling, for k = 32 * limbs and 64 * limbs
+            Fe value = {};
+            value.v[0] = 1U;
+            for (size_t i = 0U; i < 64U * limbs; ++i)
+            {
+                add(value, value, value);
+                if (i + 1U == 32U * limbs)
+                {
+                    one = value;
+                }
+            }
+            rr = value;
+        }
+
+        void add(Fe& out, const Fe& a, const Fe& b) const
+        {
+            Fe sum = {};
+            const uint32_t carry = addRaw(sum, a, b, limbs);
+            if (carry != 0U || !lessThan(sum, m, limbs))
+            {
+                (void)subRaw(sum, sum, m, limbs);
+            }
+            out = sum;
+        }
+
+        void sub(Fe& out, const Fe& a, const Fe& b) const
+        {
+            Fe difference = {};
+            if (subRaw(difference, a, b, limbs) != 0U)
+            {
+                (void)addRaw(difference, difference, m, limbs);
+            }
+            out = difference;
+        }
+
+        // CIOS Montgomery multiplication: out = a * b / R mod m
+        void mul(Fe& out, const Fe& a, const Fe& b) const
+        {
+            uint32_t t[MAX_LIMBS + 2U] = {0};
+            for (size_t i = 0U; i < limbs; ++i)
+            {
+                uint64_t carry = 0U;
+                for (size_t j = 0U; j < limbs; ++j)
+                {
+                    const uint64_t s = (static_cast<uint64_t>(a.v[j]) * b.v[i]) + t[j] + carry;
+                    t[j] = static_cast<uint32_t>(s);
+                    carry = s >> 32U;
+                }
+                uint64_t s = static_cast<uint64_t>(t[limbs]) + carry;
+                t[limbs] = static_cast<uint32_t>(s);
+                t[limbs + 1U] = static_cast<uint32_t>(s >> 32U);
+
+                const uint32_t q = t[0] * minv;
+                s = (static_cast<uint64_t>(q) * m.v[0]) + t[0];
+                carry = s >> 32U;
+                for (size_t j = 1U; j < limbs; ++j)
+                {
+                    s = (static_cast<uint64_t>(q) * m.v[j]) + t[j] + carry;
+                    t[j - 1U] = static_cast<uint32_t>(s);
+                    carry = s >> 32U;
+                }
+                s = static_cast<uint64_t>(t[limbs]) + carry;
+                t[limbs - 1U] = static_cast<uint32_t>(s);
+                t[limbs] = t[limbs + 1U] + static_cast<uint32_t>(s >> 32U);
+            }
+
+            Fe result = {};
+            std::memcpy(result.v, t, limbs * sizeof(uint32_t));
+            if (t[limbs] != 0U || !lessThan(result, m, limbs))
+            {
+                (void)subRaw(result, result, m, limbs);
+            }
+            out = result;
+        }
+
+        void toMont(Fe& out, const Fe& a) const
+        {
+            mul(out, a, rr);
+        }
+
+        void fromMont(Fe& out, const Fe& a) const
+        {
+            Fe unit = {};
+            unit.v[0] = 1U;
+            mul(out, a, unit);
+        }
+
+        // a^(m-2) in Montgomery form
+        void invert(Fe& out, const Fe& a) const
+        {
+            Fe exponent = m;
+            Fe two = {};
+            two.v[0] = 2U;
+            (void)subRaw(exponent, exponent, two, limbs);
+
+            Fe result = one;
+            for (size_t bit = bits; bit > 0U; --bit)
+            {
+                mul(result, result, result);
+                if (testBit(exponent, bit - 1U))
+                {
+                    mul(result, result, a);
+                }
+            }
+            out = result;
+        }
+    };
+
+    struct Curve
+    {
+        size_t bytes = 0U;
+        size_t spacing = 0U;    // comb column count
+        Modulus p;
+        Modulus n;
+        Fe b = {};              // Montgomery form
+    };
+
+    struct Affine
+    {
+        Fe x;
+        Fe y;
+    };
+
+    struct Jacobian
+    {
+        Fe x;
+        Fe y;
+        Fe z;
+        bool infinity;
+    };
+
+    Curve buildCurve(const CurveParameters& parameters)
+    {
+        Curve curve;
+        curve.bytes = parameters.bytes;
+        curve.p.init(parameters.p, parameters.bytes);
+        curve.n.init(parameters.n, parameters.bytes);
+        curve.spacing = (curve.n.bits + COMB_TEETH - 1U) / COMB_TEETH;
+        Fe b;
+        loadBigEndian(b, parameters.b, parameters.bytes);
+        curve.p.toMont(curve.b, b);
+        return curve;
+    }
+
+    const Curve& curveFor(OriginalityCurve id)
+    {
+        static const Curve curves[2] = {buildCurve(CURVES[0]), buildCurve(CURVES[1])};
+        return curves[static_cast<size_t>(id)];
+    }
+
+    const uint8_t* nxpKey(OriginalityKeyId key)
+    {
+        switch (key)
+        {
+            case OriginalityKeyId::Ntag21x:
+                return KEY_NTAG21X;
+            case OriginalityKeyId::DesfireEv2:
+                return KEY_DESFIRE_EV2;
+            case OriginalityKeyId::DesfireEv3:
+                return KEY_DESFIRE_EV3;
+            case OriginalityKeyId::DesfireLight:
+                return KEY_DESFIRE_LIGHT;
+            default:
+                return nullptr;
+        }
+    }
+
+    // Doubling for a = -3 (dbl-2001-b)
+    void pointDouble(const Curve& curve, Jacobian& r)
+    {
+        if (r.infinity || isZero(r.y, curve.p.limbs))
+        {
+            r.infinity = true;
+            return;
+        }
+
+        const Modulus& f = curve.p;
+        Fe delta, gamma, beta, alpha, t1, t2;
+        f.mul(delta, r.z, r.z);
+        f.mul(gamma, r.y, r.y);
+        f.mul(beta, r.x, gamma);
+        f.sub(t1, r.x, delta);
+        f.add(t2, r.x, delta);
+        f.mul(alpha, t1, t2);
+        f.add(t1, alpha, alpha);
+        f.add(alpha, alpha, t1);
+
+        // Z3 = (Y + Z)^2 - gamma - delta
+        f.add(t1, r.y, r.z);
+        f.mul(t1, t1, t1);
+        f.sub(t1, t1, gamma);
+        f.sub(r.z, t1, delta);
+
+        // X3 = alpha^2 - 8 beta
+        f.add(beta, beta, beta);
+        f.add(beta, beta, beta);     // 4 beta
+        f.add(t2, beta, beta);       // 8 beta
+        f.mul(t1, alpha, alpha);
+        f.sub(r.x, t1, t2);
+
+        // Y3 = alpha (4 beta - X3) - 8 gamma^2
+        f.sub(t1, beta, r.x);
+        f.mul(t1, alpha, t1);
+        f.mul(gamma, gamma, gamma);
+        f.add(gamma, gamma, gamma);
+        f.add(gamma, gamma, gamma);
+        f.add(gamma, gamma, gamma);
+        f.sub(r.y, t1, gamma);
+    }
+
+    // Mixed addition r += q
+    void pointAdd(const Curve& curve, Jacobian& r, const Affine& q)
+    {
+        const Modulus& f = curve.p;
+        if (r.infinity)
+        {
+            r.x = q.x;
+            r.y = q.y;
+            r.z = f.one;
+            r.infinity = false;
+            return;
+        }
+
+        Fe z1z1, u2, s2, h, rr, hh, hhh, v, t;
+        f.mul(z1z1, r.z, r.z);
+        f.mul(u2, q.x, z1z1);
+        f.mul(s2, q.y, r.z);
+        f.mul(s2, s2, z1z1);
+        f.sub(h, u2, r.x);
+        f.sub(rr, s2, r.y);
+
+        if (isZero(h, f.limbs))
+        {
+            if (isZero(rr, f.limbs))
+            {
+                pointDouble(curve, r);
+            }
+            else
+            {
+                r.infinity = true;
+            }
+            return;
+        }
+
+        f.mul(hh, h, h);
+        f.mul(hhh, h, hh);
+        f.mul(v, r.x, hh);
+
+        f.mul(t, rr, rr);
+        f.sub(t, t, hhh);
+        f.sub(t, t, v);
+        f.sub(t, t, v);
+
+        f.sub(v, v, t);
+        f.mul(v, rr, v);
+        f.mul(hhh, r.y, hhh);
+        f.sub(r.y, v, hhh);
+        r.x = t;
+        f.mul(r.z, r.z, h);
+    }
+
+    void toAffine(const Curve& curve, const Jacobian& point, Affine& out)
+    {
+        const Modulus& f = curve.p;
+        Fe zInv, zInv2;
+        f.invert(zInv, point.z);
+        f.mul(zInv2, zInv, zInv);
+        f.mul(out.x, point.x, zInv2);
+        f.mul(zInv2, zInv2, zInv);
+        f.mul(out.y, point.y, zInv2);
+    }
+
+    // Loads an uncompressed point and checks y^2 = x^3 - 3x + b
+    bool loadPoint(const Curve& curve, const uint8_t* encoded, size_t length, Affine& out)
+    {
+        if (length != (1U + (2U * curve.bytes)) || encoded[0] != 0x04U)
+        {
+            return false;
+        }
+
+        const Modulus& f = curve.p;
+        Fe x, y;
+        loadBigEndian(x, encoded + 1U, curve.bytes);
+        loadBigEndian(y, encoded + 1U + curve.bytes, curve.bytes);
+        if (!lessThan(x, f.m, f.limbs) || !lessThan(y, f.m, f.limbs))
+        {
+            return false;
+        }
+
+        f.toMont(out.x, x);
+        f.toMont(out.y, y);
+
+        Fe lhs, rhs, t;
+        f.mul(lhs, out.y, out.y);
+        f.mul(rhs, out.x, out.x);
+        f.mul(rhs, rhs, out.x);
+        f.add(t, out.x, out.x);
+        f.add(t, t, out.x);
+        f.sub(rhs, rhs, t);
+        f.add(rhs, rhs, curve.b);
+        return std::memcmp(lhs.v, rhs.v, sizeof(lhs.v)) == 0;
+    }
+
+    size_t combIndex(const Fe& scalar, size_t column, size_t spacing)
+    {
+        size_t index = 0U;
+        for (size_t tooth = 0U; tooth < COMB_TEETH; ++tooth)
+        {
+            const size_t bit = (tooth * spacing) + column;
+            if (bit < (MAX_LIMBS * 32U) && testBit(scalar, bit))
+            {
+                index |= static_cast<size_t>(1U) << tooth;
+            }
+        }
+        return index;
+    }
+
+    /**
+     * @brief Parsed signature ready for the curve step
+     */
+    struct PendingSignature
+    {
+        Fe e;
+        Fe r;
+        Fe sMont;
+        bool wellFormed;
+    };
+
+    bool parseSignature(
+        const Curve& curve,
+        const uint8_t* uid,
+        size_t uidLength,
+        const uint8_t* signature,
+        size_t signatureLength,
+        PendingSignature& out)
+    {
+        out.wellFormed = false;
+        if (uid == nullptr || signature == nullptr || uidLength == 0U ||
+            uidLength > OriginalitySignatureVerifier::MAX_UID_LENGTH ||
+            signatureLength != (2U * curve.bytes))
+        {
+            return false;
+        }
+
+        const Modulus& n = curve.n;
+        Fe s;
+        loadBigEndian(out.r, signature, curve.bytes);
+        loadBigEndian(s, signature + curve.bytes, curve.bytes);
+        if (isZero(out.r, n.limbs) || isZero(s, n.limbs) ||
+            !lessThan(out.r, n.m, n.limbs) || !lessThan(s, n.m, n.limbs))
+        {
+            return false;
+        }
+
+        // No hash: the UID is the message, shorter than n
+        loadBigEndian(out.e, uid, uidLength);
+        n.toMont(out.sMont, s);
+        out.wellFormed = true;
+        return true;
+    }
+}
+
+OriginalitySignatureVerifier::OriginalitySignatureVerifier()
+    : generatorTables()
+    , keyTables()
+    , customCurve(OriginalityCurve::Secp224r1)
+    , customKey()
+    , customKeySet(false)
+    , cache()
+    , cacheNext(0U)
+    , verifierMetrics()
+{
+}
+
+etl::expected<OriginalityKeyId, error::Error> OriginalitySignatureVerifier::keyFor(CardGeneration generation)
+{
+    switch (generation)
+    {
+        case CardGeneration::DesfireEv2:
+            return OriginalityKeyId::DesfireEv2;
+        case CardGeneration::DesfireEv3:
+        case CardGeneration::Ntag424Dna:
+            return OriginalityKeyId::DesfireEv3;
+        case CardGeneration::DesfireLight:
+            return OriginalityKeyId::DesfireLight;
+        default:
+            return etl::unexpected(error::Error::fromCardManager(error::CardManagerError::UnsupportedCardType));
+    }
+}
+
+size_t OriginalitySignatureVerifier::signatureLength(OriginalityCurve curve)
+{
+    return (curve == OriginalityCurve::Secp128r1) ? 32U : 56U;
+}
+
+OriginalityCurve OriginalitySignatureVerifier::curveOf(OriginalityKeyId key) const
+{
+    if (key == OriginalityKeyId::Custom)
+    {
+        return customCurve;
+    }
+    return (key == OriginalityKeyId::Ntag21x) ? OriginalityCurve::Secp128r1 : OriginalityCurve::Secp224r1;
+}
+
+etl::expected<void, error::Error> OriginalitySignatureVerifier::setCustomKey(
+    OriginalityCurve curve,
+    const uint8_t* publicKey,
+    size_t length)
+{
+    Affine point;
+    if (publicKey == nullptr || length > sizeof(customKey) || !loadPoint(curveFor(curve), publicKey, length, point))
+    {
+        return etl::unexpected(error::Error::fromCardManager(error::CardManagerError::InvalidParameter));
+    }
+
+    customCurve = curve;
+    std::memcpy(customKey, publicKey, length);
+    customKeySet = true;
+    keyTables[static_cast<size_t>(OriginalityKeyId::Custom)].ready = false;
+
+    // Results for the previous custom key no longer apply
+    for (size_t i = 0U; i < CACHE_SIZE; ++i)
+    {
+        if (cache[i].key == OriginalityKeyId::Custom)
+        {
+            cache[i].used = false;
+        }
+    }
+    return {};
+}
+
+etl::expected<void, error::Error> OriginalitySignatureVerifier::precompute(OriginalityKeyId key)
+{
+    return ensureTables(key);
+}
+
+etl::expected<bool, error::Error> OriginalitySignatureVerifier::verify(
+    OriginalityKeyId key,
+    const etl::ivector<uint8_t>& uid,
+    const etl::ivector<uint8_t>& signature)
+{
+    const CacheEntry* cached = findCached(key, uid, signature);
+    if (cached != nullptr)
+    {
+        ++verifierMetrics.cacheHits;
+        return cached->valid;
+    }
+
+    const Curve& curve = curveFor(curveOf(key));
+    if (uid.empty() || uid.size() > MAX_UID_LENGTH || signature.size() != (2U * curve.bytes))
+    {
+        return etl::unexpected(error::Error::fromCardManager(error::CardManagerError::InvalidParameter));
+    }
+
+    OriginalityBatchItem item;
+    item.uid = uid.data();
+    item.uidLength = uid.size();
+    item.signature = signature.data();
+    item.signatureLength = signature.size();
+    auto result = verifyBatch(key, &item, 1U);
+    if (!result)
+    {
+        return etl::unexpected(result.error());
+    }
+
+    storeCached(key, uid, signature, item.valid);
+    return item.valid;
+}
+
+etl::expected<size_t, error::Error> OriginalitySignatureVerifier::verifyBatch(
+    OriginalityKeyId key,
+    OriginalityBatchItem* items,
+    size_t count)
+{
+    auto tablesResult = ensureTables(key);
+    if (!tablesResult)
+    {
+        return etl::unexpected(tablesResult.error());
+    }
+
+    const OriginalityCurve curveId = curveOf(key);
+    const Curve& curve = curveFor(curveId);
+    const Modulus& p = curve.p;
+    const Modulus& n = curve.n;
+    const CombTable& generator = generatorTables[static_cast<size_t>(curveId)];
+    const CombTable& keyTable = keyTables[static_cast<size_t>(key)];
+
+    size_t validCount = 0U;
+    for (size_t start = 0U; start < count; start += BATCH_CHUNK)
+    {
+        const size_t chunk = ((count - start) < BATCH_CHUNK) ? (count - start) : BATCH_CHUNK;
+        PendingSignature pending[BATCH_CHUNK];
+        Fe prefix[BATCH_CHUNK];
+        size_t wellFormed[BATCH_CHUNK];
+        size_t wellFormedCount = 0U;
+
+        for (size_t i = 0U; i < chunk; ++i)
+        {
+            OriginalityBatchItem& item = items[start + i];
+            item.valid = false;
+            if (!parseSignature(curve, item.uid, item.uidLength, item.signature, item.signatureLength, pending[i]))
+            {
+                ++verifierMetrics.rejected;
+                continue;
+            }
+
+            // Running product of s values for a single shared inversion
+            if (wellFormedCount == 0U)
+            {
+                prefix[0] = pending[i].sMont;
+            }
+            else
+            {
+                n.mul(prefix[wellFormedCount], prefix[wellFormedCount - 1U], pending[i].sMont);
+            }
+            wellFormed[wellFormedCount++] = i;
+        }
+
+        if (wellFormedCount == 0U)
+        {
+            continue;
+        }
+
+        Fe inverse;
+        n.invert(inverse, prefix[wellFormedCount - 1U]);
+        for (size_t k = wellFormedCount; k > 0U; --k)
+        {
+            PendingSignature& signature = pending[wellFormed[k - 1U]];
+            Fe w;
+            if (k > 1U)
+            {
+                n.mul(w, inverse, prefix[k - 2U]);
+                n.mul(inverse, inverse, signature.sMont);
+            }
+            else
+            {
+                w = inverse;
+            }
+
+            // Montgomery product of a plain and a Montgomery value is plain
+            Fe u1, u2;
+            n.mul(u1, signature.e, w);
+            n.mul(u2, signature.r, w);
+
+            Jacobian point = {};
+            point.infinity = true;
+            for (size_t column = curve.spacing; column > 0U; --column)
+            {
+                pointDouble(curve, point);
+                const size_t i1 = combIndex(u1, column - 1U, curve.spacing);
+                if (i1 != 0U)
+                {
+                    Affine entry;
+                    std::memcpy(entry.x.v, generator.x[i1 - 1U], sizeof(entry.x.v));
+                    std::memcpy(entry.y.v, generator.y[i1 - 1U], sizeof(entry.y.v));
+                    pointAdd(curve, point, entry);
+                }
+                const size_t i2 = combIndex(u2, column - 1U, curve.spacing);
+                if (i2 != 0U)
+                {
+                    Affine entry;
+                    std::memcpy(entry.x.v, keyTable.x[i2 - 1U], sizeof(entry.x.v));
+                    std::memcpy(entry.y.v, keyTable.y[i2 - 1U], sizeof(entry.y.v));
+                    pointAdd(curve, point, entry);
+                }
+            }
+            ++verifierMetrics.verifications;
+
+            // Valid when x(R) mod n == r: compare r * Z^2 and r + n (when
+            // still below p) against X without leaving projective form.
+            bool valid = false;
+            if (!point.infinity)
+            {
+                Fe zz;
+                p.mul(zz, point.z, point.z);
+                Fe candidate = signature.r;
+                for (size_t attempt = 0U; attempt < 2U && !valid; ++attempt)
+                {
+                    if (attempt == 1U && addRaw(candidate, candidate, n.m, n.limbs) != 0U)
+                    {
+                        break;
+                    }
+                    if (!lessThan(candidate, p.m, p.limbs))
+                    {
+                        break;
+                    }
+                    Fe candidateMont, scaled;
+                    p.toMont(candidateMont, candidate);
+                    p.mul(scaled, candidateMont, zz);
+                    valid = std::memcmp(scaled.v, point.x.v, sizeof(scaled.v)) == 0;
+                }
+            }
+
+            items[start + wellFormed[k - 1U]].valid = valid;
+            if (valid)
+            {
+                ++validCount;
+            }
+            else
+            {
+                ++verifierMetrics.rejected;
+            }
+        }
+    }
+
+    return validCount;
+}
+
+void OriginalitySignatureVerifier::clearCache()
+{
+    for (size_t i = 0U; i < CACHE_SIZE; ++i)
+    {
+        cache[i].used = false;
+    }
+    cacheNext = 0U;
+}
+
+const OriginalityVerifierMetrics& OriginalitySignatureVerifier::metrics() const
+{
+    return verifierMetrics;
+}
+
+etl::expected<void, error::Error> OriginalitySignatureVerifier::ensureTables(OriginalityKeyId key)
+{
+    const size_t keyIndex = static_cast<size_t>(key);
+    if (keyIndex >= KEY_COUNT || (key == OriginalityKeyId::Custom && !customKeySet))
+    {
+        return etl::unexpected(error::Error::fromCardManager(error::CardManagerError::InvalidParameter));
+    }
+
+    const OriginalityCurve curveId = curveOf(key);
+    const Curve& curve = curveFor(curveId);
+    CombTable* tables[2] = {&generatorTables[static_cast<size_t>(curveId)], &keyTables[keyIndex]};
+
+    for (size_t t = 0U; t < 2U; ++t)
+    {
+        CombTable& table = *tables[t];
+        if (table.ready)
+        {
+            continue;
+        }
+
+        Affine base[COMB_TEETH];
+        if (t == 0U)
+        {
+            const CurveParameters& parameters = CURVES[static_cast<size_t>(curveId)];
+            Fe x, y;
+            loadBigEndian(x, parameters.gx, parameters.bytes);
+            loadBigEndian(y, parameters.gy, parameters.bytes);
+            curve.p.toMont(base[0].x, x);
+            curve.p.toMont(base[0].y, y);
+        }
+        else
+        {
+            const uint8_t* encoded = (key == OriginalityKeyId::Custom) ? customKey : nxpKey(key);
+            if (!loadPoint(curve, encoded, 1U + (2U * curve.bytes), base[0]))
+            {
+                return etl::unexpected(error::Error::fromCardManager(error::CardManagerError::InvalidParameter));
+            }
+        }
+
+        // base[k] = 2^(k * spacing) P
+        for (size_t k = 1U; k < COMB_TEETH; ++k)
+        {
+            Jacobian point = {base[k - 1U].x, base[k - 1U].y, curve.p.one, false};
+            for (size_t d = 0U; d < curve.spacing; ++d)
+            {
+                pointDouble(curve, point);
+            }
+            toAffine(curve, point, base[k]);
+        }
+
+        // table[j - 1] = sum of base[k] over the bits k set in j
+        for (size_t j = 1U; j <= COMB_ENTRIES; ++j)
+        {
+            size_t top = COMB_TEETH - 1U;
+            while ((j & (static_cast<size_t>(1U) << top)) == 0U)
+            {
+                --top;
+            }
+
+            Affine entry;
+            const size_t rest = j & ~(static_cast<size_t>(1U) << top);
+            if (rest == 0U)
+            {
+                entry = base[top];
+            }
+            else
+            {
+                Jacobian point = {};
+                std::memcpy(point.x.v, table.x[rest - 1U], sizeof(point.x.v));
+                std::memcpy(point.y.v, table.y[rest - 1U], sizeof(point.y.v));
+                point.z = curve.p.one;
+                point.infinity = false;
+                pointAdd(curve, point, base[top]);
+                toAffine(curve, point, entry);
+            }
+            std::memcpy(table.x[j - 1U], entry.x.v, sizeof(entry.x.v));
+            std::memcpy(table.y[j - 1U], entry.y.v, sizeof(entry.y.v));
+        }
+
+        table.ready = true;
+        ++verifierMetrics.tablesBuilt;
+    }
+
+    return {};
+}
+
+const OriginalitySignatureVerifier::CacheEntry* OriginalitySignatureVerifier::findCached(
+    OriginalityKeyId key,
+    const etl::ivector<uint8_t>& uid,
+    const etl::ivector<uint8_t>& signature) const
+{
+    if (uid.size() > MAX_UID_LENGTH || signature.size() != signatureLength(curveOf(key)))
+    {
+        return nullptr;
+    }
+
+    for (size_t i = 0U; i < CACHE_SIZE; ++i)
+    {
+        const CacheEntry& entry = cache[i];
+        if (entry.used && entry.key == key && entry.uidLength == uid.size() &&
+            std::memcmp(entry.uid, uid.data(), uid.size()) == 0 &&
+            std::memcmp(entry.signature, signature.data(), signature.size()) == 0)
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void OriginalitySignatureVerifier::storeCached(
+    OriginalityKeyId key,
+    const etl::ivector<uint8_t>& uid,
+    const etl::ivector<uint8_t>& signature,
+    bool valid)
+{
+    CacheEntry& entry = cache[cacheNext];
+    cacheNext = (cacheNext + 1U) % CACHE_SIZE;
+
+    entry.used = true;
+    entry.valid = valid;
+    entry.key = key;
+    entry.uidLength = static_cast<uint8_t>(uid.size());
+    std::memset(entry.uid, 0, sizeof(entry.uid));
+    std::memcpy(entry.uid, uid.data(), uid.size());
+    std::memset(entry.signature, 0, sizeof(entry.signature));
+    std::memcpy(entry.signature, signature.data(), signature.size());
+}
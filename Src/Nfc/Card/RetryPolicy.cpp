@@ -0,0 +1,147 @@
+/**
+ * @file RetryPolicy.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Layer-aware retry policy implementation
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Nfc/Card/RetryPolicy.h"
+
+using namespace nfc;
+
+namespace
+{
+    bool isTransientRfError(const error::Error& error)
+    {
+        if (error.is<error::Pn532Error>())
+        {
+            switch (error.get<error::Pn532Error>())
+            {
+                case error::Pn532Error::Timeout:
+                case error::Pn532Error::CRCError:
+                case error::Pn532Error::ParityError:
+                case error::Pn532Error::BitCountError:
+                case error::Pn532Error::MifareFramingError:
+                case error::Pn532Error::RFProtocolError:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        if (error.is<error::LinkError>())
+        {
+            switch (error.get<error::LinkError>())
+            {
+                case error::LinkError::Timeout:
+                case error::LinkError::CrcError:
+                case error::LinkError::ParityError:
+                case error::LinkError::RfError:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        if (error.is<error::DesfireError>())
+        {
+            // Card-side integrity failures leave the session unusable but the
+            // card itself healthy.
+            switch (error.get<error::DesfireError>())
+            {
+                case error::DesfireError::IntegrityError:
+                case error::DesfireError::CommandAborted:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        return false;
+    }
+}
+
+RetryPolicy::RetryPolicy(const RetryLimits& limits)
+    : retryLimits(limits)
+    , retryMetrics()
+{
+}
+
+RetryAction RetryPolicy::classifyCardError(const error::Error& error, bool authenticated)
+{
+    if (!isTransientRfError(error))
+    {
+        return RetryAction::Fail;
+    }
+
+    return authenticated ? RetryAction::RecoverSession : RetryAction::RestartCommand;
+}
+
+bool RetryPolicy::allows(RetryAction action, uint8_t attempt) const
+{
+    switch (action)
+    {
+        case RetryAction::ResendFrame:
+            return attempt < retryLimits.frameResends;
+        case RetryAction::RepeatResponse:
+            return attempt < retryLimits.responseRepeats;
+        case RetryAction::RestartCommand:
+            return attempt < retryLimits.commandRestarts;
+        case RetryAction::RecoverSession:
+            return attempt < retryLimits.sessionRecoveries;
+        case RetryAction::Fail:
+        default:
+            return false;
+    }
+}
+
+void RetryPolicy::recordAttempt(RetryAction action)
+{
+    switch (action)
+    {
+        case RetryAction::ResendFrame:
+            ++retryMetrics.frameResends;
+            break;
+        case RetryAction::RepeatResponse:
+            ++retryMetrics.responseRepeats;
+            break;
+        case RetryAction::RestartCommand:
+            ++retryMetrics.commandRestarts;
+            break;
+        case RetryAction::RecoverSession:
+            ++retryMetrics.sessionRecoveries;
+            break;
+        case RetryAction::Fail:
+        default:
+            break;
+    }
+}
+
+void RetryPolicy::recordRecovered()
+{
+    ++retryMetrics.recovered;
+}
+
+void RetryPolicy::recordExhausted()
+{
+    ++retryMetrics.exhausted;
+}
+
+const RetryLimits& RetryPolicy::limits() const
+{
+    return retryLimits;
+}
+
+const RetryMetrics& RetryPolicy::metrics() const
+{
+    return retryMetrics;
+}
+
+void RetryPolicy::resetMetrics()
+{
+    retryMetrics = RetryMetrics();
+}
@@ -0,0 +1,387 @@
+/**
+ * @file UidHotlist.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief UID hotlist image writer, view and hot-swap holder
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Nfc/Card/UidHotlist.h"
+#include "Error/CardManagerError.h"
+#include "Utils/Serialization.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace nfc;
+
+namespace
+{
+    struct Record
+    {
+        uint8_t bytes[UidHotlistFormat::RECORD_SIZE];
+    };
+
+    static_assert(sizeof(Record) == UidHotlistFormat::RECORD_SIZE, "Record must not be padded");
+
+    // FNV-1a over the record bytes, finished with a 64-bit mixer so both
+    // halves are usable for the Bloom filter and the top bits for buckets.
+    uint64_t hashRecord(const uint8_t* record)
+    {
+        uint64_t hash = 0xCBF29CE484222325ULL;
+        for (size_t i = 0; i < UidHotlistFormat::RECORD_SIZE; ++i)
+        {
+            hash ^= record[i];
+            hash *= 0x100000001B3ULL;
+        }
+        hash ^= hash >> 33U;
+        hash *= 0xFF51AFD7ED558CCDULL;
+        hash ^= hash >> 33U;
+        return hash;
+    }
+
+    uint32_t bucketOf(uint64_t hash, uint8_t bucketBits)
+    {
+        return static_cast<uint32_t>(hash >> (64U - bucketBits));
+    }
+
+    uint32_t bloomIndex(uint64_t hash, uint8_t round, uint8_t bloomBits)
+    {
+        const uint32_t h1 = static_cast<uint32_t>(hash);
+        const uint32_t h2 = static_cast<uint32_t>(hash >> 32U) | 1U;
+        const uint32_t mask = (bloomBits >= 32U) ? 0xFFFFFFFFU : ((1U << bloomBits) - 1U);
+        return (h1 + (static_cast<uint32_t>(round) * h2)) & mask;
+    }
+
+    bool encodeRecord(const uint8_t* uid, size_t length, uint8_t* record)
+    {
+        if (length == 0U || length > UidHotlistFormat::MAX_UID_LENGTH)
+        {
+            return false;
+        }
+
+        std::memset(record, 0, UidHotlistFormat::RECORD_SIZE);
+        record[0] = static_cast<uint8_t>(length);
+        std::memcpy(record + 1, uid, length);
+        return true;
+    }
+
+    error::Error invalidParameter()
+    {
+        return error::Error::fromCardManager(error::CardManagerError::InvalidParameter);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// UidHotlistWriter
+// ---------------------------------------------------------------------------
+
+UidHotlistWriter::UidHotlistWriter(uint8_t* buffer, size_t capacity, size_t maxEntries, uint32_t sequence)
+    : buffer(buffer)
+    , capacity(capacity)
+    , maxEntries(maxEntries)
+    , sequence(sequence)
+    , bucketBits(UidHotlistFormat::bucketLog2(maxEntries))
+    , bloomBits(UidHotlistFormat::bloomLog2(maxEntries))
+    , count(0U)
+{
+}
+
+etl::expected<void, error::Error> UidHotlistWriter::addUid(const etl::ivector<uint8_t>& uid)
+{
+    if (buffer == nullptr || capacity < UidHotlistFormat::imageSize(maxEntries))
+    {
+        return etl::unexpected(invalidParameter());
+    }
+
+    if (count >= maxEntries)
+    {
+        return etl::unexpected(error::Error::fromCardManager(error::CardManagerError::OperationFailed));
+    }
+
+    uint8_t* record = buffer + UidHotlistFormat::recordsOffset(bucketBits, bloomBits) +
+                      (count * UidHotlistFormat::RECORD_SIZE);
+    if (!encodeRecord(uid.data(), uid.size(), record))
+    {
+        return etl::unexpected(invalidParameter());
+    }
+
+    ++count;
+    return {};
+}
+
+etl::expected<size_t, error::Error> UidHotlistWriter::finish()
+{
+    if (buffer == nullptr || capacity < UidHotlistFormat::imageSize(maxEntries))
+    {
+        return etl::unexpected(invalidParameter());
+    }
+
+    const uint8_t bucketShift = bucketBits;
+    Record* first = reinterpret_cast<Record*>(buffer + UidHotlistFormat::recordsOffset(bucketBits, bloomBits));
+    Record* last = first + count;
+
+    std::sort(first, last, [bucketShift](const Record& a, const Record& b) {
+        const uint32_t bucketA = bucketOf(hashRecord(a.bytes), bucketShift);
+        const uint32_t bucketB = bucketOf(hashRecord(b.bytes), bucketShift);
+        if (bucketA != bucketB)
+        {
+            return bucketA < bucketB;
+        }
+        return std::memcmp(a.bytes, b.bytes, UidHotlistFormat::RECORD_SIZE) < 0;
+    });
+    last = std::unique(first, last, [](const Record& a, const Record& b) {
+        return std::memcmp(a.bytes, b.bytes, UidHotlistFormat::RECORD_SIZE) == 0;
+    });
+    count = static_cast<size_t>(last - first);
+
+    uint8_t* index = buffer + UidHotlistFormat::HEADER_SIZE;
+    uint8_t* bloom = index + UidHotlistFormat::indexSize(bucketBits);
+    std::memset(bloom, 0, UidHotlistFormat::bloomSize(bloomBits));
+
+    // index[b] is the first record of bucket b; index[buckets] is the end
+    const uint32_t buckets = 1U << bucketBits;
+    uint32_t bucket = 0U;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint64_t hash = hashRecord(first[i].bytes);
+        const uint32_t recordBucket = bucketOf(hash, bucketBits);
+        while (bucket <= recordBucket)
+        {
+            utils::writeLe32(index + (bucket * 4U), static_cast<uint32_t>(i));
+            ++bucket;
+        }
+
+        for (uint8_t round = 0U; round < UidHotlistFormat::HASH_COUNT; ++round)
+        {
+            const uint32_t bit = bloomIndex(hash, round, bloomBits);
+            bloom[bit / 8U] = static_cast<uint8_t>(bloom[bit / 8U] | (1U << (bit % 8U)));
+        }
+    }
+    while (bucket <= buckets)
+    {
+        utils::writeLe32(index + (bucket * 4U), static_cast<uint32_t>(count));
+        ++bucket;
+    }
+
+    std::memcpy(buffer, UidHotlistFormat::MAGIC, sizeof(UidHotlistFormat::MAGIC));
+    buffer[4] = UidHotlistFormat::VERSION;
+    buffer[5] = UidHotlistFormat::HASH_COUNT;
+    buffer[6] = bloomBits;
+    buffer[7] = bucketBits;
+    utils::writeLe32(buffer + 8, static_cast<uint32_t>(count));
+    utils::writeLe32(buffer + 12, sequence);
+    std::memset(buffer + 16, 0, UidHotlistFormat::HEADER_SIZE - 16U);
+
+    return UidHotlistFormat::recordsOffset(bucketBits, bloomBits) + (count * UidHotlistFormat::RECORD_SIZE);
+}
+
+size_t UidHotlistWriter::entryCount() const
+{
+    return count;
+}
+
+// ---------------------------------------------------------------------------
+// UidHotlistView
+// ---------------------------------------------------------------------------
+
+etl::expected<void, error::Error> UidHotlistView::open(const uint8_t* image, size_t size)
+{
+    *this = UidHotlistView();
+
+    if (image == nullptr || size < UidHotlistFormat::HEADER_SIZE ||
+        std::memcmp(image, UidHotlistFormat::MAGIC, sizeof(UidHotlistFormat::MAGIC)) != 0 ||
+        image[4] != UidHotlistFormat::VERSION)
+    {
+        return etl::unexpected(invalidParameter());
+    }
+
+    const uint8_t imageHashCount = image[5];
+    const uint8_t imageBloomBits = image[6];
+    const uint8_t imageBucketBits = image[7];
+    const size_t imageCount = utils::readLe32(image + 8);
+    if (imageHashCount == 0U || imageBloomBits < 3U || imageBloomBits > 31U ||
+        imageBucketBits == 0U || imageBucketBits > 24U)
+    {
+        return etl::unexpected(invalidParameter());
+    }
+
+    const size_t recordsStart = UidHotlistFormat::recordsOffset(imageBucketBits, imageBloomBits);
+    if (size < recordsStart || ((size - recordsStart) / UidHotlistFormat::RECORD_SIZE) < imageCount)
+    {
+        return etl::unexpected(invalidParameter());
+    }
+
+    // The index must be monotonic and end at the record count, otherwise a
+    // lookup could run past the records.
+    const uint8_t* imageIndex = image + UidHotlistFormat::HEADER_SIZE;
+    const uint32_t buckets = 1U << imageBucketBits;
+    if (utils::readLe32(imageIndex) != 0U || utils::readLe32(imageIndex + (buckets * 4U)) != imageCount)
+    {
+        return etl::unexpected(invalidParameter());
+    }
+    uint32_t previous = 0U;
+    for (uint32_t b = 1U; b <= buckets; ++b)
+    {
+        const uint32_t start = utils::readLe32(imageIndex + (b * 4U));
+        if (start < previous)
+        {
+            return etl::unexpected(invalidParameter());
+        }
+        previous = start;
+    }
+
+    index = imageIndex;
+    bloom = imageIndex + UidHotlistFormat::indexSize(imageBucketBits);
+    records = image + recordsStart;
+    count = imageCount;
+    listSequence = utils::readLe32(image + 12);
+    bucketBits = imageBucketBits;
+    bloomBits = imageBloomBits;
+    hashCount = imageHashCount;
+    return {};
+}
+
+bool UidHotlistView::contains(const uint8_t* uid, size_t length) const
+{
+    uint8_t key[UidHotlistFormat::RECORD_SIZE];
+    if (records == nullptr || !encodeRecord(uid, length, key))
+    {
+        return false;
+    }
+
+    const uint64_t hash = hashRecord(key);
+    for (uint8_t round = 0U; round < hashCount; ++round)
+    {
+        const uint32_t bit = bloomIndex(hash, round, bloomBits);
+        if ((bloom[bit / 8U] & (1U << (bit % 8U))) == 0U)
+        {
+            return false;
+        }
+    }
+
+    const uint32_t bucket = bucketOf(hash, bucketBits);
+    const uint32_t begin = utils::readLe32(index + (bucket * 4U));
+    const uint32_t end = utils::readLe32(index + ((bucket + 1U) * 4U));
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        if (std::memcmp(records + (i * UidHotlistFormat::RECORD_SIZE), key, UidHotlistFormat::RECORD_SIZE) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool UidHotlistView::isOpen() const
+{
+    return records != nullptr;
+}
+
+size_t UidHotlistView::size() const
+{
+    return count;
+}
+
+uint32_t UidHotlistView::sequence() const
+{
+    return listSequence;
+}
+
+// ---------------------------------------------------------------------------
+// UidHotlist
+// ---------------------------------------------------------------------------
+
+UidHotlist::UidHotlist(UidHotlistMode mode)
+    : listMode(mode)
+    , slots()
+    , readers()
+    , active(0U)
+{
+    readers[0].store(0U);
+    readers[1].store(0U);
+}
+
+etl::expected<void, error::Error> UidHotlist::publish(const uint8_t* image, size_t size)
+{
+    const uint8_t idle = static_cast<uint8_t>(1U - active.load());
+    if (readers[idle].load() != 0U)
+    {
+        return etl::unexpected(error::Error::fromCardManager(error::CardManagerError::OperationFailed));
+    }
+
+    // Readers only enter a slot after seeing it active, so the idle slot
+    // can be rewritten without coordination.
+    UidHotlistView view;
+    auto openResult = view.open(image, size);
+    if (!openResult)
+    {
+        return openResult;
+    }
+
+    slots[idle] = view;
+    active.store(idle);
+    return {};
+}
+
+bool UidHotlist::isPreviousReleased() const
+{
+    return readers[1U - active.load()].load() == 0U;
+}
+
+bool UidHotlist::allows(const etl::ivector<uint8_t>& uid) const
+{
+    const uint8_t slot = acquire();
+    const bool hasList = slots[slot].isOpen();
+    const bool listed = hasList && slots[slot].contains(uid.data(), uid.size());
+    release(slot);
+
+    if (listMode == UidHotlistMode::Allowlist)
+    {
+        return listed;
+    }
+    return !listed;
+}
+
+bool UidHotlist::contains(const etl::ivector<uint8_t>& uid) const
+{
+    const uint8_t slot = acquire();
+    const bool listed = slots[slot].contains(uid.data(), uid.size());
+    release(slot);
+    return listed;
+}
+
+uint32_t UidHotlist::sequence() const
+{
+    const uint8_t slot = acquire();
+    const uint32_t value = slots[slot].sequence();
+    release(slot);
+    return value;
+}
+
+UidHotlistMode UidHotlist::mode() const
+{
+    return listMode;
+}
+
+uint8_t UidHotlist::acquire() const
+{
+    for (;;)
+    {
+        const uint8_t slot = active.load();
+        readers[slot].fetch_add(1U);
+        if (active.load() == slot)
+        {
+            return slot;
+        }
+        // Swapped between the load and the increment: retry on the new slot
+        readers[slot].fetch_sub(1U);
+    }
+}
+
+void UidHotlist::release(uint8_t slot) const
+{
+    readers[slot].fetch_sub(1U);
+}
@@ -42,6 +42,22 @@ namespace
 
         return true;
     }
+
+    void initAesContext(AES_ctx& aesContext, const AuthenticateCommandOptions& options, const uint8_t* iv)
+    {
+        // Stored keys carry the expanded schedule; skip key expansion for them.
+        if (options.storedKey != nullptr && options.storedKey->hasAesSchedule)
+        {
+            for (size_t i = 0; i < DesfireStoredKey::AES_ROUND_KEY_SIZE; ++i)
+            {
+                aesContext.RoundKey[i] = options.storedKey->aesRoundKeys[i];
+            }
+            AES_ctx_set_iv(&aesContext, iv);
+            return;
+        }
+
+        AES_init_ctx_iv(&aesContext, options.key.data(), iv);
+    }
 }
 
 AuthenticateCommand::AuthenticateCommand(const AuthenticateCommandOptions& options)
@@ -77,16 +93,21 @@ etl::expected<DesfireRequest, error::Error> AuthenticateCommand::buildRequest(co
     switch (stage)
     {
         case Stage::Initial:
-            if (options.mode == DesfireAuthMode::AES && options.key.size() != 16)
+            if (options.storedKey != nullptr &&
+                ((options.mode == DesfireAuthMode::AES) != (options.storedKey->type == DesfireKeyType::AES)))
             {
                 return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
             }
-            if (options.mode == DesfireAuthMode::LEGACY && options.key.size() != 8 && options.key.size() != 16)
+            if (options.mode == DesfireAuthMode::AES && keyLength() != 16)
             {
                 return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
             }
-            if (options.mode == DesfireAuthMode::ISO && options.key.size() != 8 &&
-                options.key.size() != 16 && options.key.size() != 24)
+            if (options.mode == DesfireAuthMode::LEGACY && keyLength() != 8 && keyLength() != 16)
+            {
+                return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+            }
+            if (options.mode == DesfireAuthMode::ISO && keyLength() != 8 &&
+                keyLength() != 16 && keyLength() != 24)
             {
                 return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
             }
@@ -324,6 +345,11 @@ void AuthenticateCommand::reset()
     currentIv.resize(blockSize(), 0);
 }
 
+bool AuthenticateCommand::isReplaySafe() const
+{
+    return true;
+}
+
 void AuthenticateCommand::generateAuthResponse()
 {
     // STEP 7: Concatenate RndA || RndB'
@@ -343,7 +369,7 @@ void AuthenticateCommand::generateAuthResponse()
 
     if (options.mode == DesfireAuthMode::AES)
     {
-        if (options.key.size() < 16 || encryptedChallenge.size() < 16)
+        if (keyLength() < 16 || encryptedChallenge.size() < 16)
         {
             encryptedResponse.clear();
             return;
@@ -361,7 +387,7 @@ void AuthenticateCommand::generateAuthResponse()
         }
 
         AES_ctx aesContext;
-        AES_init_ctx_iv(&aesContext, options.key.data(), iv);
+        initAesContext(aesContext, options, iv);
         AES_CBC_encrypt_buffer(&aesContext, encryptedResponse.data(), encryptedResponse.size());
         return;
     }
@@ -374,7 +400,7 @@ void AuthenticateCommand::generateAuthResponse()
 
         if (usesSingleDesSessionKey())
         {
-            if (options.key.size() < 8)
+            if (keyLength() < 8)
             {
                 encryptedResponse.clear();
                 return;
@@ -389,7 +415,7 @@ void AuthenticateCommand::generateAuthResponse()
                 }
 
                 uint8_t transformed[8];
-                DesFireCrypto::desDecrypt(xoredBlock, options.key.data(), transformed);
+                DesFireCrypto::desDecrypt(xoredBlock, keyBytes(), transformed);
 
                 for (size_t i = 0; i < 8; ++i)
                 {
@@ -400,7 +426,7 @@ void AuthenticateCommand::generateAuthResponse()
         }
         else
         {
-            if (options.key.size() != 16)
+            if (keyLength() != 16)
             {
                 encryptedResponse.clear();
                 return;
@@ -415,7 +441,7 @@ void AuthenticateCommand::generateAuthResponse()
                 }
 
                 uint8_t transformed[8];
-                DesFireCrypto::des3Decrypt(xoredBlock, options.key.data(), transformed);
+                DesFireCrypto::des3Decrypt(xoredBlock, keyBytes(), transformed);
 
                 for (size_t i = 0; i < 8; ++i)
                 {
@@ -440,13 +466,13 @@ void AuthenticateCommand::generateAuthResponse()
     
     if (usesSingleDesSessionKey())
     {
-        if (options.key.size() < 8)
+        if (keyLength() < 8)
         {
             encryptedResponse.clear();
             return;
         }
 
-        DESCBC desCbc(bytesToUint64(options.key.data()), bytesToUint64(iv));
+        DESCBC desCbc(bytesToUint64(keyBytes()), bytesToUint64(iv));
         for (size_t offset = 0; offset < plainResponse.size(); offset += 8)
         {
             const uint64_t block = bytesToUint64(plainResponse.data() + offset);
@@ -456,16 +482,16 @@ void AuthenticateCommand::generateAuthResponse()
     }
     else if (usesThreeKey3DesSessionKey())
     {
-        if (options.key.size() != 24)
+        if (keyLength() != 24)
         {
             encryptedResponse.clear();
             return;
         }
 
         DES3CBC des3Cbc(
-            bytesToUint64(options.key.data()),
-            bytesToUint64(options.key.data() + 8),
-            bytesToUint64(options.key.data() + 16),
+            bytesToUint64(keyBytes()),
+            bytesToUint64(keyBytes() + 8),
+            bytesToUint64(keyBytes() + 16),
             bytesToUint64(iv));
 
         for (size_t offset = 0; offset < plainResponse.size(); offset += 8)
@@ -477,7 +503,7 @@ void AuthenticateCommand::generateAuthResponse()
     }
     else
     {
-        if (options.key.size() != 16)
+        if (keyLength() != 16)
         {
             encryptedResponse.clear();
             return;
@@ -486,7 +512,7 @@ void AuthenticateCommand::generateAuthResponse()
         DesFireCrypto::des3CbcEncrypt(
             plainResponse.data(),
             plainResponse.size(),
-            options.key.data(),
+            keyBytes(),
             iv,
             encryptedResponse.data());
     }
@@ -500,7 +526,7 @@ bool AuthenticateCommand::verifyAuthConfirmation(const etl::ivector<uint8_t>& re
 
     if (options.mode == DesfireAuthMode::AES)
     {
-        if (options.key.size() < 16 || response.size() < 16 || encryptedResponse.size() < 16)
+        if (keyLength() < 16 || response.size() < 16 || encryptedResponse.size() < 16)
         {
             return false;
         }
@@ -517,7 +543,7 @@ bool AuthenticateCommand::verifyAuthConfirmation(const etl::ivector<uint8_t>& re
         }
 
         AES_ctx aesContext;
-        AES_init_ctx_iv(&aesContext, options.key.data(), iv);
+        initAesContext(aesContext, options, iv);
         AES_CBC_decrypt_buffer(&aesContext, decryptedRndA.data(), decryptedRndA.size());
     }
     else if (options.mode == DesfireAuthMode::ISO)
@@ -531,26 +557,26 @@ bool AuthenticateCommand::verifyAuthConfirmation(const etl::ivector<uint8_t>& re
 
         if (usesSingleDesSessionKey())
         {
-            if (options.key.size() < 8)
+            if (keyLength() < 8)
             {
                 return false;
             }
 
-            DESCBC desCbc(bytesToUint64(options.key.data()), bytesToUint64(iv));
+            DESCBC desCbc(bytesToUint64(keyBytes()), bytesToUint64(iv));
             const uint64_t plainBlock = desCbc.decrypt(bytesToUint64(response.data()));
             uint64ToBytes(plainBlock, decryptedRndA.data());
         }
         else if (usesThreeKey3DesSessionKey())
         {
-            if (options.key.size() != 24)
+            if (keyLength() != 24)
             {
                 return false;
             }
 
             DES3CBC des3Cbc(
-                bytesToUint64(options.key.data()),
-                bytesToUint64(options.key.data() + 8),
-                bytesToUint64(options.key.data() + 16),
+                bytesToUint64(keyBytes()),
+                bytesToUint64(keyBytes() + 8),
+                bytesToUint64(keyBytes() + 16),
                 bytesToUint64(iv));
 
             for (size_t offset = 0; offset < randomSize(); offset += 8)
@@ -561,7 +587,7 @@ bool AuthenticateCommand::verifyAuthConfirmation(const etl::ivector<uint8_t>& re
         }
         else
         {
-            if (options.key.size() != 16)
+            if (keyLength() != 16)
             {
                 return false;
             }
@@ -569,7 +595,7 @@ bool AuthenticateCommand::verifyAuthConfirmation(const etl::ivector<uint8_t>& re
             DesFireCrypto::des3CbcDecrypt(
                 response.data(),
                 8,
-                options.key.data(),
+                keyBytes(),
                 iv,
                 decryptedRndA.data());
         }
@@ -579,26 +605,26 @@ bool AuthenticateCommand::verifyAuthConfirmation(const etl::ivector<uint8_t>& re
         // Legacy mode: Use ECB (single block)
         if (usesSingleDesSessionKey())
         {
-            if (options.key.size() < 8)
+            if (keyLength() < 8)
             {
                 return false;
             }
 
             DesFireCrypto::desDecrypt(
                 response.data(),
-                options.key.data(),
+                keyBytes(),
                 decryptedRndA.data());
         }
         else
         {
-            if (options.key.size() != 16)
+            if (keyLength() != 16)
             {
                 return false;
             }
 
             DesFireCrypto::des3Decrypt(
                 response.data(),
-                options.key.data(),
+                keyBytes(),
                 decryptedRndA.data());
         }
     }
@@ -634,7 +660,7 @@ void AuthenticateCommand::decryptChallenge()
 
     if (options.mode == DesfireAuthMode::AES)
     {
-        if (options.key.size() < 16 || encryptedChallenge.size() < 16)
+        if (keyLength() < 16 || encryptedChallenge.size() < 16)
         {
             rndB.clear();
             return;
@@ -647,7 +673,7 @@ void AuthenticateCommand::decryptChallenge()
 
         uint8_t zeroIv[16] = {0};
         AES_ctx aesContext;
-        AES_init_ctx_iv(&aesContext, options.key.data(), zeroIv);
+        initAesContext(aesContext, options, zeroIv);
         AES_CBC_decrypt_buffer(&aesContext, rndB.data(), rndB.size());
         return;
     }
@@ -659,28 +685,28 @@ void AuthenticateCommand::decryptChallenge()
 
         if (usesSingleDesSessionKey())
         {
-            if (options.key.size() < 8)
+            if (keyLength() < 8)
             {
                 rndB.clear();
                 return;
             }
 
-            DESCBC desCbc(bytesToUint64(options.key.data()), bytesToUint64(zeroIv));
+            DESCBC desCbc(bytesToUint64(keyBytes()), bytesToUint64(zeroIv));
             const uint64_t plainBlock = desCbc.decrypt(bytesToUint64(encryptedChallenge.data()));
             uint64ToBytes(plainBlock, rndB.data());
         }
         else if (usesThreeKey3DesSessionKey())
         {
-            if (options.key.size() != 24)
+            if (keyLength() != 24)
             {
                 rndB.clear();
                 return;
             }
 
             DES3CBC des3Cbc(
-                bytesToUint64(options.key.data()),
-                bytesToUint64(options.key.data() + 8),
-                bytesToUint64(options.key.data() + 16),
+                bytesToUint64(keyBytes()),
+                bytesToUint64(keyBytes() + 8),
+                bytesToUint64(keyBytes() + 16),
                 bytesToUint64(zeroIv));
 
             for (size_t offset = 0; offset < randomSize(); offset += 8)
@@ -691,7 +717,7 @@ void AuthenticateCommand::decryptChallenge()
         }
         else
         {
-            if (options.key.size() != 16)
+            if (keyLength() != 16)
             {
                 rndB.clear();
                 return;
@@ -700,7 +726,7 @@ void AuthenticateCommand::decryptChallenge()
             DesFireCrypto::des3CbcDecrypt(
                 encryptedChallenge.data(),
                 randomSize(),
-                options.key.data(),
+                keyBytes(),
                 zeroIv,
                 rndB.data());
         }
@@ -710,7 +736,7 @@ void AuthenticateCommand::decryptChallenge()
         // Legacy mode: Use ECB (single block)
         if (usesSingleDesSessionKey())
         {
-            if (options.key.size() < 8)
+            if (keyLength() < 8)
             {
                 rndB.clear();
                 return;
@@ -718,12 +744,12 @@ void AuthenticateCommand::decryptChallenge()
 
             DesFireCrypto::desDecrypt(
                 encryptedChallenge.data(),
-                options.key.data(),
+                keyBytes(),
                 rndB.data());
         }
         else
         {
-            if (options.key.size() != 16)
+            if (keyLength() != 16)
             {
                 rndB.clear();
                 return;
@@ -731,7 +757,7 @@ void AuthenticateCommand::decryptChallenge()
 
             DesFireCrypto::des3Decrypt(
                 encryptedChallenge.data(),
-                options.key.data(),
+                keyBytes(),
                 rndB.data());
         }
     }
@@ -744,17 +770,32 @@ bool AuthenticateCommand::usesSingleDesSessionKey() const
         return false;
     }
 
-    if (options.key.size() == 8)
+    if (keyLength() == 8)
     {
         return true;
     }
 
+    if (options.storedKey != nullptr)
+    {
+        return options.storedKey->singleDesKey;
+    }
+
     return isDegenerate16ByteDesKey(options.key);
 }
 
 bool AuthenticateCommand::usesThreeKey3DesSessionKey() const
 {
-    return options.mode == DesfireAuthMode::ISO && options.key.size() == 24;
+    return options.mode == DesfireAuthMode::ISO && keyLength() == 24;
+}
+
+const uint8_t* AuthenticateCommand::keyBytes() const
+{
+    return (options.storedKey != nullptr) ? options.storedKey->key.data() : options.key.data();
+}
+
+size_t AuthenticateCommand::keyLength() const
+{
+    return (options.storedKey != nullptr) ? options.storedKey->key.size() : options.key.size();
 }
 
 size_t AuthenticateCommand::randomSize() const
@@ -780,7 +821,7 @@ void AuthenticateCommand::encrypt(const etl::ivector<uint8_t>& plaintext, etl::v
 
     if (options.mode == DesfireAuthMode::AES)
     {
-        if (options.key.size() < 16 || currentIv.size() < 16)
+        if (keyLength() < 16 || currentIv.size() < 16)
         {
             ciphertext.clear();
             return;
@@ -792,7 +833,7 @@ void AuthenticateCommand::encrypt(const etl::ivector<uint8_t>& plaintext, etl::v
         }
 
         AES_ctx aesContext;
-        AES_init_ctx_iv(&aesContext, options.key.data(), currentIv.data());
+        initAesContext(aesContext, options, currentIv.data());
         AES_CBC_encrypt_buffer(&aesContext, ciphertext.data(), ciphertext.size());
         return;
     }
@@ -807,16 +848,16 @@ void AuthenticateCommand::encrypt(const etl::ivector<uint8_t>& plaintext, etl::v
 
         if (usesThreeKey3DesSessionKey())
         {
-            if (options.key.size() != 24)
+            if (keyLength() != 24)
             {
                 ciphertext.clear();
                 return;
             }
 
             DES3CBC des3Cbc(
-                bytesToUint64(options.key.data()),
-                bytesToUint64(options.key.data() + 8),
-                bytesToUint64(options.key.data() + 16),
+                bytesToUint64(keyBytes()),
+                bytesToUint64(keyBytes() + 8),
+                bytesToUint64(keyBytes() + 16),
                 bytesToUint64(currentIv.data()));
 
             for (size_t offset = 0; offset < plaintext.size(); offset += 8)
@@ -828,7 +869,7 @@ void AuthenticateCommand::encrypt(const etl::ivector<uint8_t>& plaintext, etl::v
             return;
         }
 
-        if (options.key.size() != 16)
+        if (keyLength() != 16)
         {
             ciphertext.clear();
             return;
@@ -837,7 +878,7 @@ void AuthenticateCommand::encrypt(const etl::ivector<uint8_t>& plaintext, etl::v
         DesFireCrypto::des3CbcEncrypt(
             plaintext.data(),
             plaintext.size(),
-            options.key.data(),
+            keyBytes(),
             currentIv.data(),
             ciphertext.data());
     }
@@ -847,13 +888,13 @@ void AuthenticateCommand::encrypt(const etl::ivector<uint8_t>& plaintext, etl::v
 
         if (usesSingleDesSessionKey())
         {
-            if (options.key.size() < 8)
+            if (keyLength() < 8)
             {
                 ciphertext.clear();
                 return;
             }
 
-            DESCBC desCbc(bytesToUint64(options.key.data()), bytesToUint64(zeroIv));
+            DESCBC desCbc(bytesToUint64(keyBytes()), bytesToUint64(zeroIv));
             for (size_t offset = 0; offset < plaintext.size(); offset += 8)
             {
                 const uint64_t block = bytesToUint64(plaintext.data() + offset);
@@ -863,7 +904,7 @@ void AuthenticateCommand::encrypt(const etl::ivector<uint8_t>& plaintext, etl::v
             return;
         }
 
-        if (options.key.size() != 16)
+        if (keyLength() != 16)
         {
             ciphertext.clear();
             return;
@@ -872,7 +913,7 @@ void AuthenticateCommand::encrypt(const etl::ivector<uint8_t>& plaintext, etl::v
         DesFireCrypto::des3CbcEncrypt(
             plaintext.data(),
             plaintext.size(),
-            options.key.data(),
+            keyBytes(),
             zeroIv,
             ciphertext.data());
     }
@@ -886,7 +927,7 @@ void AuthenticateCommand::decrypt(const etl::ivector<uint8_t>& ciphertext, etl::
 
     if (options.mode == DesfireAuthMode::AES)
     {
-        if (options.key.size() < 16 || currentIv.size() < 16)
+        if (keyLength() < 16 || currentIv.size() < 16)
         {
             plaintext.clear();
             return;
@@ -898,7 +939,7 @@ void AuthenticateCommand::decrypt(const etl::ivector<uint8_t>& ciphertext, etl::
         }
 
         AES_ctx aesContext;
-        AES_init_ctx_iv(&aesContext, options.key.data(), currentIv.data());
+        initAesContext(aesContext, options, currentIv.data());
         AES_CBC_decrypt_buffer(&aesContext, plaintext.data(), plaintext.size());
         return;
     }
@@ -913,16 +954,16 @@ void AuthenticateCommand::decrypt(const etl::ivector<uint8_t>& ciphertext, etl::
 
         if (usesThreeKey3DesSessionKey())
         {
-            if (options.key.size() != 24)
+            if (keyLength() != 24)
             {
                 plaintext.clear();
                 return;
             }
 
             DES3CBC des3Cbc(
-                bytesToUint64(options.key.data()),
-                bytesToUint64(options.key.data() + 8),
-                bytesToUint64(options.key.data() + 16),
+                bytesToUint64(keyBytes()),
+                bytesToUint64(keyBytes() + 8),
+                bytesToUint64(keyBytes() + 16),
                 bytesToUint64(currentIv.data()));
 
             for (size_t offset = 0; offset < ciphertext.size(); offset += 8)
@@ -933,7 +974,7 @@ void AuthenticateCommand::decrypt(const etl::ivector<uint8_t>& ciphertext, etl::
             return;
         }
 
-        if (options.key.size() != 16)
+        if (keyLength() != 16)
         {
             plaintext.clear();
             return;
@@ -942,7 +983,7 @@ void AuthenticateCommand::decrypt(const etl::ivector<uint8_t>& ciphertext, etl::
         DesFireCrypto::des3CbcDecrypt(
             ciphertext.data(),
             ciphertext.size(),
-            options.key.data(),
+            keyBytes(),
             currentIv.data(),
             plaintext.data());
     }
@@ -952,13 +993,13 @@ void AuthenticateCommand::decrypt(const etl::ivector<uint8_t>& ciphertext, etl::
 
         if (usesSingleDesSessionKey())
         {
-            if (options.key.size() < 8)
+            if (keyLength() < 8)
             {
                 plaintext.clear();
                 return;
             }
 
-            DESCBC desCbc(bytesToUint64(options.key.data()), bytesToUint64(zeroIv));
+            DESCBC desCbc(bytesToUint64(keyBytes()), bytesToUint64(zeroIv));
             for (size_t offset = 0; offset < ciphertext.size(); offset += 8)
             {
                 const uint64_t plainBlock = desCbc.decrypt(bytesToUint64(ciphertext.data() + offset));
@@ -967,7 +1008,7 @@ void AuthenticateCommand::decrypt(const etl::ivector<uint8_t>& ciphertext, etl::
             return;
         }
 
-        if (options.key.size() != 16)
+        if (keyLength() != 16)
         {
             plaintext.clear();
             return;
@@ -976,7 +1017,7 @@ void AuthenticateCommand::decrypt(const etl::ivector<uint8_t>& ciphertext, etl::
         DesFireCrypto::des3CbcDecrypt(
             ciphertext.data(),
             ciphertext.size(),
-            options.key.data(),
+            keyBytes(),
             zeroIv,
             plaintext.data());
     }
@@ -0,0 +1,250 @@
+/**
+ * @file AuthenticateEv2Command.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief DESFire AuthenticateEV2First / AuthenticateEV2NonFirst implementation
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Nfc/Desfire/Commands/AuthenticateEv2Command.h"
+#include "Nfc/Desfire/DesfireContext.h"
+#include "Nfc/Desfire/SecureMessagingPolicy.h"
+#include "Utils/DesfireCrypto.h"
+#include "Error/DesfireError.h"
+#include <aes.hpp>
+
+using namespace nfc;
+using namespace crypto;
+
+namespace
+{
+    constexpr uint8_t ADDITIONAL_FRAME = 0xAFU;
+    constexpr size_t RANDOM_SIZE = 16U;
+    constexpr size_t TI_SIZE = 4U;
+    constexpr size_t CAPABILITIES_SIZE = 6U;
+}
+
+AuthenticateEv2Command::AuthenticateEv2Command(const AuthenticateEv2CommandOptions& options)
+    : options(options)
+    , stage(Stage::Initial)
+    , rndA()
+    , rndB()
+    , encryptedResponse()
+    , piccCapabilities()
+{
+}
+
+etl::string_view AuthenticateEv2Command::name() const
+{
+    return options.nonFirst ? "AuthenticateEV2NonFirst" : "AuthenticateEV2First";
+}
+
+etl::expected<DesfireRequest, error::Error> AuthenticateEv2Command::buildRequest(const DesfireContext& context)
+{
+    DesfireRequest request;
+
+    switch (stage)
+    {
+        case Stage::Initial:
+            if (options.storedKey != nullptr && options.storedKey->type != DesfireKeyType::AES)
+            {
+                return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+            }
+            if (keyBytes().size() != 16U)
+            {
+                return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+            }
+            if (options.nonFirst && !SecureMessagingPolicy::isEv2Session(context))
+            {
+                return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidState));
+            }
+
+            request.commandCode = options.nonFirst ? NON_FIRST_COMMAND_CODE : FIRST_COMMAND_CODE;
+            request.data.push_back(options.keyNo);
+            if (!options.nonFirst)
+            {
+                request.data.push_back(0x00U); // LenCap: no PCD capabilities sent
+            }
+            request.expectedResponseLength = RANDOM_SIZE;
+            break;
+
+        case Stage::ChallengeSent:
+            request.commandCode = ADDITIONAL_FRAME;
+            request.data.assign(encryptedResponse.begin(), encryptedResponse.end());
+            request.expectedResponseLength = options.nonFirst ? RANDOM_SIZE : (2U * RANDOM_SIZE);
+            break;
+
+        default:
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidState));
+    }
+
+    return request;
+}
+
+etl::expected<DesfireResult, error::Error> AuthenticateEv2Command::parseResponse(
+    const etl::ivector<uint8_t>& response,
+    DesfireContext& context)
+{
+    if (response.empty())
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidResponse));
+    }
+
+    DesfireResult result;
+    result.statusCode = response[0];
+    if (!result.isSuccess() && !result.isAdditionalFrame())
+    {
+        return etl::unexpected(error::Error::fromDesfire(static_cast<error::DesfireError>(result.statusCode)));
+    }
+
+    const size_t dataLength = response.size() - 1U;
+    switch (stage)
+    {
+        case Stage::Initial:
+        {
+            // E(K, RndB), IV 0
+            if (!result.isAdditionalFrame() || dataLength != RANDOM_SIZE)
+            {
+                return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidResponse));
+            }
+            rndB.assign(response.begin() + 1, response.end());
+            crypt(rndB.data(), rndB.size(), false);
+
+            // E(K, RndA || RndB <<< 1), IV 0
+            generateRandom(rndA, RANDOM_SIZE);
+            etl::vector<uint8_t, 16> rotatedB(rndB.begin(), rndB.end());
+            rotateLeft(rotatedB, 1);
+            encryptedResponse.assign(rndA.begin(), rndA.end());
+            encryptedResponse.insert(encryptedResponse.end(), rotatedB.begin(), rotatedB.end());
+            crypt(encryptedResponse.data(), encryptedResponse.size(), true);
+
+            stage = Stage::ChallengeSent;
+            result.statusCode = ADDITIONAL_FRAME;
+            break;
+        }
+
+        case Stage::ChallengeSent:
+        {
+            // First: E(K, TI || RndA <<< 1 || PDcap2 || PCDcap2), NonFirst: E(K, RndA <<< 1)
+            const size_t expectedLength = options.nonFirst ? RANDOM_SIZE : (2U * RANDOM_SIZE);
+            if (!result.isSuccess() || dataLength != expectedLength)
+            {
+                return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidResponse));
+            }
+
+            etl::vector<uint8_t, 32> plain(response.begin() + 1, response.end());
+            crypt(plain.data(), plain.size(), false);
+
+            const size_t rndAOffset = options.nonFirst ? 0U : TI_SIZE;
+            etl::vector<uint8_t, 16> rotatedA(rndA.begin(), rndA.end());
+            rotateLeft(rotatedA, 1);
+            uint8_t difference = 0x00U;
+            for (size_t i = 0U; i < RANDOM_SIZE; ++i)
+            {
+                difference |= static_cast<uint8_t>(plain[rndAOffset + i] ^ rotatedA[i]);
+            }
+            if (difference != 0x00U)
+            {
+                return etl::unexpected(error::Error::fromDesfire(error::DesfireError::AuthenticationFailed));
+            }
+
+            auto keys = SecureMessagingPolicy::deriveEv2SessionKeys(keyBytes(), rndA, rndB, context);
+            if (!keys)
+            {
+                return etl::unexpected(keys.error());
+            }
+
+            if (!options.nonFirst)
+            {
+                context.transactionId.assign(plain.begin(), plain.begin() + TI_SIZE);
+                context.commandCounter = 0U;
+                const size_t capabilitiesOffset = TI_SIZE + RANDOM_SIZE;
+                piccCapabilities.assign(
+                    plain.begin() + capabilitiesOffset,
+                    plain.begin() + capabilitiesOffset + CAPABILITIES_SIZE);
+            }
+
+            context.iv.clear();
+            context.iv.resize(16U, 0x00U);
+            context.sessionEncRndB.clear();
+            context.authenticated = true;
+            context.keyNo = options.keyNo;
+            context.commMode = CommMode::Enciphered;
+            context.authScheme = SessionAuthScheme::Ev2;
+
+            stage = Stage::Complete;
+            result.statusCode = 0x00U;
+            break;
+        }
+
+        default:
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidState));
+    }
+
+    return result;
+}
+
+bool AuthenticateEv2Command::isComplete() const
+{
+    return stage == Stage::Complete;
+}
+
+void AuthenticateEv2Command::reset()
+{
+    stage = Stage::Initial;
+    rndA.clear();
+    rndB.clear();
+    encryptedResponse.clear();
+    piccCapabilities.clear();
+}
+
+bool AuthenticateEv2Command::isReplaySafe() const
+{
+    return true;
+}
+
+const etl::ivector<uint8_t>& AuthenticateEv2Command::getPiccCapabilities() const
+{
+    return piccCapabilities;
+}
+
+const etl::ivector<uint8_t>& AuthenticateEv2Command::keyBytes() const
+{
+    if (options.storedKey != nullptr)
+    {
+        return options.storedKey->key;
+    }
+    return options.key;
+}
+
+void AuthenticateEv2Command::crypt(uint8_t* data, size_t length, bool encrypt) const
+{
+    const uint8_t zeroIv[16] = {0};
+    AES_ctx aesContext;
+
+    // Stored keys carry the expanded schedule; skip key expansion for them.
+    if (options.storedKey != nullptr && options.storedKey->hasAesSchedule)
+    {
+        for (size_t i = 0U; i < DesfireStoredKey::AES_ROUND_KEY_SIZE; ++i)
+        {
+            aesContext.RoundKey[i] = options.storedKey->aesRoundKeys[i];
+        }
+        AES_ctx_set_iv(&aesContext, zeroIv);
+    }
+    else
+    {
+        AES_init_ctx_iv(&aesContext, keyBytes().data(), zeroIv);
+    }
+
+    if (encrypt)
+    {
+        AES_CBC_encrypt_buffer(&aesContext, data, length);
+    }
+    else
+    {
+        AES_CBC_decrypt_buffer(&aesContext, data, length);
+    }
+}
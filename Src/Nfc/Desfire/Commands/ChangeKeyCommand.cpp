@@ -55,6 +55,56 @@ ChangeKeyCommand::ChangeKeyCommand(const ChangeKeyCommandOptions& options)
     , sameKeyChange(false)
     , effectiveKeyNo(0x00)
 {
+    // Stored keys define their own type/version; key bytes stay in the store.
+    if (this->options.newStoredKey != nullptr)
+    {
+        this->options.newKeyType = this->options.newStoredKey->type;
+        this->options.newKeyVersion = this->options.newStoredKey->version;
+    }
+    if (this->options.oldStoredKey != nullptr)
+    {
+        this->options.oldKeyType = this->options.oldStoredKey->type;
+    }
+    if (this->options.precomputed != nullptr)
+    {
+        this->options.authMode = this->options.precomputed->authMode;
+        this->options.newKeyType = this->options.precomputed->newKeyType;
+        this->options.newKeyVersion = this->options.precomputed->newKeyVersion;
+    }
+}
+
+etl::expected<ChangeKeyPrecomputedCryptogram, error::Error> ChangeKeyCommand::precompute(
+    const ChangeKeyCommandOptions& options,
+    bool piccSelected,
+    uint8_t authenticatedKeyNo)
+{
+    if (options.precomputed != nullptr)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+    }
+
+    const ChangeKeyCommand command(options);
+    auto keyNoResult = command.resolveEffectiveKeyNo(piccSelected);
+    if (!keyNoResult)
+    {
+        return etl::unexpected(keyNoResult.error());
+    }
+
+    ChangeKeyPrecomputedCryptogram precomputed;
+    precomputed.effectiveKeyNo = keyNoResult.value();
+    precomputed.sameKey = (precomputed.effectiveKeyNo & 0x0F) == (authenticatedKeyNo & 0x0F);
+    precomputed.authMode = command.options.authMode;
+    precomputed.newKeyType = command.options.newKeyType;
+    precomputed.newKeyVersion = command.options.newKeyVersion;
+
+    auto plaintextResult = command.buildPlaintextCryptogram(precomputed.effectiveKeyNo, precomputed.sameKey);
+    if (!plaintextResult)
+    {
+        return etl::unexpected(plaintextResult.error());
+    }
+
+    precomputed.plaintext = plaintextResult.value();
+    return precomputed;
 }
 
 etl::string_view ChangeKeyCommand::name() const
@@ -157,6 +207,8 @@ etl::expected<DesfireResult, error::Error> ChangeKeyCommand::parseResponse(
         context.iv.clear();
         context.iv.resize(8, 0x00);
         context.sessionEncRndB.clear();
+        context.transactionId.clear();
+        context.commandCounter = 0;
     }
 
     stage = Stage::Complete;
@@ -179,30 +231,17 @@ void ChangeKeyCommand::reset()
 
 etl::expected<etl::vector<uint8_t, 48>, error::Error> ChangeKeyCommand::buildKeyCryptogram(const DesfireContext& context)
 {
-    effectiveKeyNo = options.keyNo;
-
     const bool piccSelected = context.selectedAid.size() == 3 &&
         context.selectedAid[0] == 0x00 &&
         context.selectedAid[1] == 0x00 &&
         context.selectedAid[2] == 0x00;
 
-    if (piccSelected && (effectiveKeyNo & 0x0F) != 0x00)
+    auto keyNoResult = resolveEffectiveKeyNo(piccSelected);
+    if (!keyNoResult)
     {
-        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
-    }
-
-    // PICC master key change uses key number flags to encode target key type.
-    if (piccSelected)
-    {
-        if (options.newKeyType == DesfireKeyType::DES3_3K)
-        {
-            effectiveKeyNo = static_cast<uint8_t>(effectiveKeyNo | 0x40);
-        }
-        else if (options.newKeyType == DesfireKeyType::AES)
-        {
-            effectiveKeyNo = static_cast<uint8_t>(effectiveKeyNo | 0x80);
-        }
+        return etl::unexpected(keyNoResult.error());
     }
+    effectiveKeyNo = keyNoResult.value();
 
     const SecureMessagingPolicy::SessionCipher sessionCipher = resolveSessionCipher(context);
     if (sessionCipher == SecureMessagingPolicy::SessionCipher::UNKNOWN)
@@ -240,7 +279,114 @@ etl::expected<etl::vector<uint8_t, 48>, error::Error> ChangeKeyCommand::buildKey
         }
     }
 
-    auto newKeyMaterialResult = normalizeKeyMaterial(options.newKey, options.newKeyType);
+    const bool sameKey = ((effectiveKeyNo & 0x0F) == (context.keyNo & 0x0F));
+    sameKeyChange = sameKey;
+
+    etl::vector<uint8_t, 33> plaintextCryptogram;
+    if (options.precomputed != nullptr)
+    {
+        // Precomputed CRCs cover the key number and same-key layout; both
+        // must match the live session.
+        if (options.precomputed->effectiveKeyNo != effectiveKeyNo ||
+            options.precomputed->sameKey != sameKey)
+        {
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+        }
+        plaintextCryptogram = options.precomputed->plaintext;
+    }
+    else
+    {
+        auto plaintextResult = buildPlaintextCryptogram(effectiveKeyNo, sameKey);
+        if (!plaintextResult)
+        {
+            return etl::unexpected(plaintextResult.error());
+        }
+        plaintextCryptogram = plaintextResult.value();
+    }
+
+    const size_t blockSize = (sessionCipher == SecureMessagingPolicy::SessionCipher::AES) ? 16U : 8U;
+
+    etl::vector<uint8_t, 48> paddedCryptogram;
+    for (size_t i = 0; i < plaintextCryptogram.size(); ++i)
+    {
+        paddedCryptogram.push_back(plaintextCryptogram[i]);
+    }
+    while ((paddedCryptogram.size() % blockSize) != 0U)
+    {
+        paddedCryptogram.push_back(0x00);
+    }
+
+    SecureMessagingPolicy::LegacySendIvSeedMode legacySeed = SecureMessagingPolicy::LegacySendIvSeedMode::Zero;
+    if (options.legacyIvMode == ChangeKeyLegacyIvMode::SessionEncryptedRndB)
+    {
+        legacySeed = SecureMessagingPolicy::LegacySendIvSeedMode::SessionEncryptedRndB;
+    }
+
+    auto protectionResult = SecureMessagingPolicy::protectEncryptedPayload(
+        context,
+        paddedCryptogram,
+        sessionCipher,
+        useLegacySendMode(sessionCipher),
+        legacySeed);
+    if (!protectionResult)
+    {
+        return etl::unexpected(protectionResult.error());
+    }
+
+    const auto& protection = protectionResult.value();
+    if (protection.encryptedPayload.size() > 48U)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
+    }
+
+    etl::vector<uint8_t, 48> encrypted;
+    for (size_t i = 0U; i < protection.encryptedPayload.size(); ++i)
+    {
+        encrypted.push_back(protection.encryptedPayload[i]);
+    }
+
+    pendingIv.clear();
+    for (size_t i = 0U; i < protection.requestState.size(); ++i)
+    {
+        pendingIv.push_back(protection.requestState[i]);
+    }
+    updateContextIv = protection.updateContextIv;
+
+    return encrypted;
+}
+
+etl::expected<uint8_t, error::Error> ChangeKeyCommand::resolveEffectiveKeyNo(bool piccSelected) const
+{
+    uint8_t keyNo = options.keyNo;
+
+    if (piccSelected && (keyNo & 0x0F) != 0x00)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+    }
+
+    // PICC master key change uses key number flags to encode target key type.
+    if (piccSelected)
+    {
+        if (options.newKeyType == DesfireKeyType::DES3_3K)
+        {
+            keyNo = static_cast<uint8_t>(keyNo | 0x40);
+        }
+        else if (options.newKeyType == DesfireKeyType::AES)
+        {
+            keyNo = static_cast<uint8_t>(keyNo | 0x80);
+        }
+    }
+
+    return keyNo;
+}
+
+etl::expected<etl::vector<uint8_t, 33>, error::Error> ChangeKeyCommand::buildPlaintextCryptogram(
+    uint8_t keyNo,
+    bool sameKey) const
+{
+    const etl::ivector<uint8_t>& newKeyData =
+        (options.newStoredKey != nullptr) ? options.newStoredKey->key : options.newKey;
+    auto newKeyMaterialResult = normalizeKeyMaterial(newKeyData, options.newKeyType);
     if (!newKeyMaterialResult)
     {
         return etl::unexpected(newKeyMaterialResult.error());
@@ -248,9 +394,6 @@ etl::expected<etl::vector<uint8_t, 48>, error::Error> ChangeKeyCommand::buildKey
 
     const etl::vector<uint8_t, 24>& newKeyMaterial = newKeyMaterialResult.value();
 
-    const bool sameKey = ((effectiveKeyNo & 0x0F) == (context.keyNo & 0x0F));
-    sameKeyChange = sameKey;
-
     etl::vector<uint8_t, 24> keyDataForCrypto;
     if (sameKey)
     {
@@ -261,7 +404,7 @@ etl::expected<etl::vector<uint8_t, 48>, error::Error> ChangeKeyCommand::buildKey
     }
     else
     {
-        if (!options.oldKey.has_value())
+        if (options.oldStoredKey == nullptr && !options.oldKey.has_value())
         {
             return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
         }
@@ -269,7 +412,9 @@ etl::expected<etl::vector<uint8_t, 48>, error::Error> ChangeKeyCommand::buildKey
         const DesfireKeyType oldKeyType = (options.oldKeyType == DesfireKeyType::UNKNOWN) ?
             options.newKeyType : options.oldKeyType;
 
-        auto oldKeyMaterialResult = normalizeKeyMaterial(options.oldKey.value(), oldKeyType);
+        const etl::ivector<uint8_t>& oldKeyData =
+            (options.oldStoredKey != nullptr) ? options.oldStoredKey->key : options.oldKey.value();
+        auto oldKeyMaterialResult = normalizeKeyMaterial(oldKeyData, oldKeyType);
         if (!oldKeyMaterialResult)
         {
             return etl::unexpected(oldKeyMaterialResult.error());
@@ -313,7 +458,7 @@ etl::expected<etl::vector<uint8_t, 48>, error::Error> ChangeKeyCommand::buildKey
     {
         etl::vector<uint8_t, 27> crcInput;
         crcInput.push_back(CHANGE_KEY_COMMAND_CODE);
-        crcInput.push_back(effectiveKeyNo);
+        crcInput.push_back(keyNo);
         for (size_t i = 0; i < keyStream.size(); ++i)
         {
             crcInput.push_back(keyStream[i]);
@@ -343,55 +488,7 @@ etl::expected<etl::vector<uint8_t, 48>, error::Error> ChangeKeyCommand::buildKey
         }
     }
 
-    const size_t blockSize = (sessionCipher == SecureMessagingPolicy::SessionCipher::AES) ? 16U : 8U;
-
-    etl::vector<uint8_t, 48> paddedCryptogram;
-    for (size_t i = 0; i < plaintextCryptogram.size(); ++i)
-    {
-        paddedCryptogram.push_back(plaintextCryptogram[i]);
-    }
-    while ((paddedCryptogram.size() % blockSize) != 0U)
-    {
-        paddedCryptogram.push_back(0x00);
-    }
-
-    SecureMessagingPolicy::LegacySendIvSeedMode legacySeed = SecureMessagingPolicy::LegacySendIvSeedMode::Zero;
-    if (options.legacyIvMode == ChangeKeyLegacyIvMode::SessionEncryptedRndB)
-    {
-        legacySeed = SecureMessagingPolicy::LegacySendIvSeedMode::SessionEncryptedRndB;
-    }
-
-    auto protectionResult = SecureMessagingPolicy::protectEncryptedPayload(
-        context,
-        paddedCryptogram,
-        sessionCipher,
-        useLegacySendMode(sessionCipher),
-        legacySeed);
-    if (!protectionResult)
-    {
-        return etl::unexpected(protectionResult.error());
-    }
-
-    const auto& protection = protectionResult.value();
-    if (protection.encryptedPayload.size() > 48U)
-    {
-        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
-    }
-
-    etl::vector<uint8_t, 48> encrypted;
-    for (size_t i = 0U; i < protection.encryptedPayload.size(); ++i)
-    {
-        encrypted.push_back(protection.encryptedPayload[i]);
-    }
-
-    pendingIv.clear();
-    for (size_t i = 0U; i < protection.requestState.size(); ++i)
-    {
-        pendingIv.push_back(protection.requestState[i]);
-    }
-    updateContextIv = protection.updateContextIv;
-
-    return encrypted;
+    return plaintextCryptogram;
 }
 
 size_t ChangeKeyCommand::getKeySize(DesfireKeyType keyType) const
@@ -180,6 +180,11 @@ void FreeMemoryCommand::reset()
     hasRequestIv = false;
 }
 
+bool FreeMemoryCommand::isReplaySafe() const
+{
+    return true;
+}
+
 uint32_t FreeMemoryCommand::getFreeMemoryBytes() const
 {
     return freeMemoryBytes;
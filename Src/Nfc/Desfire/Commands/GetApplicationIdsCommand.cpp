@@ -203,6 +203,11 @@ void GetApplicationIdsCommand::reset()
     hasRequestIv = false;
 }
 
+bool GetApplicationIdsCommand::isReplaySafe() const
+{
+    return true;
+}
+
 const etl::vector<etl::array<uint8_t, 3>, 84>& GetApplicationIdsCommand::getApplicationIds() const
 {
     return applicationIds;
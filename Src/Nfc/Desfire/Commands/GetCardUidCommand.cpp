@@ -118,6 +118,11 @@ void GetCardUidCommand::reset()
     uid.clear();
 }
 
+bool GetCardUidCommand::isReplaySafe() const
+{
+    return true;
+}
+
 const etl::vector<uint8_t, 10>& GetCardUidCommand::getUid() const
 {
     return uid;
@@ -177,13 +182,14 @@ bool GetCardUidCommand::tryDecodeEncryptedUid(
             continue;
         }
 
+        // UID + CRC + padding is at most two blocks; a longer response is not an encrypted UID
         const size_t candidateLen = payload.size() - trim;
-        if ((candidateLen % blockSize) != 0U)
+        etl::vector<uint8_t, 32> ciphertext;
+        if ((candidateLen % blockSize) != 0U || candidateLen > ciphertext.capacity())
         {
             continue;
         }
 
-        etl::vector<uint8_t, 32> ciphertext;
         for (size_t i = 0; i < candidateLen; ++i)
         {
             ciphertext.push_back(payload[i]);
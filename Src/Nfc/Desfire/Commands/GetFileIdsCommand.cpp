@@ -212,6 +212,11 @@ void GetFileIdsCommand::reset()
     hasRequestIv = false;
 }
 
+bool GetFileIdsCommand::isReplaySafe() const
+{
+    return true;
+}
+
 const etl::vector<uint8_t, 32>& GetFileIdsCommand::getFileIds() const
 {
     return fileIds;
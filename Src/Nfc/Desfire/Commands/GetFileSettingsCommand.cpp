@@ -264,6 +264,11 @@ void GetFileSettingsCommand::reset()
     hasRequestIv = false;
 }
 
+bool GetFileSettingsCommand::isReplaySafe() const
+{
+    return true;
+}
+
 uint8_t GetFileSettingsCommand::getFileNo() const
 {
     return fileNo;
@@ -117,6 +117,11 @@ void GetKeySettingsCommand::reset()
     rawPayload.clear();
 }
 
+bool GetKeySettingsCommand::isReplaySafe() const
+{
+    return true;
+}
+
 uint8_t GetKeySettingsCommand::getKeySettings1() const
 {
     return keySettings1;
@@ -109,6 +109,11 @@ void GetKeyVersionCommand::reset()
     rawPayload.clear();
 }
 
+bool GetKeyVersionCommand::isReplaySafe() const
+{
+    return true;
+}
+
 uint8_t GetKeyVersionCommand::getKeyVersion() const
 {
     return keyVersion;
@@ -209,6 +209,11 @@ void GetValueCommand::reset()
     hasRequestIv = false;
 }
 
+bool GetValueCommand::isReplaySafe() const
+{
+    return true;
+}
+
 int32_t GetValueCommand::getValue() const
 {
     return value;
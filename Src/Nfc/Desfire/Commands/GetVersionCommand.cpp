@@ -110,6 +110,11 @@ void GetVersionCommand::reset()
     versionData.clear();
 }
 
+bool GetVersionCommand::isReplaySafe() const
+{
+    return true;
+}
+
 const etl::vector<uint8_t, 96>& GetVersionCommand::getVersionData() const
 {
     return versionData;
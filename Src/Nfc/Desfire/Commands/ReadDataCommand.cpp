@@ -302,6 +302,11 @@ void ReadDataCommand::reset()
     resetProgress();
 }
 
+bool ReadDataCommand::isReplaySafe() const
+{
+    return true;
+}
+
 const etl::vector<uint8_t, ReadDataCommand::MAX_READ_DATA_SIZE>& ReadDataCommand::getData() const
 {
     return data;
@@ -253,6 +253,11 @@ void ReadRecordsCommand::reset()
     hasRequestIv = false;
 }
 
+bool ReadRecordsCommand::isReplaySafe() const
+{
+    return true;
+}
+
 const etl::ivector<uint8_t>& ReadRecordsCommand::getData() const
 {
     return data;
@@ -0,0 +1,176 @@
+/**
+ * @file ReadSigCommand.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief DESFire read originality signature command implementation
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Nfc/Desfire/Commands/ReadSigCommand.h"
+#include "Nfc/Desfire/SecureMessagingPolicy.h"
+#include "Nfc/Desfire/DesfireContext.h"
+#include "Error/DesfireError.h"
+#include <aes.hpp>
+
+using namespace nfc;
+
+namespace
+{
+    constexpr uint8_t READ_SIG_COMMAND_CODE = 0x3C;
+    constexpr uint8_t SIGNATURE_ADDRESS = 0x00;
+    constexpr size_t AES_BLOCK_SIZE = 16U;
+    constexpr size_t ENCRYPTED_LENGTH = 64U;   // signature + CRC32, padded
+}
+
+ReadSigCommand::ReadSigCommand()
+    : stage(Stage::Initial)
+    , signature()
+{
+}
+
+etl::string_view ReadSigCommand::name() const
+{
+    return "ReadSig";
+}
+
+etl::expected<DesfireRequest, error::Error> ReadSigCommand::buildRequest(const DesfireContext& context)
+{
+    (void)context;
+
+    if (stage != Stage::Initial)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidState));
+    }
+
+    DesfireRequest request;
+    request.commandCode = READ_SIG_COMMAND_CODE;
+    request.data.clear();
+    request.data.push_back(SIGNATURE_ADDRESS);
+    request.expectedResponseLength = 0;
+    return request;
+}
+
+etl::expected<DesfireResult, error::Error> ReadSigCommand::parseResponse(
+    const etl::ivector<uint8_t>& response,
+    DesfireContext& context)
+{
+    if (stage != Stage::Initial)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidState));
+    }
+
+    if (response.empty())
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidResponse));
+    }
+
+    DesfireResult result;
+    result.statusCode = response[0];
+    result.data.clear();
+
+    if (!result.isSuccess())
+    {
+        return etl::unexpected(error::Error::fromDesfire(static_cast<error::DesfireError>(result.statusCode)));
+    }
+
+    for (size_t i = 1; i < response.size(); ++i)
+    {
+        if (result.data.full())
+        {
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
+        }
+        result.data.push_back(response[i]);
+    }
+
+    signature.clear();
+
+    bool parsed = false;
+    if (context.authenticated &&
+        SecureMessagingPolicy::resolveSessionCipher(context) == SecureMessagingPolicy::SessionCipher::AES)
+    {
+        parsed = tryDecodeEncryptedSignature(result.data, context);
+    }
+
+    // Plain signature, possibly followed by a CMAC
+    if (!parsed)
+    {
+        if (result.data.size() < SIGNATURE_LENGTH)
+        {
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
+        }
+        signature.assign(result.data.begin(), result.data.begin() + SIGNATURE_LENGTH);
+    }
+
+    stage = Stage::Complete;
+    return result;
+}
+
+bool ReadSigCommand::isComplete() const
+{
+    return stage == Stage::Complete;
+}
+
+void ReadSigCommand::reset()
+{
+    stage = Stage::Initial;
+    signature.clear();
+}
+
+bool ReadSigCommand::isReplaySafe() const
+{
+    return true;
+}
+
+const etl::vector<uint8_t, ReadSigCommand::SIGNATURE_LENGTH>& ReadSigCommand::getSignature() const
+{
+    return signature;
+}
+
+bool ReadSigCommand::tryDecodeEncryptedSignature(const etl::ivector<uint8_t>& payload, DesfireContext& context)
+{
+    if (payload.size() != ENCRYPTED_LENGTH || context.sessionKeyEnc.size() < AES_BLOCK_SIZE)
+    {
+        return false;
+    }
+
+    etl::vector<uint8_t, ENCRYPTED_LENGTH> ciphertext(payload.begin(), payload.end());
+    etl::vector<uint8_t, ENCRYPTED_LENGTH> plaintext(payload.begin(), payload.end());
+
+    uint8_t iv[AES_BLOCK_SIZE] = {0};
+    if (context.iv.size() >= AES_BLOCK_SIZE)
+    {
+        for (size_t i = 0U; i < AES_BLOCK_SIZE; ++i)
+        {
+            iv[i] = context.iv[i];
+        }
+    }
+
+    AES_ctx aesContext;
+    AES_init_ctx_iv(&aesContext, context.sessionKeyEnc.data(), iv);
+    AES_CBC_decrypt_buffer(&aesContext, plaintext.data(), plaintext.size());
+
+    // CRC32 covers the signature followed by the status byte
+    etl::vector<uint8_t, SIGNATURE_LENGTH + 1U> crcData(plaintext.begin(), plaintext.begin() + SIGNATURE_LENGTH);
+    crcData.push_back(0x00);
+    const uint32_t expectedCrc = SecureMessagingPolicy::calculateCrc32Desfire(crcData);
+    const uint32_t receivedCrc =
+        static_cast<uint32_t>(plaintext[SIGNATURE_LENGTH]) |
+        (static_cast<uint32_t>(plaintext[SIGNATURE_LENGTH + 1U]) << 8U) |
+        (static_cast<uint32_t>(plaintext[SIGNATURE_LENGTH + 2U]) << 16U) |
+        (static_cast<uint32_t>(plaintext[SIGNATURE_LENGTH + 3U]) << 24U);
+    if (expectedCrc != receivedCrc)
+    {
+        return false;
+    }
+
+    if (!SecureMessagingPolicy::updateContextIvFromEncryptedCiphertext(context, ciphertext))
+    {
+        return false;
+    }
+
+    signature.assign(plaintext.begin(), plaintext.begin() + SIGNATURE_LENGTH);
+    return true;
+}
@@ -88,6 +88,8 @@ etl::expected<DesfireResult, error::Error> SelectApplicationCommand::parseRespon
         context.iv.clear();
         context.iv.resize(8, 0);
         context.sessionEncRndB.clear();
+        context.transactionId.clear();
+        context.commandCounter = 0;
     }
     
     complete = true;
@@ -105,3 +107,8 @@ void SelectApplicationCommand::reset()
     complete = false;
 }
 
+bool SelectApplicationCommand::isReplaySafe() const
+{
+    return true;
+}
+
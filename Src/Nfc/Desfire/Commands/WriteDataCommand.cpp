@@ -236,6 +236,11 @@ void WriteDataCommand::reset()
     resetProgress();
 }
 
+size_t WriteDataCommand::getWrittenLength() const
+{
+    return currentIndex;
+}
+
 void WriteDataCommand::appendLe24(etl::ivector<uint8_t>& target, uint32_t value)
 {
     target.push_back(static_cast<uint8_t>(value & 0xFFU));
@@ -269,6 +274,11 @@ bool WriteDataCommand::validateOptions() const
         return false;
     }
 
+    if (options.resumeIndex >= options.data->size())
+    {
+        return false;
+    }
+
     if (options.offset > 0x00FFFFFFU)
     {
         return false;
@@ -587,7 +597,7 @@ WriteDataCommand::encryptPayload(
 
 void WriteDataCommand::resetProgress()
 {
-    currentOffset = options.offset;
-    currentIndex = 0U;
+    currentOffset = options.offset + static_cast<uint32_t>(options.resumeIndex);
+    currentIndex = options.resumeIndex;
     lastChunkLength = 0U;
 }
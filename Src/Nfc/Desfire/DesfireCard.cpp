@@ -20,6 +20,8 @@
 #include "Nfc/Desfire/DesfireResult.h"
 #include "Nfc/Desfire/Commands/SelectApplicationCommand.h"
 #include "Nfc/Desfire/Commands/AuthenticateCommand.h"
+#include "Nfc/Desfire/Commands/AuthenticateEv2Command.h"
+#include "Nfc/Desfire/SecureMessagingPolicy.h"
 #include "Nfc/Desfire/Commands/GetVersionCommand.h"
 #include "Nfc/Desfire/Commands/FormatPiccCommand.h"
 #include "Nfc/Desfire/Commands/FreeMemoryCommand.h"
@@ -29,6 +31,7 @@
 #include "Nfc/Desfire/Commands/GetKeySettingsCommand.h"
 #include "Nfc/Desfire/Commands/GetKeyVersionCommand.h"
 #include "Nfc/Desfire/Commands/GetCardUidCommand.h"
+#include "Nfc/Desfire/Commands/ReadSigCommand.h"
 #include "Nfc/Desfire/Commands/ChangeKeySettingsCommand.h"
 #include "Nfc/Desfire/Commands/SetConfigurationCommand.h"
 #include "Nfc/Desfire/Commands/CreateApplicationCommand.h"
@@ -60,6 +63,9 @@ DesfireCard::DesfireCard(IApduTransceiver& transceiver, IWire& wireRef)
     : transceiver(transceiver)
     , context()
     , wire(&wireRef)
+    , retryPolicy(nullptr)
+    , sessionCredentials()
+    , pendingResponse()
     , plainPipe(nullptr)
     , macPipe(nullptr)
     , encPipe(nullptr)
@@ -74,6 +80,154 @@ const DesfireContext& DesfireCard::getContext() const
 }
 
 etl::expected<void, error::Error> DesfireCard::executeCommand(IDesfireCommand& command)
+{
+    // Session the command started in; recovery only rebuilds this one
+    const bool wasAuthenticated = context.authenticated;
+    const bool canRecover = sessionCredentials.valid &&
+                            sessionCredentials.keyNo == context.keyNo &&
+                            sessionCredentials.aid == context.selectedAid;
+
+    auto result = runCommand(command);
+    if (result || retryPolicy == nullptr || !command.isReplaySafe())
+    {
+        return result;
+    }
+
+    uint8_t restarts = 0U;
+    uint8_t recoveries = 0U;
+    while (!result)
+    {
+        const RetryAction action = RetryPolicy::classifyCardError(result.error(), wasAuthenticated);
+        if (action == RetryAction::Fail)
+        {
+            return result;
+        }
+
+        uint8_t& attempts = (action == RetryAction::RecoverSession) ? recoveries : restarts;
+        if (!retryPolicy->allows(action, attempts) ||
+            (action == RetryAction::RecoverSession && !canRecover))
+        {
+            retryPolicy->recordExhausted();
+            return result;
+        }
+
+        retryPolicy->recordAttempt(action);
+        ++attempts;
+
+        if (action == RetryAction::RecoverSession)
+        {
+            auto recoverResult = recoverSession();
+            if (!recoverResult)
+            {
+                retryPolicy->recordExhausted();
+                return recoverResult;
+            }
+        }
+
+        result = runCommand(command);
+    }
+
+    retryPolicy->recordRecovered();
+    return result;
+}
+
+void DesfireCard::setRetryPolicy(RetryPolicy* policy)
+{
+    retryPolicy = policy;
+}
+
+etl::expected<void, error::Error> DesfireCard::recoverSession()
+{
+    const DesfireStoredKey* storedKey = sessionCredentials.keyStore->find(sessionCredentials.keyHandle);
+    if (storedKey == nullptr)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::NoSuchKey));
+    }
+
+    if (sessionCredentials.aid.size() == 3U)
+    {
+        const etl::array<uint8_t, 3> aid = {
+            sessionCredentials.aid[0], sessionCredentials.aid[1], sessionCredentials.aid[2]
+        };
+        SelectApplicationCommand select(aid);
+        auto selectResult = runCommand(select);
+        if (!selectResult)
+        {
+            return selectResult;
+        }
+    }
+
+    AuthenticateCommandOptions options;
+    options.keyNo = sessionCredentials.keyNo;
+    options.storedKey = storedKey;
+    options.mode = sessionCredentials.mode;
+
+    AuthenticateCommand authenticate(options);
+    return runCommand(authenticate);
+}
+
+etl::expected<uint8_t, error::Error> DesfireCard::resolveDataCommunicationSettings(
+    uint8_t fileNo,
+    uint32_t offset,
+    uint32_t length,
+    uint8_t* fileType)
+{
+    uint8_t communicationSettings = context.authenticated ? 0x03U : 0x00U;
+    if (fileType != nullptr)
+    {
+        *fileType = 0xFFU;
+    }
+
+    auto settingsResult = getFileSettings(fileNo);
+    if (settingsResult)
+    {
+        const DesfireFileSettingsInfo& settings = settingsResult.value();
+        communicationSettings = settings.communicationSettings;
+        if (fileType != nullptr)
+        {
+            *fileType = settings.fileType;
+        }
+
+        if (settings.hasFileSize)
+        {
+            const uint64_t endExclusive = static_cast<uint64_t>(offset) + static_cast<uint64_t>(length);
+            if (endExclusive > static_cast<uint64_t>(settings.fileSize))
+            {
+                return etl::unexpected(error::Error::fromDesfire(error::DesfireError::BoundaryError));
+            }
+        }
+    }
+
+    return communicationSettings;
+}
+
+void DesfireCard::prepareTransferToken(
+    DesfireTransferToken& token,
+    uint8_t fileNo,
+    uint32_t offset,
+    uint32_t length) const
+{
+    const bool resumable = token.valid &&
+                           token.fileNo == fileNo &&
+                           token.offset == offset &&
+                           token.length == length &&
+                           token.completed < length &&
+                           token.aid == context.selectedAid;
+    if (resumable)
+    {
+        return;
+    }
+
+    token.valid = false;
+    token.fileNo = fileNo;
+    token.offset = offset;
+    token.length = length;
+    token.completed = 0U;
+    token.aid = context.selectedAid;
+    token.data.clear();
+}
+
+etl::expected<void, error::Error> DesfireCard::runCommand(IDesfireCommand& command)
 {
     // Reset command state
     command.reset();
@@ -109,7 +263,7 @@ etl::expected<void, error::Error> DesfireCard::executeCommand(IDesfireCommand& c
             return etl::unexpected(pduResult.error());
         }
         
-        etl::vector<uint8_t, 256>& unwrappedPdu = pduResult.value();
+        etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>& unwrappedPdu = pduResult.value();
         
         // 7. Parse response (updates command state)
         auto parseResult = command.parseResponse(unwrappedPdu, context);
@@ -148,6 +302,76 @@ etl::expected<void, error::Error> DesfireCard::authenticate(
     options.mode = mode;
     
     AuthenticateCommand command(options);
+    sessionCredentials.valid = false;
+    return executeCommand(command);
+}
+
+etl::expected<void, error::Error> DesfireCard::authenticate(
+    uint8_t keyNo,
+    const DesfireKeyStore& keyStore,
+    DesfireKeyHandle keyHandle,
+    DesfireAuthMode mode)
+{
+    const DesfireStoredKey* storedKey = keyStore.find(keyHandle);
+    if (storedKey == nullptr)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::NoSuchKey));
+    }
+
+    AuthenticateCommandOptions options;
+    options.keyNo = keyNo;
+    options.storedKey = storedKey;
+    options.mode = mode;
+
+    AuthenticateCommand command(options);
+    sessionCredentials.valid = false;
+    auto result = executeCommand(command);
+    if (result)
+    {
+        // Only the handle is kept; the key stays in the store
+        sessionCredentials.valid = true;
+        sessionCredentials.keyStore = &keyStore;
+        sessionCredentials.keyHandle = keyHandle;
+        sessionCredentials.mode = mode;
+        sessionCredentials.keyNo = keyNo;
+        sessionCredentials.aid = context.selectedAid;
+    }
+    return result;
+}
+
+etl::expected<void, error::Error> DesfireCard::authenticateEv2(
+    uint8_t keyNo,
+    const etl::vector<uint8_t, 16>& key)
+{
+    AuthenticateEv2CommandOptions options;
+    options.keyNo = keyNo;
+    options.key = key;
+    options.nonFirst = SecureMessagingPolicy::isEv2Session(context);
+
+    AuthenticateEv2Command command(options);
+    sessionCredentials.valid = false;
+    return executeCommand(command);
+}
+
+etl::expected<void, error::Error> DesfireCard::authenticateEv2(
+    uint8_t keyNo,
+    const DesfireKeyStore& keyStore,
+    DesfireKeyHandle keyHandle)
+{
+    const DesfireStoredKey* storedKey = keyStore.find(keyHandle);
+    if (storedKey == nullptr)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::NoSuchKey));
+    }
+
+    AuthenticateEv2CommandOptions options;
+    options.keyNo = keyNo;
+    options.storedKey = storedKey;
+    options.nonFirst = SecureMessagingPolicy::isEv2Session(context);
+
+    AuthenticateEv2Command command(options);
+    // Session recovery re-runs EV1 authentication; EV2 sessions are not rebuilt
+    sessionCredentials.valid = false;
     return executeCommand(command);
 }
 
@@ -391,22 +615,10 @@ etl::expected<etl::vector<uint8_t, DesfireCard::MAX_DATA_IO_SIZE>, error::Error>
     uint32_t length,
     uint16_t chunkSize)
 {
-    uint8_t communicationSettings = context.authenticated ? 0x03U : 0x00U;
-
-    auto settingsResult = getFileSettings(fileNo);
-    if (settingsResult)
+    auto settingsResult = resolveDataCommunicationSettings(fileNo, offset, length);
+    if (!settingsResult)
     {
-        const DesfireFileSettingsInfo& settings = settingsResult.value();
-        communicationSettings = settings.communicationSettings;
-
-        if (settings.hasFileSize)
-        {
-            const uint64_t endExclusive = static_cast<uint64_t>(offset) + static_cast<uint64_t>(length);
-            if (endExclusive > static_cast<uint64_t>(settings.fileSize))
-            {
-                return etl::unexpected(error::Error::fromDesfire(error::DesfireError::BoundaryError));
-            }
-        }
+        return etl::unexpected(settingsResult.error());
     }
 
     ReadDataCommandOptions options;
@@ -414,7 +626,7 @@ etl::expected<etl::vector<uint8_t, DesfireCard::MAX_DATA_IO_SIZE>, error::Error>
     options.offset = offset;
     options.length = length;
     options.chunkSize = chunkSize;
-    options.communicationSettings = communicationSettings;
+    options.communicationSettings = settingsResult.value();
 
     ReadDataCommand command(options);
     auto result = executeCommand(command);
@@ -444,22 +656,102 @@ etl::expected<void, error::Error> DesfireCard::writeData(
         return {};
     }
 
-    uint8_t communicationSettings = context.authenticated ? 0x03U : 0x00U;
+    auto settingsResult = resolveDataCommunicationSettings(fileNo, offset, static_cast<uint32_t>(data.size()));
+    if (!settingsResult)
+    {
+        return etl::unexpected(settingsResult.error());
+    }
 
-    auto settingsResult = getFileSettings(fileNo);
-    if (settingsResult)
+    WriteDataCommandOptions options;
+    options.fileNo = fileNo;
+    options.offset = offset;
+    options.data = &data;
+    options.chunkSize = chunkSize;
+    options.communicationSettings = settingsResult.value();
+
+    WriteDataCommand command(options);
+    return executeCommand(command);
+}
+
+etl::expected<etl::vector<uint8_t, DesfireCard::MAX_DATA_IO_SIZE>, error::Error> DesfireCard::readData(
+    uint8_t fileNo,
+    uint32_t offset,
+    uint32_t length,
+    uint16_t chunkSize,
+    DesfireTransferToken& token)
+{
+    if (length > MAX_DATA_IO_SIZE)
     {
-        const DesfireFileSettingsInfo& settings = settingsResult.value();
-        communicationSettings = settings.communicationSettings;
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+    }
 
-        if (settings.hasFileSize)
-        {
-            const uint64_t endExclusive = static_cast<uint64_t>(offset) + static_cast<uint64_t>(data.size());
-            if (endExclusive > static_cast<uint64_t>(settings.fileSize))
-            {
-                return etl::unexpected(error::Error::fromDesfire(error::DesfireError::BoundaryError));
-            }
-        }
+    prepareTransferToken(token, fileNo, offset, length);
+
+    auto settingsResult = resolveDataCommunicationSettings(fileNo, offset, length);
+    if (!settingsResult)
+    {
+        token.valid = (token.completed > 0U);
+        return etl::unexpected(settingsResult.error());
+    }
+
+    ReadDataCommandOptions options;
+    options.fileNo = fileNo;
+    options.offset = offset + token.completed;
+    options.length = length - token.completed;
+    options.chunkSize = chunkSize;
+    options.communicationSettings = settingsResult.value();
+
+    ReadDataCommand command(options);
+    auto result = executeCommand(command);
+
+    // Keep every verified chunk, also when a later one failed
+    const auto& commandData = command.getData();
+    for (size_t i = 0; i < commandData.size(); ++i)
+    {
+        token.data.push_back(commandData[i]);
+    }
+    token.completed += static_cast<uint32_t>(commandData.size());
+
+    if (!result)
+    {
+        token.valid = true;
+        return etl::unexpected(result.error());
+    }
+
+    etl::vector<uint8_t, MAX_DATA_IO_SIZE> out(token.data.begin(), token.data.end());
+    token.valid = false;
+    token.data.clear();
+    return out;
+}
+
+etl::expected<void, error::Error> DesfireCard::writeData(
+    uint8_t fileNo,
+    uint32_t offset,
+    const etl::ivector<uint8_t>& data,
+    uint16_t chunkSize,
+    DesfireTransferToken& token)
+{
+    if (data.empty())
+    {
+        return {};
+    }
+
+    const uint32_t length = static_cast<uint32_t>(data.size());
+    prepareTransferToken(token, fileNo, offset, length);
+
+    uint8_t fileType = 0xFFU;
+    auto settingsResult = resolveDataCommunicationSettings(fileNo, offset, length, &fileType);
+    if (!settingsResult)
+    {
+        token.valid = (token.completed > 0U);
+        return etl::unexpected(settingsResult.error());
+    }
+
+    // A backup file's acknowledged chunks went with the aborted transaction.
+    // Only a file known to be a standard data file keeps them.
+    if (fileType != static_cast<uint8_t>(GetFileSettingsCommand::FileType::StandardData))
+    {
+        token.completed = 0U;
     }
 
     WriteDataCommandOptions options;
@@ -467,10 +759,21 @@ etl::expected<void, error::Error> DesfireCard::writeData(
     options.offset = offset;
     options.data = &data;
     options.chunkSize = chunkSize;
-    options.communicationSettings = communicationSettings;
+    options.communicationSettings = settingsResult.value();
+    options.resumeIndex = token.completed;
 
     WriteDataCommand command(options);
-    return executeCommand(command);
+    auto result = executeCommand(command);
+    token.completed = static_cast<uint32_t>(command.getWrittenLength());
+
+    if (!result)
+    {
+        token.valid = true;
+        return result;
+    }
+
+    token.valid = false;
+    return {};
 }
 
 etl::expected<etl::vector<uint8_t, DesfireCard::MAX_DATA_IO_SIZE>, error::Error> DesfireCard::readRecords(
@@ -590,6 +893,339 @@ etl::expected<void, error::Error> DesfireCard::writeRecord(
     return executeCommand(command);
 }
 
+etl::expected<DesfireReadPlanMetrics, error::Error> DesfireCard::readFiles(
+    const DesfireReadPlan& plan,
+    DesfireReadResultSet& results)
+{
+    const size_t count = plan.entries.size();
+    if (count == 0U || count > DesfireReadPlan::MAX_ENTRIES)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+    }
+
+    DesfireReadPlanMetrics metrics;
+    etl::vector<DesfireFileReadResult, DesfireReadPlan::MAX_ENTRIES> planResults;
+    int8_t cachedFrom[DesfireReadPlan::MAX_ENTRIES];
+
+    // 1. Answer entries from results of an earlier call for this card and application
+    const bool reusable = !plan.cardUid.empty() &&
+                                 results.uid == plan.cardUid &&
+                                 results.aid == context.selectedAid;
+    for (size_t i = 0U; i < count; ++i)
+    {
+        const DesfireReadPlanEntry& entry = plan.entries[i];
+        DesfireFileReadResult result;
+        result.fileNo = entry.fileNo;
+        result.kind = entry.kind;
+        result.offset = entry.offset;
+        result.length = entry.length;
+        cachedFrom[i] = -1;
+
+        for (size_t j = 0U; reusable && entry.allowCached && j < results.results.size(); ++j)
+        {
+            const DesfireFileReadResult& previous = results.results[j];
+            if (previous.isOk() &&
+                previous.fileNo == entry.fileNo &&
+                previous.kind == entry.kind &&
+                previous.offset == entry.offset &&
+                previous.length == entry.length)
+            {
+                result = previous;
+                result.source = DesfireReadSource::Cache;
+                cachedFrom[i] = static_cast<int8_t>(j);
+                break;
+            }
+        }
+
+        planResults.push_back(result);
+    }
+
+    // 2. Compact the arena down to the reused bytes, in arena order so
+    //    every move goes towards the start
+    size_t compacted = 0U;
+    bool moved[DesfireReadPlan::MAX_ENTRIES] = {false};
+    for (;;)
+    {
+        int next = -1;
+        for (size_t i = 0U; i < count; ++i)
+        {
+            const int j = cachedFrom[i];
+            if (j >= 0 && !moved[j] && results.results[j].dataLength != 0U &&
+                (next < 0 || results.results[j].dataOffset < results.results[next].dataOffset))
+            {
+                next = j;
+            }
+        }
+        if (next < 0)
+        {
+            break;
+        }
+
+        const DesfireFileReadResult& previous = results.results[next];
+        for (size_t b = 0U; b < previous.dataLength; ++b)
+        {
+            results.arena[compacted + b] = results.arena[previous.dataOffset + b];
+        }
+        for (size_t i = 0U; i < count; ++i)
+        {
+            if (cachedFrom[i] == next)
+            {
+                planResults[i].dataOffset = compacted;
+            }
+        }
+        compacted += previous.dataLength;
+        moved[next] = true;
+    }
+    results.arena.resize(compacted);
+    results.uid = plan.cardUid;
+    results.aid = context.selectedAid;
+
+    // 3. Order the card reads so every read key is authenticated at most once:
+    //    the key the session holds, free access, then the other keys
+    uint8_t order[DesfireReadPlan::MAX_ENTRIES];
+    size_t ordered = 0U;
+    bool placed[DesfireReadPlan::MAX_ENTRIES] = {false};
+    for (size_t i = 0U; i < count; ++i)
+    {
+        placed[i] = cachedFrom[i] >= 0;
+    }
+    for (size_t i = 0U; context.authenticated && i < count; ++i)
+    {
+        const uint8_t keyNo = plan.entries[i].keyNo;
+        if (!placed[i] && keyNo != DesfireReadPlanEntry::FREE_ACCESS && keyNo == context.keyNo)
+        {
+            order[ordered++] = static_cast<uint8_t>(i);
+            placed[i] = true;
+        }
+    }
+    for (size_t i = 0U; i < count; ++i)
+    {
+        if (!placed[i] && plan.entries[i].keyNo == DesfireReadPlanEntry::FREE_ACCESS)
+        {
+            order[ordered++] = static_cast<uint8_t>(i);
+            placed[i] = true;
+        }
+    }
+    for (size_t i = 0U; i < count; ++i)
+    {
+        if (placed[i])
+        {
+            continue;
+        }
+
+        const uint8_t keyNo = plan.entries[i].keyNo;
+        for (size_t k = i; k < count; ++k)
+        {
+            if (!placed[k] && plan.entries[k].keyNo == keyNo)
+            {
+                order[ordered++] = static_cast<uint8_t>(k);
+                placed[k] = true;
+            }
+        }
+    }
+
+    // 4. Read from the card
+    bool sessionLost = false;
+    for (size_t n = 0U; n < ordered; ++n)
+    {
+        const DesfireReadPlanEntry& entry = plan.entries[order[n]];
+        DesfireFileReadResult& result = planResults[order[n]];
+
+        auto step = prepareForPlanEntry(plan, entry, sessionLost, metrics);
+        if (step)
+        {
+            step = readPlanEntry(entry, results, result, metrics);
+            // An error status ends the authentication on the card
+            sessionLost = !step.has_value();
+        }
+
+        result.source = step ? DesfireReadSource::Card : DesfireReadSource::None;
+        result.status = step;
+    }
+
+    for (size_t i = 0U; i < count; ++i)
+    {
+        if (planResults[i].isOk())
+        {
+            ++metrics.filesRead;
+            metrics.cacheHits += (planResults[i].source == DesfireReadSource::Cache) ? 1U : 0U;
+        }
+        else
+        {
+            ++metrics.filesFailed;
+        }
+    }
+
+    results.results = planResults;
+    return metrics;
+}
+
+etl::expected<void, error::Error> DesfireCard::prepareForPlanEntry(
+    const DesfireReadPlan& plan,
+    const DesfireReadPlanEntry& entry,
+    bool& sessionLost,
+    DesfireReadPlanMetrics& metrics)
+{
+    if (entry.keyNo == DesfireReadPlanEntry::FREE_ACCESS)
+    {
+        // The context still holds the dropped session; select again to clear it
+        if (sessionLost && context.authenticated)
+        {
+            if (context.selectedAid.size() != 3U)
+            {
+                return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidState));
+            }
+
+            const etl::array<uint8_t, 3> aid = {context.selectedAid[0], context.selectedAid[1], context.selectedAid[2]};
+            auto selected = selectApplication(aid);
+            if (!selected)
+            {
+                return selected;
+            }
+        }
+        sessionLost = false;
+        return {};
+    }
+
+    if (context.authenticated && !sessionLost && context.keyNo == entry.keyNo)
+    {
+        return {};
+    }
+
+    if (plan.keyStore == nullptr)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::AuthenticationError));
+    }
+
+    ++metrics.authentications;
+    auto authenticated = authenticate(entry.keyNo, *plan.keyStore, entry.keyHandle, entry.authMode);
+    sessionLost = !authenticated.has_value();
+    return authenticated;
+}
+
+etl::expected<void, error::Error> DesfireCard::readPlanEntry(
+    const DesfireReadPlanEntry& entry,
+    DesfireReadResultSet& results,
+    DesfireFileReadResult& result,
+    DesfireReadPlanMetrics& metrics)
+{
+    if (entry.kind == DesfireReadKind::Value)
+    {
+        GetValueCommand command(entry.fileNo);
+        ++metrics.cardReads;
+        auto executed = executeCommand(command);
+        if (!executed)
+        {
+            return executed;
+        }
+        result.value = command.getValue();
+        return {};
+    }
+
+    const bool isRecords = entry.kind == DesfireReadKind::Records;
+    uint8_t communicationSettings = entry.communicationSettings;
+    uint32_t length = entry.length;
+    uint32_t recordSize = entry.recordSize;
+
+    // Free access is always plain; otherwise only unknown settings cost a lookup
+    const bool freeAccess = entry.keyNo == DesfireReadPlanEntry::FREE_ACCESS;
+    const bool needsSettings =
+        (!freeAccess && communicationSettings == DesfireReadPlanEntry::COMM_SETTINGS_UNKNOWN) ||
+        length == 0U ||
+        (isRecords && recordSize == 0U);
+    if (needsSettings)
+    {
+        ++metrics.settingsLookups;
+        auto settingsResult = getFileSettings(entry.fileNo);
+        if (!settingsResult)
+        {
+            return etl::unexpected(settingsResult.error());
+        }
+
+        const DesfireFileSettingsInfo& settings = settingsResult.value();
+        if (communicationSettings == DesfireReadPlanEntry::COMM_SETTINGS_UNKNOWN)
+        {
+            communicationSettings = settings.communicationSettings;
+        }
+
+        if (isRecords)
+        {
+            if (!settings.hasRecordSettings || settings.recordSize == 0U)
+            {
+                return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+            }
+            recordSize = (recordSize == 0U) ? settings.recordSize : recordSize;
+            if (length == 0U)
+            {
+                if (entry.offset >= settings.currentRecords)
+                {
+                    return etl::unexpected(error::Error::fromDesfire(error::DesfireError::BoundaryError));
+                }
+                length = settings.currentRecords - entry.offset;
+            }
+        }
+        else if (length == 0U)
+        {
+            if (!settings.hasFileSize || entry.offset >= settings.fileSize)
+            {
+                return etl::unexpected(error::Error::fromDesfire(error::DesfireError::BoundaryError));
+            }
+            length = settings.fileSize - entry.offset;
+        }
+    }
+
+    // MAC-mode reads take the plain path, which checks the response CMAC
+    const uint8_t wireSettings = (!freeAccess && (communicationSettings & 0x03U) == 0x03U) ? 0x03U : 0x00U;
+
+    const uint64_t byteLength64 = isRecords
+        ? static_cast<uint64_t>(length) * static_cast<uint64_t>(recordSize)
+        : static_cast<uint64_t>(length);
+    if (byteLength64 == 0U || byteLength64 > MAX_DATA_IO_SIZE || byteLength64 > results.arena.available())
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
+    }
+
+    ++metrics.cardReads;
+    result.dataOffset = results.arena.size();
+    if (isRecords)
+    {
+        ReadRecordsCommandOptions options;
+        options.fileNo = entry.fileNo;
+        options.recordOffset = entry.offset;
+        options.recordCount = length;
+        options.recordSize = recordSize;
+        options.expectedDataLength = static_cast<uint32_t>(byteLength64);
+        options.communicationSettings = wireSettings;
+
+        ReadRecordsCommand command(options);
+        auto executed = executeCommand(command);
+        if (!executed)
+        {
+            return executed;
+        }
+        results.arena.insert(results.arena.end(), command.getData().begin(), command.getData().end());
+    }
+    else
+    {
+        ReadDataCommandOptions options;
+        options.fileNo = entry.fileNo;
+        options.offset = entry.offset;
+        options.length = length;
+        options.chunkSize = 0U;
+        options.communicationSettings = wireSettings;
+
+        ReadDataCommand command(options);
+        auto executed = executeCommand(command);
+        if (!executed)
+        {
+            return executed;
+        }
+        results.arena.insert(results.arena.end(), command.getData().begin(), command.getData().end());
+    }
+    result.dataLength = results.arena.size() - result.dataOffset;
+    return {};
+}
+
 etl::expected<etl::vector<uint8_t, 96>, error::Error> DesfireCard::getVersion()
 {
     GetVersionCommand command;
@@ -608,6 +1244,24 @@ etl::expected<etl::vector<uint8_t, 96>, error::Error> DesfireCard::getVersion()
     return payload;
 }
 
+etl::expected<CardGeneration, error::Error> DesfireCard::resolveGeneration(CardInfo& info)
+{
+    if (!info.generationAmbiguous)
+    {
+        return info.generation;
+    }
+
+    auto versionResult = getVersion();
+    if (!versionResult)
+    {
+        return etl::unexpected(versionResult.error());
+    }
+
+    info.generation = CardInfo::generationFromVersion(versionResult.value());
+    info.generationAmbiguous = false;
+    return info.generation;
+}
+
 etl::expected<void, error::Error> DesfireCard::formatPicc()
 {
     FormatPiccCommand command;
@@ -795,14 +1449,78 @@ etl::expected<etl::vector<uint8_t, 10>, error::Error> DesfireCard::getRealCardUi
     return uid;
 }
 
+etl::expected<etl::vector<uint8_t, 56>, error::Error> DesfireCard::readSignature()
+{
+    ReadSigCommand command;
+    auto result = executeCommand(command);
+    if (!result)
+    {
+        return etl::unexpected(result.error());
+    }
+
+    return command.getSignature();
+}
+
 etl::expected<etl::vector<uint8_t, 261>, error::Error> DesfireCard::wrapRequest(const DesfireRequest& request)
 {
-    // TODO: Implement request wrapping based on current communication mode
-    return etl::unexpected(error::Error::fromHardware(error::HardwareError::NotSupported));
+    auto wrapped = previewRequest(request, context);
+    if (!wrapped)
+    {
+        return etl::unexpected(wrapped.error());
+    }
+
+    context = wrapped.value().state;
+    pendingResponse = wrapped.value().expectation;
+    return etl::vector<uint8_t, 261>(wrapped.value().apdu.begin(), wrapped.value().apdu.end());
+}
+
+etl::expected<WrappedCommand, error::Error> DesfireCard::previewRequest(
+    const DesfireRequest& request,
+    const DesfireContext& state) const
+{
+    SecureCommand command;
+    command.commandCode = request.commandCode;
+    if (request.headerLength > request.data.size() ||
+        request.headerLength > command.header.max_size() ||
+        request.data.size() - request.headerLength > command.data.max_size())
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
+    }
+    command.header.assign(request.data.begin(), request.data.begin() + request.headerLength);
+    command.data.assign(request.data.begin() + request.headerLength, request.data.end());
+    command.commMode = state.commMode;
+    command.responseMode = request.responseMode;
+    command.expectedResponseLength = request.expectedResponseLength;
+
+    return SecureMessagingCodec::wrapCommand(state, command, *wire);
+}
+
+etl::expected<etl::vector<uint8_t, 261>, error::Error> DesfireCard::adoptRequest(
+    const WrappedCommand& wrapped,
+    const DesfireContext& origin)
+{
+    // The serialised image covers every field of the session state
+    if (SecureMessagingCodec::serializeState(context) != SecureMessagingCodec::serializeState(origin))
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidState));
+    }
+
+    context = wrapped.state;
+    pendingResponse = wrapped.expectation;
+    return etl::vector<uint8_t, 261>(wrapped.apdu.begin(), wrapped.apdu.end());
 }
 
 etl::expected<DesfireResult, error::Error> DesfireCard::unwrapResponse(const etl::ivector<uint8_t>& response)
 {
-    // TODO: Implement response unwrapping based on current communication mode
-    return etl::unexpected(error::Error::fromHardware(error::HardwareError::NotSupported));
+    auto unwrapped = SecureMessagingCodec::unwrapResponse(context, pendingResponse, response, *wire);
+    if (!unwrapped)
+    {
+        return etl::unexpected(unwrapped.error());
+    }
+
+    context = unwrapped.value().state;
+    DesfireResult result;
+    result.statusCode = unwrapped.value().statusCode;
+    result.data.assign(unwrapped.value().data.begin(), unwrapped.value().data.end());
+    return result;
 }
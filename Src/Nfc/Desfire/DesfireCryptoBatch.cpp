@@ -0,0 +1,504 @@
+/**
+ * @file DesfireCryptoBatch.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Multi-buffer crypto service implementation
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Nfc/Desfire/DesfireCryptoBatch.h"
+#include "Utils/DesfireCrypto.h"
+#include "Error/DesfireError.h"
+#include <cppdes/des3.h>
+#include <aes.hpp>
+#include <cstring>
+
+#if defined(NFCCPP_USE_AESNI)
+#include <wmmintrin.h>
+#include <emmintrin.h>
+#endif
+
+using namespace nfc;
+
+namespace
+{
+    constexpr size_t AES_BLOCK_SIZE = 16U;
+    constexpr size_t TDES_BLOCK_SIZE = 8U;
+    constexpr size_t AES_ROUNDS = 10U;
+    constexpr uint8_t AES_CMAC_RB = 0x87U;
+
+    bool isAesJob(DesfireCryptoJobKind kind)
+    {
+        return kind == DesfireCryptoJobKind::AesCbcEncrypt ||
+               kind == DesfireCryptoJobKind::AesCbcDecrypt ||
+               kind == DesfireCryptoJobKind::AesCmac;
+    }
+
+    /**
+     * @brief Per-job state while a group of AES jobs is running
+     */
+    struct AesLane
+    {
+        DesfireCryptoJob* job = nullptr;
+        AES_ctx schedule;
+        uint8_t chain[AES_BLOCK_SIZE];
+        uint8_t lastBlock[AES_BLOCK_SIZE];  // CMAC final block with K1/K2 applied
+        size_t blockCount = 0U;
+#if defined(NFCCPP_USE_AESNI)
+        __m128i roundKeys[AES_ROUNDS + 1U];
+#endif
+    };
+
+    void xorBlock16(const uint8_t* a, const uint8_t* b, uint8_t* out)
+    {
+        for (size_t i = 0U; i < AES_BLOCK_SIZE; ++i)
+        {
+            out[i] = static_cast<uint8_t>(a[i] ^ b[i]);
+        }
+    }
+
+    void leftShiftOneBit16(const uint8_t* input, uint8_t* output)
+    {
+        uint8_t overflow = 0U;
+        for (size_t i = AES_BLOCK_SIZE; i > 0U; --i)
+        {
+            output[i - 1U] = static_cast<uint8_t>((input[i - 1U] << 1U) | overflow);
+            overflow = static_cast<uint8_t>((input[i - 1U] & 0x80U) ? 1U : 0U);
+        }
+    }
+
+    void prepareLane(AesLane& lane, bool decrypt)
+    {
+        AES_init_ctx(&lane.schedule, lane.job->key);
+        std::memcpy(lane.chain, lane.job->iv, AES_BLOCK_SIZE);
+
+        lane.blockCount = lane.job->length / AES_BLOCK_SIZE;
+        if (lane.job->kind == DesfireCryptoJobKind::AesCmac)
+        {
+            lane.blockCount = (lane.job->length + AES_BLOCK_SIZE - 1U) / AES_BLOCK_SIZE;
+            if (lane.blockCount == 0U)
+            {
+                lane.blockCount = 1U;
+            }
+        }
+
+#if defined(NFCCPP_USE_AESNI)
+        // tiny-aes stores the expanded key in FIPS-197 byte order, which is
+        // exactly what AESENC expects. Decryption uses the equivalent inverse
+        // cipher, so rounds 1..9 need InvMixColumns applied to their keys.
+        const uint8_t* expanded = lane.schedule.RoundKey;
+        if (!decrypt)
+        {
+            for (size_t r = 0U; r <= AES_ROUNDS; ++r)
+            {
+                lane.roundKeys[r] = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(expanded + (r * AES_BLOCK_SIZE)));
+            }
+        }
+        else
+        {
+            lane.roundKeys[0] = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(expanded + (AES_ROUNDS * AES_BLOCK_SIZE)));
+            for (size_t r = 1U; r < AES_ROUNDS; ++r)
+            {
+                lane.roundKeys[r] = _mm_aesimc_si128(_mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(expanded + ((AES_ROUNDS - r) * AES_BLOCK_SIZE))));
+            }
+            lane.roundKeys[AES_ROUNDS] = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(expanded));
+        }
+#else
+        (void)decrypt;
+#endif
+    }
+
+    /**
+     * @brief Run one block through every active lane
+     *
+     * The AES-NI path issues each round for all lanes before moving to the
+     * next round, so the independent blocks fill the AES unit's pipeline.
+     */
+    void cipherStep(AesLane* const* lanes, size_t count, uint8_t (*blocks)[AES_BLOCK_SIZE], bool decrypt)
+    {
+#if defined(NFCCPP_USE_AESNI)
+        __m128i state[DesfireCryptoBatch::AES_LANES];
+        for (size_t l = 0U; l < count; ++l)
+        {
+            state[l] = _mm_xor_si128(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks[l])),
+                lanes[l]->roundKeys[0]);
+        }
+
+        for (size_t r = 1U; r < AES_ROUNDS; ++r)
+        {
+            for (size_t l = 0U; l < count; ++l)
+            {
+                state[l] = decrypt
+                    ? _mm_aesdec_si128(state[l], lanes[l]->roundKeys[r])
+                    : _mm_aesenc_si128(state[l], lanes[l]->roundKeys[r]);
+            }
+        }
+
+        for (size_t l = 0U; l < count; ++l)
+        {
+            state[l] = decrypt
+                ? _mm_aesdeclast_si128(state[l], lanes[l]->roundKeys[AES_ROUNDS])
+                : _mm_aesenclast_si128(state[l], lanes[l]->roundKeys[AES_ROUNDS]);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(blocks[l]), state[l]);
+        }
+#else
+        for (size_t l = 0U; l < count; ++l)
+        {
+            if (decrypt)
+            {
+                AES_ECB_decrypt(&lanes[l]->schedule, blocks[l]);
+            }
+            else
+            {
+                AES_ECB_encrypt(&lanes[l]->schedule, blocks[l]);
+            }
+        }
+#endif
+    }
+
+    /**
+     * @brief Derive the CMAC final block for every CMAC lane in the group
+     */
+    void prepareCmacLanes(AesLane* lanes, size_t count)
+    {
+        AesLane* active[DesfireCryptoBatch::AES_LANES];
+        uint8_t blocks[DesfireCryptoBatch::AES_LANES][AES_BLOCK_SIZE];
+        size_t activeCount = 0U;
+
+        for (size_t l = 0U; l < count; ++l)
+        {
+            if (lanes[l].job->kind == DesfireCryptoJobKind::AesCmac)
+            {
+                std::memset(blocks[activeCount], 0, AES_BLOCK_SIZE);
+                active[activeCount++] = &lanes[l];
+            }
+        }
+
+        if (activeCount == 0U)
+        {
+            return;
+        }
+
+        // L = E(K, 0^128), computed for all CMAC lanes in one step
+        cipherStep(active, activeCount, blocks, false);
+
+        for (size_t l = 0U; l < activeCount; ++l)
+        {
+            AesLane& lane = *active[l];
+            uint8_t k1[AES_BLOCK_SIZE];
+            uint8_t k2[AES_BLOCK_SIZE];
+
+            leftShiftOneBit16(blocks[l], k1);
+            if ((blocks[l][0] & 0x80U) != 0U)
+            {
+                k1[AES_BLOCK_SIZE - 1U] ^= AES_CMAC_RB;
+            }
+            leftShiftOneBit16(k1, k2);
+            if ((k1[0] & 0x80U) != 0U)
+            {
+                k2[AES_BLOCK_SIZE - 1U] ^= AES_CMAC_RB;
+            }
+
+            const size_t length = lane.job->length;
+            const size_t lastOffset = (lane.blockCount - 1U) * AES_BLOCK_SIZE;
+            const size_t lastLength = length - lastOffset;
+            if (length != 0U && lastLength == AES_BLOCK_SIZE)
+            {
+                xorBlock16(lane.job->data + lastOffset, k1, lane.lastBlock);
+            }
+            else
+            {
+                uint8_t padded[AES_BLOCK_SIZE] = {0};
+                if (lastLength != 0U)
+                {
+                    std::memcpy(padded, lane.job->data + lastOffset, lastLength);
+                }
+                padded[lastLength] = 0x80U;
+                xorBlock16(padded, k2, lane.lastBlock);
+            }
+
+            std::memset(k1, 0, sizeof(k1));
+            std::memset(k2, 0, sizeof(k2));
+        }
+    }
+
+    /**
+     * @brief Run a group of AES jobs sharing the same cipher direction
+     */
+    void runAesGroup(AesLane* lanes, size_t count, bool decrypt)
+    {
+        size_t maxBlocks = 0U;
+        for (size_t l = 0U; l < count; ++l)
+        {
+            prepareLane(lanes[l], decrypt);
+            if (lanes[l].blockCount > maxBlocks)
+            {
+                maxBlocks = lanes[l].blockCount;
+            }
+        }
+
+        if (!decrypt)
+        {
+            prepareCmacLanes(lanes, count);
+        }
+
+        AesLane* active[DesfireCryptoBatch::AES_LANES];
+        uint8_t blocks[DesfireCryptoBatch::AES_LANES][AES_BLOCK_SIZE];
+        uint8_t cipherIn[DesfireCryptoBatch::AES_LANES][AES_BLOCK_SIZE];
+
+        for (size_t blockIndex = 0U; blockIndex < maxBlocks; ++blockIndex)
+        {
+            size_t activeCount = 0U;
+            for (size_t l = 0U; l < count; ++l)
+            {
+                AesLane& lane = lanes[l];
+                if (blockIndex >= lane.blockCount)
+                {
+                    continue;
+                }
+
+                const DesfireCryptoJob& job = *lane.job;
+                const uint8_t* source = job.data + (blockIndex * AES_BLOCK_SIZE);
+                if (job.kind == DesfireCryptoJobKind::AesCmac && blockIndex + 1U == lane.blockCount)
+                {
+                    source = lane.lastBlock;
+                }
+
+                if (decrypt)
+                {
+                    std::memcpy(cipherIn[activeCount], source, AES_BLOCK_SIZE);
+                    std::memcpy(blocks[activeCount], source, AES_BLOCK_SIZE);
+                }
+                else
+                {
+                    xorBlock16(source, lane.chain, blocks[activeCount]);
+                }
+                active[activeCount++] = &lane;
+            }
+
+            cipherStep(active, activeCount, blocks, decrypt);
+
+            for (size_t l = 0U; l < activeCount; ++l)
+            {
+                AesLane& lane = *active[l];
+                DesfireCryptoJob& job = *lane.job;
+                uint8_t* target = job.data + (blockIndex * AES_BLOCK_SIZE);
+
+                if (decrypt)
+                {
+                    xorBlock16(blocks[l], lane.chain, target);
+                    std::memcpy(lane.chain, cipherIn[l], AES_BLOCK_SIZE);
+                }
+                else
+                {
+                    std::memcpy(lane.chain, blocks[l], AES_BLOCK_SIZE);
+                    if (job.kind != DesfireCryptoJobKind::AesCmac)
+                    {
+                        std::memcpy(target, blocks[l], AES_BLOCK_SIZE);
+                    }
+                }
+            }
+        }
+
+        for (size_t l = 0U; l < count; ++l)
+        {
+            DesfireCryptoJob& job = *lanes[l].job;
+            std::memcpy(job.iv, lanes[l].chain, AES_BLOCK_SIZE);
+            if (job.kind == DesfireCryptoJobKind::AesCmac)
+            {
+                std::memcpy(job.mac, lanes[l].chain, AES_BLOCK_SIZE);
+            }
+            std::memset(&lanes[l].schedule, 0, sizeof(lanes[l].schedule));
+        }
+    }
+
+    void runTdesJob(DesfireCryptoJob& job)
+    {
+        const uint64_t k1 = crypto::bytesToUint64(job.key);
+        const uint64_t k2 = crypto::bytesToUint64(job.key + 8U);
+        const uint64_t k3 = (job.keyLength == 24U) ? crypto::bytesToUint64(job.key + 16U) : k1;
+        DES3 des3(k1, k2, k3);
+
+        uint64_t chain = crypto::bytesToUint64(job.iv);
+        const bool decrypt = job.kind == DesfireCryptoJobKind::TdesCbcDecrypt;
+        for (size_t offset = 0U; offset < job.length; offset += TDES_BLOCK_SIZE)
+        {
+            const uint64_t input = crypto::bytesToUint64(job.data + offset);
+            if (decrypt)
+            {
+                crypto::uint64ToBytes(des3.decrypt(input) ^ chain, job.data + offset);
+                chain = input;
+            }
+            else
+            {
+                chain = des3.encrypt(input ^ chain);
+                crypto::uint64ToBytes(chain, job.data + offset);
+            }
+        }
+
+        crypto::uint64ToBytes(chain, job.iv);
+    }
+
+} // anonymous namespace
+
+etl::expected<size_t, error::Error> DesfireCryptoBatch::submit(const DesfireCryptoJob& job)
+{
+    if (!job.key || !job.iv || (job.length != 0U && !job.data))
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+    }
+
+    if (isAesJob(job.kind))
+    {
+        if (job.keyLength != 16U)
+        {
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+        }
+
+        if (job.kind == DesfireCryptoJobKind::AesCmac)
+        {
+            if (!job.mac)
+            {
+                return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+            }
+        }
+        else if ((job.length % AES_BLOCK_SIZE) != 0U)
+        {
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
+        }
+    }
+    else
+    {
+        if (job.keyLength != 16U && job.keyLength != 24U)
+        {
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+        }
+
+        if ((job.length % TDES_BLOCK_SIZE) != 0U)
+        {
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
+        }
+    }
+
+    // Jobs sharing a chaining value depend on each other and cannot run
+    // in parallel lanes.
+    for (const DesfireCryptoJob& queued : jobs)
+    {
+        if (queued.iv == job.iv)
+        {
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::DuplicateError));
+        }
+    }
+
+    if (jobs.full())
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::CountError));
+    }
+
+    jobs.push_back(job);
+    return jobs.size() - 1U;
+}
+
+etl::expected<size_t, error::Error> DesfireCryptoBatch::submit(
+    DesfireContext& context,
+    DesfireCryptoJobKind kind,
+    uint8_t* data,
+    size_t length,
+    uint8_t* mac)
+{
+    if (!context.authenticated)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::AuthenticationError));
+    }
+
+    const etl::ivector<uint8_t>& key =
+        (kind == DesfireCryptoJobKind::AesCmac && !context.sessionKeyMac.empty())
+            ? context.sessionKeyMac
+            : context.sessionKeyEnc;
+
+    const size_t ivLength = isAesJob(kind) ? AES_BLOCK_SIZE : TDES_BLOCK_SIZE;
+    if (context.iv.size() != ivLength)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidState));
+    }
+
+    DesfireCryptoJob job;
+    job.kind = kind;
+    job.key = key.data();
+    job.keyLength = isAesJob(kind) && key.size() > 16U ? 16U : key.size();
+    job.iv = context.iv.data();
+    job.data = data;
+    job.length = length;
+    job.mac = mac;
+    return submit(job);
+}
+
+size_t DesfireCryptoBatch::process()
+{
+    AesLane lanes[AES_LANES];
+
+    // Encrypt-direction jobs (CBC encrypt and CMAC) first, then decryption
+    for (size_t pass = 0U; pass < 2U; ++pass)
+    {
+        const bool decrypt = pass != 0U;
+        size_t laneCount = 0U;
+        for (DesfireCryptoJob& job : jobs)
+        {
+            if (!isAesJob(job.kind) || ((job.kind == DesfireCryptoJobKind::AesCbcDecrypt) != decrypt))
+            {
+                continue;
+            }
+
+            lanes[laneCount++].job = &job;
+            if (laneCount == AES_LANES)
+            {
+                runAesGroup(lanes, laneCount, decrypt);
+                laneCount = 0U;
+            }
+        }
+
+        if (laneCount != 0U)
+        {
+            runAesGroup(lanes, laneCount, decrypt);
+        }
+    }
+
+    for (DesfireCryptoJob& job : jobs)
+    {
+        if (!isAesJob(job.kind))
+        {
+            runTdesJob(job);
+        }
+    }
+
+    const size_t processed = jobs.size();
+    jobs.clear();
+    return processed;
+}
+
+void DesfireCryptoBatch::clear()
+{
+    jobs.clear();
+}
+
+size_t DesfireCryptoBatch::size() const
+{
+    return jobs.size();
+}
+
+bool DesfireCryptoBatch::hardwareAccelerated()
+{
+#if defined(NFCCPP_USE_AESNI)
+    return true;
+#else
+    return false;
+#endif
+}
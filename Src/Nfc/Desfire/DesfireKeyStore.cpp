@@ -0,0 +1,233 @@
+/**
+ * @file DesfireKeyStore.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief DESFire key store implementation
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include "Nfc/Desfire/DesfireKeyStore.h"
+#include "Utils/DesfireCrypto.h"
+#include "Error/DesfireError.h"
+#include <aes.hpp>
+
+using namespace nfc;
+using namespace crypto;
+
+namespace
+{
+    static_assert(sizeof(AES_ctx::RoundKey) == DesfireStoredKey::AES_ROUND_KEY_SIZE,
+                  "tiny-aes must be built for AES-128");
+
+    void secureZero(uint8_t* data, size_t length)
+    {
+        // Volatile writes so the compiler cannot drop the wipe of dead storage.
+        volatile uint8_t* p = data;
+        for (size_t i = 0U; i < length; ++i)
+        {
+            p[i] = 0U;
+        }
+    }
+
+    bool isValidKeyLength(DesfireKeyType type, size_t length)
+    {
+        switch (type)
+        {
+            case DesfireKeyType::DES:
+                return length == 8U || length == 16U;
+            case DesfireKeyType::DES3_2K:
+            case DesfireKeyType::AES:
+                return length == 16U;
+            case DesfireKeyType::DES3_3K:
+                return length == 24U;
+            default:
+                return false;
+        }
+    }
+
+    bool isSingleDesKey(const etl::ivector<uint8_t>& key)
+    {
+        if (key.size() == 8U)
+        {
+            return true;
+        }
+
+        if (key.size() != 16U)
+        {
+            return false;
+        }
+
+        // Ignore parity/version bit (LSB) when comparing K1 and K2.
+        for (size_t i = 0U; i < 8U; ++i)
+        {
+            if ((key[i] & 0xFEU) != (key[i + 8U] & 0xFEU))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    uint8_t slotIndexOf(uint16_t handleValue)
+    {
+        return static_cast<uint8_t>((handleValue & 0xFFU) - 1U);
+    }
+
+    uint8_t generationOf(uint16_t handleValue)
+    {
+        return static_cast<uint8_t>(handleValue >> 8U);
+    }
+}
+
+DesfireKeyStore::DesfireKeyStore()
+    : slots()
+{
+}
+
+DesfireKeyStore::~DesfireKeyStore()
+{
+    clear();
+}
+
+etl::expected<DesfireKeyHandle, error::Error> DesfireKeyStore::registerKey(
+    DesfireKeyType type,
+    const etl::ivector<uint8_t>& key,
+    uint8_t version)
+{
+    if (!isValidKeyLength(type, key.size()))
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+    }
+
+    if (type == DesfireKeyType::DES && key.size() == 16U && !isSingleDesKey(key))
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+    }
+
+    for (size_t index = 0U; index < slots.size(); ++index)
+    {
+        Slot& slot = slots[index];
+        if (slot.used)
+        {
+            continue;
+        }
+
+        DesfireStoredKey& entry = slot.entry;
+        entry.type = type;
+        entry.version = version;
+        entry.key.assign(key.begin(), key.end());
+
+        if (type == DesfireKeyType::AES)
+        {
+            AES_ctx aesContext;
+            AES_init_ctx(&aesContext, entry.key.data());
+            for (size_t i = 0U; i < DesfireStoredKey::AES_ROUND_KEY_SIZE; ++i)
+            {
+                entry.aesRoundKeys[i] = aesContext.RoundKey[i];
+            }
+            secureZero(reinterpret_cast<uint8_t*>(&aesContext), sizeof(aesContext));
+            entry.hasAesSchedule = true;
+            entry.singleDesKey = false;
+        }
+        else
+        {
+            // DES/3DES keys carry version/parity metadata in bit 0 of each byte.
+            DesFireCrypto::clearParityBits(entry.key.data(), entry.key.size());
+            entry.hasAesSchedule = false;
+            entry.singleDesKey = isSingleDesKey(entry.key);
+        }
+
+        slot.used = true;
+        const uint16_t value = static_cast<uint16_t>((static_cast<uint16_t>(slot.generation) << 8U) | (index + 1U));
+        return DesfireKeyHandle(value);
+    }
+
+    return etl::unexpected(error::Error::fromDesfire(error::DesfireError::CountError));
+}
+
+etl::expected<void, error::Error> DesfireKeyStore::release(DesfireKeyHandle handle)
+{
+    if (find(handle) == nullptr)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::NoSuchKey));
+    }
+
+    Slot& slot = slots[slotIndexOf(handle.value)];
+    zeroise(slot);
+
+    // Invalidate outstanding handles to this slot; generation 0 is never issued.
+    slot.generation = static_cast<uint8_t>(slot.generation + 1U);
+    if (slot.generation == 0U)
+    {
+        slot.generation = 1U;
+    }
+
+    return {};
+}
+
+void DesfireKeyStore::clear()
+{
+    for (size_t index = 0U; index < slots.size(); ++index)
+    {
+        if (slots[index].used)
+        {
+            (void)release(DesfireKeyHandle(static_cast<uint16_t>(
+                (static_cast<uint16_t>(slots[index].generation) << 8U) | (index + 1U))));
+        }
+    }
+}
+
+const DesfireStoredKey* DesfireKeyStore::find(DesfireKeyHandle handle) const
+{
+    if (!handle.isValid())
+    {
+        return nullptr;
+    }
+
+    const uint8_t index = slotIndexOf(handle.value);
+    if (index >= slots.size())
+    {
+        return nullptr;
+    }
+
+    const Slot& slot = slots[index];
+    if (!slot.used || slot.generation != generationOf(handle.value))
+    {
+        return nullptr;
+    }
+
+    return &slot.entry;
+}
+
+size_t DesfireKeyStore::size() const
+{
+    size_t count = 0U;
+    for (size_t index = 0U; index < slots.size(); ++index)
+    {
+        if (slots[index].used)
+        {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void DesfireKeyStore::zeroise(Slot& slot)
+{
+    DesfireStoredKey& entry = slot.entry;
+    if (!entry.key.empty())
+    {
+        secureZero(entry.key.data(), entry.key.size());
+    }
+    entry.key.clear();
+    secureZero(entry.aesRoundKeys.data(), entry.aesRoundKeys.size());
+    entry.hasAesSchedule = false;
+    entry.singleDesKey = false;
+    entry.version = 0U;
+    entry.type = DesfireKeyType::UNKNOWN;
+    slot.used = false;
+}
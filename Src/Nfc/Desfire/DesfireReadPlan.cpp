@@ -0,0 +1,49 @@
+/**
+ * @file DesfireReadPlan.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Multi-file read plan and arena-backed result set
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Nfc/Desfire/DesfireReadPlan.h"
+
+using namespace nfc;
+
+DesfireReadResultSet::DesfireReadResultSet()
+    : results()
+    , arena()
+    , uid()
+    , aid()
+{
+}
+
+size_t DesfireReadResultSet::size() const
+{
+    return results.size();
+}
+
+const DesfireFileReadResult& DesfireReadResultSet::operator[](size_t index) const
+{
+    return results[index];
+}
+
+const uint8_t* DesfireReadResultSet::data(size_t index) const
+{
+    if (index >= results.size() || results[index].dataLength == 0U)
+    {
+        return nullptr;
+    }
+    return arena.data() + results[index].dataOffset;
+}
+
+void DesfireReadResultSet::clear()
+{
+    results.clear();
+    arena.clear();
+    uid.clear();
+    aid.clear();
+}
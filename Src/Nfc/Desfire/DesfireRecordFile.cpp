@@ -0,0 +1,75 @@
+/**
+ * @file DesfireRecordFile.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Record file helper implementation
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Nfc/Desfire/DesfireRecordFile.h"
+#include "Nfc/Desfire/DesfireCard.h"
+
+using namespace nfc;
+
+DesfireRecordFile::DesfireRecordFile(DesfireCard& card, uint8_t fileNo)
+    : card(card)
+    , fileNo(fileNo)
+    , pending(0U)
+    , journal()
+{
+}
+
+etl::expected<void, error::Error> DesfireRecordFile::writeRecord(
+    uint32_t offset,
+    const etl::ivector<uint8_t>& data,
+    uint16_t chunkSize)
+{
+    auto result = card.writeRecord(fileNo, offset, data, chunkSize);
+    if (!result || data.empty())
+    {
+        return result;
+    }
+
+    pending += static_cast<uint32_t>(data.size());
+    journal.record(TransactionJournalType::WriteRecord, card.getContext().selectedAid, fileNo,
+                   static_cast<int32_t>(data.size()), static_cast<int32_t>(offset));
+    return {};
+}
+
+etl::expected<void, error::Error> DesfireRecordFile::commit()
+{
+    const uint32_t written = pending;
+    pending = 0U;
+
+    auto result = card.commitTransaction();
+    if (!result)
+    {
+        return result;
+    }
+    journal.record(TransactionJournalType::Commit, card.getContext().selectedAid, fileNo,
+                   static_cast<int32_t>(written), 0);
+    return {};
+}
+
+uint32_t DesfireRecordFile::pendingBytes() const
+{
+    return pending;
+}
+
+void DesfireRecordFile::setJournal(TransactionJournal* recordJournal, const etl::ivector<uint8_t>& uid)
+{
+    journal.attach(recordJournal, uid);
+}
+
+uint32_t DesfireRecordFile::journalFailures() const
+{
+    return journal.failures();
+}
+
+const etl::optional<error::Error>& DesfireRecordFile::lastJournalError() const
+{
+    return journal.lastError();
+}
@@ -0,0 +1,266 @@
+/**
+ * @file DesfireSequenceLearner.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Learned command sequences and speculative request protection
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Nfc/Desfire/DesfireSequenceLearner.h"
+#include <algorithm>
+
+using namespace nfc;
+
+DesfireSequenceLearner::DesfireSequenceLearner(DesfireCard& card, const DesfireSequenceOptions& options)
+    : card(card)
+    , options(options)
+    , metrics()
+    , steps()
+    , transitions()
+    , profile(0U)
+    , lastStep(START_STEP)
+    , inFlight(false)
+    , speculated(false)
+    , speculatedStep(NO_STEP)
+    , speculatedOrigin()
+    , speculatedRequest()
+{
+}
+
+void DesfireSequenceLearner::beginSequence(uint32_t sequenceProfile)
+{
+    profile = sequenceProfile;
+    lastStep = START_STEP;
+    inFlight = false;
+    dropSpeculation();
+}
+
+etl::expected<etl::vector<uint8_t, 261>, error::Error> DesfireSequenceLearner::prepare(const DesfireRequest& request)
+{
+    const uint8_t step = findOrAddStep(request);
+
+    etl::vector<uint8_t, 261> apdu;
+    bool adopted = false;
+    if (speculated)
+    {
+        if (step != NO_STEP && step == speculatedStep)
+        {
+            auto prepared = card.adoptRequest(speculatedRequest, speculatedOrigin);
+            if (prepared)
+            {
+                apdu = prepared.value();
+                adopted = true;
+                ++metrics.hits;
+            }
+            else
+            {
+                ++metrics.stale;
+            }
+        }
+        else
+        {
+            ++metrics.misses;
+        }
+        dropSpeculation();
+    }
+
+    if (!adopted)
+    {
+        auto wrapped = card.wrapRequest(request);
+        if (!wrapped)
+        {
+            return etl::unexpected(wrapped.error());
+        }
+        apdu = wrapped.value();
+    }
+
+    if (lastStep != NO_STEP && step != NO_STEP)
+    {
+        recordTransition(lastStep, step);
+    }
+    lastStep = step;
+    inFlight = true;
+    return apdu;
+}
+
+void DesfireSequenceLearner::speculate()
+{
+    if (speculated || lastStep == NO_STEP)
+    {
+        return;
+    }
+
+    const uint8_t next = predict(lastStep);
+    if (next == NO_STEP)
+    {
+        return;
+    }
+
+    // Session state once the request in flight has succeeded
+    DesfireContext origin = card.getContext();
+    if (inFlight && origin.authenticated)
+    {
+        if (origin.authScheme != SessionAuthScheme::Ev2)
+        {
+            ++metrics.unpredictable;
+            return;
+        }
+        origin.commandCounter = static_cast<uint16_t>(origin.commandCounter + 1U);
+    }
+
+    const Step& candidate = steps[next];
+    DesfireRequest request;
+    request.commandCode = candidate.commandCode;
+    request.data.assign(candidate.data.begin(), candidate.data.end());
+    request.expectedResponseLength = candidate.expectedResponseLength;
+    request.headerLength = candidate.headerLength;
+    request.responseMode = candidate.responseMode;
+
+    auto wrapped = card.previewRequest(request, origin);
+    if (!wrapped)
+    {
+        return;
+    }
+
+    speculatedRequest = wrapped.value();
+    speculatedOrigin = origin;
+    speculatedStep = next;
+    speculated = true;
+    ++metrics.predictions;
+}
+
+etl::expected<DesfireResult, error::Error> DesfireSequenceLearner::complete(const etl::ivector<uint8_t>& response)
+{
+    inFlight = false;
+    auto result = card.unwrapResponse(response);
+    if (!result || !result.value().isSuccess())
+    {
+        // The prepared request assumed success; adoptRequest() would refuse it
+        dropSpeculation();
+    }
+    return result;
+}
+
+void DesfireSequenceLearner::forget()
+{
+    steps.clear();
+    transitions.clear();
+    metrics = DesfireSequenceMetrics();
+    lastStep = START_STEP;
+    dropSpeculation();
+}
+
+const DesfireSequenceMetrics& DesfireSequenceLearner::getMetrics() const
+{
+    return metrics;
+}
+
+uint8_t DesfireSequenceLearner::findOrAddStep(const DesfireRequest& request)
+{
+    if (request.data.size() > MAX_STEP_DATA)
+    {
+        return NO_STEP;
+    }
+
+    for (size_t i = 0U; i < steps.size(); ++i)
+    {
+        const Step& step = steps[i];
+        if (step.profile == profile &&
+            step.commandCode == request.commandCode &&
+            step.expectedResponseLength == request.expectedResponseLength &&
+            step.headerLength == request.headerLength &&
+            step.responseMode == request.responseMode &&
+            step.data.size() == request.data.size() &&
+            std::equal(step.data.begin(), step.data.end(), request.data.begin()))
+        {
+            return static_cast<uint8_t>(i);
+        }
+    }
+
+    if (steps.full())
+    {
+        return NO_STEP;
+    }
+
+    Step step;
+    step.profile = profile;
+    step.commandCode = request.commandCode;
+    step.expectedResponseLength = request.expectedResponseLength;
+    step.headerLength = request.headerLength;
+    step.responseMode = request.responseMode;
+    step.data.assign(request.data.begin(), request.data.end());
+    steps.push_back(step);
+    return static_cast<uint8_t>(steps.size() - 1U);
+}
+
+void DesfireSequenceLearner::recordTransition(uint8_t from, uint8_t to)
+{
+    for (auto& transition : transitions)
+    {
+        if (transition.profile != profile || transition.from != from || transition.to != to)
+        {
+            continue;
+        }
+
+        if (transition.count == 0xFFFFU)
+        {
+            // Halve the step's counts; the shares stay the same
+            for (auto& sibling : transitions)
+            {
+                if (sibling.profile == profile && sibling.from == from)
+                {
+                    sibling.count = static_cast<uint16_t>(sibling.count / 2U);
+                }
+            }
+        }
+        ++transition.count;
+        return;
+    }
+
+    if (!transitions.full())
+    {
+        Transition transition;
+        transition.profile = profile;
+        transition.from = from;
+        transition.to = to;
+        transition.count = 1U;
+        transitions.push_back(transition);
+    }
+}
+
+uint8_t DesfireSequenceLearner::predict(uint8_t from) const
+{
+    uint32_t total = 0U;
+    const Transition* best = nullptr;
+    for (const auto& transition : transitions)
+    {
+        if (transition.profile != profile || transition.from != from)
+        {
+            continue;
+        }
+        total += transition.count;
+        if (best == nullptr || transition.count > best->count)
+        {
+            best = &transition;
+        }
+    }
+
+    if (best == nullptr || best->count < options.minObservations)
+    {
+        return NO_STEP;
+    }
+    if (static_cast<uint32_t>(best->count) * 100U < total * options.minConfidencePercent)
+    {
+        return NO_STEP;
+    }
+    return best->to;
+}
+
+void DesfireSequenceLearner::dropSpeculation()
+{
+    speculated = false;
+    speculatedStep = NO_STEP;
+}
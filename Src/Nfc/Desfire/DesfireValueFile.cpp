@@ -0,0 +1,254 @@
+/**
+ * @file DesfireValueFile.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Value file helper implementation
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Nfc/Desfire/DesfireValueFile.h"
+#include "Nfc/Desfire/DesfireCard.h"
+
+using namespace nfc;
+
+DesfireValueFile::DesfireValueFile(DesfireCard& card, uint8_t fileNo)
+    : card(card)
+    , fileNo(fileNo)
+    , cached(false)
+    , committedValue(0)
+    , pending(0)
+    , sessionAuthenticated(false)
+    , sessionKeyNo(0U)
+    , sessionAid()
+    , valueMetrics()
+    , journal()
+{
+}
+
+etl::expected<int32_t, error::Error> DesfireValueFile::balance()
+{
+    if (isCached())
+    {
+        ++valueMetrics.cacheHits;
+        return committedValue;
+    }
+
+    return refresh();
+}
+
+etl::expected<int32_t, error::Error> DesfireValueFile::refresh()
+{
+    invalidate();
+    auto result = readFromCard();
+    if (!result)
+    {
+        return result;
+    }
+
+    committedValue = result.value();
+    cached = true;
+    bindSession();
+    return committedValue;
+}
+
+etl::expected<void, error::Error> DesfireValueFile::credit(int32_t value)
+{
+    if (!sessionMatches())
+    {
+        invalidate();
+    }
+
+    auto result = card.credit(fileNo, value);
+    if (!result)
+    {
+        invalidate();
+        return result;
+    }
+
+    pending += value;
+    journalOperation(TransactionJournalType::Credit, value);
+    return {};
+}
+
+etl::expected<void, error::Error> DesfireValueFile::debit(int32_t value)
+{
+    if (!sessionMatches())
+    {
+        invalidate();
+    }
+
+    auto result = card.debit(fileNo, value);
+    if (!result)
+    {
+        invalidate();
+        return result;
+    }
+
+    pending -= value;
+    journalOperation(TransactionJournalType::Debit, -value);
+    return {};
+}
+
+etl::expected<void, error::Error> DesfireValueFile::limitedCredit(int32_t value)
+{
+    if (!sessionMatches())
+    {
+        invalidate();
+    }
+
+    auto result = card.limitedCredit(fileNo, value);
+    if (!result)
+    {
+        invalidate();
+        return result;
+    }
+
+    pending += value;
+    journalOperation(TransactionJournalType::LimitedCredit, value);
+    return {};
+}
+
+etl::expected<DesfireValueCommitResult, error::Error> DesfireValueFile::commit()
+{
+    const bool hadCache = isCached();
+    const int32_t before = committedValue;
+    const int32_t predicted = committedValue + pending;
+
+    DesfireValueCommitResult outcome;
+    auto commitResult = card.commitTransaction();
+    if (commitResult && hadCache)
+    {
+        committedValue = predicted;
+        pending = 0;
+        outcome.balance = predicted;
+        outcome.committed = true;
+        journalOutcome(outcome, predicted - before);
+        return outcome;
+    }
+
+    // Either the commit outcome is unknown or there was nothing to predict
+    // from: ask the card.
+    const int32_t delta = pending;
+    invalidate();
+    auto readResult = readFromCard();
+    if (!readResult)
+    {
+        return etl::unexpected(commitResult ? readResult.error() : commitResult.error());
+    }
+
+    committedValue = readResult.value();
+    cached = true;
+    bindSession();
+
+    outcome.balance = committedValue;
+    outcome.verified = true;
+    if (commitResult)
+    {
+        outcome.committed = true;
+        journalOutcome(outcome, delta);
+        return outcome;
+    }
+
+    ++valueMetrics.reconciliations;
+    if (!hadCache || delta == 0)
+    {
+        // No reference to compare against
+        return etl::unexpected(commitResult.error());
+    }
+
+    if (committedValue == predicted)
+    {
+        // Commit reached the card, only its answer was lost
+        outcome.committed = true;
+        journalOutcome(outcome, delta);
+        return outcome;
+    }
+
+    if (committedValue == before)
+    {
+        outcome.committed = false;
+        journalOutcome(outcome, delta);
+        return outcome;
+    }
+
+    // Balance matches neither state; someone else touched the file
+    return etl::unexpected(commitResult.error());
+}
+
+bool DesfireValueFile::isCached() const
+{
+    return cached && sessionMatches();
+}
+
+int32_t DesfireValueFile::pendingDelta() const
+{
+    return pending;
+}
+
+void DesfireValueFile::invalidate()
+{
+    cached = false;
+    pending = 0;
+}
+
+void DesfireValueFile::setJournal(TransactionJournal* valueJournal, const etl::ivector<uint8_t>& uid)
+{
+    journal.attach(valueJournal, uid);
+}
+
+uint32_t DesfireValueFile::journalFailures() const
+{
+    return journal.failures();
+}
+
+const etl::optional<error::Error>& DesfireValueFile::lastJournalError() const
+{
+    return journal.lastError();
+}
+
+const DesfireValueFileMetrics& DesfireValueFile::metrics() const
+{
+    return valueMetrics;
+}
+
+bool DesfireValueFile::sessionMatches() const
+{
+    const DesfireContext& context = card.getContext();
+    return context.authenticated == sessionAuthenticated &&
+           context.keyNo == sessionKeyNo &&
+           context.selectedAid == sessionAid;
+}
+
+void DesfireValueFile::bindSession()
+{
+    const DesfireContext& context = card.getContext();
+    sessionAuthenticated = context.authenticated;
+    sessionKeyNo = context.keyNo;
+    sessionAid = context.selectedAid;
+}
+
+etl::expected<int32_t, error::Error> DesfireValueFile::readFromCard()
+{
+    ++valueMetrics.cardReads;
+    return card.getValue(fileNo);
+}
+
+void DesfireValueFile::journalOperation(TransactionJournalType type, int32_t delta)
+{
+    // The new balance is only known when the operation started from a cached one
+    journal.record(type, card.getContext().selectedAid, fileNo, delta,
+                   cached ? (committedValue + pending) : 0,
+                   cached ? static_cast<uint8_t>(TRANSACTION_JOURNAL_VALUE_KNOWN) : 0U);
+}
+
+void DesfireValueFile::journalOutcome(DesfireValueCommitResult& outcome, int32_t delta)
+{
+    const uint8_t flags = static_cast<uint8_t>(TRANSACTION_JOURNAL_VALUE_KNOWN |
+                                               (outcome.verified ? static_cast<uint8_t>(TRANSACTION_JOURNAL_VERIFIED) : 0U));
+    const TransactionJournalType type = outcome.committed ? TransactionJournalType::Commit
+                                                          : TransactionJournalType::Abort;
+    outcome.journaled = journal.record(type, card.getContext().selectedAid, fileNo, delta, outcome.balance, flags);
+}
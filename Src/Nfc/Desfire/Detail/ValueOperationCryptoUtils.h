@@ -33,6 +33,12 @@ namespace nfc
 
         inline SessionCipher resolveSessionCipher(const DesfireContext& context)
         {
+            // EV2 sessions have no chaining IV; see SecureMessagingPolicy::protectEv2Command
+            if (context.authScheme == SessionAuthScheme::Ev2)
+            {
+                return SessionCipher::UNKNOWN;
+            }
+
             if (context.iv.size() == 16U && context.sessionKeyEnc.size() >= 16U)
             {
                 return SessionCipher::AES;
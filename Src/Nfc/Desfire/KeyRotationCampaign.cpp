@@ -0,0 +1,312 @@
+/**
+ * @file KeyRotationCampaign.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Key rotation campaign image implementation
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Nfc/Desfire/KeyRotationCampaign.h"
+#include "Error/DesfireError.h"
+#include "Utils/Serialization.h"
+#include <cstring>
+
+using namespace nfc;
+
+namespace
+{
+    using Format = KeyRotationCampaignFormat;
+
+    // Header offsets
+    constexpr size_t HDR_VERSION = 4U;
+    constexpr size_t HDR_RECORD_SIZE = 5U;
+    constexpr size_t HDR_AID = 6U;
+    constexpr size_t HDR_KEY_NO = 9U;
+    constexpr size_t HDR_AUTH_KEY_NO = 10U;
+    constexpr size_t HDR_AUTH_MODE = 11U;
+    constexpr size_t HDR_SESSION_KEY_TYPE = 12U;
+    constexpr size_t HDR_NEW_KEY_TYPE = 13U;
+    constexpr size_t HDR_NEW_KEY_VERSION = 14U;
+    constexpr size_t HDR_COUNT = 16U;
+    constexpr size_t HDR_RECORDS_CRC = 20U;
+    constexpr size_t HDR_CRC = 24U;
+
+    // Record offsets
+    constexpr size_t REC_UID_LENGTH = 0U;
+    constexpr size_t REC_UID = 1U;
+    constexpr size_t REC_FLAGS = 11U;
+    constexpr size_t REC_KEY_NO = 12U;
+    constexpr size_t REC_PLAIN_LENGTH = 13U;
+    constexpr size_t REC_PLAIN = 14U;
+    constexpr size_t REC_CRC = 48U;
+
+    constexpr uint8_t FLAG_SAME_KEY = 0x01U;
+    constexpr size_t MAX_PLAINTEXT = 33U;
+
+    static_assert(REC_PLAIN + MAX_PLAINTEXT < REC_CRC, "record layout overlaps CRC");
+    static_assert(REC_CRC + 4U == Format::RECORD_SIZE, "record layout must fill RECORD_SIZE");
+    static_assert(HDR_CRC + 4U == Format::HEADER_SIZE, "header layout must fill HEADER_SIZE");
+
+    /**
+     * @brief CRC over the contents of all records
+     *
+     * Leaves out the per-record CRC fields: a CRC run over data followed by
+     * its own CRC always ends in the same residue.
+     */
+    uint32_t recordsCrc(const uint8_t* records, size_t count)
+    {
+        uint32_t crc = 0U;
+        for (size_t i = 0U; i < count; ++i)
+        {
+            crc = utils::crc32(records + (i * Format::RECORD_SIZE), REC_CRC, crc);
+        }
+        return crc;
+    }
+
+    /**
+     * @brief Order records by UID length, then UID bytes
+     */
+    int compareUid(const uint8_t* record, const etl::ivector<uint8_t>& uid)
+    {
+        const size_t recordLength = record[REC_UID_LENGTH];
+        if (recordLength != uid.size())
+        {
+            return (recordLength < uid.size()) ? -1 : 1;
+        }
+        return std::memcmp(record + REC_UID, uid.data(), recordLength);
+    }
+
+    /**
+     * @brief Index of the first record not ordered before @p uid
+     */
+    size_t lowerBound(const uint8_t* records, size_t count, const etl::ivector<uint8_t>& uid)
+    {
+        size_t low = 0U;
+        size_t high = count;
+        while (low < high)
+        {
+            const size_t mid = low + ((high - low) / 2U);
+            if (compareUid(records + (mid * Format::RECORD_SIZE), uid) < 0)
+            {
+                low = mid + 1U;
+            }
+            else
+            {
+                high = mid;
+            }
+        }
+        return low;
+    }
+}
+
+KeyRotationCampaignWriter::KeyRotationCampaignWriter(
+    uint8_t* buffer,
+    size_t capacity,
+    const KeyRotationCampaignSettings& settings)
+    : buffer(buffer)
+    , capacity(capacity)
+    , settings(settings)
+    , count(0U)
+{
+}
+
+etl::expected<void, error::Error> KeyRotationCampaignWriter::addCard(
+    const etl::ivector<uint8_t>& uid,
+    const etl::ivector<uint8_t>& newKey,
+    const etl::ivector<uint8_t>& oldKey)
+{
+    if (buffer == nullptr || uid.empty() || uid.size() > Format::MAX_UID_LENGTH ||
+        newKey.size() > 24U || oldKey.size() > 24U)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+    }
+
+    if (Format::imageSize(count + 1U) > capacity)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::CountError));
+    }
+
+    uint8_t* records = buffer + Format::HEADER_SIZE;
+    const size_t position = lowerBound(records, count, uid);
+    if (position < count && compareUid(records + (position * Format::RECORD_SIZE), uid) == 0)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::DuplicateError));
+    }
+
+    ChangeKeyCommandOptions options;
+    options.keyNo = settings.keyNo;
+    options.authMode = settings.authMode;
+    options.sessionKeyType = settings.sessionKeyType;
+    options.newKeyType = settings.newKeyType;
+    options.newKeyVersion = settings.newKeyVersion;
+    options.newKey.assign(newKey.begin(), newKey.end());
+    if (!oldKey.empty())
+    {
+        etl::vector<uint8_t, 24> old;
+        old.assign(oldKey.begin(), oldKey.end());
+        options.oldKey = old;
+    }
+
+    const bool piccSelected = settings.aid[0] == 0x00U && settings.aid[1] == 0x00U && settings.aid[2] == 0x00U;
+    auto precomputedResult = ChangeKeyCommand::precompute(options, piccSelected, settings.authKeyNo);
+    if (!precomputedResult)
+    {
+        return etl::unexpected(precomputedResult.error());
+    }
+    const ChangeKeyPrecomputedCryptogram& precomputed = precomputedResult.value();
+
+    uint8_t* record = records + (position * Format::RECORD_SIZE);
+    std::memmove(record + Format::RECORD_SIZE, record, (count - position) * Format::RECORD_SIZE);
+    std::memset(record, 0, Format::RECORD_SIZE);
+
+    record[REC_UID_LENGTH] = static_cast<uint8_t>(uid.size());
+    std::memcpy(record + REC_UID, uid.data(), uid.size());
+    record[REC_FLAGS] = precomputed.sameKey ? FLAG_SAME_KEY : 0x00U;
+    record[REC_KEY_NO] = precomputed.effectiveKeyNo;
+    record[REC_PLAIN_LENGTH] = static_cast<uint8_t>(precomputed.plaintext.size());
+    std::memcpy(record + REC_PLAIN, precomputed.plaintext.data(), precomputed.plaintext.size());
+    utils::writeLe32(record + REC_CRC, utils::crc32(record, REC_CRC));
+
+    ++count;
+    return {};
+}
+
+etl::expected<size_t, error::Error> KeyRotationCampaignWriter::finish()
+{
+    if (buffer == nullptr || capacity < Format::HEADER_SIZE)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+    }
+
+    std::memset(buffer, 0, Format::HEADER_SIZE);
+    std::memcpy(buffer, Format::MAGIC, sizeof(Format::MAGIC));
+    buffer[HDR_VERSION] = Format::VERSION;
+    buffer[HDR_RECORD_SIZE] = static_cast<uint8_t>(Format::RECORD_SIZE);
+    std::memcpy(buffer + HDR_AID, settings.aid.data(), settings.aid.size());
+    buffer[HDR_KEY_NO] = settings.keyNo;
+    buffer[HDR_AUTH_KEY_NO] = settings.authKeyNo;
+    buffer[HDR_AUTH_MODE] = static_cast<uint8_t>(settings.authMode);
+    buffer[HDR_SESSION_KEY_TYPE] = static_cast<uint8_t>(settings.sessionKeyType);
+    buffer[HDR_NEW_KEY_TYPE] = static_cast<uint8_t>(settings.newKeyType);
+    buffer[HDR_NEW_KEY_VERSION] = settings.newKeyVersion;
+    utils::writeLe32(buffer + HDR_COUNT, static_cast<uint32_t>(count));
+    utils::writeLe32(buffer + HDR_RECORDS_CRC, recordsCrc(buffer + Format::HEADER_SIZE, count));
+    utils::writeLe32(buffer + HDR_CRC, utils::crc32(buffer, HDR_CRC));
+
+    return Format::imageSize(count);
+}
+
+size_t KeyRotationCampaignWriter::recordCount() const
+{
+    return count;
+}
+
+etl::expected<void, error::Error> KeyRotationCampaignView::open(const uint8_t* data, size_t size)
+{
+    image = nullptr;
+    count = 0U;
+
+    if (data == nullptr || size < Format::HEADER_SIZE)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
+    }
+
+    if (std::memcmp(data, Format::MAGIC, sizeof(Format::MAGIC)) != 0 ||
+        data[HDR_VERSION] != Format::VERSION ||
+        data[HDR_RECORD_SIZE] != Format::RECORD_SIZE ||
+        utils::readLe32(data + HDR_CRC) != utils::crc32(data, HDR_CRC))
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::IntegrityError));
+    }
+
+    const size_t recordCount = utils::readLe32(data + HDR_COUNT);
+    if (size < Format::imageSize(recordCount))
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
+    }
+
+    // The campaign ID only covers the records if they still match the header
+    if (utils::readLe32(data + HDR_RECORDS_CRC) != recordsCrc(data + Format::HEADER_SIZE, recordCount))
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::IntegrityError));
+    }
+
+    campaignSettings.aid = {data[HDR_AID], data[HDR_AID + 1U], data[HDR_AID + 2U]};
+    campaignSettings.keyNo = data[HDR_KEY_NO];
+    campaignSettings.authKeyNo = data[HDR_AUTH_KEY_NO];
+    campaignSettings.authMode = static_cast<DesfireAuthMode>(data[HDR_AUTH_MODE]);
+    campaignSettings.sessionKeyType = static_cast<DesfireKeyType>(data[HDR_SESSION_KEY_TYPE]);
+    campaignSettings.newKeyType = static_cast<DesfireKeyType>(data[HDR_NEW_KEY_TYPE]);
+    campaignSettings.newKeyVersion = data[HDR_NEW_KEY_VERSION];
+
+    image = data;
+    count = recordCount;
+    id = utils::readLe32(data + HDR_CRC);
+    return {};
+}
+
+const KeyRotationCampaignSettings& KeyRotationCampaignView::settings() const
+{
+    return campaignSettings;
+}
+
+uint32_t KeyRotationCampaignView::campaignId() const
+{
+    return id;
+}
+
+size_t KeyRotationCampaignView::recordCount() const
+{
+    return count;
+}
+
+etl::optional<size_t> KeyRotationCampaignView::find(const etl::ivector<uint8_t>& uid) const
+{
+    if (image == nullptr)
+    {
+        return etl::nullopt;
+    }
+
+    const uint8_t* records = image + Format::HEADER_SIZE;
+    const size_t position = lowerBound(records, count, uid);
+    if (position < count && compareUid(records + (position * Format::RECORD_SIZE), uid) == 0)
+    {
+        return position;
+    }
+    return etl::nullopt;
+}
+
+bool KeyRotationCampaignView::matches(size_t index, const etl::ivector<uint8_t>& uid) const
+{
+    if (image == nullptr || index >= count)
+    {
+        return false;
+    }
+    return compareUid(image + Format::HEADER_SIZE + (index * Format::RECORD_SIZE), uid) == 0;
+}
+
+etl::expected<ChangeKeyPrecomputedCryptogram, error::Error> KeyRotationCampaignView::cryptogram(size_t index) const
+{
+    if (image == nullptr || index >= count)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+    }
+
+    const uint8_t* record = image + Format::HEADER_SIZE + (index * Format::RECORD_SIZE);
+    if (utils::readLe32(record + REC_CRC) != utils::crc32(record, REC_CRC) || record[REC_PLAIN_LENGTH] > MAX_PLAINTEXT)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::IntegrityError));
+    }
+
+    ChangeKeyPrecomputedCryptogram precomputed;
+    precomputed.effectiveKeyNo = record[REC_KEY_NO];
+    precomputed.sameKey = (record[REC_FLAGS] & FLAG_SAME_KEY) != 0U;
+    precomputed.authMode = campaignSettings.authMode;
+    precomputed.newKeyType = campaignSettings.newKeyType;
+    precomputed.newKeyVersion = campaignSettings.newKeyVersion;
+    precomputed.plaintext.assign(record + REC_PLAIN, record + REC_PLAIN + record[REC_PLAIN_LENGTH]);
+    return precomputed;
+}
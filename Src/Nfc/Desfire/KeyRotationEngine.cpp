@@ -0,0 +1,105 @@
+/**
+ * @file KeyRotationEngine.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Key rotation campaign engine implementation
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Nfc/Desfire/KeyRotationEngine.h"
+#include "Nfc/Desfire/DesfireCard.h"
+#include "Nfc/Desfire/Commands/ChangeKeyCommand.h"
+
+using namespace nfc;
+
+KeyRotationEngine::KeyRotationEngine(const KeyRotationCampaignView& campaign, KeyRotationJournal& journal)
+    : campaign(campaign)
+    , journal(journal)
+{
+}
+
+etl::expected<KeyRotationOutcome, error::Error> KeyRotationEngine::apply(
+    DesfireCard& card,
+    const etl::ivector<uint8_t>& uid,
+    const etl::vector<uint8_t, 24>& authKey)
+{
+    const etl::optional<size_t> index = campaign.find(uid);
+    if (!index.has_value())
+    {
+        return KeyRotationOutcome::NotInCampaign;
+    }
+
+    const KeyRotationState state = journal.state(index.value());
+    if (state == KeyRotationState::Done)
+    {
+        return KeyRotationOutcome::AlreadyRotated;
+    }
+
+    // Load before touching the card so a damaged record costs no RF time.
+    auto cryptogramResult = campaign.cryptogram(index.value());
+    if (!cryptogramResult)
+    {
+        return etl::unexpected(cryptogramResult.error());
+    }
+    const ChangeKeyPrecomputedCryptogram& cryptogram = cryptogramResult.value();
+    const KeyRotationCampaignSettings& settings = campaign.settings();
+
+    auto selectResult = card.selectApplication(settings.aid);
+    if (!selectResult)
+    {
+        return etl::unexpected(selectResult.error());
+    }
+
+    if (state == KeyRotationState::InProgress)
+    {
+        // The previous run died between sending ChangeKey and journaling
+        // the result; the card knows which key it holds.
+        auto versionResult = card.getKeyVersion(settings.keyNo);
+        if (versionResult && versionResult.value() == settings.newKeyVersion)
+        {
+            auto doneResult = journal.markDone(index.value(), uid);
+            if (!doneResult)
+            {
+                return etl::unexpected(doneResult.error());
+            }
+            return KeyRotationOutcome::AlreadyRotated;
+        }
+    }
+
+    auto authResult = card.authenticate(settings.authKeyNo, authKey, settings.authMode);
+    if (!authResult)
+    {
+        return etl::unexpected(authResult.error());
+    }
+
+    auto startResult = journal.markInProgress(index.value(), uid);
+    if (!startResult)
+    {
+        return etl::unexpected(startResult.error());
+    }
+
+    ChangeKeyCommandOptions options;
+    options.keyNo = settings.keyNo;
+    options.sessionKeyType = settings.sessionKeyType;
+    options.newKeyType = settings.newKeyType;
+    options.newKeyVersion = settings.newKeyVersion;
+    options.precomputed = &cryptogram;
+
+    ChangeKeyCommand command(options);
+    auto changeResult = card.executeCommand(command);
+    if (!changeResult)
+    {
+        return etl::unexpected(changeResult.error());
+    }
+
+    auto doneResult = journal.markDone(index.value(), uid);
+    if (!doneResult)
+    {
+        return etl::unexpected(doneResult.error());
+    }
+
+    return KeyRotationOutcome::Rotated;
+}
@@ -0,0 +1,212 @@
+/**
+ * @file KeyRotationJournal.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Key rotation journal implementation
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Nfc/Desfire/KeyRotationJournal.h"
+#include "Error/DesfireError.h"
+#include "Utils/Serialization.h"
+#include <cstring>
+
+using namespace nfc;
+
+namespace
+{
+    constexpr uint8_t RECORD_MAGIC = 0x4AU;
+
+    constexpr uint8_t TYPE_BEGIN = 0x01U;
+    constexpr uint8_t TYPE_IN_PROGRESS = 0x02U;
+    constexpr uint8_t TYPE_DONE = 0x03U;
+
+    // Record offsets
+    constexpr size_t REC_MAGIC = 0U;
+    constexpr size_t REC_TYPE = 1U;
+    constexpr size_t REC_UID_LENGTH = 2U;
+    constexpr size_t REC_VALUE = 4U;    // Campaign id (begin) or record index
+    constexpr size_t REC_UID = 8U;
+    constexpr size_t REC_CRC = 20U;
+    constexpr size_t MAX_UID_LENGTH = 10U;
+
+    static_assert(REC_UID + MAX_UID_LENGTH <= REC_CRC, "record layout overlaps CRC");
+    static_assert(REC_CRC + 4U == KeyRotationJournal::RECORD_SIZE, "record layout must fill RECORD_SIZE");
+
+    bool recordValid(const uint8_t* record)
+    {
+        return record[REC_MAGIC] == RECORD_MAGIC &&
+               record[REC_UID_LENGTH] <= MAX_UID_LENGTH &&
+               utils::readLe32(record + REC_CRC) == utils::crc32(record, REC_CRC);
+    }
+}
+
+KeyRotationJournal::KeyRotationJournal(IKeyRotationJournalStorage& storage, KeyRotationState* states, size_t stateCount)
+    : storage(storage)
+    , states(states)
+    , stateCount(stateCount)
+    , recovered(false)
+{
+}
+
+etl::expected<size_t, error::Error> KeyRotationJournal::recover(const KeyRotationCampaignView& campaign)
+{
+    const uint32_t campaignId = campaign.campaignId();
+    recovered = false;
+    for (size_t i = 0U; i < stateCount; ++i)
+    {
+        states[i] = KeyRotationState::Pending;
+    }
+
+    const size_t storedSize = storage.size();
+    size_t validLength = 0U;
+    size_t replayed = 0U;
+    uint8_t record[RECORD_SIZE];
+
+    while (validLength + RECORD_SIZE <= storedSize)
+    {
+        auto readResult = storage.read(validLength, record, RECORD_SIZE);
+        if (!readResult)
+        {
+            return etl::unexpected(readResult.error());
+        }
+
+        if (!recordValid(record))
+        {
+            break;
+        }
+
+        const uint8_t type = record[REC_TYPE];
+        const uint32_t value = utils::readLe32(record + REC_VALUE);
+        if (validLength == 0U)
+        {
+            if (type != TYPE_BEGIN || value != campaignId)
+            {
+                return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+            }
+        }
+        else if (type == TYPE_IN_PROGRESS || type == TYPE_DONE)
+        {
+            etl::vector<uint8_t, MAX_UID_LENGTH> uid;
+            uid.assign(record + REC_UID, record + REC_UID + record[REC_UID_LENGTH]);
+            if (value >= stateCount || !campaign.matches(value, uid))
+            {
+                return etl::unexpected(error::Error::fromDesfire(error::DesfireError::IntegrityError));
+            }
+            states[value] = (type == TYPE_DONE) ? KeyRotationState::Done : KeyRotationState::InProgress;
+        }
+        else
+        {
+            break;
+        }
+
+        validLength += RECORD_SIZE;
+        ++replayed;
+    }
+
+    // Anything after the last valid record is a write torn by a crash.
+    if (validLength != storedSize)
+    {
+        auto truncateResult = storage.truncate(validLength);
+        if (!truncateResult)
+        {
+            return etl::unexpected(truncateResult.error());
+        }
+    }
+
+    recovered = true;
+    if (validLength == 0U)
+    {
+        const etl::vector<uint8_t, 1> noUid;
+        auto beginResult = appendRecord(TYPE_BEGIN, campaignId, noUid);
+        if (!beginResult)
+        {
+            recovered = false;
+            return etl::unexpected(beginResult.error());
+        }
+        return 0U;
+    }
+
+    return replayed - 1U;
+}
+
+KeyRotationState KeyRotationJournal::state(size_t index) const
+{
+    if (index >= stateCount)
+    {
+        return KeyRotationState::Pending;
+    }
+    return states[index];
+}
+
+etl::expected<void, error::Error> KeyRotationJournal::markInProgress(size_t index, const etl::ivector<uint8_t>& uid)
+{
+    if (index >= stateCount)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+    }
+
+    auto appendResult = appendRecord(TYPE_IN_PROGRESS, static_cast<uint32_t>(index), uid);
+    if (!appendResult)
+    {
+        return appendResult;
+    }
+
+    states[index] = KeyRotationState::InProgress;
+    return {};
+}
+
+etl::expected<void, error::Error> KeyRotationJournal::markDone(size_t index, const etl::ivector<uint8_t>& uid)
+{
+    if (index >= stateCount)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+    }
+
+    auto appendResult = appendRecord(TYPE_DONE, static_cast<uint32_t>(index), uid);
+    if (!appendResult)
+    {
+        return appendResult;
+    }
+
+    states[index] = KeyRotationState::Done;
+    return {};
+}
+
+etl::expected<void, error::Error> KeyRotationJournal::appendRecord(
+    uint8_t type,
+    uint32_t value,
+    const etl::ivector<uint8_t>& uid)
+{
+    if (!recovered)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidState));
+    }
+
+    if (uid.size() > MAX_UID_LENGTH)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+    }
+
+    uint8_t record[RECORD_SIZE] = {0};
+    record[REC_MAGIC] = RECORD_MAGIC;
+    record[REC_TYPE] = type;
+    record[REC_UID_LENGTH] = static_cast<uint8_t>(uid.size());
+    utils::writeLe32(record + REC_VALUE, value);
+    if (!uid.empty())
+    {
+        std::memcpy(record + REC_UID, uid.data(), uid.size());
+    }
+    utils::writeLe32(record + REC_CRC, utils::crc32(record, REC_CRC));
+
+    auto appendResult = storage.append(record, RECORD_SIZE);
+    if (!appendResult)
+    {
+        return appendResult;
+    }
+
+    return storage.sync();
+}
@@ -0,0 +1,527 @@
+/**
+ * @file SdmVerifier.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Back-end verifier for Secure Dynamic Messaging (SUN) tap URLs
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Nfc/Desfire/SdmVerifier.h"
+#include "Nfc/Desfire/DesfireCryptoBatch.h"
+#include "Error/DesfireError.h"
+#include "Detail/ValueOperationCryptoUtils.h"
+#include "Utils/Hex.h"
+#include <cstring>
+
+using namespace nfc;
+
+namespace
+{
+    constexpr size_t AES_BLOCK_SIZE = 16U;
+    constexpr size_t PICC_DATA_LENGTH = 16U;
+    constexpr size_t DIVERSIFICATION_BLOCK = 32U;
+    constexpr uint8_t DIVERSIFICATION_CONSTANT = 0x01U;
+
+    // PICCDataTag: UID mirrored, SDMReadCtr mirrored, UID length
+    constexpr uint8_t PICC_TAG_UID_MIRRORED = 0x80U;
+    constexpr uint8_t PICC_TAG_COUNTER_MIRRORED = 0x40U;
+    constexpr uint8_t PICC_TAG_UID_LENGTH_MASK = 0x0FU;
+
+    // SV1 (encryption) and SV2 (MAC) session vector prefixes
+    constexpr uint8_t SV1_PREFIX[6] = {0xC3, 0x3C, 0x00, 0x01, 0x00, 0x80};
+    constexpr uint8_t SV2_PREFIX[6] = {0x3C, 0xC3, 0x00, 0x01, 0x00, 0x80};
+
+    /**
+     * @brief Find the value of a query parameter
+     *
+     * @return true Parameter present; value points into the URL
+     */
+    bool findParameter(etl::string_view url, etl::string_view name, etl::string_view& value)
+    {
+        size_t position = url.find('?');
+        position = (position == etl::string_view::npos) ? 0U : position + 1U;
+
+        while (position < url.size())
+        {
+            size_t end = url.find('&', position);
+            if (end == etl::string_view::npos)
+            {
+                end = url.size();
+            }
+
+            const etl::string_view pair = url.substr(position, end - position);
+            const size_t equals = pair.find('=');
+            if (equals != etl::string_view::npos && pair.substr(0U, equals) == name)
+            {
+                value = pair.substr(equals + 1U);
+                return true;
+            }
+            position = end + 1U;
+        }
+
+        return false;
+    }
+
+    bool equalConstantTime(const uint8_t* a, const uint8_t* b, size_t length)
+    {
+        uint8_t difference = 0U;
+        for (size_t i = 0U; i < length; ++i)
+        {
+            difference = static_cast<uint8_t>(difference | (a[i] ^ b[i]));
+        }
+        return difference == 0U;
+    }
+
+    void buildSessionVector(const uint8_t* prefix, const uint8_t* uid, uint32_t counter, uint8_t* out)
+    {
+        std::memcpy(out, prefix, 6U);
+        std::memcpy(out + 6U, uid, SdmTap::UID_LENGTH);
+        out[13] = static_cast<uint8_t>(counter & 0xFFU);
+        out[14] = static_cast<uint8_t>((counter >> 8U) & 0xFFU);
+        out[15] = static_cast<uint8_t>((counter >> 16U) & 0xFFU);
+    }
+}
+
+/**
+ * @brief Working buffers of one tap while its group is processed
+ */
+struct SdmVerifier::Lane
+{
+    SdmTap* tap = nullptr;
+    bool active = false;
+    uint8_t piccData[PICC_DATA_LENGTH];
+    uint8_t receivedMac[MAC_LENGTH];
+    uint8_t macInput[MAX_MAC_INPUT];
+    size_t macInputLength = 0U;
+    uint8_t encData[SdmTap::MAX_FILE_DATA];
+    size_t encLength = 0U;
+    uint8_t fileReadKey[KEY_LENGTH];
+    uint8_t sv1[AES_BLOCK_SIZE];
+    uint8_t sv2[AES_BLOCK_SIZE];
+    uint8_t sessionEncKey[KEY_LENGTH];
+    uint8_t sessionMacKey[KEY_LENGTH];
+    uint8_t mac[AES_BLOCK_SIZE];
+    uint8_t encIv[AES_BLOCK_SIZE];
+    uint8_t chainA[AES_BLOCK_SIZE];     // one chaining buffer per job of a stage
+    uint8_t chainB[AES_BLOCK_SIZE];
+};
+
+SdmVerifier::SdmVerifier(const SdmVerifierOptions& options)
+    : options(options)
+    , cache()
+    , cacheClock(0U)
+    , verifierMetrics()
+{
+}
+
+etl::expected<bool, error::Error> SdmVerifier::verify(SdmTap& tap)
+{
+    auto result = verifyBatch(&tap, 1U);
+    if (!result)
+    {
+        return etl::unexpected(result.error());
+    }
+    return result.value() == 1U;
+}
+
+etl::expected<size_t, error::Error> SdmVerifier::verifyBatch(SdmTap* taps, size_t count)
+{
+    if (!options.metaReadKey || !options.fileReadKey || (count != 0U && !taps))
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+    }
+
+    Lane lanes[LANES];
+    size_t validCount = 0U;
+
+    for (size_t offset = 0U; offset < count; offset += LANES)
+    {
+        const size_t groupSize = (count - offset) < LANES ? (count - offset) : LANES;
+        for (size_t l = 0U; l < groupSize; ++l)
+        {
+            lanes[l].tap = &taps[offset + l];
+        }
+
+        runGroup(lanes, groupSize);
+
+        for (size_t l = 0U; l < groupSize; ++l)
+        {
+            if (lanes[l].tap->status == SdmVerifyStatus::Valid)
+            {
+                ++validCount;
+            }
+        }
+    }
+
+    // Drop session keys and decrypted data
+    for (Lane& lane : lanes)
+    {
+        lane = Lane();
+    }
+    return validCount;
+}
+
+void SdmVerifier::runGroup(Lane* lanes, size_t count)
+{
+    DesfireCryptoBatch batch;
+
+    // Parse the URLs and decrypt PICCData with K_SDMMetaRead
+    for (size_t l = 0U; l < count; ++l)
+    {
+        Lane& lane = lanes[l];
+        SdmTap& tap = *lane.tap;
+        tap.status = SdmVerifyStatus::Malformed;
+        tap.readCounter = 0U;
+        tap.fileDataLength = 0U;
+        lane.active = false;
+        ++verifierMetrics.taps;
+
+        etl::string_view piccText;
+        etl::string_view macText;
+        etl::string_view encText;
+        size_t length = 0U;
+        if (!findParameter(tap.url, options.piccDataParameter, piccText) ||
+            !utils::hexDecode(piccText.data(), piccText.size(), lane.piccData, PICC_DATA_LENGTH, length) || length != PICC_DATA_LENGTH ||
+            !findParameter(tap.url, options.macParameter, macText) ||
+            !utils::hexDecode(macText.data(), macText.size(), lane.receivedMac, MAC_LENGTH, length) || length != MAC_LENGTH)
+        {
+            continue;
+        }
+
+        lane.encLength = 0U;
+        if (!options.encParameter.empty() && findParameter(tap.url, options.encParameter, encText))
+        {
+            if (!utils::hexDecode(encText.data(), encText.size(), lane.encData, SdmTap::MAX_FILE_DATA, lane.encLength) ||
+                lane.encLength == 0U || (lane.encLength % AES_BLOCK_SIZE) != 0U)
+            {
+                continue;
+            }
+        }
+
+        lane.macInputLength = 0U;
+        if (!options.macInputParameter.empty())
+        {
+            etl::string_view inputText;
+            if (!findParameter(tap.url, options.macInputParameter, inputText) ||
+                inputText.data() > macText.data())
+            {
+                continue;
+            }
+
+            const size_t inputLength = static_cast<size_t>(macText.data() - inputText.data());
+            if (inputLength > MAX_MAC_INPUT)
+            {
+                continue;
+            }
+            std::memcpy(lane.macInput, inputText.data(), inputLength);
+            lane.macInputLength = inputLength;
+        }
+
+        std::memset(lane.chainA, 0, AES_BLOCK_SIZE);
+        DesfireCryptoJob job;
+        job.kind = DesfireCryptoJobKind::AesCbcDecrypt;
+        job.key = options.metaReadKey;
+        job.keyLength = KEY_LENGTH;
+        job.iv = lane.chainA;
+        job.data = lane.piccData;
+        job.length = PICC_DATA_LENGTH;
+        lane.active = batch.submit(job).has_value();
+    }
+    batch.process();
+
+    // Read UID and counter, derive SDM session keys from SV1/SV2
+    for (size_t l = 0U; l < count; ++l)
+    {
+        Lane& lane = lanes[l];
+        if (!lane.active)
+        {
+            continue;
+        }
+
+        SdmTap& tap = *lane.tap;
+        const uint8_t tag = lane.piccData[0];
+        if ((tag & PICC_TAG_UID_MIRRORED) == 0U || (tag & PICC_TAG_COUNTER_MIRRORED) == 0U ||
+            (tag & PICC_TAG_UID_LENGTH_MASK) != SdmTap::UID_LENGTH)
+        {
+            lane.active = false;
+            continue;
+        }
+
+        std::memcpy(tap.uid, lane.piccData + 1U, SdmTap::UID_LENGTH);
+        tap.readCounter =
+            static_cast<uint32_t>(lane.piccData[8]) |
+            (static_cast<uint32_t>(lane.piccData[9]) << 8U) |
+            (static_cast<uint32_t>(lane.piccData[10]) << 16U);
+
+        if (!resolveFileReadKey(tap.uid, lane.fileReadKey))
+        {
+            lane.active = false;
+            continue;
+        }
+
+        buildSessionVector(SV2_PREFIX, tap.uid, tap.readCounter, lane.sv2);
+        std::memset(lane.chainA, 0, AES_BLOCK_SIZE);
+        DesfireCryptoJob job;
+        job.kind = DesfireCryptoJobKind::AesCmac;
+        job.key = lane.fileReadKey;
+        job.keyLength = KEY_LENGTH;
+        job.iv = lane.chainA;
+        job.data = lane.sv2;
+        job.length = AES_BLOCK_SIZE;
+        job.mac = lane.sessionMacKey;
+        lane.active = batch.submit(job).has_value();
+
+        if (lane.active && lane.encLength != 0U)
+        {
+            buildSessionVector(SV1_PREFIX, tap.uid, tap.readCounter, lane.sv1);
+            std::memset(lane.chainB, 0, AES_BLOCK_SIZE);
+            job.iv = lane.chainB;
+            job.data = lane.sv1;
+            job.mac = lane.sessionEncKey;
+            lane.active = batch.submit(job).has_value();
+        }
+    }
+    batch.process();
+
+    // SDMMAC over the MAC input; IV for SDMENCFileData = E(KSesSDMFileReadENC, ctr || 0^13)
+    for (size_t l = 0U; l < count; ++l)
+    {
+        Lane& lane = lanes[l];
+        if (!lane.active)
+        {
+            continue;
+        }
+
+        std::memset(lane.chainA, 0, AES_BLOCK_SIZE);
+        DesfireCryptoJob job;
+        job.kind = DesfireCryptoJobKind::AesCmac;
+        job.key = lane.sessionMacKey;
+        job.keyLength = KEY_LENGTH;
+        job.iv = lane.chainA;
+        job.data = lane.macInput;
+        job.length = lane.macInputLength;
+        job.mac = lane.mac;
+        lane.active = batch.submit(job).has_value();
+
+        if (lane.active && lane.encLength != 0U)
+        {
+            std::memset(lane.encIv, 0, AES_BLOCK_SIZE);
+            std::memcpy(lane.encIv, lane.piccData + 8U, 3U);
+            std::memset(lane.chainB, 0, AES_BLOCK_SIZE);
+            job.kind = DesfireCryptoJobKind::AesCbcEncrypt;
+            job.key = lane.sessionEncKey;
+            job.iv = lane.chainB;
+            job.data = lane.encIv;
+            job.length = AES_BLOCK_SIZE;
+            job.mac = nullptr;
+            lane.active = batch.submit(job).has_value();
+        }
+    }
+    batch.process();
+
+    // Check the truncated MAC (odd bytes) and the counter, then decrypt file data
+    for (size_t l = 0U; l < count; ++l)
+    {
+        Lane& lane = lanes[l];
+        if (!lane.active)
+        {
+            continue;
+        }
+
+        SdmTap& tap = *lane.tap;
+        uint8_t truncated[MAC_LENGTH];
+        for (size_t i = 0U; i < MAC_LENGTH; ++i)
+        {
+            truncated[i] = lane.mac[(2U * i) + 1U];
+        }
+
+        if (!equalConstantTime(truncated, lane.receivedMac, MAC_LENGTH))
+        {
+            tap.status = SdmVerifyStatus::MacMismatch;
+            lane.active = false;
+            continue;
+        }
+
+        CacheEntry& entry = cacheEntry(tap.uid);
+        if (options.rejectReplay && entry.counterSeen && tap.readCounter <= entry.lastCounter)
+        {
+            tap.status = SdmVerifyStatus::Replayed;
+            lane.active = false;
+            continue;
+        }
+        entry.counterSeen = true;
+        entry.lastCounter = tap.readCounter;
+        tap.status = SdmVerifyStatus::Valid;
+
+        if (lane.encLength != 0U)
+        {
+            std::memcpy(lane.chainA, lane.encIv, AES_BLOCK_SIZE);
+            DesfireCryptoJob job;
+            job.kind = DesfireCryptoJobKind::AesCbcDecrypt;
+            job.key = lane.sessionEncKey;
+            job.keyLength = KEY_LENGTH;
+            job.iv = lane.chainA;
+            job.data = lane.encData;
+            job.length = lane.encLength;
+            if (!batch.submit(job))
+            {
+                tap.status = SdmVerifyStatus::Malformed;
+                lane.active = false;
+            }
+        }
+    }
+    batch.process();
+
+    for (size_t l = 0U; l < count; ++l)
+    {
+        Lane& lane = lanes[l];
+        SdmTap& tap = *lane.tap;
+        switch (tap.status)
+        {
+            case SdmVerifyStatus::Valid:
+                ++verifierMetrics.valid;
+                if (lane.encLength != 0U)
+                {
+                    std::memcpy(tap.fileData, lane.encData, lane.encLength);
+                    tap.fileDataLength = lane.encLength;
+                }
+                break;
+            case SdmVerifyStatus::MacMismatch:
+                ++verifierMetrics.macMismatches;
+                break;
+            case SdmVerifyStatus::Replayed:
+                ++verifierMetrics.replayed;
+                break;
+            default:
+                tap.status = SdmVerifyStatus::Malformed;
+                ++verifierMetrics.malformed;
+                break;
+        }
+    }
+}
+
+SdmVerifier::CacheEntry& SdmVerifier::cacheEntry(const uint8_t* uid)
+{
+    // FNV-1a over the UID selects the set
+    uint32_t hash = 2166136261U;
+    for (size_t i = 0U; i < SdmTap::UID_LENGTH; ++i)
+    {
+        hash = (hash ^ uid[i]) * 16777619U;
+    }
+
+    CacheEntry* set = &cache[((hash ^ (hash >> 16U)) % (CACHE_SIZE / CACHE_WAYS)) * CACHE_WAYS];
+    ++cacheClock;
+
+    CacheEntry* victim = &set[0];
+    for (size_t way = 0U; way < CACHE_WAYS; ++way)
+    {
+        CacheEntry& entry = set[way];
+        if (entry.used && std::memcmp(entry.uid, uid, SdmTap::UID_LENGTH) == 0)
+        {
+            entry.lastUse = cacheClock;
+            return entry;
+        }
+
+        // Free ways first, then the least recently used one
+        if (victim->used && (!entry.used || entry.lastUse < victim->lastUse))
+        {
+            victim = &entry;
+        }
+    }
+
+    *victim = CacheEntry();
+    victim->used = true;
+    victim->lastUse = cacheClock;
+    std::memcpy(victim->uid, uid, SdmTap::UID_LENGTH);
+    return *victim;
+}
+
+bool SdmVerifier::resolveFileReadKey(const uint8_t* uid, uint8_t* outKey)
+{
+    if (!options.diversifyFileReadKey)
+    {
+        std::memcpy(outKey, options.fileReadKey, KEY_LENGTH);
+        return true;
+    }
+
+    CacheEntry& entry = cacheEntry(uid);
+    if (entry.keyReady)
+    {
+        ++verifierMetrics.keyCacheHits;
+        std::memcpy(outKey, entry.key, KEY_LENGTH);
+        return true;
+    }
+
+    ++verifierMetrics.keyCacheMisses;
+    uint8_t input[DIVERSIFICATION_BLOCK];
+    const size_t inputLength = SdmTap::UID_LENGTH + options.diversificationSuffixLength;
+    if (inputLength >= DIVERSIFICATION_BLOCK ||
+        (options.diversificationSuffixLength != 0U && !options.diversificationSuffix))
+    {
+        return false;
+    }
+    std::memcpy(input, uid, SdmTap::UID_LENGTH);
+    if (options.diversificationSuffixLength != 0U)
+    {
+        std::memcpy(input + SdmTap::UID_LENGTH, options.diversificationSuffix, options.diversificationSuffixLength);
+    }
+
+    if (!diversifyKey(options.fileReadKey, input, inputLength, entry.key))
+    {
+        return false;
+    }
+    entry.keyReady = true;
+    std::memcpy(outKey, entry.key, KEY_LENGTH);
+    return true;
+}
+
+bool SdmVerifier::diversifyKey(const uint8_t* masterKey, const uint8_t* input, size_t length, uint8_t* outKey)
+{
+    if (!masterKey || !input || !outKey || length == 0U || length >= DIVERSIFICATION_BLOCK)
+    {
+        return false;
+    }
+
+    // M = 0x01 || input, padded to two blocks; the last block is masked
+    // with K1 when M fills it and with K2 when it was padded.
+    uint8_t message[DIVERSIFICATION_BLOCK] = {0};
+    message[0] = DIVERSIFICATION_CONSTANT;
+    std::memcpy(message + 1U, input, length);
+    const bool padded = (length + 1U) < DIVERSIFICATION_BLOCK;
+    if (padded)
+    {
+        message[length + 1U] = 0x80U;
+    }
+
+    uint8_t k1[AES_BLOCK_SIZE];
+    uint8_t k2[AES_BLOCK_SIZE];
+    valueop_detail::generateAesCmacSubkeys(masterKey, k1, k2);
+    valueop_detail::xorBlock16(message + AES_BLOCK_SIZE, padded ? k2 : k1, message + AES_BLOCK_SIZE);
+
+    uint8_t chain[AES_BLOCK_SIZE];
+    valueop_detail::aesEncryptBlock(masterKey, message, chain);
+    valueop_detail::xorBlock16(chain, message + AES_BLOCK_SIZE, chain);
+    valueop_detail::aesEncryptBlock(masterKey, chain, outKey);
+
+    std::memset(message, 0, sizeof(message));
+    std::memset(k1, 0, sizeof(k1));
+    std::memset(k2, 0, sizeof(k2));
+    return true;
+}
+
+void SdmVerifier::clearCache()
+{
+    for (CacheEntry& entry : cache)
+    {
+        entry = CacheEntry();
+    }
+    cacheClock = 0U;
+}
+
+const SdmVerifierMetrics& SdmVerifier::metrics() const
+{
+    return verifierMetrics;
+}
@@ -0,0 +1,432 @@
+/**
+ * @file SecureMessagingCodec.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Stateless DESFire secure messaging for relayed sessions
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Nfc/Desfire/SecureMessagingCodec.h"
+#include "Nfc/Desfire/SecureMessagingPolicy.h"
+#include "Nfc/Desfire/DesfireCryptoBatch.h"
+#include "Error/DesfireError.h"
+#include "Utils/Serialization.h"
+
+using namespace nfc;
+
+namespace
+{
+    using SessionCipher = SecureMessagingPolicy::SessionCipher;
+
+    constexpr uint8_t ADDITIONAL_FRAME = 0xAFU;
+    constexpr size_t TRUNCATED_MAC_LENGTH = 8U;
+    constexpr size_t CRC32_LENGTH = 4U;
+    constexpr uint8_t STATE_FLAG_AUTHENTICATED = 0x01U;
+
+    /**
+     * @brief Cipher of an EV1 session, UNKNOWN for sessions the codec does not handle
+     *
+     * EV2 sessions are handled before this is consulted.
+     */
+    SessionCipher resolveEv1Cipher(const DesfireContext& state)
+    {
+        const SessionCipher cipher = SecureMessagingPolicy::resolveSessionCipher(state);
+        if (cipher == SessionCipher::DES || SecureMessagingPolicy::isLegacyDesOr2KSession(state))
+        {
+            return SessionCipher::UNKNOWN;
+        }
+        return cipher;
+    }
+
+    size_t blockSizeOf(SessionCipher cipher)
+    {
+        return (cipher == SessionCipher::AES) ? 16U : 8U;
+    }
+
+    /**
+     * @brief State of a session the card has dropped after an error status
+     */
+    DesfireContext endSession(const DesfireContext& state)
+    {
+        DesfireContext ended;
+        ended.selectedAid = state.selectedAid;
+        return ended;
+    }
+
+    template <size_t N>
+    void appendField(etl::vector<uint8_t, SecureMessagingCodec::STATE_SIZE>& out, const etl::vector<uint8_t, N>& field)
+    {
+        out.push_back(static_cast<uint8_t>(field.size()));
+        for (size_t i = 0U; i < N; ++i)
+        {
+            out.push_back(i < field.size() ? field[i] : 0x00U);
+        }
+    }
+
+    template <size_t N>
+    bool readField(const etl::ivector<uint8_t>& image, size_t& offset, etl::vector<uint8_t, N>& field)
+    {
+        const size_t length = image[offset];
+        if (length > N)
+        {
+            return false;
+        }
+        field.assign(image.begin() + offset + 1U, image.begin() + offset + 1U + length);
+        offset += 1U + N;
+        return true;
+    }
+}
+
+etl::expected<WrappedCommand, error::Error> SecureMessagingCodec::wrapCommand(
+    const DesfireContext& state,
+    const SecureCommand& command,
+    IWire& wire)
+{
+    WrappedCommand wrapped;
+    wrapped.state = state;
+    wrapped.expectation.responseMode = command.responseMode;
+    wrapped.expectation.expectedResponseLength = command.expectedResponseLength;
+
+    etl::vector<uint8_t, buffer::APDU_COMMAND_MAX> pdu;
+    pdu.push_back(command.commandCode);
+    pdu.insert(pdu.end(), command.header.begin(), command.header.end());
+
+    if (!state.authenticated)
+    {
+        if (pdu.size() + command.data.size() > buffer::DESFIRE_FRAME_MAX)
+        {
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
+        }
+        pdu.insert(pdu.end(), command.data.begin(), command.data.end());
+        wrapped.apdu = wire.wrap(pdu);
+        return wrapped;
+    }
+
+    if (state.authScheme == SessionAuthScheme::Ev2)
+    {
+        // EV2 responses carry a MAC whenever the command was MACed or enciphered
+        auto protection = SecureMessagingPolicy::protectEv2Command(
+            state,
+            command.commandCode,
+            command.header,
+            command.data,
+            command.commMode);
+        if (!protection)
+        {
+            return etl::unexpected(protection.error());
+        }
+        if (1U + protection.value().payload.size() > buffer::DESFIRE_FRAME_MAX)
+        {
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
+        }
+
+        pdu.assign(1U, command.commandCode);
+        pdu.insert(pdu.end(), protection.value().payload.begin(), protection.value().payload.end());
+        if (command.commMode == CommMode::Plain)
+        {
+            wrapped.expectation.responseMode = CommMode::Plain;
+        }
+        else if (command.responseMode != CommMode::Enciphered)
+        {
+            wrapped.expectation.responseMode = CommMode::MACed;
+        }
+        wrapped.apdu = wire.wrap(pdu);
+        return wrapped;
+    }
+
+    const SessionCipher cipher = resolveEv1Cipher(state);
+    if (cipher == SessionCipher::UNKNOWN)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidState));
+    }
+
+    // INS || header || data: CMAC input for plain/MACed, CRC input when enciphered
+    etl::vector<uint8_t, 256> message(pdu.begin(), pdu.end());
+    if (message.size() + command.data.size() > message.max_size())
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
+    }
+    message.insert(message.end(), command.data.begin(), command.data.end());
+
+    // Nothing to encipher when the command has no data beyond its header
+    if (command.commMode != CommMode::Enciphered || command.data.empty())
+    {
+        auto requestIv = SecureMessagingPolicy::derivePlainRequestIv(state, message, true);
+        if (!requestIv)
+        {
+            return etl::unexpected(requestIv.error());
+        }
+
+        const size_t macLength = (command.commMode == CommMode::MACed) ? TRUNCATED_MAC_LENGTH : 0U;
+        if (message.size() + macLength > buffer::DESFIRE_FRAME_MAX)
+        {
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
+        }
+        pdu.insert(pdu.end(), command.data.begin(), command.data.end());
+        pdu.insert(pdu.end(), requestIv.value().begin(), requestIv.value().begin() + macLength);
+        wrapped.state.iv.assign(requestIv.value().begin(), requestIv.value().end());
+    }
+    else
+    {
+        // data || CRC32(INS || header || data), zero padded to the block size
+        etl::vector<uint8_t, 128> plaintext;
+        const size_t blockSize = blockSizeOf(cipher);
+        const size_t protectedLength = command.data.size() + CRC32_LENGTH;
+        const size_t paddedLength = ((protectedLength + blockSize - 1U) / blockSize) * blockSize;
+        if (paddedLength > plaintext.max_size() || pdu.size() + paddedLength > buffer::DESFIRE_FRAME_MAX)
+        {
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
+        }
+
+        plaintext.assign(command.data.begin(), command.data.end());
+        const uint32_t crc = SecureMessagingPolicy::calculateCrc32Desfire(message);
+        for (size_t i = 0U; i < CRC32_LENGTH; ++i)
+        {
+            plaintext.push_back(static_cast<uint8_t>((crc >> (8U * i)) & 0xFFU));
+        }
+        plaintext.resize(paddedLength, 0x00U);
+
+        auto protection = SecureMessagingPolicy::protectEncryptedPayload(state, plaintext, cipher, false);
+        if (!protection)
+        {
+            return etl::unexpected(protection.error());
+        }
+
+        pdu.insert(pdu.end(), protection.value().encryptedPayload.begin(), protection.value().encryptedPayload.end());
+        wrapped.state.iv.assign(protection.value().requestState.begin(), protection.value().requestState.end());
+    }
+
+    wrapped.apdu = wire.wrap(pdu);
+    return wrapped;
+}
+
+etl::expected<UnwrappedResponse, error::Error> SecureMessagingCodec::unwrapResponse(
+    const DesfireContext& state,
+    const SecureResponseExpectation& expectation,
+    const etl::ivector<uint8_t>& response,
+    IWire& wire)
+{
+    auto pduResult = wire.unwrap(response);
+    if (!pduResult)
+    {
+        return etl::unexpected(pduResult.error());
+    }
+
+    const auto& pdu = pduResult.value();
+    if (pdu.empty())
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidResponse));
+    }
+
+    UnwrappedResponse unwrapped;
+    unwrapped.statusCode = pdu[0];
+    unwrapped.state = state;
+
+    if (!state.authenticated)
+    {
+        unwrapped.data.assign(pdu.begin() + 1, pdu.end());
+        return unwrapped;
+    }
+
+    if (unwrapped.statusCode == ADDITIONAL_FRAME)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidState));
+    }
+
+    if (!unwrapped.isSuccess())
+    {
+        unwrapped.state = endSession(state);
+        return unwrapped;
+    }
+
+    if (state.authScheme == SessionAuthScheme::Ev2)
+    {
+        const etl::vector<uint8_t, 256> payload(pdu.begin() + 1, pdu.end());
+        auto verified = SecureMessagingPolicy::verifyEv2Response(
+            unwrapped.state,
+            unwrapped.statusCode,
+            payload,
+            expectation.responseMode,
+            unwrapped.data);
+        if (!verified)
+        {
+            return etl::unexpected(verified.error());
+        }
+        return unwrapped;
+    }
+
+    const SessionCipher cipher = resolveEv1Cipher(state);
+    if (cipher == SessionCipher::UNKNOWN)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidState));
+    }
+
+    etl::vector<uint8_t, 256> payload(pdu.begin() + 1, pdu.end());
+
+    if (expectation.responseMode != CommMode::Enciphered)
+    {
+        // Every successful response of an EV1 session carries the CMAC
+        if (payload.size() < TRUNCATED_MAC_LENGTH)
+        {
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::IntegrityError));
+        }
+
+        const size_t dataLength = payload.size() - TRUNCATED_MAC_LENGTH;
+        const etl::vector<uint8_t, 16> requestIv(state.iv.begin(), state.iv.end());
+        auto verified = SecureMessagingPolicy::verifyAuthenticatedPlainPayloadAndUpdateContextIv(
+            unwrapped.state,
+            payload,
+            unwrapped.statusCode,
+            requestIv,
+            dataLength,
+            TRUNCATED_MAC_LENGTH);
+        if (!verified)
+        {
+            return etl::unexpected(verified.error());
+        }
+
+        unwrapped.data.assign(payload.begin(), payload.begin() + dataLength);
+        return unwrapped;
+    }
+
+    const size_t blockSize = blockSizeOf(cipher);
+    if (payload.empty() || (payload.size() % blockSize) != 0U || state.iv.size() != blockSize)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidResponse));
+    }
+
+    etl::vector<uint8_t, 256> plaintext(payload.begin(), payload.end());
+    uint8_t chain[16];
+    for (size_t i = 0U; i < blockSize; ++i)
+    {
+        chain[i] = state.iv[i];
+    }
+
+    DesfireCryptoJob job;
+    job.kind = (cipher == SessionCipher::AES) ? DesfireCryptoJobKind::AesCbcDecrypt : DesfireCryptoJobKind::TdesCbcDecrypt;
+    job.key = state.sessionKeyEnc.data();
+    job.keyLength = state.sessionKeyEnc.size();
+    job.iv = chain;
+    job.data = plaintext.data();
+    job.length = plaintext.size();
+
+    DesfireCryptoBatch batch;
+    auto submitted = batch.submit(job);
+    if (!submitted)
+    {
+        return etl::unexpected(submitted.error());
+    }
+    batch.process();
+
+    // data || CRC32(data || status) || zero padding; the padding is shorter than a block
+    const size_t longest = plaintext.size() - CRC32_LENGTH;
+    bool located = false;
+    size_t dataLength = 0U;
+    for (size_t step = 0U; step < blockSize && step <= longest; ++step)
+    {
+        const size_t candidate = longest - step;
+        if (expectation.expectedResponseLength != 0U && candidate != expectation.expectedResponseLength)
+        {
+            continue;
+        }
+
+        bool padded = true;
+        for (size_t i = candidate + CRC32_LENGTH; i < plaintext.size(); ++i)
+        {
+            padded = padded && (plaintext[i] == 0x00U);
+        }
+        if (!padded)
+        {
+            continue;
+        }
+
+        etl::vector<uint8_t, 256> crcInput(plaintext.begin(), plaintext.begin() + candidate);
+        crcInput.push_back(unwrapped.statusCode);
+        const uint32_t received =
+            static_cast<uint32_t>(plaintext[candidate]) |
+            (static_cast<uint32_t>(plaintext[candidate + 1U]) << 8U) |
+            (static_cast<uint32_t>(plaintext[candidate + 2U]) << 16U) |
+            (static_cast<uint32_t>(plaintext[candidate + 3U]) << 24U);
+        if (SecureMessagingPolicy::calculateCrc32Desfire(crcInput) == received)
+        {
+            located = true;
+            dataLength = candidate;
+            break;
+        }
+    }
+
+    if (!located)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::IntegrityError));
+    }
+
+    auto ivUpdate = SecureMessagingPolicy::updateContextIvFromEncryptedCiphertext(unwrapped.state, payload);
+    if (!ivUpdate)
+    {
+        return etl::unexpected(ivUpdate.error());
+    }
+
+    unwrapped.data.assign(plaintext.begin(), plaintext.begin() + dataLength);
+    return unwrapped;
+}
+
+etl::vector<uint8_t, SecureMessagingCodec::STATE_SIZE> SecureMessagingCodec::serializeState(const DesfireContext& state)
+{
+    etl::vector<uint8_t, STATE_SIZE> image;
+    image.push_back(STATE_MAGIC);
+    image.push_back(STATE_VERSION);
+    image.push_back(state.authenticated ? STATE_FLAG_AUTHENTICATED : 0x00U);
+    image.push_back(static_cast<uint8_t>(state.commMode));
+    image.push_back(static_cast<uint8_t>(state.authScheme));
+    image.push_back(state.keyNo);
+    appendField(image, state.sessionKeyEnc);
+    appendField(image, state.sessionKeyMac);
+    appendField(image, state.iv);
+    appendField(image, state.sessionEncRndB);
+    appendField(image, state.selectedAid);
+    appendField(image, state.transactionId);
+
+    const size_t counterOffset = image.size();
+    image.resize(counterOffset + 2U + CRC32_LENGTH);
+    utils::writeLe16(image.data() + counterOffset, state.commandCounter);
+    const size_t crcOffset = counterOffset + 2U;
+    utils::writeLe32(image.data() + crcOffset, utils::crc32(image.data(), crcOffset));
+    return image;
+}
+
+etl::expected<DesfireContext, error::Error> SecureMessagingCodec::deserializeState(const etl::ivector<uint8_t>& image)
+{
+    if (image.size() != STATE_SIZE || image[0] != STATE_MAGIC || image[1] != STATE_VERSION)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+    }
+
+    const size_t crcOffset = STATE_SIZE - CRC32_LENGTH;
+    if (utils::readLe32(image.data() + crcOffset) != utils::crc32(image.data(), crcOffset))
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::IntegrityError));
+    }
+
+    DesfireContext state;
+    state.authenticated = (image[2] & STATE_FLAG_AUTHENTICATED) != 0U;
+    state.commMode = static_cast<CommMode>(image[3]);
+    state.authScheme = static_cast<SessionAuthScheme>(image[4]);
+    state.keyNo = image[5];
+
+    size_t offset = 6U;
+    if (!readField(image, offset, state.sessionKeyEnc) ||
+        !readField(image, offset, state.sessionKeyMac) ||
+        !readField(image, offset, state.iv) ||
+        !readField(image, offset, state.sessionEncRndB) ||
+        !readField(image, offset, state.selectedAid) ||
+        !readField(image, offset, state.transactionId))
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::IntegrityError));
+    }
+    state.commandCounter = utils::readLe16(image.data() + offset);
+
+    return state;
+}
@@ -725,3 +725,251 @@ void SecureMessagingPolicy::applyLegacyCommandBoundaryIvPolicy(DesfireContext& c
     zeroIv.resize(8U, 0x00U);
     valueop_detail::setContextIv(context, zeroIv);
 }
+
+bool SecureMessagingPolicy::isEv2Session(const DesfireContext& context)
+{
+    return context.authenticated &&
+           context.authScheme == SessionAuthScheme::Ev2 &&
+           context.transactionId.size() == 4U &&
+           context.sessionKeyEnc.size() == 16U &&
+           context.sessionKeyMac.size() == 16U;
+}
+
+etl::expected<void, error::Error> SecureMessagingPolicy::deriveEv2SessionKeys(
+    const etl::ivector<uint8_t>& key,
+    const etl::ivector<uint8_t>& rndA,
+    const etl::ivector<uint8_t>& rndB,
+    DesfireContext& context)
+{
+    if (key.size() != 16U || rndA.size() != 16U || rndB.size() != 16U)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+    }
+
+    // SV = label(2) || 00 01 00 80 || RndA[0..1] || (RndA[2..7] ^ RndB[0..5]) || RndB[6..15] || RndA[8..15]
+    uint8_t sv1[32];
+    sv1[0] = 0xA5U;
+    sv1[1] = 0x5AU;
+    sv1[2] = 0x00U;
+    sv1[3] = 0x01U;
+    sv1[4] = 0x00U;
+    sv1[5] = 0x80U;
+    sv1[6] = rndA[0];
+    sv1[7] = rndA[1];
+    for (size_t i = 0U; i < 6U; ++i)
+    {
+        sv1[8U + i] = static_cast<uint8_t>(rndA[2U + i] ^ rndB[i]);
+    }
+    for (size_t i = 0U; i < 10U; ++i)
+    {
+        sv1[14U + i] = rndB[6U + i];
+    }
+    for (size_t i = 0U; i < 8U; ++i)
+    {
+        sv1[24U + i] = rndA[8U + i];
+    }
+
+    uint8_t sv2[32];
+    for (size_t i = 0U; i < sizeof(sv2); ++i)
+    {
+        sv2[i] = sv1[i];
+    }
+    sv2[0] = 0x5AU;
+    sv2[1] = 0xA5U;
+
+    const uint8_t zeroIv[16] = {0};
+    uint8_t encKey[16];
+    uint8_t macKey[16];
+    if (!valueop_detail::calculateAesCmac(key.data(), zeroIv, sv1, sizeof(sv1), encKey) ||
+        !valueop_detail::calculateAesCmac(key.data(), zeroIv, sv2, sizeof(sv2), macKey))
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidState));
+    }
+
+    context.sessionKeyEnc.assign(encKey, encKey + 16U);
+    context.sessionKeyMac.assign(macKey, macKey + 16U);
+    return {};
+}
+
+etl::vector<uint8_t, 8> SecureMessagingPolicy::calculateEv2Mac(
+    const DesfireContext& context,
+    uint8_t code,
+    uint16_t commandCounter,
+    const etl::ivector<uint8_t>& data)
+{
+    etl::vector<uint8_t, 264> message;
+    message.push_back(code);
+    message.push_back(static_cast<uint8_t>(commandCounter & 0xFFU));
+    message.push_back(static_cast<uint8_t>((commandCounter >> 8U) & 0xFFU));
+    message.insert(message.end(), context.transactionId.begin(), context.transactionId.end());
+    message.insert(message.end(), data.begin(), data.end());
+
+    const uint8_t zeroIv[16] = {0};
+    uint8_t cmac[16] = {0};
+    valueop_detail::calculateAesCmac(context.sessionKeyMac.data(), zeroIv, message.data(), message.size(), cmac);
+
+    etl::vector<uint8_t, 8> truncated;
+    for (size_t i = 1U; i < 16U; i += 2U)
+    {
+        truncated.push_back(cmac[i]);
+    }
+    return truncated;
+}
+
+etl::vector<uint8_t, 16> SecureMessagingPolicy::deriveEv2Iv(
+    const DesfireContext& context,
+    bool response,
+    uint16_t commandCounter)
+{
+    uint8_t input[16] = {0};
+    input[0] = response ? 0x5AU : 0xA5U;
+    input[1] = response ? 0xA5U : 0x5AU;
+    for (size_t i = 0U; i < context.transactionId.size() && i < 4U; ++i)
+    {
+        input[2U + i] = context.transactionId[i];
+    }
+    input[6] = static_cast<uint8_t>(commandCounter & 0xFFU);
+    input[7] = static_cast<uint8_t>((commandCounter >> 8U) & 0xFFU);
+
+    uint8_t iv[16];
+    valueop_detail::aesEncryptBlock(context.sessionKeyEnc.data(), input, iv);
+    return etl::vector<uint8_t, 16>(iv, iv + 16U);
+}
+
+etl::expected<SecureMessagingPolicy::Ev2CommandProtection, error::Error> SecureMessagingPolicy::protectEv2Command(
+    const DesfireContext& context,
+    uint8_t commandCode,
+    const etl::ivector<uint8_t>& header,
+    const etl::ivector<uint8_t>& data,
+    CommMode commMode)
+{
+    // CmdCtr must not wrap; the session has to be re-established first
+    if (!isEv2Session(context) || context.commandCounter == 0xFFFFU)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidState));
+    }
+
+    Ev2CommandProtection protection;
+    const size_t paddedLength = (commMode == CommMode::Enciphered && !data.empty())
+        ? ((data.size() / 16U) + 1U) * 16U
+        : data.size();
+    const size_t macLength = (commMode == CommMode::Plain) ? 0U : 8U;
+    if (header.size() + paddedLength + macLength > protection.payload.max_size())
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
+    }
+
+    protection.payload.assign(header.begin(), header.end());
+    if (commMode != CommMode::Enciphered || data.empty())
+    {
+        protection.payload.insert(protection.payload.end(), data.begin(), data.end());
+    }
+    else
+    {
+        // Data || 80 00 .. 00, always at least one padding byte
+        const size_t start = protection.payload.size();
+        protection.payload.insert(protection.payload.end(), data.begin(), data.end());
+        protection.payload.push_back(0x80U);
+        protection.payload.resize(start + paddedLength, 0x00U);
+
+        const etl::vector<uint8_t, 16> iv = deriveEv2Iv(context, false, context.commandCounter);
+        AES_ctx aesContext;
+        AES_init_ctx_iv(&aesContext, context.sessionKeyEnc.data(), iv.data());
+        AES_CBC_encrypt_buffer(&aesContext, protection.payload.data() + start, paddedLength);
+    }
+
+    if (commMode != CommMode::Plain)
+    {
+        const etl::vector<uint8_t, 8> mac = calculateEv2Mac(context, commandCode, context.commandCounter, protection.payload);
+        protection.payload.insert(protection.payload.end(), mac.begin(), mac.end());
+    }
+
+    return protection;
+}
+
+etl::expected<void, error::Error> SecureMessagingPolicy::verifyEv2Response(
+    DesfireContext& context,
+    uint8_t statusCode,
+    const etl::ivector<uint8_t>& payload,
+    CommMode commMode,
+    etl::ivector<uint8_t>& data)
+{
+    if (!isEv2Session(context))
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidState));
+    }
+
+    const uint16_t nextCounter = static_cast<uint16_t>(context.commandCounter + 1U);
+    data.clear();
+
+    if (commMode == CommMode::Plain)
+    {
+        if (payload.size() > data.max_size())
+        {
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
+        }
+        data.assign(payload.begin(), payload.end());
+        context.commandCounter = nextCounter;
+        return {};
+    }
+
+    if (payload.size() < 8U)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::IntegrityError));
+    }
+
+    const size_t bodyLength = payload.size() - 8U;
+    const etl::vector<uint8_t, 256> body(payload.begin(), payload.begin() + bodyLength);
+    const etl::vector<uint8_t, 8> expected = calculateEv2Mac(context, statusCode, nextCounter, body);
+    uint8_t difference = 0x00U;
+    for (size_t i = 0U; i < 8U; ++i)
+    {
+        difference |= static_cast<uint8_t>(expected[i] ^ payload[bodyLength + i]);
+    }
+    if (difference != 0x00U)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::IntegrityError));
+    }
+
+    if (commMode == CommMode::MACed || bodyLength == 0U)
+    {
+        if (bodyLength > data.max_size())
+        {
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
+        }
+        data.assign(body.begin(), body.end());
+        context.commandCounter = nextCounter;
+        return {};
+    }
+
+    if ((bodyLength % 16U) != 0U)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidResponse));
+    }
+
+    etl::vector<uint8_t, 256> plaintext(body.begin(), body.end());
+    const etl::vector<uint8_t, 16> iv = deriveEv2Iv(context, true, nextCounter);
+    AES_ctx aesContext;
+    AES_init_ctx_iv(&aesContext, context.sessionKeyEnc.data(), iv.data());
+    AES_CBC_decrypt_buffer(&aesContext, plaintext.data(), plaintext.size());
+
+    // Strip 80 00 .. 00; the padding never exceeds one block
+    size_t dataLength = plaintext.size();
+    while (dataLength > 0U && (plaintext.size() - dataLength) < 16U && plaintext[dataLength - 1U] == 0x00U)
+    {
+        --dataLength;
+    }
+    if (dataLength == 0U || plaintext[dataLength - 1U] != 0x80U)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::IntegrityError));
+    }
+    --dataLength;
+    if (dataLength > data.max_size())
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
+    }
+
+    data.assign(plaintext.begin(), plaintext.begin() + dataLength);
+    context.commandCounter = nextCounter;
+    return {};
+}
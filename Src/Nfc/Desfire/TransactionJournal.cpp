@@ -0,0 +1,591 @@
+/**
+ * @file TransactionJournal.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Transaction journal implementation
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Nfc/Desfire/TransactionJournal.h"
+#include "Nfc/Desfire/DesfireCryptoBatch.h"
+#include "Error/DesfireError.h"
+#include "Utils/Serialization.h"
+#include <cstring>
+
+using namespace nfc;
+
+namespace
+{
+    using Format = TransactionJournalFormat;
+
+    // Header offsets
+    constexpr size_t HDR_VERSION = 4U;
+    constexpr size_t HDR_INDEX = 8U;
+    constexpr size_t HDR_FIRST_SEQUENCE = 12U;
+    constexpr size_t HDR_SEGMENT_SIZE = 16U;
+
+    // Entry offsets
+    constexpr size_t ENT_MAGIC = 0U;
+    constexpr size_t ENT_TYPE = 1U;
+    constexpr size_t ENT_FLAGS = 2U;
+    constexpr size_t ENT_FILE_NO = 3U;
+    constexpr size_t ENT_AID_LENGTH = 4U;
+    constexpr size_t ENT_AID = 5U;
+    constexpr size_t ENT_SEQUENCE = 8U;
+    constexpr size_t ENT_DELTA = 12U;
+    constexpr size_t ENT_TIMESTAMP = 16U;
+    constexpr size_t ENT_NEW_VALUE = 24U;
+    constexpr size_t ENT_UID_LENGTH = 28U;
+    constexpr size_t ENT_UID = 29U;
+    constexpr size_t MAX_AID_LENGTH = 3U;
+    constexpr size_t MAX_UID_LENGTH = 10U;
+    constexpr size_t MAC_LENGTH = 8U;
+
+    static_assert(ENT_UID + MAX_UID_LENGTH <= Format::MAC_OFFSET, "entry layout overlaps MAC");
+    static_assert(Format::MAC_OFFSET + MAC_LENGTH <= Format::CRC_OFFSET, "entry layout overlaps CRC");
+    static_assert(Format::CRC_OFFSET + 4U == Format::SLOT_SIZE, "entry layout must fill SLOT_SIZE");
+
+    bool slotEmpty(const uint8_t* slot)
+    {
+        for (size_t i = 0U; i < Format::SLOT_SIZE; ++i)
+        {
+            if (slot[i] != 0U)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void computeMac(const uint8_t* key, const uint8_t* slot, uint8_t* mac)
+    {
+        uint8_t message[Format::MAC_OFFSET];
+        std::memcpy(message, slot, sizeof(message));
+        uint8_t iv[16] = {0};
+        uint8_t full[16] = {0};
+
+        DesfireCryptoJob job;
+        job.kind = DesfireCryptoJobKind::AesCmac;
+        job.key = key;
+        job.keyLength = 16U;
+        job.iv = iv;
+        job.data = message;
+        job.length = sizeof(message);
+        job.mac = full;
+
+        DesfireCryptoBatch batch;
+        (void)batch.submit(job);
+        (void)batch.process();
+        std::memcpy(mac, full, MAC_LENGTH);
+    }
+
+    // Writes the entry body first and the CRC last, so a concurrent reader
+    // or a crash never sees a matching CRC over a partial entry.
+    void writeSlot(uint8_t* target, const uint8_t* slot)
+    {
+        std::memcpy(target, slot, Format::CRC_OFFSET);
+        std::memcpy(target + Format::CRC_OFFSET, slot + Format::CRC_OFFSET, 4U);
+    }
+
+    bool headerValid(const uint8_t* header, size_t mappedSize)
+    {
+        return std::memcmp(header, Format::MAGIC, sizeof(Format::MAGIC)) == 0 &&
+               header[HDR_VERSION] == Format::VERSION &&
+               utils::readLe32(header + Format::CRC_OFFSET) == utils::crc32(header, Format::CRC_OFFSET) &&
+               utils::readLe32(header + HDR_SEGMENT_SIZE) >= (2U * Format::SLOT_SIZE) &&
+               utils::readLe32(header + HDR_SEGMENT_SIZE) <= mappedSize;
+    }
+}
+
+void TransactionJournalFormat::encode(const TransactionJournalEntry& entry, uint8_t* slot)
+{
+    std::memset(slot, 0, SLOT_SIZE);
+    slot[ENT_MAGIC] = ENTRY_MAGIC;
+    slot[ENT_TYPE] = static_cast<uint8_t>(entry.type);
+    slot[ENT_FLAGS] = entry.flags;
+    slot[ENT_FILE_NO] = entry.fileNo;
+    slot[ENT_AID_LENGTH] = static_cast<uint8_t>(entry.aid.size());
+    if (!entry.aid.empty())
+    {
+        std::memcpy(slot + ENT_AID, entry.aid.data(), entry.aid.size());
+    }
+    utils::writeLe32(slot + ENT_SEQUENCE, entry.sequence);
+    utils::writeLe32(slot + ENT_DELTA, static_cast<uint32_t>(entry.delta));
+    utils::writeLe64(slot + ENT_TIMESTAMP, entry.timestamp);
+    utils::writeLe32(slot + ENT_NEW_VALUE, static_cast<uint32_t>(entry.newValue));
+    slot[ENT_UID_LENGTH] = static_cast<uint8_t>(entry.uid.size());
+    if (!entry.uid.empty())
+    {
+        std::memcpy(slot + ENT_UID, entry.uid.data(), entry.uid.size());
+    }
+    std::memcpy(slot + MAC_OFFSET, entry.mac, MAC_LENGTH);
+}
+
+bool TransactionJournalFormat::decode(const uint8_t* slot, TransactionJournalEntry& entry)
+{
+    if (slot[ENT_MAGIC] != ENTRY_MAGIC ||
+        slot[ENT_AID_LENGTH] > MAX_AID_LENGTH ||
+        slot[ENT_UID_LENGTH] > MAX_UID_LENGTH ||
+        utils::readLe32(slot + CRC_OFFSET) != utils::crc32(slot, CRC_OFFSET))
+    {
+        return false;
+    }
+
+    entry.type = static_cast<TransactionJournalType>(slot[ENT_TYPE]);
+    entry.flags = slot[ENT_FLAGS];
+    entry.fileNo = slot[ENT_FILE_NO];
+    entry.aid.assign(slot + ENT_AID, slot + ENT_AID + slot[ENT_AID_LENGTH]);
+    entry.sequence = utils::readLe32(slot + ENT_SEQUENCE);
+    entry.delta = static_cast<int32_t>(utils::readLe32(slot + ENT_DELTA));
+    entry.timestamp = utils::readLe64(slot + ENT_TIMESTAMP);
+    entry.newValue = static_cast<int32_t>(utils::readLe32(slot + ENT_NEW_VALUE));
+    entry.uid.assign(slot + ENT_UID, slot + ENT_UID + slot[ENT_UID_LENGTH]);
+    std::memcpy(entry.mac, slot + MAC_OFFSET, MAC_LENGTH);
+    return true;
+}
+
+bool TransactionJournalFormat::verifyMac(const TransactionJournalEntry& entry, const uint8_t* key)
+{
+    uint8_t slot[SLOT_SIZE];
+    encode(entry, slot);
+    uint8_t mac[MAC_LENGTH];
+    computeMac(key, slot, mac);
+    return std::memcmp(mac, entry.mac, MAC_LENGTH) == 0;
+}
+
+TransactionJournal::TransactionJournal(ITransactionJournalSegments& segments, const TransactionJournalOptions& options)
+    : segments(segments)
+    , options(options)
+    , segment(nullptr)
+    , currentIndex(0U)
+    , capacity(0U)
+    , used(0U)
+    , flushed(0U)
+    , sequence(0U)
+    , durableSequence(0U)
+    , groupStart(0U)
+    , journalMetrics()
+{
+}
+
+TransactionJournal::~TransactionJournal()
+{
+    if (segment != nullptr)
+    {
+        (void)commit();
+        segments.unmap(currentIndex);
+    }
+}
+
+etl::expected<uint32_t, error::Error> TransactionJournal::recover()
+{
+    if (options.segmentSize % Format::SLOT_SIZE != 0U ||
+        options.segmentSize < (2U * Format::SLOT_SIZE) ||
+        options.groupSize == 0U)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+    }
+
+    if (segment != nullptr)
+    {
+        (void)commit();
+        segments.unmap(currentIndex);
+        segment = nullptr;
+    }
+
+    uint32_t newest = 0U;
+    if (!segments.newestSegment(newest))
+    {
+        auto startResult = startSegment(0U, 0U);
+        if (!startResult)
+        {
+            return etl::unexpected(startResult.error());
+        }
+        return 0U;
+    }
+
+    auto mapResult = segments.map(newest, options.segmentSize);
+    if (!mapResult)
+    {
+        return etl::unexpected(mapResult.error());
+    }
+    uint8_t* image = mapResult.value();
+
+    if (!headerValid(image, options.segmentSize) || utils::readLe32(image + HDR_INDEX) != newest)
+    {
+        // Crashed while starting this segment: the sequence continues from
+        // the end of the previous one.
+        segments.unmap(newest);
+        uint32_t firstSequence = 0U;
+        if (newest > 0U)
+        {
+            auto previousResult = segments.map(newest - 1U, options.segmentSize);
+            if (!previousResult)
+            {
+                return etl::unexpected(previousResult.error());
+            }
+            const uint8_t* previous = previousResult.value();
+            const bool previousValid = headerValid(previous, options.segmentSize);
+            if (previousValid)
+            {
+                const uint32_t previousFirst = utils::readLe32(previous + HDR_FIRST_SEQUENCE);
+                firstSequence = previousFirst + scanSegment(previous, previousFirst);
+            }
+            segments.unmap(newest - 1U);
+            if (!previousValid)
+            {
+                return etl::unexpected(error::Error::fromDesfire(error::DesfireError::IntegrityError));
+            }
+        }
+
+        auto startResult = startSegment(newest, firstSequence);
+        if (!startResult)
+        {
+            return etl::unexpected(startResult.error());
+        }
+        return 0U;
+    }
+
+    const uint32_t firstSequence = utils::readLe32(image + HDR_FIRST_SEQUENCE);
+    const size_t slots = Format::entriesPerSegment(utils::readLe32(image + HDR_SEGMENT_SIZE));
+    const uint32_t kept = scanSegment(image, firstSequence);
+
+    // Everything after the last good entry belongs to a group that was
+    // never flushed; its pages may have reached the disk out of order.
+    size_t cleared = 0U;
+    for (size_t i = kept; i < slots; ++i)
+    {
+        uint8_t* slot = image + ((i + 1U) * Format::SLOT_SIZE);
+        if (!slotEmpty(slot))
+        {
+            std::memset(slot, 0, Format::SLOT_SIZE);
+            ++journalMetrics.discarded;
+            cleared = i + 1U;
+        }
+    }
+
+    if (cleared != 0U)
+    {
+        auto flushResult = segments.flush(newest,
+                                          (kept + 1U) * Format::SLOT_SIZE,
+                                          (cleared - kept) * Format::SLOT_SIZE);
+        if (!flushResult)
+        {
+            segments.unmap(newest);
+            return etl::unexpected(flushResult.error());
+        }
+    }
+
+    segment = image;
+    currentIndex = newest;
+    capacity = slots;
+    used = kept;
+    flushed = kept;
+    sequence = firstSequence + kept;
+    durableSequence = sequence;
+    journalMetrics.recovered += kept;
+    return kept;
+}
+
+etl::expected<uint32_t, error::Error> TransactionJournal::append(const TransactionJournalEntry& entry)
+{
+    if (segment == nullptr)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidState));
+    }
+
+    if (entry.uid.size() > MAX_UID_LENGTH || entry.aid.size() > MAX_AID_LENGTH)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+    }
+
+    if (used == capacity)
+    {
+        auto rotateResult = rotate();
+        if (!rotateResult)
+        {
+            return etl::unexpected(rotateResult.error());
+        }
+    }
+
+    TransactionJournalEntry stamped = entry;
+    stamped.sequence = sequence;
+    if (options.clock != nullptr)
+    {
+        stamped.timestamp = options.clock();
+    }
+
+    uint8_t slot[Format::SLOT_SIZE];
+    std::memset(stamped.mac, 0, sizeof(stamped.mac));
+    Format::encode(stamped, slot);
+    if (options.macKey != nullptr)
+    {
+        computeMac(options.macKey, slot, slot + Format::MAC_OFFSET);
+    }
+    utils::writeLe32(slot + Format::CRC_OFFSET, utils::crc32(slot, Format::CRC_OFFSET));
+    writeSlot(segment + ((used + 1U) * Format::SLOT_SIZE), slot);
+
+    if (used == flushed)
+    {
+        groupStart = stamped.timestamp;
+    }
+    ++used;
+    ++sequence;
+    ++journalMetrics.appended;
+
+    if ((used - flushed) >= options.groupSize)
+    {
+        auto commitResult = commit();
+        if (!commitResult)
+        {
+            return etl::unexpected(commitResult.error());
+        }
+    }
+
+    return stamped.sequence;
+}
+
+etl::expected<void, error::Error> TransactionJournal::poll()
+{
+    if (segment == nullptr || used == flushed || options.clock == nullptr)
+    {
+        return {};
+    }
+
+    if ((options.clock() - groupStart) < options.groupDelayMs)
+    {
+        return {};
+    }
+
+    return commit();
+}
+
+etl::expected<void, error::Error> TransactionJournal::commit()
+{
+    if (segment == nullptr || used == flushed)
+    {
+        return {};
+    }
+
+    auto flushResult = segments.flush(currentIndex,
+                                      (flushed + 1U) * Format::SLOT_SIZE,
+                                      (used - flushed) * Format::SLOT_SIZE);
+    ++journalMetrics.flushes;
+    if (!flushResult)
+    {
+        return flushResult;
+    }
+
+    flushed = used;
+    durableSequence = sequence;
+    return {};
+}
+
+bool TransactionJournal::isDurable(uint32_t entrySequence) const
+{
+    return entrySequence < durableSequence;
+}
+
+uint32_t TransactionJournal::nextSequence() const
+{
+    return sequence;
+}
+
+uint32_t TransactionJournal::segmentIndex() const
+{
+    return currentIndex;
+}
+
+const TransactionJournalMetrics& TransactionJournal::metrics() const
+{
+    return journalMetrics;
+}
+
+etl::expected<void, error::Error> TransactionJournal::startSegment(uint32_t index, uint32_t firstSequence)
+{
+    auto mapResult = segments.map(index, options.segmentSize);
+    if (!mapResult)
+    {
+        return etl::unexpected(mapResult.error());
+    }
+
+    // A segment restarted after a crash may hold stale slots
+    uint8_t* image = mapResult.value();
+    std::memset(image, 0, options.segmentSize);
+    std::memcpy(image, Format::MAGIC, sizeof(Format::MAGIC));
+    image[HDR_VERSION] = Format::VERSION;
+    utils::writeLe32(image + HDR_INDEX, index);
+    utils::writeLe32(image + HDR_FIRST_SEQUENCE, firstSequence);
+    utils::writeLe32(image + HDR_SEGMENT_SIZE, static_cast<uint32_t>(options.segmentSize));
+    utils::writeLe32(image + Format::CRC_OFFSET, utils::crc32(image, Format::CRC_OFFSET));
+
+    auto flushResult = segments.flush(index, 0U, options.segmentSize);
+    ++journalMetrics.flushes;
+    if (!flushResult)
+    {
+        segments.unmap(index);
+        return flushResult;
+    }
+
+    segment = image;
+    currentIndex = index;
+    capacity = Format::entriesPerSegment(options.segmentSize);
+    used = 0U;
+    flushed = 0U;
+    sequence = firstSequence;
+    durableSequence = firstSequence;
+    return {};
+}
+
+etl::expected<void, error::Error> TransactionJournal::rotate()
+{
+    auto commitResult = commit();
+    if (!commitResult)
+    {
+        return commitResult;
+    }
+
+    const uint32_t next = currentIndex + 1U;
+    segments.unmap(currentIndex);
+    segment = nullptr;
+
+    auto startResult = startSegment(next, sequence);
+    if (!startResult)
+    {
+        return startResult;
+    }
+
+    ++journalMetrics.rotations;
+    return {};
+}
+
+uint32_t TransactionJournal::scanSegment(const uint8_t* image, uint32_t firstSequence) const
+{
+    const size_t slots = Format::entriesPerSegment(utils::readLe32(image + HDR_SEGMENT_SIZE));
+    TransactionJournalEntry entry;
+    uint32_t count = 0U;
+    while (count < slots &&
+           Format::decode(image + ((count + 1U) * Format::SLOT_SIZE), entry) &&
+           entry.sequence == firstSequence + count)
+    {
+        ++count;
+    }
+    return count;
+}
+
+TransactionJournalRecorder::TransactionJournalRecorder()
+    : journal(nullptr)
+    , uid()
+    , failed(0U)
+    , lastFailure()
+{
+}
+
+void TransactionJournalRecorder::attach(TransactionJournal* target, const etl::ivector<uint8_t>& cardUid)
+{
+    journal = target;
+    uid.assign(cardUid.begin(), cardUid.begin() + ((cardUid.size() < uid.capacity()) ? cardUid.size() : uid.capacity()));
+    failed = 0U;
+    lastFailure.reset();
+}
+
+bool TransactionJournalRecorder::isAttached() const
+{
+    return journal != nullptr;
+}
+
+bool TransactionJournalRecorder::record(
+    TransactionJournalType type,
+    const etl::ivector<uint8_t>& aid,
+    uint8_t fileNo,
+    int32_t delta,
+    int32_t newValue,
+    uint8_t flags)
+{
+    if (journal == nullptr)
+    {
+        return false;
+    }
+
+    TransactionJournalEntry entry;
+    entry.type = type;
+    entry.flags = flags;
+    entry.uid = uid;
+    entry.aid.assign(aid.begin(), aid.begin() + ((aid.size() < entry.aid.capacity()) ? aid.size() : entry.aid.capacity()));
+    entry.fileNo = fileNo;
+    entry.delta = delta;
+    entry.newValue = newValue;
+
+    auto appendResult = journal->append(entry);
+    if (!appendResult)
+    {
+        ++failed;
+        lastFailure = appendResult.error();
+        return false;
+    }
+    return true;
+}
+
+uint32_t TransactionJournalRecorder::failures() const
+{
+    return failed;
+}
+
+const etl::optional<error::Error>& TransactionJournalRecorder::lastError() const
+{
+    return lastFailure;
+}
+
+etl::expected<void, error::Error> TransactionJournalReader::open(const uint8_t* segmentImage, size_t size)
+{
+    image = nullptr;
+    if (segmentImage == nullptr || size < (2U * Format::SLOT_SIZE) || !headerValid(segmentImage, size))
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+    }
+
+    image = segmentImage;
+    slots = Format::entriesPerSegment(utils::readLe32(segmentImage + HDR_SEGMENT_SIZE));
+    position = 0U;
+    index = utils::readLe32(segmentImage + HDR_INDEX);
+    expectedSequence = utils::readLe32(segmentImage + HDR_FIRST_SEQUENCE);
+    return {};
+}
+
+bool TransactionJournalReader::next(TransactionJournalEntry& entry)
+{
+    if (image == nullptr || position >= slots)
+    {
+        return false;
+    }
+
+    TransactionJournalEntry decoded;
+    if (!Format::decode(image + ((position + 1U) * Format::SLOT_SIZE), decoded) ||
+        decoded.sequence != expectedSequence)
+    {
+        return false;
+    }
+
+    entry = decoded;
+    ++position;
+    ++expectedSequence;
+    return true;
+}
+
+bool TransactionJournalReader::atEnd() const
+{
+    return image != nullptr && position >= slots;
+}
+
+uint32_t TransactionJournalReader::segmentIndex() const
+{
+    return index;
+}
+
+uint32_t TransactionJournalReader::nextSequence() const
+{
+    return expectedSequence;
+}
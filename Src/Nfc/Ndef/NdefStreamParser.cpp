@@ -0,0 +1,208 @@
+/**
+ * @file NdefStreamParser.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Incremental NDEF message parser implementation
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Nfc/Ndef/NdefStreamParser.h"
+#include "Error/DesfireError.h"
+
+using namespace nfc;
+
+NdefStreamParser::NdefStreamParser(INdefRecordHandler& handler)
+    : handler(handler)
+    , header()
+    , state(State::Header)
+    , typeLength(0U)
+    , idLength(0U)
+    , lengthBytesLeft(0U)
+    , payloadLeft(0U)
+    , records(0U)
+    , inChunkedRecord(false)
+{
+}
+
+void NdefStreamParser::reset()
+{
+    header = NdefRecordHeader();
+    state = State::Header;
+    typeLength = 0U;
+    idLength = 0U;
+    lengthBytesLeft = 0U;
+    payloadLeft = 0U;
+    records = 0U;
+    inChunkedRecord = false;
+}
+
+size_t NdefStreamParser::recordCount() const
+{
+    return records;
+}
+
+etl::expected<void, error::Error> NdefStreamParser::feed(const uint8_t* data, size_t length)
+{
+    size_t index = 0U;
+    while (index < length)
+    {
+        const uint8_t byte = data[index];
+        switch (state)
+        {
+            case State::Header:
+            {
+                const bool first = (records == 0U) && !inChunkedRecord;
+                const bool messageBegin = (byte & ndef::FLAG_MB) != 0U;
+                const NdefTnf tnf = static_cast<NdefTnf>(byte & ndef::TNF_MASK);
+
+                // MB only on the first record; chunk continuations must be
+                // TNF Unchanged and nothing else may be.
+                if (messageBegin != first ||
+                    tnf == NdefTnf::Reserved ||
+                    (tnf == NdefTnf::Unchanged) != inChunkedRecord)
+                {
+                    return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidResponse));
+                }
+
+                header.flags = static_cast<uint8_t>(byte & ~ndef::TNF_MASK);
+                header.tnf = tnf;
+                header.payloadLength = 0U;
+                header.type.clear();
+                header.id.clear();
+                idLength = 0U;
+                state = State::TypeLength;
+                ++index;
+                break;
+            }
+
+            case State::TypeLength:
+                typeLength = byte;
+                if ((header.tnf == NdefTnf::Empty || header.tnf == NdefTnf::Unchanged) && typeLength != 0U)
+                {
+                    return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidResponse));
+                }
+                lengthBytesLeft = ((header.flags & ndef::FLAG_SR) != 0U) ? 1U : 4U;
+                state = State::PayloadLength;
+                ++index;
+                break;
+
+            case State::PayloadLength:
+                header.payloadLength = (header.payloadLength << 8U) | byte;
+                ++index;
+                if (--lengthBytesLeft == 0U)
+                {
+                    state = ((header.flags & ndef::FLAG_IL) != 0U) ? State::IdLength : State::Type;
+                    if (state == State::Type && typeLength == 0U)
+                    {
+                        beginPayload();
+                    }
+                }
+                break;
+
+            case State::IdLength:
+                idLength = byte;
+                ++index;
+                state = State::Type;
+                if (typeLength == 0U)
+                {
+                    state = State::Id;
+                    if (idLength == 0U)
+                    {
+                        beginPayload();
+                    }
+                }
+                break;
+
+            case State::Type:
+            {
+                const size_t wanted = typeLength - header.type.size();
+                const size_t take = (wanted < length - index) ? wanted : length - index;
+                header.type.insert(header.type.end(), data + index, data + index + take);
+                index += take;
+                if (header.type.size() == typeLength)
+                {
+                    state = State::Id;
+                    if (idLength == 0U)
+                    {
+                        beginPayload();
+                    }
+                }
+                break;
+            }
+
+            case State::Id:
+            {
+                const size_t wanted = idLength - header.id.size();
+                const size_t take = (wanted < length - index) ? wanted : length - index;
+                header.id.insert(header.id.end(), data + index, data + index + take);
+                index += take;
+                if (header.id.size() == idLength)
+                {
+                    beginPayload();
+                }
+                break;
+            }
+
+            case State::Payload:
+            {
+                const size_t take = (payloadLeft < length - index) ? payloadLeft : length - index;
+                handler.onPayload(data + index, take);
+                index += take;
+                payloadLeft -= static_cast<uint32_t>(take);
+                if (payloadLeft == 0U)
+                {
+                    endRecord();
+                }
+                break;
+            }
+
+            case State::Done:
+            default:
+                // Bytes after the ME record
+                return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidResponse));
+        }
+    }
+
+    return {};
+}
+
+etl::expected<void, error::Error> NdefStreamParser::finish() const
+{
+    // An empty message (NLEN = 0) is valid and contains no records.
+    if (state == State::Done || (state == State::Header && records == 0U && !inChunkedRecord))
+    {
+        return {};
+    }
+
+    return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
+}
+
+void NdefStreamParser::beginPayload()
+{
+    handler.onRecordBegin(header);
+    payloadLeft = header.payloadLength;
+    state = State::Payload;
+    if (payloadLeft == 0U)
+    {
+        endRecord();
+    }
+}
+
+void NdefStreamParser::endRecord()
+{
+    handler.onRecordEnd();
+    ++records;
+    inChunkedRecord = (header.flags & ndef::FLAG_CF) != 0U;
+
+    if ((header.flags & ndef::FLAG_ME) != 0U && !inChunkedRecord)
+    {
+        state = State::Done;
+    }
+    else
+    {
+        state = State::Header;
+    }
+}
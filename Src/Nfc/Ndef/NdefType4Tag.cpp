@@ -0,0 +1,321 @@
+/**
+ * @file NdefType4Tag.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief NFC Forum Type 4 Tag NDEF access implementation
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Nfc/Ndef/NdefType4Tag.h"
+#include "Nfc/Desfire/DesfireCard.h"
+#include "Nfc/Desfire/Commands/ReadDataCommand.h"
+#include "Nfc/Desfire/Commands/WriteDataCommand.h"
+#include "Error/DesfireError.h"
+
+using namespace nfc;
+
+namespace
+{
+    constexpr uint8_t COMM_PLAIN = 0x00U;
+    constexpr uint8_t ACCESS_GRANTED = 0x00U;
+
+    constexpr size_t CC_MIN_LENGTH = 15U;
+    constexpr uint8_t TLV_NDEF_FILE_CONTROL = 0x04U;
+    constexpr uint8_t TLV_EXTENDED_NDEF_FILE_CONTROL = 0x06U;
+
+    uint16_t readBe16(const uint8_t* data)
+    {
+        return static_cast<uint16_t>((static_cast<uint16_t>(data[0]) << 8U) | data[1]);
+    }
+
+    uint32_t readBe32(const uint8_t* data)
+    {
+        return (static_cast<uint32_t>(data[0]) << 24U) |
+               (static_cast<uint32_t>(data[1]) << 16U) |
+               (static_cast<uint32_t>(data[2]) << 8U) |
+               static_cast<uint32_t>(data[3]);
+    }
+
+    etl::expected<NdefCapabilityContainer, error::Error> parseCapabilities(const etl::ivector<uint8_t>& cc)
+    {
+        if (cc.size() < CC_MIN_LENGTH)
+        {
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
+        }
+
+        NdefCapabilityContainer result;
+        result.mappingVersion = cc[2];
+        result.maxReadLength = readBe16(&cc[3]);
+        result.maxWriteLength = readBe16(&cc[5]);
+
+        const uint8_t tag = cc[7];
+        const uint8_t length = cc[8];
+        if (tag == TLV_NDEF_FILE_CONTROL && length == 6U)
+        {
+            result.ndefFileId = readBe16(&cc[9]);
+            result.maxNdefFileSize = readBe16(&cc[11]);
+            result.readAccess = cc[13];
+            result.writeAccess = cc[14];
+        }
+        else if (tag == TLV_EXTENDED_NDEF_FILE_CONTROL && length == 8U && cc.size() >= CC_MIN_LENGTH + 2U)
+        {
+            result.ndefFileId = readBe16(&cc[9]);
+            result.maxNdefFileSize = readBe32(&cc[11]);
+            result.readAccess = cc[15];
+            result.writeAccess = cc[16];
+        }
+        else
+        {
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidResponse));
+        }
+
+        if (result.maxNdefFileSize < NdefType4Tag::NLEN_SIZE)
+        {
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidResponse));
+        }
+
+        return result;
+    }
+}
+
+NdefType4Tag::NdefType4Tag(DesfireCard& card, const NdefType4Options& options)
+    : card(card)
+    , options(options)
+    , capabilities()
+    , opened(false)
+{
+}
+
+etl::expected<NdefCapabilityContainer, error::Error> NdefType4Tag::open()
+{
+    opened = false;
+
+    auto selectResult = card.selectApplication(options.aid);
+    if (!selectResult)
+    {
+        return etl::unexpected(selectResult.error());
+    }
+
+    // Read the short CC first; the extended TLV adds two bytes.
+    ReadDataCommandOptions ccOptions;
+    ccOptions.fileNo = options.ccFileNo;
+    ccOptions.offset = 0U;
+    ccOptions.length = CC_MIN_LENGTH;
+    ccOptions.chunkSize = 0U;
+    ccOptions.communicationSettings = COMM_PLAIN;
+
+    ReadDataCommand ccCommand(ccOptions);
+    auto ccResult = card.executeCommand(ccCommand);
+    if (!ccResult)
+    {
+        return etl::unexpected(ccResult.error());
+    }
+
+    etl::vector<uint8_t, CC_MIN_LENGTH + 2U> cc;
+    cc.assign(ccCommand.getData().begin(), ccCommand.getData().end());
+    if (cc.size() == CC_MIN_LENGTH && cc[7] == TLV_EXTENDED_NDEF_FILE_CONTROL)
+    {
+        ccOptions.offset = CC_MIN_LENGTH;
+        ccOptions.length = 2U;
+        ReadDataCommand tailCommand(ccOptions);
+        auto tailResult = card.executeCommand(tailCommand);
+        if (!tailResult)
+        {
+            return etl::unexpected(tailResult.error());
+        }
+        cc.insert(cc.end(), tailCommand.getData().begin(), tailCommand.getData().end());
+    }
+
+    auto parsed = parseCapabilities(cc);
+    if (!parsed)
+    {
+        return etl::unexpected(parsed.error());
+    }
+
+    capabilities = parsed.value();
+    opened = true;
+    return capabilities;
+}
+
+etl::expected<uint32_t, error::Error> NdefType4Tag::readMessage(INdefRecordHandler& handler)
+{
+    if (!opened)
+    {
+        auto openResult = open();
+        if (!openResult)
+        {
+            return etl::unexpected(openResult.error());
+        }
+    }
+
+    if (capabilities.readAccess != ACCESS_GRANTED)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::PermissionDenied));
+    }
+
+    ReadDataCommandOptions readOptions;
+    readOptions.fileNo = options.ndefFileNo;
+    readOptions.offset = 0U;
+    readOptions.length = NLEN_SIZE;
+    readOptions.chunkSize = 0U;
+    readOptions.communicationSettings = COMM_PLAIN;
+
+    ReadDataCommand nlenCommand(readOptions);
+    auto nlenResult = card.executeCommand(nlenCommand);
+    if (!nlenResult)
+    {
+        return etl::unexpected(nlenResult.error());
+    }
+    if (nlenCommand.getData().size() != NLEN_SIZE)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
+    }
+
+    const uint32_t nlen = readBe16(nlenCommand.getData().data());
+    if (nlen > capabilities.maxNdefFileSize - NLEN_SIZE)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::BoundaryError));
+    }
+
+    // One ReadData per chunk, each fed straight into the parser, so only a
+    // single frame of the message is held at any time.
+    NdefStreamParser parser(handler);
+    const uint16_t chunkSize = readChunkSize();
+    uint32_t offset = 0U;
+    while (offset < nlen)
+    {
+        readOptions.offset = NLEN_SIZE + offset;
+        readOptions.length = ((nlen - offset) < chunkSize) ? (nlen - offset) : chunkSize;
+        readOptions.chunkSize = chunkSize;
+
+        ReadDataCommand chunkCommand(readOptions);
+        auto chunkResult = card.executeCommand(chunkCommand);
+        if (!chunkResult)
+        {
+            return etl::unexpected(chunkResult.error());
+        }
+
+        const auto& chunk = chunkCommand.getData();
+        if (chunk.size() != readOptions.length)
+        {
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::LengthError));
+        }
+
+        auto feedResult = parser.feed(chunk.data(), chunk.size());
+        if (!feedResult)
+        {
+            return etl::unexpected(feedResult.error());
+        }
+
+        offset += static_cast<uint32_t>(chunk.size());
+    }
+
+    auto finishResult = parser.finish();
+    if (!finishResult)
+    {
+        return etl::unexpected(finishResult.error());
+    }
+
+    return nlen;
+}
+
+etl::expected<void, error::Error> NdefType4Tag::writeMessage(const uint8_t* message, size_t length)
+{
+    if (message == nullptr && length != 0U)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::ParameterError));
+    }
+
+    if (!opened)
+    {
+        auto openResult = open();
+        if (!openResult)
+        {
+            return etl::unexpected(openResult.error());
+        }
+    }
+
+    if (capabilities.writeAccess != ACCESS_GRANTED)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::PermissionDenied));
+    }
+
+    // NLEN is a 16-bit field regardless of the CC's file size.
+    if (length > capabilities.maxNdefFileSize - NLEN_SIZE || length > 0xFFFFU)
+    {
+        return etl::unexpected(error::Error::fromDesfire(error::DesfireError::BoundaryError));
+    }
+
+    const uint8_t emptyLength[NLEN_SIZE] = {0x00U, 0x00U};
+    auto invalidateResult = writeFile(0U, emptyLength, NLEN_SIZE);
+    if (!invalidateResult)
+    {
+        return etl::unexpected(invalidateResult.error());
+    }
+
+    auto bodyResult = writeFile(NLEN_SIZE, message, length);
+    if (!bodyResult)
+    {
+        return etl::unexpected(bodyResult.error());
+    }
+
+    const uint8_t messageLength[NLEN_SIZE] = {
+        static_cast<uint8_t>((length >> 8U) & 0xFFU),
+        static_cast<uint8_t>(length & 0xFFU)
+    };
+    return writeFile(0U, messageLength, NLEN_SIZE);
+}
+
+etl::expected<void, error::Error> NdefType4Tag::writeFile(uint32_t offset, const uint8_t* data, size_t length)
+{
+    const uint16_t chunkSize = writeChunkSize();
+    etl::vector<uint8_t, WriteDataCommand::MAX_CHUNK_SIZE> chunk;
+
+    size_t written = 0U;
+    while (written < length)
+    {
+        const size_t take = ((length - written) < chunkSize) ? (length - written) : chunkSize;
+        chunk.assign(data + written, data + written + take);
+
+        WriteDataCommandOptions writeOptions;
+        writeOptions.fileNo = options.ndefFileNo;
+        writeOptions.offset = offset + static_cast<uint32_t>(written);
+        writeOptions.data = &chunk;
+        writeOptions.chunkSize = chunkSize;
+        writeOptions.communicationSettings = COMM_PLAIN;
+
+        WriteDataCommand command(writeOptions);
+        auto result = card.executeCommand(command);
+        if (!result)
+        {
+            return etl::unexpected(result.error());
+        }
+
+        written += take;
+    }
+
+    return {};
+}
+
+uint16_t NdefType4Tag::readChunkSize() const
+{
+    uint16_t size = (options.chunkSize != 0U) ? options.chunkSize : ReadDataCommand::MAX_CHUNK_SIZE;
+    if (capabilities.maxReadLength != 0U)
+    {
+        size = (capabilities.maxReadLength < size) ? capabilities.maxReadLength : size;
+    }
+    return (size < ReadDataCommand::MAX_CHUNK_SIZE) ? size : ReadDataCommand::MAX_CHUNK_SIZE;
+}
+
+uint16_t NdefType4Tag::writeChunkSize() const
+{
+    uint16_t size = (options.chunkSize != 0U) ? options.chunkSize : WriteDataCommand::MAX_CHUNK_SIZE;
+    if (capabilities.maxWriteLength != 0U)
+    {
+        size = (capabilities.maxWriteLength < size) ? capabilities.maxWriteLength : size;
+    }
+    return (size < WriteDataCommand::MAX_CHUNK_SIZE) ? size : WriteDataCommand::MAX_CHUNK_SIZE;
+}
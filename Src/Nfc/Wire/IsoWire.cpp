@@ -45,7 +45,7 @@ etl::vector<uint8_t, APDU_COMMAND_MAX> IsoWire::wrap(const etl::ivector<uint8_t>
     return apdu;
 }
 
-etl::expected<etl::vector<uint8_t, APDU_DATA_MAX>, error::Error> IsoWire::unwrap(const etl::ivector<uint8_t>& apdu)
+etl::expected<etl::vector<uint8_t, PDU_RESPONSE_MAX>, error::Error> IsoWire::unwrap(const etl::ivector<uint8_t>& apdu)
 {
     // ISO 7816-4 APDU unwrapping
     // Input format: [Data...][SW1][SW2]
@@ -69,7 +69,13 @@ etl::expected<etl::vector<uint8_t, APDU_DATA_MAX>, error::Error> IsoWire::unwrap
         return etl::unexpected(error::Error::fromApdu(error::ApduError::Unknown));
     }
 
-    etl::vector<uint8_t, APDU_DATA_MAX> result;
+    // [Status] plus data must fit the PDU buffer; chained responses can be longer
+    if (apdu.size() - APDU_STATUS_SIZE + 1U > PDU_RESPONSE_MAX)
+    {
+        return etl::unexpected(error::Error::fromApdu(error::ApduError::WrongLength));
+    }
+
+    etl::vector<uint8_t, PDU_RESPONSE_MAX> result;
     
     // Map ISO status to DESFire status byte
     result.push_back(sw2);  // 0x00 for success, or DESFire status code
@@ -22,10 +22,15 @@ etl::vector<uint8_t, APDU_COMMAND_MAX> NativeWire::wrap(const etl::ivector<uint8
     return result;
 }
 
-etl::expected<etl::vector<uint8_t, APDU_DATA_MAX>, error::Error> NativeWire::unwrap(const etl::ivector<uint8_t>& apdu)
+etl::expected<etl::vector<uint8_t, PDU_RESPONSE_MAX>, error::Error> NativeWire::unwrap(const etl::ivector<uint8_t>& apdu)
 {
     // TODO: Implement native unwrapping
     // Native mode typically just passes through the response
-    etl::vector<uint8_t, APDU_DATA_MAX> result(apdu.begin(), apdu.end());
+    if (apdu.size() > PDU_RESPONSE_MAX)
+    {
+        return etl::unexpected(error::Error::fromApdu(error::ApduError::WrongLength));
+    }
+
+    etl::vector<uint8_t, PDU_RESPONSE_MAX> result(apdu.begin(), apdu.end());
     return result;
 }
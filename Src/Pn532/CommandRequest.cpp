@@ -10,19 +10,25 @@
  */
 
 #include "Pn532/CommandRequest.h"
+#include "Utils/Hex.h"
+#include <cstdio>
 
 namespace pn532
 {
-    CommandRequest::CommandRequest(uint8_t cmd, const etl::ivector<uint8_t>& payloadData, uint32_t timeout, bool expectsData)
-        : commandCode(cmd), payload(payloadData.begin(), payloadData.end()), responseTimeoutMs(timeout), expectsData(expectsData)
+    CommandRequest::CommandRequest(uint8_t cmd, const etl::ivector<uint8_t>& payloadData, uint32_t timeout, bool expectsData, PrecomputedFrame frame)
+        : commandCode(cmd), payload(payloadData.begin(), payloadData.end()), responseTimeoutMs(timeout), expectsData(expectsData), fixedFrame(frame)
     {
         // TODO: Initialize command request
     }
 
     etl::string<256> CommandRequest::toString() const
     {
-        // TODO: Implement string representation
-        etl::string<256> result;
+        // e.g. "Cmd 0x4A [2 bytes]: 01 00", payload cut short when it does not fit
+        char header[32];
+        std::snprintf(header, sizeof(header), "Cmd 0x%02X [%u bytes]: ", commandCode, static_cast<unsigned>(payload.size()));
+
+        etl::string<256> result(header);
+        utils::appendHex(result, payload.data(), payload.size());
         return result;
     }
 
@@ -61,4 +67,14 @@ namespace pn532
         return expectsData;
     }
 
+    bool CommandRequest::hasPrecomputedFrame() const
+    {
+        return !fixedFrame.empty();
+    }
+
+    const PrecomputedFrame& CommandRequest::precomputedFrame() const
+    {
+        return fixedFrame;
+    }
+
 } // namespace pn532
@@ -10,6 +10,8 @@
  */
 
 #include "Pn532/CommandResponse.h"
+#include "Utils/Hex.h"
+#include <cstdio>
 
 namespace pn532
 {
@@ -21,8 +23,12 @@ namespace pn532
 
     etl::string<256> CommandResponse::toString() const
     {
-        // TODO: Implement string representation
-        etl::string<256> result;
+        // e.g. "Rsp 0x4A [2 bytes]: 01 00", payload cut short when it does not fit
+        char header[32];
+        std::snprintf(header, sizeof(header), "Rsp 0x%02X [%u bytes]: ", cmd, static_cast<unsigned>(payload.size()));
+
+        etl::string<256> result(header);
+        utils::appendHex(result, payload.data(), payload.size());
         return result;
     }
 
@@ -10,6 +10,7 @@
  */
 
 #include "Pn532/Commands/GetFirmwareVersion.h"
+#include "Pn532/Pn532PrecomputedFrames.h"
 #include "Error/Pn532Error.h"
 #include <cstdio>
 
@@ -35,9 +36,9 @@ namespace pn532
 
     CommandRequest GetFirmwareVersion::buildRequest()
     {
-        // GetFirmwareVersion command has no parameters
+        // GetFirmwareVersion command has no parameters, so the frame is fixed
         etl::vector<uint8_t, 1> payload;
-        return createCommandRequest(0x02, payload); // 0x02 = GetFirmwareVersion
+        return createPrecomputedCommandRequest(0x02, payload, PrecomputedFrame::of(frames::GET_FIRMWARE_VERSION)); // 0x02 = GetFirmwareVersion
     }
 
     etl::expected<CommandResponse, Error> GetFirmwareVersion::parseResponse(const Pn532ResponseFrame& frame)
@@ -10,6 +10,7 @@
  */
 
 #include "Pn532/Commands/GetGeneralStatus.h"
+#include "Pn532/Pn532PrecomputedFrames.h"
 #include "Error/Pn532Error.h"
 #include <cstdio>
 
@@ -38,9 +39,9 @@ namespace pn532
 
     CommandRequest GetGeneralStatus::buildRequest()
     {
-        // GetGeneralStatus command has no parameters
+        // GetGeneralStatus command has no parameters, so the frame is fixed
         etl::vector<uint8_t, 1> payload;
-        return createCommandRequest(0x04, payload); // 0x04 = GetGeneralStatus
+        return createPrecomputedCommandRequest(0x04, payload, PrecomputedFrame::of(frames::GET_GENERAL_STATUS)); // 0x04 = GetGeneralStatus
     }
 
     etl::expected<CommandResponse, Error> GetGeneralStatus::parseResponse(const Pn532ResponseFrame& frame)
@@ -10,6 +10,7 @@
  */
 
 #include "Pn532/Commands/InDataExchange.h"
+#include "Pn532/Pn532PrecomputedFrames.h"
 #include "Error/Pn532Error.h"
 
 using namespace error;
@@ -38,6 +39,13 @@ namespace pn532
             payload.push_back(options.payload[i]);
         }
         
+        // Fixed DESFire commands (GetVersion, 0xAF continuation, ...) have a precomputed frame
+        const PrecomputedFrame fixedFrame = frames::findInDataExchangeFrame(options.targetNumber, options.payload);
+        if (!fixedFrame.empty())
+        {
+            return createPrecomputedCommandRequest(0x40, payload, fixedFrame, options.responseTimeoutMs);
+        }
+        
         return createCommandRequest(0x40, payload, options.responseTimeoutMs); // 0x40 = InDataExchange
     }
 
@@ -62,12 +70,11 @@ namespace pn532
         }
         
         // Check card-level status and return PN532 error for failures
-        // Status byte 0x00 = success, anything else is an error
-        // The status byte values directly correspond to Pn532Error enum values
-        if (cachedStatusByte != 0x00)
+        // The low 6 bits are the error code (0 = success); MI and NAD are flags
+        // The error code values directly correspond to Pn532Error enum values
+        if (!isSuccess())
         {
-            Pn532Error pn532Error = static_cast<Pn532Error>(cachedStatusByte);
-            return etl::unexpected(Error::fromPn532(pn532Error));
+            return etl::unexpected(Error::fromPn532(getStatus()));
         }
         
         return createCommandResponse(frame.getCommandCode(), data);
@@ -85,14 +92,19 @@ namespace pn532
 
     Pn532Error InDataExchange::getStatus() const
     {
-        return static_cast<Pn532Error>(cachedStatusByte);
+        return static_cast<Pn532Error>(cachedStatusByte & STATUS_ERROR_MASK);
     }
 
     
 
     bool InDataExchange::isSuccess() const
     {
-        return cachedStatusByte == 0x00;
+        return (cachedStatusByte & STATUS_ERROR_MASK) == 0x00;
+    }
+
+    bool InDataExchange::hasMoreInformation() const
+    {
+        return (cachedStatusByte & STATUS_MI) != 0x00;
     }
 
     const etl::ivector<uint8_t>& InDataExchange::getResponseData() const
@@ -48,8 +48,12 @@ namespace pn532
             return etl::unexpected(Error::fromPn532(Pn532Error::InvalidResponse));
         }
 
-        // First byte is number of targets found
+        // First byte is number of targets found; the PN532 lists at most two
         uint8_t nbTargets = data[0];
+        if (nbTargets > detectedTargets.capacity())
+        {
+            return etl::unexpected(Error::fromPn532(Pn532Error::InvalidResponse));
+        }
         
         size_t index = 1;
         for (uint8_t i = 0; i < nbTargets; ++i)
@@ -141,7 +145,7 @@ namespace pn532
 
         uint8_t uidLength = data[index++];
         
-        if (index + uidLength > data.size())
+        if (uidLength > targetInfo.uid.capacity() || index + uidLength > data.size())
         {
             return false;
         }
@@ -166,7 +170,8 @@ namespace pn532
         uint8_t atsLength = data[index++];
         uint8_t dataBytes = (atsLength > 0) ? (atsLength - 1) : 0;
         
-        if (dataBytes > 0 && index + dataBytes <= data.size())
+        // An ATS longer than any card sends is left out rather than cut short
+        if (dataBytes > 0 && dataBytes <= targetInfo.ats.capacity() && index + dataBytes <= data.size())
         {
             targetInfo.ats.assign(data.begin() + index, data.begin() + index + dataBytes);
             index += dataBytes;
@@ -184,7 +189,7 @@ namespace pn532
 
         uint8_t dataLength = data[index++];
         
-        if (index + dataLength > data.size())
+        if (dataLength > targetInfo.uid.capacity() || index + dataLength > data.size())
         {
             return false;
         }
@@ -0,0 +1,63 @@
+/**
+ * @file PowerDown.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief PowerDown command implementation
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Pn532/Commands/PowerDown.h"
+#include "Error/Pn532Error.h"
+
+using namespace error;
+
+namespace pn532
+{
+    PowerDown::PowerDown(const PowerDownOptions& opts)
+        : options(opts)
+    {
+    }
+
+    etl::string_view PowerDown::name() const
+    {
+        return "PowerDown";
+    }
+
+    CommandRequest PowerDown::buildRequest()
+    {
+        // Build payload: [WakeUpEnable] [GenerateIRQ (optional)]
+        etl::vector<uint8_t, 2> payload;
+        payload.push_back(options.wakeUpEnable);
+        if (options.generateIrq)
+        {
+            payload.push_back(0x01);
+        }
+
+        return createCommandRequest(0x16, payload); // 0x16 = PowerDown
+    }
+
+    etl::expected<CommandResponse, Error> PowerDown::parseResponse(const Pn532ResponseFrame& frame)
+    {
+        // Response: [Status], 0x00 = going to sleep
+        const auto& data = frame.data();
+        if (data.empty())
+        {
+            return etl::unexpected(Error::fromPn532(Pn532Error::InvalidResponse));
+        }
+        if ((data[0] & 0x3FU) != 0x00U)
+        {
+            return etl::unexpected(Error::fromPn532(static_cast<Pn532Error>(data[0] & 0x3FU)));
+        }
+
+        return createCommandResponse(frame.getCommandCode(), data);
+    }
+
+    bool PowerDown::expectsDataFrame() const
+    {
+        return true;
+    }
+
+} // namespace pn532
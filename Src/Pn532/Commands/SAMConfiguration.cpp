@@ -10,6 +10,7 @@
  */
 
 #include "Pn532/Commands/SAMConfiguration.h"
+#include "Pn532/Pn532PrecomputedFrames.h"
 #include "Error/Pn532Error.h"
 
 using namespace error;
@@ -37,6 +38,12 @@ namespace pn532
         
         // IRQ usage (0x00 = not used, 0x01 = used)
         payload.push_back(options.useIRQ ? 0x01 : 0x00);
+
+        // Normal mode with default parameters is the common init path; send it from flash
+        if (options.mode == SamMode::Normal && options.timeout == 0x00 && !options.useIRQ)
+        {
+            return createPrecomputedCommandRequest(0x14, payload, PrecomputedFrame::of(frames::SAM_CONFIGURATION_NORMAL));
+        }
         
         return createCommandRequest(0x14, payload); // 0x14 = SAMConfiguration
     }
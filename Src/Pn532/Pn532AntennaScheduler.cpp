@@ -0,0 +1,231 @@
+/**
+ * @file Pn532AntennaScheduler.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief RF time slots for co-located PN532 readers
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Pn532/Pn532AntennaScheduler.h"
+#include "Pn532/Pn532Driver.h"
+#include "Nfc/Card/RetryPolicy.h"
+#include "Utils/Timing.h"
+
+using namespace pn532;
+
+Pn532AntennaScheduler::Pn532AntennaScheduler(const AntennaSchedulerOptions& options)
+    : options(options)
+    , metrics()
+    , readers()
+    , holder(NO_READER)
+    , cursor(0U)
+    , slotReader(NO_READER)
+    , slotKind(AntennaSlotKind::Poll)
+    , transactionReader(NO_READER)
+    , transactionStartMs(0U)
+    , lastTickMs(0U)
+{
+}
+
+etl::expected<size_t, error::Error> Pn532AntennaScheduler::addReader(Pn532Driver& driver)
+{
+    if (readers.full())
+    {
+        return etl::unexpected(error::Error::fromPn532(error::Pn532Error::InvalidParameter));
+    }
+
+    Reader reader;
+    reader.driver = &driver;
+    reader.pollBurstMs = options.minPollBurstMs;
+    readers.push_back(reader);
+
+    const size_t index = readers.size() - 1U;
+    auto switched = switchField(index, options.mode == AntennaSchedulingMode::Shared);
+    if (!switched)
+    {
+        readers.pop_back();
+        return etl::unexpected(switched.error());
+    }
+
+    lastTickMs = nowMs();
+    return index;
+}
+
+etl::expected<AntennaSlot, error::Error> Pn532AntennaScheduler::nextSlot()
+{
+    if (readers.empty())
+    {
+        return etl::unexpected(error::Error::fromPn532(error::Pn532Error::InvalidDeviceState));
+    }
+
+    const uint32_t now = nowMs();
+    accountOverlap(now);
+
+    // A poll burst that found nothing: this reader is quiet, poll it for less time
+    if (slotKind == AntennaSlotKind::Poll && slotReader != NO_READER)
+    {
+        Reader& quiet = readers[slotReader];
+        quiet.pollBurstMs -= quiet.pollBurstMs / 4U;
+        if (quiet.pollBurstMs < options.minPollBurstMs)
+        {
+            quiet.pollBurstMs = options.minPollBurstMs;
+        }
+    }
+
+    if (transactionReader != NO_READER)
+    {
+        const uint32_t held = now - transactionStartMs;
+        if (held < options.transactionLimitMs)
+        {
+            ++metrics.transactionSlots;
+            slotReader = transactionReader;
+            slotKind = AntennaSlotKind::Transaction;
+
+            AntennaSlot slot;
+            slot.reader = transactionReader;
+            slot.kind = AntennaSlotKind::Transaction;
+            slot.budgetMs = options.transactionLimitMs - held;
+            return slot;
+        }
+
+        ++metrics.transactionsRevoked;
+        transactionReader = NO_READER;
+    }
+
+    const size_t reader = cursor;
+    if (options.mode == AntennaSchedulingMode::Exclusive)
+    {
+        auto switched = giveFieldTo(reader);
+        if (!switched)
+        {
+            slotReader = NO_READER;
+            return etl::unexpected(switched.error());
+        }
+    }
+    cursor = (cursor + 1U) % readers.size();
+
+    ++metrics.pollSlots;
+    slotReader = reader;
+    slotKind = AntennaSlotKind::Poll;
+
+    AntennaSlot slot;
+    slot.reader = reader;
+    slot.kind = AntennaSlotKind::Poll;
+    slot.budgetMs = readers[reader].pollBurstMs;
+    return slot;
+}
+
+etl::expected<void, error::Error> Pn532AntennaScheduler::beginTransaction(size_t reader)
+{
+    if (reader != slotReader || slotKind != AntennaSlotKind::Poll || transactionReader != NO_READER)
+    {
+        return etl::unexpected(error::Error::fromPn532(error::Pn532Error::InvalidDeviceState));
+    }
+
+    transactionReader = reader;
+    transactionStartMs = nowMs();
+    slotKind = AntennaSlotKind::Transaction;
+    ++metrics.transactions;
+
+    // Cards keep coming here: give this reader longer bursts
+    Reader& busy = readers[reader];
+    busy.pollBurstMs *= 2U;
+    if (busy.pollBurstMs > options.maxPollBurstMs)
+    {
+        busy.pollBurstMs = options.maxPollBurstMs;
+    }
+    return {};
+}
+
+void Pn532AntennaScheduler::endTransaction(size_t reader)
+{
+    if (reader == transactionReader)
+    {
+        transactionReader = NO_READER;
+    }
+}
+
+void Pn532AntennaScheduler::recordSuccess()
+{
+    ++metrics.exchanges;
+}
+
+void Pn532AntennaScheduler::recordFailure(const error::Error& error)
+{
+    ++metrics.exchanges;
+    if (nfc::RetryPolicy::classifyCardError(error, false) == nfc::RetryAction::RestartCommand)
+    {
+        ++metrics.rfErrors;
+    }
+}
+
+const AntennaSchedulerMetrics& Pn532AntennaScheduler::getMetrics() const
+{
+    return metrics;
+}
+
+etl::expected<void, error::Error> Pn532AntennaScheduler::giveFieldTo(size_t reader)
+{
+    if (holder == reader)
+    {
+        return {};
+    }
+
+    // Off before on: two fields are never on together
+    if (holder != NO_READER)
+    {
+        auto off = switchField(holder, false);
+        if (!off)
+        {
+            return off;
+        }
+        holder = NO_READER;
+    }
+
+    auto on = switchField(reader, true);
+    if (!on)
+    {
+        return on;
+    }
+    holder = reader;
+    return {};
+}
+
+etl::expected<void, error::Error> Pn532AntennaScheduler::switchField(size_t reader, bool on)
+{
+    auto result = readers[reader].driver->setRfField(on);
+    if (!result)
+    {
+        ++metrics.fieldSwitchFailures;
+        return result;
+    }
+
+    readers[reader].fieldOn = on;
+    ++metrics.fieldSwitches;
+    return {};
+}
+
+void Pn532AntennaScheduler::accountOverlap(uint32_t now)
+{
+    size_t fieldsOn = 0U;
+    for (const auto& reader : readers)
+    {
+        if (reader.fieldOn)
+        {
+            ++fieldsOn;
+        }
+    }
+    if (fieldsOn > 1U)
+    {
+        metrics.overlapMs += now - lastTickMs;
+    }
+    lastTickMs = now;
+}
+
+uint32_t Pn532AntennaScheduler::nowMs() const
+{
+    return (options.clock != nullptr) ? options.clock() : utils::get_tick_ms();
+}
@@ -12,6 +12,8 @@
 #include "Pn532/Pn532ApduAdapter.h"
 #include "Pn532/Commands/InListPassiveTarget.h"
 #include "Pn532/Commands/InDataExchange.h"
+#include "Pn532/Commands/PerformSelfTest.h"
+#include "Pn532/Commands/RFConfiguration.h"
 #include "Pn532/Pn532Driver.h"
 #include "Nfc/Wire/IWire.h"
 #include "Utils/Logging.h"
@@ -23,7 +25,7 @@ namespace pn532
 {
 
     Pn532ApduAdapter::Pn532ApduAdapter(Pn532Driver &driver)
-        : driver(driver), activeWire(nullptr)
+        : driver(driver), activeWire(nullptr), powerSaving(), powerSavingMetrics()
     {
         LOG_INFO("Pn532ApduAdapter initialized");
     }
@@ -34,7 +36,7 @@ namespace pn532
         LOG_INFO("Wire protocol configured for adapter");
     }
 
-    etl::expected<etl::vector<uint8_t, buffer::APDU_DATA_MAX>, error::Error> Pn532ApduAdapter::transceive(
+    etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> Pn532ApduAdapter::transceive(
         const etl::ivector<uint8_t> &apdu)
     {
         if (!activeWire)
@@ -58,24 +60,52 @@ namespace pn532
             opts.payload.push_back(byte);
         }
 
-        InDataExchange cmd(opts);
-        auto result = driver.executeCommand(cmd);
-
-        if (!result)
+        // Collect the card response; when the PN532 sets MI the answer continues
+        // in further rounds, which are sent straight away with an empty DataOut.
+        etl::vector<uint8_t, buffer::APDU_RESPONSE_MAX> responseData;
+        for (;;)
         {
-            LOG_ERROR("InDataExchange failed");
-            return etl::unexpected(result.error());
-        }
-
-        // Check if the exchange was successful at PN532 level
-        if (!cmd.isSuccess())
-        {
-            LOG_ERROR("InDataExchange status error: 0x%02X", cmd.getStatusByte());
-            return etl::unexpected(error::Error::fromPn532(cmd.getStatus()));
+            InDataExchange cmd(opts);
+            auto result = driver.executeCommand(cmd);
+
+            if (!result)
+            {
+                LOG_ERROR("InDataExchange failed");
+                return etl::unexpected(result.error());
+            }
+
+            // Check if the exchange was successful at PN532 level
+            if (!cmd.isSuccess())
+            {
+                LOG_ERROR("InDataExchange status error: 0x%02X", cmd.getStatusByte());
+                return etl::unexpected(error::Error::fromPn532(cmd.getStatus()));
+            }
+
+            const auto& fragment = cmd.getResponseData();
+            if (fragment.size() > responseData.available())
+            {
+                LOG_ERROR("Chained response exceeds %zu bytes", responseData.capacity());
+                return etl::unexpected(error::Error::fromPn532(Pn532Error::BufferSizeInsufficient));
+            }
+            responseData.insert(responseData.end(), fragment.begin(), fragment.end());
+
+            if (!cmd.hasMoreInformation())
+            {
+                break;
+            }
+
+            // An empty fragment with MI set would never make progress
+            if (fragment.empty())
+            {
+                LOG_ERROR("MI set on empty InDataExchange response");
+                return etl::unexpected(error::Error::fromPn532(Pn532Error::InvalidResponse));
+            }
+
+            LOG_INFO("MI set, fetching next fragment (%zu bytes so far)", responseData.size());
+            opts.payload.clear();
         }
 
         // Get raw card response and unwrap using configured wire protocol
-        const auto& responseData = cmd.getResponseData();
         LOG_HEX("DEBUG", "Card RX (raw)", responseData.data(), responseData.size());
         
         // Wire unwraps protocol-specific framing to normalized PDU: [Status][Data...]
@@ -127,13 +157,18 @@ namespace pn532
             cardInfo.atqa = target.atqa;
             cardInfo.sak = target.sak;
             cardInfo.ats = target.ats;
-            cardInfo.detectType(); // Detect card type based on ATQA/SAK
+            cardInfo.detectType(); // Card type from ATQA/SAK, capabilities from the ATS
 
             return cardInfo;
         }
 
         LOG_WARN("No card detected");
 
+        if (powerSaving.enabled)
+        {
+            sleepUntilNextDetection();
+        }
+
         return {};
     }
 
@@ -141,22 +176,20 @@ namespace pn532
     {
         LOG_INFO("Checking if card is present");
 
-        // Quick check: Send InDataExchange with minimal data to target 1
-        // If the command succeeds, card is present
-        // If it fails (timeout, card disappeared, etc.), card is not present
-        InDataExchangeOptions opts;
-        opts.targetNumber = 1;        // Target from last detectCard()
-        opts.payload = {0x00};        // Minimal payload
+        // Diagnose CardPresence (NumTst 0x06): the PN532 checks the target
+        // it activated last without sending an application command, so a
+        // running DESFire session and its IV stay untouched
+        SelfTestOptions opts;
+        opts.test = TestType::CardPresence;
         opts.responseTimeoutMs = 500; // Quick timeout (500ms)
 
-        InDataExchange cmd(opts);
+        PerformSelfTest cmd(opts);
         auto result = driver.executeCommand(cmd);
 
-        // Command success = card present and responding
-        // Command failure = card not present or not responding
-        if (result.has_value())
+        // Response: [Status], 0x00 = target still answers
+        if (result.has_value() && !result.value().data().empty() && result.value().data()[0] == 0x00U)
         {
-            LOG_INFO("Card present (successful exchange)");
+            LOG_INFO("Card present");
             return true;
         }
         else
@@ -166,4 +199,48 @@ namespace pn532
         }
     }
 
+    etl::expected<void, error::Error> Pn532ApduAdapter::setPowerSaving(const PowerSavingOptions &options)
+    {
+        // MxRtyATR and MxRtyPSL stay at their defaults; 0xFF passive retries waits for a card
+        const uint8_t passiveRetries = options.enabled ? options.passiveRetries : 0xFFU;
+        RFConfiguration cmd(RFConfigurationOptions{
+            .item = RFConfigItem::MaxRetries,
+            .configData = {0xFFU, 0x01U, passiveRetries}
+        });
+
+        auto result = driver.executeCommand(cmd);
+        if (!result)
+        {
+            LOG_ERROR("Setting passive activation retries failed");
+            return etl::unexpected(result.error());
+        }
+
+        powerSaving = options;
+        return {};
+    }
+
+    const PowerSavingMetrics &Pn532ApduAdapter::getPowerSavingMetrics() const
+    {
+        return powerSavingMetrics;
+    }
+
+    void Pn532ApduAdapter::sleepUntilNextDetection()
+    {
+        PowerDownOptions opts;
+        opts.wakeUpEnable = powerSaving.wakeUpEnable;
+
+        auto result = driver.powerDown(opts);
+        if (!result)
+        {
+            ++powerSavingMetrics.powerDownFailures;
+            return;
+        }
+
+        ++powerSavingMetrics.sleeps;
+        if (driver.waitForWakeUp(powerSaving.sleepMs))
+        {
+            ++powerSavingMetrics.earlyWakeUps;
+        }
+    }
+
 } // namespace pn532
\ No newline at end of file
@@ -15,13 +15,31 @@
 #include "Pn532/Commands/SAMConfiguration.h"
 #include "Pn532/Commands/RFConfiguration.h"
 #include "Pn532/Commands/SetSerialBaudRate.h"
+#include "Pn532/Commands/PowerDown.h"
+#include <cstring>
 
 using namespace error;
 using namespace pn532;
 
+namespace
+{
+    /**
+     * @brief Frame to send for a request: its compile-time frame, or a freshly built one
+     */
+    etl::expected<etl::vector<uint8_t, nfc::buffer::PN532_FRAME_MAX>, Error> requestFrame(const CommandRequest &request)
+    {
+        if (request.hasPrecomputedFrame())
+        {
+            const PrecomputedFrame &fixedFrame = request.precomputedFrame();
+            return etl::vector<uint8_t, nfc::buffer::PN532_FRAME_MAX>(fixedFrame.bytes, fixedFrame.bytes + fixedFrame.length);
+        }
+        return Pn532RequestFrame::build(request);
+    }
+}
+
 // Constructor
 Pn532Driver::Pn532Driver(comms::IHardwareBus &bus)
-    : bus(bus)
+    : bus(bus), retryPolicy(nullptr), poweredDown(false)
 {
 }
 
@@ -65,8 +83,8 @@ etl::expected<Pn532ResponseFrame, Error> Pn532Driver::transceive(const CommandRe
     const uint32_t responseTimeout = request.timeoutMs();
     LOG_INFO("Transceive using timeout: %u ms", responseTimeout);
     
-    // 0. Build PN532 frame from request
-    auto frameResult = Pn532RequestFrame::build(request);
+    // 0. Build PN532 frame from request (fixed commands carry a compile-time frame)
+    auto frameResult = requestFrame(request);
     if (!frameResult)
     {
         LOG_ERROR("Failed to build PN532 frame");
@@ -74,8 +92,102 @@ etl::expected<Pn532ResponseFrame, Error> Pn532Driver::transceive(const CommandRe
     }
 
     const auto &frame = frameResult.value();
+
     LOG_HEX("INFO", "Sending frame", frame.data(), frame.size());
 
+    // 1-4. Send the command and wait for the ACK. Only when nothing at all
+    // came back has the PN532 not accepted the frame, so only then can it be
+    // sent again without running the command twice. A garbled or partial ACK
+    // means the command may already be running: fail instead.
+    uint8_t resends = 0;
+    for (;;)
+    {
+        auto ackResult = sendAndReadAck(frame);
+        if (ackResult)
+        {
+            break;
+        }
+
+        const bool nothingReceived = ackResult.error().is<Pn532Error>() &&
+                                     ackResult.error().get<Pn532Error>() == Pn532Error::Timeout;
+        if (retryPolicy == nullptr || !nothingReceived)
+        {
+            return etl::unexpected(ackResult.error());
+        }
+        if (!retryPolicy->allows(nfc::RetryAction::ResendFrame, resends))
+        {
+            retryPolicy->recordExhausted();
+            return etl::unexpected(ackResult.error());
+        }
+
+        LOG_WARN("No ACK, resending frame (attempt %u)", static_cast<unsigned>(resends + 1));
+        retryPolicy->recordAttempt(nfc::RetryAction::ResendFrame);
+        ++resends;
+        bus.flush();
+    }
+
+    // 5. Check if command expects a data frame response
+    // Some commands (like EchoBack) only expect ACK, no data frame
+    if (!request.expectsDataFrame())
+    {
+        LOG_INFO("Command does not expect data frame, returning empty response");
+        // Create an empty response frame (command code will be validated by parseResponse)
+        etl::vector<uint8_t, Pn532ResponseFrame::MaxPayloadSize> emptyPayload;
+        if (resends > 0 && retryPolicy != nullptr)
+        {
+            retryPolicy->recordRecovered();
+        }
+        return Pn532ResponseFrame(request.getCommandCode() + protocol::RESPONSE_CODE_OFFSET, emptyPayload);
+    }
+
+    // 6-8. Read the response. A corrupted frame is answered with a NACK,
+    // which makes the PN532 repeat its last response without touching the card.
+    uint8_t repeats = 0;
+    for (;;)
+    {
+        auto responseResult = readResponseFrame(request);
+        if (responseResult)
+        {
+            if ((resends > 0 || repeats > 0) && retryPolicy != nullptr)
+            {
+                retryPolicy->recordRecovered();
+            }
+            return responseResult;
+        }
+
+        const bool corrupted = responseResult.error().is<Pn532Error>() &&
+                               responseResult.error().get<Pn532Error>() == Pn532Error::FrameCheckFailed;
+        if (retryPolicy == nullptr || !corrupted)
+        {
+            return etl::unexpected(responseResult.error());
+        }
+        if (!retryPolicy->allows(nfc::RetryAction::RepeatResponse, repeats))
+        {
+            retryPolicy->recordExhausted();
+            return etl::unexpected(responseResult.error());
+        }
+
+        LOG_WARN("Corrupted response frame, sending NACK (attempt %u)", static_cast<unsigned>(repeats + 1));
+        retryPolicy->recordAttempt(nfc::RetryAction::RepeatResponse);
+        ++repeats;
+        bus.flush();
+
+        etl::vector<uint8_t, 6> nack(NACK_FRAME.begin(), NACK_FRAME.end());
+        auto nackResult = bus.write(nack);
+        if (!nackResult)
+        {
+            return etl::unexpected(nackResult.error());
+        }
+    }
+}
+
+void Pn532Driver::setRetryPolicy(nfc::RetryPolicy* policy)
+{
+    retryPolicy = policy;
+}
+
+etl::expected<void, Error> Pn532Driver::sendAndReadAck(const etl::ivector<uint8_t> &frame)
+{
     // 1. Send the command
     auto sendResult = this->sendCommand(frame);
     if (!sendResult)
@@ -109,18 +221,13 @@ etl::expected<Pn532ResponseFrame, Error> Pn532Driver::transceive(const CommandRe
         return etl::unexpected(Error::fromPn532(Pn532Error::InvalidAckFrame));
     }
 
-    // 5. Check if command expects a data frame response
-    // Some commands (like EchoBack) only expect ACK, no data frame
-    if (!request.expectsDataFrame())
-    {
-        LOG_INFO("Command does not expect data frame, returning empty response");
-        // Create an empty response frame (command code will be validated by parseResponse)
-        etl::vector<uint8_t, Pn532ResponseFrame::MaxPayloadSize> emptyPayload;
-        return Pn532ResponseFrame(request.getCommandCode() + protocol::RESPONSE_CODE_OFFSET, emptyPayload);
-    }
+    return {};
+}
 
+etl::expected<Pn532ResponseFrame, Error> Pn532Driver::readResponseFrame(const CommandRequest &request)
+{
     // 6. Wait for the rest of the response frame (use command-specific timeout)
-    if (!waitForChip(responseTimeout))
+    if (!waitForChip(request.timeoutMs()))
     {
         LOG_ERROR("Timeout waiting for PN532 response frame");
         return etl::unexpected(Error::fromPn532(Pn532Error::Timeout));
@@ -145,7 +252,7 @@ etl::expected<Pn532ResponseFrame, Error> Pn532Driver::transceive(const CommandRe
 
     // Read up to the available bytes or max frame size, whichever is smaller
     size_t bytesToRead = (availableBytes < nfc::buffer::PN532_FRAME_MAX) ? availableBytes : nfc::buffer::PN532_FRAME_MAX;
-    result = bus.read(responseFrame, bytesToRead);
+    auto result = bus.read(responseFrame, bytesToRead);
     
     if (!result)
     {
@@ -354,8 +461,59 @@ etl::expected<void, Error> Pn532Driver::setSamConfiguration(uint8_t mode)
 
 etl::expected<void, Error> Pn532Driver::setRfField(const bool state)
 {
-    // TODO: Implement set RF field
-    return etl::unexpected(Error::fromPn532(Pn532Error::Timeout));
+    // Bit 0 switches the field, bit 1 (AutoRFCA) stays off: no external-field
+    // check before switching on. Not logged, antenna scheduling toggles this often.
+    RFConfiguration cmd(RFConfigurationOptions{
+        .item = RFConfigItem::RFField,
+        .configData = {static_cast<uint8_t>(state ? 0x01U : 0x00U)}
+    });
+
+    auto result = executeCommand(cmd);
+    if (!result.has_value())
+    {
+        LOG_ERROR("Set RF field failed");
+        return etl::unexpected(result.error());
+    }
+
+    return {};
+}
+
+etl::expected<void, Error> Pn532Driver::powerDown(const PowerDownOptions &options)
+{
+    LOG_INFO("Powering down, wake-up sources: 0x%02X", options.wakeUpEnable);
+
+    PowerDown cmd(options);
+    auto result = executeCommand(cmd);
+    if (!result.has_value())
+    {
+        LOG_ERROR("PowerDown failed");
+        return etl::unexpected(result.error());
+    }
+
+    poweredDown = true;
+    return {};
+}
+
+bool Pn532Driver::waitForWakeUp(const uint32_t timeoutMs)
+{
+    // A blocking read instead of waitForChip()'s polling: the host sleeps in
+    // the bus until the chip sends something or the time is up
+    auto previousTimeout = bus.getProperty(comms::BusProperty::Timeout);
+    if (!previousTimeout || !bus.setProperty(comms::BusProperty::Timeout, timeoutMs))
+    {
+        utils::delay_ms(timeoutMs);
+        return bus.available() > 0;
+    }
+
+    etl::vector<uint8_t, 1> buffer;
+    auto result = bus.read(buffer, buffer.capacity());
+    bus.setProperty(comms::BusProperty::Timeout, previousTimeout.value());
+    return result.has_value() && result.value() > 0;
+}
+
+bool Pn532Driver::isPoweredDown() const
+{
+    return poweredDown;
 }
 
 etl::expected<void, Error> Pn532Driver::setMaxRetries(const uint8_t maxRetries)
@@ -438,6 +596,21 @@ uint32_t Pn532Driver::calculateChecksum(const etl::ivector<uint8_t> &data)
 
 etl::expected<void, Error> Pn532Driver::sendCommand(const etl::ivector<uint8_t> &data)
 {
+    if (poweredDown)
+    {
+        // Preamble and frame in one write: the chip is listening by the time
+        // the frame starts, no separate wake-up round trip before the first command
+        etl::vector<uint8_t, HSU_WAKE_PREAMBLE.size() + nfc::buffer::PN532_FRAME_MAX> wakeAndFrame(
+            HSU_WAKE_PREAMBLE.begin(), HSU_WAKE_PREAMBLE.end());
+        wakeAndFrame.insert(wakeAndFrame.end(), data.begin(), data.end());
+        auto written = bus.write(wakeAndFrame);
+        if (written)
+        {
+            poweredDown = false;
+        }
+        return written;
+    }
+
     auto result = this->wakeUp(); // Wake up the PN532
     if (!result)
     {
@@ -515,49 +688,56 @@ etl::expected<Pn532ResponseFrame, Error> Pn532Driver::parseResponseFrame(
     const etl::ivector<uint8_t> &frame,
     uint8_t sentCommandCode)
 {
-    // 1. Search for the 0x00 0x00 0xFF start sequence
-    bool foundStartSequence = false;
+    // 1. Search for the 0x00 0x00 0xFF start sequence followed by a valid LEN/LCS pair.
+    // Candidates whose header does not check out (line noise, an ACK) are skipped, so
+    // the scan stays linear in the buffer size however much garbage precedes the frame.
     size_t index = 0;
+    uint8_t packetLength = 0;
+    bool foundStartSequence = false;
+    bool foundFrame = false;
 
-    for (size_t i = 0; i + 2 < frame.size(); i++)
+    for (size_t from = 0; !foundFrame && from + 2 < frame.size();)
     {
-        if (frame[i] == 0x00 && frame[i + 1] == 0x00 && frame[i + 2] == 0xFF)
+        // memchr for the 0xFF of the start code, then look back for the two zeros
+        const void *hit = std::memchr(frame.data() + from + 2, 0xFF, frame.size() - from - 2);
+        if (hit == nullptr)
         {
-            index = i;
-            foundStartSequence = true;
             break;
         }
-    }
-
-    if (!foundStartSequence)
-    {
-        LOG_ERROR("Start sequence 0x00 0x00 0xFF not found in buffer");
-        return etl::unexpected(Error::fromPn532(Pn532Error::FrameCheckFailed));
-    }
+        const size_t ff = static_cast<size_t>(static_cast<const uint8_t *>(hit) - frame.data());
+        from = ff - 1;
+        if (frame[ff - 1] != 0x00 || frame[ff - 2] != 0x00)
+        {
+            continue;
+        }
 
-    // Skip past preamble and start code
-    index += 3;
+        foundStartSequence = true;
+        if (ff + 2 >= frame.size())
+        {
+            break;
+        }
 
-    // 2. Check we have enough bytes for length and length checksum
-    if (index + 2 > frame.size())
-    {
-        LOG_ERROR("Frame too short for length bytes");
-        return etl::unexpected(Error::fromPn532(Pn532Error::FrameCheckFailed));
+        // 2-4. Packet length must cover TFI and command code, LEN + LCS must equal 0x00
+        const uint8_t length = frame[ff + 1];
+        const uint8_t lengthChecksum = frame[ff + 2];
+        if (length >= 2 && length <= nfc::buffer::PN532_DATA_MAX &&
+            static_cast<uint8_t>(length + lengthChecksum) == 0x00)
+        {
+            packetLength = length;
+            index = ff + 3;
+            foundFrame = true;
+        }
     }
 
-    // 3. Extract and validate packet length
-    uint8_t packetLength = frame[index++];
-    if (packetLength == 0 || packetLength > nfc::buffer::PN532_DATA_MAX)
+    if (!foundStartSequence)
     {
-        LOG_ERROR("Invalid packet length: %u", packetLength);
+        LOG_ERROR("Start sequence 0x00 0x00 0xFF not found in buffer");
         return etl::unexpected(Error::fromPn532(Pn532Error::FrameCheckFailed));
     }
 
-    // 4. Validate length checksum (LEN + LCS should equal 0x00)
-    uint8_t lengthChecksum = frame[index++];
-    if (static_cast<uint8_t>(packetLength + lengthChecksum) != 0x00)
+    if (!foundFrame)
     {
-        LOG_ERROR("Invalid length checksum");
+        LOG_ERROR("No start sequence with a valid length in buffer");
         return etl::unexpected(Error::fromPn532(Pn532Error::FrameCheckFailed));
     }
 
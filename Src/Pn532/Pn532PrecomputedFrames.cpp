@@ -0,0 +1,75 @@
+/**
+ * @file Pn532PrecomputedFrames.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Lookup of compile-time built PN532 frames
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include "Pn532/Pn532PrecomputedFrames.h"
+
+using namespace pn532;
+
+namespace
+{
+    // Sanity checks against hand-verified frames
+    static_assert(frames::GET_FIRMWARE_VERSION.size() == 9U, "GetFirmwareVersion frame size");
+    static_assert(frames::SAM_CONFIGURATION_NORMAL.size() == 12U, "SAMConfiguration frame size");
+    static_assert(frames::DESFIRE_ISO_GET_VERSION.size() == 15U, "ISO GetVersion exchange frame size");
+    static_assert(frames::DESFIRE_NATIVE_GET_VERSION.size() == 11U, "Native GetVersion exchange frame size");
+
+    PrecomputedFrame findIsoFrame(uint8_t ins)
+    {
+        switch (ins)
+        {
+            case 0x60: return PrecomputedFrame::of(frames::DESFIRE_ISO_GET_VERSION);
+            case 0x6A: return PrecomputedFrame::of(frames::DESFIRE_ISO_GET_APPLICATION_IDS);
+            case 0x6E: return PrecomputedFrame::of(frames::DESFIRE_ISO_FREE_MEMORY);
+            case 0x6F: return PrecomputedFrame::of(frames::DESFIRE_ISO_GET_FILE_IDS);
+            case 0xAF: return PrecomputedFrame::of(frames::DESFIRE_ISO_ADDITIONAL_FRAME);
+            default: return PrecomputedFrame{};
+        }
+    }
+
+    PrecomputedFrame findNativeFrame(uint8_t ins)
+    {
+        switch (ins)
+        {
+            case 0x60: return PrecomputedFrame::of(frames::DESFIRE_NATIVE_GET_VERSION);
+            case 0x6A: return PrecomputedFrame::of(frames::DESFIRE_NATIVE_GET_APPLICATION_IDS);
+            case 0x6E: return PrecomputedFrame::of(frames::DESFIRE_NATIVE_FREE_MEMORY);
+            case 0x6F: return PrecomputedFrame::of(frames::DESFIRE_NATIVE_GET_FILE_IDS);
+            case 0xAF: return PrecomputedFrame::of(frames::DESFIRE_NATIVE_ADDITIONAL_FRAME);
+            default: return PrecomputedFrame{};
+        }
+    }
+}
+
+PrecomputedFrame frames::findInDataExchangeFrame(uint8_t targetNumber, const etl::ivector<uint8_t>& dataOut)
+{
+    if (targetNumber != DESFIRE_TARGET)
+    {
+        return PrecomputedFrame{};
+    }
+
+    // Native: [INS]
+    if (dataOut.size() == 1U)
+    {
+        return findNativeFrame(dataOut[0]);
+    }
+
+    // ISO: 90 INS 00 00 00 (no Lc, Le = 0)
+    if (dataOut.size() == 5U &&
+        dataOut[0] == 0x90 &&
+        dataOut[2] == 0x00 &&
+        dataOut[3] == 0x00 &&
+        dataOut[4] == 0x00)
+    {
+        return findIsoFrame(dataOut[1]);
+    }
+
+    return PrecomputedFrame{};
+}
@@ -31,7 +31,7 @@ namespace rc522
         LOG_ERROR("RC522 setWire not implemented");
     }
 
-    etl::expected<etl::vector<uint8_t, buffer::APDU_DATA_MAX>, error::Error> Rc522ApduAdapter::transceive(
+    etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> Rc522ApduAdapter::transceive(
         const etl::ivector<uint8_t> &apdu)
     {
         LOG_ERROR("RC522 APDU transceive not implemented");
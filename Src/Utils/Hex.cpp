@@ -0,0 +1,165 @@
+/**
+ * @file Hex.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Table-driven hex encoding and decoding
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Utils/Hex.h"
+#include <etl/array.h>
+#include <cstring>
+
+namespace
+{
+    using DigitPairs = etl::array<char, 512>;
+    using NibbleTable = etl::array<int8_t, 256>;
+
+    constexpr DigitPairs makeDigitPairs()
+    {
+        constexpr char DIGITS[] = "0123456789ABCDEF";
+        DigitPairs pairs{};
+        for (size_t i = 0U; i < 256U; ++i)
+        {
+            pairs[i * 2U] = DIGITS[i >> 4];
+            pairs[(i * 2U) + 1U] = DIGITS[i & 0x0FU];
+        }
+        return pairs;
+    }
+
+    constexpr NibbleTable makeNibbles()
+    {
+        NibbleTable nibbles{};
+        for (size_t i = 0U; i < 256U; ++i)
+        {
+            nibbles[i] = -1;
+        }
+        for (int8_t i = 0; i < 10; ++i)
+        {
+            nibbles['0' + i] = i;
+        }
+        for (int8_t i = 0; i < 6; ++i)
+        {
+            nibbles['A' + i] = static_cast<int8_t>(10 + i);
+            nibbles['a' + i] = static_cast<int8_t>(10 + i);
+        }
+        return nibbles;
+    }
+
+    // Both digits of every byte value, and the value of every character (-1: not a digit)
+    constexpr DigitPairs DIGIT_PAIRS = makeDigitPairs();
+    constexpr NibbleTable NIBBLES = makeNibbles();
+
+    inline int8_t nibble(char c)
+    {
+        return NIBBLES[static_cast<uint8_t>(c)];
+    }
+}
+
+namespace utils
+{
+    size_t hexEncode(const uint8_t* data, size_t length, char* out, char separator)
+    {
+        if (length == 0U)
+        {
+            return 0U;
+        }
+
+        char* cursor = out;
+        if (separator == '\0')
+        {
+            for (size_t i = 0U; i < length; ++i)
+            {
+                std::memcpy(cursor, &DIGIT_PAIRS[data[i] * 2U], 2U);
+                cursor += 2;
+            }
+            return static_cast<size_t>(cursor - out);
+        }
+
+        std::memcpy(cursor, &DIGIT_PAIRS[data[0] * 2U], 2U);
+        cursor += 2;
+        for (size_t i = 1U; i < length; ++i)
+        {
+            *cursor++ = separator;
+            std::memcpy(cursor, &DIGIT_PAIRS[data[i] * 2U], 2U);
+            cursor += 2;
+        }
+        return static_cast<size_t>(cursor - out);
+    }
+
+    void appendHex(etl::istring& text, const uint8_t* data, size_t length, char separator)
+    {
+        const bool separated = (separator != '\0');
+        const size_t room = text.available();
+
+        // Whole bytes that fit, counting the separator before each one but the first
+        size_t fits = separated ? (room + 1U) / 3U : room / 2U;
+        if (fits > length)
+        {
+            fits = length;
+        }
+
+        const size_t start = text.size();
+        const size_t added = hexEncodedLength(fits, separated);
+        text.resize(start + added);
+        hexEncode(data, fits, text.data() + start, separator);
+    }
+
+    bool hexDecode(const char* text, size_t length, uint8_t* out, size_t capacity, size_t& outLength)
+    {
+        if ((length % 2U) != 0U || (length / 2U) > capacity)
+        {
+            return false;
+        }
+
+        for (size_t i = 0U; i < length; i += 2U)
+        {
+            const int8_t high = nibble(text[i]);
+            const int8_t low = nibble(text[i + 1U]);
+            if ((high | low) < 0)
+            {
+                return false;
+            }
+            out[i / 2U] = static_cast<uint8_t>((high << 4) | low);
+        }
+
+        outLength = length / 2U;
+        return true;
+    }
+
+    bool hexDecodeLoose(const char* text, size_t length, uint8_t* out, size_t capacity, size_t& outLength)
+    {
+        size_t decoded = 0U;
+        int8_t high = -1;
+        for (size_t i = 0U; i < length; ++i)
+        {
+            const int8_t value = nibble(text[i]);
+            if (value < 0)
+            {
+                continue;
+            }
+            if (high < 0)
+            {
+                high = value;
+                continue;
+            }
+            if (decoded == capacity)
+            {
+                return false;
+            }
+            out[decoded++] = static_cast<uint8_t>((high << 4) | value);
+            high = -1;
+        }
+
+        if (high >= 0)
+        {
+            return false;
+        }
+        outLength = decoded;
+        return true;
+    }
+
+} // namespace utils
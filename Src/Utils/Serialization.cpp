@@ -0,0 +1,50 @@
+/**
+ * @file Serialization.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Table-driven CRC32 for persisted binary images
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Utils/Serialization.h"
+#include <etl/array.h>
+
+namespace
+{
+    using CrcTable = etl::array<uint32_t, 256>;
+
+    constexpr CrcTable makeCrcTable()
+    {
+        CrcTable table{};
+        for (uint32_t i = 0U; i < 256U; ++i)
+        {
+            uint32_t crc = i;
+            for (uint8_t bit = 0U; bit < 8U; ++bit)
+            {
+                crc = (crc & 1U) ? ((crc >> 1U) ^ 0xEDB88320U) : (crc >> 1U);
+            }
+            table[i] = crc;
+        }
+        return table;
+    }
+
+    // CRC of every byte value, one lookup per input byte
+    constexpr CrcTable CRC_TABLE = makeCrcTable();
+}
+
+namespace utils
+{
+    uint32_t crc32(const uint8_t* data, size_t length, uint32_t previous)
+    {
+        uint32_t crc = ~previous;
+        for (size_t i = 0U; i < length; ++i)
+        {
+            crc = CRC_TABLE[(crc ^ data[i]) & 0xFFU] ^ (crc >> 8U);
+        }
+        return ~crc;
+    }
+
+} // namespace utils
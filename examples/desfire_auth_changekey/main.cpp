@@ -6,13 +6,10 @@
  *   desfire_auth_changekey_example COM5 --auth-key-hex 00000000000000000000000000000000 --new-key-hex 00112233445566778899AABBCCDDEEFF --confirm-change
  */
 
-#include <cctype>
 #include <cstdint>
 #include <cstdlib>
-#include <iomanip>
 #include <iostream>
 #include <optional>
-#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -25,6 +22,7 @@
 #include "Nfc/Desfire/DesfireKeyType.h"
 #include "Nfc/Desfire/Commands/ChangeKeyCommand.h"
 #include "Error/DesfireError.h"
+#include "Utils/Hex.h"
 
 using namespace comms::serial;
 using namespace pn532;
@@ -62,45 +60,21 @@ namespace
 
     std::vector<uint8_t> parseHex(std::string text)
     {
-        std::vector<uint8_t> out;
-        std::string filtered;
-        filtered.reserve(text.size());
-
-        for (char c : text)
-        {
-            if (std::isxdigit(static_cast<unsigned char>(c)))
-            {
-                filtered.push_back(c);
-            }
-        }
-
-        if (filtered.size() % 2 != 0)
+        std::vector<uint8_t> out(text.size() / 2U);
+        size_t length = 0U;
+        if (!utils::hexDecodeLoose(text.data(), text.size(), out.data(), out.size(), length))
         {
             throw std::runtime_error("Hex string has odd number of digits");
         }
-
-        for (size_t i = 0; i < filtered.size(); i += 2)
-        {
-            const std::string byteText = filtered.substr(i, 2);
-            out.push_back(static_cast<uint8_t>(std::stoul(byteText, nullptr, 16)));
-        }
-
+        out.resize(length);
         return out;
     }
 
     std::string toHex(const std::vector<uint8_t>& data)
     {
-        std::ostringstream oss;
-        oss << std::hex << std::uppercase << std::setfill('0');
-        for (size_t i = 0; i < data.size(); ++i)
-        {
-            if (i > 0)
-            {
-                oss << ' ';
-            }
-            oss << std::setw(2) << static_cast<int>(data[i]);
-        }
-        return oss.str();
+        std::string text(utils::hexEncodedLength(data.size(), true), ' ');
+        utils::hexEncode(data.data(), data.size(), text.data(), ' ');
+        return text;
     }
 
     size_t expectedNewKeySize(DesfireKeyType keyType)
@@ -13,9 +13,7 @@
 #include <cctype>
 #include <cstdint>
 #include <cstdlib>
-#include <iomanip>
 #include <iostream>
-#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -29,6 +27,7 @@
 #include "Nfc/Desfire/DesfireAuthMode.h"
 #include "Nfc/Desfire/DesfireCard.h"
 #include "Error/DesfireError.h"
+#include "Utils/Hex.h"
 
 using namespace comms::serial;
 using namespace pn532;
@@ -78,45 +77,21 @@ namespace
 
     std::vector<uint8_t> parseHex(const std::string& text)
     {
-        std::vector<uint8_t> out;
-        std::string filtered;
-        filtered.reserve(text.size());
-
-        for (char c : text)
-        {
-            if (std::isxdigit(static_cast<unsigned char>(c)))
-            {
-                filtered.push_back(c);
-            }
-        }
-
-        if ((filtered.size() % 2U) != 0U)
+        std::vector<uint8_t> out(text.size() / 2U);
+        size_t length = 0U;
+        if (!utils::hexDecodeLoose(text.data(), text.size(), out.data(), out.size(), length))
         {
             throw std::runtime_error("Hex string has odd number of digits");
         }
-
-        for (size_t i = 0; i < filtered.size(); i += 2U)
-        {
-            const std::string byteText = filtered.substr(i, 2U);
-            out.push_back(static_cast<uint8_t>(std::stoul(byteText, nullptr, 16)));
-        }
-
+        out.resize(length);
         return out;
     }
 
     std::string toHex(const std::vector<uint8_t>& data)
     {
-        std::ostringstream oss;
-        oss << std::hex << std::uppercase << std::setfill('0');
-        for (size_t i = 0; i < data.size(); ++i)
-        {
-            if (i > 0U)
-            {
-                oss << ' ';
-            }
-            oss << std::setw(2) << static_cast<int>(data[i]);
-        }
-        return oss.str();
+        std::string text(utils::hexEncodedLength(data.size(), true), ' ');
+        utils::hexEncode(data.data(), data.size(), text.data(), ' ');
+        return text;
     }
 
     DesfireAuthMode parseAuthMode(const std::string& text)
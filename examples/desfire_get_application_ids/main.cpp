@@ -9,12 +9,9 @@
  *   4) Print all AIDs
  */
 
-#include <cctype>
 #include <cstdint>
 #include <cstdlib>
-#include <iomanip>
 #include <iostream>
-#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -27,6 +24,7 @@
 #include "Nfc/Card/CardManager.h"
 #include "Nfc/Card/ReaderCapabilities.h"
 #include "Nfc/Desfire/DesfireAuthMode.h"
+#include "Utils/Hex.h"
 
 using namespace comms::serial;
 using namespace pn532;
@@ -56,40 +54,21 @@ namespace
 
     std::vector<uint8_t> parseHex(std::string text)
     {
-        std::vector<uint8_t> out;
-        std::string filtered;
-        filtered.reserve(text.size());
-
-        for (char c : text)
-        {
-            if (std::isxdigit(static_cast<unsigned char>(c)))
-            {
-                filtered.push_back(c);
-            }
-        }
-
-        if ((filtered.size() % 2U) != 0U)
+        std::vector<uint8_t> out(text.size() / 2U);
+        size_t length = 0U;
+        if (!utils::hexDecodeLoose(text.data(), text.size(), out.data(), out.size(), length))
         {
             throw std::runtime_error("Hex string has odd number of digits");
         }
-
-        for (size_t i = 0; i < filtered.size(); i += 2U)
-        {
-            const std::string byteText = filtered.substr(i, 2);
-            out.push_back(static_cast<uint8_t>(std::stoul(byteText, nullptr, 16)));
-        }
-
+        out.resize(length);
         return out;
     }
 
     std::string toHex(const etl::array<uint8_t, 3>& aid)
     {
-        std::ostringstream oss;
-        oss << std::hex << std::uppercase << std::setfill('0')
-            << std::setw(2) << static_cast<int>(aid[0])
-            << std::setw(2) << static_cast<int>(aid[1])
-            << std::setw(2) << static_cast<int>(aid[2]);
-        return oss.str();
+        std::string text(utils::hexEncodedLength(aid.size()), ' ');
+        utils::hexEncode(aid.data(), aid.size(), text.data());
+        return text;
     }
 
     DesfireAuthMode parseAuthMode(const std::string& text)
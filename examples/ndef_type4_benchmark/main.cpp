@@ -0,0 +1,248 @@
+/**
+ * @file main.cpp
+ * @brief NDEF Type 4 Tag streaming read/write benchmark
+ *
+ * Goal:
+ *   - Time NdefStreamParser alone on 8 KB, 16 KB and 32 KB messages
+ *   - Time NdefType4Tag::readMessage / writeMessage against an emulated
+ *     DESFire card (plain comm, 59-byte AF frames)
+ *   - Report the number of card commands and the largest piece the
+ *     handler ever saw, to confirm the message is never buffered whole
+ *
+ * No reader is needed; the card is emulated in-process.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "Nfc/Apdu/IApduTransceiver.h"
+#include "Nfc/Desfire/DesfireCard.h"
+#include "Nfc/Ndef/NdefStreamParser.h"
+#include "Nfc/Ndef/NdefType4Tag.h"
+#include "Nfc/Wire/NativeWire.h"
+
+using namespace nfc;
+
+namespace
+{
+    constexpr size_t FRAME_SIZE = 59U;
+
+    class CountingHandler : public INdefRecordHandler
+    {
+    public:
+        void onRecordBegin(const NdefRecordHeader&) override
+        {
+            ++records;
+        }
+
+        void onPayload(const uint8_t* data, size_t length) override
+        {
+            for (size_t i = 0; i < length; ++i)
+            {
+                checksum = (checksum * 31U) + data[i];
+            }
+            payloadBytes += length;
+            largestPiece = std::max(largestPiece, length);
+        }
+
+        void onRecordEnd() override
+        {
+        }
+
+        size_t records = 0U;
+        size_t payloadBytes = 0U;
+        size_t largestPiece = 0U;
+        uint32_t checksum = 0U;
+    };
+
+    class EmulatedType4Card : public IApduTransceiver
+    {
+    public:
+        explicit EmulatedType4Card(size_t ndefFileSize)
+        {
+            files[0x01] = {
+                0x00, 0x0F, 0x20, 0x00, 0x3B, 0x00, 0x34, 0x04, 0x06, 0xE1, 0x04,
+                static_cast<uint8_t>(ndefFileSize >> 8U), static_cast<uint8_t>(ndefFileSize), 0x00, 0x00
+            };
+            files[0x02] = std::vector<uint8_t>(ndefFileSize, 0x00);
+        }
+
+        void setWire(IWire&) override
+        {
+        }
+
+        etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> transceive(
+            const etl::ivector<uint8_t>& apdu) override
+        {
+            ++commands;
+            etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX> response;
+            switch (apdu[0])
+            {
+                case 0x5A:
+                    response.push_back(0x00);
+                    break;
+
+                case 0xBD:
+                {
+                    const std::vector<uint8_t>& file = files[apdu[1]];
+                    const size_t offset = le24(&apdu[2]);
+                    pending.assign(file.begin() + offset, file.begin() + offset + le24(&apdu[5]));
+                    pendingIndex = 0U;
+                    nextFrame(response);
+                    break;
+                }
+
+                case 0xAF:
+                    nextFrame(response);
+                    break;
+
+                case 0x3D:
+                {
+                    std::vector<uint8_t>& file = files[apdu[1]];
+                    std::copy(apdu.begin() + 8, apdu.end(), file.begin() + le24(&apdu[2]));
+                    response.push_back(0x00);
+                    break;
+                }
+
+                default:
+                    response.push_back(0x1C);
+                    break;
+            }
+            return response;
+        }
+
+        std::map<uint8_t, std::vector<uint8_t>> files;
+        size_t commands = 0U;
+
+    private:
+        static size_t le24(const uint8_t* data)
+        {
+            return static_cast<size_t>(data[0]) |
+                   (static_cast<size_t>(data[1]) << 8U) |
+                   (static_cast<size_t>(data[2]) << 16U);
+        }
+
+        void nextFrame(etl::ivector<uint8_t>& response)
+        {
+            const size_t take = std::min(FRAME_SIZE, pending.size() - pendingIndex);
+            response.push_back((pendingIndex + take == pending.size()) ? 0x00 : 0xAF);
+            response.insert(response.end(), pending.begin() + pendingIndex, pending.begin() + pendingIndex + take);
+            pendingIndex += take;
+        }
+
+        std::vector<uint8_t> pending;
+        size_t pendingIndex = 0U;
+    };
+
+    // One short text record followed by a long media record
+    std::vector<uint8_t> buildMessage(size_t totalSize)
+    {
+        std::vector<uint8_t> message = {0x91, 0x01, 0x03, 'T', 0x02, 'e', 'n'};
+        const std::string type = "application/octet-stream";
+        const size_t fixed = message.size() + 6U + type.size();
+        const uint32_t payloadLength = static_cast<uint32_t>(totalSize - fixed);
+
+        message.push_back(0x42);    // ME, TNF media, long record
+        message.push_back(static_cast<uint8_t>(type.size()));
+        message.push_back(static_cast<uint8_t>(payloadLength >> 24U));
+        message.push_back(static_cast<uint8_t>(payloadLength >> 16U));
+        message.push_back(static_cast<uint8_t>(payloadLength >> 8U));
+        message.push_back(static_cast<uint8_t>(payloadLength));
+        message.insert(message.end(), type.begin(), type.end());
+        for (uint32_t i = 0; i < payloadLength; ++i)
+        {
+            message.push_back(static_cast<uint8_t>(i * 13U));
+        }
+        return message;
+    }
+
+    template <typename Fn>
+    double averageMicros(size_t iterations, Fn&& fn)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            fn();
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::micro>(elapsed).count() / static_cast<double>(iterations);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t iterations = (argc > 1) ? static_cast<size_t>(std::strtoul(argv[1], nullptr, 10)) : 200U;
+    const size_t sizes[] = {8U * 1024U, 16U * 1024U, 32U * 1024U};
+
+    std::cout << "NDEF Type 4 benchmark (" << iterations << " iterations per size)\n\n";
+    std::cout << std::left
+              << std::setw(10) << "size"
+              << std::setw(16) << "parse us"
+              << std::setw(16) << "read us"
+              << std::setw(16) << "write us"
+              << std::setw(12) << "commands"
+              << "largest piece\n";
+
+    for (size_t size : sizes)
+    {
+        const std::vector<uint8_t> message = buildMessage(size);
+
+        CountingHandler parseHandler;
+        const double parseUs = averageMicros(iterations, [&]() {
+            NdefStreamParser parser(parseHandler);
+            // Feed in frame-sized pieces, as the tag reader does
+            for (size_t offset = 0; offset < message.size(); offset += FRAME_SIZE)
+            {
+                const size_t take = std::min(FRAME_SIZE, message.size() - offset);
+                if (!parser.feed(message.data() + offset, take))
+                {
+                    std::exit(1);
+                }
+            }
+            if (!parser.finish())
+            {
+                std::exit(1);
+            }
+        });
+
+        EmulatedType4Card emulated(message.size() + NdefType4Tag::NLEN_SIZE);
+        NativeWire wire;
+        DesfireCard card(emulated, wire);
+        NdefType4Tag tag(card);
+
+        const double writeUs = averageMicros(iterations, [&]() {
+            if (!tag.writeMessage(message.data(), message.size()))
+            {
+                std::cerr << "writeMessage failed\n";
+                std::exit(1);
+            }
+        });
+
+        CountingHandler readHandler;
+        emulated.commands = 0U;
+        const double readUs = averageMicros(iterations, [&]() {
+            auto result = tag.readMessage(readHandler);
+            if (!result || result.value() != message.size())
+            {
+                std::cerr << "readMessage failed\n";
+                std::exit(1);
+            }
+        });
+
+        std::cout << std::left
+                  << std::setw(10) << size
+                  << std::setw(16) << std::fixed << std::setprecision(1) << parseUs
+                  << std::setw(16) << readUs
+                  << std::setw(16) << writeUs
+                  << std::setw(12) << (emulated.commands / iterations)
+                  << readHandler.largestPiece << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,202 @@
+/**
+ * @file main.cpp
+ * @brief SUN (Secure Dynamic Messaging) tap verification throughput benchmark
+ *
+ * Goal:
+ *   - Generate tap URLs the way NTAG 424 DNA / DESFire EV3 cards with
+ *     per-UID diversified K_SDMFileRead keys would produce them
+ *   - Time SdmVerifier::verify one tap at a time against
+ *     SdmVerifier::verifyBatch over the same taps
+ *   - Report taps per second and the diversified key cache hit rate
+ *
+ * No reader is needed; the taps are generated in-process.
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Nfc/Desfire/DesfireCryptoBatch.h"
+#include "Nfc/Desfire/SdmVerifier.h"
+#include "Utils/Hex.h"
+
+using namespace nfc;
+
+namespace
+{
+    const std::array<uint8_t, 16> META_READ_KEY = {
+        0x5A, 0x11, 0x42, 0x08, 0x9C, 0x3D, 0x77, 0xE1,
+        0x20, 0x6B, 0xF4, 0x91, 0x0E, 0xA5, 0x38, 0xC2};
+
+    const std::array<uint8_t, 16> MASTER_KEY = {
+        0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+        0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
+
+    const std::array<uint8_t, 3> AID = {0x10, 0xE5, 0x01};
+
+    std::string toHex(const uint8_t* data, size_t length)
+    {
+        std::string text(utils::hexEncodedLength(length), ' ');
+        utils::hexEncode(data, length, text.data());
+        return text;
+    }
+
+    void runJob(DesfireCryptoJobKind kind, const uint8_t* key, uint8_t* data, size_t length, uint8_t* mac)
+    {
+        uint8_t iv[16] = {0};
+        DesfireCryptoJob job;
+        job.kind = kind;
+        job.key = key;
+        job.keyLength = 16U;
+        job.iv = iv;
+        job.data = data;
+        job.length = length;
+        job.mac = mac;
+
+        DesfireCryptoBatch batch;
+        if (!batch.submit(job))
+        {
+            std::cerr << "crypto job rejected\n";
+            std::exit(1);
+        }
+        batch.process();
+    }
+
+    /**
+     * @brief Build the SUN URL a card would mirror for one tap
+     */
+    std::string makeTapUrl(const std::array<uint8_t, 7>& uid, uint32_t counter)
+    {
+        uint8_t input[10];
+        std::copy(uid.begin(), uid.end(), input);
+        std::copy(AID.begin(), AID.end(), input + 7);
+        uint8_t fileReadKey[16];
+        SdmVerifier::diversifyKey(MASTER_KEY.data(), input, sizeof(input), fileReadKey);
+
+        uint8_t picc[16] = {0xC7};
+        std::copy(uid.begin(), uid.end(), picc + 1);
+        picc[8] = static_cast<uint8_t>(counter);
+        picc[9] = static_cast<uint8_t>(counter >> 8U);
+        picc[10] = static_cast<uint8_t>(counter >> 16U);
+        runJob(DesfireCryptoJobKind::AesCbcEncrypt, META_READ_KEY.data(), picc, sizeof(picc), nullptr);
+
+        uint8_t sv2[16] = {0x3C, 0xC3, 0x00, 0x01, 0x00, 0x80};
+        std::copy(uid.begin(), uid.end(), sv2 + 6);
+        sv2[13] = static_cast<uint8_t>(counter);
+        sv2[14] = static_cast<uint8_t>(counter >> 8U);
+        sv2[15] = static_cast<uint8_t>(counter >> 16U);
+        uint8_t sessionKey[16];
+        runJob(DesfireCryptoJobKind::AesCmac, fileReadKey, sv2, sizeof(sv2), sessionKey);
+
+        uint8_t fullMac[16];
+        runJob(DesfireCryptoJobKind::AesCmac, sessionKey, nullptr, 0U, fullMac);
+        uint8_t mac[8];
+        for (size_t i = 0; i < 8U; ++i)
+        {
+            mac[i] = fullMac[(2U * i) + 1U];
+        }
+
+        return "https://tap.example.com/v?picc_data=" + toHex(picc, 16) + "&cmac=" + toHex(mac, 8);
+    }
+
+    std::unique_ptr<SdmVerifier> makeVerifier()
+    {
+        SdmVerifierOptions options;
+        options.metaReadKey = META_READ_KEY.data();
+        options.fileReadKey = MASTER_KEY.data();
+        options.diversifyFileReadKey = true;
+        options.diversificationSuffix = AID.data();
+        options.diversificationSuffixLength = AID.size();
+        return std::make_unique<SdmVerifier>(options);
+    }
+
+    void report(const char* label, double seconds, size_t taps, size_t valid, const SdmVerifierMetrics& metrics)
+    {
+        const uint32_t lookups = metrics.keyCacheHits + metrics.keyCacheMisses;
+        std::cout << std::left
+                  << std::setw(14) << label
+                  << std::setw(14) << std::fixed << std::setprecision(0) << (static_cast<double>(taps) / seconds)
+                  << std::setw(12) << std::setprecision(2) << (seconds * 1e6 / static_cast<double>(taps))
+                  << std::setw(10) << valid
+                  << std::setprecision(1)
+                  << (lookups == 0U ? 0.0 : 100.0 * metrics.keyCacheHits / lookups) << "%\n";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t cards = (argc > 1) ? static_cast<size_t>(std::strtoul(argv[1], nullptr, 10)) : 200U;
+    const size_t tapsPerCard = (argc > 2) ? static_cast<size_t>(std::strtoul(argv[2], nullptr, 10)) : 25U;
+
+    // Taps arrive interleaved across cards, counters increasing per card
+    std::vector<std::string> urls;
+    urls.reserve(cards * tapsPerCard);
+    for (size_t round = 0; round < tapsPerCard; ++round)
+    {
+        for (size_t card = 0; card < cards; ++card)
+        {
+            const std::array<uint8_t, 7> uid = {
+                0x04, 0x5E, static_cast<uint8_t>(card >> 8U), static_cast<uint8_t>(card),
+                0x2A, 0x6C, 0x80};
+            urls.push_back(makeTapUrl(uid, static_cast<uint32_t>(round + 1U)));
+        }
+    }
+
+    std::vector<SdmTap> taps(urls.size());
+    for (size_t i = 0; i < urls.size(); ++i)
+    {
+        taps[i].url = urls[i].c_str();
+    }
+
+    std::cout << "SDM verification benchmark (" << cards << " cards, " << tapsPerCard << " taps each, "
+              << (DesfireCryptoBatch::hardwareAccelerated() ? "AES-NI" : "portable AES") << ")\n\n";
+    std::cout << std::left
+              << std::setw(14) << "mode"
+              << std::setw(14) << "taps/s"
+              << std::setw(12) << "us/tap"
+              << std::setw(10) << "valid"
+              << "key cache hits\n";
+
+    {
+        std::unique_ptr<SdmVerifier> verifier = makeVerifier();
+        size_t valid = 0U;
+        const auto start = std::chrono::steady_clock::now();
+        for (SdmTap& tap : taps)
+        {
+            auto result = verifier->verify(tap);
+            if (result && result.value())
+            {
+                ++valid;
+            }
+        }
+        const double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        report("single", seconds, taps.size(), valid, verifier->metrics());
+    }
+
+    for (size_t batchSize : {8U, 64U, 1024U})
+    {
+        std::unique_ptr<SdmVerifier> verifier = makeVerifier();
+        size_t valid = 0U;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t offset = 0; offset < taps.size(); offset += batchSize)
+        {
+            const size_t take = std::min(batchSize, taps.size() - offset);
+            auto result = verifier->verifyBatch(taps.data() + offset, take);
+            valid += result ? result.value() : 0U;
+        }
+        const double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const std::string label = "batch " + std::to_string(batchSize);
+        report(label.c_str(), seconds, taps.size(), valid, verifier->metrics());
+    }
+
+    return 0;
+}
@@ -0,0 +1,388 @@
+/**
+ * @file main.cpp
+ * @brief io_uring serial engine vs thread-per-reader blocking I/O benchmark
+ *
+ * Goal:
+ *   - Simulate N PN532 readers on pseudo terminals; a simulator process
+ *     answers every GetFirmwareVersion frame with ACK + response
+ *   - Run the same request/response exchanges once with one blocking
+ *     thread per reader (write, poll, read) and once with SerialRing
+ *     serving all readers from a few threads
+ *   - Report exchanges per second, host CPU time and system calls; the
+ *     CPU time is the whole host process, kernel io_uring workers included
+ *
+ * No reader is needed; Linux only.
+ */
+
+#include <atomic>
+#include <algorithm>
+#include <csignal>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+#include "Comms/Serial/SerialRing.hpp"
+
+using namespace comms::serial;
+
+namespace
+{
+    // GetFirmwareVersion, then the ACK and the PN532 v1.6 answer
+    const uint8_t REQUEST[] = {0x00, 0x00, 0xFF, 0x02, 0xFE, 0xD4, 0x02, 0x2A, 0x00};
+    const uint8_t RESPONSE[] = {
+        0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00,
+        0x00, 0x00, 0xFF, 0x06, 0xFA, 0xD5, 0x03, 0x32, 0x01, 0x06, 0x07, 0xE8, 0x00};
+
+    struct Reader
+    {
+        int master = -1;
+        int slave = -1;
+        size_t pendingRequestBytes = 0U;    // simulator side
+    };
+
+    bool openReader(Reader& reader)
+    {
+        reader.master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (reader.master < 0 || grantpt(reader.master) != 0 || unlockpt(reader.master) != 0)
+        {
+            return false;
+        }
+        reader.slave = open(ptsname(reader.master), O_RDWR | O_NOCTTY);
+        if (reader.slave < 0)
+        {
+            return false;
+        }
+
+        // Raw tty, reads block for at least one byte (as SerialRingBus sets it)
+        termios options;
+        tcgetattr(reader.slave, &options);
+        cfmakeraw(&options);
+        options.c_cc[VMIN] = 1;
+        options.c_cc[VTIME] = 0;
+        return tcsetattr(reader.slave, TCSANOW, &options) == 0;
+    }
+
+    volatile std::sig_atomic_t simulatorStop = 0;
+
+    void stopSimulator(int)
+    {
+        simulatorStop = 1;
+    }
+
+    /**
+     * Answers every complete request on every master; stands in for the readers.
+     */
+    void simulate(std::vector<Reader>& readers)
+    {
+        std::vector<pollfd> descriptors(readers.size());
+        for (size_t i = 0; i < readers.size(); ++i)
+        {
+            descriptors[i] = {readers[i].master, POLLIN, 0};
+        }
+
+        uint8_t buffer[256];
+        while (simulatorStop == 0)
+        {
+            if (poll(descriptors.data(), descriptors.size(), 20) <= 0)
+            {
+                continue;
+            }
+            for (size_t i = 0; i < readers.size(); ++i)
+            {
+                if ((descriptors[i].revents & POLLIN) == 0)
+                {
+                    continue;
+                }
+                const ssize_t count = read(readers[i].master, buffer, sizeof(buffer));
+                if (count <= 0)
+                {
+                    continue;
+                }
+                readers[i].pendingRequestBytes += static_cast<size_t>(count);
+                while (readers[i].pendingRequestBytes >= sizeof(REQUEST))
+                {
+                    readers[i].pendingRequestBytes -= sizeof(REQUEST);
+                    (void)!write(readers[i].master, RESPONSE, sizeof(RESPONSE));
+                }
+            }
+        }
+    }
+
+    double processCpuSeconds()
+    {
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+               static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+    }
+
+    struct RunResult
+    {
+        double seconds = 0.0;
+        double cpuSeconds = 0.0;
+        uint64_t syscalls = 0U;
+        uint64_t exchanges = 0U;
+        size_t threads = 0U;
+    };
+
+    // ------------------------------------------------------------------------
+    // Thread per reader, blocking write/poll/read
+    // ------------------------------------------------------------------------
+
+    RunResult runBlocking(std::vector<Reader>& readers, size_t exchanges)
+    {
+        std::atomic<uint64_t> syscalls(0U);
+        std::atomic<uint64_t> done(0U);
+        std::vector<std::thread> threads;
+
+        const double cpuStart = processCpuSeconds();
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < readers.size(); ++r)
+        {
+            threads.emplace_back([&, r]() {
+                uint64_t calls = 0U;
+                uint8_t buffer[64];
+                for (size_t n = 0; n < exchanges; ++n)
+                {
+                    (void)!write(readers[r].slave, REQUEST, sizeof(REQUEST));
+                    ++calls;
+                    size_t received = 0U;
+                    while (received < sizeof(RESPONSE))
+                    {
+                        pollfd descriptor = {readers[r].slave, POLLIN, 0};
+                        ++calls;
+                        if (poll(&descriptor, 1, 1000) <= 0)
+                        {
+                            break;
+                        }
+                        const ssize_t count = read(readers[r].slave, buffer, sizeof(RESPONSE) - received);
+                        ++calls;
+                        if (count <= 0)
+                        {
+                            break;
+                        }
+                        received += static_cast<size_t>(count);
+                    }
+                    if (received == sizeof(RESPONSE))
+                    {
+                        done.fetch_add(1U, std::memory_order_relaxed);
+                    }
+                }
+                syscalls.fetch_add(calls, std::memory_order_relaxed);
+            });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        RunResult result;
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.cpuSeconds = processCpuSeconds() - cpuStart;
+        result.syscalls = syscalls.load();
+        result.exchanges = done.load();
+        result.threads = readers.size();
+        return result;
+    }
+
+    // ------------------------------------------------------------------------
+    // SerialRing, callbacks drive the exchanges
+    // ------------------------------------------------------------------------
+
+    struct RingWorker
+    {
+        SerialRing ring;
+        std::vector<size_t> channelOf;      // reader slot -> ring channel
+        std::vector<size_t> slotOf;         // ring channel -> reader slot
+        std::vector<size_t> received;
+        std::vector<size_t> sent;
+        size_t exchanges = 0U;
+        uint64_t done = 0U;
+    };
+
+    void onReceive(void* context, size_t channel)
+    {
+        RingWorker& worker = *static_cast<RingWorker*>(context);
+        const size_t slot = worker.slotOf[channel];
+        uint8_t buffer[SerialRing::RX_BUFFER_SIZE];
+        worker.received[slot] += worker.ring.read(channel, buffer, sizeof(buffer));
+
+        while (worker.received[slot] >= sizeof(RESPONSE))
+        {
+            worker.received[slot] -= sizeof(RESPONSE);
+            ++worker.done;
+            if (worker.sent[slot] < worker.exchanges)
+            {
+                ++worker.sent[slot];
+                const etl::vector<uint8_t, sizeof(REQUEST)> request(REQUEST, REQUEST + sizeof(REQUEST));
+                (void)worker.ring.write(channel, request);
+            }
+        }
+    }
+
+    void runRingWorker(RingWorker& worker, std::vector<Reader>& readers, size_t first, size_t count)
+    {
+        SerialRingHandlers handlers;
+        handlers.onReceive = onReceive;
+        handlers.context = &worker;
+
+        worker.slotOf.assign(SerialRing::MAX_CHANNELS, 0U);
+        worker.received.assign(count, 0U);
+        worker.sent.assign(count, 1U);
+        const etl::vector<uint8_t, sizeof(REQUEST)> request(REQUEST, REQUEST + sizeof(REQUEST));
+        for (size_t slot = 0; slot < count; ++slot)
+        {
+            auto channel = worker.ring.attach(readers[first + slot].slave, handlers);
+            if (!channel)
+            {
+                std::cerr << "attach failed\n";
+                return;
+            }
+            worker.channelOf.push_back(channel.value());
+            worker.slotOf[channel.value()] = slot;
+            (void)worker.ring.write(channel.value(), request);
+        }
+
+        // One io_uring_enter submits every queued request and waits for the next answer
+        const uint64_t target = static_cast<uint64_t>(count) * worker.exchanges;
+        while (worker.done < target)
+        {
+            auto polled = worker.ring.poll(1000U);
+            if (!polled || polled.value() == 0U)
+            {
+                break;
+            }
+        }
+
+        for (size_t channel : worker.channelOf)
+        {
+            worker.ring.detach(channel);
+        }
+    }
+
+    RunResult runRing(std::vector<Reader>& readers, size_t exchanges, size_t ringThreads)
+    {
+        std::vector<RingWorker> workers(ringThreads);
+        for (RingWorker& worker : workers)
+        {
+            worker.exchanges = exchanges;
+            if (!worker.ring.init())
+            {
+                std::cerr << "io_uring not available\n";
+                return RunResult();
+            }
+        }
+
+        std::vector<std::thread> threads;
+        const size_t perThread = (readers.size() + ringThreads - 1U) / ringThreads;
+        const double cpuStart = processCpuSeconds();
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t t = 0; t < ringThreads; ++t)
+        {
+            const size_t first = t * perThread;
+            const size_t count = (first < readers.size()) ? std::min(perThread, readers.size() - first) : 0U;
+            threads.emplace_back([&, t, first, count]() {
+                runRingWorker(workers[t], readers, first, count);
+            });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        RunResult result;
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.cpuSeconds = processCpuSeconds() - cpuStart;
+        for (size_t t = 0; t < ringThreads; ++t)
+        {
+            result.syscalls += workers[t].ring.getMetrics().enterCalls;
+            result.exchanges += workers[t].done;
+        }
+        result.threads = ringThreads;
+        return result;
+    }
+
+    void report(const char* mode, const RunResult& result)
+    {
+        const double exchanges = static_cast<double>(result.exchanges);
+        std::cout << std::left << std::fixed
+                  << std::setw(12) << mode
+                  << std::setw(9) << result.threads
+                  << std::setw(14) << std::setprecision(0) << (exchanges / result.seconds)
+                  << std::setw(14) << std::setprecision(3) << result.cpuSeconds
+                  << std::setw(16) << std::setprecision(1) << (result.cpuSeconds * 1e6 / exchanges)
+                  << std::setprecision(2) << (static_cast<double>(result.syscalls) / exchanges) << "\n";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t readerCount = (argc > 1) ? static_cast<size_t>(std::strtoul(argv[1], nullptr, 10)) : 8U;
+    const size_t exchanges = (argc > 2) ? static_cast<size_t>(std::strtoul(argv[2], nullptr, 10)) : 2000U;
+    const size_t minimumThreads = (readerCount + SerialRing::MAX_CHANNELS - 1U) / SerialRing::MAX_CHANNELS;
+    size_t ringThreads = (argc > 3) ? static_cast<size_t>(std::strtoul(argv[3], nullptr, 10)) : 1U;
+    ringThreads = std::max(ringThreads, std::max<size_t>(minimumThreads, 1U));
+
+    std::vector<Reader> readers(readerCount);
+    for (Reader& reader : readers)
+    {
+        if (!openReader(reader))
+        {
+            std::cerr << "Could not open a pseudo terminal\n";
+            return 1;
+        }
+    }
+
+    // The readers live in their own process so their CPU time is not counted
+    const pid_t simulator = fork();
+    if (simulator < 0)
+    {
+        std::cerr << "Could not start the reader simulator\n";
+        return 1;
+    }
+    if (simulator == 0)
+    {
+        std::signal(SIGTERM, stopSimulator);
+        for (Reader& reader : readers)
+        {
+            close(reader.slave);
+        }
+        simulate(readers);
+        _exit(0);
+    }
+    for (Reader& reader : readers)
+    {
+        close(reader.master);
+    }
+
+    std::cout << "Serial I/O benchmark (" << readerCount << " pty readers, " << exchanges
+              << " GetFirmwareVersion exchanges each)\n\n";
+    std::cout << std::left
+              << std::setw(12) << "mode"
+              << std::setw(9) << "threads"
+              << std::setw(14) << "exchanges/s"
+              << std::setw(14) << "host CPU s"
+              << std::setw(16) << "CPU us/exchange"
+              << "syscalls/exchange\n";
+
+    report("blocking", runBlocking(readers, exchanges));
+    report("io_uring", runRing(readers, exchanges, ringThreads));
+
+    kill(simulator, SIGTERM);
+    waitpid(simulator, nullptr, 0);
+    for (Reader& reader : readers)
+    {
+        close(reader.slave);
+    }
+    return 0;
+}
@@ -0,0 +1,18 @@
+/**
+ * @file FuzzMain.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief libFuzzer entry point; NFCCPP_FUZZ_TARGET names the parser (see ParserTargets.h)
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "ParserTargets.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    fuzz::NFCCPP_FUZZ_TARGET(data, size);
+    return 0;
+}
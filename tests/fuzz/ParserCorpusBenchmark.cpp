@@ -0,0 +1,266 @@
+/**
+ * @file ParserCorpusBenchmark.cpp
+ * @brief Parse throughput and worst-case time per input for every parser fuzz target
+ *
+ * Goal:
+ *   - Run each fuzz target over a corpus: built-in seeds, pathological
+ *     inputs (long garbage before 00 00 FF, runs of false start codes,
+ *     oversized length fields) and deterministic mutations of both
+ *   - Optionally add a libFuzzer corpus: <corpus-root>/<target name>/<files>
+ *   - Report MB/s over the corpus and the slowest single input, so a parser
+ *     change that makes some input quadratic shows up as a worst-case jump
+ *
+ * Usage: parser_corpus_benchmark [corpus-root] [--repeat N] [--max-worst-us N]
+ *   --repeat        timed runs per input (default 50)
+ *   --max-worst-us  exit with 1 when any input takes longer (regression gate)
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "ParserTargets.h"
+
+namespace
+{
+    using Bytes = std::vector<uint8_t>;
+
+    struct CorpusEntry
+    {
+        std::string origin;
+        Bytes data;
+    };
+
+    constexpr size_t MUTANTS_PER_ENTRY = 64U;
+    constexpr size_t BUS_READ_MAX = 261U;   // PN532_FRAME_MAX
+
+    Bytes pn532Frame(const Bytes& body)
+    {
+        Bytes frame = {0x00, 0x00, 0xFF, static_cast<uint8_t>(body.size()),
+                       static_cast<uint8_t>(0x100U - body.size())};
+        uint8_t sum = 0U;
+        for (uint8_t b : body)
+        {
+            frame.push_back(b);
+            sum = static_cast<uint8_t>(sum + b);
+        }
+        frame.push_back(static_cast<uint8_t>(0x100U - sum));
+        frame.push_back(0x00);
+        return frame;
+    }
+
+    Bytes concat(std::initializer_list<Bytes> parts)
+    {
+        Bytes out;
+        for (const Bytes& part : parts)
+        {
+            out.insert(out.end(), part.begin(), part.end());
+        }
+        return out;
+    }
+
+    Bytes repeated(const Bytes& pattern, size_t length)
+    {
+        Bytes out;
+        while (out.size() < length)
+        {
+            out.push_back(pattern[out.size() % pattern.size()]);
+        }
+        return out;
+    }
+
+    std::vector<CorpusEntry> builtInCorpus(const std::string& target)
+    {
+        const Bytes typeACard = {0x01, 0x01, 0x44, 0x03, 0x20, 0x07, 0x04, 0x5E, 0x11, 0x22, 0x2A, 0x6C, 0x80,
+                                 0x06, 0x75, 0x77, 0x81, 0x02, 0x80};
+        std::vector<CorpusEntry> corpus;
+
+        if (target == "pn532_frame")
+        {
+            const Bytes response = pn532Frame(concat({{0xD5, 0x4B}, typeACard}));
+            const Bytes ack = {0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00};
+            const Bytes noise = repeated({0x5A, 0xC3, 0x00, 0x17}, BUS_READ_MAX - response.size());
+            corpus.push_back({"seed: target found", concat({{0x4A}, response})});
+            corpus.push_back({"seed: firmware", concat({{0x02}, pn532Frame({0xD5, 0x03, 0x32, 0x01, 0x06, 0x07})})});
+            corpus.push_back({"seed: ack then frame", concat({{0x4A}, ack, response})});
+            corpus.push_back({"garbage before frame", concat({{0x4A}, noise, response})});
+            corpus.push_back({"false start codes", concat({{0x4A}, repeated({0x00, 0x00, 0xFF, 0x07}, BUS_READ_MAX)})});
+            corpus.push_back({"zeros", Bytes(BUS_READ_MAX + 1U, 0x00)});
+            corpus.push_back({"0xFF", Bytes(BUS_READ_MAX + 1U, 0xFF)});
+            corpus.push_back({"length 1", {0x4A, 0x00, 0x00, 0xFF, 0x01, 0xFF, 0xD5, 0x2B, 0x00}});
+            corpus.push_back({"length past end", concat({{0x4A, 0x00, 0x00, 0xFF, 0xFE, 0x02}, Bytes(16U, 0xD5)})});
+        }
+        else if (target == "in_list_passive_target")
+        {
+            corpus.push_back({"seed: type A with ATS", concat({{0x00}, typeACard})});
+            corpus.push_back({"seed: no target", {0x00, 0x00}});
+            corpus.push_back({"seed: FeliCa", concat({{0x01, 0x01, 0x01, 0x08}, Bytes(8U, 0x01)})});
+            corpus.push_back({"255 targets", concat({{0x00, 0xFF}, repeated({0x01, 0x44, 0x00, 0x08, 0x04}, 250U)})});
+            corpus.push_back({"oversized UID", concat({{0x00, 0x01, 0x01, 0x44, 0x00, 0x20, 0xF0}, Bytes(240U, 0x04)})});
+            corpus.push_back({"oversized ATS", concat({{0x00, 0x01, 0x01, 0x44, 0x00, 0x20, 0x04, 1, 2, 3, 4, 0xC8},
+                                                      Bytes(200U, 0x77)})});
+        }
+        else if (target == "iso_wire_unwrap")
+        {
+            corpus.push_back({"seed: success", {0x01, 0x02, 0x90, 0x00}});
+            corpus.push_back({"seed: additional frame", {0x91, 0xAF}});
+            corpus.push_back({"oversized", concat({Bytes(BUS_READ_MAX - 2U, 0xAA), {0x90, 0x00}})});
+            corpus.push_back({"short", {0x90}});
+        }
+        else if (target == "desfire_response")
+        {
+            for (uint8_t command = 0U; command < 14U; ++command)
+            {
+                for (uint8_t session : {0x00, 0x02, 0x0A, 0x03, 0x0B, 0x01})
+                {
+                    corpus.push_back({"seed: command " + std::to_string(command) + " session " + std::to_string(session),
+                                      concat({{command, session, 0x09, 0xAF}, Bytes(8U, 0x11),
+                                              {0x11, 0x00}, Bytes(16U, 0x22)})});
+                }
+            }
+            corpus.push_back({"chained frames", concat({{0x00, 0x00}, repeated({0x08, 0xAF, 1, 2, 3, 4, 5, 6, 7}, 600U)})});
+            corpus.push_back({"oversized frame", concat({{0x0A, 0x02, 0xFF, 0x00}, Bytes(254U, 0x33)})});
+        }
+        return corpus;
+    }
+
+    // xorshift32: the same mutants on every run and platform
+    uint32_t nextRandom(uint32_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    void addMutants(std::vector<CorpusEntry>& corpus)
+    {
+        uint32_t state = 0x2545F491U;
+        const size_t originals = corpus.size();
+        for (size_t i = 0U; i < originals; ++i)
+        {
+            for (size_t m = 0U; m < MUTANTS_PER_ENTRY; ++m)
+            {
+                Bytes data = corpus[i].data;
+                const uint32_t edits = 1U + (nextRandom(state) % 4U);
+                for (uint32_t e = 0U; e < edits && !data.empty(); ++e)
+                {
+                    const size_t at = nextRandom(state) % data.size();
+                    switch (nextRandom(state) % 4U)
+                    {
+                    case 0U: data[at] ^= static_cast<uint8_t>(1U << (nextRandom(state) % 8U)); break;
+                    case 1U: data[at] = static_cast<uint8_t>(nextRandom(state)); break;
+                    case 2U: data.resize(at + 1U); break;
+                    default: data.insert(data.begin() + static_cast<long>(at), {0x00, 0x00, 0xFF}); break;
+                    }
+                }
+                corpus.push_back({corpus[i].origin + " / mutant " + std::to_string(m), data});
+            }
+        }
+    }
+
+    void addCorpusFiles(std::vector<CorpusEntry>& corpus, const std::filesystem::path& directory)
+    {
+        std::error_code error;
+        if (!std::filesystem::is_directory(directory, error))
+        {
+            return;
+        }
+        for (const auto& file : std::filesystem::directory_iterator(directory, error))
+        {
+            std::ifstream in(file.path(), std::ios::binary);
+            corpus.push_back({file.path().string(),
+                              Bytes(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>())});
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string corpusRoot;
+    size_t repeat = 50U;
+    double maxWorstUs = 0.0;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc)
+        {
+            repeat = std::max<size_t>(1U, std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--max-worst-us" && i + 1 < argc)
+        {
+            maxWorstUs = std::strtod(argv[++i], nullptr);
+        }
+        else
+        {
+            corpusRoot = arg;
+        }
+    }
+
+    std::cout << "Parser corpus benchmark (" << repeat << " runs per input)\n\n";
+    std::cout << std::left
+              << std::setw(24) << "target"
+              << std::setw(10) << "inputs"
+              << std::setw(12) << "MB/s"
+              << std::setw(12) << "worst us"
+              << "slowest input\n";
+
+    bool withinBudget = true;
+    for (const fuzz::ParserTarget& target : fuzz::TARGETS)
+    {
+        std::vector<CorpusEntry> corpus = builtInCorpus(target.name);
+        addMutants(corpus);
+        if (!corpusRoot.empty())
+        {
+            addCorpusFiles(corpus, std::filesystem::path(corpusRoot) / target.name);
+        }
+
+        size_t bytes = 0U;
+        double totalSeconds = 0.0;
+        double worstSeconds = 0.0;
+        const CorpusEntry* slowest = nullptr;
+        volatile int sink = 0;
+        for (const CorpusEntry& entry : corpus)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t r = 0U; r < repeat; ++r)
+            {
+                sink = sink + target.run(entry.data.data(), entry.data.size());
+            }
+            const double seconds =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repeat;
+
+            bytes += entry.data.size();
+            totalSeconds += seconds;
+            if (slowest == nullptr || seconds > worstSeconds)
+            {
+                worstSeconds = seconds;
+                slowest = &entry;
+            }
+        }
+
+        const double worstUs = worstSeconds * 1e6;
+        std::cout << std::left
+                  << std::setw(24) << target.name
+                  << std::setw(10) << corpus.size()
+                  << std::setw(12) << std::fixed << std::setprecision(1)
+                  << (totalSeconds > 0.0 ? static_cast<double>(bytes) / totalSeconds / 1e6 : 0.0)
+                  << std::setw(12) << std::setprecision(2) << worstUs
+                  << (slowest != nullptr ? slowest->origin : "-")
+                  << " (" << (slowest != nullptr ? slowest->data.size() : 0U) << " bytes)\n";
+
+        if (maxWorstUs > 0.0 && worstUs > maxWorstUs)
+        {
+            withinBudget = false;
+        }
+    }
+
+    return withinBudget ? 0 : 1;
+}
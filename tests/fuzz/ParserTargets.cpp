@@ -0,0 +1,208 @@
+/**
+ * @file ParserTargets.cpp
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Parsers of untrusted reader and card bytes, as fuzz / benchmark entry points
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "ParserTargets.h"
+#include "Nfc/BufferSizes.h"
+#include "Nfc/Wire/IsoWire.h"
+#include "Nfc/Desfire/DesfireContext.h"
+#include "Nfc/Desfire/IDesfireCommand.h"
+#include "Nfc/Desfire/Commands/CommitTransactionCommand.h"
+#include "Nfc/Desfire/Commands/FreeMemoryCommand.h"
+#include "Nfc/Desfire/Commands/GetApplicationIdsCommand.h"
+#include "Nfc/Desfire/Commands/GetCardUidCommand.h"
+#include "Nfc/Desfire/Commands/GetFileIdsCommand.h"
+#include "Nfc/Desfire/Commands/GetFileSettingsCommand.h"
+#include "Nfc/Desfire/Commands/GetKeySettingsCommand.h"
+#include "Nfc/Desfire/Commands/GetKeyVersionCommand.h"
+#include "Nfc/Desfire/Commands/GetValueCommand.h"
+#include "Nfc/Desfire/Commands/GetVersionCommand.h"
+#include "Nfc/Desfire/Commands/ReadDataCommand.h"
+#include "Nfc/Desfire/Commands/ReadRecordsCommand.h"
+#include "Nfc/Desfire/Commands/ReadSigCommand.h"
+#include "Nfc/Desfire/Commands/SelectApplicationCommand.h"
+#include "Pn532/Pn532Driver.h"
+#include "Pn532/Commands/InListPassiveTarget.h"
+#include <etl/vector.h>
+
+using namespace nfc;
+using namespace pn532;
+
+namespace
+{
+    constexpr size_t MAX_DESFIRE_FRAMES = 16U;
+
+    // Raw bytes as one bus read would hand them over
+    etl::vector<uint8_t, buffer::PN532_FRAME_MAX> busBytes(const uint8_t* data, size_t size)
+    {
+        const size_t length = (size < buffer::PN532_FRAME_MAX) ? size : buffer::PN532_FRAME_MAX;
+        return etl::vector<uint8_t, buffer::PN532_FRAME_MAX>(data, data + length);
+    }
+
+    DesfireContext makeSession(uint8_t selector)
+    {
+        DesfireContext context;
+        const uint8_t scheme = selector & 0x03U;
+        if (scheme == 0U)
+        {
+            return context;
+        }
+
+        context.authenticated = true;
+        context.commMode = static_cast<CommMode>(((selector >> 2) & 0x03U) % 3U);
+        context.sessionKeyEnc.assign(16U, 0x00U);
+        context.sessionKeyMac.assign(16U, 0x00U);
+        switch (scheme)
+        {
+        case 1U:
+            context.authScheme = SessionAuthScheme::Legacy;
+            context.iv.assign(8U, 0x00U);
+            break;
+        case 2U:
+            context.authScheme = SessionAuthScheme::Aes;
+            context.iv.assign(16U, 0x00U);
+            break;
+        default:
+            context.authScheme = SessionAuthScheme::Ev2;
+            context.iv.assign(16U, 0x00U);
+            context.transactionId.assign(4U, 0x00U);
+            break;
+        }
+        return context;
+    }
+
+    int runCommand(IDesfireCommand& command, DesfireContext& context, const uint8_t* data, size_t size)
+    {
+        int consumed = 0;
+        size_t offset = 0U;
+        for (size_t frame = 0U; frame < MAX_DESFIRE_FRAMES && offset < size; ++frame)
+        {
+            if (!command.buildRequest(context))
+            {
+                break;
+            }
+
+            size_t length = data[offset++];
+            if (length > size - offset)
+            {
+                length = size - offset;
+            }
+            const etl::vector<uint8_t, 256> response(data + offset, data + offset + length);
+            offset += length;
+
+            auto result = command.parseResponse(response, context);
+            if (!result)
+            {
+                break;
+            }
+            consumed += static_cast<int>(result.value().data.size());
+            if (command.isComplete())
+            {
+                break;
+            }
+        }
+        return consumed;
+    }
+}
+
+namespace fuzz
+{
+    int parsePn532Frame(const uint8_t* data, size_t size)
+    {
+        if (size == 0U)
+        {
+            return 0;
+        }
+
+        const auto frame = busBytes(data + 1, size - 1U);
+        auto parsed = Pn532Driver::parseResponseFrame(frame, data[0]);
+        return parsed ? static_cast<int>(parsed.value().size()) : 0;
+    }
+
+    int parseInListPassiveTarget(const uint8_t* data, size_t size)
+    {
+        if (size == 0U)
+        {
+            return 0;
+        }
+
+        InListPassiveTargetOptions options;
+        options.target = static_cast<CardTargetType>(data[0] % 5U);
+        InListPassiveTarget command(options);
+
+        // Frame the payload the way the PN532 would: 00 00 FF LEN LCS D5 4B payload DCS 00
+        const size_t payloadLength = (size - 1U < buffer::PN532_DATA_MAX - 2U) ? size - 1U : buffer::PN532_DATA_MAX - 2U;
+        const uint8_t packetLength = static_cast<uint8_t>(payloadLength + 2U);
+        etl::vector<uint8_t, buffer::PN532_FRAME_MAX> frame = {0x00, 0x00, 0xFF, packetLength,
+                                                                static_cast<uint8_t>(0x100U - packetLength), 0xD5, 0x4B};
+        uint8_t sum = 0xD5 + 0x4B;
+        for (size_t i = 0U; i < payloadLength; ++i)
+        {
+            frame.push_back(data[1U + i]);
+            sum = static_cast<uint8_t>(sum + data[1U + i]);
+        }
+        frame.push_back(static_cast<uint8_t>(0x100U - sum));
+        frame.push_back(0x00);
+
+        auto parsed = Pn532Driver::parseResponseFrame(frame, 0x4A);
+        if (!parsed || !command.parseResponse(parsed.value()))
+        {
+            return 0;
+        }
+        return static_cast<int>(command.getDetectedTargets().size());
+    }
+
+    int unwrapIsoApdu(const uint8_t* data, size_t size)
+    {
+        IsoWire wire;
+        auto unwrapped = wire.unwrap(busBytes(data, size));
+        return unwrapped ? static_cast<int>(unwrapped.value().size()) : 0;
+    }
+
+    int parseDesfireResponses(const uint8_t* data, size_t size)
+    {
+        if (size < 2U)
+        {
+            return 0;
+        }
+
+        DesfireContext context = makeSession(data[1]);
+        const uint8_t* frames = data + 2;
+        const size_t framesSize = size - 2U;
+        const etl::array<uint8_t, 3> aid = {0x01, 0x02, 0x03};
+
+        switch (data[0] % 14U)
+        {
+        case 0U: { GetVersionCommand command; return runCommand(command, context, frames, framesSize); }
+        case 1U: { GetApplicationIdsCommand command; return runCommand(command, context, frames, framesSize); }
+        case 2U: { GetFileIdsCommand command; return runCommand(command, context, frames, framesSize); }
+        case 3U: { GetFileSettingsCommand command(0x01); return runCommand(command, context, frames, framesSize); }
+        case 4U: { GetKeySettingsCommand command; return runCommand(command, context, frames, framesSize); }
+        case 5U: { GetKeyVersionCommand command(0x00); return runCommand(command, context, frames, framesSize); }
+        case 6U: { GetValueCommand command(0x01); return runCommand(command, context, frames, framesSize); }
+        case 7U: { FreeMemoryCommand command; return runCommand(command, context, frames, framesSize); }
+        case 8U: { GetCardUidCommand command; return runCommand(command, context, frames, framesSize); }
+        case 9U: { ReadSigCommand command; return runCommand(command, context, frames, framesSize); }
+        case 10U:
+        {
+            ReadDataCommand command(ReadDataCommandOptions{0x01, 0U, 64U, 32U});
+            return runCommand(command, context, frames, framesSize);
+        }
+        case 11U:
+        {
+            ReadRecordsCommand command(ReadRecordsCommandOptions{0x01, 0U, 2U, 16U, 32U});
+            return runCommand(command, context, frames, framesSize);
+        }
+        case 12U: { SelectApplicationCommand command(aid); return runCommand(command, context, frames, framesSize); }
+        default: { CommitTransactionCommand command; return runCommand(command, context, frames, framesSize); }
+        }
+    }
+
+} // namespace fuzz
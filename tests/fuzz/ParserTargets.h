@@ -0,0 +1,71 @@
+/**
+ * @file ParserTargets.h
+ * @author Nathan Houwaart (n.m.houwaart@hva.nl)
+ * @brief Parsers of untrusted reader and card bytes, as fuzz / benchmark entry points
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace fuzz
+{
+    /**
+     * @brief One parser entry point
+     *
+     * run() takes arbitrary bytes and must return for every input, in time
+     * linear in its size. The return value only keeps the work from being
+     * optimized away.
+     */
+    struct ParserTarget
+    {
+        const char* name;                               // also the corpus subdirectory name
+        int (*run)(const uint8_t* data, size_t size);
+    };
+
+    /**
+     * @brief Pn532Driver::parseResponseFrame on raw bus bytes
+     *
+     * Input: [sent command code][bytes as read from the bus...]
+     */
+    int parsePn532Frame(const uint8_t* data, size_t size);
+
+    /**
+     * @brief InListPassiveTarget::parseResponse (parseTarget, parseUid, parseATS)
+     *
+     * Input: [target type][response payload...]; the payload is framed and
+     * goes through parseResponseFrame() first, as it does on the wire.
+     */
+    int parseInListPassiveTarget(const uint8_t* data, size_t size);
+
+    /**
+     * @brief IsoWire::unwrap on an ISO 7816-4 response APDU
+     *
+     * Input: [data...][SW1][SW2]
+     */
+    int unwrapIsoApdu(const uint8_t* data, size_t size);
+
+    /**
+     * @brief parseResponse of the DESFire commands that read data back
+     *
+     * Input: [command selector][session selector][frame length][frame]...
+     * Frames go to the command in turn while it asks for more. The session
+     * selector picks the authentication scheme and communication mode, with
+     * all-zero session keys.
+     */
+    int parseDesfireResponses(const uint8_t* data, size_t size);
+
+    constexpr ParserTarget TARGETS[] = {
+        {"pn532_frame", parsePn532Frame},
+        {"in_list_passive_target", parseInListPassiveTarget},
+        {"iso_wire_unwrap", unwrapIsoApdu},
+        {"desfire_response", parseDesfireResponses},
+    };
+
+} // namespace fuzz
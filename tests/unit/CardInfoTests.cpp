@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <initializer_list>
+#include "Nfc/Card/CardInfo.h"
+
+using namespace nfc;
+
+namespace
+{
+    CardInfo makeIsoDepCard(std::initializer_list<uint8_t> ats)
+    {
+        CardInfo info;
+        info.atqa = 0x4403;
+        info.sak = 0x20;
+        info.ats.assign(ats.begin(), ats.end());
+        return info;
+    }
+}
+
+TEST(CardInfoTests, DecodesDesfireDefaultAts)
+{
+    CardInfo info = makeIsoDepCard({0x75, 0x77, 0x81, 0x02, 0x80});
+    EXPECT_EQ(info.detectType(), CardType::MifareDesfire);
+
+    const AtsInfo& ats = info.atsInfo;
+    ASSERT_TRUE(ats.valid);
+    EXPECT_EQ(ats.fsci, 5U);
+    EXPECT_EQ(ats.fsc, 64U);
+    EXPECT_EQ(ats.bitRatesToCard, ATS_BITRATE_106 | ATS_BITRATE_212 | ATS_BITRATE_424 | ATS_BITRATE_848);
+    EXPECT_EQ(ats.bitRatesFromCard, ATS_BITRATE_106 | ATS_BITRATE_212 | ATS_BITRATE_424 | ATS_BITRATE_848);
+    EXPECT_FALSE(ats.sameBitRateOnly);
+    EXPECT_EQ(ats.fwi, 8U);
+    EXPECT_EQ(ats.sfgi, 1U);
+    EXPECT_TRUE(ats.cidSupported);
+    EXPECT_FALSE(ats.nadSupported);
+    EXPECT_EQ(ats.historicalOffset, 4U);
+    EXPECT_EQ(ats.historicalLength, 1U);
+
+    // EV1, EV2 and EV3 share this ATS
+    EXPECT_TRUE(info.generationAmbiguous);
+}
+
+TEST(CardInfoTests, RecognisesUnambiguousSignature)
+{
+    CardInfo info = makeIsoDepCard({0x77, 0x77, 0x71, 0x02, 0x80});
+    info.detectType();
+    EXPECT_FALSE(info.generationAmbiguous);
+    EXPECT_EQ(info.generation, CardGeneration::Ntag424Dna);
+    EXPECT_EQ(info.atsInfo.fsc, 128U);
+    EXPECT_EQ(info.atsInfo.fwi, 7U);
+}
+
+TEST(CardInfoTests, AppliesDefaultsForAbsentInterfaceBytes)
+{
+    // Only TB present, FSCI 8, two historical bytes
+    CardInfo info = makeIsoDepCard({0x28, 0x90, 0xC1, 0x05});
+    info.detectType();
+
+    const AtsInfo& ats = info.atsInfo;
+    ASSERT_TRUE(ats.valid);
+    EXPECT_EQ(ats.fsc, 256U);
+    EXPECT_EQ(ats.bitRatesToCard, ATS_BITRATE_106);
+    EXPECT_EQ(ats.fwi, 9U);
+    EXPECT_TRUE(ats.cidSupported);
+    EXPECT_EQ(ats.historicalOffset, 2U);
+    EXPECT_EQ(ats.historicalLength, 2U);
+    EXPECT_TRUE(info.generationAmbiguous);
+}
+
+TEST(CardInfoTests, RejectsTruncatedAts)
+{
+    // T0 announces TA, TB and TC but only TA follows
+    CardInfo info = makeIsoDepCard({0x75, 0x77});
+    info.detectType();
+    EXPECT_FALSE(info.atsInfo.valid);
+    EXPECT_TRUE(info.generationAmbiguous);
+
+    CardInfo none = makeIsoDepCard({});
+    EXPECT_FALSE(none.parseAts());
+}
+
+TEST(CardInfoTests, MapsGetVersionHardwareBlock)
+{
+    etl::vector<uint8_t, 28> version = {0x04, 0x01, 0x01, 0x12, 0x00, 0x18, 0x05};
+    EXPECT_EQ(CardInfo::generationFromVersion(version), CardGeneration::DesfireEv2);
+    version[3] = 0x33;
+    EXPECT_EQ(CardInfo::generationFromVersion(version), CardGeneration::DesfireEv3);
+    version[3] = 0x01;
+    EXPECT_EQ(CardInfo::generationFromVersion(version), CardGeneration::DesfireEv1);
+    version[1] = 0x08;
+    EXPECT_EQ(CardInfo::generationFromVersion(version), CardGeneration::DesfireLight);
+    version.resize(3);
+    EXPECT_EQ(CardInfo::generationFromVersion(version), CardGeneration::Unknown);
+}
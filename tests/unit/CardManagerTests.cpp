@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+#include "Nfc/Card/CardManager.h"
+#include "Nfc/Card/UidHotlist.h"
+#include "Error/CardManagerError.h"
+
+using namespace nfc;
+
+namespace
+{
+    uint32_t fakeNow = 0U;
+
+    uint32_t fakeClock()
+    {
+        return fakeNow;
+    }
+
+    /**
+     * Reports one card in the field; detectCard() counts full activations.
+     */
+    class FakeDetector : public ICardDetector
+    {
+    public:
+        etl::expected<CardInfo, error::Error> detectCard() override
+        {
+            ++detections;
+            if (!present && emptyFieldIsCardInfo)
+            {
+                // PN532 style: an empty field is a CardInfo without UID
+                return CardInfo();
+            }
+            if (!present)
+            {
+                return etl::unexpected(error::Error::fromCardManager(error::CardManagerError::NoCardPresent));
+            }
+            CardInfo info;
+            info.uid = uid;
+            info.atqa = 0x0344U;
+            info.sak = 0x20U;
+            info.type = CardType::MifareDesfire;
+            return info;
+        }
+
+        bool isCardPresent() override
+        {
+            ++presenceChecks;
+            return present;
+        }
+
+        etl::vector<uint8_t, 10> uid = {0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+        bool present = true;
+        bool emptyFieldIsCardInfo = false;
+        int detections = 0;
+        int presenceChecks = 0;
+    };
+
+    class NullTransceiver : public IApduTransceiver
+    {
+    public:
+        void setWire(IWire&) override
+        {
+        }
+
+        etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> transceive(
+            const etl::ivector<uint8_t>&) override
+        {
+            return etl::unexpected(error::Error::fromCardManager(error::CardManagerError::CardMute));
+        }
+    };
+
+    class CardManagerTest : public ::testing::Test
+    {
+    protected:
+        CardManagerTest()
+            : manager(transceiver, detector, ReaderCapabilities())
+        {
+            fakeNow = 1000U;
+        }
+
+        void enableDebounce(TapDebounceMode mode)
+        {
+            TapDebounceOptions options;
+            options.mode = mode;
+            options.windowMs = 1500U;
+            options.clock = fakeClock;
+            manager.setTapDebounce(options);
+        }
+
+        bool isDuplicate(const etl::expected<CardInfo, error::Error>& result)
+        {
+            return !result.has_value() &&
+                result.error().get<error::CardManagerError>() == error::CardManagerError::DuplicateTap;
+        }
+
+        FakeDetector detector;
+        NullTransceiver transceiver;
+        CardManager manager;
+    };
+}
+
+// Test: Without debounce every call is a fresh detection
+TEST_F(CardManagerTest, OffModeDetectsEveryCall)
+{
+    EXPECT_TRUE(manager.detectCard().has_value());
+    EXPECT_TRUE(manager.detectCard().has_value());
+    EXPECT_EQ(detector.detections, 2);
+    EXPECT_EQ(detector.presenceChecks, 0);
+}
+
+// Test: A card held on the reader is reported once
+TEST_F(CardManagerTest, SuppressesCardHeldInField)
+{
+    enableDebounce(TapDebounceMode::Suppress);
+
+    EXPECT_TRUE(manager.detectCard().has_value());
+    fakeNow += 5000U;
+    EXPECT_TRUE(isDuplicate(manager.detectCard()));
+    EXPECT_TRUE(isDuplicate(manager.detectCard()));
+
+    EXPECT_EQ(detector.detections, 1);
+    EXPECT_EQ(manager.getTapDebounceMetrics().suppressed, 2U);
+    EXPECT_EQ(manager.getTapDebounceMetrics().presenceChecks, 2U);
+}
+
+// Test: A held card keeps its session instead of being activated again
+TEST_F(CardManagerTest, ReusesSessionOfCardHeldInField)
+{
+    enableDebounce(TapDebounceMode::ReuseSession);
+
+    ASSERT_TRUE(manager.detectCard().has_value());
+    auto first = manager.createSession();
+    ASSERT_TRUE(first.has_value());
+
+    auto again = manager.detectCard();
+    ASSERT_TRUE(again.has_value());
+    EXPECT_EQ(again.value().uid, detector.uid);
+    auto second = manager.createSession();
+    ASSERT_TRUE(second.has_value());
+
+    EXPECT_EQ(first.value(), second.value());
+    EXPECT_EQ(detector.detections, 1);
+    EXPECT_EQ(manager.getTapDebounceMetrics().sessionsReused, 1U);
+}
+
+// Test: Lifting and re-tapping within the window is a duplicate, later it is a new tap
+TEST_F(CardManagerTest, ReTapWithinWindowIsDuplicate)
+{
+    enableDebounce(TapDebounceMode::Suppress);
+
+    EXPECT_TRUE(manager.detectCard().has_value());
+
+    detector.present = false;
+    EXPECT_FALSE(manager.detectCard().has_value());
+
+    detector.present = true;
+    fakeNow += 1000U;
+    EXPECT_TRUE(isDuplicate(manager.detectCard()));
+
+    detector.present = false;
+    EXPECT_FALSE(manager.detectCard().has_value());
+
+    // Window runs from the last time the card was seen
+    detector.present = true;
+    fakeNow += 1600U;
+    EXPECT_TRUE(manager.detectCard().has_value());
+}
+
+// Test: Another card inside the window is not a duplicate
+TEST_F(CardManagerTest, DifferentCardIsNotDuplicate)
+{
+    enableDebounce(TapDebounceMode::Suppress);
+
+    EXPECT_TRUE(manager.detectCard().has_value());
+    detector.present = false;
+    EXPECT_FALSE(manager.detectCard().has_value());
+
+    detector.present = true;
+    detector.uid[6] = 0x67;
+    EXPECT_TRUE(manager.detectCard().has_value());
+}
+
+// Test: Empty polls between two taps are neither duplicates nor remembered
+TEST_F(CardManagerTest, EmptyPollsAreNotTaps)
+{
+    enableDebounce(TapDebounceMode::Suppress);
+    detector.emptyFieldIsCardInfo = true;
+
+    EXPECT_TRUE(manager.detectCard().has_value());
+
+    detector.present = false;
+    for (int i = 0; i < 8; ++i)
+    {
+        auto empty = manager.detectCard();
+        ASSERT_TRUE(empty.has_value());
+        EXPECT_TRUE(empty.value().uid.empty());
+    }
+    EXPECT_EQ(manager.getTapDebounceMetrics().suppressed, 0U);
+
+    // The first card is still remembered, so its re-tap is a duplicate
+    detector.present = true;
+    EXPECT_TRUE(isDuplicate(manager.detectCard()));
+
+    detector.present = false;
+    EXPECT_TRUE(manager.detectCard().value().uid.empty());
+
+    detector.present = true;
+    detector.uid[6] = 0x67;
+    EXPECT_TRUE(manager.detectCard().has_value());
+    EXPECT_EQ(manager.getTapDebounceMetrics().suppressed, 1U);
+}
+
+// Test: An empty field is not rejected by an allowlist
+TEST_F(CardManagerTest, AllowlistIgnoresEmptyField)
+{
+    UidHotlist allowlist(UidHotlistMode::Allowlist);
+    manager.setHotlist(&allowlist);
+    detector.emptyFieldIsCardInfo = true;
+
+    detector.present = false;
+    auto empty = manager.detectCard();
+    ASSERT_TRUE(empty.has_value());
+    EXPECT_TRUE(empty.value().uid.empty());
+
+    // Without a published list every real card is rejected
+    detector.present = true;
+    auto rejected = manager.detectCard();
+    ASSERT_FALSE(rejected.has_value());
+    EXPECT_EQ(rejected.error().get<error::CardManagerError>(), error::CardManagerError::CardRejected);
+}
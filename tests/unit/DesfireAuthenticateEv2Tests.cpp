@@ -0,0 +1,506 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <map>
+#include <vector>
+#include <aes.hpp>
+#include "Nfc/Desfire/DesfireCard.h"
+#include "Nfc/Desfire/Commands/AuthenticateEv2Command.h"
+#include "Nfc/Desfire/SecureMessagingCodec.h"
+#include "Nfc/Desfire/DesfireSequenceLearner.h"
+#include "Nfc/Desfire/SecureMessagingPolicy.h"
+#include "Nfc/Desfire/DesfireCryptoBatch.h"
+#include "Nfc/Apdu/IApduTransceiver.h"
+#include "Nfc/Wire/NativeWire.h"
+
+using namespace nfc;
+
+namespace
+{
+    using Block = std::array<uint8_t, 16>;
+
+    const Block KEY_0 = {};
+    const Block KEY_1 = {
+        0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF,
+        0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10};
+
+    Block cmac(const Block& key, std::vector<uint8_t> message)
+    {
+        uint8_t iv[16] = {0};
+        Block mac = {};
+        DesfireCryptoJob job;
+        job.kind = DesfireCryptoJobKind::AesCmac;
+        job.key = key.data();
+        job.keyLength = 16U;
+        job.iv = iv;
+        job.data = message.data();
+        job.length = message.size();
+        job.mac = mac.data();
+        DesfireCryptoBatch batch;
+        batch.submit(job);
+        batch.process();
+        return mac;
+    }
+
+    void cbc(const Block& key, const uint8_t* iv, uint8_t* data, size_t length, bool encrypt)
+    {
+        AES_ctx ctx;
+        AES_init_ctx_iv(&ctx, key.data(), iv);
+        if (encrypt)
+        {
+            AES_CBC_encrypt_buffer(&ctx, data, length);
+        }
+        else
+        {
+            AES_CBC_decrypt_buffer(&ctx, data, length);
+        }
+    }
+
+    /**
+     * Card side of EV2 secure messaging, written from the datasheet rather
+     * than against SecureMessagingPolicy.
+     */
+    class Ev2Card : public IApduTransceiver
+    {
+    public:
+        Ev2Card()
+        {
+            keys[0] = KEY_0;
+            keys[1] = KEY_1;
+        }
+
+        void setWire(IWire&) override
+        {
+        }
+
+        etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> transceive(
+            const etl::ivector<uint8_t>& apdu) override
+        {
+            std::vector<uint8_t> reply = process(std::vector<uint8_t>(apdu.begin(), apdu.end()));
+            etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX> response;
+            response.assign(reply.begin(), reply.end());
+            return response;
+        }
+
+        std::vector<uint8_t> process(const std::vector<uint8_t>& pdu)
+        {
+            sent.push_back(pdu[0]);
+            switch (pdu[0])
+            {
+                case 0x71:
+                case 0x77:
+                    return beginAuthentication(pdu);
+                case 0xAF:
+                    return finishAuthentication(pdu);
+                default:
+                    return command(pdu);
+            }
+        }
+
+        std::array<uint8_t, 4> ti = {0x9D, 0x00, 0xC4, 0xDF};
+        uint16_t counter = 0;
+        bool authenticated = false;
+        std::vector<uint8_t> sent;
+        std::vector<uint8_t> file = std::vector<uint8_t>(32, 0x00);
+        std::vector<uint8_t> uid = {0x04, 0x96, 0x8C, 0xAA, 0x5C, 0x5E, 0x80};
+        bool corruptNextMac = false;
+
+    private:
+        std::vector<uint8_t> mact(uint8_t code, uint16_t ctr, const std::vector<uint8_t>& data)
+        {
+            std::vector<uint8_t> message = {code, static_cast<uint8_t>(ctr), static_cast<uint8_t>(ctr >> 8)};
+            message.insert(message.end(), ti.begin(), ti.end());
+            message.insert(message.end(), data.begin(), data.end());
+            const Block full = cmac(sesMac, message);
+            std::vector<uint8_t> truncated;
+            for (size_t i = 1; i < 16; i += 2)
+            {
+                truncated.push_back(full[i]);
+            }
+            return truncated;
+        }
+
+        Block ivFor(bool response, uint16_t ctr)
+        {
+            Block input = {};
+            input[0] = response ? 0x5A : 0xA5;
+            input[1] = response ? 0xA5 : 0x5A;
+            std::copy(ti.begin(), ti.end(), input.begin() + 2);
+            input[6] = static_cast<uint8_t>(ctr);
+            input[7] = static_cast<uint8_t>(ctr >> 8);
+            const uint8_t zero[16] = {0};
+            cbc(sesEnc, zero, input.data(), 16, true);
+            return input;
+        }
+
+        std::vector<uint8_t> fail(uint8_t status)
+        {
+            authenticated = false;
+            return {status};
+        }
+
+        std::vector<uint8_t> respond(const std::vector<uint8_t>& data, bool encipher)
+        {
+            std::vector<uint8_t> body = data;
+            if (encipher && !data.empty())
+            {
+                body.push_back(0x80);
+                body.resize(((body.size() + 15) / 16) * 16, 0x00);
+                cbc(sesEnc, ivFor(true, counter).data(), body.data(), body.size(), true);
+            }
+            std::vector<uint8_t> mac = mact(0x00, counter, body);
+            if (corruptNextMac)
+            {
+                mac[0] ^= 0x01;
+                corruptNextMac = false;
+            }
+            std::vector<uint8_t> reply = {0x00};
+            reply.insert(reply.end(), body.begin(), body.end());
+            reply.insert(reply.end(), mac.begin(), mac.end());
+            return reply;
+        }
+
+        std::vector<uint8_t> command(const std::vector<uint8_t>& pdu)
+        {
+            if (!authenticated)
+            {
+                return fail(0xAE);
+            }
+
+            // GetKeyVersion in plain mode: no MAC either way
+            if (pdu[0] == 0x64)
+            {
+                ++counter;
+                return {0x00, 0x10};
+            }
+
+            const std::vector<uint8_t> covered(pdu.begin() + 1, pdu.end() - 8);
+            const std::vector<uint8_t> received(pdu.end() - 8, pdu.end());
+            if (mact(pdu[0], counter, covered) != received)
+            {
+                return fail(0x1E);
+            }
+            ++counter;
+
+            switch (pdu[0])
+            {
+                case 0x51:
+                    return respond(uid, true);
+                case 0xBD:
+                {
+                    const size_t offset = covered[1];
+                    const size_t length = covered[4];
+                    return respond(std::vector<uint8_t>(file.begin() + offset, file.begin() + offset + length), true);
+                }
+                case 0x3D:
+                {
+                    const size_t offset = covered[1];
+                    const size_t length = covered[4];
+                    std::vector<uint8_t> plain(covered.begin() + 7, covered.end());
+                    cbc(sesEnc, ivFor(false, counter - 1).data(), plain.data(), plain.size(), false);
+                    if (plain.size() <= length || plain[length] != 0x80)
+                    {
+                        return fail(0x1E);
+                    }
+                    std::copy(plain.begin(), plain.begin() + length, file.begin() + offset);
+                    return respond({}, false);
+                }
+                default:
+                    return fail(0x1C);
+            }
+        }
+
+        std::vector<uint8_t> beginAuthentication(const std::vector<uint8_t>& pdu)
+        {
+            nonFirst = pdu[0] == 0x77;
+            if (nonFirst && !authenticated)
+            {
+                return fail(0xAE);
+            }
+            authenticated = false;
+            pendingKey = pdu[1];
+            for (size_t i = 0; i < 16; ++i)
+            {
+                rndB[i] = static_cast<uint8_t>(0x40 + 3 * i + pendingKey);
+            }
+            std::vector<uint8_t> reply = {0xAF};
+            Block encrypted = rndB;
+            const uint8_t zero[16] = {0};
+            cbc(keys[pendingKey], zero, encrypted.data(), 16, true);
+            reply.insert(reply.end(), encrypted.begin(), encrypted.end());
+            return reply;
+        }
+
+        std::vector<uint8_t> finishAuthentication(const std::vector<uint8_t>& pdu)
+        {
+            const uint8_t zero[16] = {0};
+            uint8_t plain[32];
+            std::memcpy(plain, pdu.data() + 1, 32);
+            cbc(keys[pendingKey], zero, plain, 32, false);
+
+            Block rndA = {};
+            std::memcpy(rndA.data(), plain, 16);
+            for (size_t i = 0; i < 16; ++i)
+            {
+                if (plain[16 + i] != rndB[(i + 1) % 16])
+                {
+                    return fail(0xAE);
+                }
+            }
+
+            std::vector<uint8_t> sv1 = {0xA5, 0x5A, 0x00, 0x01, 0x00, 0x80, rndA[0], rndA[1]};
+            for (size_t i = 0; i < 6; ++i)
+            {
+                sv1.push_back(static_cast<uint8_t>(rndA[2 + i] ^ rndB[i]));
+            }
+            sv1.insert(sv1.end(), rndB.begin() + 6, rndB.end());
+            sv1.insert(sv1.end(), rndA.begin() + 8, rndA.end());
+            std::vector<uint8_t> sv2 = sv1;
+            sv2[0] = 0x5A;
+            sv2[1] = 0xA5;
+            sesEnc = cmac(keys[pendingKey], sv1);
+            sesMac = cmac(keys[pendingKey], sv2);
+
+            std::vector<uint8_t> body;
+            if (!nonFirst)
+            {
+                ti[0] ^= 0x11;  // new transaction
+                counter = 0;
+                body.insert(body.end(), ti.begin(), ti.end());
+            }
+            for (size_t i = 0; i < 16; ++i)
+            {
+                body.push_back(rndA[(i + 1) % 16]);
+            }
+            if (!nonFirst)
+            {
+                body.insert(body.end(), 12, 0x00);
+            }
+            cbc(keys[pendingKey], zero, body.data(), body.size(), true);
+            authenticated = true;
+
+            std::vector<uint8_t> reply = {0x00};
+            reply.insert(reply.end(), body.begin(), body.end());
+            return reply;
+        }
+
+        std::map<uint8_t, Block> keys;
+        uint8_t pendingKey = 0;
+        bool nonFirst = false;
+        Block rndB = {};
+        Block sesEnc = {};
+        Block sesMac = {};
+    };
+
+    std::vector<uint8_t> toStd(const etl::ivector<uint8_t>& data)
+    {
+        return std::vector<uint8_t>(data.begin(), data.end());
+    }
+
+    etl::vector<uint8_t, 258> toEtl(const std::vector<uint8_t>& data)
+    {
+        return etl::vector<uint8_t, 258>(data.begin(), data.end());
+    }
+
+    class AuthenticateEv2Test : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            ASSERT_TRUE(card.authenticateEv2(0, etl::vector<uint8_t, 16>(KEY_0.begin(), KEY_0.end())).has_value());
+        }
+
+        // GetCardUID through the card's own wrap/unwrap
+        etl::expected<DesfireResult, error::Error> getCardUid()
+        {
+            DesfireRequest request;
+            request.commandCode = 0x51;
+            request.responseMode = CommMode::Enciphered;
+            auto wrapped = card.wrapRequest(request);
+            EXPECT_TRUE(wrapped.has_value());
+            return card.unwrapResponse(toEtl(emulator.process(toStd(wrapped.value()))));
+        }
+
+        // Relayed command through the stateless codec
+        etl::expected<UnwrappedResponse, error::Error> relay(DesfireContext& state, const SecureCommand& command)
+        {
+            auto wrapped = SecureMessagingCodec::wrapCommand(state, command, wire);
+            EXPECT_TRUE(wrapped.has_value());
+            auto unwrapped = SecureMessagingCodec::unwrapResponse(
+                wrapped.value().state,
+                wrapped.value().expectation,
+                toEtl(emulator.process(toStd(wrapped.value().apdu))),
+                wire);
+            if (unwrapped)
+            {
+                state = unwrapped.value().state;
+            }
+            return unwrapped;
+        }
+
+        Ev2Card emulator;
+        NativeWire wire;
+        DesfireCard card{emulator, wire};
+    };
+}
+
+// Test: Session keys match the AuthenticateEV2First example of NXP AN12196
+TEST(AuthenticateEv2KeyTests, DerivesSessionKeysFromSv1AndSv2)
+{
+    const uint8_t rndA[16] = {
+        0x13, 0xC5, 0xDB, 0x8A, 0x59, 0x30, 0x43, 0x9F,
+        0xC3, 0xDE, 0xF9, 0xA4, 0xC6, 0x75, 0x36, 0x0F};
+    const uint8_t rndB[16] = {
+        0xB9, 0xE2, 0xFC, 0x78, 0x9B, 0x64, 0xBF, 0x23,
+        0x7C, 0xCC, 0xAA, 0x20, 0xEC, 0x7E, 0x6E, 0x48};
+    const uint8_t encKey[16] = {
+        0x13, 0x09, 0xC8, 0x77, 0x50, 0x9E, 0x5A, 0x21,
+        0x50, 0x07, 0xFF, 0x0E, 0xD1, 0x9C, 0xA5, 0x64};
+    const uint8_t macKey[16] = {
+        0x4C, 0x66, 0x26, 0xF5, 0xE7, 0x2E, 0xA6, 0x94,
+        0x20, 0x21, 0x39, 0x29, 0x5C, 0x7A, 0x7F, 0xC7};
+
+    DesfireContext context;
+    ASSERT_TRUE(SecureMessagingPolicy::deriveEv2SessionKeys(
+        etl::vector<uint8_t, 16>(16U, 0x00U),
+        etl::vector<uint8_t, 16>(rndA, rndA + 16),
+        etl::vector<uint8_t, 16>(rndB, rndB + 16),
+        context).has_value());
+    EXPECT_TRUE(std::equal(encKey, encKey + 16, context.sessionKeyEnc.begin()));
+    EXPECT_TRUE(std::equal(macKey, macKey + 16, context.sessionKeyMac.begin()));
+}
+
+// Test: First starts a transaction, NonFirst switches keys and keeps TI and counter
+TEST_F(AuthenticateEv2Test, NonFirstKeepsTransaction)
+{
+    const DesfireContext& context = card.getContext();
+    EXPECT_EQ(emulator.sent, (std::vector<uint8_t>{0x71, 0xAF}));
+    EXPECT_EQ(context.authScheme, SessionAuthScheme::Ev2);
+    EXPECT_TRUE(std::equal(emulator.ti.begin(), emulator.ti.end(), context.transactionId.begin()));
+    EXPECT_EQ(context.commandCounter, 0U);
+
+    auto uid = getCardUid();
+    ASSERT_TRUE(uid.has_value());
+    EXPECT_EQ(toStd(uid.value().data), emulator.uid);
+    EXPECT_EQ(context.commandCounter, 1U);
+
+    const etl::vector<uint8_t, 16> previousMacKey(context.sessionKeyMac.begin(), context.sessionKeyMac.end());
+    ASSERT_TRUE(card.authenticateEv2(1, etl::vector<uint8_t, 16>(KEY_1.begin(), KEY_1.end())).has_value());
+    EXPECT_EQ(emulator.sent.back(), 0xAF);
+    EXPECT_EQ(emulator.sent[emulator.sent.size() - 2], 0x77);
+    EXPECT_EQ(context.keyNo, 1U);
+    EXPECT_EQ(context.commandCounter, 1U);
+    EXPECT_TRUE(std::equal(emulator.ti.begin(), emulator.ti.end(), context.transactionId.begin()));
+    EXPECT_FALSE(std::equal(previousMacKey.begin(), previousMacKey.end(), context.sessionKeyMac.begin()));
+
+    uid = getCardUid();
+    ASSERT_TRUE(uid.has_value());
+    EXPECT_EQ(toStd(uid.value().data), emulator.uid);
+    EXPECT_EQ(context.commandCounter, 2U);
+    EXPECT_EQ(emulator.counter, 2U);
+}
+
+// Test: Enciphered write and read through the codec; plain commands still advance the counter
+TEST_F(AuthenticateEv2Test, RelaysEncipheredAndPlainCommands)
+{
+    DesfireContext state = card.getContext();
+
+    SecureCommand write;
+    write.commandCode = 0x3D;
+    write.header = {0x02, 0x04, 0x00, 0x00, 0x10, 0x00, 0x00};
+    for (uint8_t i = 0; i < 16; ++i)
+    {
+        write.data.push_back(static_cast<uint8_t>(0xC0 + i));
+    }
+    write.commMode = CommMode::Enciphered;
+    auto written = relay(state, write);
+    ASSERT_TRUE(written.has_value());
+    EXPECT_TRUE(written.value().isSuccess());
+    EXPECT_EQ(emulator.file[4], 0xC0);
+    EXPECT_EQ(emulator.file[19], 0xCF);
+
+    SecureCommand keyVersion;
+    keyVersion.commandCode = 0x64;
+    keyVersion.header = {0x00};
+    auto version = relay(state, keyVersion);
+    ASSERT_TRUE(version.has_value());
+    ASSERT_EQ(version.value().data.size(), 1U);
+    EXPECT_EQ(version.value().data[0], 0x10);
+    EXPECT_EQ(state.commandCounter, 2U);
+
+    SecureCommand read;
+    read.commandCode = 0xBD;
+    read.header = {0x02, 0x03, 0x00, 0x00, 0x06, 0x00, 0x00};
+    read.commMode = CommMode::MACed;
+    read.responseMode = CommMode::Enciphered;
+    auto data = relay(state, read);
+    ASSERT_TRUE(data.has_value());
+    EXPECT_EQ(toStd(data.value().data), (std::vector<uint8_t>{0x00, 0xC0, 0xC1, 0xC2, 0xC3, 0xC4}));
+    EXPECT_EQ(state.commandCounter, 3U);
+    EXPECT_EQ(emulator.counter, 3U);
+}
+
+// Test: A wrong response MAC is an integrity error
+TEST_F(AuthenticateEv2Test, RejectsTamperedResponse)
+{
+    emulator.corruptNextMac = true;
+    auto uid = getCardUid();
+    ASSERT_FALSE(uid.has_value());
+    EXPECT_EQ(uid.error().get<error::DesfireError>(), error::DesfireError::IntegrityError);
+}
+
+// Test: NonFirst needs a running EV2 session; EV1 chaining helpers refuse EV2 sessions
+TEST_F(AuthenticateEv2Test, NonFirstRequiresEv2Session)
+{
+    AuthenticateEv2CommandOptions options;
+    options.keyNo = 1;
+    options.key.assign(KEY_1.begin(), KEY_1.end());
+    options.nonFirst = true;
+    AuthenticateEv2Command command(options);
+    auto request = command.buildRequest(DesfireContext());
+    ASSERT_FALSE(request.has_value());
+    EXPECT_EQ(request.error().get<error::DesfireError>(), error::DesfireError::InvalidState);
+
+    const etl::vector<uint8_t, 8> message = {0x51};
+    EXPECT_FALSE(SecureMessagingPolicy::derivePlainRequestIv(card.getContext(), message, true).has_value());
+}
+
+// Test: TI and command counter survive serialisation of a relayed session
+TEST_F(AuthenticateEv2Test, SerialisesTransactionState)
+{
+    DesfireContext state = card.getContext();
+    state.commandCounter = 0x1234U;
+    auto restored = SecureMessagingCodec::deserializeState(SecureMessagingCodec::serializeState(state));
+    ASSERT_TRUE(restored.has_value());
+    EXPECT_EQ(restored.value().authScheme, SessionAuthScheme::Ev2);
+    EXPECT_EQ(restored.value().commandCounter, 0x1234U);
+    EXPECT_TRUE(std::equal(state.transactionId.begin(), state.transactionId.end(), restored.value().transactionId.begin()));
+}
+
+// Test: Under EV2 the next request is MACed for CmdCtr + 1 while the current one is in flight
+TEST_F(AuthenticateEv2Test, LearnerPreparesNextRequestInFlight)
+{
+    DesfireSequenceLearner learner(card);
+    learner.beginSequence(1U);
+    DesfireRequest request;
+    request.commandCode = 0x51;
+    request.expectedResponseLength = 0U;
+    request.responseMode = CommMode::Enciphered;
+
+    for (int i = 0; i < 6; ++i)
+    {
+        auto apdu = learner.prepare(request);
+        ASSERT_TRUE(apdu.has_value());
+        learner.speculate();
+        auto uid = learner.complete(toEtl(emulator.process(toStd(apdu.value()))));
+        ASSERT_TRUE(uid.has_value());
+        EXPECT_TRUE(uid.value().isSuccess());
+    }
+
+    // The card accepted both requests sent as prepared
+    EXPECT_EQ(learner.getMetrics().predictions, 3U);
+    EXPECT_EQ(learner.getMetrics().hits, 2U);
+    EXPECT_EQ(learner.getMetrics().stale, 0U);
+    EXPECT_EQ(learner.getMetrics().unpredictable, 0U);
+}
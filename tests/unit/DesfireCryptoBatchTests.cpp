@@ -0,0 +1,317 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <cstring>
+#include <cppdes/des3cbc.h>
+#include "Nfc/Desfire/DesfireCryptoBatch.h"
+#include "Nfc/Desfire/DesfireContext.h"
+#include "Utils/DesfireCrypto.h"
+#include "Error/DesfireError.h"
+
+using namespace nfc;
+
+namespace
+{
+    // NIST SP 800-38A / RFC 4493 AES-128 test key and message
+    constexpr std::array<uint8_t, 16> AES_KEY = {
+        0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6,
+        0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C
+    };
+
+    constexpr std::array<uint8_t, 64> MESSAGE = {
+        0x6B, 0xC1, 0xBE, 0xE2, 0x2E, 0x40, 0x9F, 0x96, 0xE9, 0x3D, 0x7E, 0x11, 0x73, 0x93, 0x17, 0x2A,
+        0xAE, 0x2D, 0x8A, 0x57, 0x1E, 0x03, 0xAC, 0x9C, 0x9E, 0xB7, 0x6F, 0xAC, 0x45, 0xAF, 0x8E, 0x51,
+        0x30, 0xC8, 0x1C, 0x46, 0xA3, 0x5C, 0xE4, 0x11, 0xE5, 0xFB, 0xC1, 0x19, 0x1A, 0x0A, 0x52, 0xEF,
+        0xF6, 0x9F, 0x24, 0x45, 0xDF, 0x4F, 0x9B, 0x17, 0xAD, 0x2B, 0x41, 0x7B, 0xE6, 0x6C, 0x37, 0x10
+    };
+
+    constexpr std::array<uint8_t, 16> CBC_IV = {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+        0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F
+    };
+
+    constexpr std::array<uint8_t, 64> CBC_CIPHERTEXT = {
+        0x76, 0x49, 0xAB, 0xAC, 0x81, 0x19, 0xB2, 0x46, 0xCE, 0xE9, 0x8E, 0x9B, 0x12, 0xE9, 0x19, 0x7D,
+        0x50, 0x86, 0xCB, 0x9B, 0x50, 0x72, 0x19, 0xEE, 0x95, 0xDB, 0x11, 0x3A, 0x91, 0x76, 0x78, 0xB2,
+        0x73, 0xBE, 0xD6, 0xB8, 0xE3, 0xC1, 0x74, 0x3B, 0x71, 0x16, 0xE6, 0x9E, 0x22, 0x22, 0x95, 0x16,
+        0x3F, 0xF1, 0xCA, 0xA1, 0x68, 0x1F, 0xAC, 0x09, 0x12, 0x0E, 0xCA, 0x30, 0x75, 0x86, 0xE1, 0xA7
+    };
+
+    struct CmacVector
+    {
+        size_t length;
+        std::array<uint8_t, 16> mac;
+    };
+
+    constexpr std::array<CmacVector, 4> CMAC_VECTORS = {{
+        {0U, {0xBB, 0x1D, 0x69, 0x29, 0xE9, 0x59, 0x37, 0x28, 0x7F, 0xA3, 0x7D, 0x12, 0x9B, 0x75, 0x67, 0x46}},
+        {16U, {0x07, 0x0A, 0x16, 0xB4, 0x6B, 0x4D, 0x41, 0x44, 0xF7, 0x9B, 0xDD, 0x9D, 0xD0, 0x4A, 0x28, 0x7C}},
+        {40U, {0xDF, 0xA6, 0x67, 0x47, 0xDE, 0x9A, 0xE6, 0x30, 0x30, 0xCA, 0x32, 0x61, 0x14, 0x97, 0xC8, 0x27}},
+        {64U, {0x51, 0xF0, 0xBE, 0xBF, 0x7E, 0x3B, 0x9D, 0x92, 0xFC, 0x49, 0x74, 0x17, 0x79, 0x36, 0x3C, 0xFE}}
+    }};
+
+    DesfireContext buildAesContext(uint8_t seed)
+    {
+        DesfireContext context;
+        context.authenticated = true;
+        context.commMode = CommMode::Enciphered;
+        context.authScheme = SessionAuthScheme::Aes;
+        for (uint8_t i = 0; i < 16; ++i)
+        {
+            context.sessionKeyEnc.push_back(static_cast<uint8_t>(seed + i));
+            context.iv.push_back(0x00);
+        }
+        context.sessionKeyMac = context.sessionKeyEnc;
+        return context;
+    }
+}
+
+TEST(DesfireCryptoBatchTests, AesCbcEncryptAcrossMoreJobsThanLanesMatchesSp80038a)
+{
+    constexpr size_t JOB_COUNT = DesfireCryptoBatch::AES_LANES + 2U;
+    std::array<std::array<uint8_t, 64>, JOB_COUNT> buffers;
+    std::array<std::array<uint8_t, 16>, JOB_COUNT> ivs;
+
+    DesfireCryptoBatch batch;
+    for (size_t i = 0; i < JOB_COUNT; ++i)
+    {
+        buffers[i] = MESSAGE;
+        ivs[i] = CBC_IV;
+
+        DesfireCryptoJob job;
+        job.kind = DesfireCryptoJobKind::AesCbcEncrypt;
+        job.key = AES_KEY.data();
+        job.keyLength = AES_KEY.size();
+        job.iv = ivs[i].data();
+        job.data = buffers[i].data();
+        job.length = ((i % 4U) + 1U) * 16U;  // lanes finish at different blocks
+
+        auto index = batch.submit(job);
+        ASSERT_TRUE(index.has_value());
+        EXPECT_EQ(index.value(), i);
+    }
+
+    EXPECT_EQ(batch.process(), JOB_COUNT);
+    EXPECT_EQ(batch.size(), 0U);
+
+    for (size_t i = 0; i < JOB_COUNT; ++i)
+    {
+        const size_t length = ((i % 4U) + 1U) * 16U;
+        EXPECT_EQ(0, std::memcmp(buffers[i].data(), CBC_CIPHERTEXT.data(), length)) << "job " << i;
+        EXPECT_EQ(0, std::memcmp(buffers[i].data() + length, MESSAGE.data() + length, 64U - length));
+        EXPECT_EQ(0, std::memcmp(ivs[i].data(), CBC_CIPHERTEXT.data() + length - 16U, 16U));
+    }
+}
+
+TEST(DesfireCryptoBatchTests, AesCmacJobsMatchRfc4493AlongsideCbcJob)
+{
+    DesfireCryptoBatch batch;
+    std::array<std::array<uint8_t, 64>, CMAC_VECTORS.size()> messages;
+    std::array<std::array<uint8_t, 16>, CMAC_VECTORS.size()> ivs = {};
+    std::array<std::array<uint8_t, 16>, CMAC_VECTORS.size()> macs = {};
+
+    for (size_t i = 0; i < CMAC_VECTORS.size(); ++i)
+    {
+        messages[i] = MESSAGE;
+
+        DesfireCryptoJob job;
+        job.kind = DesfireCryptoJobKind::AesCmac;
+        job.key = AES_KEY.data();
+        job.keyLength = AES_KEY.size();
+        job.iv = ivs[i].data();
+        job.data = messages[i].data();
+        job.length = CMAC_VECTORS[i].length;
+        job.mac = macs[i].data();
+        ASSERT_TRUE(batch.submit(job).has_value());
+    }
+
+    std::array<uint8_t, 64> cbcBuffer = MESSAGE;
+    std::array<uint8_t, 16> cbcIv = CBC_IV;
+    DesfireCryptoJob cbcJob;
+    cbcJob.kind = DesfireCryptoJobKind::AesCbcEncrypt;
+    cbcJob.key = AES_KEY.data();
+    cbcJob.keyLength = AES_KEY.size();
+    cbcJob.iv = cbcIv.data();
+    cbcJob.data = cbcBuffer.data();
+    cbcJob.length = cbcBuffer.size();
+    ASSERT_TRUE(batch.submit(cbcJob).has_value());
+
+    batch.process();
+
+    for (size_t i = 0; i < CMAC_VECTORS.size(); ++i)
+    {
+        EXPECT_EQ(macs[i], CMAC_VECTORS[i].mac) << "length " << CMAC_VECTORS[i].length;
+        EXPECT_EQ(ivs[i], CMAC_VECTORS[i].mac);
+        EXPECT_EQ(messages[i], MESSAGE);
+    }
+    EXPECT_EQ(cbcBuffer, CBC_CIPHERTEXT);
+}
+
+TEST(DesfireCryptoBatchTests, AesCbcDecryptRestoresPlaintext)
+{
+    std::array<uint8_t, 64> first = CBC_CIPHERTEXT;
+    std::array<uint8_t, 16> firstIv = CBC_IV;
+    std::array<uint8_t, 64> second = CBC_CIPHERTEXT;
+    std::array<uint8_t, 16> secondIv = CBC_IV;
+
+    DesfireCryptoBatch batch;
+    DesfireCryptoJob job;
+    job.kind = DesfireCryptoJobKind::AesCbcDecrypt;
+    job.key = AES_KEY.data();
+    job.keyLength = AES_KEY.size();
+    job.iv = firstIv.data();
+    job.data = first.data();
+    job.length = first.size();
+    ASSERT_TRUE(batch.submit(job).has_value());
+
+    job.iv = secondIv.data();
+    job.data = second.data();
+    job.length = 32U;
+    ASSERT_TRUE(batch.submit(job).has_value());
+
+    batch.process();
+
+    EXPECT_EQ(first, MESSAGE);
+    EXPECT_EQ(0, std::memcmp(firstIv.data(), CBC_CIPHERTEXT.data() + 48U, 16U));
+    EXPECT_EQ(0, std::memcmp(second.data(), MESSAGE.data(), 32U));
+    EXPECT_EQ(0, std::memcmp(second.data() + 32U, CBC_CIPHERTEXT.data() + 32U, 32U));
+    EXPECT_EQ(0, std::memcmp(secondIv.data(), CBC_CIPHERTEXT.data() + 16U, 16U));
+}
+
+TEST(DesfireCryptoBatchTests, TdesJobsMatchSingleSessionCbc)
+{
+    const std::array<uint8_t, 24> key = {
+        0x00, 0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0x70,
+        0x80, 0x90, 0xA0, 0xB0, 0xC0, 0xD0, 0xE0, 0xF0,
+        0x02, 0x12, 0x22, 0x32, 0x42, 0x52, 0x62, 0x72
+    };
+    std::array<uint8_t, 32> data;
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = static_cast<uint8_t>(i * 7U);
+    }
+    const std::array<uint8_t, 32> plain = data;
+    std::array<uint8_t, 8> iv = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+    const std::array<uint8_t, 8> initialIv = iv;
+
+    std::array<uint8_t, 32> expected = {};
+    DES3CBC reference(
+        crypto::bytesToUint64(key.data()),
+        crypto::bytesToUint64(key.data() + 8U),
+        crypto::bytesToUint64(key.data() + 16U),
+        crypto::bytesToUint64(initialIv.data()));
+    for (size_t offset = 0; offset < plain.size(); offset += 8U)
+    {
+        crypto::uint64ToBytes(reference.encrypt(crypto::bytesToUint64(plain.data() + offset)), expected.data() + offset);
+    }
+
+    DesfireCryptoBatch batch;
+    DesfireCryptoJob job;
+    job.kind = DesfireCryptoJobKind::TdesCbcEncrypt;
+    job.key = key.data();
+    job.keyLength = key.size();
+    job.iv = iv.data();
+    job.data = data.data();
+    job.length = data.size();
+    ASSERT_TRUE(batch.submit(job).has_value());
+    batch.process();
+
+    EXPECT_EQ(data, expected);
+    EXPECT_EQ(0, std::memcmp(iv.data(), expected.data() + 24U, 8U));
+
+    iv = initialIv;
+    job.kind = DesfireCryptoJobKind::TdesCbcDecrypt;
+    ASSERT_TRUE(batch.submit(job).has_value());
+    batch.process();
+
+    EXPECT_EQ(data, plain);
+}
+
+TEST(DesfireCryptoBatchTests, ContextJobsUseSessionKeyAndAdvanceIv)
+{
+    DesfireContext first = buildAesContext(0x10);
+    DesfireContext second = buildAesContext(0x40);
+
+    std::array<uint8_t, 32> firstData = {};
+    std::array<uint8_t, 16> secondMac = {};
+    std::array<uint8_t, 8> secondMessage = {0x3D, 0x01, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00};
+
+    DesfireCryptoBatch batch;
+    ASSERT_TRUE(batch.submit(first, DesfireCryptoJobKind::AesCbcEncrypt, firstData.data(), firstData.size()).has_value());
+    ASSERT_TRUE(batch.submit(second, DesfireCryptoJobKind::AesCmac, secondMessage.data(), secondMessage.size(), secondMac.data()).has_value());
+
+    auto duplicate = batch.submit(first, DesfireCryptoJobKind::AesCmac, firstData.data(), firstData.size(), secondMac.data());
+    ASSERT_FALSE(duplicate.has_value());
+    EXPECT_EQ(duplicate.error().get<error::DesfireError>(), error::DesfireError::DuplicateError);
+
+    batch.process();
+
+    // Same jobs one at a time must give identical results.
+    DesfireContext firstAlone = buildAesContext(0x10);
+    DesfireContext secondAlone = buildAesContext(0x40);
+    std::array<uint8_t, 32> firstAloneData = {};
+    std::array<uint8_t, 16> secondAloneMac = {};
+
+    DesfireCryptoBatch single;
+    ASSERT_TRUE(single.submit(firstAlone, DesfireCryptoJobKind::AesCbcEncrypt, firstAloneData.data(), firstAloneData.size()).has_value());
+    single.process();
+    ASSERT_TRUE(single.submit(secondAlone, DesfireCryptoJobKind::AesCmac, secondMessage.data(), secondMessage.size(), secondAloneMac.data()).has_value());
+    single.process();
+
+    EXPECT_EQ(firstData, firstAloneData);
+    EXPECT_EQ(secondMac, secondAloneMac);
+    EXPECT_EQ(0, std::memcmp(first.iv.data(), firstData.data() + 16U, 16U));
+    EXPECT_EQ(0, std::memcmp(second.iv.data(), secondMac.data(), 16U));
+    EXPECT_NE(firstData, (std::array<uint8_t, 32>{}));
+}
+
+TEST(DesfireCryptoBatchTests, SubmitRejectsInvalidJobs)
+{
+    DesfireCryptoBatch batch;
+    std::array<uint8_t, 16> iv = {};
+    std::array<uint8_t, 20> data = {};
+
+    DesfireCryptoJob job;
+    job.kind = DesfireCryptoJobKind::AesCbcEncrypt;
+    job.key = AES_KEY.data();
+    job.keyLength = AES_KEY.size();
+    job.iv = iv.data();
+    job.data = data.data();
+    job.length = data.size();
+
+    auto unaligned = batch.submit(job);
+    ASSERT_FALSE(unaligned.has_value());
+    EXPECT_EQ(unaligned.error().get<error::DesfireError>(), error::DesfireError::LengthError);
+
+    job.kind = DesfireCryptoJobKind::AesCmac;
+    auto missingMac = batch.submit(job);
+    ASSERT_FALSE(missingMac.has_value());
+    EXPECT_EQ(missingMac.error().get<error::DesfireError>(), error::DesfireError::ParameterError);
+
+    job.kind = DesfireCryptoJobKind::TdesCbcEncrypt;
+    job.keyLength = 8U;
+    job.length = 16U;
+    auto shortKey = batch.submit(job);
+    ASSERT_FALSE(shortKey.has_value());
+    EXPECT_EQ(shortKey.error().get<error::DesfireError>(), error::DesfireError::ParameterError);
+
+    DesfireContext unauthenticated;
+    auto noSession = batch.submit(unauthenticated, DesfireCryptoJobKind::AesCbcEncrypt, data.data(), 16U);
+    ASSERT_FALSE(noSession.has_value());
+    EXPECT_EQ(noSession.error().get<error::DesfireError>(), error::DesfireError::AuthenticationError);
+
+    std::array<std::array<uint8_t, 16>, DesfireCryptoBatch::MAX_JOBS + 1U> ivs = {};
+    job.kind = DesfireCryptoJobKind::AesCbcEncrypt;
+    job.keyLength = AES_KEY.size();
+    for (size_t i = 0; i < DesfireCryptoBatch::MAX_JOBS; ++i)
+    {
+        job.iv = ivs[i].data();
+        ASSERT_TRUE(batch.submit(job).has_value());
+    }
+    job.iv = ivs[DesfireCryptoBatch::MAX_JOBS].data();
+    auto full = batch.submit(job);
+    ASSERT_FALSE(full.has_value());
+    EXPECT_EQ(full.error().get<error::DesfireError>(), error::DesfireError::CountError);
+
+    batch.clear();
+    EXPECT_EQ(batch.size(), 0U);
+}
@@ -0,0 +1,476 @@
+#include <gtest/gtest.h>
+#include <cctype>
+#include <deque>
+#include <string_view>
+#include <vector>
+#include "Nfc/Desfire/KeyRotationCampaign.h"
+#include "Nfc/Desfire/KeyRotationJournal.h"
+#include "Nfc/Desfire/KeyRotationEngine.h"
+#include "Nfc/Desfire/Commands/ChangeKeyCommand.h"
+#include "Nfc/Desfire/DesfireCard.h"
+#include "Nfc/Desfire/DesfireContext.h"
+#include "Nfc/Apdu/IApduTransceiver.h"
+#include "Nfc/Wire/NativeWire.h"
+#include "Error/DesfireError.h"
+#include "Utils/Serialization.h"
+
+using namespace nfc;
+
+namespace
+{
+    std::vector<uint8_t> hexToBytes(std::string_view text)
+    {
+        std::vector<uint8_t> bytes;
+        int high = -1;
+        for (char c : text)
+        {
+            if (!std::isxdigit(static_cast<unsigned char>(c)))
+            {
+                continue;
+            }
+            const int value = std::isdigit(static_cast<unsigned char>(c))
+                ? (c - '0')
+                : (std::toupper(static_cast<unsigned char>(c)) - 'A' + 10);
+            if (high < 0)
+            {
+                high = value;
+            }
+            else
+            {
+                bytes.push_back(static_cast<uint8_t>((high << 4) | value));
+                high = -1;
+            }
+        }
+        return bytes;
+    }
+
+    template <size_t Capacity>
+    etl::vector<uint8_t, Capacity> toEtl(const std::vector<uint8_t>& bytes)
+    {
+        etl::vector<uint8_t, Capacity> out;
+        for (uint8_t b : bytes)
+        {
+            out.push_back(b);
+        }
+        return out;
+    }
+
+    std::vector<uint8_t> toStdVector(const etl::ivector<uint8_t>& data)
+    {
+        return std::vector<uint8_t>(data.begin(), data.end());
+    }
+
+    DesfireContext buildContext(
+        const std::vector<uint8_t>& sessionKey,
+        const std::vector<uint8_t>& iv,
+        uint8_t authenticatedKeyNo)
+    {
+        DesfireContext context;
+        context.authenticated = true;
+        context.commMode = CommMode::Enciphered;
+        context.keyNo = authenticatedKeyNo;
+        for (uint8_t b : sessionKey)
+        {
+            context.sessionKeyEnc.push_back(b);
+        }
+        for (uint8_t b : iv)
+        {
+            context.iv.push_back(b);
+        }
+        return context;
+    }
+
+    ChangeKeyCommandOptions isoDesDifferentKeyOptions()
+    {
+        ChangeKeyCommandOptions options;
+        options.keyNo = 0x01;
+        options.authMode = DesfireAuthMode::ISO;
+        options.sessionKeyType = DesfireKeyType::DES;
+        options.newKeyType = DesfireKeyType::DES3_2K;
+        options.newKey = toEtl<24>(hexToBytes("00 10 20 31 40 50 60 70 80 90 A0 B0 B0 A0 90 80"));
+        options.newKeyVersion = 0x00;
+        options.oldKey = toEtl<24>(hexToBytes("00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00"));
+        return options;
+    }
+
+    KeyRotationCampaignSettings aesCampaignSettings()
+    {
+        KeyRotationCampaignSettings settings;
+        settings.aid = {0x01, 0x02, 0x03};
+        settings.keyNo = 0x01;
+        settings.authKeyNo = 0x00;
+        settings.authMode = DesfireAuthMode::AES;
+        settings.sessionKeyType = DesfireKeyType::AES;
+        settings.newKeyType = DesfireKeyType::AES;
+        settings.newKeyVersion = 0x05;
+        return settings;
+    }
+
+    std::vector<uint8_t> buildAesCampaign(const std::vector<std::vector<uint8_t>>& uids)
+    {
+        std::vector<uint8_t> image(KeyRotationCampaignFormat::imageSize(uids.size()));
+        KeyRotationCampaignWriter writer(image.data(), image.size(), aesCampaignSettings());
+        for (size_t i = 0; i < uids.size(); ++i)
+        {
+            etl::vector<uint8_t, 24> newKey;
+            etl::vector<uint8_t, 24> oldKey;
+            for (uint8_t b = 0; b < 16; ++b)
+            {
+                newKey.push_back(static_cast<uint8_t>(0xA0 + b + i));
+                oldKey.push_back(static_cast<uint8_t>(b));
+            }
+            EXPECT_TRUE(writer.addCard(toEtl<10>(uids[i]), newKey, oldKey).has_value());
+        }
+        auto size = writer.finish();
+        EXPECT_TRUE(size.has_value());
+        EXPECT_EQ(size.value(), image.size());
+        return image;
+    }
+
+    class MemoryJournalStorage : public IKeyRotationJournalStorage
+    {
+    public:
+        size_t size() const override
+        {
+            return bytes.size();
+        }
+
+        etl::expected<void, error::Error> read(size_t offset, uint8_t* out, size_t length) override
+        {
+            std::copy(bytes.begin() + offset, bytes.begin() + offset + length, out);
+            return {};
+        }
+
+        etl::expected<void, error::Error> append(const uint8_t* data, size_t length) override
+        {
+            bytes.insert(bytes.end(), data, data + length);
+            return {};
+        }
+
+        etl::expected<void, error::Error> truncate(size_t length) override
+        {
+            bytes.resize(length);
+            return {};
+        }
+
+        etl::expected<void, error::Error> sync() override
+        {
+            ++syncCount;
+            return {};
+        }
+
+        std::vector<uint8_t> bytes;
+        size_t syncCount = 0U;
+    };
+
+    class ScriptedTransceiver : public IApduTransceiver
+    {
+    public:
+        void setWire(IWire&) override
+        {
+        }
+
+        etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> transceive(
+            const etl::ivector<uint8_t>& apdu) override
+        {
+            sent.push_back(toStdVector(apdu));
+            etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX> response;
+            if (responses.empty())
+            {
+                return etl::unexpected(error::Error::fromDesfire(error::DesfireError::CommandAborted));
+            }
+            for (uint8_t b : responses.front())
+            {
+                response.push_back(b);
+            }
+            responses.pop_front();
+            return response;
+        }
+
+        std::deque<std::vector<uint8_t>> responses;
+        std::vector<std::vector<uint8_t>> sent;
+    };
+}
+
+TEST(DesfireKeyRotationTests, PrecomputedCryptogramMatchesDirectChangeKey)
+{
+    const ChangeKeyCommandOptions direct = isoDesDifferentKeyOptions();
+    auto precomputed = ChangeKeyCommand::precompute(direct, false, 0x00);
+    ASSERT_TRUE(precomputed.has_value());
+    EXPECT_EQ(precomputed.value().effectiveKeyNo, 0x01);
+    EXPECT_FALSE(precomputed.value().sameKey);
+
+    // Only the key number and the precomputed part are passed on tap.
+    ChangeKeyCommandOptions tapOptions;
+    tapOptions.keyNo = 0x01;
+    tapOptions.sessionKeyType = DesfireKeyType::DES;
+    tapOptions.precomputed = &precomputed.value();
+
+    DesfireContext context = buildContext(
+        hexToBytes("CA A6 74 E8 CA E8 52 5E CA A6 74 E8 CA E8 52 5E"),
+        hexToBytes("00 00 00 00 00 00 00 00"),
+        0x00);
+
+    ChangeKeyCommand command(tapOptions);
+    auto request = command.buildRequest(context);
+    ASSERT_TRUE(request.has_value());
+    EXPECT_EQ(toStdVector(request.value().data), hexToBytes(
+        "01 4E B6 69 E4 8D CA 58 47 49 54 2E 1B E8 9C B4 C7 84 5A 38 C5 7D 19 DE 59"));
+}
+
+TEST(DesfireKeyRotationTests, PrecomputedCryptogramRejectsDifferentAuthenticatedKey)
+{
+    auto precomputed = ChangeKeyCommand::precompute(isoDesDifferentKeyOptions(), false, 0x00);
+    ASSERT_TRUE(precomputed.has_value());
+
+    ChangeKeyCommandOptions tapOptions;
+    tapOptions.keyNo = 0x01;
+    tapOptions.precomputed = &precomputed.value();
+
+    // Session authenticated with key 1: cryptogram layout would be same-key.
+    DesfireContext context = buildContext(
+        hexToBytes("CA A6 74 E8 CA E8 52 5E CA A6 74 E8 CA E8 52 5E"),
+        hexToBytes("00 00 00 00 00 00 00 00"),
+        0x01);
+
+    ChangeKeyCommand command(tapOptions);
+    auto request = command.buildRequest(context);
+    ASSERT_FALSE(request.has_value());
+    EXPECT_EQ(request.error().get<error::DesfireError>(), error::DesfireError::ParameterError);
+}
+
+TEST(DesfireKeyRotationTests, CampaignImageIsSortedAndSearchable)
+{
+    const std::vector<std::vector<uint8_t>> uids = {
+        hexToBytes("04 AA BB CC DD EE 80"),
+        hexToBytes("04 11 22 33 44 55 80"),
+        hexToBytes("DE AD BE EF"),
+        hexToBytes("04 77 22 33 44 55 80")
+    };
+    const std::vector<uint8_t> image = buildAesCampaign(uids);
+
+    KeyRotationCampaignView view;
+    ASSERT_TRUE(view.open(image.data(), image.size()).has_value());
+    EXPECT_EQ(view.recordCount(), uids.size());
+    EXPECT_EQ(view.settings().newKeyVersion, 0x05);
+    EXPECT_EQ(view.settings().aid[2], 0x03);
+
+    // 4-byte UIDs order before 7-byte UIDs.
+    EXPECT_EQ(view.find(toEtl<10>(uids[2])).value(), 0U);
+    EXPECT_EQ(view.find(toEtl<10>(uids[1])).value(), 1U);
+    EXPECT_EQ(view.find(toEtl<10>(uids[3])).value(), 2U);
+    EXPECT_EQ(view.find(toEtl<10>(uids[0])).value(), 3U);
+    EXPECT_FALSE(view.find(toEtl<10>(hexToBytes("04 00 00 00 00 00 00"))).has_value());
+
+    auto cryptogram = view.cryptogram(1U);
+    ASSERT_TRUE(cryptogram.has_value());
+    EXPECT_EQ(cryptogram.value().effectiveKeyNo, 0x01);
+    EXPECT_FALSE(cryptogram.value().sameKey);
+    EXPECT_EQ(cryptogram.value().authMode, DesfireAuthMode::AES);
+    // 16 key bytes + version + CRC32(cryptogram) + CRC32(new key)
+    EXPECT_EQ(cryptogram.value().plaintext.size(), 25U);
+}
+
+TEST(DesfireKeyRotationTests, CampaignWriterRejectsDuplicatesAndOverflow)
+{
+    std::vector<uint8_t> image(KeyRotationCampaignFormat::imageSize(1U));
+    KeyRotationCampaignWriter writer(image.data(), image.size(), aesCampaignSettings());
+    const auto key = toEtl<24>(hexToBytes("00 11 22 33 44 55 66 77 88 99 AA BB CC DD EE FF"));
+    const auto uid = toEtl<10>(hexToBytes("04 11 22 33 44 55 80"));
+
+    ASSERT_TRUE(writer.addCard(uid, key, key).has_value());
+
+    auto overflow = writer.addCard(toEtl<10>(hexToBytes("04 22 22 33 44 55 80")), key, key);
+    ASSERT_FALSE(overflow.has_value());
+    EXPECT_EQ(overflow.error().get<error::DesfireError>(), error::DesfireError::CountError);
+
+    image.resize(KeyRotationCampaignFormat::imageSize(2U));
+    KeyRotationCampaignWriter larger(image.data(), image.size(), aesCampaignSettings());
+    ASSERT_TRUE(larger.addCard(uid, key, key).has_value());
+    auto duplicate = larger.addCard(uid, key, key);
+    ASSERT_FALSE(duplicate.has_value());
+    EXPECT_EQ(duplicate.error().get<error::DesfireError>(), error::DesfireError::DuplicateError);
+}
+
+TEST(DesfireKeyRotationTests, CampaignViewDetectsCorruption)
+{
+    std::vector<uint8_t> image = buildAesCampaign({hexToBytes("04 11 22 33 44 55 80")});
+
+    KeyRotationCampaignView view;
+    std::vector<uint8_t> damagedRecord = image;
+    damagedRecord[KeyRotationCampaignFormat::HEADER_SIZE + 20U] ^= 0x01U;
+    auto opened = view.open(damagedRecord.data(), damagedRecord.size());
+    ASSERT_FALSE(opened.has_value());
+    EXPECT_EQ(opened.error().get<error::DesfireError>(), error::DesfireError::IntegrityError);
+
+    // A record changed together with its own CRC still breaks the campaign CRC
+    std::vector<uint8_t> replacedRecord = image;
+    uint8_t* record = replacedRecord.data() + KeyRotationCampaignFormat::HEADER_SIZE;
+    record[20] ^= 0x01U;
+    utils::writeLe32(record + KeyRotationCampaignFormat::RECORD_SIZE - 4U,
+                     utils::crc32(record, KeyRotationCampaignFormat::RECORD_SIZE - 4U));
+    opened = view.open(replacedRecord.data(), replacedRecord.size());
+    ASSERT_FALSE(opened.has_value());
+    EXPECT_EQ(opened.error().get<error::DesfireError>(), error::DesfireError::IntegrityError);
+
+    // Damage after open is still caught per record
+    std::vector<uint8_t> mapped = image;
+    ASSERT_TRUE(view.open(mapped.data(), mapped.size()).has_value());
+    mapped[KeyRotationCampaignFormat::HEADER_SIZE + 20U] ^= 0x01U;
+    auto cryptogram = view.cryptogram(0U);
+    ASSERT_FALSE(cryptogram.has_value());
+    EXPECT_EQ(cryptogram.error().get<error::DesfireError>(), error::DesfireError::IntegrityError);
+
+    std::vector<uint8_t> damagedHeader = image;
+    damagedHeader[10] ^= 0x01U;
+    opened = view.open(damagedHeader.data(), damagedHeader.size());
+    ASSERT_FALSE(opened.has_value());
+    EXPECT_EQ(opened.error().get<error::DesfireError>(), error::DesfireError::IntegrityError);
+
+    opened = view.open(image.data(), image.size() - 1U);
+    ASSERT_FALSE(opened.has_value());
+    EXPECT_EQ(opened.error().get<error::DesfireError>(), error::DesfireError::LengthError);
+}
+
+TEST(DesfireKeyRotationTests, CampaignIdCoversRecordContents)
+{
+    const std::vector<uint8_t> uidA = hexToBytes("04 11 22 33 44 55 80");
+    const std::vector<uint8_t> uidB = hexToBytes("04 AA BB CC DD EE 80");
+    const auto key = toEtl<24>(hexToBytes("00 11 22 33 44 55 66 77 88 99 AA BB CC DD EE FF"));
+    const auto otherKey = toEtl<24>(hexToBytes("FF EE DD CC BB AA 99 88 77 66 55 44 33 22 11 00"));
+
+    // Same header fields, different cards.
+    const std::vector<uint8_t> first = buildAesCampaign({uidA});
+    const std::vector<uint8_t> second = buildAesCampaign({uidB});
+
+    // Same cards, different key for the one card.
+    std::vector<uint8_t> third(KeyRotationCampaignFormat::imageSize(1U));
+    KeyRotationCampaignWriter writer(third.data(), third.size(), aesCampaignSettings());
+    ASSERT_TRUE(writer.addCard(toEtl<10>(uidA), otherKey, key).has_value());
+    ASSERT_TRUE(writer.finish().has_value());
+
+    KeyRotationCampaignView firstView;
+    KeyRotationCampaignView secondView;
+    KeyRotationCampaignView thirdView;
+    ASSERT_TRUE(firstView.open(first.data(), first.size()).has_value());
+    ASSERT_TRUE(secondView.open(second.data(), second.size()).has_value());
+    ASSERT_TRUE(thirdView.open(third.data(), third.size()).has_value());
+    EXPECT_NE(firstView.campaignId(), secondView.campaignId());
+    EXPECT_NE(firstView.campaignId(), thirdView.campaignId());
+}
+
+TEST(DesfireKeyRotationTests, JournalReplaysStateAndDropsTornRecord)
+{
+    const std::vector<std::vector<uint8_t>> uids = {
+        hexToBytes("04 11 22 33 44 55 80"),
+        hexToBytes("04 22 22 33 44 55 80"),
+        hexToBytes("04 33 22 33 44 55 80")
+    };
+    const std::vector<uint8_t> image = buildAesCampaign(uids);
+    KeyRotationCampaignView view;
+    ASSERT_TRUE(view.open(image.data(), image.size()).has_value());
+
+    MemoryJournalStorage storage;
+
+    {
+        KeyRotationState states[3];
+        KeyRotationJournal journal(storage, states, 3U);
+        auto started = journal.recover(view);
+        ASSERT_TRUE(started.has_value());
+        EXPECT_EQ(started.value(), 0U);
+
+        ASSERT_TRUE(journal.markInProgress(0U, toEtl<10>(uids[0])).has_value());
+        ASSERT_TRUE(journal.markDone(0U, toEtl<10>(uids[0])).has_value());
+        ASSERT_TRUE(journal.markInProgress(2U, toEtl<10>(uids[2])).has_value());
+        EXPECT_EQ(storage.syncCount, 4U);
+    }
+
+    // Crash in the middle of the next append.
+    const size_t intactSize = storage.bytes.size();
+    storage.bytes.insert(storage.bytes.end(), {0x4A, 0x03, 0x07});
+
+    KeyRotationState states[3];
+    KeyRotationJournal journal(storage, states, 3U);
+    auto replayed = journal.recover(view);
+    ASSERT_TRUE(replayed.has_value());
+    EXPECT_EQ(replayed.value(), 3U);
+    EXPECT_EQ(storage.bytes.size(), intactSize);
+    EXPECT_EQ(journal.state(0U), KeyRotationState::Done);
+    EXPECT_EQ(journal.state(1U), KeyRotationState::Pending);
+    EXPECT_EQ(journal.state(2U), KeyRotationState::InProgress);
+
+    const std::vector<uint8_t> otherImage = buildAesCampaign({uids[0], uids[1]});
+    KeyRotationCampaignView otherView;
+    ASSERT_TRUE(otherView.open(otherImage.data(), otherImage.size()).has_value());
+    KeyRotationJournal other(storage, states, 3U);
+    auto mismatch = other.recover(otherView);
+    ASSERT_FALSE(mismatch.has_value());
+    EXPECT_EQ(mismatch.error().get<error::DesfireError>(), error::DesfireError::ParameterError);
+}
+
+TEST(DesfireKeyRotationTests, JournalRejectsRecordForAnotherCard)
+{
+    const std::vector<uint8_t> uidA = hexToBytes("04 11 22 33 44 55 80");
+    const std::vector<uint8_t> uidB = hexToBytes("04 AA BB CC DD EE 80");
+    const std::vector<uint8_t> image = buildAesCampaign({uidA, uidB});
+    KeyRotationCampaignView view;
+    ASSERT_TRUE(view.open(image.data(), image.size()).has_value());
+
+    MemoryJournalStorage storage;
+    KeyRotationState states[2];
+    {
+        KeyRotationJournal journal(storage, states, 2U);
+        ASSERT_TRUE(journal.recover(view).has_value());
+        // Record index 0 belongs to card A, not card B.
+        ASSERT_TRUE(journal.markDone(0U, toEtl<10>(uidB)).has_value());
+    }
+
+    KeyRotationJournal journal(storage, states, 2U);
+    auto replayed = journal.recover(view);
+    ASSERT_FALSE(replayed.has_value());
+    EXPECT_EQ(replayed.error().get<error::DesfireError>(), error::DesfireError::IntegrityError);
+    EXPECT_EQ(journal.state(0U), KeyRotationState::Pending);
+}
+
+TEST(DesfireKeyRotationTests, EngineSkipsFinishedCardsAndConfirmsInterruptedOnes)
+{
+    const std::vector<uint8_t> uidA = hexToBytes("04 11 22 33 44 55 80");
+    const std::vector<uint8_t> uidB = hexToBytes("04 AA BB CC DD EE 80");
+    const std::vector<uint8_t> image = buildAesCampaign({uidA, uidB});
+
+    KeyRotationCampaignView view;
+    ASSERT_TRUE(view.open(image.data(), image.size()).has_value());
+
+    MemoryJournalStorage storage;
+    KeyRotationState states[2];
+    KeyRotationJournal journal(storage, states, 2U);
+    ASSERT_TRUE(journal.recover(view).has_value());
+    ASSERT_TRUE(journal.markDone(view.find(toEtl<10>(uidA)).value(), toEtl<10>(uidA)).has_value());
+    ASSERT_TRUE(journal.markInProgress(view.find(toEtl<10>(uidB)).value(), toEtl<10>(uidB)).has_value());
+
+    ScriptedTransceiver transceiver;
+    NativeWire wire;
+    DesfireCard card(transceiver, wire);
+    KeyRotationEngine engine(view, journal);
+    const etl::vector<uint8_t, 24> authKey = toEtl<24>(std::vector<uint8_t>(16U, 0x00U));
+
+    auto unknown = engine.apply(card, toEtl<10>(hexToBytes("01 02 03 04")), authKey);
+    ASSERT_TRUE(unknown.has_value());
+    EXPECT_EQ(unknown.value(), KeyRotationOutcome::NotInCampaign);
+
+    auto finished = engine.apply(card, toEtl<10>(uidA), authKey);
+    ASSERT_TRUE(finished.has_value());
+    EXPECT_EQ(finished.value(), KeyRotationOutcome::AlreadyRotated);
+    EXPECT_TRUE(transceiver.sent.empty());
+
+    // Card B already holds key version 5: journal it without ChangeKey.
+    transceiver.responses.push_back({0x00});
+    transceiver.responses.push_back({0x00, 0x05});
+    auto interrupted = engine.apply(card, toEtl<10>(uidB), authKey);
+    ASSERT_TRUE(interrupted.has_value());
+    EXPECT_EQ(interrupted.value(), KeyRotationOutcome::AlreadyRotated);
+    ASSERT_EQ(transceiver.sent.size(), 2U);
+    EXPECT_EQ(transceiver.sent[0], hexToBytes("5A 01 02 03"));
+    EXPECT_EQ(transceiver.sent[1], hexToBytes("64 01"));
+    EXPECT_EQ(journal.state(view.find(toEtl<10>(uidB)).value()), KeyRotationState::Done);
+}
@@ -0,0 +1,308 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <cstring>
+#include <aes.hpp>
+#include "Nfc/Desfire/DesfireKeyStore.h"
+#include "Nfc/Desfire/Commands/AuthenticateCommand.h"
+#include "Nfc/Desfire/Commands/ChangeKeyCommand.h"
+#include "Nfc/Desfire/DesfireContext.h"
+#include "Error/DesfireError.h"
+
+using namespace nfc;
+
+namespace
+{
+    template <size_t Capacity>
+    etl::vector<uint8_t, Capacity> makeKey(std::initializer_list<uint8_t> bytes)
+    {
+        etl::vector<uint8_t, Capacity> out;
+        for (uint8_t b : bytes)
+        {
+            out.push_back(b);
+        }
+        return out;
+    }
+
+    std::array<uint8_t, 16> rotateLeft16(const std::array<uint8_t, 16>& in)
+    {
+        std::array<uint8_t, 16> out = {};
+        for (size_t i = 0; i < 15; ++i)
+        {
+            out[i] = in[i + 1];
+        }
+        out[15] = in[0];
+        return out;
+    }
+
+    DesfireContext buildAuthenticatedContext(uint8_t keyNo)
+    {
+        DesfireContext context;
+        context.authenticated = true;
+        context.commMode = CommMode::Enciphered;
+        context.authScheme = SessionAuthScheme::Iso;
+        context.keyNo = keyNo;
+        for (uint8_t i = 0; i < 16; ++i)
+        {
+            context.sessionKeyEnc.push_back(static_cast<uint8_t>(0x10 + i * 2));
+            context.iv.push_back(0x00);
+        }
+        context.iv.resize(8);
+        context.sessionKeyMac = context.sessionKeyEnc;
+        context.selectedAid.push_back(0x01);
+        context.selectedAid.push_back(0x02);
+        context.selectedAid.push_back(0x03);
+        return context;
+    }
+}
+
+TEST(DesfireKeyStoreTests, RegisterNormalizesDesParityAndKeepsAesBytes)
+{
+    DesfireKeyStore store;
+
+    auto desHandle = store.registerKey(DesfireKeyType::DES3_2K, makeKey<16>({
+        0x01, 0x03, 0x05, 0x07, 0x09, 0x0B, 0x0D, 0x0F,
+        0x11, 0x13, 0x15, 0x17, 0x19, 0x1B, 0x1D, 0x1F}), 0x02);
+    ASSERT_TRUE(desHandle.has_value());
+
+    const DesfireStoredKey* desKey = store.find(desHandle.value());
+    ASSERT_NE(desKey, nullptr);
+    ASSERT_EQ(desKey->key.size(), 16U);
+    for (size_t i = 0; i < desKey->key.size(); ++i)
+    {
+        EXPECT_EQ(desKey->key[i] & 0x01, 0x00);
+    }
+    EXPECT_EQ(desKey->version, 0x02);
+    EXPECT_FALSE(desKey->singleDesKey);
+    EXPECT_FALSE(desKey->hasAesSchedule);
+
+    auto aesHandle = store.registerKey(DesfireKeyType::AES, makeKey<16>({
+        0x01, 0x11, 0x21, 0x31, 0x41, 0x51, 0x61, 0x71,
+        0x81, 0x91, 0xA1, 0xB1, 0xC1, 0xD1, 0xE1, 0xF1}));
+    ASSERT_TRUE(aesHandle.has_value());
+
+    const DesfireStoredKey* aesKey = store.find(aesHandle.value());
+    ASSERT_NE(aesKey, nullptr);
+    EXPECT_EQ(aesKey->key[0], 0x01);
+    EXPECT_EQ(aesKey->key[15], 0xF1);
+    EXPECT_TRUE(aesKey->hasAesSchedule);
+    EXPECT_EQ(store.size(), 2U);
+}
+
+TEST(DesfireKeyStoreTests, DegenerateTwoKeyDesIsFlaggedSingleDes)
+{
+    DesfireKeyStore store;
+
+    auto handle = store.registerKey(DesfireKeyType::DES3_2K, makeKey<16>({
+        0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0x70, 0x80,
+        0x11, 0x21, 0x31, 0x41, 0x51, 0x61, 0x71, 0x81}));
+    ASSERT_TRUE(handle.has_value());
+    EXPECT_TRUE(store.find(handle.value())->singleDesKey);
+}
+
+TEST(DesfireKeyStoreTests, RejectsInvalidKeyLengths)
+{
+    DesfireKeyStore store;
+
+    auto aes = store.registerKey(DesfireKeyType::AES, makeKey<24>({0x00, 0x01, 0x02}));
+    ASSERT_FALSE(aes.has_value());
+    EXPECT_TRUE(aes.error().is<error::DesfireError>());
+    EXPECT_EQ(aes.error().get<error::DesfireError>(), error::DesfireError::ParameterError);
+
+    etl::vector<uint8_t, 24> threeKey(16, 0x00);
+    EXPECT_FALSE(store.registerKey(DesfireKeyType::DES3_3K, threeKey).has_value());
+    EXPECT_EQ(store.size(), 0U);
+}
+
+TEST(DesfireKeyStoreTests, ReleaseInvalidatesHandleAndWipesSlot)
+{
+    DesfireKeyStore store;
+
+    etl::vector<uint8_t, 16> key(16, 0xA5);
+    auto first = store.registerKey(DesfireKeyType::AES, key);
+    ASSERT_TRUE(first.has_value());
+
+    const DesfireStoredKey* entry = store.find(first.value());
+    ASSERT_NE(entry, nullptr);
+
+    ASSERT_TRUE(store.release(first.value()).has_value());
+    EXPECT_EQ(store.find(first.value()), nullptr);
+    EXPECT_TRUE(entry->key.empty());
+    for (uint8_t b : entry->aesRoundKeys)
+    {
+        EXPECT_EQ(b, 0x00);
+    }
+
+    auto second = store.registerKey(DesfireKeyType::AES, key);
+    ASSERT_TRUE(second.has_value());
+    EXPECT_NE(first.value(), second.value());
+    EXPECT_EQ(store.find(first.value()), nullptr);
+    EXPECT_NE(store.find(second.value()), nullptr);
+
+    auto stale = store.release(first.value());
+    ASSERT_FALSE(stale.has_value());
+    EXPECT_EQ(stale.error().get<error::DesfireError>(), error::DesfireError::NoSuchKey);
+}
+
+TEST(DesfireKeyStoreTests, ReportsFullStore)
+{
+    DesfireKeyStore store;
+    etl::vector<uint8_t, 16> key(16, 0x00);
+
+    for (size_t i = 0; i < DesfireKeyStore::MAX_KEYS; ++i)
+    {
+        ASSERT_TRUE(store.registerKey(DesfireKeyType::AES, key).has_value());
+    }
+
+    auto overflow = store.registerKey(DesfireKeyType::AES, key);
+    ASSERT_FALSE(overflow.has_value());
+    EXPECT_EQ(overflow.error().get<error::DesfireError>(), error::DesfireError::CountError);
+
+    store.clear();
+    EXPECT_EQ(store.size(), 0U);
+}
+
+TEST(DesfireKeyStoreTests, AesAuthenticationWithStoredKey)
+{
+    const auto rawKey = makeKey<16>({
+        0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+        0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF});
+
+    DesfireKeyStore store;
+    auto handle = store.registerKey(DesfireKeyType::AES, rawKey);
+    ASSERT_TRUE(handle.has_value());
+
+    AuthenticateCommandOptions options;
+    options.mode = DesfireAuthMode::AES;
+    options.keyNo = 0x00;
+    options.storedKey = store.find(handle.value());
+    ASSERT_TRUE(options.key.empty());
+
+    AuthenticateCommand command(options);
+    DesfireContext context;
+
+    ASSERT_TRUE(command.buildRequest(context).has_value());
+
+    const std::array<uint8_t, 16> rndB = {
+        0x00, 0x01, 0x02, 0x03, 0x10, 0x11, 0x12, 0x13,
+        0x20, 0x21, 0x22, 0x23, 0x30, 0x31, 0x32, 0x33};
+
+    uint8_t encRndB[16];
+    std::memcpy(encRndB, rndB.data(), sizeof(encRndB));
+    uint8_t iv0[16] = {0};
+    AES_ctx aesStart;
+    AES_init_ctx_iv(&aesStart, rawKey.data(), iv0);
+    AES_CBC_encrypt_buffer(&aesStart, encRndB, sizeof(encRndB));
+
+    etl::vector<uint8_t, 17> response1;
+    response1.push_back(0xAF);
+    for (uint8_t b : encRndB)
+    {
+        response1.push_back(b);
+    }
+    ASSERT_TRUE(command.parseResponse(response1, context).has_value());
+
+    auto request2 = command.buildRequest(context);
+    ASSERT_TRUE(request2.has_value());
+    ASSERT_EQ(request2.value().data.size(), 32U);
+
+    uint8_t plainAB[32];
+    std::memcpy(plainAB, request2.value().data.data(), sizeof(plainAB));
+    AES_ctx aesReq;
+    AES_init_ctx_iv(&aesReq, rawKey.data(), encRndB);
+    AES_CBC_decrypt_buffer(&aesReq, plainAB, sizeof(plainAB));
+
+    std::array<uint8_t, 16> rndA = {};
+    std::memcpy(rndA.data(), plainAB, 16);
+
+    const std::array<uint8_t, 16> rndBrot = rotateLeft16(rndB);
+    for (size_t i = 0; i < 16; ++i)
+    {
+        EXPECT_EQ(plainAB[16 + i], rndBrot[i]);
+    }
+
+    std::array<uint8_t, 16> encRndArot = rotateLeft16(rndA);
+    AES_ctx aesResp;
+    AES_init_ctx_iv(&aesResp, rawKey.data(), request2.value().data.data() + 16);
+    AES_CBC_encrypt_buffer(&aesResp, encRndArot.data(), encRndArot.size());
+
+    etl::vector<uint8_t, 17> response2;
+    response2.push_back(0x00);
+    for (uint8_t b : encRndArot)
+    {
+        response2.push_back(b);
+    }
+
+    ASSERT_TRUE(command.parseResponse(response2, context).has_value());
+    EXPECT_TRUE(command.isComplete());
+    EXPECT_TRUE(context.authenticated);
+    EXPECT_EQ(context.authScheme, SessionAuthScheme::Aes);
+}
+
+TEST(DesfireKeyStoreTests, AuthenticationRejectsKeyTypeModeMismatch)
+{
+    DesfireKeyStore store;
+    etl::vector<uint8_t, 16> key(16, 0x00);
+    auto handle = store.registerKey(DesfireKeyType::DES3_2K, key);
+    ASSERT_TRUE(handle.has_value());
+
+    AuthenticateCommandOptions options;
+    options.mode = DesfireAuthMode::AES;
+    options.keyNo = 0x00;
+    options.storedKey = store.find(handle.value());
+
+    AuthenticateCommand command(options);
+    DesfireContext context;
+    auto request = command.buildRequest(context);
+    ASSERT_FALSE(request.has_value());
+    EXPECT_EQ(request.error().get<error::DesfireError>(), error::DesfireError::ParameterError);
+}
+
+TEST(DesfireKeyStoreTests, ChangeKeyWithStoredKeysMatchesRawKeys)
+{
+    const auto newKey = makeKey<24>({
+        0x00, 0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0x70,
+        0x80, 0x90, 0xA0, 0xB0, 0xC0, 0xD0, 0xE0, 0xF0});
+    const auto oldKey = makeKey<24>({
+        0x02, 0x04, 0x06, 0x08, 0x0A, 0x0C, 0x0E, 0x10,
+        0x12, 0x14, 0x16, 0x18, 0x1A, 0x1C, 0x1E, 0x20});
+
+    ChangeKeyCommandOptions rawOptions;
+    rawOptions.keyNo = 0x01;
+    rawOptions.authMode = DesfireAuthMode::ISO;
+    rawOptions.sessionKeyType = DesfireKeyType::DES3_2K;
+    rawOptions.newKeyType = DesfireKeyType::DES3_2K;
+    rawOptions.oldKeyType = DesfireKeyType::DES3_2K;
+    rawOptions.newKey = newKey;
+    rawOptions.newKeyVersion = 0x00;
+    rawOptions.oldKey = oldKey;
+
+    DesfireKeyStore store;
+    auto newHandle = store.registerKey(DesfireKeyType::DES3_2K, newKey);
+    auto oldHandle = store.registerKey(DesfireKeyType::DES3_2K, oldKey);
+    ASSERT_TRUE(newHandle.has_value());
+    ASSERT_TRUE(oldHandle.has_value());
+
+    ChangeKeyCommandOptions storedOptions;
+    storedOptions.keyNo = 0x01;
+    storedOptions.authMode = DesfireAuthMode::ISO;
+    storedOptions.sessionKeyType = DesfireKeyType::DES3_2K;
+    storedOptions.newStoredKey = store.find(newHandle.value());
+    storedOptions.oldStoredKey = store.find(oldHandle.value());
+
+    DesfireContext rawContext = buildAuthenticatedContext(0x00);
+    DesfireContext storedContext = buildAuthenticatedContext(0x00);
+
+    ChangeKeyCommand rawCommand(rawOptions);
+    ChangeKeyCommand storedCommand(storedOptions);
+
+    auto rawRequest = rawCommand.buildRequest(rawContext);
+    auto storedRequest = storedCommand.buildRequest(storedContext);
+    ASSERT_TRUE(rawRequest.has_value());
+    ASSERT_TRUE(storedRequest.has_value());
+
+    ASSERT_EQ(rawRequest.value().data.size(), storedRequest.value().data.size());
+    for (size_t i = 0; i < rawRequest.value().data.size(); ++i)
+    {
+        EXPECT_EQ(rawRequest.value().data[i], storedRequest.value().data[i]);
+    }
+}
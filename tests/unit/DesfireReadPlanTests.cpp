@@ -0,0 +1,534 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <cstring>
+#include <map>
+#include <vector>
+#include <aes.hpp>
+#include "Nfc/Desfire/DesfireCard.h"
+#include "Nfc/Desfire/DesfireKeyStore.h"
+#include "Nfc/Desfire/DesfireCryptoBatch.h"
+#include "Nfc/Desfire/SecureMessagingPolicy.h"
+#include "Nfc/Apdu/IApduTransceiver.h"
+#include "Nfc/Wire/NativeWire.h"
+
+using namespace nfc;
+
+namespace
+{
+    using Key = std::array<uint8_t, 16>;
+
+    const Key KEY_1 = {
+        0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+        0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F};
+    const Key KEY_2 = {
+        0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27,
+        0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F};
+
+    struct EmulatedFile
+    {
+        uint8_t type = 0x00;        // 0x00 data, 0x02 value, 0x04 cyclic record
+        uint8_t comm = 0x00;
+        uint8_t readKey = 0x0E;
+        std::vector<uint8_t> data;  // file contents, or records back to back
+        uint32_t recordSize = 0U;
+        int32_t value = 0;
+    };
+
+    /**
+     * One application with AES keys 1 and 2. Authenticated sessions keep
+     * the EV1 CMAC chaining value and answer with data || CMAC, or with
+     * enciphered data || CRC32 for files in enciphered mode.
+     */
+    class PlanCard : public IApduTransceiver
+    {
+    public:
+        PlanCard()
+        {
+            keys[1] = KEY_1;
+            keys[2] = KEY_2;
+        }
+
+        void setWire(IWire&) override
+        {
+        }
+
+        etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> transceive(
+            const etl::ivector<uint8_t>& apdu) override
+        {
+            sent.push_back(apdu[0]);
+            std::vector<uint8_t> reply;
+            switch (apdu[0])
+            {
+                case 0x5A:
+                    authenticated = false;
+                    reply = {0x00};
+                    break;
+                case 0xAA:
+                    reply = beginAuthentication(apdu[1]);
+                    break;
+                case 0xAF:
+                    reply = finishAuthentication(apdu);
+                    break;
+                default:
+                    reply = command(apdu);
+                    break;
+            }
+
+            etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX> response;
+            response.assign(reply.begin(), reply.end());
+            return response;
+        }
+
+        size_t count(uint8_t code) const
+        {
+            size_t n = 0U;
+            for (uint8_t c : sent)
+            {
+                n += (c == code) ? 1U : 0U;
+            }
+            return n;
+        }
+
+        std::map<uint8_t, EmulatedFile> files;
+        std::vector<uint8_t> sent;
+
+    private:
+        static uint32_t le24(const etl::ivector<uint8_t>& apdu, size_t at)
+        {
+            return apdu[at] | (apdu[at + 1] << 8U) | (apdu[at + 2] << 16U);
+        }
+
+        void cmac(const std::vector<uint8_t>& message, uint8_t* mac)
+        {
+            std::vector<uint8_t> copy = message;
+            DesfireCryptoJob job;
+            job.kind = DesfireCryptoJobKind::AesCmac;
+            job.key = sessionKey.data();
+            job.keyLength = 16U;
+            job.iv = iv.data();
+            job.data = copy.data();
+            job.length = copy.size();
+            job.mac = mac;
+            DesfireCryptoBatch batch;
+            batch.submit(job);
+            batch.process();
+        }
+
+        std::vector<uint8_t> fail(uint8_t status)
+        {
+            authenticated = false;
+            return {status};
+        }
+
+        std::vector<uint8_t> respond(const std::vector<uint8_t>& payload, uint8_t comm)
+        {
+            std::vector<uint8_t> reply = {0x00};
+            if (!authenticated)
+            {
+                reply.insert(reply.end(), payload.begin(), payload.end());
+                return reply;
+            }
+
+            if (comm == 0x03)
+            {
+                std::vector<uint8_t> plain = payload;
+                etl::vector<uint8_t, 256> crcInput(payload.begin(), payload.end());
+                crcInput.push_back(0x00);
+                const uint32_t crc = SecureMessagingPolicy::calculateCrc32Desfire(crcInput);
+                for (size_t i = 0; i < 4U; ++i)
+                {
+                    plain.push_back(static_cast<uint8_t>(crc >> (8U * i)));
+                }
+                plain.resize(((plain.size() + 15U) / 16U) * 16U, 0x00);
+
+                AES_ctx ctx;
+                AES_init_ctx_iv(&ctx, sessionKey.data(), iv.data());
+                AES_CBC_encrypt_buffer(&ctx, plain.data(), plain.size());
+                std::memcpy(iv.data(), plain.data() + plain.size() - 16U, 16U);
+                reply.insert(reply.end(), plain.begin(), plain.end());
+                return reply;
+            }
+
+            std::vector<uint8_t> message = payload;
+            message.push_back(0x00);
+            uint8_t mac[16];
+            cmac(message, mac);
+            reply.insert(reply.end(), payload.begin(), payload.end());
+            reply.insert(reply.end(), mac, mac + 8);
+            return reply;
+        }
+
+        std::vector<uint8_t> command(const etl::ivector<uint8_t>& apdu)
+        {
+            if (authenticated)
+            {
+                uint8_t mac[16];
+                cmac(std::vector<uint8_t>(apdu.begin(), apdu.end()), mac);
+            }
+
+            auto found = files.find(apdu[1]);
+            if (found == files.end())
+            {
+                return fail(0xF0);
+            }
+            const EmulatedFile& file = found->second;
+
+            if (apdu[0] == 0xF5)
+            {
+                std::vector<uint8_t> settings = {file.type, file.comm, 0xEE, static_cast<uint8_t>((file.readKey << 4U) | 0x0E)};
+                const uint32_t size = (file.type == 0x00) ? static_cast<uint32_t>(file.data.size()) : file.recordSize;
+                settings.push_back(static_cast<uint8_t>(size));
+                settings.push_back(static_cast<uint8_t>(size >> 8U));
+                settings.push_back(static_cast<uint8_t>(size >> 16U));
+                if (file.type == 0x04)
+                {
+                    const uint32_t records = static_cast<uint32_t>(file.data.size() / file.recordSize);
+                    settings.insert(settings.end(), {0x10, 0x00, 0x00});
+                    settings.insert(settings.end(), {static_cast<uint8_t>(records), 0x00, 0x00});
+                }
+                return respond(settings, 0x00);
+            }
+
+            const bool allowed = file.readKey == 0x0E || (authenticated && authKey == file.readKey);
+            if (!allowed)
+            {
+                return fail(0x9D);
+            }
+            const uint8_t comm = (file.readKey == 0x0E) ? 0x00 : file.comm;
+
+            switch (apdu[0])
+            {
+                case 0xBD:
+                {
+                    const uint32_t offset = le24(apdu, 2);
+                    const uint32_t length = le24(apdu, 5);
+                    if (offset + length > file.data.size())
+                    {
+                        return fail(0xBE);
+                    }
+                    return respond(std::vector<uint8_t>(file.data.begin() + offset, file.data.begin() + offset + length), comm);
+                }
+                case 0xBB:
+                {
+                    const uint32_t first = le24(apdu, 2) * file.recordSize;
+                    const uint32_t length = le24(apdu, 5) * file.recordSize;
+                    if (first + length > file.data.size())
+                    {
+                        return fail(0xBE);
+                    }
+                    return respond(std::vector<uint8_t>(file.data.begin() + first, file.data.begin() + first + length), comm);
+                }
+                case 0x6C:
+                {
+                    std::vector<uint8_t> value;
+                    for (size_t i = 0; i < 4U; ++i)
+                    {
+                        value.push_back(static_cast<uint8_t>(static_cast<uint32_t>(file.value) >> (8U * i)));
+                    }
+                    return respond(value, comm);
+                }
+                default:
+                    return fail(0x1C);
+            }
+        }
+
+        std::vector<uint8_t> beginAuthentication(uint8_t keyNo)
+        {
+            authenticated = false;
+            pendingKey = keyNo;
+            for (size_t i = 0; i < 16; ++i)
+            {
+                rndB[i] = static_cast<uint8_t>(0xB0 + i + keyNo);
+            }
+            std::memcpy(lastCipher.data(), rndB.data(), 16);
+            uint8_t zero[16] = {0};
+            AES_ctx ctx;
+            AES_init_ctx_iv(&ctx, keys[keyNo].data(), zero);
+            AES_CBC_encrypt_buffer(&ctx, lastCipher.data(), 16);
+
+            std::vector<uint8_t> reply = {0xAF};
+            reply.insert(reply.end(), lastCipher.begin(), lastCipher.end());
+            return reply;
+        }
+
+        std::vector<uint8_t> finishAuthentication(const etl::ivector<uint8_t>& apdu)
+        {
+            uint8_t plain[32];
+            std::memcpy(plain, apdu.data() + 1, 32);
+            AES_ctx ctx;
+            AES_init_ctx_iv(&ctx, keys[pendingKey].data(), lastCipher.data());
+            AES_CBC_decrypt_buffer(&ctx, plain, 32);
+
+            Key rndA = {};
+            Key rndArot = {};
+            std::memcpy(rndA.data(), plain, 16);
+            for (size_t i = 0; i < 16; ++i)
+            {
+                rndArot[i] = rndA[(i + 1) % 16];
+            }
+            AES_init_ctx_iv(&ctx, keys[pendingKey].data(), apdu.data() + 17);
+            AES_CBC_encrypt_buffer(&ctx, rndArot.data(), 16);
+
+            for (size_t i = 0; i < 4; ++i)
+            {
+                sessionKey[i] = rndA[i];
+                sessionKey[i + 4] = rndB[i];
+                sessionKey[i + 8] = rndA[12 + i];
+                sessionKey[i + 12] = rndB[12 + i];
+            }
+            iv.fill(0x00);
+            authenticated = true;
+            authKey = pendingKey;
+
+            std::vector<uint8_t> reply = {0x00};
+            reply.insert(reply.end(), rndArot.begin(), rndArot.end());
+            return reply;
+        }
+
+        std::map<uint8_t, Key> keys;
+        bool authenticated = false;
+        uint8_t authKey = 0;
+        uint8_t pendingKey = 0;
+        Key rndB = {};
+        Key lastCipher = {};
+        Key sessionKey = {};
+        Key iv = {};
+    };
+
+    class ReadPlanTest : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            EmulatedFile profile;
+            profile.data = {'p', 'r', 'o', 'f', 'i', 'l', 'e', 0x00, 0x00, 0x00};
+            transceiver.files[1] = profile;
+
+            EmulatedFile secret;
+            secret.comm = 0x03;
+            secret.readKey = 1;
+            for (uint8_t i = 0; i < 20; ++i)
+            {
+                secret.data.push_back(static_cast<uint8_t>(0xA0 + i));
+            }
+            transceiver.files[2] = secret;
+
+            EmulatedFile balance;
+            balance.type = 0x02;
+            balance.readKey = 1;
+            balance.value = 1250;
+            transceiver.files[3] = balance;
+
+            EmulatedFile history;
+            history.type = 0x04;
+            history.comm = 0x01;
+            history.readKey = 2;
+            history.recordSize = 4;
+            history.data = {1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3};
+            transceiver.files[4] = history;
+
+            key1 = store.registerKey(DesfireKeyType::AES, etl::vector<uint8_t, 24>(KEY_1.begin(), KEY_1.end())).value();
+            key2 = store.registerKey(DesfireKeyType::AES, etl::vector<uint8_t, 24>(KEY_2.begin(), KEY_2.end())).value();
+            ASSERT_TRUE(card.selectApplication({0x01, 0x02, 0x03}).has_value());
+        }
+
+        DesfireReadPlanEntry dataEntry(uint8_t fileNo, uint32_t length, uint8_t comm, uint8_t keyNo)
+        {
+            DesfireReadPlanEntry entry;
+            entry.fileNo = fileNo;
+            entry.length = length;
+            entry.communicationSettings = comm;
+            entry.keyNo = keyNo;
+            entry.keyHandle = (keyNo == 1) ? key1 : key2;
+            return entry;
+        }
+
+        // Tap flow with reads of three keys interleaved
+        DesfireReadPlan tapPlan()
+        {
+            DesfireReadPlan plan;
+            plan.keyStore = &store;
+            plan.cardUid = {0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+            plan.entries.push_back(dataEntry(2, 20, 0x03, 1));
+
+            DesfireReadPlanEntry history = dataEntry(4, 3, 0x01, 2);
+            history.kind = DesfireReadKind::Records;
+            history.recordSize = 4;
+            plan.entries.push_back(history);
+
+            plan.entries.push_back(dataEntry(1, 10, 0x00, DesfireReadPlanEntry::FREE_ACCESS));
+
+            DesfireReadPlanEntry balance = dataEntry(3, 0, 0x00, 1);
+            balance.kind = DesfireReadKind::Value;
+            plan.entries.push_back(balance);
+            return plan;
+        }
+
+        void expectTapResults(const DesfireReadResultSet& results)
+        {
+            ASSERT_EQ(results.size(), 4U);
+            ASSERT_TRUE(results[0].isOk());
+            EXPECT_EQ(results[0].dataLength, 20U);
+            EXPECT_EQ(results.data(0)[0], 0xA0);
+            EXPECT_EQ(results.data(0)[19], 0xB3);
+
+            ASSERT_TRUE(results[1].isOk());
+            ASSERT_EQ(results[1].dataLength, 12U);
+            EXPECT_EQ(results.data(1)[4], 0x02);
+
+            ASSERT_TRUE(results[2].isOk());
+            EXPECT_EQ(std::memcmp(results.data(2), "profile", 7), 0);
+
+            ASSERT_TRUE(results[3].isOk());
+            EXPECT_EQ(results[3].value, 1250);
+            EXPECT_EQ(results.data(3), nullptr);
+        }
+
+        PlanCard transceiver;
+        NativeWire wire;
+        DesfireCard card{transceiver, wire};
+        DesfireKeyStore store;
+        DesfireKeyHandle key1;
+        DesfireKeyHandle key2;
+    };
+}
+
+TEST_F(ReadPlanTest, GroupsReadsByKey)
+{
+    DesfireReadResultSet results;
+    auto metrics = card.readFiles(tapPlan(), results);
+    ASSERT_TRUE(metrics.has_value());
+    expectTapResults(results);
+
+    EXPECT_EQ(metrics.value().filesRead, 4U);
+    EXPECT_EQ(metrics.value().authentications, 2U);
+    EXPECT_EQ(metrics.value().settingsLookups, 0U);
+    EXPECT_EQ(metrics.value().cardReads, 4U);
+    EXPECT_EQ(transceiver.count(0xAA), 2U);
+    EXPECT_EQ(transceiver.count(0xF5), 0U);
+
+    // Free file before any authentication, both key 1 files under one session
+    EXPECT_EQ(transceiver.sent, (std::vector<uint8_t>{0x5A, 0xBD, 0xAA, 0xAF, 0xBD, 0x6C, 0xAA, 0xAF, 0xBB}));
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        EXPECT_EQ(results[i].source, DesfireReadSource::Card);
+    }
+}
+
+TEST_F(ReadPlanTest, StartsWithKeyOfCurrentSession)
+{
+    ASSERT_TRUE(card.authenticate(2, store, key2, DesfireAuthMode::AES).has_value());
+    transceiver.sent.clear();
+
+    DesfireReadResultSet results;
+    auto metrics = card.readFiles(tapPlan(), results);
+    ASSERT_TRUE(metrics.has_value());
+    expectTapResults(results);
+    EXPECT_EQ(metrics.value().authentications, 1U);
+    EXPECT_EQ(transceiver.sent, (std::vector<uint8_t>{0xBB, 0xBD, 0xAA, 0xAF, 0xBD, 0x6C}));
+}
+
+TEST_F(ReadPlanTest, AnswersRepeatedReadsFromCache)
+{
+    DesfireReadResultSet results;
+    ASSERT_TRUE(card.readFiles(tapPlan(), results).has_value());
+    transceiver.sent.clear();
+
+    auto metrics = card.readFiles(tapPlan(), results);
+    ASSERT_TRUE(metrics.has_value());
+    EXPECT_EQ(metrics.value().cacheHits, 4U);
+    EXPECT_TRUE(transceiver.sent.empty());
+    expectTapResults(results);
+
+    // The balance changed on the card: read it again, keep the rest
+    transceiver.files[3].value = 1100;
+    DesfireReadPlan plan = tapPlan();
+    plan.entries[3].allowCached = false;
+    metrics = card.readFiles(plan, results);
+    ASSERT_TRUE(metrics.has_value());
+    EXPECT_EQ(metrics.value().cacheHits, 3U);
+    EXPECT_EQ(metrics.value().cardReads, 1U);
+    EXPECT_EQ(results[3].source, DesfireReadSource::Card);
+    EXPECT_EQ(results[3].value, 1100);
+    EXPECT_EQ(results[0].source, DesfireReadSource::Cache);
+    EXPECT_EQ(results.data(0)[0], 0xA0);
+    EXPECT_EQ(std::memcmp(results.data(2), "profile", 7), 0);
+
+    // Another application invalidates everything
+    ASSERT_TRUE(card.selectApplication({0x04, 0x05, 0x06}).has_value());
+    metrics = card.readFiles(tapPlan(), results);
+    ASSERT_TRUE(metrics.has_value());
+    EXPECT_EQ(metrics.value().cacheHits, 0U);
+}
+
+TEST_F(ReadPlanTest, NeverReusesResultsOfAnotherCard)
+{
+    DesfireReadResultSet results;
+    ASSERT_TRUE(card.readFiles(tapPlan(), results).has_value());
+
+    // Next tap, another card with another balance
+    transceiver.files[3].value = 40;
+    DesfireReadPlan plan = tapPlan();
+    plan.cardUid[6] = 0x67;
+    auto metrics = card.readFiles(plan, results);
+    ASSERT_TRUE(metrics.has_value());
+    EXPECT_EQ(metrics.value().cacheHits, 0U);
+    EXPECT_EQ(results[3].source, DesfireReadSource::Card);
+    EXPECT_EQ(results[3].value, 40);
+
+    // Without a card UID nothing is reused either
+    plan.cardUid.clear();
+    metrics = card.readFiles(plan, results);
+    ASSERT_TRUE(metrics.has_value());
+    EXPECT_EQ(metrics.value().cacheHits, 0U);
+    metrics = card.readFiles(plan, results);
+    ASSERT_TRUE(metrics.has_value());
+    EXPECT_EQ(metrics.value().cacheHits, 0U);
+}
+
+TEST_F(ReadPlanTest, LooksUpUnknownSettings)
+{
+    DesfireReadPlan plan;
+    plan.keyStore = &store;
+    plan.entries.push_back(dataEntry(1, 0, DesfireReadPlanEntry::COMM_SETTINGS_UNKNOWN, DesfireReadPlanEntry::FREE_ACCESS));
+    DesfireReadPlanEntry history = dataEntry(4, 0, DesfireReadPlanEntry::COMM_SETTINGS_UNKNOWN, 2);
+    history.kind = DesfireReadKind::Records;
+    history.offset = 1;
+    plan.entries.push_back(history);
+
+    DesfireReadResultSet results;
+    auto metrics = card.readFiles(plan, results);
+    ASSERT_TRUE(metrics.has_value());
+    EXPECT_EQ(metrics.value().settingsLookups, 2U);
+    ASSERT_TRUE(results[0].isOk());
+    EXPECT_EQ(results[0].dataLength, 10U);
+    ASSERT_TRUE(results[1].isOk());
+    ASSERT_EQ(results[1].dataLength, 8U);
+    EXPECT_EQ(results.data(1)[0], 0x02);
+}
+
+TEST_F(ReadPlanTest, ContinuesAfterFailedEntry)
+{
+    DesfireReadPlan plan;
+    plan.keyStore = &store;
+    plan.entries.push_back(dataEntry(9, 4, 0x00, 1));
+    plan.entries.push_back(dataEntry(2, 20, 0x03, 1));
+    plan.entries.push_back(dataEntry(1, 10, 0x00, DesfireReadPlanEntry::FREE_ACCESS));
+
+    DesfireReadResultSet results;
+    auto metrics = card.readFiles(plan, results);
+    ASSERT_TRUE(metrics.has_value());
+    EXPECT_EQ(metrics.value().filesFailed, 1U);
+    EXPECT_EQ(metrics.value().filesRead, 2U);
+
+    ASSERT_FALSE(results[0].isOk());
+    EXPECT_EQ(results[0].source, DesfireReadSource::None);
+    ASSERT_FALSE(results[0].status.has_value());
+    EXPECT_EQ(results[0].status.error().get<error::DesfireError>(), error::DesfireError::FileNotFound);
+
+    // The error ended the session; key 1 is authenticated again
+    EXPECT_EQ(metrics.value().authentications, 2U);
+    ASSERT_TRUE(results[1].isOk());
+    EXPECT_EQ(results.data(1)[5], 0xA5);
+    EXPECT_TRUE(results[2].isOk());
+}
@@ -1,11 +1,85 @@
 #include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
 #include "Nfc/Desfire/Commands/ReadDataCommand.h"
 #include "Nfc/Desfire/Commands/WriteDataCommand.h"
+#include "Nfc/Desfire/DesfireCard.h"
 #include "Nfc/Desfire/DesfireContext.h"
+#include "Nfc/Apdu/IApduTransceiver.h"
+#include "Nfc/Wire/NativeWire.h"
 #include "Error/DesfireError.h"
+#include "Error/Pn532Error.h"
 
 using namespace nfc;
 
+namespace
+{
+    /**
+     * Plain-mode data file emulation. The ReadData/WriteData exchange with
+     * index failOnTransfer times out, as a weak RF link would. A backup
+     * file's writes are dropped when the link fails, as the aborted
+     * transaction would drop them. GetFileSettings fails when
+     * settingsUnavailable is set.
+     */
+    class FlakyDataFileCard : public IApduTransceiver
+    {
+    public:
+        void setWire(IWire&) override
+        {
+        }
+
+        etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> transceive(
+            const etl::ivector<uint8_t>& apdu) override
+        {
+            etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX> response;
+            if (apdu[0] == 0xF5 && !settingsUnavailable)
+            {
+                // Standard or backup data file, plain, free access, 32 bytes
+                response.assign({0x00, backupFile ? uint8_t{0x01} : uint8_t{0x00}, 0x00, 0xEE, 0xEE, 0x20, 0x00, 0x00});
+                return response;
+            }
+            if (apdu[0] != 0xBD && apdu[0] != 0x3D)
+            {
+                response.push_back(0x1C);
+                return response;
+            }
+
+            const size_t offset = apdu[2] | (apdu[3] << 8U) | (apdu[4] << 16U);
+            const size_t length = apdu[5] | (apdu[6] << 8U) | (apdu[7] << 16U);
+            transfers.push_back(offset);
+            if (transfers.size() - 1U == failOnTransfer)
+            {
+                if (backupFile)
+                {
+                    file = committed;
+                }
+                return etl::unexpected(error::Error::fromPn532(error::Pn532Error::Timeout));
+            }
+
+            response.push_back(0x00);
+            for (size_t i = 0; i < length; ++i)
+            {
+                if (apdu[0] == 0xBD)
+                {
+                    response.push_back(file[offset + i]);
+                }
+                else
+                {
+                    file[offset + i] = apdu[8 + i];
+                }
+            }
+            return response;
+        }
+
+        std::vector<uint8_t> file = std::vector<uint8_t>(32);
+        std::vector<uint8_t> committed = std::vector<uint8_t>(32);
+        bool backupFile = false;
+        bool settingsUnavailable = false;
+        std::vector<size_t> transfers;     // Byte offset of every ReadData/WriteData sent
+        size_t failOnTransfer = SIZE_MAX;
+    };
+}
+
 TEST(DesfireReadDataCommandTests, BuildRequestEncodesFileOffsetAndChunkLength)
 {
     ReadDataCommandOptions options;
@@ -187,3 +261,145 @@ TEST(DesfireWriteDataCommandTests, RejectsEmptyPayload)
     ASSERT_TRUE(requestResult.error().is<error::DesfireError>());
     EXPECT_EQ(requestResult.error().get<error::DesfireError>(), error::DesfireError::ParameterError);
 }
+
+TEST(DesfireCardTransferResumeTests, ResumesReadAfterLastVerifiedChunk)
+{
+    FlakyDataFileCard transceiver;
+    for (size_t i = 0; i < transceiver.file.size(); ++i)
+    {
+        transceiver.file[i] = static_cast<uint8_t>(0xA0 + i);
+    }
+    NativeWire wire;
+    DesfireCard card(transceiver, wire);
+    DesfireTransferToken token;
+
+    transceiver.failOnTransfer = 1U;
+    auto failed = card.readData(0x01, 2U, 20U, 8U, token);
+    ASSERT_FALSE(failed.has_value());
+    EXPECT_TRUE(token.valid);
+    EXPECT_EQ(token.completed, 8U);
+    ASSERT_EQ(token.data.size(), 8U);
+    EXPECT_EQ(token.data[0], 0xA2);
+
+    transceiver.transfers.clear();
+    transceiver.failOnTransfer = SIZE_MAX;
+    auto resumed = card.readData(0x01, 2U, 20U, 8U, token);
+    ASSERT_TRUE(resumed.has_value());
+    EXPECT_EQ(transceiver.transfers, std::vector<size_t>({10U, 18U}));
+    ASSERT_EQ(resumed.value().size(), 20U);
+    for (size_t i = 0; i < 20U; ++i)
+    {
+        EXPECT_EQ(resumed.value()[i], transceiver.file[2U + i]);
+    }
+    EXPECT_FALSE(token.valid);
+}
+
+TEST(DesfireCardTransferResumeTests, ResumesWriteAfterLastAcknowledgedChunk)
+{
+    FlakyDataFileCard transceiver;
+    NativeWire wire;
+    DesfireCard card(transceiver, wire);
+    DesfireTransferToken token;
+
+    etl::vector<uint8_t, 20> payload;
+    for (size_t i = 0; i < 20U; ++i)
+    {
+        payload.push_back(static_cast<uint8_t>(i + 1U));
+    }
+
+    transceiver.failOnTransfer = 2U;
+    ASSERT_FALSE(card.writeData(0x01, 4U, payload, 8U, token).has_value());
+    EXPECT_TRUE(token.valid);
+    EXPECT_EQ(token.completed, 16U);
+
+    transceiver.transfers.clear();
+    transceiver.failOnTransfer = SIZE_MAX;
+    ASSERT_TRUE(card.writeData(0x01, 4U, payload, 8U, token).has_value());
+    EXPECT_EQ(transceiver.transfers, std::vector<size_t>({20U}));
+    for (size_t i = 0; i < 20U; ++i)
+    {
+        EXPECT_EQ(transceiver.file[4U + i], payload[i]);
+    }
+    EXPECT_FALSE(token.valid);
+}
+
+TEST(DesfireCardTransferResumeTests, RestartsBackupFileWriteFromFirstByte)
+{
+    FlakyDataFileCard transceiver;
+    transceiver.backupFile = true;
+    NativeWire wire;
+    DesfireCard card(transceiver, wire);
+    DesfireTransferToken token;
+
+    etl::vector<uint8_t, 20> payload;
+    for (size_t i = 0; i < 20U; ++i)
+    {
+        payload.push_back(static_cast<uint8_t>(i + 1U));
+    }
+
+    transceiver.failOnTransfer = 2U;
+    ASSERT_FALSE(card.writeData(0x01, 4U, payload, 8U, token).has_value());
+    EXPECT_TRUE(token.valid);
+
+    // The acknowledged chunks were rolled back, so all of them go again
+    transceiver.transfers.clear();
+    transceiver.failOnTransfer = SIZE_MAX;
+    ASSERT_TRUE(card.writeData(0x01, 4U, payload, 8U, token).has_value());
+    EXPECT_EQ(transceiver.transfers, std::vector<size_t>({4U, 12U, 20U}));
+    for (size_t i = 0; i < 20U; ++i)
+    {
+        EXPECT_EQ(transceiver.file[4U + i], payload[i]);
+    }
+    EXPECT_FALSE(token.valid);
+}
+
+TEST(DesfireCardTransferResumeTests, RestartsWriteFromFirstByteWhenFileTypeIsUnknown)
+{
+    FlakyDataFileCard transceiver;
+    transceiver.backupFile = true;
+    transceiver.settingsUnavailable = true;
+    NativeWire wire;
+    DesfireCard card(transceiver, wire);
+    DesfireTransferToken token;
+
+    etl::vector<uint8_t, 20> payload;
+    for (size_t i = 0; i < 20U; ++i)
+    {
+        payload.push_back(static_cast<uint8_t>(i + 1U));
+    }
+
+    transceiver.failOnTransfer = 2U;
+    ASSERT_FALSE(card.writeData(0x01, 4U, payload, 8U, token).has_value());
+    EXPECT_TRUE(token.valid);
+
+    // Without the settings the file may be a backup file, so nothing is skipped
+    transceiver.transfers.clear();
+    transceiver.failOnTransfer = SIZE_MAX;
+    ASSERT_TRUE(card.writeData(0x01, 4U, payload, 8U, token).has_value());
+    EXPECT_EQ(transceiver.transfers, std::vector<size_t>({4U, 12U, 20U}));
+    for (size_t i = 0; i < 20U; ++i)
+    {
+        EXPECT_EQ(transceiver.file[4U + i], payload[i]);
+    }
+    EXPECT_FALSE(token.valid);
+}
+
+TEST(DesfireCardTransferResumeTests, RestartsWhenTokenDoesNotMatch)
+{
+    FlakyDataFileCard transceiver;
+    NativeWire wire;
+    DesfireCard card(transceiver, wire);
+    DesfireTransferToken token;
+
+    transceiver.failOnTransfer = 1U;
+    ASSERT_FALSE(card.readData(0x01, 0U, 16U, 8U, token).has_value());
+    ASSERT_TRUE(token.valid);
+
+    // Same file, different range: nothing from the old token is reused
+    transceiver.transfers.clear();
+    transceiver.failOnTransfer = SIZE_MAX;
+    auto other = card.readData(0x01, 8U, 16U, 8U, token);
+    ASSERT_TRUE(other.has_value());
+    EXPECT_EQ(transceiver.transfers, std::vector<size_t>({8U, 16U}));
+    EXPECT_EQ(other.value().size(), 16U);
+}
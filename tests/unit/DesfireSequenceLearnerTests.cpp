@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "Nfc/Desfire/DesfireCard.h"
+#include "Nfc/Desfire/DesfireSequenceLearner.h"
+#include "Nfc/Apdu/IApduTransceiver.h"
+#include "Nfc/Wire/NativeWire.h"
+
+using namespace nfc;
+
+namespace
+{
+    // The learner never talks to the card itself; requests go out by hand
+    class UnusedTransceiver : public IApduTransceiver
+    {
+    public:
+        void setWire(IWire&) override
+        {
+        }
+
+        etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> transceive(
+            const etl::ivector<uint8_t>&) override
+        {
+            ADD_FAILURE() << "unexpected transceive";
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidState));
+        }
+    };
+
+    DesfireRequest makeRequest(uint8_t commandCode, std::vector<uint8_t> data = {})
+    {
+        DesfireRequest request;
+        request.commandCode = commandCode;
+        request.data.assign(data.begin(), data.end());
+        request.expectedResponseLength = 0U;
+        return request;
+    }
+
+    const DesfireRequest SELECT = makeRequest(0x5A, {0x01, 0x00, 0x00});
+    const DesfireRequest GET_FILE_IDS = makeRequest(0x6F);
+    const DesfireRequest READ_FILE = makeRequest(0xBD, {0x01, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00});
+    const DesfireRequest GET_VERSION = makeRequest(0x60);
+}
+
+// Test Fixture: an unauthenticated card whose answers are all 00 (OK)
+class DesfireSequenceLearnerTest : public ::testing::Test {
+protected:
+    // One request the way a relay would run it, returning what was sent
+    std::vector<uint8_t> run(const DesfireRequest& request) {
+        auto apdu = learner.prepare(request);
+        EXPECT_TRUE(apdu.has_value());
+        learner.speculate();
+        const etl::vector<uint8_t, 1> ok = {0x00};
+        auto result = learner.complete(ok);
+        EXPECT_TRUE(result.has_value());
+        return std::vector<uint8_t>(apdu.value().begin(), apdu.value().end());
+    }
+
+    void tap(std::vector<DesfireRequest> requests) {
+        learner.beginSequence(1U);
+        learner.speculate();
+        for (const auto& request : requests) {
+            run(request);
+        }
+    }
+
+    std::vector<uint8_t> plain(const DesfireRequest& request) {
+        std::vector<uint8_t> pdu = {request.commandCode};
+        pdu.insert(pdu.end(), request.data.begin(), request.data.end());
+        return pdu;
+    }
+
+    UnusedTransceiver transceiver;
+    NativeWire wire;
+    DesfireCard card{transceiver, wire};
+    DesfireSequenceLearner learner{card};
+};
+
+// Test: After enough taps every request of the sequence goes out as prepared
+TEST_F(DesfireSequenceLearnerTest, SendsLearnedSequenceAsPrepared) {
+    for (int i = 0; i < 3; ++i) {
+        tap({SELECT, GET_FILE_IDS, READ_FILE});
+    }
+    EXPECT_EQ(learner.getMetrics().predictions, 0U);
+
+    learner.beginSequence(1U);
+    learner.speculate();
+    EXPECT_EQ(run(SELECT), plain(SELECT));
+    EXPECT_EQ(run(GET_FILE_IDS), plain(GET_FILE_IDS));
+    EXPECT_EQ(run(READ_FILE), plain(READ_FILE));
+
+    EXPECT_EQ(learner.getMetrics().predictions, 3U);
+    EXPECT_EQ(learner.getMetrics().hits, 3U);
+    EXPECT_EQ(learner.getMetrics().misses, 0U);
+}
+
+// Test: A misprediction sends exactly what the application asked for
+TEST_F(DesfireSequenceLearnerTest, MispredictionSendsOnlyIssuedRequest) {
+    for (int i = 0; i < 3; ++i) {
+        tap({SELECT, GET_FILE_IDS});
+    }
+
+    learner.beginSequence(1U);
+    EXPECT_EQ(run(SELECT), plain(SELECT));
+    EXPECT_EQ(run(GET_VERSION), plain(GET_VERSION));
+    EXPECT_EQ(learner.getMetrics().misses, 1U);
+    EXPECT_EQ(learner.getMetrics().hits, 0U);
+
+    // Sequences of another profile are learned separately
+    learner.beginSequence(2U);
+    learner.speculate();
+    EXPECT_EQ(run(SELECT), plain(SELECT));
+    EXPECT_EQ(learner.getMetrics().predictions, 1U);   // nothing new for profile 2
+}
+
+// Test: A step with no dominant successor is not speculated on
+TEST_F(DesfireSequenceLearnerTest, NoPredictionWithoutConfidence) {
+    for (int i = 0; i < 3; ++i) {
+        tap({SELECT, GET_FILE_IDS});
+        tap({SELECT, GET_VERSION});
+    }
+
+    const DesfireSequenceMetrics before = learner.getMetrics();
+    learner.beginSequence(1U);
+    learner.speculate();
+    run(SELECT);
+    run(GET_VERSION);
+    EXPECT_EQ(learner.getMetrics().predictions, before.predictions + 1U);   // SELECT only
+    EXPECT_EQ(learner.getMetrics().hits, before.hits + 1U);
+    EXPECT_EQ(learner.getMetrics().misses, 0U);
+
+    learner.forget();
+    tap({SELECT, GET_FILE_IDS});
+    EXPECT_EQ(learner.getMetrics().predictions, 0U);
+}
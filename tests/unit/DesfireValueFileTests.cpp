@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "Nfc/Desfire/DesfireValueFile.h"
+#include "Nfc/Desfire/DesfireCard.h"
+#include "Nfc/Wire/NativeWire.h"
+#include "Support/ValueCard.h"
+
+using namespace nfc;
+using test_support::ValueCard;
+
+TEST(DesfireValueFileTests, PredictsBalanceAfterCommit)
+{
+    ValueCard transceiver;
+    NativeWire wire;
+    DesfireCard card(transceiver, wire);
+    DesfireValueFile file(card, 0x03);
+
+    ASSERT_EQ(file.balance().value(), 100);
+    ASSERT_TRUE(file.debit(30).has_value());
+    EXPECT_EQ(file.pendingDelta(), -30);
+
+    auto committed = file.commit();
+    ASSERT_TRUE(committed.has_value());
+    EXPECT_EQ(committed.value().balance, 70);
+    EXPECT_TRUE(committed.value().committed);
+    EXPECT_FALSE(committed.value().verified);
+
+    // Next fare starts from the cache
+    ASSERT_EQ(file.balance().value(), 70);
+    EXPECT_EQ(transceiver.count(0x6C), 1U);
+    EXPECT_EQ(file.metrics().cacheHits, 1U);
+    EXPECT_EQ(transceiver.value, 70);
+}
+
+TEST(DesfireValueFileTests, ReconcilesLostCommitResponse)
+{
+    ValueCard transceiver;
+    NativeWire wire;
+    DesfireCard card(transceiver, wire);
+    DesfireValueFile file(card, 0x03);
+
+    ASSERT_TRUE(file.balance().has_value());
+    ASSERT_TRUE(file.credit(25).has_value());
+    transceiver.commitFault = ValueCard::CommitFault::LostResponse;
+
+    auto result = file.commit();
+    ASSERT_TRUE(result.has_value());
+    EXPECT_TRUE(result.value().committed);
+    EXPECT_TRUE(result.value().verified);
+    EXPECT_EQ(result.value().balance, 125);
+    EXPECT_EQ(file.metrics().reconciliations, 1U);
+    EXPECT_EQ(transceiver.count(0x6C), 2U);
+}
+
+TEST(DesfireValueFileTests, ReconcilesCommitThatNeverArrived)
+{
+    ValueCard transceiver;
+    NativeWire wire;
+    DesfireCard card(transceiver, wire);
+    DesfireValueFile file(card, 0x03);
+
+    ASSERT_TRUE(file.balance().has_value());
+    ASSERT_TRUE(file.debit(40).has_value());
+    transceiver.commitFault = ValueCard::CommitFault::LostRequest;
+
+    auto result = file.commit();
+    ASSERT_TRUE(result.has_value());
+    EXPECT_FALSE(result.value().committed);
+    EXPECT_TRUE(result.value().verified);
+    EXPECT_EQ(result.value().balance, 100);
+    EXPECT_EQ(file.pendingDelta(), 0);
+    EXPECT_TRUE(file.isCached());
+}
+
+TEST(DesfireValueFileTests, DropsCacheWhenSessionChanges)
+{
+    ValueCard transceiver;
+    NativeWire wire;
+    DesfireCard card(transceiver, wire);
+    DesfireValueFile file(card, 0x03);
+
+    ASSERT_TRUE(file.balance().has_value());
+    ASSERT_TRUE(file.debit(10).has_value());
+
+    ASSERT_TRUE(card.selectApplication({0x01, 0x02, 0x03}).has_value());
+    EXPECT_FALSE(file.isCached());
+
+    // The debit was aborted by the select, so the prediction must not be used
+    auto result = file.commit();
+    ASSERT_TRUE(result.has_value());
+    EXPECT_TRUE(result.value().verified);
+    EXPECT_EQ(result.value().balance, 100);
+}
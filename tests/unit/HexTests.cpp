@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <etl/string.h>
+#include "Utils/Hex.h"
+#include "Pn532/Commands/InListPassiveTarget.h"
+
+using namespace utils;
+
+// Test: Every byte value encodes to its two upper-case digits and back
+TEST(HexTests, RoundTripsEveryByteValue)
+{
+    std::vector<uint8_t> bytes(256);
+    for (size_t i = 0; i < bytes.size(); ++i)
+    {
+        bytes[i] = static_cast<uint8_t>(i);
+    }
+
+    std::string text(hexEncodedLength(bytes.size()), '\0');
+    EXPECT_EQ(hexEncode(bytes.data(), bytes.size(), text.data()), 512U);
+    EXPECT_EQ(text.substr(0, 6), "000102");
+    EXPECT_EQ(text.substr(506), "FDFEFF");
+
+    std::vector<uint8_t> decoded(256);
+    size_t length = 0U;
+    ASSERT_TRUE(hexDecode(text.data(), text.size(), decoded.data(), decoded.size(), length));
+    EXPECT_EQ(length, 256U);
+    EXPECT_EQ(decoded, bytes);
+}
+
+// Test: Separators go between bytes only
+TEST(HexTests, EncodesWithSeparator)
+{
+    const uint8_t bytes[] = {0x04, 0xA1, 0xFF};
+    char text[16] = {0};
+    EXPECT_EQ(hexEncode(bytes, sizeof(bytes), text, ':'), hexEncodedLength(sizeof(bytes), true));
+    EXPECT_STREQ(text, "04:A1:FF");
+    EXPECT_EQ(hexEncode(bytes, 0U, text, ':'), 0U);
+}
+
+// Test: Strict decoding refuses odd lengths, non-hex characters and short buffers
+TEST(HexTests, StrictDecodeRejectsMalformedText)
+{
+    uint8_t out[4] = {0};
+    size_t length = 0U;
+    EXPECT_TRUE(hexDecode("a1B2", 4U, out, sizeof(out), length));
+    EXPECT_EQ(out[0], 0xA1);
+    EXPECT_EQ(out[1], 0xB2);
+    EXPECT_FALSE(hexDecode("A1B", 3U, out, sizeof(out), length));
+    EXPECT_FALSE(hexDecode("A1 B2", 5U, out, sizeof(out), length));
+    EXPECT_FALSE(hexDecode("G1", 2U, out, sizeof(out), length));
+    EXPECT_FALSE(hexDecode("0011223344", 10U, out, sizeof(out), length));
+}
+
+// Test: Loose decoding skips separators but still wants whole bytes
+TEST(HexTests, LooseDecodeSkipsSeparators)
+{
+    uint8_t out[4] = {0};
+    size_t length = 0U;
+    const std::string key = "11 22:aa-BB";
+    ASSERT_TRUE(hexDecodeLoose(key.data(), key.size(), out, sizeof(out), length));
+    EXPECT_EQ(length, 4U);
+    EXPECT_EQ(out[3], 0xBB);
+    EXPECT_FALSE(hexDecodeLoose("11 2", 4U, out, sizeof(out), length));
+    EXPECT_FALSE(hexDecodeLoose("11 22 33 44 55", 14U, out, sizeof(out), length));
+}
+
+// Test: Appending stops at the last whole byte that fits
+TEST(HexTests, AppendTruncatesAtWholeBytes)
+{
+    const uint8_t bytes[] = {0x01, 0x02, 0x03, 0x04};
+    etl::string<10> text("ID ");
+    appendHex(text, bytes, sizeof(bytes));
+    EXPECT_EQ(std::string(text.c_str()), "ID 01 02");
+}
+
+// Test: Command requests print their code and payload
+TEST(HexTests, CommandRequestToString)
+{
+    pn532::InListPassiveTarget command(pn532::InListPassiveTargetOptions{});
+    EXPECT_EQ(std::string(command.buildRequest().toString().c_str()), "Cmd 0x4A [2 bytes]: 01 00");
+}
@@ -0,0 +1,365 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "Nfc/Ndef/NdefStreamParser.h"
+#include "Nfc/Ndef/NdefType4Tag.h"
+#include "Nfc/Desfire/DesfireCard.h"
+#include "Nfc/Apdu/IApduTransceiver.h"
+#include "Nfc/Wire/NativeWire.h"
+#include "Error/DesfireError.h"
+
+using namespace nfc;
+
+namespace
+{
+    struct CollectedRecord
+    {
+        uint8_t flags = 0U;
+        NdefTnf tnf = NdefTnf::Empty;
+        std::vector<uint8_t> type;
+        std::vector<uint8_t> id;
+        std::vector<uint8_t> payload;
+        size_t payloadPieces = 0U;
+        bool ended = false;
+    };
+
+    class CollectingHandler : public INdefRecordHandler
+    {
+    public:
+        void onRecordBegin(const NdefRecordHeader& header) override
+        {
+            CollectedRecord record;
+            record.flags = header.flags;
+            record.tnf = header.tnf;
+            record.type.assign(header.type.begin(), header.type.end());
+            record.id.assign(header.id.begin(), header.id.end());
+            records.push_back(record);
+        }
+
+        void onPayload(const uint8_t* data, size_t length) override
+        {
+            records.back().payload.insert(records.back().payload.end(), data, data + length);
+            ++records.back().payloadPieces;
+        }
+
+        void onRecordEnd() override
+        {
+            records.back().ended = true;
+        }
+
+        std::vector<CollectedRecord> records;
+    };
+
+    void appendRecord(
+        std::vector<uint8_t>& message,
+        uint8_t flags,
+        NdefTnf tnf,
+        const std::string& type,
+        const std::vector<uint8_t>& payload,
+        const std::string& id = std::string())
+    {
+        const bool shortRecord = payload.size() < 256U;
+        uint8_t header = static_cast<uint8_t>(flags | static_cast<uint8_t>(tnf));
+        if (shortRecord)
+        {
+            header |= ndef::FLAG_SR;
+        }
+        if (!id.empty())
+        {
+            header |= ndef::FLAG_IL;
+        }
+
+        message.push_back(header);
+        message.push_back(static_cast<uint8_t>(type.size()));
+        if (shortRecord)
+        {
+            message.push_back(static_cast<uint8_t>(payload.size()));
+        }
+        else
+        {
+            const uint32_t length = static_cast<uint32_t>(payload.size());
+            message.push_back(static_cast<uint8_t>(length >> 24U));
+            message.push_back(static_cast<uint8_t>(length >> 16U));
+            message.push_back(static_cast<uint8_t>(length >> 8U));
+            message.push_back(static_cast<uint8_t>(length));
+        }
+        if (!id.empty())
+        {
+            message.push_back(static_cast<uint8_t>(id.size()));
+        }
+        message.insert(message.end(), type.begin(), type.end());
+        message.insert(message.end(), id.begin(), id.end());
+        message.insert(message.end(), payload.begin(), payload.end());
+    }
+
+    std::vector<uint8_t> pattern(size_t length, uint8_t seed)
+    {
+        std::vector<uint8_t> bytes(length);
+        for (size_t i = 0; i < length; ++i)
+        {
+            bytes[i] = static_cast<uint8_t>(seed + i * 7U);
+        }
+        return bytes;
+    }
+
+    /**
+     * Plain-mode DESFire card holding a Type 4 Tag application. ReadData
+     * responses are split into 59-byte frames with AF chaining.
+     */
+    class EmulatedType4Card : public IApduTransceiver
+    {
+    public:
+        static constexpr size_t FRAME_SIZE = 59U;
+
+        explicit EmulatedType4Card(size_t ndefFileSize)
+        {
+            const uint8_t maxHigh = static_cast<uint8_t>(ndefFileSize >> 8U);
+            const uint8_t maxLow = static_cast<uint8_t>(ndefFileSize);
+            files[0x01] = {0x00, 0x0F, 0x20, 0x00, 0x3B, 0x00, 0x34, 0x04, 0x06, 0xE1, 0x04, maxHigh, maxLow, 0x00, 0x00};
+            files[0x02] = std::vector<uint8_t>(ndefFileSize, 0x00);
+        }
+
+        void setWire(IWire&) override
+        {
+        }
+
+        etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> transceive(
+            const etl::ivector<uint8_t>& apdu) override
+        {
+            ++commandCount;
+            std::vector<uint8_t> reply;
+            switch (apdu[0])
+            {
+                case 0x5A:
+                    selectedAid.assign(apdu.begin() + 1, apdu.end());
+                    reply.push_back(0x00);
+                    break;
+
+                case 0xBD:
+                {
+                    const std::vector<uint8_t>& file = files[apdu[1]];
+                    const size_t offset = le24(&apdu[2]);
+                    const size_t length = le24(&apdu[5]);
+                    if (offset + length > file.size())
+                    {
+                        reply.push_back(0xBE);
+                        break;
+                    }
+                    pending.assign(file.begin() + offset, file.begin() + offset + length);
+                    reply = nextFrame();
+                    break;
+                }
+
+                case 0xAF:
+                    reply = nextFrame();
+                    break;
+
+                case 0x3D:
+                {
+                    std::vector<uint8_t>& file = files[apdu[1]];
+                    const size_t offset = le24(&apdu[2]);
+                    const size_t length = le24(&apdu[5]);
+                    if (offset + length > file.size() || apdu.size() != 8U + length)
+                    {
+                        reply.push_back(0xBE);
+                        break;
+                    }
+                    std::copy(apdu.begin() + 8, apdu.end(), file.begin() + offset);
+                    writes.push_back({apdu[1], offset, std::vector<uint8_t>(apdu.begin() + 8, apdu.end())});
+                    reply.push_back(0x00);
+                    break;
+                }
+
+                default:
+                    reply.push_back(0x1C);
+                    break;
+            }
+
+            etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX> response;
+            response.assign(reply.begin(), reply.end());
+            return response;
+        }
+
+        void storeMessage(const std::vector<uint8_t>& message)
+        {
+            std::vector<uint8_t>& file = files[0x02];
+            file[0] = static_cast<uint8_t>(message.size() >> 8U);
+            file[1] = static_cast<uint8_t>(message.size());
+            std::copy(message.begin(), message.end(), file.begin() + 2);
+        }
+
+        struct Write
+        {
+            uint8_t fileNo;
+            size_t offset;
+            std::vector<uint8_t> data;
+        };
+
+        std::map<uint8_t, std::vector<uint8_t>> files;
+        std::vector<uint8_t> selectedAid;
+        std::vector<Write> writes;
+        size_t commandCount = 0U;
+
+    private:
+        static size_t le24(const uint8_t* data)
+        {
+            return static_cast<size_t>(data[0]) |
+                   (static_cast<size_t>(data[1]) << 8U) |
+                   (static_cast<size_t>(data[2]) << 16U);
+        }
+
+        std::vector<uint8_t> nextFrame()
+        {
+            const size_t take = pending.size() < FRAME_SIZE ? pending.size() : FRAME_SIZE;
+            std::vector<uint8_t> frame;
+            frame.push_back(take == pending.size() ? 0x00 : 0xAF);
+            frame.insert(frame.end(), pending.begin(), pending.begin() + take);
+            pending.erase(pending.begin(), pending.begin() + take);
+            return frame;
+        }
+
+        std::vector<uint8_t> pending;
+    };
+}
+
+TEST(NdefStreamParserTests, ParsesMessageFedOneByteAtATime)
+{
+    std::vector<uint8_t> message;
+    appendRecord(message, ndef::FLAG_MB, NdefTnf::WellKnown, "U", {0x04, 'e', 'x', '.', 'n', 'l'}, "a");
+    appendRecord(message, ndef::FLAG_ME, NdefTnf::Media, "text/plain", pattern(300, 0x11));
+
+    CollectingHandler handler;
+    NdefStreamParser parser(handler);
+    for (uint8_t byte : message)
+    {
+        ASSERT_TRUE(parser.feed(&byte, 1U).has_value());
+    }
+    ASSERT_TRUE(parser.finish().has_value());
+
+    ASSERT_EQ(handler.records.size(), 2U);
+    EXPECT_EQ(parser.recordCount(), 2U);
+    EXPECT_EQ(handler.records[0].tnf, NdefTnf::WellKnown);
+    EXPECT_EQ(handler.records[0].type, std::vector<uint8_t>({'U'}));
+    EXPECT_EQ(handler.records[0].id, std::vector<uint8_t>({'a'}));
+    EXPECT_EQ(handler.records[0].payload, std::vector<uint8_t>({0x04, 'e', 'x', '.', 'n', 'l'}));
+    EXPECT_EQ(handler.records[1].tnf, NdefTnf::Media);
+    EXPECT_EQ(handler.records[1].payload, pattern(300, 0x11));
+    EXPECT_EQ(handler.records[1].payloadPieces, 300U);
+    EXPECT_TRUE(handler.records[1].ended);
+}
+
+TEST(NdefStreamParserTests, AcceptsChunkedRecordAndEmptyMessage)
+{
+    std::vector<uint8_t> message;
+    appendRecord(message, ndef::FLAG_MB | ndef::FLAG_CF, NdefTnf::Media, "a/b", pattern(10, 0x01));
+    appendRecord(message, ndef::FLAG_CF, NdefTnf::Unchanged, "", pattern(10, 0x02));
+    appendRecord(message, ndef::FLAG_ME, NdefTnf::Unchanged, "", pattern(5, 0x03));
+
+    CollectingHandler handler;
+    NdefStreamParser parser(handler);
+    ASSERT_TRUE(parser.finish().has_value());
+    ASSERT_TRUE(parser.feed(message.data(), message.size()).has_value());
+    ASSERT_TRUE(parser.finish().has_value());
+    EXPECT_EQ(handler.records.size(), 3U);
+    EXPECT_EQ(handler.records[2].tnf, NdefTnf::Unchanged);
+}
+
+TEST(NdefStreamParserTests, RejectsMalformedAndTruncatedMessages)
+{
+    CollectingHandler handler;
+    NdefStreamParser parser(handler);
+
+    // First record without MB
+    const uint8_t noBegin[] = {0xD1 & static_cast<uint8_t>(~ndef::FLAG_MB), 0x01, 0x00, 'T'};
+    auto result = parser.feed(noBegin, sizeof(noBegin));
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().get<error::DesfireError>(), error::DesfireError::InvalidResponse);
+
+    // Data after the ME record
+    parser.reset();
+    const uint8_t trailing[] = {0xD1, 0x01, 0x00, 'T', 0x00};
+    EXPECT_FALSE(parser.feed(trailing, sizeof(trailing)).has_value());
+
+    // Message stops inside a payload
+    parser.reset();
+    const uint8_t truncated[] = {0xD1, 0x01, 0x04, 'T', 0x02};
+    ASSERT_TRUE(parser.feed(truncated, sizeof(truncated)).has_value());
+    auto finish = parser.finish();
+    ASSERT_FALSE(finish.has_value());
+    EXPECT_EQ(finish.error().get<error::DesfireError>(), error::DesfireError::LengthError);
+}
+
+TEST(NdefType4TagTests, ReadsCapabilityContainer)
+{
+    EmulatedType4Card emulated(1024U);
+    NativeWire wire;
+    DesfireCard card(emulated, wire);
+    NdefType4Tag tag(card);
+
+    auto cc = tag.open();
+    ASSERT_TRUE(cc.has_value());
+    EXPECT_EQ(emulated.selectedAid, std::vector<uint8_t>({0x10, 0xEE, 0xEE}));
+    EXPECT_EQ(cc.value().mappingVersion, 0x20);
+    EXPECT_EQ(cc.value().maxReadLength, 0x3B);
+    EXPECT_EQ(cc.value().maxWriteLength, 0x34);
+    EXPECT_EQ(cc.value().ndefFileId, 0xE104);
+    EXPECT_EQ(cc.value().maxNdefFileSize, 1024U);
+}
+
+TEST(NdefType4TagTests, StreamsLargeMessageInChunks)
+{
+    std::vector<uint8_t> message;
+    appendRecord(message, ndef::FLAG_MB, NdefTnf::WellKnown, "T", {0x02, 'e', 'n', 'h', 'i'});
+    appendRecord(message, ndef::FLAG_ME, NdefTnf::Media, "application/octet-stream", pattern(9000, 0x5A));
+
+    EmulatedType4Card emulated(message.size() + 2U);
+    emulated.storeMessage(message);
+    NativeWire wire;
+    DesfireCard card(emulated, wire);
+    NdefType4Tag tag(card);
+
+    CollectingHandler handler;
+    auto result = tag.readMessage(handler);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value(), message.size());
+    ASSERT_EQ(handler.records.size(), 2U);
+    EXPECT_EQ(handler.records[1].payload, pattern(9000, 0x5A));
+    // Delivered per MLe-sized chunk, never as one buffer
+    EXPECT_GT(handler.records[1].payloadPieces, 9000U / 0x3BU);
+}
+
+TEST(NdefType4TagTests, WriteClearsLengthBeforeBody)
+{
+    std::vector<uint8_t> message;
+    appendRecord(message, ndef::FLAG_MB | ndef::FLAG_ME, NdefTnf::Media, "a/b", pattern(500, 0x33));
+
+    EmulatedType4Card emulated(1024U);
+    emulated.storeMessage(pattern(100, 0x01));
+    NativeWire wire;
+    DesfireCard card(emulated, wire);
+    NdefType4Tag tag(card);
+
+    ASSERT_TRUE(tag.writeMessage(message.data(), message.size()).has_value());
+
+    ASSERT_GE(emulated.writes.size(), 3U);
+    EXPECT_EQ(emulated.writes.front().offset, 0U);
+    EXPECT_EQ(emulated.writes.front().data, std::vector<uint8_t>({0x00, 0x00}));
+    EXPECT_EQ(emulated.writes.back().offset, 0U);
+    EXPECT_EQ(emulated.writes.back().data,
+        std::vector<uint8_t>({static_cast<uint8_t>(message.size() >> 8U), static_cast<uint8_t>(message.size())}));
+    for (size_t i = 1; i + 1 < emulated.writes.size(); ++i)
+    {
+        EXPECT_GE(emulated.writes[i].offset, NdefType4Tag::NLEN_SIZE);
+        EXPECT_LE(emulated.writes[i].data.size(), 0x34U);
+    }
+
+    CollectingHandler handler;
+    ASSERT_TRUE(tag.readMessage(handler).has_value());
+    ASSERT_EQ(handler.records.size(), 1U);
+    EXPECT_EQ(handler.records[0].payload, pattern(500, 0x33));
+
+    auto tooLarge = tag.writeMessage(message.data(), 1023U);
+    ASSERT_FALSE(tooLarge.has_value());
+    EXPECT_EQ(tooLarge.error().get<error::DesfireError>(), error::DesfireError::BoundaryError);
+}
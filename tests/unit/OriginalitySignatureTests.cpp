@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+#include "Nfc/Card/OriginalitySignature.h"
+#include "Nfc/Desfire/DesfireCard.h"
+#include "Nfc/Apdu/IApduTransceiver.h"
+#include "Nfc/Wire/NativeWire.h"
+#include "Error/CardManagerError.h"
+
+using namespace nfc;
+
+namespace
+{
+    // Test issuer keys and signatures over the UIDs below (ECDSA, no hash)
+    const std::vector<uint8_t> P224_PUBLIC_KEY = {
+        0x04, 0x40, 0xEC, 0x7F, 0xD1, 0xB7, 0xC7, 0xE1, 0x94, 0xBB, 0xE4, 0x61, 0x76, 0xAA, 0xE7, 0x2B,
+        0x6A, 0x55, 0xEE, 0xB4, 0xB2, 0xA0, 0xF5, 0x44, 0xE1, 0x43, 0xA3, 0x05, 0xCC, 0xF5, 0xBB, 0x5E,
+        0xB6, 0x13, 0x50, 0xF5, 0x9E, 0x54, 0xA7, 0x54, 0xE7, 0x38, 0xC3, 0xFB, 0xA2, 0x94, 0xB7, 0x8F,
+        0xD0, 0x0D, 0xC8, 0x76, 0x1C, 0x64, 0xB9, 0x85, 0xDF};
+    const std::vector<uint8_t> P128_PUBLIC_KEY = {
+        0x04, 0x66, 0x83, 0x83, 0x29, 0xBF, 0x60, 0xF7, 0x50, 0xFF, 0x4C, 0xED, 0x17, 0x02, 0xF7, 0x6D,
+        0xF9, 0xD4, 0xA6, 0xDD, 0x39, 0x28, 0x16, 0x3D, 0x23, 0x52, 0xD1, 0x4E, 0x7A, 0x6D, 0x62, 0x0C,
+        0xCF};
+
+    const std::vector<uint8_t> UID_A = {0x04, 0xA1, 0xB2, 0xC3, 0xD4, 0xE5, 0x80};
+    const std::vector<uint8_t> UID_B = {0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+
+    const std::vector<uint8_t> P224_SIG_A = {
+        0x5A, 0x73, 0xBC, 0x03, 0x01, 0x08, 0x81, 0x2D, 0x66, 0xDE, 0x6B, 0x3C, 0x06, 0xA9, 0x4F, 0x7D,
+        0xB9, 0x6A, 0xA5, 0xAC, 0xA2, 0xAC, 0x50, 0x07, 0xB1, 0x9C, 0x93, 0xAB, 0xE8, 0xC2, 0xB8, 0xB5,
+        0x3E, 0x86, 0x4F, 0xF1, 0x3A, 0xE1, 0xDD, 0x3A, 0x56, 0xE7, 0xC1, 0xDB, 0x23, 0x49, 0xC7, 0x79,
+        0x2E, 0xD6, 0x21, 0xA3, 0xFA, 0x04, 0xF2, 0x0B};
+    const std::vector<uint8_t> P224_SIG_B = {
+        0x92, 0x4C, 0x6C, 0x41, 0x44, 0x6C, 0x8C, 0x88, 0x2F, 0xFC, 0xBA, 0x2D, 0xC6, 0x81, 0x39, 0xE2,
+        0x48, 0x31, 0x58, 0x96, 0xC8, 0x59, 0xAE, 0x38, 0x9A, 0xBF, 0x2C, 0x72, 0x1C, 0xC3, 0x36, 0x36,
+        0x27, 0xE4, 0x79, 0x6A, 0xCB, 0xB1, 0x92, 0x6D, 0xCE, 0x7D, 0x48, 0x36, 0x3C, 0x3D, 0xB1, 0x55,
+        0x61, 0x48, 0x3F, 0x2A, 0xCC, 0x47, 0x2F, 0x31};
+    const std::vector<uint8_t> P128_SIG_A = {
+        0x57, 0x09, 0x1D, 0x67, 0x75, 0x5A, 0x2A, 0xA3, 0x04, 0x73, 0xBA, 0x66, 0xDE, 0x49, 0x81, 0xB9,
+        0x4E, 0xA0, 0x91, 0x2A, 0xF9, 0xBD, 0x66, 0x88, 0x2F, 0xB7, 0x01, 0x2E, 0x94, 0x7A, 0x28, 0x58};
+    const std::vector<uint8_t> P128_SIG_B = {
+        0xE2, 0xD0, 0x8A, 0xA6, 0xCE, 0xFC, 0xCB, 0x3D, 0x14, 0x6E, 0x03, 0xF8, 0x23, 0x42, 0xEC, 0x35,
+        0xE8, 0x08, 0xD7, 0x2A, 0xA2, 0x05, 0xBD, 0xCA, 0xA9, 0x23, 0x7A, 0x29, 0x3A, 0xB1, 0x74, 0x16};
+
+    template <size_t N>
+    etl::vector<uint8_t, N> toEtl(const std::vector<uint8_t>& bytes)
+    {
+        return etl::vector<uint8_t, N>(bytes.begin(), bytes.end());
+    }
+
+    bool verify(OriginalitySignatureVerifier& verifier, const std::vector<uint8_t>& uid, const std::vector<uint8_t>& signature)
+    {
+        auto result = verifier.verify(OriginalityKeyId::Custom, toEtl<10>(uid), toEtl<56>(signature));
+        EXPECT_TRUE(result.has_value());
+        return result.has_value() && result.value();
+    }
+
+    OriginalityBatchItem batchItem(const std::vector<uint8_t>& uid, const std::vector<uint8_t>& signature)
+    {
+        OriginalityBatchItem item;
+        item.uid = uid.data();
+        item.uidLength = uid.size();
+        item.signature = signature.data();
+        item.signatureLength = signature.size();
+        return item;
+    }
+
+    class SignatureCard : public IApduTransceiver
+    {
+    public:
+        void setWire(IWire&) override
+        {
+        }
+
+        etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> transceive(
+            const etl::ivector<uint8_t>& apdu) override
+        {
+            sent.emplace_back(apdu.begin(), apdu.end());
+            etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX> response;
+            response.push_back(0x00);
+            response.insert(response.end(), P224_SIG_A.begin(), P224_SIG_A.end());
+            return response;
+        }
+
+        std::vector<std::vector<uint8_t>> sent;
+    };
+}
+
+TEST(OriginalitySignatureTests, VerifiesSecp224r1Signatures)
+{
+    auto verifier = std::make_unique<OriginalitySignatureVerifier>();
+    ASSERT_TRUE(verifier->setCustomKey(OriginalityCurve::Secp224r1, P224_PUBLIC_KEY.data(), P224_PUBLIC_KEY.size()).has_value());
+
+    EXPECT_TRUE(verify(*verifier, UID_A, P224_SIG_A));
+    EXPECT_TRUE(verify(*verifier, UID_B, P224_SIG_B));
+
+    // Signature copied to another UID, and a flipped bit in s
+    EXPECT_FALSE(verify(*verifier, UID_B, P224_SIG_A));
+    std::vector<uint8_t> tampered = P224_SIG_A;
+    tampered[40] ^= 0x01;
+    EXPECT_FALSE(verify(*verifier, UID_A, tampered));
+
+    EXPECT_EQ(verifier->metrics().tablesBuilt, 2U);
+    EXPECT_EQ(verifier->metrics().rejected, 2U);
+}
+
+TEST(OriginalitySignatureTests, VerifiesSecp128r1Signatures)
+{
+    auto verifier = std::make_unique<OriginalitySignatureVerifier>();
+    ASSERT_TRUE(verifier->setCustomKey(OriginalityCurve::Secp128r1, P128_PUBLIC_KEY.data(), P128_PUBLIC_KEY.size()).has_value());
+
+    EXPECT_TRUE(verify(*verifier, UID_A, P128_SIG_A));
+    EXPECT_TRUE(verify(*verifier, UID_B, P128_SIG_B));
+    EXPECT_FALSE(verify(*verifier, UID_A, P128_SIG_B));
+
+    // Wrong length for the curve
+    auto wrongLength = verifier->verify(OriginalityKeyId::Custom, toEtl<10>(UID_A), toEtl<56>(P224_SIG_A));
+    ASSERT_FALSE(wrongLength.has_value());
+    EXPECT_TRUE(wrongLength.error().is<error::CardManagerError>());
+
+    // A point off the curve is refused
+    std::vector<uint8_t> offCurve = P128_PUBLIC_KEY;
+    offCurve[32] ^= 0x01;
+    EXPECT_FALSE(verifier->setCustomKey(OriginalityCurve::Secp128r1, offCurve.data(), offCurve.size()).has_value());
+}
+
+TEST(OriginalitySignatureTests, CachesResultPerUidAndSignature)
+{
+    auto verifier = std::make_unique<OriginalitySignatureVerifier>();
+    ASSERT_TRUE(verifier->setCustomKey(OriginalityCurve::Secp224r1, P224_PUBLIC_KEY.data(), P224_PUBLIC_KEY.size()).has_value());
+
+    EXPECT_TRUE(verify(*verifier, UID_A, P224_SIG_A));
+    EXPECT_TRUE(verify(*verifier, UID_A, P224_SIG_A));
+    EXPECT_FALSE(verify(*verifier, UID_B, P224_SIG_A));
+    EXPECT_FALSE(verify(*verifier, UID_B, P224_SIG_A));
+    EXPECT_EQ(verifier->metrics().verifications, 2U);
+    EXPECT_EQ(verifier->metrics().cacheHits, 2U);
+
+    verifier->clearCache();
+    EXPECT_TRUE(verify(*verifier, UID_A, P224_SIG_A));
+    EXPECT_EQ(verifier->metrics().verifications, 3U);
+}
+
+TEST(OriginalitySignatureTests, BatchVerifiesLoggedSignatures)
+{
+    auto verifier = std::make_unique<OriginalitySignatureVerifier>();
+    ASSERT_TRUE(verifier->setCustomKey(OriginalityCurve::Secp224r1, P224_PUBLIC_KEY.data(), P224_PUBLIC_KEY.size()).has_value());
+
+    std::vector<uint8_t> tampered = P224_SIG_B;
+    tampered[3] ^= 0x80;
+    const std::vector<uint8_t> zeroR(56U, 0x00);
+
+    std::vector<OriginalityBatchItem> items;
+    for (size_t i = 0U; i < 12U; ++i)
+    {
+        items.push_back(batchItem(UID_A, P224_SIG_A));
+        items.push_back(batchItem(UID_B, P224_SIG_B));
+    }
+    items.push_back(batchItem(UID_B, tampered));
+    items.push_back(batchItem(UID_A, zeroR));
+
+    auto valid = verifier->verifyBatch(OriginalityKeyId::Custom, items.data(), items.size());
+    ASSERT_TRUE(valid.has_value());
+    EXPECT_EQ(valid.value(), 24U);
+    for (size_t i = 0U; i < 24U; ++i)
+    {
+        EXPECT_TRUE(items[i].valid);
+    }
+    EXPECT_FALSE(items[24].valid);
+    EXPECT_FALSE(items[25].valid);
+    EXPECT_EQ(verifier->metrics().verifications, 25U);
+}
+
+TEST(OriginalitySignatureTests, NxpKeysAreUsableAndMappedToGenerations)
+{
+    auto verifier = std::make_unique<OriginalitySignatureVerifier>();
+    EXPECT_TRUE(verifier->precompute(OriginalityKeyId::Ntag21x).has_value());
+    EXPECT_TRUE(verifier->precompute(OriginalityKeyId::DesfireEv2).has_value());
+    EXPECT_TRUE(verifier->precompute(OriginalityKeyId::DesfireEv3).has_value());
+    EXPECT_TRUE(verifier->precompute(OriginalityKeyId::DesfireLight).has_value());
+    EXPECT_FALSE(verifier->precompute(OriginalityKeyId::Custom).has_value());
+    EXPECT_EQ(verifier->metrics().tablesBuilt, 6U);
+
+    EXPECT_EQ(OriginalitySignatureVerifier::keyFor(CardGeneration::Ntag424Dna).value(), OriginalityKeyId::DesfireEv3);
+    EXPECT_EQ(OriginalitySignatureVerifier::keyFor(CardGeneration::DesfireEv2).value(), OriginalityKeyId::DesfireEv2);
+    EXPECT_FALSE(OriginalitySignatureVerifier::keyFor(CardGeneration::DesfireEv1).has_value());
+    EXPECT_EQ(verifier->curveOf(OriginalityKeyId::Ntag21x), OriginalityCurve::Secp128r1);
+
+    // A signature from another issuer does not pass as NXP
+    auto result = verifier->verify(OriginalityKeyId::DesfireEv3, toEtl<10>(UID_A), toEtl<56>(P224_SIG_A));
+    ASSERT_TRUE(result.has_value());
+    EXPECT_FALSE(result.value());
+}
+
+TEST(OriginalitySignatureTests, DesfireCardReadsSignature)
+{
+    SignatureCard transceiver;
+    NativeWire wire;
+    DesfireCard card(transceiver, wire);
+
+    auto signature = card.readSignature();
+    ASSERT_TRUE(signature.has_value());
+    ASSERT_EQ(transceiver.sent.size(), 1U);
+    EXPECT_EQ(transceiver.sent[0], std::vector<uint8_t>({0x3C, 0x00}));
+    EXPECT_EQ(std::vector<uint8_t>(signature.value().begin(), signature.value().end()), P224_SIG_A);
+}
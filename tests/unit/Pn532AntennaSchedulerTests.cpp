@@ -0,0 +1,285 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <deque>
+#include <vector>
+#include "Pn532/Pn532Driver.h"
+#include "Pn532/Pn532AntennaScheduler.h"
+#include "Comms/IHardwareBus.hpp"
+#include "Error/Pn532Error.h"
+#include "Error/DesfireError.h"
+
+using namespace pn532;
+
+namespace
+{
+    uint32_t fakeNow = 0U;
+
+    uint32_t fakeClock()
+    {
+        return fakeNow;
+    }
+
+    std::vector<uint8_t> buildFrame(const std::vector<uint8_t>& body)
+    {
+        std::vector<uint8_t> frame = {0x00, 0x00, 0xFF};
+        frame.push_back(static_cast<uint8_t>(body.size()));
+        frame.push_back(static_cast<uint8_t>(0x100U - body.size()));
+        uint8_t sum = 0U;
+        for (uint8_t b : body)
+        {
+            frame.push_back(b);
+            sum = static_cast<uint8_t>(sum + b);
+        }
+        frame.push_back(static_cast<uint8_t>(0x100U - sum));
+        frame.push_back(0x00);
+        return frame;
+    }
+
+    // Fields of all readers of one gate
+    struct Gate
+    {
+        int fieldsOn = 0;
+        int mostFieldsOn = 0;
+    };
+
+    /**
+     * PN532 that only knows RFConfiguration; tracks its field in the gate.
+     */
+    class FieldPn532Bus : public comms::IHardwareBus
+    {
+    public:
+        explicit FieldPn532Bus(Gate& gate) : gate(gate)
+        {
+        }
+
+        etl::expected<void, error::Error> init() override
+        {
+            return {};
+        }
+
+        etl::expected<void, error::Error> open() override
+        {
+            setIsOpen(true);
+            return {};
+        }
+
+        void close() override
+        {
+            setIsOpen(false);
+        }
+
+        etl::expected<void, error::Error> write(const etl::ivector<uint8_t>& data) override
+        {
+            // Wake-up bytes and anything but RFConfiguration RF field go unanswered
+            if (data.size() < 10U || data[5] != 0xD4 || data[6] != 0x32 || data[7] != 0x01)
+            {
+                return {};
+            }
+
+            rfFieldFrames.emplace_back(data.begin() + 5, data.end() - 2);
+            const bool on = (data[8] & 0x01U) != 0U;
+            if (on && !fieldOn)
+            {
+                ++gate.fieldsOn;
+                gate.mostFieldsOn = std::max(gate.mostFieldsOn, gate.fieldsOn);
+            }
+            else if (!on && fieldOn)
+            {
+                --gate.fieldsOn;
+            }
+            fieldOn = on;
+
+            const uint8_t ack[] = {0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00};
+            rx.insert(rx.end(), ack, ack + sizeof(ack));
+            const std::vector<uint8_t> response = buildFrame({0xD5, 0x33});
+            rx.insert(rx.end(), response.begin(), response.end());
+            return {};
+        }
+
+        etl::expected<size_t, error::Error> read(etl::ivector<uint8_t>& buffer, size_t length) override
+        {
+            buffer.clear();
+            while (length-- > 0U && !rx.empty())
+            {
+                buffer.push_back(rx.front());
+                rx.pop_front();
+            }
+            return buffer.size();
+        }
+
+        etl::expected<void, error::Error> flush() override
+        {
+            rx.clear();
+            return {};
+        }
+
+        size_t available() const override
+        {
+            return rx.size();
+        }
+
+        etl::expected<void, error::Error> setProperty(comms::BusProperty, uint32_t) override
+        {
+            return {};
+        }
+
+        etl::expected<uint32_t, error::Error> getProperty(comms::BusProperty) const override
+        {
+            return etl::unexpected(error::Error::fromHardware(error::HardwareError::NotSupported));
+        }
+
+        bool fieldOn = true;    // PN532 default after SAMConfiguration
+        std::vector<std::vector<uint8_t>> rfFieldFrames;    // TFI onwards, without DCS/postamble
+
+    private:
+        Gate& gate;
+        std::deque<uint8_t> rx;
+    };
+}
+
+// Test Fixture: three readers of one gate, fields initially on
+class AntennaSchedulerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        fakeNow = 1000U;
+        gate.fieldsOn = 3;
+        gate.mostFieldsOn = 0;
+    }
+
+    void addReaders(Pn532AntennaScheduler& scheduler) {
+        for (auto& driver : drivers) {
+            ASSERT_TRUE(scheduler.addReader(driver).has_value());
+        }
+    }
+
+    AntennaSchedulerOptions options(AntennaSchedulingMode mode) {
+        AntennaSchedulerOptions result;
+        result.mode = mode;
+        result.clock = fakeClock;
+        return result;
+    }
+
+    Gate gate;
+    FieldPn532Bus buses[3] = {FieldPn532Bus(gate), FieldPn532Bus(gate), FieldPn532Bus(gate)};
+    Pn532Driver drivers[3] = {Pn532Driver(buses[0]), Pn532Driver(buses[1]), Pn532Driver(buses[2])};
+};
+
+// Test: setRfField sends RFConfiguration item 0x01 with the field bit
+TEST_F(AntennaSchedulerTest, SetRfFieldSendsRfConfiguration) {
+    ASSERT_TRUE(drivers[0].setRfField(false).has_value());
+    ASSERT_TRUE(drivers[0].setRfField(true).has_value());
+    ASSERT_EQ(buses[0].rfFieldFrames.size(), 2U);
+    EXPECT_EQ(buses[0].rfFieldFrames[0], std::vector<uint8_t>({0xD4, 0x32, 0x01, 0x00}));
+    EXPECT_EQ(buses[0].rfFieldFrames[1], std::vector<uint8_t>({0xD4, 0x32, 0x01, 0x01}));
+}
+
+// Test: Idle readers poll in turn and never have their fields on together
+TEST_F(AntennaSchedulerTest, ExclusiveRotationKeepsOneFieldOn) {
+    Pn532AntennaScheduler scheduler(options(AntennaSchedulingMode::Exclusive));
+    addReaders(scheduler);
+    EXPECT_EQ(gate.fieldsOn, 0);
+
+    for (size_t i = 0; i < 9; ++i) {
+        auto slot = scheduler.nextSlot();
+        ASSERT_TRUE(slot.has_value());
+        EXPECT_EQ(slot.value().reader, i % 3U);
+        EXPECT_EQ(slot.value().kind, AntennaSlotKind::Poll);
+        EXPECT_TRUE(buses[slot.value().reader].fieldOn);
+        fakeNow += slot.value().budgetMs;
+    }
+
+    EXPECT_EQ(gate.mostFieldsOn, 1);
+    EXPECT_EQ(scheduler.getMetrics().pollSlots, 9U);
+    EXPECT_EQ(scheduler.getMetrics().overlapMs, 0U);
+}
+
+// Test: A transaction keeps the field and every slot until it ends
+TEST_F(AntennaSchedulerTest, TransactionHoldsFieldUntilEnd) {
+    Pn532AntennaScheduler scheduler(options(AntennaSchedulingMode::Exclusive));
+    addReaders(scheduler);
+
+    auto first = scheduler.nextSlot();
+    ASSERT_TRUE(first.has_value());
+    ASSERT_TRUE(scheduler.beginTransaction(first.value().reader).has_value());
+    EXPECT_FALSE(scheduler.beginTransaction(1U).has_value());
+
+    const uint32_t switches = scheduler.getMetrics().fieldSwitches;
+    for (int i = 0; i < 3; ++i) {
+        fakeNow += 100U;
+        auto slot = scheduler.nextSlot();
+        ASSERT_TRUE(slot.has_value());
+        EXPECT_EQ(slot.value().reader, first.value().reader);
+        EXPECT_EQ(slot.value().kind, AntennaSlotKind::Transaction);
+        EXPECT_EQ(slot.value().budgetMs, 2000U - 100U * static_cast<uint32_t>(i + 1));
+    }
+    EXPECT_EQ(scheduler.getMetrics().fieldSwitches, switches);
+
+    scheduler.endTransaction(first.value().reader);
+    auto next = scheduler.nextSlot();
+    ASSERT_TRUE(next.has_value());
+    EXPECT_EQ(next.value().reader, 1U);
+    EXPECT_EQ(next.value().kind, AntennaSlotKind::Poll);
+    EXPECT_FALSE(buses[0].fieldOn);
+    EXPECT_EQ(gate.mostFieldsOn, 1);
+}
+
+// Test: A transaction past its limit loses the field
+TEST_F(AntennaSchedulerTest, RevokesOverrunningTransaction) {
+    Pn532AntennaScheduler scheduler(options(AntennaSchedulingMode::Exclusive));
+    addReaders(scheduler);
+
+    ASSERT_TRUE(scheduler.nextSlot().has_value());
+    ASSERT_TRUE(scheduler.beginTransaction(0U).has_value());
+    fakeNow += 2000U;
+
+    auto slot = scheduler.nextSlot();
+    ASSERT_TRUE(slot.has_value());
+    EXPECT_EQ(slot.value().reader, 1U);
+    EXPECT_EQ(slot.value().kind, AntennaSlotKind::Poll);
+    EXPECT_EQ(scheduler.getMetrics().transactionsRevoked, 1U);
+}
+
+// Test: Poll bursts grow where cards turn up and shrink where none do
+TEST_F(AntennaSchedulerTest, PollBurstsFollowDemand) {
+    Pn532AntennaScheduler scheduler(options(AntennaSchedulingMode::Exclusive));
+    addReaders(scheduler);
+
+    uint32_t budgets[3] = {};
+    for (int round = 0; round < 4; ++round) {
+        for (size_t reader = 0; reader < 3U; ++reader) {
+            auto slot = scheduler.nextSlot();
+            ASSERT_TRUE(slot.has_value());
+            budgets[slot.value().reader] = slot.value().budgetMs;
+            if (slot.value().reader == 0U) {
+                ASSERT_TRUE(scheduler.beginTransaction(0U).has_value());
+                scheduler.endTransaction(0U);
+            }
+        }
+    }
+
+    EXPECT_EQ(budgets[0], 100U);    // 20, 40, 80, 100
+    EXPECT_EQ(budgets[1], 20U);
+    EXPECT_EQ(budgets[2], 20U);
+}
+
+// Test: Shared mode is the baseline: overlap time and RF errors are counted
+TEST_F(AntennaSchedulerTest, SharedModeMeasuresOverlap) {
+    Pn532AntennaScheduler scheduler(options(AntennaSchedulingMode::Shared));
+    addReaders(scheduler);
+    EXPECT_EQ(gate.fieldsOn, 3);
+
+    for (int i = 0; i < 3; ++i) {
+        auto slot = scheduler.nextSlot();
+        ASSERT_TRUE(slot.has_value());
+        fakeNow += slot.value().budgetMs;
+    }
+    ASSERT_TRUE(scheduler.nextSlot().has_value());
+    EXPECT_EQ(scheduler.getMetrics().overlapMs, 60U);
+    EXPECT_EQ(scheduler.getMetrics().fieldSwitches, 3U);   // switched on when added
+
+    scheduler.recordSuccess();
+    scheduler.recordFailure(error::Error::fromPn532(error::Pn532Error::CRCError));
+    scheduler.recordFailure(error::Error::fromDesfire(error::DesfireError::PermissionDenied));
+    EXPECT_EQ(scheduler.getMetrics().exchanges, 3U);
+    EXPECT_EQ(scheduler.getMetrics().rfErrors, 1U);
+}
@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "Pn532/Pn532Driver.h"
+#include "Pn532/Pn532ApduAdapter.h"
+#include "Pn532/Commands/InDataExchange.h"
+#include "Nfc/Wire/IsoWire.h"
+#include "Nfc/Wire/NativeWire.h"
+#include "Error/Pn532Error.h"
+#include "Support/ScriptedPn532Bus.h"
+
+using namespace pn532;
+using namespace nfc;
+using test_support::ScriptedPn532Bus;
+
+namespace
+{
+    std::vector<uint8_t> buildFrame(const std::vector<uint8_t>& body)
+    {
+        std::vector<uint8_t> frame = {0x00, 0x00, 0xFF};
+        frame.push_back(static_cast<uint8_t>(body.size()));
+        frame.push_back(static_cast<uint8_t>(0x100U - body.size()));
+        uint8_t sum = 0U;
+        for (uint8_t b : body)
+        {
+            frame.push_back(b);
+            sum = static_cast<uint8_t>(sum + b);
+        }
+        frame.push_back(static_cast<uint8_t>(0x100U - sum));
+        frame.push_back(0x00);
+        return frame;
+    }
+
+    std::vector<uint8_t> buildResponseFrame(uint8_t status, const std::vector<uint8_t>& dataIn)
+    {
+        std::vector<uint8_t> body = {0xD5, 0x41, status};
+        body.insert(body.end(), dataIn.begin(), dataIn.end());
+        return buildFrame(body);
+    }
+
+    std::vector<uint8_t> pattern(size_t length)
+    {
+        std::vector<uint8_t> bytes(length);
+        for (size_t i = 0; i < length; ++i)
+        {
+            bytes[i] = static_cast<uint8_t>(i);
+        }
+        return bytes;
+    }
+}
+
+TEST(InDataExchangeTests, SeparatesMiFlagFromErrorCode)
+{
+    ScriptedPn532Bus bus;
+    Pn532Driver driver(bus);
+    bus.replies.push_back(buildResponseFrame(0x40, {0xAA, 0xBB}));
+    bus.replies.push_back(buildResponseFrame(0x41, {}));
+
+    InDataExchangeOptions options;
+    options.payload.push_back(0x60);
+
+    InDataExchange chained(options);
+    ASSERT_TRUE(driver.executeCommand(chained).has_value());
+    EXPECT_TRUE(chained.isSuccess());
+    EXPECT_TRUE(chained.hasMoreInformation());
+    EXPECT_EQ(chained.getStatus(), error::Pn532Error::Ok);
+    EXPECT_EQ(chained.getResponseData().size(), 2U);
+
+    // Timeout with MI set is still a timeout
+    InDataExchange failed(options);
+    auto result = driver.executeCommand(failed);
+    ASSERT_FALSE(result.has_value());
+    EXPECT_FALSE(failed.isSuccess());
+    EXPECT_EQ(failed.getStatus(), error::Pn532Error::Timeout);
+    EXPECT_EQ(result.error().get<error::Pn532Error>(), error::Pn532Error::Timeout);
+}
+
+TEST(Pn532ApduAdapterTests, CollectsMiChainedFragments)
+{
+    ScriptedPn532Bus bus;
+    Pn532Driver driver(bus);
+    Pn532ApduAdapter adapter(driver);
+    IsoWire wire;
+    adapter.setWire(wire);
+
+    // 250 data bytes + SW split over two InDataExchange rounds
+    std::vector<uint8_t> full = pattern(250);
+    full.push_back(0x91);
+    full.push_back(0x00);
+    bus.replies.push_back(buildResponseFrame(0x40, std::vector<uint8_t>(full.begin(), full.begin() + 200)));
+    bus.replies.push_back(buildResponseFrame(0x00, std::vector<uint8_t>(full.begin() + 200, full.end())));
+
+    etl::vector<uint8_t, 5> apdu = {0x90, 0xBD, 0x00, 0x00, 0x00};
+    auto result = adapter.transceive(apdu);
+    ASSERT_TRUE(result.has_value());
+    ASSERT_EQ(result.value().size(), 251U);
+    EXPECT_EQ(result.value()[0], 0x00);
+    EXPECT_EQ(std::vector<uint8_t>(result.value().begin() + 1, result.value().end()), pattern(250));
+
+    ASSERT_EQ(bus.sentFrames.size(), 2U);
+    EXPECT_EQ(bus.dataOut(0), std::vector<uint8_t>({0x90, 0xBD, 0x00, 0x00, 0x00}));
+    EXPECT_TRUE(bus.dataOut(1).empty());
+
+    // Maximum short APDU response: 256 data bytes + SW
+    std::vector<uint8_t> longest = pattern(256);
+    longest.push_back(0x91);
+    longest.push_back(0xAF);
+    bus.replies.push_back(buildResponseFrame(0x40, std::vector<uint8_t>(longest.begin(), longest.begin() + 200)));
+    bus.replies.push_back(buildResponseFrame(0x00, std::vector<uint8_t>(longest.begin() + 200, longest.end())));
+
+    result = adapter.transceive(apdu);
+    ASSERT_TRUE(result.has_value());
+    ASSERT_EQ(result.value().size(), 257U);
+    EXPECT_EQ(result.value()[0], 0xAF);
+    EXPECT_EQ(std::vector<uint8_t>(result.value().begin() + 1, result.value().end()), pattern(256));
+}
+
+TEST(Pn532ApduAdapterTests, RejectsRunawayChains)
+{
+    ScriptedPn532Bus bus;
+    Pn532Driver driver(bus);
+    Pn532ApduAdapter adapter(driver);
+    NativeWire wire;
+    adapter.setWire(wire);
+
+    bus.replies.push_back(buildResponseFrame(0x40, pattern(200)));
+    bus.replies.push_back(buildResponseFrame(0x40, pattern(200)));
+
+    etl::vector<uint8_t, 1> apdu = {0x60};
+    auto result = adapter.transceive(apdu);
+    ASSERT_FALSE(result.has_value());
+    ASSERT_TRUE(result.error().is<error::Pn532Error>());
+    EXPECT_EQ(result.error().get<error::Pn532Error>(), error::Pn532Error::BufferSizeInsufficient);
+
+    bus.replies.clear();
+    bus.replies.push_back(buildResponseFrame(0x40, {}));
+    result = adapter.transceive(apdu);
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().get<error::Pn532Error>(), error::Pn532Error::InvalidResponse);
+}
+
+TEST(Pn532ApduAdapterTests, PresenceCheckSendsNoApplicationCommand)
+{
+    ScriptedPn532Bus bus;
+    Pn532Driver driver(bus);
+    Pn532ApduAdapter adapter(driver);
+
+    // Diagnose CardPresence: status 0x00 present, anything else gone
+    bus.replies.push_back(buildFrame({0xD5, 0x01, 0x00}));
+    bus.replies.push_back(buildFrame({0xD5, 0x01, 0x01}));
+
+    EXPECT_TRUE(adapter.isCardPresent());
+    EXPECT_FALSE(adapter.isCardPresent());
+
+    ASSERT_EQ(bus.sentFrames.size(), 2U);
+    const std::vector<uint8_t>& frame = bus.sentFrames[0];
+    EXPECT_EQ(std::vector<uint8_t>(frame.begin() + 5, frame.end() - 2), std::vector<uint8_t>({0xD4, 0x00, 0x06}));
+}
+
+TEST(Pn532ApduAdapterTests, IdleDetectionPowersDownAndWakesWithNextFrame)
+{
+    ScriptedPn532Bus bus;
+    Pn532Driver driver(bus);
+    Pn532ApduAdapter adapter(driver);
+
+    bus.replies.push_back(buildFrame({0xD5, 0x33}));          // RFConfiguration MaxRetries
+    bus.replies.push_back(buildFrame({0xD5, 0x4B, 0x00}));    // no target
+    bus.replies.push_back(buildFrame({0xD5, 0x17, 0x00}));    // PowerDown
+    bus.replies.push_back(buildFrame({0xD5, 0x4B, 0x00}));
+    bus.replies.push_back(buildFrame({0xD5, 0x17, 0x00}));
+
+    PowerSavingOptions options;
+    options.enabled = true;
+    options.sleepMs = 1U;
+    ASSERT_TRUE(adapter.setPowerSaving(options).has_value());
+
+    auto body = [&bus](size_t index, size_t skip) {
+        const std::vector<uint8_t>& frame = bus.sentFrames[index];
+        return std::vector<uint8_t>(frame.begin() + skip + 5, frame.end() - 2);
+    };
+    EXPECT_EQ(body(0, 0), std::vector<uint8_t>({0xD4, 0x32, 0x05, 0xFF, 0x01, 0x02}));
+
+    auto first = adapter.detectCard();
+    ASSERT_TRUE(first.has_value());
+    EXPECT_TRUE(first.value().uid.empty());
+    EXPECT_TRUE(driver.isPoweredDown());
+    EXPECT_EQ(body(2, 0), std::vector<uint8_t>({0xD4, 0x16, 0x18}));
+
+    // The HSU wake-up preamble goes out in the same write as the next frame
+    ASSERT_TRUE(adapter.detectCard().has_value());
+    const std::vector<uint8_t>& woken = bus.sentFrames[3];
+    EXPECT_EQ(std::vector<uint8_t>(woken.begin(), woken.begin() + 2), std::vector<uint8_t>({0x55, 0x55}));
+    EXPECT_EQ(body(3, 16), std::vector<uint8_t>({0xD4, 0x4A, 0x01, 0x00}));
+    EXPECT_EQ(bus.sentFrames.size(), 5U);
+
+    EXPECT_EQ(adapter.getPowerSavingMetrics().sleeps, 2U);
+    EXPECT_EQ(adapter.getPowerSavingMetrics().earlyWakeUps, 0U);
+}
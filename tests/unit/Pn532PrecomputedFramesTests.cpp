@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "Pn532/Pn532PrecomputedFrames.h"
+#include "Pn532/Pn532RequestFrame.h"
+#include "Pn532/Commands/GetFirmwareVersion.h"
+#include "Pn532/Commands/GetGeneralStatus.h"
+#include "Pn532/Commands/SAMConfiguration.h"
+#include "Pn532/Commands/InDataExchange.h"
+#include "Nfc/Wire/IsoWire.h"
+#include "Nfc/Wire/NativeWire.h"
+
+using namespace pn532;
+
+namespace
+{
+    void expectFrameEquals(const PrecomputedFrame& fixedFrame, const etl::ivector<uint8_t>& builtFrame)
+    {
+        ASSERT_FALSE(fixedFrame.empty());
+        ASSERT_EQ(fixedFrame.length, builtFrame.size());
+        for (size_t i = 0; i < builtFrame.size(); ++i)
+        {
+            EXPECT_EQ(fixedFrame.bytes[i], builtFrame[i]) << "byte " << i;
+        }
+    }
+
+    void expectRequestMatchesRuntimeBuild(IPn532Command& command)
+    {
+        const CommandRequest request = command.buildRequest();
+        ASSERT_TRUE(request.hasPrecomputedFrame());
+
+        auto built = Pn532RequestFrame::build(request);
+        ASSERT_TRUE(built.has_value());
+        expectFrameEquals(request.precomputedFrame(), built.value());
+    }
+
+    InDataExchange makeExchange(const etl::ivector<uint8_t>& dataOut)
+    {
+        InDataExchangeOptions options;
+        options.targetNumber = 1;
+        options.payload.assign(dataOut.begin(), dataOut.end());
+        return InDataExchange(options);
+    }
+}
+
+TEST(Pn532PrecomputedFramesTests, GetFirmwareVersionMatchesKnownBytes)
+{
+    const uint8_t expected[] = {0x00, 0x00, 0xFF, 0x02, 0xFE, 0xD4, 0x02, 0x2A, 0x00};
+    ASSERT_EQ(frames::GET_FIRMWARE_VERSION.size(), sizeof(expected));
+    for (size_t i = 0; i < sizeof(expected); ++i)
+    {
+        EXPECT_EQ(frames::GET_FIRMWARE_VERSION[i], expected[i]);
+    }
+}
+
+TEST(Pn532PrecomputedFramesTests, FixedPn532CommandsMatchRuntimeBuild)
+{
+    GetFirmwareVersion firmwareVersion;
+    expectRequestMatchesRuntimeBuild(firmwareVersion);
+
+    GetGeneralStatus generalStatus;
+    expectRequestMatchesRuntimeBuild(generalStatus);
+
+    SAMConfiguration samConfiguration(SAMConfigurationOptions{});
+    expectRequestMatchesRuntimeBuild(samConfiguration);
+}
+
+TEST(Pn532PrecomputedFramesTests, NonDefaultSamConfigurationIsBuiltAtRuntime)
+{
+    SAMConfigurationOptions options;
+    options.mode = SamMode::VirtualCard;
+    options.timeout = 0x14;
+
+    SAMConfiguration command(options);
+    EXPECT_FALSE(command.buildRequest().hasPrecomputedFrame());
+}
+
+TEST(Pn532PrecomputedFramesTests, IsoWireFixedApdusMatchRuntimeWrap)
+{
+    nfc::IsoWire wire;
+    etl::vector<uint8_t, 4> pdu;
+    pdu.push_back(0x60);
+
+    const auto wrapped = wire.wrap(pdu);
+    constexpr auto fixed = nfc::IsoWire::wrapFixed<0x60>();
+    ASSERT_EQ(fixed.size(), wrapped.size());
+    for (size_t i = 0; i < wrapped.size(); ++i)
+    {
+        EXPECT_EQ(fixed[i], wrapped[i]);
+    }
+
+    pdu.push_back(0x01);
+    pdu.push_back(0x02);
+    const auto wrappedWithData = wire.wrap(pdu);
+    constexpr auto fixedWithData = nfc::IsoWire::wrapFixed<0x60, 0x01, 0x02>();
+    ASSERT_EQ(fixedWithData.size(), wrappedWithData.size());
+    for (size_t i = 0; i < wrappedWithData.size(); ++i)
+    {
+        EXPECT_EQ(fixedWithData[i], wrappedWithData[i]);
+    }
+}
+
+TEST(Pn532PrecomputedFramesTests, DesfireExchangesMatchRuntimeBuild)
+{
+    const uint8_t commands[] = {0x60, 0x6A, 0x6E, 0x6F, 0xAF};
+    nfc::IsoWire isoWire;
+    nfc::NativeWire nativeWire;
+
+    for (const uint8_t ins : commands)
+    {
+        etl::vector<uint8_t, 1> pdu;
+        pdu.push_back(ins);
+
+        InDataExchange isoExchange = makeExchange(isoWire.wrap(pdu));
+        expectRequestMatchesRuntimeBuild(isoExchange);
+
+        InDataExchange nativeExchange = makeExchange(nativeWire.wrap(pdu));
+        expectRequestMatchesRuntimeBuild(nativeExchange);
+    }
+}
+
+TEST(Pn532PrecomputedFramesTests, ExchangesWithDataAreBuiltAtRuntime)
+{
+    etl::vector<uint8_t, 8> dataOut;
+    dataOut.push_back(0xBD);
+    dataOut.push_back(0x01);
+
+    InDataExchange exchange = makeExchange(dataOut);
+    EXPECT_FALSE(exchange.buildRequest().hasPrecomputedFrame());
+}
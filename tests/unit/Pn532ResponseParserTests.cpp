@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "Pn532/Pn532Driver.h"
+#include "Pn532/Commands/InListPassiveTarget.h"
+#include "Nfc/BufferSizes.h"
+
+using namespace pn532;
+
+namespace
+{
+    using Frame = etl::vector<uint8_t, nfc::buffer::PN532_FRAME_MAX>;
+
+    std::vector<uint8_t> buildFrame(const std::vector<uint8_t>& body)
+    {
+        std::vector<uint8_t> frame = {0x00, 0x00, 0xFF};
+        frame.push_back(static_cast<uint8_t>(body.size()));
+        frame.push_back(static_cast<uint8_t>(0x100U - body.size()));
+        uint8_t sum = 0U;
+        for (uint8_t b : body)
+        {
+            frame.push_back(b);
+            sum = static_cast<uint8_t>(sum + b);
+        }
+        frame.push_back(static_cast<uint8_t>(0x100U - sum));
+        frame.push_back(0x00);
+        return frame;
+    }
+
+    Frame toFrame(const std::vector<uint8_t>& bytes)
+    {
+        return Frame(bytes.begin(), bytes.end());
+    }
+}
+
+// Test: Noise, an ACK and false start codes before the frame are skipped
+TEST(Pn532ResponseParserTests, SkipsGarbageBeforeFrame)
+{
+    std::vector<uint8_t> bytes = {0x17, 0x00, 0x00, 0xFF, 0x09, 0x09, 0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00};
+    bytes.insert(bytes.end(), 200U, 0x5A);
+    const std::vector<uint8_t> frame = buildFrame({0xD5, 0x03, 0x32, 0x01, 0x06, 0x07});
+    bytes.insert(bytes.end(), frame.begin(), frame.end());
+
+    auto parsed = Pn532Driver::parseResponseFrame(toFrame(bytes), 0x02);
+    ASSERT_TRUE(parsed.has_value());
+    EXPECT_EQ(parsed.value().getCommandCode(), 0x03);
+    EXPECT_EQ(parsed.value().size(), 4U);
+}
+
+// Test: A length too short for TFI and command code is not a frame
+TEST(Pn532ResponseParserTests, RejectsLengthBelowTwo)
+{
+    const std::vector<uint8_t> bytes = {0x00, 0x00, 0xFF, 0x01, 0xFF, 0xD5, 0x2B, 0x00};
+    EXPECT_FALSE(Pn532Driver::parseResponseFrame(toFrame(bytes), 0x02).has_value());
+}
+
+// Test: A UID longer than any card has fails the response instead of overrunning
+TEST(Pn532ResponseParserTests, RejectsOversizedUid)
+{
+    std::vector<uint8_t> body = {0xD5, 0x4B, 0x01, 0x01, 0x44, 0x00, 0x20, 0x20};
+    body.insert(body.end(), 0x20U, 0x04);
+    auto parsed = Pn532Driver::parseResponseFrame(toFrame(buildFrame(body)), 0x4A);
+    ASSERT_TRUE(parsed.has_value());
+
+    InListPassiveTarget command(InListPassiveTargetOptions{});
+    EXPECT_FALSE(command.parseResponse(parsed.value()).has_value());
+
+    body[2] = 0x03;     // three targets; the PN532 lists at most two
+    parsed = Pn532Driver::parseResponseFrame(toFrame(buildFrame(body)), 0x4A);
+    ASSERT_TRUE(parsed.has_value());
+    EXPECT_FALSE(command.parseResponse(parsed.value()).has_value());
+}
@@ -0,0 +1,288 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <cstring>
+#include <map>
+#include <vector>
+#include <aes.hpp>
+#include "Nfc/Card/RetryPolicy.h"
+#include "Nfc/Desfire/DesfireCard.h"
+#include "Nfc/Desfire/DesfireKeyStore.h"
+#include "Nfc/Desfire/Commands/CreditCommand.h"
+#include "Nfc/Apdu/IApduTransceiver.h"
+#include "Nfc/Wire/NativeWire.h"
+#include "Pn532/Pn532Driver.h"
+#include "Error/DesfireError.h"
+#include "Error/Pn532Error.h"
+#include "Support/ScriptedPn532Bus.h"
+
+using namespace nfc;
+using test_support::ScriptedPn532Bus;
+
+namespace
+{
+    const std::array<uint8_t, 16> AES_KEY = {
+        0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+        0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
+
+    /**
+     * Card with one AES key that answers SelectApplication, AES
+     * authentication, GetVersion and GetKeyVersion. Errors in failAt are
+     * returned instead of the answer to that exchange (index into sent), as
+     * a failed RF exchange would be.
+     */
+    class FlakyAesCard : public IApduTransceiver
+    {
+    public:
+        void setWire(IWire&) override
+        {
+        }
+
+        etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> transceive(
+            const etl::ivector<uint8_t>& apdu) override
+        {
+            sent.emplace_back(apdu.begin(), apdu.end());
+            auto failure = failAt.find(sent.size() - 1U);
+            if (failure != failAt.end())
+            {
+                return etl::unexpected(failure->second);
+            }
+
+            std::vector<uint8_t> reply;
+            switch (apdu[0])
+            {
+                case 0x5A:
+                    reply = {0x00};
+                    break;
+                case 0x64:
+                    reply = {0x00, 0x07};
+                    break;
+                case 0x60:
+                    versionFrames = 1U;
+                    reply = {0xAF, 0x04, 0x01, 0x01, 0x01, 0x00, 0x18, 0x05};
+                    break;
+                case 0xAA:
+                    reply = beginAuthentication();
+                    break;
+                case 0xAF:
+                    reply = (apdu.size() == 33U) ? finishAuthentication(apdu) : versionFrame();
+                    break;
+                default:
+                    reply = {0x1C};
+                    break;
+            }
+
+            etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX> response;
+            response.assign(reply.begin(), reply.end());
+            return response;
+        }
+
+        std::map<size_t, error::Error> failAt;
+        std::vector<std::vector<uint8_t>> sent;
+
+    private:
+        std::vector<uint8_t> beginAuthentication()
+        {
+            for (size_t i = 0; i < 16; ++i)
+            {
+                rndB[i] = static_cast<uint8_t>(0xB0 + i);
+            }
+            std::memcpy(lastCipher.data(), rndB.data(), 16);
+            uint8_t iv[16] = {0};
+            AES_ctx ctx;
+            AES_init_ctx_iv(&ctx, AES_KEY.data(), iv);
+            AES_CBC_encrypt_buffer(&ctx, lastCipher.data(), 16);
+
+            std::vector<uint8_t> reply = {0xAF};
+            reply.insert(reply.end(), lastCipher.begin(), lastCipher.end());
+            return reply;
+        }
+
+        std::vector<uint8_t> finishAuthentication(const etl::ivector<uint8_t>& apdu)
+        {
+            uint8_t plain[32];
+            std::memcpy(plain, apdu.data() + 1, 32);
+            AES_ctx ctx;
+            AES_init_ctx_iv(&ctx, AES_KEY.data(), lastCipher.data());
+            AES_CBC_decrypt_buffer(&ctx, plain, 32);
+
+            std::array<uint8_t, 16> rndArot = {};
+            for (size_t i = 0; i < 16; ++i)
+            {
+                rndArot[i] = plain[(i + 1) % 16];
+            }
+            AES_init_ctx_iv(&ctx, AES_KEY.data(), apdu.data() + 17);
+            AES_CBC_encrypt_buffer(&ctx, rndArot.data(), 16);
+
+            std::vector<uint8_t> reply = {0x00};
+            reply.insert(reply.end(), rndArot.begin(), rndArot.end());
+            return reply;
+        }
+
+        std::vector<uint8_t> versionFrame()
+        {
+            if (versionFrames++ == 1U)
+            {
+                return {0xAF, 0x04, 0x01, 0x01, 0x01, 0x00, 0x18, 0x05};
+            }
+            return {0x00, 0x04, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x26, 0x21};
+        }
+
+        std::array<uint8_t, 16> rndB = {};
+        std::array<uint8_t, 16> lastCipher = {};
+        size_t versionFrames = 0U;
+    };
+
+    // ACK followed by the RFConfiguration response frame D5 33
+    const std::vector<uint8_t> RF_CONFIGURATION_ANSWER = {
+        0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00,
+        0x00, 0x00, 0xFF, 0x02, 0xFE, 0xD5, 0x33, 0xF8, 0x00};
+
+    error::Error rfTimeout()
+    {
+        return error::Error::fromPn532(error::Pn532Error::Timeout);
+    }
+}
+
+TEST(RetryPolicyTests, ClassifiesByLayer)
+{
+    EXPECT_EQ(RetryPolicy::classifyCardError(rfTimeout(), false), RetryAction::RestartCommand);
+    EXPECT_EQ(RetryPolicy::classifyCardError(error::Error::fromPn532(error::Pn532Error::CRCError), true),
+              RetryAction::RecoverSession);
+    EXPECT_EQ(RetryPolicy::classifyCardError(error::Error::fromLink(error::LinkError::CrcError), false),
+              RetryAction::RestartCommand);
+    EXPECT_EQ(RetryPolicy::classifyCardError(error::Error::fromDesfire(error::DesfireError::IntegrityError), true),
+              RetryAction::RecoverSession);
+
+    EXPECT_EQ(RetryPolicy::classifyCardError(error::Error::fromPn532(error::Pn532Error::CardDisappeared), false),
+              RetryAction::Fail);
+    EXPECT_EQ(RetryPolicy::classifyCardError(error::Error::fromDesfire(error::DesfireError::PermissionDenied), true),
+              RetryAction::Fail);
+    EXPECT_EQ(RetryPolicy::classifyCardError(error::Error::fromLink(error::LinkError::CardDisappeared), false),
+              RetryAction::Fail);
+
+    RetryLimits limits;
+    limits.commandRestarts = 2U;
+    RetryPolicy policy(limits);
+    EXPECT_TRUE(policy.allows(RetryAction::RestartCommand, 1U));
+    EXPECT_FALSE(policy.allows(RetryAction::RestartCommand, 2U));
+    EXPECT_FALSE(policy.allows(RetryAction::Fail, 0U));
+}
+
+TEST(RetryPolicyTests, RestartsReadOnlyCommandOutsideSession)
+{
+    FlakyAesCard transceiver;
+    NativeWire wire;
+    DesfireCard card(transceiver, wire);
+    RetryPolicy policy;
+    card.setRetryPolicy(&policy);
+
+    // Second frame of GetVersion is lost; the whole command runs again
+    transceiver.failAt.emplace(1U, rfTimeout());
+    auto version = card.getVersion();
+    ASSERT_TRUE(version.has_value());
+    EXPECT_EQ(version.value().size(), 30U);
+    ASSERT_EQ(transceiver.sent.size(), 5U);
+    EXPECT_EQ(transceiver.sent[2], std::vector<uint8_t>({0x60}));
+    EXPECT_EQ(policy.metrics().commandRestarts, 1U);
+    EXPECT_EQ(policy.metrics().recovered, 1U);
+    EXPECT_EQ(policy.metrics().sessionRecoveries, 0U);
+}
+
+TEST(RetryPolicyTests, RecoversKeyStoreSession)
+{
+    FlakyAesCard transceiver;
+    NativeWire wire;
+    DesfireCard card(transceiver, wire);
+    RetryPolicy policy;
+    card.setRetryPolicy(&policy);
+
+    DesfireKeyStore store;
+    etl::vector<uint8_t, 24> key(AES_KEY.begin(), AES_KEY.end());
+    auto handle = store.registerKey(DesfireKeyType::AES, key);
+    ASSERT_TRUE(handle.has_value());
+
+    ASSERT_TRUE(card.selectApplication({0x01, 0x02, 0x03}).has_value());
+    ASSERT_TRUE(card.authenticate(0x00, store, handle.value(), DesfireAuthMode::AES).has_value());
+    transceiver.sent.clear();
+
+    transceiver.failAt.emplace(0U, error::Error::fromPn532(error::Pn532Error::CRCError));
+    auto keyVersion = card.getKeyVersion(0x01);
+    ASSERT_TRUE(keyVersion.has_value());
+    EXPECT_EQ(keyVersion.value(), 0x07);
+
+    // Failed GetKeyVersion, re-select, two-pass AES authentication, GetKeyVersion
+    ASSERT_EQ(transceiver.sent.size(), 5U);
+    EXPECT_EQ(transceiver.sent[0], std::vector<uint8_t>({0x64, 0x01}));
+    EXPECT_EQ(transceiver.sent[1], std::vector<uint8_t>({0x5A, 0x01, 0x02, 0x03}));
+    EXPECT_EQ(transceiver.sent[2], std::vector<uint8_t>({0xAA, 0x00}));
+    EXPECT_EQ(transceiver.sent[4], std::vector<uint8_t>({0x64, 0x01}));
+    EXPECT_TRUE(card.getContext().authenticated);
+    EXPECT_EQ(policy.metrics().sessionRecoveries, 1U);
+    EXPECT_EQ(policy.metrics().recovered, 1U);
+}
+
+TEST(RetryPolicyTests, NeverRepeatsCommandsWithSideEffects)
+{
+    FlakyAesCard transceiver;
+    NativeWire wire;
+    DesfireCard card(transceiver, wire);
+    RetryPolicy policy;
+    card.setRetryPolicy(&policy);
+
+    CreditCommandOptions options;
+    options.fileNo = 0x01;
+    options.value = 10;
+    options.communicationSettings = 0x00;
+    CreditCommand credit(options);
+
+    transceiver.failAt.emplace(0U, rfTimeout());
+    auto result = card.executeCommand(credit);
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(transceiver.sent.size(), 1U);
+    EXPECT_EQ(policy.metrics().commandRestarts, 0U);
+
+    // A raw-key session cannot be rebuilt, so the retry budget is not spent
+    etl::vector<uint8_t, 24> key(AES_KEY.begin(), AES_KEY.end());
+    ASSERT_TRUE(card.authenticate(0x00, key, DesfireAuthMode::AES).has_value());
+    transceiver.failAt.emplace(transceiver.sent.size(), rfTimeout());
+    EXPECT_FALSE(card.getKeyVersion(0x01).has_value());
+    EXPECT_EQ(policy.metrics().sessionRecoveries, 0U);
+    EXPECT_EQ(policy.metrics().exhausted, 1U);
+}
+
+TEST(RetryPolicyTests, ResendsFrameOnlyWhenNothingCameBack)
+{
+    ScriptedPn532Bus bus;
+    bus.ackFrames = false;
+    pn532::Pn532Driver driver(bus);
+    RetryPolicy policy;
+    driver.setRetryPolicy(&policy);
+
+    // First frame lost on the host link: not a single byte comes back
+    bus.replies = {{}, RF_CONFIGURATION_ANSWER};
+    ASSERT_TRUE(driver.setRfField(true).has_value());
+    EXPECT_EQ(bus.sentFrames.size(), 2U);
+    EXPECT_EQ(policy.metrics().frameResends, 1U);
+    EXPECT_EQ(policy.metrics().recovered, 1U);
+}
+
+TEST(RetryPolicyTests, NeverResendsFrameAfterCorruptAck)
+{
+    ScriptedPn532Bus bus;
+    bus.ackFrames = false;
+    pn532::Pn532Driver driver(bus);
+    RetryPolicy policy;
+    driver.setRetryPolicy(&policy);
+
+    // The PN532 answered, so it may be running the command already
+    bus.replies = {{0x00, 0x00, 0xFF, 0x00, 0x7F, 0x00}, RF_CONFIGURATION_ANSWER};
+    EXPECT_FALSE(driver.setRfField(true).has_value());
+    EXPECT_EQ(bus.sentFrames.size(), 1U);
+
+    // Same for an ACK cut short
+    bus.sentFrames.clear();
+    bus.replies = {{0x00, 0x00, 0xFF}, RF_CONFIGURATION_ANSWER};
+    EXPECT_FALSE(driver.setRfField(true).has_value());
+    EXPECT_EQ(bus.sentFrames.size(), 1U);
+    EXPECT_EQ(policy.metrics().frameResends, 0U);
+}
@@ -0,0 +1,281 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Nfc/Desfire/SdmVerifier.h"
+#include "Nfc/Desfire/DesfireCryptoBatch.h"
+
+using namespace nfc;
+
+namespace
+{
+    const std::array<uint8_t, 16> ZERO_KEY = {0};
+
+    const std::array<uint8_t, 16> MASTER_KEY = {
+        0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+        0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
+
+    // NXP AN12196: SUN message with SDMMACInputOffset == SDMMACOffset
+    const char* PLAIN_URL =
+        "https://choose.url.com/ntag424?picc_data=EF963FF7828658A599F3041510671E88&cmac=94EED9EE65337086";
+
+    // NXP AN12196: SUN message with SDMENCFileData, MAC input starts at the enc value
+    const char* ENC_URL =
+        "https://www.my424dna.com/?picc_data=FD91EC264309878BE6345CBE53BADF40"
+        "&enc=CEE9A53E3E463EF1F459635736738962&cmac=ECC1E7F6C6C73BF6";
+
+    SdmVerifierOptions zeroKeyOptions()
+    {
+        SdmVerifierOptions options;
+        options.metaReadKey = ZERO_KEY.data();
+        options.fileReadKey = ZERO_KEY.data();
+        return options;
+    }
+
+    std::string toHex(const uint8_t* data, size_t length)
+    {
+        std::string text;
+        char digits[3];
+        for (size_t i = 0; i < length; ++i)
+        {
+            std::snprintf(digits, sizeof(digits), "%02X", data[i]);
+            text += digits;
+        }
+        return text;
+    }
+
+    void cmac(const uint8_t* key, uint8_t* data, size_t length, uint8_t* out)
+    {
+        uint8_t iv[16] = {0};
+        DesfireCryptoJob job;
+        job.kind = DesfireCryptoJobKind::AesCmac;
+        job.key = key;
+        job.keyLength = 16U;
+        job.iv = iv;
+        job.data = data;
+        job.length = length;
+        job.mac = out;
+
+        DesfireCryptoBatch batch;
+        ASSERT_TRUE(batch.submit(job).has_value());
+        batch.process();
+    }
+
+    /**
+     * Produces a SUN URL the way a card with the given file read key would
+     * (PICCData encrypted with the zero meta read key, no MAC input).
+     */
+    std::string makeTapUrl(const uint8_t* fileReadKey, const std::array<uint8_t, 7>& uid, uint32_t counter)
+    {
+        uint8_t picc[16] = {0xC7};
+        std::copy(uid.begin(), uid.end(), picc + 1);
+        picc[8] = static_cast<uint8_t>(counter);
+        picc[9] = static_cast<uint8_t>(counter >> 8U);
+        picc[10] = static_cast<uint8_t>(counter >> 16U);
+
+        uint8_t iv[16] = {0};
+        DesfireCryptoJob job;
+        job.kind = DesfireCryptoJobKind::AesCbcEncrypt;
+        job.key = ZERO_KEY.data();
+        job.keyLength = 16U;
+        job.iv = iv;
+        job.data = picc;
+        job.length = 16U;
+        DesfireCryptoBatch batch;
+        EXPECT_TRUE(batch.submit(job).has_value());
+        batch.process();
+
+        uint8_t sv2[16] = {0x3C, 0xC3, 0x00, 0x01, 0x00, 0x80};
+        std::copy(uid.begin(), uid.end(), sv2 + 6);
+        sv2[13] = static_cast<uint8_t>(counter);
+        sv2[14] = static_cast<uint8_t>(counter >> 8U);
+        sv2[15] = static_cast<uint8_t>(counter >> 16U);
+
+        uint8_t sessionKey[16];
+        uint8_t fullMac[16];
+        cmac(fileReadKey, sv2, sizeof(sv2), sessionKey);
+        cmac(sessionKey, nullptr, 0U, fullMac);
+
+        uint8_t mac[8];
+        for (size_t i = 0; i < 8U; ++i)
+        {
+            mac[i] = fullMac[(2U * i) + 1U];
+        }
+
+        return "https://example.com/t?picc_data=" + toHex(picc, 16) + "&cmac=" + toHex(mac, 8);
+    }
+}
+
+TEST(SdmVerifierTests, VerifiesAn12196PlainMessage)
+{
+    SdmVerifier verifier(zeroKeyOptions());
+    SdmTap tap;
+    tap.url = PLAIN_URL;
+
+    auto result = verifier.verify(tap);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_TRUE(result.value());
+    EXPECT_EQ(tap.status, SdmVerifyStatus::Valid);
+    EXPECT_EQ(tap.readCounter, 61U);
+
+    const uint8_t expectedUid[7] = {0x04, 0xDE, 0x5F, 0x1E, 0xAC, 0xC0, 0x40};
+    EXPECT_EQ(0, std::memcmp(tap.uid, expectedUid, sizeof(expectedUid)));
+    EXPECT_EQ(tap.fileDataLength, 0U);
+}
+
+TEST(SdmVerifierTests, DecryptsFileDataAfterMacCheck)
+{
+    SdmVerifierOptions options = zeroKeyOptions();
+    options.macInputParameter = "enc";
+    SdmVerifier verifier(options);
+    SdmTap tap;
+    tap.url = ENC_URL;
+
+    auto result = verifier.verify(tap);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_TRUE(result.value());
+    EXPECT_EQ(tap.readCounter, 8U);
+    ASSERT_EQ(tap.fileDataLength, 16U);
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(tap.fileData), 16U), "xxxxxxxxxxxxxxxx");
+
+    // Without the MAC input configured the card's MAC cannot match
+    SdmVerifier wrongInput(zeroKeyOptions());
+    SdmTap second;
+    second.url = ENC_URL;
+    EXPECT_FALSE(wrongInput.verify(second).value());
+    EXPECT_EQ(second.status, SdmVerifyStatus::MacMismatch);
+    EXPECT_EQ(second.fileDataLength, 0U);
+}
+
+TEST(SdmVerifierTests, RejectsTamperedAndMalformedUrls)
+{
+    SdmVerifier verifier(zeroKeyOptions());
+
+    const std::string tamperedMac =
+        "https://choose.url.com/ntag424?picc_data=EF963FF7828658A599F3041510671E88&cmac=94EED9EE65337087";
+    const std::string tamperedPicc =
+        "https://choose.url.com/ntag424?picc_data=EF963FF7828658A599F3041510671E89&cmac=94EED9EE65337086";
+    const std::string badHex =
+        "https://choose.url.com/ntag424?picc_data=EF963FF7828658A599F3041510671EXX&cmac=94EED9EE65337086";
+    const std::string missingMac =
+        "https://choose.url.com/ntag424?picc_data=EF963FF7828658A599F3041510671E88";
+    const std::string shortMac =
+        "https://choose.url.com/ntag424?picc_data=EF963FF7828658A599F3041510671E88&cmac=94EED9";
+
+    std::array<SdmTap, 5> taps;
+    taps[0].url = tamperedMac.c_str();
+    taps[1].url = tamperedPicc.c_str();
+    taps[2].url = badHex.c_str();
+    taps[3].url = missingMac.c_str();
+    taps[4].url = shortMac.c_str();
+
+    auto result = verifier.verifyBatch(taps.data(), taps.size());
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value(), 0U);
+    EXPECT_EQ(taps[0].status, SdmVerifyStatus::MacMismatch);
+    // A changed ciphertext decrypts to garbage: bad tag or wrong MAC
+    EXPECT_NE(taps[1].status, SdmVerifyStatus::Valid);
+    EXPECT_EQ(taps[2].status, SdmVerifyStatus::Malformed);
+    EXPECT_EQ(taps[3].status, SdmVerifyStatus::Malformed);
+    EXPECT_EQ(taps[4].status, SdmVerifyStatus::Malformed);
+    EXPECT_EQ(verifier.metrics().taps, 5U);
+    EXPECT_EQ(verifier.metrics().malformed + verifier.metrics().macMismatches, 5U);
+
+    SdmVerifier unconfigured{SdmVerifierOptions()};
+    SdmTap tap;
+    tap.url = PLAIN_URL;
+    EXPECT_FALSE(unconfigured.verify(tap).has_value());
+}
+
+TEST(SdmVerifierTests, RejectsReplayedCounter)
+{
+    SdmVerifier verifier(zeroKeyOptions());
+    const std::array<uint8_t, 7> uid = {0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+    const std::string first = makeTapUrl(ZERO_KEY.data(), uid, 10U);
+    const std::string older = makeTapUrl(ZERO_KEY.data(), uid, 9U);
+    const std::string newer = makeTapUrl(ZERO_KEY.data(), uid, 11U);
+
+    std::array<SdmTap, 4> taps;
+    taps[0].url = first.c_str();
+    taps[1].url = first.c_str();
+    taps[2].url = older.c_str();
+    taps[3].url = newer.c_str();
+
+    auto result = verifier.verifyBatch(taps.data(), taps.size());
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value(), 2U);
+    EXPECT_EQ(taps[0].status, SdmVerifyStatus::Valid);
+    EXPECT_EQ(taps[1].status, SdmVerifyStatus::Replayed);
+    EXPECT_EQ(taps[2].status, SdmVerifyStatus::Replayed);
+    EXPECT_EQ(taps[3].status, SdmVerifyStatus::Valid);
+    EXPECT_EQ(verifier.metrics().replayed, 2U);
+
+    SdmVerifierOptions options = zeroKeyOptions();
+    options.rejectReplay = false;
+    SdmVerifier lenient(options);
+    SdmTap again;
+    again.url = first.c_str();
+    EXPECT_TRUE(lenient.verify(again).value());
+    EXPECT_TRUE(lenient.verify(again).value());
+}
+
+TEST(SdmVerifierTests, DiversifiesKeysPerUidWithCache)
+{
+    // NXP AN10922 AES-128 example: UID || AID || system identifier
+    const uint8_t input[] = {
+        0x04, 0x78, 0x2E, 0x21, 0x80, 0x1D, 0x80, 0x30, 0x42, 0xF5,
+        0x4E, 0x58, 0x50, 0x20, 0x41, 0x62, 0x75};
+    const uint8_t expected[16] = {
+        0xA8, 0xDD, 0x63, 0xA3, 0xB8, 0x9D, 0x54, 0xB3,
+        0x7C, 0xA8, 0x02, 0x47, 0x3F, 0xDA, 0x91, 0x75};
+    uint8_t key[16];
+    ASSERT_TRUE(SdmVerifier::diversifyKey(MASTER_KEY.data(), input, sizeof(input), key));
+    EXPECT_EQ(0, std::memcmp(key, expected, sizeof(expected)));
+    EXPECT_FALSE(SdmVerifier::diversifyKey(MASTER_KEY.data(), input, 0U, key));
+
+    const uint8_t suffix[] = {0x30, 0x42, 0xF5};
+    SdmVerifierOptions options = zeroKeyOptions();
+    options.fileReadKey = MASTER_KEY.data();
+    options.diversifyFileReadKey = true;
+    options.diversificationSuffix = suffix;
+    options.diversificationSuffixLength = sizeof(suffix);
+    SdmVerifier verifier(options);
+
+    std::vector<std::string> urls;
+    for (uint8_t card = 0; card < 20U; ++card)
+    {
+        const std::array<uint8_t, 7> uid = {0x04, 0xA0, card, 0x10, 0x20, 0x30, 0x80};
+        uint8_t diversificationInput[10];
+        std::copy(uid.begin(), uid.end(), diversificationInput);
+        std::copy(suffix, suffix + 3, diversificationInput + 7);
+        uint8_t cardKey[16];
+        ASSERT_TRUE(SdmVerifier::diversifyKey(MASTER_KEY.data(), diversificationInput, 10U, cardKey));
+
+        urls.push_back(makeTapUrl(cardKey, uid, 1U));
+        urls.push_back(makeTapUrl(cardKey, uid, 2U));
+    }
+    // A card keyed with the master key itself is rejected
+    urls.push_back(makeTapUrl(MASTER_KEY.data(), {0x04, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, 1U));
+
+    std::vector<SdmTap> taps(urls.size());
+    for (size_t i = 0; i < urls.size(); ++i)
+    {
+        taps[i].url = urls[i].c_str();
+    }
+
+    auto result = verifier.verifyBatch(taps.data(), taps.size());
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value(), 40U);
+    EXPECT_EQ(taps.back().status, SdmVerifyStatus::MacMismatch);
+    EXPECT_EQ(verifier.metrics().keyCacheMisses, 21U);
+    EXPECT_EQ(verifier.metrics().keyCacheHits, 20U);
+
+    verifier.clearCache();
+    SdmTap retry;
+    retry.url = urls[1].c_str();
+    EXPECT_TRUE(verifier.verify(retry).value());
+    EXPECT_EQ(verifier.metrics().keyCacheMisses, 22U);
+}
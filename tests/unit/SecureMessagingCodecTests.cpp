@@ -0,0 +1,420 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+#include "Nfc/Desfire/SecureMessagingCodec.h"
+#include "Nfc/Desfire/SecureMessagingPolicy.h"
+#include "Nfc/Desfire/DesfireCryptoBatch.h"
+#include "Nfc/Desfire/DesfireCard.h"
+#include "Nfc/Desfire/DesfireRequest.h"
+#include "Nfc/Apdu/IApduTransceiver.h"
+#include "Nfc/Wire/NativeWire.h"
+#include "Nfc/Wire/IsoWire.h"
+
+using namespace nfc;
+
+namespace
+{
+    const uint8_t SESSION_KEY[16] = {
+        0x4C, 0x31, 0x9A, 0x07, 0xE2, 0x55, 0x1B, 0xC8,
+        0x60, 0xDD, 0x3F, 0x92, 0x14, 0x7A, 0xB6, 0x2E};
+
+    DesfireContext aesSession()
+    {
+        DesfireContext state;
+        state.authenticated = true;
+        state.authScheme = SessionAuthScheme::Aes;
+        state.sessionKeyEnc.assign(SESSION_KEY, SESSION_KEY + 16);
+        state.sessionKeyMac.assign(SESSION_KEY, SESSION_KEY + 16);
+        state.iv.resize(16U, 0x00U);
+        state.keyNo = 1U;
+        state.selectedAid.push_back(0x01);
+        state.selectedAid.push_back(0x02);
+        state.selectedAid.push_back(0x03);
+        return state;
+    }
+
+    void runJob(DesfireCryptoJobKind kind, uint8_t* iv, uint8_t* data, size_t length, uint8_t* mac = nullptr)
+    {
+        DesfireCryptoJob job;
+        job.kind = kind;
+        job.key = SESSION_KEY;
+        job.keyLength = 16U;
+        job.iv = iv;
+        job.data = data;
+        job.length = length;
+        job.mac = mac;
+
+        DesfireCryptoBatch batch;
+        ASSERT_TRUE(batch.submit(job).has_value());
+        batch.process();
+    }
+
+    uint32_t crc32(const std::vector<uint8_t>& data)
+    {
+        etl::vector<uint8_t, 256> input(data.begin(), data.end());
+        return SecureMessagingPolicy::calculateCrc32Desfire(input);
+    }
+
+    /**
+     * Card side of an EV1 AES session, written against the raw AES/CMAC
+     * primitives rather than the codec.
+     */
+    class AesCardEmulator
+    {
+    public:
+        AesCardEmulator()
+            : iv(16U, 0x00U)
+        {
+        }
+
+        // Plain command: the card only advances its IV with the CMAC
+        void receivePlain(const std::vector<uint8_t>& pdu)
+        {
+            std::vector<uint8_t> message = pdu;
+            uint8_t mac[16];
+            runJob(DesfireCryptoJobKind::AesCmac, iv.data(), message.data(), message.size(), mac);
+        }
+
+        bool receiveMaced(const std::vector<uint8_t>& pdu)
+        {
+            std::vector<uint8_t> message(pdu.begin(), pdu.end() - 8);
+            uint8_t mac[16];
+            runJob(DesfireCryptoJobKind::AesCmac, iv.data(), message.data(), message.size(), mac);
+            return std::equal(pdu.end() - 8, pdu.end(), mac);
+        }
+
+        bool receiveEnciphered(const std::vector<uint8_t>& pdu, size_t headerLength, std::vector<uint8_t>& data)
+        {
+            std::vector<uint8_t> plain(pdu.begin() + 1 + headerLength, pdu.end());
+            runJob(DesfireCryptoJobKind::AesCbcDecrypt, iv.data(), plain.data(), plain.size());
+
+            // Shortest candidate first: CRC32 without final XOR leaves a zero
+            // register after the CRC, so longer candidates match on zero padding
+            for (size_t length = (plain.size() > 19U) ? plain.size() - 19U : 0U; length + 4U <= plain.size(); ++length)
+            {
+                std::vector<uint8_t> crcInput(pdu.begin(), pdu.begin() + 1 + headerLength);
+                crcInput.insert(crcInput.end(), plain.begin(), plain.begin() + length);
+                const uint32_t crc = crc32(crcInput);
+                if (plain[length] == static_cast<uint8_t>(crc) && plain[length + 1] == static_cast<uint8_t>(crc >> 8) &&
+                    plain[length + 2] == static_cast<uint8_t>(crc >> 16) && plain[length + 3] == static_cast<uint8_t>(crc >> 24))
+                {
+                    data.assign(plain.begin(), plain.begin() + length);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::vector<uint8_t> respondMaced(const std::vector<uint8_t>& data)
+        {
+            std::vector<uint8_t> message = data;
+            message.push_back(0x00);
+            uint8_t mac[16];
+            runJob(DesfireCryptoJobKind::AesCmac, iv.data(), message.data(), message.size(), mac);
+
+            std::vector<uint8_t> response = {0x00};
+            response.insert(response.end(), data.begin(), data.end());
+            response.insert(response.end(), mac, mac + 8);
+            return response;
+        }
+
+        std::vector<uint8_t> respondEnciphered(const std::vector<uint8_t>& data)
+        {
+            std::vector<uint8_t> crcInput = data;
+            crcInput.push_back(0x00);
+            const uint32_t crc = crc32(crcInput);
+
+            std::vector<uint8_t> plain = data;
+            for (size_t i = 0; i < 4U; ++i)
+            {
+                plain.push_back(static_cast<uint8_t>(crc >> (8U * i)));
+            }
+            plain.resize(((plain.size() + 15U) / 16U) * 16U, 0x00);
+            runJob(DesfireCryptoJobKind::AesCbcEncrypt, iv.data(), plain.data(), plain.size());
+
+            std::vector<uint8_t> response = {0x00};
+            response.insert(response.end(), plain.begin(), plain.end());
+            return response;
+        }
+
+        std::vector<uint8_t> iv;
+    };
+
+    std::vector<uint8_t> toStd(const etl::ivector<uint8_t>& data)
+    {
+        return std::vector<uint8_t>(data.begin(), data.end());
+    }
+
+    etl::vector<uint8_t, 258> toEtl(const std::vector<uint8_t>& data)
+    {
+        return etl::vector<uint8_t, 258>(data.begin(), data.end());
+    }
+
+    class NoTransceiver : public IApduTransceiver
+    {
+    public:
+        void setWire(IWire&) override
+        {
+        }
+
+        etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> transceive(
+            const etl::ivector<uint8_t>&) override
+        {
+            return etl::unexpected(error::Error::fromDesfire(error::DesfireError::InvalidState));
+        }
+    };
+
+    // Hands the state to another worker the way a relay service would
+    DesfireContext moveBetweenWorkers(const DesfireContext& state)
+    {
+        auto image = SecureMessagingCodec::serializeState(state);
+        auto restored = SecureMessagingCodec::deserializeState(image);
+        EXPECT_TRUE(restored.has_value());
+        return restored.value();
+    }
+}
+
+TEST(SecureMessagingCodecTests, RelaysAesSessionThroughAllCommModes)
+{
+    NativeWire wire;
+    AesCardEmulator card;
+    DesfireContext state = aesSession();
+
+    // GetValue: plain request, MACed response
+    SecureCommand getValue;
+    getValue.commandCode = 0x6C;
+    getValue.header.push_back(0x02);
+    auto wrapped = SecureMessagingCodec::wrapCommand(state, getValue, wire);
+    ASSERT_TRUE(wrapped.has_value());
+    EXPECT_EQ(toStd(wrapped.value().apdu), (std::vector<uint8_t>{0x6C, 0x02}));
+    card.receivePlain(toStd(wrapped.value().apdu));
+    EXPECT_EQ(toStd(wrapped.value().state.iv), card.iv);
+
+    state = moveBetweenWorkers(wrapped.value().state);
+    auto response = SecureMessagingCodec::unwrapResponse(
+        state, wrapped.value().expectation, toEtl(card.respondMaced({0xE8, 0x03, 0x00, 0x00})), wire);
+    ASSERT_TRUE(response.has_value());
+    EXPECT_TRUE(response.value().isSuccess());
+    EXPECT_EQ(toStd(response.value().data), (std::vector<uint8_t>{0xE8, 0x03, 0x00, 0x00}));
+    EXPECT_EQ(toStd(response.value().state.iv), card.iv);
+    state = moveBetweenWorkers(response.value().state);
+
+    // Credit: MACed request
+    SecureCommand credit;
+    credit.commandCode = 0x0C;
+    credit.header.push_back(0x02);
+    credit.data.assign({0x10, 0x00, 0x00, 0x00});
+    credit.commMode = CommMode::MACed;
+    wrapped = SecureMessagingCodec::wrapCommand(state, credit, wire);
+    ASSERT_TRUE(wrapped.has_value());
+    EXPECT_EQ(wrapped.value().apdu.size(), 2U + 4U + 8U);
+    EXPECT_TRUE(card.receiveMaced(toStd(wrapped.value().apdu)));
+    response = SecureMessagingCodec::unwrapResponse(
+        wrapped.value().state, wrapped.value().expectation, toEtl(card.respondMaced({})), wire);
+    ASSERT_TRUE(response.has_value());
+    EXPECT_TRUE(response.value().data.empty());
+    state = moveBetweenWorkers(response.value().state);
+
+    // WriteData: enciphered request, header in the clear
+    SecureCommand write;
+    write.commandCode = 0x3D;
+    write.header.assign({0x01, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00});
+    write.data.assign({'h', 'e', 'l', 'l', 'o'});
+    write.commMode = CommMode::Enciphered;
+    wrapped = SecureMessagingCodec::wrapCommand(state, write, wire);
+    ASSERT_TRUE(wrapped.has_value());
+    EXPECT_EQ(wrapped.value().apdu.size(), 1U + 7U + 16U);
+    std::vector<uint8_t> received;
+    ASSERT_TRUE(card.receiveEnciphered(toStd(wrapped.value().apdu), 7U, received));
+    EXPECT_EQ(received, (std::vector<uint8_t>{'h', 'e', 'l', 'l', 'o'}));
+    EXPECT_EQ(toStd(wrapped.value().state.iv), card.iv);
+    response = SecureMessagingCodec::unwrapResponse(
+        wrapped.value().state, wrapped.value().expectation, toEtl(card.respondMaced({})), wire);
+    ASSERT_TRUE(response.has_value());
+    state = moveBetweenWorkers(response.value().state);
+
+    // ReadData: plain request, enciphered response located by its CRC
+    SecureCommand read;
+    read.commandCode = 0xBD;
+    read.header.assign({0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    read.responseMode = CommMode::Enciphered;
+    wrapped = SecureMessagingCodec::wrapCommand(state, read, wire);
+    ASSERT_TRUE(wrapped.has_value());
+    card.receivePlain(toStd(wrapped.value().apdu));
+    const std::vector<uint8_t> fileData = {'h', 'e', 'l', 'l', 'o', 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    response = SecureMessagingCodec::unwrapResponse(
+        wrapped.value().state, wrapped.value().expectation, toEtl(card.respondEnciphered(fileData)), wire);
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(toStd(response.value().state.iv), card.iv);
+
+    // Trailing zeros of the data look like padding; the CRC picks the right length
+    EXPECT_EQ(toStd(response.value().data), fileData);
+}
+
+TEST(SecureMessagingCodecTests, CardRequestKeepsHeaderPlainInEncipheredSession)
+{
+    NativeWire wire;
+    NoTransceiver transceiver;
+    DesfireCard desfire(transceiver, wire);
+    AesCardEmulator card;
+    DesfireContext state = aesSession();
+    state.commMode = CommMode::Enciphered;
+
+    // WriteData: file number, offset and length in the clear, answered by status and CMAC
+    DesfireRequest write;
+    write.commandCode = 0x3D;
+    write.data.assign({0x01, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 'h', 'e', 'l', 'l', 'o'});
+    write.expectedResponseLength = 0U;
+    write.headerLength = 7U;
+    auto wrapped = desfire.previewRequest(write, state);
+    ASSERT_TRUE(wrapped.has_value());
+    const std::vector<uint8_t> apdu = toStd(wrapped.value().apdu);
+    ASSERT_EQ(apdu.size(), 1U + 7U + 16U);
+    EXPECT_TRUE(std::equal(write.data.begin(), write.data.begin() + 7, apdu.begin() + 1));
+    std::vector<uint8_t> received;
+    ASSERT_TRUE(card.receiveEnciphered(apdu, 7U, received));
+    EXPECT_EQ(received, (std::vector<uint8_t>{'h', 'e', 'l', 'l', 'o'}));
+
+    auto response = SecureMessagingCodec::unwrapResponse(
+        wrapped.value().state, wrapped.value().expectation, toEtl(card.respondMaced({})), wire);
+    ASSERT_TRUE(response.has_value());
+    EXPECT_TRUE(response.value().isSuccess());
+    state = response.value().state;
+
+    // GetValue: only a header, sent in the clear; the value comes back enciphered
+    DesfireRequest getValue;
+    getValue.commandCode = 0x6C;
+    getValue.data.push_back(0x02);
+    getValue.expectedResponseLength = 4U;
+    getValue.headerLength = 1U;
+    getValue.responseMode = CommMode::Enciphered;
+    wrapped = desfire.previewRequest(getValue, state);
+    ASSERT_TRUE(wrapped.has_value());
+    EXPECT_EQ(toStd(wrapped.value().apdu), (std::vector<uint8_t>{0x6C, 0x02}));
+    card.receivePlain(toStd(wrapped.value().apdu));
+    response = SecureMessagingCodec::unwrapResponse(
+        wrapped.value().state, wrapped.value().expectation, toEtl(card.respondEnciphered({0xE8, 0x03, 0x00, 0x00})), wire);
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(toStd(response.value().data), (std::vector<uint8_t>{0xE8, 0x03, 0x00, 0x00}));
+
+    // A header longer than the request data is refused
+    write.headerLength = 13U;
+    EXPECT_FALSE(desfire.previewRequest(write, state).has_value());
+}
+
+TEST(SecureMessagingCodecTests, RejectsTamperedResponses)
+{
+    NativeWire wire;
+    AesCardEmulator card;
+
+    SecureCommand getValue;
+    getValue.commandCode = 0x6C;
+    getValue.header.push_back(0x02);
+    auto wrapped = SecureMessagingCodec::wrapCommand(aesSession(), getValue, wire);
+    ASSERT_TRUE(wrapped.has_value());
+    card.receivePlain(toStd(wrapped.value().apdu));
+
+    std::vector<uint8_t> tampered = card.respondMaced({0x01, 0x00, 0x00, 0x00});
+    tampered[1] ^= 0x01;
+    auto response = SecureMessagingCodec::unwrapResponse(
+        wrapped.value().state, wrapped.value().expectation, toEtl(tampered), wire);
+    ASSERT_FALSE(response.has_value());
+    EXPECT_TRUE(response.error().is<error::DesfireError>());
+    EXPECT_EQ(response.error().get<error::DesfireError>(), error::DesfireError::IntegrityError);
+
+    SecureResponseExpectation enciphered;
+    enciphered.responseMode = CommMode::Enciphered;
+    std::vector<uint8_t> corrupted = AesCardEmulator().respondEnciphered({0x01, 0x02, 0x03});
+    corrupted[5] ^= 0x80;
+    response = SecureMessagingCodec::unwrapResponse(aesSession(), enciphered, toEtl(corrupted), wire);
+    ASSERT_FALSE(response.has_value());
+    EXPECT_EQ(response.error().get<error::DesfireError>(), error::DesfireError::IntegrityError);
+
+    // Status only, without the CMAC every EV1 response carries
+    response = SecureMessagingCodec::unwrapResponse(
+        wrapped.value().state, wrapped.value().expectation, toEtl({0x00}), wire);
+    EXPECT_FALSE(response.has_value());
+}
+
+TEST(SecureMessagingCodecTests, CardErrorEndsSession)
+{
+    NativeWire wire;
+    SecureCommand command;
+    command.commandCode = 0x6C;
+    command.header.push_back(0x05);
+
+    auto wrapped = SecureMessagingCodec::wrapCommand(aesSession(), command, wire);
+    ASSERT_TRUE(wrapped.has_value());
+    auto response = SecureMessagingCodec::unwrapResponse(
+        wrapped.value().state, wrapped.value().expectation, toEtl({0x9D}), wire);
+    ASSERT_TRUE(response.has_value());
+    EXPECT_FALSE(response.value().isSuccess());
+    EXPECT_EQ(response.value().statusCode, 0x9D);
+    EXPECT_FALSE(response.value().state.authenticated);
+    EXPECT_TRUE(response.value().state.sessionKeyEnc.empty());
+    EXPECT_EQ(response.value().state.selectedAid.size(), 3U);
+
+    // 0xAF chaining is left to DesfireCard
+    response = SecureMessagingCodec::unwrapResponse(
+        wrapped.value().state, wrapped.value().expectation, toEtl({0xAF, 0x01}), wire);
+    EXPECT_FALSE(response.has_value());
+}
+
+TEST(SecureMessagingCodecTests, PassesThroughUnauthenticatedIsoFrames)
+{
+    IsoWire wire;
+    DesfireContext state;
+    SecureCommand select;
+    select.commandCode = 0x5A;
+    select.data.assign({0x01, 0x02, 0x03});
+
+    auto wrapped = SecureMessagingCodec::wrapCommand(state, select, wire);
+    ASSERT_TRUE(wrapped.has_value());
+    EXPECT_EQ(toStd(wrapped.value().apdu), (std::vector<uint8_t>{0x90, 0x5A, 0x00, 0x00, 0x03, 0x01, 0x02, 0x03, 0x00}));
+
+    auto response = SecureMessagingCodec::unwrapResponse(
+        wrapped.value().state, wrapped.value().expectation, toEtl({0x91, 0x00}), wire);
+    ASSERT_TRUE(response.has_value());
+    EXPECT_TRUE(response.value().isSuccess());
+    EXPECT_TRUE(response.value().data.empty());
+
+    // Legacy sessions are not handled by the codec
+    DesfireContext legacy;
+    legacy.authenticated = true;
+    legacy.authScheme = SessionAuthScheme::Legacy;
+    legacy.sessionKeyEnc.resize(8U, 0x11U);
+    legacy.iv.resize(8U, 0x00U);
+    EXPECT_FALSE(SecureMessagingCodec::wrapCommand(legacy, select, wire).has_value());
+}
+
+TEST(SecureMessagingCodecTests, SerialisedStateIsCheckedOnRestore)
+{
+    DesfireContext state = aesSession();
+    state.iv[3] = 0x42;
+    state.commMode = CommMode::Enciphered;
+
+    auto image = SecureMessagingCodec::serializeState(state);
+    ASSERT_EQ(image.size(), SecureMessagingCodec::STATE_SIZE);
+
+    auto restored = SecureMessagingCodec::deserializeState(image);
+    ASSERT_TRUE(restored.has_value());
+    EXPECT_TRUE(restored.value().authenticated);
+    EXPECT_EQ(restored.value().authScheme, SessionAuthScheme::Aes);
+    EXPECT_EQ(restored.value().commMode, CommMode::Enciphered);
+    EXPECT_EQ(restored.value().keyNo, 1U);
+    EXPECT_EQ(toStd(restored.value().sessionKeyEnc), toStd(state.sessionKeyEnc));
+    EXPECT_EQ(toStd(restored.value().iv), toStd(state.iv));
+    EXPECT_EQ(toStd(restored.value().selectedAid), toStd(state.selectedAid));
+
+    auto damaged = image;
+    damaged[20] ^= 0x01;
+    auto rejected = SecureMessagingCodec::deserializeState(damaged);
+    ASSERT_FALSE(rejected.has_value());
+    EXPECT_EQ(rejected.error().get<error::DesfireError>(), error::DesfireError::IntegrityError);
+
+    auto truncated = image;
+    truncated.pop_back();
+    rejected = SecureMessagingCodec::deserializeState(truncated);
+    ASSERT_FALSE(rejected.has_value());
+    EXPECT_EQ(rejected.error().get<error::DesfireError>(), error::DesfireError::ParameterError);
+}
@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "Comms/Serial/SerialBusLinux.hpp"
+#include "Error/Error.h"
+
+using namespace comms;
+using namespace comms::serial;
+using namespace error;
+
+// Test Fixture: a pty stands in for the USB-UART, a temporary directory for /sys/class/tty
+class SerialBusLinuxTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        master = posix_openpt(O_RDWR | O_NOCTTY);
+        ASSERT_GE(master, 0);
+        ASSERT_EQ(grantpt(master), 0);
+        ASSERT_EQ(unlockpt(master), 0);
+        slavePath = ptsname(master);
+
+        char tmpl[] = "/tmp/nfccpp_sysfs_XXXXXX";
+        ASSERT_NE(mkdtemp(tmpl), nullptr);
+        sysfsRoot = tmpl;
+    }
+
+    void TearDown() override {
+        std::remove(latencyTimerFile().c_str());
+        rmdir((ttyDirectory() + "/device").c_str());
+        rmdir(ttyDirectory().c_str());
+        rmdir(sysfsRoot.c_str());
+        close(master);
+    }
+
+    std::string ttyDirectory() const {
+        return sysfsRoot + "/" + slavePath.substr(slavePath.find_last_of('/') + 1);
+    }
+
+    std::string latencyTimerFile() const {
+        return ttyDirectory() + "/device/latency_timer";
+    }
+
+    // Mimic the ftdi_sio latency_timer attribute
+    void createLatencyTimer(unsigned value) {
+        mkdir(ttyDirectory().c_str(), 0700);
+        mkdir((ttyDirectory() + "/device").c_str(), 0700);
+        writeLatencyTimer(value);
+    }
+
+    void writeLatencyTimer(unsigned value) {
+        FILE* file = std::fopen(latencyTimerFile().c_str(), "w");
+        ASSERT_NE(file, nullptr);
+        std::fprintf(file, "%u\n", value);
+        std::fclose(file);
+    }
+
+    unsigned readLatencyTimer() {
+        unsigned value = 0;
+        FILE* file = std::fopen(latencyTimerFile().c_str(), "r");
+        EXPECT_NE(file, nullptr);
+        if (file != nullptr) {
+            EXPECT_EQ(std::fscanf(file, "%u", &value), 1);
+            std::fclose(file);
+        }
+        return value;
+    }
+
+    int master = -1;
+    std::string slavePath;
+    std::string sysfsRoot;
+};
+
+// Test: Data written on the bus arrives on the other side of the pty and back
+TEST_F(SerialBusLinuxTest, TransfersDataOverPty) {
+    SerialBusLinux serialBus(slavePath.c_str(), 115200, sysfsRoot.c_str());
+    ASSERT_TRUE(serialBus.init().has_value());
+    ASSERT_TRUE(serialBus.setTimeout(200).has_value());
+
+    etl::vector<uint8_t, 8> frame{0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00};
+    ASSERT_TRUE(serialBus.write(frame).has_value());
+
+    uint8_t received[8];
+    ASSERT_EQ(::read(master, received, sizeof(received)), 6);
+    EXPECT_EQ(received[2], 0xFF);
+
+    ASSERT_EQ(::write(master, received, 6), 6);
+    etl::vector<uint8_t, 16> buffer;
+    auto result = serialBus.read(buffer, 16);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value(), 6U);
+    EXPECT_EQ(buffer.size(), 6U);
+
+    // Nothing pending: the read returns empty after the timeout
+    result = serialBus.read(buffer, 4);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value(), 0U);
+}
+
+// Test: Without TIOCSSERIAL and latency_timer, low latency is reported as unavailable
+TEST_F(SerialBusLinuxTest, LowLatencyUnsupportedOnPlainPty) {
+    SerialBusLinux serialBus(slavePath.c_str(), 115200, sysfsRoot.c_str());
+    ASSERT_TRUE(serialBus.open().has_value());
+
+    auto result = serialBus.setProperty(BusProperty::LowLatency, 1);
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().get<HardwareError>(), HardwareError::NotSupported);
+
+    auto lowLatency = serialBus.getProperty(BusProperty::LowLatency);
+    ASSERT_FALSE(lowLatency.has_value());
+    EXPECT_EQ(lowLatency.error().get<HardwareError>(), HardwareError::NotSupported);
+    EXPECT_FALSE(serialBus.getProperty(BusProperty::LatencyTimer).has_value());
+}
+
+// Test: The latency timer is lowered, reported, and restored on disable and close
+TEST_F(SerialBusLinuxTest, LowLatencyLowersAndRestoresLatencyTimer) {
+    createLatencyTimer(16);
+
+    SerialBusLinux serialBus(slavePath.c_str(), 115200, sysfsRoot.c_str());
+    ASSERT_TRUE(serialBus.open().has_value());
+
+    auto lowLatency = serialBus.getProperty(BusProperty::LowLatency);
+    ASSERT_TRUE(lowLatency.has_value());
+    EXPECT_EQ(lowLatency.value(), 0U);
+
+    ASSERT_TRUE(serialBus.setProperty(BusProperty::LowLatency, 1).has_value());
+    EXPECT_EQ(readLatencyTimer(), SerialBusLinux::LOW_LATENCY_TIMER_MS);
+    EXPECT_EQ(serialBus.getProperty(BusProperty::LowLatency).value(), 1U);
+    EXPECT_EQ(serialBus.getProperty(BusProperty::LatencyTimer).value(), 1U);
+
+    ASSERT_TRUE(serialBus.setProperty(BusProperty::LowLatency, 0).has_value());
+    EXPECT_EQ(readLatencyTimer(), 16U);
+    EXPECT_EQ(serialBus.getProperty(BusProperty::LowLatency).value(), 0U);
+
+    // Another process changed the timer meanwhile: the effective value is reported
+    writeLatencyTimer(1);
+    EXPECT_EQ(serialBus.getProperty(BusProperty::LowLatency).value(), 1U);
+    writeLatencyTimer(16);
+
+    ASSERT_TRUE(serialBus.setLowLatency(true).has_value());
+    serialBus.close();
+    EXPECT_EQ(readLatencyTimer(), 16U);
+}
+
+// Test: Latency timer values outside the driver's range are rejected
+TEST_F(SerialBusLinuxTest, LatencyTimerRange) {
+    createLatencyTimer(16);
+
+    SerialBusLinux serialBus(slavePath.c_str(), 115200, sysfsRoot.c_str());
+    ASSERT_TRUE(serialBus.open().has_value());
+
+    auto result = serialBus.setProperty(BusProperty::LatencyTimer, 0);
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().get<HardwareError>(), HardwareError::InvalidConfiguration);
+    EXPECT_FALSE(serialBus.setLatencyTimer(256).has_value());
+
+    ASSERT_TRUE(serialBus.setLatencyTimer(4).has_value());
+    EXPECT_EQ(readLatencyTimer(), 4U);
+    EXPECT_EQ(serialBus.getProperty(BusProperty::LatencyTimer).value(), 4U);
+}
+
+// Test: Opening a missing device fails
+TEST_F(SerialBusLinuxTest, OpenMissingDevice) {
+    SerialBusLinux serialBus("/dev/ttyNFCCPP_MISSING", 115200, sysfsRoot.c_str());
+    auto result = serialBus.open();
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().get<HardwareError>(), HardwareError::DeviceNotFound);
+    EXPECT_FALSE(serialBus.isOpen());
+}
@@ -0,0 +1,237 @@
+#include <gtest/gtest.h>
+#include <poll.h>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include "Comms/Serial/SerialRing.hpp"
+#include "Comms/Serial/SerialRingBus.hpp"
+#include "Error/Error.h"
+
+using namespace comms;
+using namespace comms::serial;
+using namespace error;
+
+namespace
+{
+    struct Pty
+    {
+        int master = -1;
+        int slave = -1;
+        std::string slavePath;
+    };
+
+    Pty openPty(bool openSlave)
+    {
+        Pty pty;
+        pty.master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (pty.master >= 0 && grantpt(pty.master) == 0 && unlockpt(pty.master) == 0)
+        {
+            pty.slavePath = ptsname(pty.master);
+            if (openSlave)
+            {
+                pty.slave = open(pty.slavePath.c_str(), O_RDWR | O_NOCTTY);
+                termios options;
+                tcgetattr(pty.slave, &options);
+                cfmakeraw(&options);
+                options.c_cc[VMIN] = 1;
+                options.c_cc[VTIME] = 0;
+                tcsetattr(pty.slave, TCSANOW, &options);
+            }
+        }
+        return pty;
+    }
+
+    void closePty(Pty& pty)
+    {
+        if (pty.slave >= 0)
+        {
+            close(pty.slave);
+        }
+        if (pty.master >= 0)
+        {
+            close(pty.master);
+        }
+    }
+
+    // What the simulated reader received, waiting up to 1 s for the first byte
+    std::vector<uint8_t> readMaster(int master, size_t expected)
+    {
+        std::vector<uint8_t> data;
+        while (data.size() < expected)
+        {
+            pollfd descriptor = {master, POLLIN, 0};
+            if (poll(&descriptor, 1, 1000) <= 0)
+            {
+                break;
+            }
+            uint8_t chunk[64];
+            const ssize_t count = read(master, chunk, sizeof(chunk));
+            if (count <= 0)
+            {
+                break;
+            }
+            data.insert(data.end(), chunk, chunk + count);
+        }
+        return data;
+    }
+
+    struct HandlerLog
+    {
+        std::vector<size_t> received;
+        std::vector<size_t> written;
+    };
+
+    void onReceive(void* context, size_t channel)
+    {
+        static_cast<HandlerLog*>(context)->received.push_back(channel);
+    }
+
+    void onWriteComplete(void* context, size_t channel, bool ok)
+    {
+        if (ok)
+        {
+            static_cast<HandlerLog*>(context)->written.push_back(channel);
+        }
+    }
+}
+
+// Test Fixture: an initialized ring; skipped where the kernel has no io_uring
+class SerialRingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (!ring.init().has_value()) {
+            GTEST_SKIP() << "io_uring not available";
+        }
+    }
+
+    SerialRing ring;
+};
+
+// Test: Writes queued on several channels go out in one io_uring_enter
+TEST_F(SerialRingTest, BatchesWritesOfAllChannels) {
+    constexpr size_t READERS = 4U;
+    Pty ptys[READERS];
+    size_t channels[READERS];
+    HandlerLog log;
+    SerialRingHandlers handlers;
+    handlers.onWriteComplete = onWriteComplete;
+    handlers.context = &log;
+
+    for (size_t i = 0; i < READERS; ++i) {
+        ptys[i] = openPty(true);
+        ASSERT_GE(ptys[i].slave, 0);
+        auto channel = ring.attach(ptys[i].slave, handlers);
+        ASSERT_TRUE(channel.has_value());
+        channels[i] = channel.value();
+    }
+    ASSERT_TRUE(ring.poll(0).has_value()); // arm the reads
+
+    const uint32_t entersBefore = ring.getMetrics().enterCalls;
+    for (size_t i = 0; i < READERS; ++i) {
+        etl::vector<uint8_t, 4> frame = {0x00, 0x00, 0xFF, static_cast<uint8_t>(i)};
+        ASSERT_TRUE(ring.write(channels[i], frame).has_value());
+    }
+    ASSERT_TRUE(ring.poll(0).has_value());
+    EXPECT_EQ(ring.getMetrics().enterCalls, entersBefore + 1U);
+
+    for (size_t i = 0; i < READERS; ++i) {
+        EXPECT_TRUE(ring.waitWritten(channels[i], 1000));
+        EXPECT_EQ(readMaster(ptys[i].master, 4U), std::vector<uint8_t>({0x00, 0x00, 0xFF, static_cast<uint8_t>(i)}));
+    }
+    EXPECT_EQ(log.written.size(), READERS);
+
+    for (size_t i = 0; i < READERS; ++i) {
+        ring.detach(channels[i]);
+        closePty(ptys[i]);
+    }
+}
+
+// Test: Received bytes are buffered per channel and reported through the handler
+TEST_F(SerialRingTest, BuffersReceivedBytesPerChannel) {
+    Pty first = openPty(true);
+    Pty second = openPty(true);
+    HandlerLog log;
+    SerialRingHandlers handlers;
+    handlers.onReceive = onReceive;
+    handlers.context = &log;
+
+    auto a = ring.attach(first.slave, handlers);
+    auto b = ring.attach(second.slave, handlers);
+    ASSERT_TRUE(a.has_value());
+    ASSERT_TRUE(b.has_value());
+    ASSERT_TRUE(ring.poll(0).has_value());
+
+    const uint8_t ack[] = {0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00};
+    ASSERT_EQ(write(second.master, ack, sizeof(ack)), static_cast<ssize_t>(sizeof(ack)));
+
+    ASSERT_TRUE(ring.waitReadable(b.value(), 1000));
+    EXPECT_EQ(ring.available(a.value()), 0U);
+    ASSERT_FALSE(log.received.empty());
+    EXPECT_EQ(log.received[0], b.value());
+
+    // Wait out the rest of a split delivery
+    for (int i = 0; i < 10 && ring.available(b.value()) < sizeof(ack); ++i) {
+        ASSERT_TRUE(ring.poll(10).has_value());
+    }
+    uint8_t data[16];
+    ASSERT_EQ(ring.read(b.value(), data, sizeof(data)), sizeof(ack));
+    EXPECT_EQ(std::vector<uint8_t>(data, data + sizeof(ack)), std::vector<uint8_t>(ack, ack + sizeof(ack)));
+
+    ring.detach(a.value());
+    ring.detach(b.value());
+    closePty(first);
+    closePty(second);
+}
+
+// Test: Detaching cancels the outstanding read so the descriptor can be closed
+TEST_F(SerialRingTest, DetachCancelsOutstandingRead) {
+    Pty pty = openPty(true);
+    auto channel = ring.attach(pty.slave);
+    ASSERT_TRUE(channel.has_value());
+    ASSERT_TRUE(ring.poll(0).has_value());
+
+    ring.detach(channel.value());
+    EXPECT_EQ(ring.available(channel.value()), 0U);
+    EXPECT_FALSE(ring.write(channel.value(), etl::vector<uint8_t, 1>{0x55}).has_value());
+
+    // The channel is free again
+    auto again = ring.attach(pty.slave);
+    ASSERT_TRUE(again.has_value());
+    EXPECT_EQ(again.value(), channel.value());
+    ring.detach(again.value());
+    closePty(pty);
+}
+
+// Test: SerialRingBus behaves like SerialBusLinux for a request/response exchange
+TEST_F(SerialRingTest, BusExchangesFramesOverPty) {
+    Pty pty = openPty(false);
+    SerialRingBus bus(ring, pty.slavePath.c_str(), 115200);
+    ASSERT_TRUE(bus.init().has_value());
+    ASSERT_TRUE(bus.setTimeout(200).has_value());
+    EXPECT_TRUE(bus.isOpen());
+
+    etl::vector<uint8_t, 8> request = {0x00, 0x00, 0xFF, 0x02, 0xFE, 0xD4, 0x02, 0x2A};
+    ASSERT_TRUE(bus.write(request).has_value());
+    ASSERT_TRUE(bus.flush().has_value());
+    EXPECT_EQ(readMaster(pty.master, request.size()), std::vector<uint8_t>(request.begin(), request.end()));
+
+    const uint8_t response[] = {0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00};
+    ASSERT_EQ(write(pty.master, response, sizeof(response)), static_cast<ssize_t>(sizeof(response)));
+
+    etl::vector<uint8_t, 16> buffer;
+    auto result = bus.read(buffer, sizeof(response));
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value(), sizeof(response));
+    EXPECT_EQ(bus.available(), 0U);
+
+    // Nothing more arrives: the read ends at the timeout with what it has
+    auto empty = bus.read(buffer, 4);
+    ASSERT_TRUE(empty.has_value());
+    EXPECT_EQ(empty.value(), 0U);
+
+    bus.close();
+    EXPECT_FALSE(bus.isOpen());
+    closePty(pty);
+}
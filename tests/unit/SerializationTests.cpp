@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include "Utils/Serialization.h"
+
+using namespace utils;
+
+// Test: CRC32 matches the IEEE 802.3 check value
+TEST(SerializationTests, Crc32MatchesCheckValue)
+{
+    const uint8_t digits[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    EXPECT_EQ(crc32(digits, sizeof(digits)), 0xCBF43926U);
+    EXPECT_EQ(crc32(digits, 0U), 0x00000000U);
+}
+
+// Test: CRC32 over chunks equals CRC32 over the whole buffer
+TEST(SerializationTests, Crc32ContinuesPreviousChunk)
+{
+    const uint8_t digits[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    const uint32_t head = crc32(digits, 4U);
+    EXPECT_EQ(crc32(digits + 4U, sizeof(digits) - 4U, head), 0xCBF43926U);
+}
+
+// Test: Little-endian fields are written low byte first and read back
+TEST(SerializationTests, LittleEndianFieldsRoundTrip)
+{
+    uint8_t buffer[8] = {0};
+    writeLe32(buffer, 0x12345678U);
+    EXPECT_EQ(buffer[0], 0x78);
+    EXPECT_EQ(buffer[3], 0x12);
+    EXPECT_EQ(readLe32(buffer), 0x12345678U);
+
+    writeLe64(buffer, 0x0102030405060708ULL);
+    EXPECT_EQ(buffer[0], 0x08);
+    EXPECT_EQ(buffer[7], 0x01);
+    EXPECT_EQ(readLe64(buffer), 0x0102030405060708ULL);
+}
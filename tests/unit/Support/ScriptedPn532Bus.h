@@ -0,0 +1,107 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include "Comms/IHardwareBus.hpp"
+#include "Error/HardwareError.h"
+
+namespace test_support
+{
+    /**
+     * PN532 host link that answers every command frame with the next
+     * scripted reply (raw bytes, may be empty). With ackFrames set, an ACK
+     * goes out ahead of each reply. Wake-up bytes are ignored; once the
+     * script runs out, frames get the ACK only.
+     */
+    class ScriptedPn532Bus : public comms::IHardwareBus
+    {
+    public:
+        etl::expected<void, error::Error> init() override
+        {
+            return {};
+        }
+
+        etl::expected<void, error::Error> open() override
+        {
+            setIsOpen(true);
+            return {};
+        }
+
+        void close() override
+        {
+            setIsOpen(false);
+        }
+
+        etl::expected<void, error::Error> write(const etl::ivector<uint8_t>& data) override
+        {
+            bool wakeUp = true;
+            for (uint8_t b : data)
+            {
+                wakeUp = wakeUp && (b == 0x00);
+            }
+            if (wakeUp)
+            {
+                return {};
+            }
+
+            sentFrames.emplace_back(data.begin(), data.end());
+            if (ackFrames)
+            {
+                const uint8_t ack[] = {0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00};
+                rx.insert(rx.end(), ack, ack + sizeof(ack));
+            }
+            if (!replies.empty())
+            {
+                rx.insert(rx.end(), replies.front().begin(), replies.front().end());
+                replies.pop_front();
+            }
+            return {};
+        }
+
+        etl::expected<size_t, error::Error> read(etl::ivector<uint8_t>& buffer, size_t length) override
+        {
+            buffer.clear();
+            while (length-- > 0U && !rx.empty())
+            {
+                buffer.push_back(rx.front());
+                rx.pop_front();
+            }
+            return buffer.size();
+        }
+
+        etl::expected<void, error::Error> flush() override
+        {
+            rx.clear();
+            return {};
+        }
+
+        size_t available() const override
+        {
+            return rx.size();
+        }
+
+        etl::expected<void, error::Error> setProperty(comms::BusProperty, uint32_t) override
+        {
+            return {};
+        }
+
+        etl::expected<uint32_t, error::Error> getProperty(comms::BusProperty) const override
+        {
+            return etl::unexpected(error::Error::fromHardware(error::HardwareError::NotSupported));
+        }
+
+        // DataOut of the InDataExchange frames sent, without the Tg byte
+        std::vector<uint8_t> dataOut(size_t index) const
+        {
+            const std::vector<uint8_t>& frame = sentFrames[index];
+            return std::vector<uint8_t>(frame.begin() + 8, frame.end() - 2);
+        }
+
+        std::deque<std::vector<uint8_t>> replies;
+        std::vector<std::vector<uint8_t>> sentFrames;
+        bool ackFrames = true;
+
+    private:
+        std::deque<uint8_t> rx;
+    };
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+#include "Nfc/Apdu/IApduTransceiver.h"
+#include "Error/Pn532Error.h"
+
+namespace test_support
+{
+    /**
+     * Plain-mode value file emulation with CommitTransaction semantics:
+     * GetValue, Credit, LimitedCredit, Debit, SelectApplication and
+     * CommitTransaction. Commit failures can be injected before or after
+     * the card applied it.
+     */
+    class ValueCard : public nfc::IApduTransceiver
+    {
+    public:
+        enum class CommitFault
+        {
+            None,
+            LostRequest,
+            LostResponse
+        };
+
+        void setWire(nfc::IWire&) override
+        {
+        }
+
+        etl::expected<etl::vector<uint8_t, nfc::buffer::PDU_RESPONSE_MAX>, error::Error> transceive(
+            const etl::ivector<uint8_t>& apdu) override
+        {
+            commands.push_back(apdu[0]);
+            etl::vector<uint8_t, nfc::buffer::PDU_RESPONSE_MAX> response;
+            response.push_back(0x00);
+            switch (apdu[0])
+            {
+                case 0x6C:
+                    for (size_t i = 0; i < 4U; ++i)
+                    {
+                        response.push_back(static_cast<uint8_t>(static_cast<uint32_t>(value) >> (8U * i)));
+                    }
+                    break;
+                case 0x0C:
+                case 0x1C:
+                case 0xDC:
+                {
+                    const int32_t amount = static_cast<int32_t>(
+                        apdu[2] | (apdu[3] << 8U) | (apdu[4] << 16U) | (static_cast<uint32_t>(apdu[5]) << 24U));
+                    pending += (apdu[0] == 0xDC) ? -amount : amount;
+                    break;
+                }
+                case 0x5A:
+                    // Selecting aborts the open transaction
+                    pending = 0;
+                    break;
+                case 0xC7:
+                    if (commitFault == CommitFault::LostRequest)
+                    {
+                        commitFault = CommitFault::None;
+                        return etl::unexpected(error::Error::fromPn532(error::Pn532Error::Timeout));
+                    }
+                    value += pending;
+                    pending = 0;
+                    if (commitFault == CommitFault::LostResponse)
+                    {
+                        commitFault = CommitFault::None;
+                        return etl::unexpected(error::Error::fromPn532(error::Pn532Error::Timeout));
+                    }
+                    break;
+                default:
+                    response[0] = 0x1C;
+                    break;
+            }
+            return response;
+        }
+
+        size_t count(uint8_t command) const
+        {
+            size_t n = 0U;
+            for (uint8_t c : commands)
+            {
+                n += (c == command) ? 1U : 0U;
+            }
+            return n;
+        }
+
+        int32_t value = 100;
+        int32_t pending = 0;
+        CommitFault commitFault = CommitFault::None;
+        std::vector<uint8_t> commands;
+    };
+}
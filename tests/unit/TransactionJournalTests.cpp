@@ -0,0 +1,461 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <map>
+#include <vector>
+#include "Nfc/Desfire/TransactionJournal.h"
+#include "Nfc/Desfire/DesfireValueFile.h"
+#include "Nfc/Desfire/DesfireRecordFile.h"
+#include "Nfc/Desfire/DesfireCard.h"
+#include "Nfc/Apdu/IApduTransceiver.h"
+#include "Nfc/Wire/NativeWire.h"
+#include "Support/ValueCard.h"
+
+using namespace nfc;
+using test_support::ValueCard;
+
+namespace
+{
+    const std::array<uint8_t, 16> JOURNAL_KEY = {
+        0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6,
+        0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C};
+
+    constexpr size_t SMALL_SEGMENT = 4U * TransactionJournalFormat::SLOT_SIZE;    // three entries
+
+    /**
+     * Segment files kept in memory. "disk" holds what survived the last
+     * flush, "mapped" what the process sees.
+     */
+    class MemorySegments : public ITransactionJournalSegments
+    {
+    public:
+        bool newestSegment(uint32_t& index) const override
+        {
+            if (disk.empty())
+            {
+                return false;
+            }
+            index = disk.rbegin()->first;
+            return true;
+        }
+
+        etl::expected<uint8_t*, error::Error> map(uint32_t index, size_t size) override
+        {
+            std::vector<uint8_t>& file = disk[index];
+            file.resize(size, 0U);
+            mapped[index] = file;
+            return mapped[index].data();
+        }
+
+        etl::expected<void, error::Error> flush(uint32_t index, size_t offset, size_t length) override
+        {
+            if (crashed)
+            {
+                return {};
+            }
+            flushes.push_back({offset, length});
+            std::copy(mapped[index].begin() + offset, mapped[index].begin() + offset + length,
+                      disk[index].begin() + offset);
+            return {};
+        }
+
+        void unmap(uint32_t index) override
+        {
+            mapped.erase(index);
+        }
+
+        std::map<uint32_t, std::vector<uint8_t>> disk;
+        std::map<uint32_t, std::vector<uint8_t>> mapped;
+        std::vector<std::pair<size_t, size_t>> flushes;
+        bool crashed = false;   // nothing reaches the disk any more
+    };
+
+    TransactionJournalEntry debitEntry(int32_t amount)
+    {
+        TransactionJournalEntry entry;
+        entry.type = TransactionJournalType::Debit;
+        entry.uid = {0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+        entry.aid = {0x01, 0x02, 0x03};
+        entry.fileNo = 0x03;
+        entry.delta = -amount;
+        entry.newValue = 100 - amount;
+        entry.flags = TRANSACTION_JOURNAL_VALUE_KNOWN;
+        return entry;
+    }
+
+    uint64_t fakeNow = 0U;
+
+    uint64_t fakeClock()
+    {
+        return fakeNow;
+    }
+
+    /**
+     * Plain linear record file of 16-byte records: GetFileSettings,
+     * WriteRecord and CommitTransaction only.
+     */
+    class RecordCard : public IApduTransceiver
+    {
+    public:
+        void setWire(IWire&) override
+        {
+        }
+
+        etl::expected<etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX>, error::Error> transceive(
+            const etl::ivector<uint8_t>& apdu) override
+        {
+            etl::vector<uint8_t, buffer::PDU_RESPONSE_MAX> response;
+            if (apdu[0] == 0xF5)
+            {
+                response.assign({0x00, 0x03, 0x00, 0xEE, 0xEE, 0x10, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00});
+                return response;
+            }
+            if (apdu[0] == 0xC7 && failCommit)
+            {
+                return etl::unexpected(error::Error::fromDesfire(error::DesfireError::IntegrityError));
+            }
+            response.push_back(0x00);
+            return response;
+        }
+
+        bool failCommit = false;
+    };
+}
+
+TEST(TransactionJournalTests, FlushesOncePerGroup)
+{
+    MemorySegments segments;
+    TransactionJournalOptions options;
+    options.groupSize = 4U;
+    options.clock = fakeClock;
+    TransactionJournal journal(segments, options);
+    ASSERT_EQ(journal.recover().value(), 0U);
+    ASSERT_EQ(segments.flushes.size(), 1U);     // segment header
+
+    for (int32_t i = 0; i < 6; ++i)
+    {
+        fakeNow = 1000U + static_cast<uint64_t>(i);
+        auto sequence = journal.append(debitEntry(i));
+        ASSERT_TRUE(sequence.has_value());
+        EXPECT_EQ(sequence.value(), static_cast<uint32_t>(i));
+    }
+
+    // One flush covering entries 0..3, entries 4 and 5 still in the mapping
+    ASSERT_EQ(segments.flushes.size(), 2U);
+    EXPECT_EQ(segments.flushes[1], std::make_pair(size_t{64U}, size_t{256U}));
+    EXPECT_TRUE(journal.isDurable(3U));
+    EXPECT_FALSE(journal.isDurable(4U));
+
+    // The delay has not passed for the oldest pending entry yet
+    fakeNow = 1004U + options.groupDelayMs - 1U;
+    ASSERT_TRUE(journal.poll().has_value());
+    EXPECT_EQ(segments.flushes.size(), 2U);
+
+    fakeNow = 1004U + options.groupDelayMs;
+    ASSERT_TRUE(journal.poll().has_value());
+    ASSERT_EQ(segments.flushes.size(), 3U);
+    EXPECT_EQ(segments.flushes[2], std::make_pair(size_t{320U}, size_t{128U}));
+    EXPECT_TRUE(journal.isDurable(5U));
+
+    TransactionJournalReader reader;
+    ASSERT_TRUE(reader.open(segments.disk[0].data(), segments.disk[0].size()).has_value());
+    TransactionJournalEntry entry;
+    ASSERT_TRUE(reader.next(entry));
+    EXPECT_EQ(entry.type, TransactionJournalType::Debit);
+    EXPECT_EQ(entry.timestamp, 1000U);
+    EXPECT_EQ(entry.delta, 0);
+    EXPECT_EQ(entry.uid.size(), 7U);
+    EXPECT_EQ(entry.aid[2], 0x03);
+    EXPECT_EQ(journal.metrics().appended, 6U);
+}
+
+TEST(TransactionJournalTests, RecoveryKeepsCompletePrefix)
+{
+    MemorySegments segments;
+    TransactionJournalOptions options;
+    options.groupSize = 8U;
+    {
+        TransactionJournal journal(segments, options);
+        ASSERT_TRUE(journal.recover().has_value());
+        for (int32_t i = 0; i < 5; ++i)
+        {
+            ASSERT_TRUE(journal.append(debitEntry(i)).has_value());
+        }
+
+        // Crash: entries 0, 1, 3 and 4 reached the disk, entry 2 only partly
+        std::vector<uint8_t>& mapped = segments.mapped[0];
+        std::vector<uint8_t>& disk = segments.disk[0];
+        std::copy(mapped.begin(), mapped.begin() + (6 * 64), disk.begin());
+        std::fill(disk.begin() + (3 * 64) + 40, disk.begin() + (4 * 64), 0U);
+        segments.crashed = true;
+    }
+    segments.crashed = false;
+    segments.mapped.clear();
+    segments.flushes.clear();
+
+    TransactionJournal journal(segments, options);
+    auto kept = journal.recover();
+    ASSERT_TRUE(kept.has_value());
+    EXPECT_EQ(kept.value(), 2U);
+    EXPECT_EQ(journal.metrics().discarded, 3U);
+    EXPECT_EQ(journal.nextSequence(), 2U);
+    ASSERT_EQ(segments.flushes.size(), 1U);
+    EXPECT_EQ(segments.flushes[0], std::make_pair(size_t{192U}, size_t{192U}));
+
+    ASSERT_EQ(journal.append(debitEntry(7)).value(), 2U);
+    ASSERT_TRUE(journal.commit().has_value());
+
+    TransactionJournalReader reader;
+    ASSERT_TRUE(reader.open(segments.disk[0].data(), segments.disk[0].size()).has_value());
+    TransactionJournalEntry entry;
+    size_t count = 0U;
+    while (reader.next(entry))
+    {
+        ++count;
+    }
+    EXPECT_EQ(count, 3U);
+    EXPECT_EQ(entry.delta, -7);
+}
+
+TEST(TransactionJournalTests, RotatesSegmentsAndExportsWhileWriting)
+{
+    MemorySegments segments;
+    TransactionJournalOptions options;
+    options.segmentSize = SMALL_SEGMENT;
+    options.groupSize = 2U;
+    options.macKey = JOURNAL_KEY.data();
+    TransactionJournal journal(segments, options);
+    ASSERT_TRUE(journal.recover().has_value());
+
+    for (int32_t i = 0; i < 7; ++i)
+    {
+        ASSERT_TRUE(journal.append(debitEntry(i)).has_value());
+    }
+    EXPECT_EQ(journal.segmentIndex(), 2U);
+    EXPECT_EQ(journal.metrics().rotations, 2U);
+    ASSERT_EQ(segments.disk.size(), 3U);
+
+    // Export closed segments from disk and the live one from the mapping
+    uint32_t expected = 0U;
+    for (uint32_t index = 0U; index < 2U; ++index)
+    {
+        TransactionJournalReader reader;
+        ASSERT_TRUE(reader.open(segments.disk[index].data(), SMALL_SEGMENT).has_value());
+        EXPECT_EQ(reader.segmentIndex(), index);
+        TransactionJournalEntry entry;
+        while (reader.next(entry))
+        {
+            EXPECT_EQ(entry.sequence, expected++);
+            EXPECT_TRUE(TransactionJournalFormat::verifyMac(entry, JOURNAL_KEY.data()));
+        }
+        EXPECT_TRUE(reader.atEnd());
+    }
+    EXPECT_EQ(expected, 6U);
+
+    TransactionJournalReader live;
+    ASSERT_TRUE(live.open(segments.mapped[2].data(), SMALL_SEGMENT).has_value());
+    TransactionJournalEntry entry;
+    ASSERT_TRUE(live.next(entry));
+    EXPECT_EQ(entry.sequence, 6U);
+    EXPECT_FALSE(live.next(entry));
+
+    ASSERT_TRUE(journal.append(debitEntry(9)).has_value());
+    ASSERT_TRUE(live.next(entry));
+    EXPECT_EQ(entry.sequence, 7U);
+    EXPECT_EQ(entry.delta, -9);
+
+    // A modified entry no longer matches its MAC
+    entry.newValue += 1;
+    EXPECT_FALSE(TransactionJournalFormat::verifyMac(entry, JOURNAL_KEY.data()));
+}
+
+TEST(TransactionJournalTests, RestartsSegmentWithTornHeader)
+{
+    MemorySegments segments;
+    TransactionJournalOptions options;
+    options.segmentSize = SMALL_SEGMENT;
+    options.groupSize = 1U;
+    {
+        TransactionJournal journal(segments, options);
+        ASSERT_TRUE(journal.recover().has_value());
+        for (int32_t i = 0; i < 3; ++i)
+        {
+            ASSERT_TRUE(journal.append(debitEntry(i)).has_value());
+        }
+    }
+
+    // Crash after creating segment 1, before its header was written
+    segments.disk[1] = std::vector<uint8_t>(SMALL_SEGMENT, 0U);
+
+    TransactionJournal journal(segments, options);
+    auto kept = journal.recover();
+    ASSERT_TRUE(kept.has_value());
+    EXPECT_EQ(kept.value(), 0U);
+    EXPECT_EQ(journal.segmentIndex(), 1U);
+    EXPECT_EQ(journal.nextSequence(), 3U);
+    EXPECT_EQ(journal.append(debitEntry(4)).value(), 3U);
+}
+
+TEST(TransactionJournalTests, ValueFileJournalsOperationsAndCommit)
+{
+    ValueCard transceiver;
+    NativeWire wire;
+    DesfireCard card(transceiver, wire);
+    DesfireValueFile file(card, 0x03);
+
+    MemorySegments segments;
+    TransactionJournalOptions options;
+    TransactionJournal journal(segments, options);
+    ASSERT_TRUE(journal.recover().has_value());
+    const etl::vector<uint8_t, 7> uid = {0x04, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6};
+    file.setJournal(&journal, uid);
+
+    ASSERT_EQ(file.balance().value(), 100);
+    ASSERT_TRUE(file.debit(30).has_value());
+    auto committed = file.commit();
+    ASSERT_TRUE(committed.has_value());
+    EXPECT_TRUE(committed.value().journaled);
+    ASSERT_TRUE(journal.commit().has_value());
+
+    TransactionJournalReader reader;
+    ASSERT_TRUE(reader.open(segments.disk[0].data(), segments.disk[0].size()).has_value());
+    TransactionJournalEntry entry;
+    ASSERT_TRUE(reader.next(entry));
+    EXPECT_EQ(entry.type, TransactionJournalType::Debit);
+    EXPECT_EQ(entry.delta, -30);
+    EXPECT_EQ(entry.newValue, 70);
+    EXPECT_EQ(entry.fileNo, 0x03);
+    EXPECT_EQ(entry.uid[6], 0xA6);
+    ASSERT_TRUE(reader.next(entry));
+    EXPECT_EQ(entry.type, TransactionJournalType::Commit);
+    EXPECT_EQ(entry.newValue, 70);
+    EXPECT_EQ(entry.delta, -30);
+    EXPECT_FALSE(reader.next(entry));
+}
+
+TEST(TransactionJournalTests, ValueFileJournalsLimitedCredit)
+{
+    ValueCard transceiver;
+    NativeWire wire;
+    DesfireCard card(transceiver, wire);
+    DesfireValueFile file(card, 0x03);
+
+    MemorySegments segments;
+    TransactionJournalOptions options;
+    TransactionJournal journal(segments, options);
+    ASSERT_TRUE(journal.recover().has_value());
+    const etl::vector<uint8_t, 7> uid = {0x04, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6};
+    file.setJournal(&journal, uid);
+
+    ASSERT_EQ(file.balance().value(), 100);
+    ASSERT_TRUE(file.limitedCredit(20).has_value());
+    auto committed = file.commit();
+    ASSERT_TRUE(committed.has_value());
+    EXPECT_EQ(committed.value().balance, 120);
+    ASSERT_TRUE(journal.commit().has_value());
+
+    TransactionJournalReader reader;
+    ASSERT_TRUE(reader.open(segments.disk[0].data(), segments.disk[0].size()).has_value());
+    TransactionJournalEntry entry;
+    ASSERT_TRUE(reader.next(entry));
+    EXPECT_EQ(entry.type, TransactionJournalType::LimitedCredit);
+    EXPECT_EQ(entry.delta, 20);
+    EXPECT_EQ(entry.newValue, 120);
+    EXPECT_EQ(entry.flags, TRANSACTION_JOURNAL_VALUE_KNOWN);
+    ASSERT_TRUE(reader.next(entry));
+    EXPECT_EQ(entry.type, TransactionJournalType::Commit);
+    EXPECT_EQ(entry.newValue, 120);
+}
+
+TEST(TransactionJournalTests, RecordFileJournalsWritesAndCommit)
+{
+    RecordCard transceiver;
+    NativeWire wire;
+    DesfireCard card(transceiver, wire);
+    DesfireRecordFile file(card, 0x05);
+
+    MemorySegments segments;
+    TransactionJournalOptions options;
+    TransactionJournal journal(segments, options);
+    ASSERT_TRUE(journal.recover().has_value());
+    const etl::vector<uint8_t, 7> uid = {0x04, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6};
+    file.setJournal(&journal, uid);
+
+    const etl::vector<uint8_t, 6> head = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+    const etl::vector<uint8_t, 4> tail = {0x07, 0x08, 0x09, 0x0A};
+    ASSERT_TRUE(file.writeRecord(0U, head).has_value());
+    ASSERT_TRUE(file.writeRecord(6U, tail).has_value());
+    EXPECT_EQ(file.pendingBytes(), 10U);
+    ASSERT_TRUE(file.commit().has_value());
+    EXPECT_EQ(file.pendingBytes(), 0U);
+
+    // A commit whose outcome is unknown leaves its write unsettled
+    ASSERT_TRUE(file.writeRecord(0U, tail).has_value());
+    transceiver.failCommit = true;
+    EXPECT_FALSE(file.commit().has_value());
+    ASSERT_TRUE(journal.commit().has_value());
+
+    TransactionJournalReader reader;
+    ASSERT_TRUE(reader.open(segments.disk[0].data(), segments.disk[0].size()).has_value());
+    TransactionJournalEntry entry;
+    ASSERT_TRUE(reader.next(entry));
+    EXPECT_EQ(entry.type, TransactionJournalType::WriteRecord);
+    EXPECT_EQ(entry.fileNo, 0x05);
+    EXPECT_EQ(entry.delta, 6);
+    EXPECT_EQ(entry.newValue, 0);
+    ASSERT_TRUE(reader.next(entry));
+    EXPECT_EQ(entry.type, TransactionJournalType::WriteRecord);
+    EXPECT_EQ(entry.delta, 4);
+    EXPECT_EQ(entry.newValue, 6);
+    ASSERT_TRUE(reader.next(entry));
+    EXPECT_EQ(entry.type, TransactionJournalType::Commit);
+    EXPECT_EQ(entry.delta, 10);
+    EXPECT_EQ(entry.flags, 0U);
+    ASSERT_TRUE(reader.next(entry));
+    EXPECT_EQ(entry.type, TransactionJournalType::WriteRecord);
+    EXPECT_FALSE(reader.next(entry));
+}
+
+TEST(TransactionJournalTests, JournalFailureDoesNotFailCardOperation)
+{
+    ValueCard valueTransceiver;
+    RecordCard recordTransceiver;
+    NativeWire wire;
+    DesfireCard valueCard(valueTransceiver, wire);
+    DesfireCard recordCard(recordTransceiver, wire);
+    DesfireValueFile valueFile(valueCard, 0x03);
+    DesfireRecordFile recordFile(recordCard, 0x05);
+
+    // Never recovered: every append fails
+    MemorySegments segments;
+    TransactionJournalOptions options;
+    TransactionJournal journal(segments, options);
+    const etl::vector<uint8_t, 7> uid = {0x04, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6};
+    valueFile.setJournal(&journal, uid);
+    recordFile.setJournal(&journal, uid);
+
+    ASSERT_EQ(valueFile.balance().value(), 100);
+    ASSERT_TRUE(valueFile.debit(30).has_value());
+    EXPECT_EQ(valueFile.pendingDelta(), -30);
+    EXPECT_EQ(valueTransceiver.pending, -30);
+    EXPECT_EQ(valueFile.journalFailures(), 1U);
+    ASSERT_TRUE(valueFile.lastJournalError().has_value());
+    EXPECT_EQ(valueFile.lastJournalError().value().get<error::DesfireError>(), error::DesfireError::InvalidState);
+
+    auto committed = valueFile.commit();
+    ASSERT_TRUE(committed.has_value());
+    EXPECT_TRUE(committed.value().committed);
+    EXPECT_FALSE(committed.value().journaled);
+    EXPECT_EQ(valueFile.journalFailures(), 2U);
+
+    const etl::vector<uint8_t, 4> data = {0x07, 0x08, 0x09, 0x0A};
+    ASSERT_TRUE(recordFile.writeRecord(0U, data).has_value());
+    EXPECT_EQ(recordFile.pendingBytes(), 4U);
+    EXPECT_EQ(recordFile.journalFailures(), 1U);
+    ASSERT_TRUE(recordFile.commit().has_value());
+    EXPECT_EQ(recordFile.journalFailures(), 2U);
+
+    // Attaching again starts a new count
+    recordFile.setJournal(&journal, uid);
+    EXPECT_EQ(recordFile.journalFailures(), 0U);
+    EXPECT_FALSE(recordFile.lastJournalError().has_value());
+}
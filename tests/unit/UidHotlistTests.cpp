@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "Nfc/Card/UidHotlist.h"
+#include "Error/CardManagerError.h"
+
+using namespace nfc;
+
+namespace
+{
+    etl::vector<uint8_t, 10> makeUid(uint32_t n, size_t length = 7U)
+    {
+        etl::vector<uint8_t, 10> uid;
+        uid.push_back(0x04);
+        for (size_t i = 1; i < length; ++i)
+        {
+            uid.push_back(static_cast<uint8_t>(n >> (8U * ((i - 1U) % 4U))) ^ static_cast<uint8_t>(i * 0x3BU));
+        }
+        return uid;
+    }
+
+    std::vector<uint8_t> buildImage(uint32_t first, uint32_t count, uint32_t sequence)
+    {
+        std::vector<uint8_t> image(UidHotlistFormat::imageSize(count));
+        UidHotlistWriter writer(image.data(), image.size(), count, sequence);
+        for (uint32_t n = first; n < first + count; ++n)
+        {
+            EXPECT_TRUE(writer.addUid(makeUid(n)).has_value());
+        }
+        auto size = writer.finish();
+        EXPECT_TRUE(size.has_value());
+        image.resize(size.value());
+        return image;
+    }
+}
+
+TEST(UidHotlistTests, FindsEveryListedUid)
+{
+    const std::vector<uint8_t> image = buildImage(0U, 20000U, 7U);
+    UidHotlistView view;
+    ASSERT_TRUE(view.open(image.data(), image.size()).has_value());
+    EXPECT_EQ(view.size(), 20000U);
+    EXPECT_EQ(view.sequence(), 7U);
+
+    for (uint32_t n = 0U; n < 20000U; ++n)
+    {
+        const auto uid = makeUid(n);
+        ASSERT_TRUE(view.contains(uid.data(), uid.size())) << n;
+    }
+    for (uint32_t n = 20000U; n < 40000U; ++n)
+    {
+        const auto uid = makeUid(n);
+        EXPECT_FALSE(view.contains(uid.data(), uid.size()));
+    }
+
+    // Same bytes, different length: a 4-byte UID is not its 7-byte extension
+    const auto shortUid = makeUid(5U, 4U);
+    EXPECT_FALSE(view.contains(shortUid.data(), shortUid.size()));
+}
+
+TEST(UidHotlistTests, DropsDuplicatesAndRejectsBadInput)
+{
+    std::vector<uint8_t> image(UidHotlistFormat::imageSize(4U));
+    UidHotlistWriter writer(image.data(), image.size(), 4U, 1U);
+    ASSERT_TRUE(writer.addUid(makeUid(1U)).has_value());
+    ASSERT_TRUE(writer.addUid(makeUid(1U)).has_value());
+    ASSERT_TRUE(writer.addUid(makeUid(2U, 4U)).has_value());
+
+    etl::vector<uint8_t, 10> empty;
+    auto bad = writer.addUid(empty);
+    ASSERT_FALSE(bad.has_value());
+    EXPECT_EQ(bad.error().get<error::CardManagerError>(), error::CardManagerError::InvalidParameter);
+
+    auto size = writer.finish();
+    ASSERT_TRUE(size.has_value());
+    EXPECT_EQ(writer.entryCount(), 2U);
+
+    UidHotlistView view;
+    ASSERT_TRUE(view.open(image.data(), size.value()).has_value());
+    EXPECT_EQ(view.size(), 2U);
+
+    // Truncated and corrupted images are refused
+    EXPECT_FALSE(view.open(image.data(), size.value() - 1U).has_value());
+    image[UidHotlistFormat::HEADER_SIZE + 4U] = 0xFF;
+    EXPECT_FALSE(view.open(image.data(), size.value()).has_value());
+}
+
+TEST(UidHotlistTests, AppliesDenyAndAllowModes)
+{
+    const std::vector<uint8_t> image = buildImage(100U, 50U, 1U);
+    UidHotlist denylist(UidHotlistMode::Denylist);
+    UidHotlist allowlist(UidHotlistMode::Allowlist);
+
+    // Without a list: deny lists fail open, allow lists fail closed
+    EXPECT_TRUE(denylist.allows(makeUid(120U)));
+    EXPECT_FALSE(allowlist.allows(makeUid(120U)));
+
+    ASSERT_TRUE(denylist.publish(image.data(), image.size()).has_value());
+    ASSERT_TRUE(allowlist.publish(image.data(), image.size()).has_value());
+    EXPECT_FALSE(denylist.allows(makeUid(120U)));
+    EXPECT_TRUE(denylist.allows(makeUid(10U)));
+    EXPECT_TRUE(allowlist.allows(makeUid(120U)));
+    EXPECT_FALSE(allowlist.allows(makeUid(10U)));
+}
+
+TEST(UidHotlistTests, SwapsWhileReadersRun)
+{
+    const std::vector<uint8_t> images[2] = {buildImage(0U, 1000U, 1U), buildImage(0U, 1000U, 2U)};
+    UidHotlist hotlist;
+    ASSERT_TRUE(hotlist.publish(images[0].data(), images[0].size()).has_value());
+
+    std::atomic<bool> stop(false);
+    std::atomic<uint32_t> misses(0U);
+    std::thread reader([&]() {
+        uint32_t n = 0U;
+        while (!stop.load())
+        {
+            if (!hotlist.contains(makeUid(n % 1000U)))
+            {
+                misses.fetch_add(1U);
+            }
+            ++n;
+        }
+    });
+
+    for (uint32_t swap = 0U; swap < 200U; ++swap)
+    {
+        const std::vector<uint8_t>& next = images[(swap + 1U) % 2U];
+        while (!hotlist.publish(next.data(), next.size()).has_value())
+        {
+            std::this_thread::yield();
+        }
+        EXPECT_EQ(hotlist.sequence(), ((swap + 1U) % 2U) + 1U);
+    }
+
+    stop.store(true);
+    reader.join();
+    EXPECT_EQ(misses.load(), 0U);
+    EXPECT_TRUE(hotlist.isPreviousReleased());
+}